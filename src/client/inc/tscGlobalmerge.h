@@ -29,13 +29,16 @@ extern "C" {
 #define MAX_NUM_OF_SUBQUERY_RETRY 3
   
 struct SQLFunctionCtx;
+struct SSqlObj;
 
 typedef struct SLocalDataSource {
-  tExtMemBuffer *pMemBuffer;
-  int32_t        flushoutIdx;
-  int32_t        pageId;
-  int32_t        rowIdx;
-  tFilePage      filePage;
+  tExtMemBuffer   *pMemBuffer;
+  int32_t          flushoutIdx;
+  int32_t          pageId;
+  int32_t          rowIdx;
+  struct SSqlObj  *pSql;     // subquery that provides the rows on demand, NULL if the rows are loaded from disk
+  int32_t          resIdx;   // the first row in the retrieved result of the subquery not loaded into filePage yet
+  tFilePage        filePage;
 } SLocalDataSource;
 
 typedef struct SGlobalMerger {
@@ -48,10 +51,11 @@ typedef struct SGlobalMerger {
   tOrderDescriptor      *pDesc;
   tExtMemBuffer        **pExtMemBuffer;    // disk-based buffer
   char                  *buf;              // temp buffer
+  int64_t                maxRows;          // no more rows are merged once reached, 0 if not limited
+  int64_t                numOfMerged;
+  SLocalDataSource      *pPendingSrc;      // the chosen source waits for the next block from its vnode
 } SGlobalMerger;
 
-struct SSqlObj;
-
 typedef struct SRetrieveSupport {
   tExtMemBuffer **  pExtMemBuffer;     // for build loser tree
   tOrderDescriptor *pOrderDescriptor;
@@ -76,6 +80,20 @@ int32_t tscFlushTmpBuffer(tExtMemBuffer *pMemoryBuf, tOrderDescriptor *pDesc, tF
 int32_t tscCreateGlobalMerger(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrderDescriptor *pDesc,
                           SQueryInfo *pQueryInfo, SGlobalMerger **pMerger, int64_t id);
 
+/*
+ * The ordered projection on super table with limit clause is merged from the sorted results of vnodes
+ * directly. Each source keeps only the last retrieved block, the next one is fetched when it is consumed.
+ */
+bool tscIsStreamGlobalMerge(struct SSqlObj *pSql, SQueryInfo *pQueryInfo);
+
+int32_t tscCreateStreamGlobalMerger(struct SSqlObj *pSql, tExtMemBuffer **pMemBuffer, tOrderDescriptor *pDesc,
+                                    SGlobalMerger **pMerger);
+
+/*
+ * fetch the next block for the pending source of the stream merge, and continue the merge afterwards
+ */
+void tscFetchGlobalMergeSource(struct SSqlObj *pSql);
+
 void tscDestroyGlobalMerger(SGlobalMerger* pMerger);
 
 #ifdef __cplusplus
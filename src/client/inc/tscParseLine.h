@@ -50,6 +50,7 @@ typedef enum {
 typedef struct {
   uint64_t id;
   SHashObj* smlDataToSchema;
+  const char* lineEnd;  // '\0' of the line being parsed
 } SSmlLinesInfo;
 
 int tscSmlInsert(TAOS* taos, TAOS_SML_DATA_POINT* points, int numPoint, SSmlLinesInfo* info);
@@ -61,6 +62,11 @@ bool convertSmlValueType(TAOS_SML_KV *pVal, char *value,
 int32_t convertSmlTimeStamp(TAOS_SML_KV *pVal, char *value,
                             uint16_t len, SSmlLinesInfo* info);
 
+const char *smlScanSpecialChar(const char *str, const char *end);
+
+int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* failedLines, SSmlLinesInfo* info);
+int32_t tscParseTelnetLines(char* lines[], int numLines, SArray* points, SArray* failedLines, SSmlLinesInfo* info);
+
 void destroySmlDataPoint(TAOS_SML_DATA_POINT* point);
 
 #ifdef __cplusplus
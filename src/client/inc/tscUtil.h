@@ -94,6 +94,7 @@ typedef struct SMergeTsCtx {
 typedef struct SVgroupTableInfo {
   SVgroupMsg  vgInfo;
   SArray     *itemList;   // SArray<STableIdInfo>
+  SArray     *joinList;   // SArray<STableIdInfo>, join partner of each item when both sides are in this vgroup
 } SVgroupTableInfo;
 
 typedef struct SBlockKeyTuple {
@@ -110,6 +111,8 @@ int32_t converToStr(char *str, int type, void *buf, int32_t bufSize, int32_t *le
 
 int32_t tscCreateDataBlock(size_t initialSize, int32_t rowSize, int32_t startOffset, SName* name, STableMeta* pTableMeta, STableDataBlocks** dataBlocks);
 void tscDestroyDataBlock(STableDataBlocks* pDataBlock, bool removeMeta);
+void    tscDestroyBindColumns(STableDataBlocks* pDataBlock);
+int32_t tscFlattenBindColumns(STableDataBlocks* pDataBlock);
 void    tscSortRemoveDataBlockDupRowsRaw(STableDataBlocks* dataBuf);
 int     tscSortRemoveDataBlockDupRows(STableDataBlocks* dataBuf, SBlockKeyInfo* pBlkKeyInfo);
 int32_t tsSetBlockInfo(SSubmitBlk *pBlocks, const STableMeta *pTableMeta, int32_t numOfRows);
@@ -352,6 +355,7 @@ int32_t copyTagData(STagData* dst, const STagData* src);
 STableMeta* createSuperTableMeta(STableMetaMsg* pChild);
 uint32_t tscGetTableMetaSize(STableMeta* pTableMeta);
 CChildTableMeta* tscCreateChildMeta(STableMeta* pTableMeta);
+void tscEvictTableMetaIfNeeded();
 uint32_t tscGetTableMetaMaxSize();
 int32_t tscCreateTableMetaFromSTableMeta(STableMeta** ppChild, const char* name, size_t *tableMetaCapacity, STableMeta **ppStable);
 STableMeta* tscTableMetaDup(STableMeta* pTableMeta);
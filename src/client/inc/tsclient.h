@@ -63,6 +63,14 @@ typedef struct CChildTableMeta {
   uint64_t       suid;                              // super table id
 } CChildTableMeta;
 
+typedef struct SMetaCacheStat {
+  int64_t hit;
+  int64_t miss;
+  int64_t stale;       // cached meta found outdated
+  int64_t prefetched;  // child table metas filled by prefetch of super table
+  int64_t evicted;
+} SMetaCacheStat;
+
 typedef struct SColumnIndex {
   int16_t tableIndex;
   int16_t columnIndex;
@@ -207,6 +215,22 @@ static FORCE_INLINE void tscAppendMemRowColValEx(SMemRow row, const void *value,
     tdGetColAppendDeltaLen(value, colType, dataLen, kvLen);
   }
 }
+// values of one column bound by taos_stmt_bind_param_batch, kept in submit columnar layout
+typedef struct SBindColumn {
+  int32_t  numOfRows;
+  int32_t  rowCapacity;  // rows allocated for bitmap and offsets
+  int32_t  dataLen;
+  int32_t  dataCapacity;
+  uint8_t *bitmap;       // a set bit means null
+  int32_t *offsets;      // offset of each value in data, for binary/nchar only
+  char    *data;
+} SBindColumn;
+
+#define BIND_COL_BITMAP_LEN(rows)   (((rows) + 7) >> 3)
+#define BIND_COL_IS_NULL(bm, row)   (((bm)[(row) >> 3] & (1u << ((row) & 7))) != 0)
+#define BIND_COL_SET_NULL(bm, row)  ((bm)[(row) >> 3] |= (uint8_t)(1u << ((row) & 7)))
+#define BIND_COL_SET_VALUE(bm, row) ((bm)[(row) >> 3] &= (uint8_t)~(1u << ((row) & 7)))
+
 typedef struct STableDataBlocks {
   SName       tableName;
   int8_t      tsSource;     // where does the UNIX timestamp come from, server or client
@@ -229,6 +253,7 @@ typedef struct STableDataBlocks {
   uint32_t       numOfParams;
   SParamInfo *   params;
   SMemRowBuilder rowBuilder;
+  SBindColumn *  pBindCols;  // one for each column if rows are bound column-wise, instead of into pData
 } STableDataBlocks;
 
 typedef struct {
@@ -326,6 +351,7 @@ typedef struct STscObj {
   char               sversion[TSDB_VERSION_LEN];
   char               writeAuth : 1;
   char               superAuth : 1;
+  int8_t             features;  // TSDB_CONN_FEATURE_XXX reported by mnode
   uint32_t           connId;
   uint64_t           rid;      // ref ID returned by taosAddRef
   int64_t            hbrid;
@@ -408,10 +434,19 @@ typedef struct SSqlStream {
   void *param;
 
   void (*callback)(void *);  // Callback function when stream is stopped from client level
+
+  /*
+   * emit the closed windows in [skey, ekey) without a query, return false if the windows have to be queried.
+   * it is set by the CQ of a vnode which keeps the window state of the stream up to date on writes.
+   */
+  bool  (*incFp)(void *param, struct SSqlStream *pStream, int64_t skey, int64_t ekey);
+  int64_t incEkey;  // end of the windows being queried instead of being emitted by incFp
+
   struct SSqlStream *prev, *next;
 } SSqlStream;
 
 void tscSetStreamDestTable(SSqlStream* pStream, const char* dstTable);
+void tscSetStreamIncFp(SSqlStream* pStream, bool (*fp)(void *, SSqlStream *, int64_t, int64_t));
 
 int  tscAcquireRpc(const char *key, const char *user, const char *secret,void **pRpcObj);
 void tscReleaseRpc(void *param);
@@ -421,8 +456,11 @@ int tsParseSql(SSqlObj *pSql, bool initial);
 
 void tscProcessMsgFromServer(SRpcMsg *rpcMsg, SRpcEpSet *pEpSet);
 int  tscBuildAndSendRequest(SSqlObj *pSql, SQueryInfo* pQueryInfo);
+int  tscSendMsgToServer(SSqlObj *pSql);
+void tscDumpEpSetFromVgroupInfo(SRpcEpSet *pEpSet, SNewVgroupInfo *pVgroupInfo);
 
 int  tscRenewTableMeta(SSqlObj *pSql, int32_t tableIndex);
+void tscPrefetchSTableMeta(STscObj *pObj, const char *sTableName);
 void tscAsyncResultOnError(SSqlObj *pSql);
 
 void tscQueueAsyncError(void(*fp), void *param, int32_t code);
@@ -461,6 +499,8 @@ void tscFreeRegisteredSqlObj(void *pSql);
 
 void tscCloseTscObj(void *pObj);
 
+void tscFreeBulkWriter(void *pWriter);
+
 // todo move to taos? or create a new file: taos_internal.h
 TAOS *taos_connect_a(char *ip, char *user, char *pass, char *db, uint16_t port, void (*fp)(void *, TAOS_RES *, int),
                      void *param, TAOS **taos);
@@ -489,12 +529,17 @@ int32_t tscSQLSyntaxErrMsg(char* msg, const char* additionalInfo,  const char* s
 int32_t tscValidateSqlInfo(SSqlObj *pSql, struct SSqlInfo *pInfo);
 
 int32_t tsSetBlockInfo(SSubmitBlk *pBlocks, const STableMeta *pTableMeta, int32_t numOfRows);
+int32_t tscBindParam(STableDataBlocks* pBlock, char* data, SParamInfo* param, TAOS_BIND* bind);
 extern int32_t    sentinel;
 extern SHashObj  *tscVgroupMap;
+extern SHashObj  *tscVgroupFlowCtrlMap;
 extern SHashObj  *tscTableMetaMap;
 extern SCacheObj *tscVgroupListBuf;
+extern SHashObj  *tscMetaPrefetchMap;
+extern SMetaCacheStat tscMetaCacheStat;
 
 extern int   tscObjRef;
+extern int   tscBulkWriterRef;
 extern void *tscTmr;
 extern void *tscQhandle;
 extern int   tscKeepConn[];
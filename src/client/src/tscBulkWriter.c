@@ -0,0 +1,677 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "taos.h"
+#include "tsclient.h"
+#include "ttimer.h"
+#include "tref.h"
+#include "ttoken.h"
+#include "tscLog.h"
+#include "tscUtil.h"
+#include "tutil.h"
+
+#define TSC_BULK_DEFAULT_ROWS     4096
+#define TSC_BULK_DEFAULT_BYTES    (1024 * 1024)
+#define TSC_BULK_DEFAULT_INTERVAL 100  // ms
+#define TSC_BULK_DEFAULT_INFLIGHT 2
+#define TSC_BULK_MAX_TABLE_ROWS   (INT16_MAX - 1)
+
+typedef struct SBulkTable {
+  SName       name;
+  STableMeta *pTableMeta;
+  int32_t     numOfParams;
+  SParamInfo *params;  // one for each column, in the layout of raw payload row
+} SBulkTable;
+
+typedef struct SBulkVgroup {
+  int32_t   vgId;
+  int32_t   numOfRows;
+  int32_t   size;      // bytes buffered
+  int32_t   inflight;  // submits not responded yet
+  int64_t   firstTs;   // ms, when the oldest buffered row was appended
+  SHashObj *pBlocks;   // table uid -> STableDataBlocks*
+} SBulkVgroup;
+
+typedef struct SBulkTableRows {
+  char    name[TSDB_TABLE_FNAME_LEN];
+  int32_t numOfRows;
+} SBulkTableRows;
+
+typedef struct SBulkSubmit {
+  int64_t rid;  // ref of the writer
+  int32_t vgId;
+  int32_t numOfRows;
+  SArray *pTables;  // SBulkTableRows, to report failures
+} SBulkSubmit;
+
+typedef struct SBulkWriter {
+  void *                   signature;
+  int64_t                  rid;
+  STscObj *                pTscObj;
+  SSqlObj *                pSql;       // only used to resolve table meta, never sent
+  pthread_mutex_t          metaMutex;  // protects pSql
+  TAOS_BULK_WRITER_OPTIONS options;
+  pthread_mutex_t          mutex;
+  pthread_cond_t           cond;       // signaled when a submit is responded
+  SHashObj *               pTables;    // table name given by user -> SBulkTable*
+  SHashObj *               pVgroups;   // vgId -> SBulkVgroup*
+  SArray *                 pVgroupList;
+  void *                   pTimer;
+  int32_t                  inflight;
+  int32_t                  code;       // first failure since last flush
+  int8_t                   closed;
+} SBulkWriter;
+
+static void tscBulkWriterSubmitCallback(void *param, TAOS_RES *tres, int code);
+
+static void tscDestroyBulkTable(SBulkTable *pTable) {
+  if (pTable == NULL) return;
+  tfree(pTable->pTableMeta);
+  tfree(pTable->params);
+  free(pTable);
+}
+
+static void tscClearBulkTables(SHashObj *pTables) {
+  SBulkTable **p = taosHashIterate(pTables, NULL);
+  while (p) {
+    tscDestroyBulkTable(*p);
+    p = taosHashIterate(pTables, p);
+  }
+
+  taosHashClear(pTables);
+}
+
+void tscFreeBulkWriter(void *param) {
+  SBulkWriter *pWriter = param;
+  assert(pWriter->inflight == 0);
+
+  size_t numOfVgroups = (pWriter->pVgroupList != NULL) ? taosArrayGetSize(pWriter->pVgroupList) : 0;
+  for (int32_t i = 0; i < numOfVgroups; ++i) {
+    SBulkVgroup *pVgroup = taosArrayGetP(pWriter->pVgroupList, i);
+    tscDestroyBlockHashTable(pVgroup->pBlocks, false);
+    free(pVgroup);
+  }
+
+  taosArrayDestroy(pWriter->pVgroupList);
+  taosHashCleanup(pWriter->pVgroups);
+
+  tscClearBulkTables(pWriter->pTables);
+  taosHashCleanup(pWriter->pTables);
+
+  tscFreeSqlObj(pWriter->pSql);
+
+  pthread_cond_destroy(&pWriter->cond);
+  pthread_mutex_destroy(&pWriter->mutex);
+  pthread_mutex_destroy(&pWriter->metaMutex);
+
+  tscDebug("bulk writer:%p is freed", pWriter);
+  free(pWriter);
+}
+
+static int32_t tscBulkWriterLoadTable(SBulkWriter *pWriter, const char *tableName, SBulkTable **ppTable) {
+  char name[TSDB_TABLE_FNAME_LEN] = {0};
+  size_t len = strlen(tableName);
+  if (len == 0 || len >= TSDB_TABLE_FNAME_LEN) {
+    return TSDB_CODE_TSC_INVALID_TABLE_NAME;
+  }
+
+  strtolower(name, tableName);
+
+  SSqlObj *pSql = pWriter->pSql;
+  STableMetaInfo *pTableMetaInfo = tscGetTableMetaInfoFromCmd(&pSql->cmd, 0);
+
+  SStrToken token = {.z = name, .n = (uint32_t)len, .type = TK_STRING};
+
+  pthread_mutex_lock(&pWriter->metaMutex);
+
+  int32_t code = tscSetTableFullName(&pTableMetaInfo->name, &token, pSql);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = tscGetTableMetaEx(pSql, pTableMetaInfo, false, true);
+    if (code == TSDB_CODE_TSC_NO_META_CACHED) {
+      // not cached yet, fetch it from mnode synchronously and try again
+      code = taos_load_table_info(pWriter->pTscObj, name);
+      if (code == TSDB_CODE_SUCCESS) {
+        code = tscGetTableMetaEx(pSql, pTableMetaInfo, false, true);
+      }
+    }
+  }
+
+  STableMeta *pTableMeta = pTableMetaInfo->pTableMeta;
+  if (code == TSDB_CODE_SUCCESS && UTIL_TABLE_IS_SUPER_TABLE(pTableMetaInfo)) {
+    code = TSDB_CODE_TSC_INVALID_OPERATION;
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    pthread_mutex_unlock(&pWriter->metaMutex);
+    tscError("bulk writer:%p failed to get meta of table:%s, code:%s", pWriter, tableName, tstrerror(code));
+    return code;
+  }
+
+  SBulkTable *pTable = calloc(1, sizeof(SBulkTable));
+  int32_t     numOfCols = tscGetNumOfColumns(pTableMeta);
+  if (pTable != NULL) {
+    pTable->pTableMeta = tscTableMetaDup(pTableMeta);
+    pTable->params = calloc(numOfCols, sizeof(SParamInfo));
+  }
+
+  if (pTable == NULL || pTable->pTableMeta == NULL || pTable->params == NULL) {
+    pthread_mutex_unlock(&pWriter->metaMutex);
+    tscDestroyBulkTable(pTable);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  tNameAssign(&pTable->name, &pTableMetaInfo->name);
+  pthread_mutex_unlock(&pWriter->metaMutex);
+
+  SSchema *pSchema = tscGetTableSchema(pTable->pTableMeta);
+  uint32_t offset = 0;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SParamInfo *param = &pTable->params[i];
+    param->idx = i;
+    param->type = pSchema[i].type;
+    param->timePrec = pTable->pTableMeta->tableInfo.precision;
+    param->bytes = pSchema[i].bytes;
+    param->offset = offset;
+
+    offset += pSchema[i].bytes;
+  }
+
+  pTable->numOfParams = numOfCols;
+  *ppTable = pTable;
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static SBulkVgroup *tscBulkWriterGetVgroup(SBulkWriter *pWriter, int32_t vgId) {
+  SBulkVgroup **p = taosHashGet(pWriter->pVgroups, &vgId, sizeof(vgId));
+  if (p != NULL) {
+    return *p;
+  }
+
+  SBulkVgroup *pVgroup = calloc(1, sizeof(SBulkVgroup));
+  if (pVgroup == NULL) {
+    return NULL;
+  }
+
+  pVgroup->vgId = vgId;
+  pVgroup->pBlocks = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, HASH_NO_LOCK);
+  if (pVgroup->pBlocks == NULL) {
+    free(pVgroup);
+    return NULL;
+  }
+
+  taosHashPut(pWriter->pVgroups, &vgId, sizeof(vgId), &pVgroup, POINTER_BYTES);
+  taosArrayPush(pWriter->pVgroupList, &pVgroup);
+  return pVgroup;
+}
+
+static void tscBulkWriterReportFailure(SBulkWriter *pWriter, SBulkSubmit *pSubmit, int32_t code) {
+  tscError("bulk writer:%p failed to write %d rows into vgId:%d, code:%s", pWriter, pSubmit->numOfRows,
+           pSubmit->vgId, tstrerror(code));
+
+  if (pWriter->options.fp == NULL) {
+    return;
+  }
+
+  size_t numOfTables = taosArrayGetSize(pSubmit->pTables);
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    SBulkTableRows *pRows = taosArrayGet(pSubmit->pTables, i);
+    (*pWriter->options.fp)(pWriter->options.param, pRows->name, pRows->numOfRows, code);
+  }
+}
+
+static void tscDestroyBulkSubmit(SBulkSubmit *pSubmit) {
+  taosArrayDestroy(pSubmit->pTables);
+  free(pSubmit);
+}
+
+/*
+ * Detach the rows buffered for one vgroup and build a submit for them. It is called with pWriter->mutex held, and
+ * the returned sql object shall be sent after the mutex is released. If wait is false, the vgroup is skipped when
+ * it has reached the in-flight limit.
+ */
+static SSqlObj *tscBulkWriterPrepareSubmit(SBulkWriter *pWriter, SBulkVgroup *pVgroup, bool wait) {
+  while (pVgroup->numOfRows > 0 && pVgroup->inflight >= pWriter->options.maxInflight) {
+    if (!wait) {
+      return NULL;
+    }
+
+    pthread_cond_wait(&pWriter->cond, &pWriter->mutex);
+  }
+
+  // flushed by others while waiting
+  if (pVgroup->numOfRows == 0) {
+    return NULL;
+  }
+
+  SHashObj *pBlocks = pVgroup->pBlocks;
+  pVgroup->pBlocks = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, HASH_NO_LOCK);
+  if (pVgroup->pBlocks == NULL) {
+    pVgroup->pBlocks = pBlocks;
+    pWriter->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  SBulkSubmit *pSubmit = calloc(1, sizeof(SBulkSubmit));
+  if (pSubmit != NULL) {
+    pSubmit->rid = pWriter->rid;
+    pSubmit->vgId = pVgroup->vgId;
+    pSubmit->numOfRows = pVgroup->numOfRows;
+    pSubmit->pTables = taosArrayInit(taosHashGetSize(pBlocks), sizeof(SBulkTableRows));
+  }
+
+  pVgroup->numOfRows = 0;
+  pVgroup->size = 0;
+  pVgroup->firstTs = 0;
+
+  SSqlObj *pNew = calloc(1, sizeof(SSqlObj));
+  int32_t  code = TSDB_CODE_SUCCESS;
+
+  if (pSubmit == NULL || pSubmit->pTables == NULL || pNew == NULL) {
+    code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    goto _error;
+  }
+
+  STableDataBlocks **p = taosHashIterate(pBlocks, NULL);
+  while (p) {
+    SBulkTableRows rows = {.numOfRows = ((SSubmitBlk *)(*p)->pData)->numOfRows};
+    tNameExtractFullName(&(*p)->tableName, rows.name);
+    taosArrayPush(pSubmit->pTables, &rows);
+
+    p = taosHashIterate(pBlocks, p);
+  }
+
+  pNew->pTscObj = pWriter->pTscObj;
+  pNew->signature = pNew;
+  pNew->cmd.command = TSDB_SQL_INSERT;
+  pNew->fp = tscBulkWriterSubmitCallback;
+  pNew->fetchFp = tscBulkWriterSubmitCallback;
+  pNew->param = pSubmit;
+  pNew->maxRetry = TSDB_MAX_REPLICA;
+  pNew->retry = pNew->maxRetry;  // the buffered rows are gone, failures are reported instead of re-parsing
+  tsem_init(&pNew->rspSem, 0, 0);
+
+  if (tscAddQueryInfo(&pNew->cmd) != TSDB_CODE_SUCCESS ||
+      tscAddEmptyMetaInfo(tscGetQueryInfo(&pNew->cmd)) == NULL) {
+    code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    goto _error;
+  }
+
+  registerSqlObj(pNew);
+
+  SInsertStatementParam *pInsertParam = &pNew->cmd.insertParam;
+  pInsertParam->objectId = pNew->self;
+  pInsertParam->payloadType = PAYLOAD_TYPE_RAW;
+  pInsertParam->pTableBlockHashList = pBlocks;
+  pBlocks = NULL;
+
+  code = tscMergeTableDataBlocks(pInsertParam, true);
+  if (code == TSDB_CODE_SUCCESS) {
+    // all tables are in the same vgroup, so they are merged into one block
+    assert(taosArrayGetSize(pInsertParam->pDataBlocks) == 1);
+    code = tscCopyDataBlockToPayload(pNew, taosArrayGetP(pInsertParam->pDataBlocks, 0));
+    pInsertParam->pDataBlocks = tscDestroyBlockArrayList(pInsertParam->pDataBlocks);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
+  taosAcquireRef(tscBulkWriterRef, pWriter->rid);
+  pVgroup->inflight += 1;
+  pWriter->inflight += 1;
+
+  tscDebug("0x%" PRIx64 " bulk writer:%p submit %d rows of %d tables to vgId:%d, inflight:%d", pNew->self, pWriter,
+           pSubmit->numOfRows, (int32_t)taosArrayGetSize(pSubmit->pTables), pVgroup->vgId, pVgroup->inflight);
+  return pNew;
+
+_error:
+  tscDestroyBlockHashTable(pBlocks, false);
+  if (pSubmit != NULL) {
+    if (pWriter->code == TSDB_CODE_SUCCESS) pWriter->code = code;
+    tscBulkWriterReportFailure(pWriter, pSubmit, code);
+    tscDestroyBulkSubmit(pSubmit);
+  }
+
+  if (pNew != NULL) {
+    pNew->param = NULL;
+    taos_free_result(pNew);
+  }
+
+  return NULL;
+}
+
+static void tscBulkWriterSubmitCallback(void *param, TAOS_RES *tres, int numOfRows) {
+  SBulkSubmit *pSubmit = param;
+  SSqlObj     *pSql = tres;
+  int32_t      code = taos_errno(tres);
+
+  SBulkWriter *pWriter = taosAcquireRef(tscBulkWriterRef, pSubmit->rid);
+  assert(pWriter != NULL);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tscBulkWriterReportFailure(pWriter, pSubmit, code);
+  } else if (numOfRows < pSubmit->numOfRows) {
+    tscDebug("0x%" PRIx64 " bulk writer:%p %d rows submitted to vgId:%d, %d rows affected", pSql->self, pWriter,
+             pSubmit->numOfRows, pSubmit->vgId, numOfRows);
+  }
+
+  // the buffered meta is outdated, reload it on next append
+  bool outdated = (code == TSDB_CODE_TDB_INVALID_TABLE_ID || code == TSDB_CODE_TDB_TABLE_RECONFIGURE ||
+                   code == TSDB_CODE_VND_INVALID_VGROUP_ID);
+  if (outdated) {
+    size_t numOfTables = taosArrayGetSize(pSubmit->pTables);
+    for (int32_t i = 0; i < numOfTables; ++i) {
+      SBulkTableRows *pRows = taosArrayGet(pSubmit->pTables, i);
+      taosHashRemove(tscTableMetaMap, pRows->name, strnlen(pRows->name, TSDB_TABLE_FNAME_LEN));
+    }
+  }
+
+  pthread_mutex_lock(&pWriter->mutex);
+
+  if (outdated) {
+    tscClearBulkTables(pWriter->pTables);
+  }
+
+  if (code != TSDB_CODE_SUCCESS && pWriter->code == TSDB_CODE_SUCCESS) {
+    pWriter->code = code;
+  }
+
+  SBulkVgroup **p = taosHashGet(pWriter->pVgroups, &pSubmit->vgId, sizeof(pSubmit->vgId));
+  assert(p != NULL);
+  (*p)->inflight -= 1;
+  pWriter->inflight -= 1;
+
+  pthread_cond_broadcast(&pWriter->cond);
+  pthread_mutex_unlock(&pWriter->mutex);
+
+  tscDestroyBulkSubmit(pSubmit);
+  taos_free_result(tres);
+
+  taosReleaseRef(tscBulkWriterRef, pWriter->rid);  // acquired above
+  taosReleaseRef(tscBulkWriterRef, pWriter->rid);  // acquired when the submit is prepared
+}
+
+static void tscBulkWriterSend(SSqlObj *pSql) {
+  int32_t code = tscBuildAndSendRequest(pSql, NULL);
+  if (code != TSDB_CODE_SUCCESS) {
+    pSql->res.code = code;
+    tscAsyncResultOnError(pSql);
+  }
+}
+
+/*
+ * Submit the rows of every vgroup, it is called with pWriter->mutex held. If timeout is positive, only vgroups holding
+ * rows older than it are submitted, and the ones reaching the in-flight limit are left for next round.
+ */
+static void tscBulkWriterSubmitAll(SBulkWriter *pWriter, int64_t timeout) {
+  int64_t now = taosGetTimestampMs();
+
+  // vgroups may be added once the mutex is released, so iterate the list by index
+  for (int32_t i = 0; i < taosArrayGetSize(pWriter->pVgroupList); ++i) {
+    SBulkVgroup *pVgroup = taosArrayGetP(pWriter->pVgroupList, i);
+    if (pVgroup->numOfRows == 0 || (timeout > 0 && now - pVgroup->firstTs < timeout)) {
+      continue;
+    }
+
+    SSqlObj *pNew = tscBulkWriterPrepareSubmit(pWriter, pVgroup, timeout <= 0);
+    if (pNew != NULL) {
+      pthread_mutex_unlock(&pWriter->mutex);
+      tscBulkWriterSend(pNew);
+      pthread_mutex_lock(&pWriter->mutex);
+    }
+  }
+}
+
+static void tscBulkWriterTimer(void *param, void *tmrId) {
+  int64_t      rid = (int64_t)param;
+  SBulkWriter *pWriter = taosAcquireRef(tscBulkWriterRef, rid);
+  if (pWriter == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&pWriter->mutex);
+  if (!pWriter->closed) {
+    tscBulkWriterSubmitAll(pWriter, pWriter->options.flushInterval);
+    taosTmrReset(tscBulkWriterTimer, pWriter->options.flushInterval, (void *)rid, tscTmr, &pWriter->pTimer);
+  }
+  pthread_mutex_unlock(&pWriter->mutex);
+
+  taosReleaseRef(tscBulkWriterRef, rid);
+}
+
+TAOS_BULK_WRITER *taos_bulk_writer_open(TAOS *taos, TAOS_BULK_WRITER_OPTIONS *options) {
+  STscObj *pObj = (STscObj *)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    terrno = TSDB_CODE_TSC_DISCONNECTED;
+    tscError("connection disconnected");
+    return NULL;
+  }
+
+  SBulkWriter *pWriter = calloc(1, sizeof(SBulkWriter));
+  if (pWriter == NULL) {
+    terrno = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    tscError("failed to allocate memory for bulk writer");
+    return NULL;
+  }
+
+  if (options != NULL) {
+    pWriter->options = *options;
+  }
+
+  TAOS_BULK_WRITER_OPTIONS *pOpt = &pWriter->options;
+  if (pOpt->maxRows <= 0) pOpt->maxRows = TSC_BULK_DEFAULT_ROWS;
+  if (pOpt->maxBytes <= 0) pOpt->maxBytes = TSC_BULK_DEFAULT_BYTES;
+  if (pOpt->flushInterval <= 0) pOpt->flushInterval = TSC_BULK_DEFAULT_INTERVAL;
+  if (pOpt->maxInflight <= 0) pOpt->maxInflight = TSC_BULK_DEFAULT_INFLIGHT;
+
+  pWriter->pTscObj = pObj;
+  pthread_mutex_init(&pWriter->metaMutex, NULL);
+  pthread_mutex_init(&pWriter->mutex, NULL);
+  pthread_cond_init(&pWriter->cond, NULL);
+
+  pWriter->pTables = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  pWriter->pVgroups = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, HASH_NO_LOCK);
+  pWriter->pVgroupList = taosArrayInit(64, POINTER_BYTES);
+
+  SSqlObj *pSql = calloc(1, sizeof(SSqlObj));
+  if (pSql != NULL) {
+    tsem_init(&pSql->rspSem, 0, 0);
+    pSql->signature = pSql;
+    pSql->pTscObj = pObj;
+    pSql->maxRetry = TSDB_MAX_REPLICA;
+  }
+
+  pWriter->pSql = pSql;
+
+  if (pWriter->pTables == NULL || pWriter->pVgroups == NULL || pWriter->pVgroupList == NULL || pSql == NULL ||
+      tscAllocPayload(&pSql->cmd, TSDB_DEFAULT_PAYLOAD_SIZE) != TSDB_CODE_SUCCESS ||
+      tscAddQueryInfo(&pSql->cmd) != TSDB_CODE_SUCCESS ||
+      tscAddEmptyMetaInfo(tscGetQueryInfo(&pSql->cmd)) == NULL) {
+    tscFreeBulkWriter(pWriter);
+    terrno = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    tscError("failed to allocate memory for bulk writer");
+    return NULL;
+  }
+
+  pWriter->signature = pWriter;
+  pWriter->rid = taosAddRef(tscBulkWriterRef, pWriter);
+
+  pthread_mutex_lock(&pWriter->mutex);
+  taosTmrReset(tscBulkWriterTimer, pOpt->flushInterval, (void *)pWriter->rid, tscTmr, &pWriter->pTimer);
+  pthread_mutex_unlock(&pWriter->mutex);
+
+  tscDebug("bulk writer:%p is opened, maxRows:%d maxBytes:%d flushInterval:%d maxInflight:%d", pWriter,
+           pOpt->maxRows, pOpt->maxBytes, pOpt->flushInterval, pOpt->maxInflight);
+  return pWriter;
+}
+
+static int32_t tscBulkWriterBindRow(SBulkWriter *pWriter, SBulkTable *pTable, TAOS_BIND *row, SBulkVgroup **ppVgroup) {
+  STableMeta  *pTableMeta = pTable->pTableMeta;
+  SBulkVgroup *pVgroup = tscBulkWriterGetVgroup(pWriter, pTableMeta->vgId);
+  if (pVgroup == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  STableDataBlocks *pBlock = NULL;
+  int32_t code = tscGetDataBlockFromList(pVgroup->pBlocks, pTableMeta->id.uid, TSDB_PAYLOAD_SIZE, sizeof(SSubmitBlk),
+                                         pTableMeta->tableInfo.rowSize, &pTable->name, pTableMeta, &pBlock, NULL);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  if (pBlock->size + pBlock->rowSize > pBlock->nAllocSize) {
+    uint32_t nAllocSize = (uint32_t)((pBlock->size + pBlock->rowSize) * 1.5);
+    char    *tmp = realloc(pBlock->pData, nAllocSize);
+    if (tmp == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    pBlock->pData = tmp;
+    pBlock->nAllocSize = nAllocSize;
+  }
+
+  char *data = pBlock->pData + pBlock->size;
+  for (int32_t i = 0; i < pTable->numOfParams; ++i) {
+    code = tscBindParam(pBlock, data, &pTable->params[i], &row[i]);
+    if (code != TSDB_CODE_SUCCESS) {
+      tscDebug("bulk writer:%p bind column %d of table:%s failed, type mismatch or invalid", pWriter, i,
+               tNameGetTableName(&pTable->name));
+      return code;
+    }
+  }
+
+  SSubmitBlk *pBlk = (SSubmitBlk *)pBlock->pData;
+  tsSetBlockInfo(pBlk, pTableMeta, 1);
+  pBlock->size += pBlock->rowSize;
+
+  if (pVgroup->numOfRows == 0) {
+    pVgroup->firstTs = taosGetTimestampMs();
+  }
+
+  pVgroup->numOfRows += 1;
+  pVgroup->size += pBlock->rowSize;
+
+  if (pVgroup->numOfRows >= pWriter->options.maxRows || pVgroup->size >= pWriter->options.maxBytes ||
+      pBlk->numOfRows >= TSC_BULK_MAX_TABLE_ROWS) {
+    *ppVgroup = pVgroup;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int taos_bulk_writer_append(TAOS_BULK_WRITER *writer, const char *tableName, TAOS_BIND *row) {
+  SBulkWriter *pWriter = writer;
+  if (pWriter == NULL || pWriter->signature != pWriter) {
+    terrno = TSDB_CODE_TSC_DISCONNECTED;
+    return terrno;
+  }
+
+  if (tableName == NULL || row == NULL) {
+    terrno = TSDB_CODE_TSC_INVALID_OPERATION;
+    return terrno;
+  }
+
+  size_t len = strlen(tableName);
+
+  pthread_mutex_lock(&pWriter->mutex);
+
+  SBulkTable **p = taosHashGet(pWriter->pTables, tableName, len);
+  SBulkTable  *pTable = (p != NULL) ? *p : NULL;
+
+  if (pTable == NULL) {
+    // meta may be fetched from mnode, do not block the submit callbacks meanwhile
+    pthread_mutex_unlock(&pWriter->mutex);
+    int32_t code = tscBulkWriterLoadTable(pWriter, tableName, &pTable);
+    if (code != TSDB_CODE_SUCCESS) {
+      terrno = code;
+      return code;
+    }
+
+    pthread_mutex_lock(&pWriter->mutex);
+    p = taosHashGet(pWriter->pTables, tableName, len);
+    if (p != NULL) {
+      tscDestroyBulkTable(pTable);
+      pTable = *p;
+    } else {
+      taosHashPut(pWriter->pTables, tableName, len, &pTable, POINTER_BYTES);
+    }
+  }
+
+  SBulkVgroup *pVgroup = NULL;
+  SSqlObj     *pNew = NULL;
+
+  int32_t code = tscBulkWriterBindRow(pWriter, pTable, row, &pVgroup);
+  if (code == TSDB_CODE_SUCCESS && pVgroup != NULL) {
+    pNew = tscBulkWriterPrepareSubmit(pWriter, pVgroup, true);
+  }
+
+  pthread_mutex_unlock(&pWriter->mutex);
+
+  if (pNew != NULL) {
+    tscBulkWriterSend(pNew);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    terrno = code;
+  }
+
+  return code;
+}
+
+int taos_bulk_writer_flush(TAOS_BULK_WRITER *writer) {
+  SBulkWriter *pWriter = writer;
+  if (pWriter == NULL || pWriter->signature != pWriter) {
+    terrno = TSDB_CODE_TSC_DISCONNECTED;
+    return terrno;
+  }
+
+  pthread_mutex_lock(&pWriter->mutex);
+
+  tscBulkWriterSubmitAll(pWriter, 0);
+  while (pWriter->inflight > 0) {
+    pthread_cond_wait(&pWriter->cond, &pWriter->mutex);
+  }
+
+  int32_t code = pWriter->code;
+  pWriter->code = TSDB_CODE_SUCCESS;
+
+  pthread_mutex_unlock(&pWriter->mutex);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    terrno = code;
+  }
+
+  return code;
+}
+
+void taos_bulk_writer_close(TAOS_BULK_WRITER *writer) {
+  SBulkWriter *pWriter = writer;
+  if (pWriter == NULL || pWriter->signature != pWriter) {
+    return;
+  }
+
+  taos_bulk_writer_flush(writer);
+
+  pthread_mutex_lock(&pWriter->mutex);
+  pWriter->closed = 1;
+  pWriter->signature = NULL;
+  taosTmrStopA(&pWriter->pTimer);
+  pthread_mutex_unlock(&pWriter->mutex);
+
+  tscDebug("bulk writer:%p is closed", pWriter);
+  taosRemoveRef(tscBulkWriterRef, pWriter->rid);
+}
@@ -71,6 +71,8 @@ static int32_t treeComparator(const void *pLeft, const void *pRight, void *param
   }
 }
 
+static int32_t createLoserTreeForMerge(SGlobalMerger **pMerger, SQueryInfo *pQueryInfo);
+
 int32_t tscCreateGlobalMerger(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrderDescriptor *pDesc,
                              SQueryInfo* pQueryInfo, SGlobalMerger **pMerger, int64_t id) {
   if (pMemBuffer == NULL) {
@@ -147,6 +149,7 @@ int32_t tscCreateGlobalMerger(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, t
       ds->filePage.num = 0;
       ds->pageId = 0;
       ds->rowIdx = 0;
+      ds->pSql = NULL;
 
       tscDebug("0x%"PRIx64" load data from disk into memory, orderOfVnode:%d, total:%d", id, i + 1, idx + 1);
       tExtMemBufferLoadData(pMemBuffer[i], &(ds->filePage), j, 0);
@@ -179,6 +182,11 @@ int32_t tscCreateGlobalMerger(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, t
   }
 
   (*pMerger)->numOfBuffer = idx;
+  return createLoserTreeForMerge(pMerger, pQueryInfo);
+}
+
+static int32_t createLoserTreeForMerge(SGlobalMerger **pMerger, SQueryInfo *pQueryInfo) {
+  tExtMemBuffer **pMemBuffer = (*pMerger)->pExtMemBuffer;
 
   SCompareParam *param = malloc(sizeof(SCompareParam));
   if (param == NULL) {
@@ -223,6 +231,193 @@ int32_t tscCreateGlobalMerger(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, t
   return TSDB_CODE_SUCCESS;
 }
 
+bool tscIsStreamGlobalMerge(SSqlObj *pSql, SQueryInfo *pQueryInfo) {
+  // vnodes of an older version return the rows unordered
+  if ((pSql->pTscObj->features & TSDB_CONN_FEATURE_ORDERED_PRJ_LIMIT) == 0) {
+    return false;
+  }
+
+  if (!pQueryInfo->orderProjectQuery || pQueryInfo->vgroupLimit <= 0 ||
+      pQueryInfo->vgroupLimit > TSDB_MAX_ORDERED_PRJ_LIMIT || pQueryInfo->tsBuf != NULL ||
+      pQueryInfo->distinct || pQueryInfo->groupbyExpr.numOfGroupCols > 0 ||
+      pQueryInfo->order.orderColId != PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+    return false;
+  }
+
+  // the vnode sorts its results only if the primary timestamp is in the results, see isOrderedPrjLimitQuery
+  size_t size = tscNumOfExprs(pQueryInfo);
+  for (int32_t i = 0; i < size; ++i) {
+    SExprInfo *pExpr = tscExprGet(pQueryInfo, i);
+    if (pExpr->base.functionId == TSDB_FUNC_PRJ && pExpr->base.colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// load the next rows retrieved by the subquery into the page of the data source
+static void loadNewDataFromSubquery(SGlobalMerger *pMerger, SLocalDataSource *pOneInterDataSrc,
+                                    bool *needAdjustLoserTree) {
+  SSqlRes      *pRes = &pOneInterDataSrc->pSql->res;
+  SColumnModel *pModel = pOneInterDataSrc->pMemBuffer->pColumnModel;
+
+  if (pOneInterDataSrc->resIdx < pRes->numOfRows) {
+    int32_t numOfRows = MIN(pRes->numOfRows - pOneInterDataSrc->resIdx, pModel->capacity);
+
+    pOneInterDataSrc->filePage.num = 0;
+    tColModelAppend(pModel, &pOneInterDataSrc->filePage, pRes->data, pOneInterDataSrc->resIdx, numOfRows,
+                    pRes->numOfRows);
+
+    pOneInterDataSrc->resIdx += numOfRows;
+    pOneInterDataSrc->rowIdx = 0;
+    *needAdjustLoserTree = true;
+  } else if (pRes->completed || pRes->numOfRows == 0) {
+    pMerger->numOfCompleted += 1;
+
+    pOneInterDataSrc->rowIdx = -1;
+    *needAdjustLoserTree = true;
+  } else {  // the loser tree is adjusted after the next block is retrieved
+    pMerger->pPendingSrc = pOneInterDataSrc;
+    *needAdjustLoserTree = false;
+  }
+}
+
+int32_t tscCreateStreamGlobalMerger(SSqlObj *pSql, tExtMemBuffer **pMemBuffer, tOrderDescriptor *pDesc,
+                                    SGlobalMerger **pMerger) {
+  SQueryInfo *pQueryInfo = tscGetQueryInfo(&pSql->cmd);
+  int32_t     numOfSub = pSql->subState.numOfSub;
+
+  int32_t numOfSrc = 0;
+  for (int32_t i = 0; i < numOfSub; ++i) {
+    if (pSql->pSubs[i]->res.numOfRows > 0) {
+      numOfSrc += 1;
+    }
+  }
+
+  if (numOfSrc == 0) {
+    tscDestroyGlobalMergerEnv(pMemBuffer, pDesc, numOfSub);
+    tscDebug("0x%"PRIx64" retrieved no data", pSql->self);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  *pMerger = (SGlobalMerger *) calloc(1, sizeof(SGlobalMerger));
+  if ((*pMerger) == NULL) {
+    tscError("0x%"PRIx64" failed to create local merge structure, out of memory", pSql->self);
+
+    tscDestroyGlobalMergerEnv(pMemBuffer, pDesc, numOfSub);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  (*pMerger)->pExtMemBuffer = pMemBuffer;
+  (*pMerger)->numOfVnode = numOfSub;
+  (*pMerger)->pDesc = pDesc;
+  (*pMerger)->maxRows = pQueryInfo->vgroupLimit;
+
+  (*pMerger)->pLocalDataSrc = calloc(numOfSrc, POINTER_BYTES);
+  if ((*pMerger)->pLocalDataSrc == NULL) {
+    tscError("0x%"PRIx64" failed to create merge structure, out of memory", pSql->self);
+    tscDestroyGlobalMerger(*pMerger);
+    *pMerger = NULL;
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  int32_t idx = 0;
+  for (int32_t i = 0; i < numOfSub; ++i) {
+    SSqlObj *pSub = pSql->pSubs[i];
+    if (pSub->res.numOfRows == 0) {
+      continue;
+    }
+
+    SLocalDataSource *ds = (SLocalDataSource *)malloc(sizeof(SLocalDataSource) + pMemBuffer[0]->pageSize);
+    if (ds == NULL) {
+      tscError("0x%"PRIx64" failed to create merge structure, out of memory", pSql->self);
+      (*pMerger)->numOfBuffer = idx;  // the sources created are freed with the merger
+      tscDestroyGlobalMerger(*pMerger);
+      *pMerger = NULL;
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    (*pMerger)->pLocalDataSrc[idx++] = ds;
+
+    ds->pMemBuffer = pMemBuffer[i];
+    ds->flushoutIdx = -1;
+    ds->pageId = -1;
+    ds->pSql = pSub;
+    ds->resIdx = 0;
+    ds->filePage.num = 0;
+
+    bool needAdjust = false;
+    loadNewDataFromSubquery(*pMerger, ds, &needAdjust);
+  }
+
+  (*pMerger)->numOfBuffer = idx;
+  tscDebug("0x%"PRIx64" the number of merged leaves is: %d, merge at most %"PRId64" rows", pSql->self, idx,
+           (*pMerger)->maxRows);
+
+  return createLoserTreeForMerge(pMerger, pQueryInfo);
+}
+
+static void tscRetrieveMergeSourceCallback(void *param, TAOS_RES *tres, int numOfRows) {
+  SSqlObj *pSub = (SSqlObj *)tres;
+  int64_t  rid = (int64_t)param;
+
+  SSqlObj *pSql = (SSqlObj *)taosAcquireRef(tscObjRef, rid);
+  if (pSql == NULL) {
+    tscDebug("0x%"PRIx64" already released, sub:0x%"PRIx64" retrieved rows are discarded", rid, pSub->self);
+    return;
+  }
+
+  SSqlRes       *pRes = &pSql->res;
+  SGlobalMerger *pMerger = pRes->pMerger;
+
+  if (numOfRows < 0) {
+    atomic_val_compare_exchange_32(&pRes->code, TSDB_CODE_SUCCESS, numOfRows);
+  }
+
+  // a fetch is sent only for the pending source, the merge must not have been freed or resumed without it
+  if (pMerger == NULL || pMerger->pPendingSrc == NULL) {
+    atomic_val_compare_exchange_32(&pRes->code, TSDB_CODE_SUCCESS, TSDB_CODE_TSC_APP_ERROR);
+  }
+
+  if (pRes->code != TSDB_CODE_SUCCESS) {
+    tscError("0x%"PRIx64" sub:0x%"PRIx64" failed to retrieve data for global merge, code:%s", pSql->self,
+             pSub->self, tstrerror(pRes->code));
+    tscAsyncResultOnError(pSql);
+    taosReleaseRef(tscObjRef, rid);
+    return;
+  }
+
+  SLocalDataSource *pOneInterDataSrc = pMerger->pPendingSrc;
+  assert(pOneInterDataSrc->pSql == pSub);
+
+  tscDebug("0x%"PRIx64" sub:0x%"PRIx64" retrieve numOfRows:%d for global merge, completed:%d", pSql->self,
+           pSub->self, numOfRows, pSub->res.completed);
+
+  pMerger->pPendingSrc = NULL;
+  pOneInterDataSrc->resIdx = 0;
+
+  bool needToAdjust = true;
+  loadNewDataFromSubquery(pMerger, pOneInterDataSrc, &needToAdjust);
+  assert(needToAdjust);
+
+  // the source is still the winner of the loser tree since it has become pending
+  SLoserTreeInfo *pTree = pMerger->pLoserTree;
+  tLoserTreeAdjust(pTree, pTree->pNode[0].index + pMerger->numOfBuffer);
+
+  tscBuildAndSendRequest(pSql, NULL);
+  taosReleaseRef(tscObjRef, rid);
+}
+
+void tscFetchGlobalMergeSource(SSqlObj *pSql) {
+  SLocalDataSource *pOneInterDataSrc = pSql->res.pMerger->pPendingSrc;
+  assert(pOneInterDataSrc != NULL && pOneInterDataSrc->pSql != NULL);
+
+  tscDebug("0x%"PRIx64" sub:0x%"PRIx64" retrieved rows are all merged, fetch more from vnode", pSql->self,
+           pOneInterDataSrc->pSql->self);
+  taos_fetch_rows_a(pOneInterDataSrc->pSql, tscRetrieveMergeSourceCallback, (void *)pSql->self);
+}
+
 static int32_t tscFlushTmpBufferImpl(tExtMemBuffer *pMemoryBuf, tOrderDescriptor *pDesc, tFilePage *pPage,
                                      int32_t orderType) {
   if (pPage->num == 0) {
@@ -525,7 +720,11 @@ void adjustLoserTreeFromNewData(SGlobalMerger *pMerger, SLocalDataSource *pOneIn
    */
   bool needToAdjust = true;
   if (pOneInterDataSrc->filePage.num <= pOneInterDataSrc->rowIdx) {
-    loadNewDataFromDiskFor(pMerger, pOneInterDataSrc, &needToAdjust);
+    if (pOneInterDataSrc->pSql != NULL) {
+      loadNewDataFromSubquery(pMerger, pOneInterDataSrc, &needToAdjust);
+    } else {
+      loadNewDataFromDiskFor(pMerger, pOneInterDataSrc, &needToAdjust);
+    }
   }
 
   /*
@@ -774,6 +973,11 @@ SSDataBlock* doMultiwayMergeSort(void* param, bool* newgroup) {
       break;
     }
 
+    // the chosen source needs the next block from its vnode, return the merged rows so far
+    if (pMerger->pPendingSrc != NULL) {
+      return (pInfo->binfo.pRes->info.rows > 0)? pInfo->binfo.pRes:NULL;
+    }
+
 #ifdef _DEBUG_VIEW
     printf("chosen data in pTree[0] = %d\n", pTree->pNode[0].index);
 #endif
@@ -839,6 +1043,13 @@ SSDataBlock* doMultiwayMergeSort(void* param, bool* newgroup) {
 #endif
 
     pOneDataSrc->rowIdx += 1;
+    pMerger->numOfMerged += 1;
+
+    // the remain rows of all sources are not required anymore
+    if (pMerger->maxRows > 0 && pMerger->numOfMerged >= pMerger->maxRows) {
+      break;
+    }
+
     adjustLoserTreeFromNewData(pMerger, pOneDataSrc, pTree);
 
     if (pInfo->binfo.pRes->info.rows >= pInfo->bufCapacity) {
@@ -2,6 +2,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "os.h"
 #include "osString.h"
@@ -745,112 +748,6 @@ static int32_t creatChildTableIfNotExists(TAOS* taos, const char* cTableName, co
   return code;
 }
 
-static int32_t insertChildTableBatch(TAOS* taos,  char* cTableName, SArray* colsSchema, SArray* rowsBind, SSmlLinesInfo* info) {
-  size_t numCols = taosArrayGetSize(colsSchema);
-  char* sql = malloc(tsMaxSQLStringLen+1);
-  if (sql == NULL) {
-    tscError("malloc sql memory error");
-    return TSDB_CODE_TSC_OUT_OF_MEMORY;
-  }
-
-  int32_t freeBytes = tsMaxSQLStringLen + 1 ;
-  sprintf(sql, "insert into ? (");
-
-  for (int i = 0; i < numCols; ++i) {
-    SSchema* colSchema = taosArrayGet(colsSchema, i);
-    snprintf(sql+strlen(sql), freeBytes-strlen(sql), "%s,", colSchema->name);
-  }
-  snprintf(sql + strlen(sql)-1, freeBytes-strlen(sql)+1, ") values (");
-
-  for (int i = 0; i < numCols; ++i) {
-    snprintf(sql+strlen(sql), freeBytes-strlen(sql), "?,");
-  }
-  snprintf(sql + strlen(sql)-1, freeBytes-strlen(sql)+1, ")");
-  sql[strlen(sql)] = '\0';
-
-  tscDebug("SML:0x%"PRIx64" insert rows into child table %s. num of rows: %zu", info->id, cTableName, taosArrayGetSize(rowsBind));
-
-  int32_t code = 0;
-
-  TAOS_STMT* stmt = taos_stmt_init(taos);
-  if (stmt == NULL) {
-    tfree(sql);
-    return TSDB_CODE_TSC_OUT_OF_MEMORY;
-  }
-
-  code = taos_stmt_prepare(stmt, sql, (unsigned long)strlen(sql));
-  tfree(sql);
-
-  if (code != 0) {
-    tscError("SML:0x%"PRIx64" taos_stmt_prepare return %d:%s", info->id, code, tstrerror(code));
-    taos_stmt_close(stmt);
-    return code;
-  }
-
-  bool tryAgain = false;
-  int32_t try = 0;
-  do {
-    code = taos_stmt_set_tbname(stmt, cTableName);
-    if (code != 0) {
-      tscError("SML:0x%"PRIx64" taos_stmt_set_tbname return %d:%s", info->id, code, tstrerror(code));
-      taos_stmt_close(stmt);
-      return code;
-    }
-
-    size_t rows = taosArrayGetSize(rowsBind);
-    for (int32_t i = 0; i < rows; ++i) {
-      TAOS_BIND* colsBinds = taosArrayGetP(rowsBind, i);
-      code = taos_stmt_bind_param(stmt, colsBinds);
-      if (code != 0) {
-        tscError("SML:0x%"PRIx64" taos_stmt_bind_param return %d:%s", info->id, code, tstrerror(code));
-        taos_stmt_close(stmt);
-        return code;
-      }
-      code = taos_stmt_add_batch(stmt);
-      if (code != 0) {
-        tscError("SML:0x%"PRIx64" taos_stmt_add_batch return %d:%s", info->id, code, tstrerror(code));
-        taos_stmt_close(stmt);
-        return code;
-      }
-    }
-
-    code = taos_stmt_execute(stmt);
-    if (code != 0) {
-      tscError("SML:0x%"PRIx64" taos_stmt_execute return %d:%s, try:%d", info->id, code, tstrerror(code), try);
-    }
-
-    tryAgain = false;
-    if ((code == TSDB_CODE_TDB_INVALID_TABLE_ID
-        || code == TSDB_CODE_VND_INVALID_VGROUP_ID
-        || code == TSDB_CODE_TDB_TABLE_RECONFIGURE
-        || code == TSDB_CODE_APP_NOT_READY
-        || code == TSDB_CODE_RPC_NETWORK_UNAVAIL) && try++ < TSDB_MAX_REPLICA) {
-      tryAgain = true;
-    }
-
-    if (code == TSDB_CODE_TDB_INVALID_TABLE_ID || code == TSDB_CODE_VND_INVALID_VGROUP_ID) {
-      TAOS_RES* res2 = taos_query(taos, "RESET QUERY CACHE");
-      int32_t   code2 = taos_errno(res2);
-      if (code2 != TSDB_CODE_SUCCESS) {
-        tscError("SML:0x%" PRIx64 " insert child table. reset query cache. error: %s", info->id, taos_errstr(res2));
-      }
-      taos_free_result(res2);
-      if (tryAgain) {
-        taosMsleep(50 * (2 << try));
-      }
-    }
-    if (code == TSDB_CODE_APP_NOT_READY || code == TSDB_CODE_RPC_NETWORK_UNAVAIL) {
-      if (tryAgain) {
-        taosMsleep( 50 * (2 << try));
-      }
-    }
-  } while (tryAgain);
-
-
-  taos_stmt_close(stmt);
-  return code;
-}
-
 static int32_t arrangePointsByChildTableName(TAOS_SML_DATA_POINT* points, int numPoints,
                                              SHashObj* cname2points, SArray* stableSchemas, SSmlLinesInfo* info) {
   for (int32_t i = 0; i < numPoints; ++i) {
@@ -940,104 +837,428 @@ static int32_t applyChildTableTags(TAOS* taos, char* cTableName, char* sTableNam
   return code;
 }
 
-static int32_t applyChildTableFields(TAOS* taos, SSmlSTableSchema* sTableSchema, char* cTableName,
-                                     SArray* cTablePoints, SSmlLinesInfo* info) {
+static int32_t getSmlTableFullName(SSqlObj* pSql, char* tableName, char* fullName) {
+  char tableNameLowerCase[TSDB_TABLE_NAME_LEN];
+  strtolower(tableNameLowerCase, tableName);
+
+  SStrToken tableToken = {.z = tableNameLowerCase, .n = (uint32_t)strlen(tableNameLowerCase), .type = TK_ID};
+  tGetToken(tableNameLowerCase, &tableToken.type);
+  if (tscValidateName(&tableToken) != TSDB_CODE_SUCCESS) {
+    return TSDB_CODE_TSC_INVALID_TABLE_ID_LENGTH;
+  }
+
+  SName sname = {0};
+  int32_t code = tscSetTableFullName(&sname, &tableToken, pSql);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  return tNameExtractFullName(&sname, fullName);
+}
+
+static bool isSmlTableMetaCached(SSqlObj* pSql, char* tableName) {
+  char fullName[TSDB_TABLE_FNAME_LEN] = {0};
+  if (getSmlTableFullName(pSql, tableName, fullName) != TSDB_CODE_SUCCESS) {
+    return false;
+  }
+
+  return taosHashGet(tscTableMetaMap, fullName, strlen(fullName)) != NULL;
+}
+
+// map the fields of the point schema to the columns of super table, the column order is needed to encode rows
+static int32_t buildSmlColumnIndex(TAOS* taos, SSqlObj* pSql, SSmlSTableSchema* sTableSchema, int32_t** pColIndex,
+                                   int32_t* numOfCols, SSmlLinesInfo* info) {
+  char fullName[TSDB_TABLE_FNAME_LEN] = {0};
+  STableMeta* tableMeta = NULL;
+  size_t size = 0;
+
+  int32_t code = getSmlTableFullName(pSql, sTableSchema->sTableName, fullName);
+  if (code == TSDB_CODE_SUCCESS) {
+    taosHashGetCloneExt(tscTableMetaMap, fullName, strlen(fullName), NULL, (void**)&tableMeta, &size);
+  }
+
+  // schema altered just now, the cached meta has been removed
+  if (tableMeta == NULL) {
+    code = retrieveTableMeta(taos, sTableSchema->sTableName, &tableMeta, info);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  size_t numFields = taosArrayGetSize(sTableSchema->fields);
+  int32_t* colIndex = malloc(numFields * sizeof(int32_t));
+  if (colIndex == NULL) {
+    free(tableMeta);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < numFields; ++i) {
+    SSchema* field = taosArrayGet(sTableSchema->fields, i);
+    colIndex[i] = -1;
+    for (int32_t j = 0; j < tableMeta->tableInfo.numOfColumns; ++j) {
+      if (strcasecmp(field->name, tableMeta->schema[j].name) == 0) {
+        colIndex[i] = j;
+        break;
+      }
+    }
+
+    if (colIndex[i] < 0) {
+      tscError("SML:0x%"PRIx64" column %s not found in super table %s", info->id, field->name, sTableSchema->sTableName);
+      free(colIndex);
+      free(tableMeta);
+      return TSDB_CODE_TSC_INVALID_OPERATION;
+    }
+  }
+
+  *numOfCols = tableMeta->tableInfo.numOfColumns;
+  *pColIndex = colIndex;
+  free(tableMeta);
+  return TSDB_CODE_SUCCESS;
+}
+
+// quotes and backslashes are escaped differently by the parser of tag values, leave such tags to stmt
+static bool appendSmlTagValue(SStringBuilder* sb, TAOS_SML_KV* kv) {
+  if (kv == NULL) {
+    taosStringBuilderAppendStringLen(sb, "NULL", 4);
+    return true;
+  }
+
+  char buf[64] = {0};
+  switch (kv->type) {
+    case TSDB_DATA_TYPE_BOOL:
+      snprintf(buf, sizeof(buf), "%s", (*(int8_t*)kv->value) ? "true" : "false");
+      break;
+    case TSDB_DATA_TYPE_TINYINT:
+      snprintf(buf, sizeof(buf), "%d", *(int8_t*)kv->value);
+      break;
+    case TSDB_DATA_TYPE_UTINYINT:
+      snprintf(buf, sizeof(buf), "%u", *(uint8_t*)kv->value);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      snprintf(buf, sizeof(buf), "%d", *(int16_t*)kv->value);
+      break;
+    case TSDB_DATA_TYPE_USMALLINT:
+      snprintf(buf, sizeof(buf), "%u", *(uint16_t*)kv->value);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      snprintf(buf, sizeof(buf), "%d", *(int32_t*)kv->value);
+      break;
+    case TSDB_DATA_TYPE_UINT:
+      snprintf(buf, sizeof(buf), "%u", *(uint32_t*)kv->value);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      snprintf(buf, sizeof(buf), "%"PRId64, *(int64_t*)kv->value);
+      break;
+    case TSDB_DATA_TYPE_UBIGINT:
+      snprintf(buf, sizeof(buf), "%"PRIu64, *(uint64_t*)kv->value);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      if (!isfinite(*(float*)kv->value)) return false;
+      snprintf(buf, sizeof(buf), "%.9g", *(float*)kv->value);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      if (!isfinite(*(double*)kv->value)) return false;
+      snprintf(buf, sizeof(buf), "%.17g", *(double*)kv->value);
+      break;
+    case TSDB_DATA_TYPE_BINARY:
+    case TSDB_DATA_TYPE_NCHAR:
+      for (int32_t i = 0; i < kv->length; ++i) {
+        if (kv->value[i] == '\'' || kv->value[i] == '\\' || kv->value[i] == 0) {
+          return false;
+        }
+      }
+      taosStringBuilderAppendChar(sb, '\'');
+      taosStringBuilderAppendStringLen(sb, kv->value, kv->length);
+      taosStringBuilderAppendChar(sb, '\'');
+      return true;
+    default:
+      return false;
+  }
+
+  taosStringBuilderAppendString(sb, buf);
+  return true;
+}
+
+static int32_t executeSmlCreateTables(TAOS* taos, SStringBuilder* sb, int32_t numOfTables, SSmlLinesInfo* info) {
+  char* sql = taosStringBuilderGetResult(sb, NULL);
+  tscDebug("SML:0x%"PRIx64" create %d child tables: %s", info->id, numOfTables, sql);
+
+  TAOS_RES* res = taos_query(taos, sql);
+  int32_t code = taos_errno(res);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("SML:0x%"PRIx64" create %d child tables failed: %s", info->id, numOfTables, taos_errstr(res));
+  }
+  taos_free_result(res);
+
+  sb->pos = 0;
+  return code;
+}
+
+static int32_t loadSmlChildTableMeta(TAOS* taos, SStringBuilder* sb, SSmlLinesInfo* info) {
+  char* names = taosStringBuilderGetResult(sb, NULL);
+  int32_t code = taos_load_table_info(taos, names);
+  if (code != TSDB_CODE_SUCCESS) {
+    // tables not loaded here are loaded one by one when written
+    tscWarn("SML:0x%"PRIx64" load child table meta failed: %s", info->id, tstrerror(code));
+  }
+
+  sb->pos = 0;
+  return code;
+}
+
+/*
+ * Child tables whose meta is not cached yet are created by batched "create table if not exists" sql, and their
+ * meta is then loaded in batch, so that rows can be encoded into submit blocks directly.
+ */
+static int32_t createSmlChildTables(TAOS* taos, SSqlObj* pSql, SHashObj* cname2points, SArray* stableSchemas,
+                                    SSmlLinesInfo* info) {
   int32_t code = TSDB_CODE_SUCCESS;
+  int32_t numOfTables = 0;
+  SStringBuilder sqlBuilder = {0};
+  SStringBuilder nameBuilder = {0};
+  SStringBuilder tableBuilder = {0};
 
-  size_t numCols = taosArrayGetSize(sTableSchema->fields);
-  size_t rows = taosArrayGetSize(cTablePoints);
-  SArray* rowsBind = taosArrayInit(rows, POINTER_BYTES);
+  SArray** pCTablePoints = taosHashIterate(cname2points, NULL);
+  while (pCTablePoints) {
+    SArray* cTablePoints = *pCTablePoints;
+    pCTablePoints = taosHashIterate(cname2points, pCTablePoints);
 
-  for (int i = 0; i < rows; ++i) {
-    TAOS_SML_DATA_POINT* point = taosArrayGetP(cTablePoints, i);
+    TAOS_SML_DATA_POINT* point = taosArrayGetP(cTablePoints, 0);
+    if (isSmlTableMetaCached(pSql, point->childTableName)) {
+      continue;
+    }
 
-    TAOS_BIND* colBinds = calloc(numCols, sizeof(TAOS_BIND));
-    if (colBinds == NULL) {
-      tscError("SML:0x%"PRIx64" taos_sml_insert insert points, failed to allocated memory for TAOS_BIND, "
-               "num of rows: %zu, num of cols: %zu", info->id, rows, numCols);
-      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    uintptr_t valPointer = (uintptr_t)point;
+    size_t* pSchemaIndex = taosHashGet(info->smlDataToSchema, &valPointer, sizeof(uintptr_t));
+    assert(pSchemaIndex != NULL);
+    SSmlSTableSchema* sTableSchema = taosArrayGet(stableSchemas, *pSchemaIndex);
+
+    TAOS_SML_KV* tagKVs[TSDB_MAX_TAGS] = {0};
+    size_t rows = taosArrayGetSize(cTablePoints);
+    for (int i = 0; i < rows; ++i) {
+      TAOS_SML_DATA_POINT* pDataPoint = taosArrayGetP(cTablePoints, i);
+      for (int j = 0; j < pDataPoint->tagNum; ++j) {
+        TAOS_SML_KV* kv = pDataPoint->tags + j;
+        uintptr_t kvPointer = (uintptr_t)kv;
+        size_t* pTagSchemaIdx = taosHashGet(info->smlDataToSchema, &kvPointer, sizeof(uintptr_t));
+        assert(pTagSchemaIdx != NULL);
+        tagKVs[*pTagSchemaIdx] = kv;
+      }
+    }
+
+    size_t numTags = taosArrayGetSize(sTableSchema->tags);
+    tableBuilder.pos = 0;
+    taosStringBuilderAppendString(&tableBuilder, " if not exists ");
+    taosStringBuilderAppendString(&tableBuilder, point->childTableName);
+    taosStringBuilderAppendString(&tableBuilder, " using ");
+    taosStringBuilderAppendString(&tableBuilder, point->stableName);
+    taosStringBuilderAppendString(&tableBuilder, " (");
+    for (int j = 0; j < numTags; ++j) {
+      SSchema* tagSchema = taosArrayGet(sTableSchema->tags, j);
+      if (j > 0) taosStringBuilderAppendChar(&tableBuilder, ',');
+      taosStringBuilderAppendString(&tableBuilder, tagSchema->name);
+    }
+    taosStringBuilderAppendString(&tableBuilder, ") tags (");
+
+    bool inlined = true;
+    for (int j = 0; j < numTags && inlined; ++j) {
+      if (j > 0) taosStringBuilderAppendChar(&tableBuilder, ',');
+      inlined = appendSmlTagValue(&tableBuilder, tagKVs[j]);
+    }
+    taosStringBuilderAppendChar(&tableBuilder, ')');
+
+    if (!inlined) {
+      tscDebug("SML:0x%"PRIx64" apply child table tags by stmt. child table: %s", info->id, point->childTableName);
+      code = applyChildTableTags(taos, point->childTableName, point->stableName, sTableSchema, cTablePoints, info);
+      if (code != TSDB_CODE_SUCCESS) {
+        tscError("SML:0x%"PRIx64" apply child table tags failed. child table %s, error %s", info->id,
+                 point->childTableName, tstrerror(code));
+        goto _end;
+      }
+    } else {
+      if (sqlBuilder.pos > 0 && sqlBuilder.pos + tableBuilder.pos >= tsMaxSQLStringLen) {
+        code = executeSmlCreateTables(taos, &sqlBuilder, numOfTables, info);
+        if (code != TSDB_CODE_SUCCESS) goto _end;
+        numOfTables = 0;
+      }
+
+      if (sqlBuilder.pos == 0) {
+        taosStringBuilderAppendString(&sqlBuilder, "create table");
+      }
+      taosStringBuilderAppendStringLen(&sqlBuilder, tableBuilder.buf, tableBuilder.pos);
+      numOfTables += 1;
     }
 
-    int isNullColBind = TSDB_TRUE;
-    for (int j = 0; j < numCols; ++j) {
-      TAOS_BIND* bind = colBinds + j;
-      bind->is_null = &isNullColBind;
+    if (nameBuilder.pos > 0) taosStringBuilderAppendChar(&nameBuilder, ',');
+    taosStringBuilderAppendString(&nameBuilder, point->childTableName);
+  }
+
+  if (numOfTables > 0) {
+    code = executeSmlCreateTables(taos, &sqlBuilder, numOfTables, info);
+    if (code != TSDB_CODE_SUCCESS) goto _end;
+  }
+
+  if (nameBuilder.pos > 0) {
+    loadSmlChildTableMeta(taos, &nameBuilder, info);
+  }
+
+_end:
+  taosStringBuilderDestroy(&sqlBuilder);
+  taosStringBuilderDestroy(&nameBuilder);
+  taosStringBuilderDestroy(&tableBuilder);
+  return code;
+}
+
+static int32_t writeSmlDataPoints(TAOS* taos, SSqlObj* pSql, TAOS_SML_DATA_POINT* points, int32_t numPoints,
+                                  SArray* stableSchemas, SSmlLinesInfo* info) {
+  int32_t code = TSDB_CODE_SUCCESS;
+  size_t  numStables = taosArrayGetSize(stableSchemas);
+
+  int32_t** colIndex = calloc(numStables, POINTER_BYTES);
+  int32_t*  numOfCols = calloc(numStables, sizeof(int32_t));
+  int32_t   maxCols = 0;
+  if (colIndex == NULL || numOfCols == NULL) {
+    code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    goto _end;
+  }
+
+  for (int32_t i = 0; i < numStables; ++i) {
+    code = buildSmlColumnIndex(taos, pSql, taosArrayGet(stableSchemas, i), &colIndex[i], &numOfCols[i], info);
+    if (code != TSDB_CODE_SUCCESS) goto _end;
+    maxCols = MAX(maxCols, numOfCols[i]);
+  }
+
+  // flushed once all points are appended, so each vgroup gets one submit and all of them are sent concurrently
+  TAOS_BULK_WRITER_OPTIONS options = {0};
+  options.maxRows = numPoints;
+  options.maxBytes = TSDB_MAX_WAL_SIZE;
+  options.flushInterval = INT32_MAX;
+  options.maxInflight = 1;
+
+  TAOS_BULK_WRITER* writer = taos_bulk_writer_open(taos, &options);
+  if (writer == NULL) {
+    code = terrno;
+    goto _end;
+  }
+
+  TAOS_BIND* colBinds = calloc(maxCols, sizeof(TAOS_BIND));
+  uintptr_t* lengths = calloc(maxCols, sizeof(uintptr_t));
+  int        isNullColBind = TSDB_TRUE;
+  if (colBinds == NULL || lengths == NULL) {
+    code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < numPoints && code == TSDB_CODE_SUCCESS; ++i) {
+    TAOS_SML_DATA_POINT* point = points + i;
+    uintptr_t valPointer = (uintptr_t)point;
+    size_t* pSchemaIndex = taosHashGet(info->smlDataToSchema, &valPointer, sizeof(uintptr_t));
+    assert(pSchemaIndex != NULL);
+
+    for (int j = 0; j < numOfCols[*pSchemaIndex]; ++j) {
+      colBinds[j].is_null = &isNullColBind;
     }
+
     for (int j = 0; j < point->fieldNum; ++j) {
       TAOS_SML_KV* kv = point->fields + j;
-      uintptr_t valPointer = (uintptr_t)kv;
-      size_t* pFieldSchemaIdx = taosHashGet(info->smlDataToSchema, &valPointer, sizeof(uintptr_t));
+      uintptr_t kvPointer = (uintptr_t)kv;
+      size_t* pFieldSchemaIdx = taosHashGet(info->smlDataToSchema, &kvPointer, sizeof(uintptr_t));
       assert(pFieldSchemaIdx != NULL);
-      TAOS_BIND* bind = colBinds + *pFieldSchemaIdx;
+
+      int32_t col = colIndex[*pSchemaIndex][*pFieldSchemaIdx];
+      TAOS_BIND* bind = colBinds + col;
       bind->buffer_type = kv->type;
-      bind->length = malloc(sizeof(uintptr_t*));
-      *bind->length = kv->length;
       bind->buffer = kv->value;
+      lengths[col] = kv->length;
+      bind->length = &lengths[col];
       bind->is_null = NULL;
     }
-    taosArrayPush(rowsBind, &colBinds);
+
+    code = taos_bulk_writer_append(writer, point->childTableName, colBinds);
+    if (code != TSDB_CODE_SUCCESS) {
+      tscError("SML:0x%"PRIx64" encode point into child table %s failed. error %s", info->id, point->childTableName,
+               tstrerror(code));
+    }
   }
 
-  code = insertChildTableBatch(taos, cTableName, sTableSchema->fields, rowsBind, info);
-  if (code != 0) {
-    tscError("SML:0x%"PRIx64" insert into child table %s failed. error %s", info->id, cTableName, tstrerror(code));
+  int32_t flushCode = taos_bulk_writer_flush(writer);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = flushCode;
   }
 
-  for (int i = 0; i < rows; ++i) {
-    TAOS_BIND* colBinds = taosArrayGetP(rowsBind, i);
-    for (int j = 0; j < numCols; ++j) {
-      TAOS_BIND* bind = colBinds + j;
-      free(bind->length);
-    }
-    free(colBinds);
+  taos_bulk_writer_close(writer);
+  tfree(colBinds);
+  tfree(lengths);
+
+_end:
+  for (int32_t i = 0; colIndex != NULL && i < numStables; ++i) {
+    tfree(colIndex[i]);
   }
-  taosArrayDestroy(rowsBind);
+  tfree(colIndex);
+  tfree(numOfCols);
   return code;
 }
 
 static int32_t applyDataPoints(TAOS* taos, TAOS_SML_DATA_POINT* points, int32_t numPoints, SArray* stableSchemas, SSmlLinesInfo* info) {
   int32_t code = TSDB_CODE_SUCCESS;
 
+  SSqlObj* pSql = calloc(1, sizeof(SSqlObj));
+  if (pSql == NULL || tscAllocPayload(&pSql->cmd, TSDB_DEFAULT_PAYLOAD_SIZE) != TSDB_CODE_SUCCESS) {
+    tfree(pSql);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+  pSql->pTscObj = taos;
+  pSql->signature = pSql;
+
   SHashObj* cname2points = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, false);
   arrangePointsByChildTableName(points, numPoints, cname2points, stableSchemas, info);
 
-  SArray** pCTablePoints = taosHashIterate(cname2points, NULL);
-  while (pCTablePoints) {
-    SArray* cTablePoints = *pCTablePoints;
-
-    TAOS_SML_DATA_POINT* point = taosArrayGetP(cTablePoints, 0);
-    uintptr_t valPointer = (uintptr_t)point;
-    size_t* pSchemaIndex = taosHashGet(info->smlDataToSchema, &valPointer, sizeof(uintptr_t));
-    assert(pSchemaIndex != NULL);
-    SSmlSTableSchema*    sTableSchema = taosArrayGet(stableSchemas, *pSchemaIndex);
+  int32_t try = 0;
+  bool tryAgain = false;
+  do {
+    tscDebug("SML:0x%"PRIx64" create child tables, try:%d", info->id, try);
+    code = createSmlChildTables(taos, pSql, cname2points, stableSchemas, info);
+    if (code == TSDB_CODE_SUCCESS) {
+      tscDebug("SML:0x%"PRIx64" write %d points, try:%d", info->id, numPoints, try);
+      code = writeSmlDataPoints(taos, pSql, points, numPoints, stableSchemas, info);
+    }
 
-    tscDebug("SML:0x%"PRIx64" apply child table tags. child table: %s", info->id, point->childTableName);
-    code = applyChildTableTags(taos, point->childTableName, point->stableName, sTableSchema, cTablePoints, info);
-    if (code != 0) {
-      tscError("apply child table tags failed. child table %s, error %s", point->childTableName, tstrerror(code));
-      goto cleanup;
+    // rows already written are overwritten by the same ones when tried again
+    tryAgain = false;
+    if ((code == TSDB_CODE_TDB_INVALID_TABLE_ID
+        || code == TSDB_CODE_VND_INVALID_VGROUP_ID
+        || code == TSDB_CODE_TDB_TABLE_RECONFIGURE
+        || code == TSDB_CODE_APP_NOT_READY
+        || code == TSDB_CODE_RPC_NETWORK_UNAVAIL) && try++ < TSDB_MAX_REPLICA) {
+      tryAgain = true;
     }
 
-    tscDebug("SML:0x%"PRIx64" apply child table points. child table: %s", info->id, point->childTableName);
-    code = applyChildTableFields(taos, sTableSchema, point->childTableName, cTablePoints, info);
-    if (code != 0) {
-      tscError("SML:0x%"PRIx64" Apply child table fields failed. child table %s, error %s", info->id, point->childTableName, tstrerror(code));
-      goto cleanup;
+    if (code == TSDB_CODE_TDB_INVALID_TABLE_ID || code == TSDB_CODE_VND_INVALID_VGROUP_ID) {
+      TAOS_RES* res2 = taos_query(taos, "RESET QUERY CACHE");
+      int32_t   code2 = taos_errno(res2);
+      if (code2 != TSDB_CODE_SUCCESS) {
+        tscError("SML:0x%" PRIx64 " apply data points. reset query cache. error: %s", info->id, taos_errstr(res2));
+      }
+      taos_free_result(res2);
     }
 
-    tscDebug("SML:0x%"PRIx64" successfully applied data points of child table %s", info->id, point->childTableName);
+    if (tryAgain) {
+      taosMsleep(50 * (2 << try));
+    }
+  } while (tryAgain);
 
-    pCTablePoints = taosHashIterate(cname2points, pCTablePoints);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("SML:0x%"PRIx64" apply data points failed. error %s", info->id, tstrerror(code));
   }
 
-cleanup:
-  pCTablePoints = taosHashIterate(cname2points, NULL);
+  SArray** pCTablePoints = taosHashIterate(cname2points, NULL);
   while (pCTablePoints) {
     SArray* pPoints = *pCTablePoints;
     taosArrayDestroy(pPoints);
     pCTablePoints = taosHashIterate(cname2points, pCTablePoints);
   }
   taosHashCleanup(cname2points);
+  tscFreeSqlObj(pSql);
   return code;
 }
 
@@ -1137,197 +1358,343 @@ static void escapeSpecialCharacter(uint8_t field, const char **pos) {
   *pos = cur;
 }
 
-static bool isValidInteger(char *str) {
-  char *c = str;
-  if (*c != '+' && *c != '-' && !isdigit(*c)) {
-    return false;
-  }
-  c++;
-  while (*c != '\0') {
-    if (!isdigit(*c)) {
-      return false;
-    }
-    c++;
+static const uint8_t smlSpecialChar[256] = {['\0'] = 1, [' '] = 1, ['"'] = 1, [','] = 1, ['='] = 1, ['\\'] = 1};
+
+/*
+ * Returns the first '\0', ' ', '"', ',', '=' or '\\' in str, end is the terminating '\0'. With SSE2, 16 bytes are
+ * checked per step while they are all before end, the bytes left are checked one by one.
+ */
+const char *smlScanSpecialChar(const char *str, const char *end) {
+  const char *cur = str;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i equal = _mm_set1_epi8('=');
+  const __m128i slash = _mm_set1_epi8('\\');
+  while (end - cur >= 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)cur);
+    __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, zero), _mm_cmpeq_epi8(chunk, space)),
+                               _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, comma)));
+    hit = _mm_or_si128(hit, _mm_or_si128(_mm_cmpeq_epi8(chunk, equal), _mm_cmpeq_epi8(chunk, slash)));
+    int32_t mask = _mm_movemask_epi8(hit);
+    if (mask != 0) {
+      return cur + __builtin_ctz(mask);
+    }
+    cur += 16;
+  }
+#endif
+  while (!smlSpecialChar[(uint8_t)*cur]) {
+    cur++;
   }
-  return true;
+  return cur;
 }
 
-static bool isValidFloat(char *str) {
-  char *c = str;
-  uint8_t has_dot, has_exp, has_sign;
-  has_dot = 0;
-  has_exp = 0;
-  has_sign = 0;
+/*
+ * Returns the first unescaped '\0' or delimiter in str, *len is set to the length of str before it with
+ * the escape characters removed.
+ */
+static const char *smlFindDelimiter(const char *str, const char *lineEnd, uint8_t field, const char *delimiters,
+                                    int32_t *len) {
+  const char *cur = str;
+  int32_t     numOfEscapes = 0;
 
-  if (*c != '+' && *c != '-' && *c != '.' && !isdigit(*c)) {
-    return false;
-  }
-  if (*c == '.' && isdigit(*(c + 1))) {
-    has_dot = 1;
-  }
-  c++;
-  while (*c != '\0') {
-    if (!isdigit(*c)) {
-      switch (*c) {
-        case '.': {
-          if (!has_dot && !has_exp && isdigit(*(c + 1))) {
-            has_dot = 1;
-          } else {
-            return false;
-          }
-          break;
-        }
-        case 'e':
-        case 'E': {
-          if (!has_exp && isdigit(*(c - 1)) &&
-              (isdigit(*(c + 1)) ||
-               *(c + 1) == '+' ||
-               *(c + 1) == '-')) {
-            has_exp = 1;
-          } else {
-            return false;
-          }
-          break;
-        }
-        case '+':
-        case '-': {
-          if (!has_sign && has_exp && isdigit(*(c + 1))) {
-            has_sign = 1;
-          } else {
-            return false;
-          }
-          break;
-        }
-        default: {
-          return false;
-        }
-      }
+  while (1) {
+    cur = smlScanSpecialChar(cur, lineEnd);
+    if (*cur == '\0' || strchr(delimiters, *cur) != NULL) {
+      break;
     }
-    c++;
-  } //while
-  return true;
-}
-
-static bool isTinyInt(char *pVal, uint16_t len) {
-  if (len <= 2) {
-    return false;
-  }
-  if (!strcmp(&pVal[len - 2], "i8")) {
-    //printf("Type is int8(%s)\n", pVal);
-    return true;
+    if (*cur == '\\') {
+      const char *pos = cur;
+      escapeSpecialCharacter(field, &cur);
+      numOfEscapes += (int32_t)(cur - pos);
+    }
+    cur++;
   }
-  return false;
+
+  *len = (int32_t)(cur - str) - numOfEscapes;
+  return cur;
 }
 
-static bool isTinyUint(char *pVal, uint16_t len) {
-  if (len <= 2) {
-    return false;
-  }
-  if (pVal[0] == '-') {
-    return false;
-  }
-  if (!strcmp(&pVal[len - 2], "u8")) {
-    //printf("Type is uint8(%s)\n", pVal);
-    return true;
+// copies [start, end) to dst without the escape characters, dst is '\0' terminated
+static void smlUnescape(char *dst, const char *start, const char *end, uint8_t field) {
+  const char *cur = start;
+  while (cur < end) {
+    const char *pos = memchr(cur, '\\', end - cur);
+    if (pos == NULL) {
+      pos = end;
+    }
+    memcpy(dst, cur, pos - cur);
+    dst += pos - cur;
+    cur = pos;
+    if (cur < end) {
+      escapeSpecialCharacter(field, &cur);
+      *dst++ = *cur++;
+    }
   }
-  return false;
+  *dst = '\0';
 }
 
-static bool isSmallInt(char *pVal, uint16_t len) {
-  if (len <= 3) {
-    return false;
+typedef struct {
+  bool     negative;
+  bool     isInteger;  // neither fraction nor exponent
+  bool     overflow;   // mantissa does not fit in 64 bits, only the leading digits are kept
+  uint64_t mantissa;
+  int32_t  exponent;   // value is mantissa * 10^exponent
+} SSmlNumber;
+
+static const double smlPowerOf10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/*
+ * Scans a decimal number in the form [+-][digits][.digits][(e|E)[+-]digits] in a single pass, the mantissa
+ * and exponent are accumulated on the way. Returns the first char after the number, or NULL if str does not
+ * start with a valid number.
+ */
+static const char *smlScanNumber(const char *str, SSmlNumber *pNum) {
+  const char *cur = str;
+  int32_t     numOfDigits = 0;
+
+  memset(pNum, 0, sizeof(SSmlNumber));
+  pNum->isInteger = true;
+
+  if (*cur == '+' || *cur == '-') {
+    pNum->negative = (*cur == '-');
+    cur++;
   }
-  if (!strcmp(&pVal[len - 3], "i16")) {
-    //printf("Type is int16(%s)\n", pVal);
-    return true;
+
+  for (; isdigit(*cur); ++cur, ++numOfDigits) {
+    uint64_t digit = *cur - '0';
+    if (pNum->overflow || pNum->mantissa > (UINT64_MAX - digit) / 10) {
+      pNum->overflow = true;
+      pNum->exponent++;
+    } else {
+      pNum->mantissa = pNum->mantissa * 10 + digit;
+    }
   }
-  return false;
-}
 
-static bool isSmallUint(char *pVal, uint16_t len) {
-  if (len <= 3) {
-    return false;
+  if (*cur == '.') {
+    // a dot must be followed by digits
+    if (!isdigit(*(cur + 1))) {
+      return NULL;
+    }
+    pNum->isInteger = false;
+    for (cur++; isdigit(*cur); ++cur, ++numOfDigits) {
+      uint64_t digit = *cur - '0';
+      if (!pNum->overflow && pNum->mantissa <= (UINT64_MAX - digit) / 10) {
+        pNum->mantissa = pNum->mantissa * 10 + digit;
+        pNum->exponent--;
+      } else {
+        pNum->overflow = true;
+      }
+    }
   }
-  if (pVal[0] == '-') {
-    return false;
+
+  if (numOfDigits == 0) {
+    return NULL;
   }
-  if (strcmp(&pVal[len - 3], "u16") == 0) {
-    //printf("Type is uint16(%s)\n", pVal);
-    return true;
+
+  if (*cur == 'e' || *cur == 'E') {
+    const char *pos = cur + 1;
+    bool        negative = false;
+    if (*pos == '+' || *pos == '-') {
+      negative = (*pos == '-');
+      pos++;
+    }
+    if (!isdigit(*pos)) {
+      return NULL;
+    }
+
+    int32_t exponent = 0;
+    for (; isdigit(*pos); ++pos) {
+      if (exponent < 100000) {
+        exponent = exponent * 10 + (*pos - '0');
+      }
+    }
+    pNum->exponent += negative ? -exponent : exponent;
+    pNum->isInteger = false;
+    cur = pos;
   }
-  return false;
+
+  return cur;
 }
 
-static bool isInt(char *pVal, uint16_t len) {
-  if (len <= 3) {
-    return false;
-  }
-  if (strcmp(&pVal[len - 3], "i32") == 0) {
-    //printf("Type is int32(%s)\n", pVal);
+static bool smlNumberToDouble(const SSmlNumber *pNum, const char *str, double *dVal) {
+  // exact when both the mantissa and the power of 10 are representable in a double
+  if (!pNum->overflow && pNum->mantissa <= (1ULL << 53) && pNum->exponent >= -22 && pNum->exponent <= 22) {
+    double val = (double)pNum->mantissa;
+    if (pNum->exponent < 0) {
+      val /= smlPowerOf10[-pNum->exponent];
+    } else {
+      val *= smlPowerOf10[pNum->exponent];
+    }
+    *dVal = pNum->negative ? -val : val;
     return true;
   }
-  return false;
+
+  // str is already validated, strtod stops at the type suffix
+  errno = 0;
+  *dVal = strtod(str, NULL);
+  return errno != ERANGE;
 }
 
-static bool isUint(char *pVal, uint16_t len) {
-  if (len <= 3) {
-    return false;
-  }
-  if (pVal[0] == '-') {
+static bool smlNumberToInteger(const SSmlNumber *pNum, bool isSigned, int64_t *iVal, uint64_t *uVal) {
+  if (!pNum->isInteger || pNum->overflow) {
     return false;
   }
-  if (strcmp(&pVal[len - 3], "u32") == 0) {
-    //printf("Type is uint32(%s)\n", pVal);
-    return true;
+
+  if (isSigned) {
+    if (pNum->mantissa > (uint64_t)INT64_MAX + pNum->negative) {
+      return false;
+    }
+    *iVal = pNum->negative ? (int64_t)(0 - pNum->mantissa) : (int64_t)pNum->mantissa;
+  } else {
+    if (pNum->negative) {
+      return false;
+    }
+    *uVal = pNum->mantissa;
   }
-  return false;
+
+  return true;
 }
 
-static bool isBigInt(char *pVal, uint16_t len) {
-  if (len <= 3) {
-    return false;
-  }
-  if (strcmp(&pVal[len - 3], "i64") == 0) {
-    //printf("Type is int64(%s)\n", pVal);
-    return true;
+static uint8_t smlGetNumberType(const char *suffix, uint16_t len) {
+  if (len == 0) {
+    //Handle default(no appendix) as float
+    return TSDB_DATA_TYPE_FLOAT;
+  }
+
+  if (len == 2) {
+    if (strncmp(suffix, "i8", 2) == 0) return TSDB_DATA_TYPE_TINYINT;
+    if (strncmp(suffix, "u8", 2) == 0) return TSDB_DATA_TYPE_UTINYINT;
+  } else if (len == 3) {
+    switch (suffix[0]) {
+      case 'i':
+        if (strncmp(suffix, "i16", 3) == 0) return TSDB_DATA_TYPE_SMALLINT;
+        if (strncmp(suffix, "i32", 3) == 0) return TSDB_DATA_TYPE_INT;
+        if (strncmp(suffix, "i64", 3) == 0) return TSDB_DATA_TYPE_BIGINT;
+        break;
+      case 'u':
+        if (strncmp(suffix, "u16", 3) == 0) return TSDB_DATA_TYPE_USMALLINT;
+        if (strncmp(suffix, "u32", 3) == 0) return TSDB_DATA_TYPE_UINT;
+        if (strncmp(suffix, "u64", 3) == 0) return TSDB_DATA_TYPE_UBIGINT;
+        break;
+      case 'f':
+        if (strncmp(suffix, "f32", 3) == 0) return TSDB_DATA_TYPE_FLOAT;
+        if (strncmp(suffix, "f64", 3) == 0) return TSDB_DATA_TYPE_DOUBLE;
+        break;
+      default:
+        break;
+    }
   }
-  return false;
+
+  return TSDB_DATA_TYPE_NULL;
 }
 
-static bool isBigUint(char *pVal, uint16_t len) {
-  if (len <= 3) {
-    return false;
-  }
-  if (pVal[0] == '-') {
+static bool convertSmlNumber(TAOS_SML_KV *pVal, char *value, uint16_t len, SSmlLinesInfo* info) {
+  SSmlNumber num;
+
+  const char *end = smlScanNumber(value, &num);
+  if (end == NULL) {
     return false;
   }
-  if (strcmp(&pVal[len - 3], "u64") == 0) {
-    //printf("Type is uint64(%s)\n", pVal);
-    return true;
-  }
-  return false;
-}
 
-static bool isFloat(char *pVal, uint16_t len) {
-  if (len <= 3) {
+  uint8_t type = smlGetNumberType(end, (uint16_t)(len - (end - value)));
+  if (type == TSDB_DATA_TYPE_NULL) {
     return false;
   }
-  if (strcmp(&pVal[len - 3], "f32") == 0) {
-    //printf("Type is float(%s)\n", pVal);
-    return true;
-  }
-  return false;
-}
 
-static bool isDouble(char *pVal, uint16_t len) {
-  if (len <= 3) {
+  int64_t  val_s = 0;
+  uint64_t val_u = 0;
+  double   val_d = 0;
+  if (IS_FLOAT_TYPE(type)) {
+    if (!smlNumberToDouble(&num, value, &val_d)) {
+      tscError("SML:0x%"PRIx64" Convert number(%s) out of range", info->id, value);
+      return false;
+    }
+  } else if (!smlNumberToInteger(&num, IS_SIGNED_NUMERIC_TYPE(type), &val_s, &val_u)) {
     return false;
   }
-  if (strcmp(&pVal[len - 3], "f64") == 0) {
-    //printf("Type is double(%s)\n", pVal);
-    return true;
+
+  pVal->type = type;
+  pVal->length = (int16_t)tDataTypes[type].bytes;
+
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      if (!IS_VALID_TINYINT(val_s)) {
+        return false;
+      }
+      pVal->value = calloc(pVal->length, 1);
+      *(int8_t *)(pVal->value) = (int8_t)val_s;
+      break;
+    case TSDB_DATA_TYPE_UTINYINT:
+      if (!IS_VALID_UTINYINT(val_u)) {
+        return false;
+      }
+      pVal->value = calloc(pVal->length, 1);
+      *(uint8_t *)(pVal->value) = (uint8_t)val_u;
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      if (!IS_VALID_SMALLINT(val_s)) {
+        return false;
+      }
+      pVal->value = calloc(pVal->length, 1);
+      *(int16_t *)(pVal->value) = (int16_t)val_s;
+      break;
+    case TSDB_DATA_TYPE_USMALLINT:
+      if (!IS_VALID_USMALLINT(val_u)) {
+        return false;
+      }
+      pVal->value = calloc(pVal->length, 1);
+      *(uint16_t *)(pVal->value) = (uint16_t)val_u;
+      break;
+    case TSDB_DATA_TYPE_INT:
+      if (!IS_VALID_INT(val_s)) {
+        return false;
+      }
+      pVal->value = calloc(pVal->length, 1);
+      *(int32_t *)(pVal->value) = (int32_t)val_s;
+      break;
+    case TSDB_DATA_TYPE_UINT:
+      if (!IS_VALID_UINT(val_u)) {
+        return false;
+      }
+      pVal->value = calloc(pVal->length, 1);
+      *(uint32_t *)(pVal->value) = (uint32_t)val_u;
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+      if (!IS_VALID_BIGINT(val_s)) {
+        return false;
+      }
+      pVal->value = calloc(pVal->length, 1);
+      *(int64_t *)(pVal->value) = (int64_t)val_s;
+      break;
+    case TSDB_DATA_TYPE_UBIGINT:
+      if (!IS_VALID_UBIGINT(val_u)) {
+        return false;
+      }
+      pVal->value = calloc(pVal->length, 1);
+      *(uint64_t *)(pVal->value) = (uint64_t)val_u;
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      if (!IS_VALID_FLOAT(val_d)) {
+        return false;
+      }
+      pVal->value = calloc(pVal->length, 1);
+      *(float *)(pVal->value) = (float)val_d;
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      if (!IS_VALID_DOUBLE(val_d)) {
+        return false;
+      }
+      pVal->value = calloc(pVal->length, 1);
+      *(double *)(pVal->value) = (double)val_d;
+      break;
+    default:
+      return false;
   }
-  return false;
+  return true;
 }
 
 static bool isBool(char *pVal, uint16_t len, bool *bVal) {
@@ -1434,105 +1801,6 @@ static bool isTimeStamp(char *pVal, uint16_t len, SMLTimeStampType *tsType) {
   return false;
 }
 
-static bool convertStrToNumber(TAOS_SML_KV *pVal, char*str, SSmlLinesInfo* info) {
-  errno = 0;
-  uint8_t type = pVal->type;
-  int16_t length = pVal->length;
-  int64_t val_s;
-  uint64_t val_u;
-  double val_d;
-
-  if (IS_FLOAT_TYPE(type)) {
-    val_d = strtod(str, NULL);
-  } else {
-    if (IS_SIGNED_NUMERIC_TYPE(type)) {
-      val_s = strtoll(str, NULL, 10);
-    } else {
-      val_u = strtoull(str, NULL, 10);
-    }
-  }
-
-  if (errno == ERANGE) {
-    tscError("SML:0x%"PRIx64" Convert number(%s) out of range", info->id, str);
-    return false;
-  }
-
-  switch (type) {
-    case TSDB_DATA_TYPE_TINYINT:
-      if (!IS_VALID_TINYINT(val_s)) {
-        return false;
-      }
-      pVal->value = calloc(length, 1);
-      *(int8_t *)(pVal->value) = (int8_t)val_s;
-      break;
-    case TSDB_DATA_TYPE_UTINYINT:
-      if (!IS_VALID_UTINYINT(val_u)) {
-        return false;
-      }
-      pVal->value = calloc(length, 1);
-      *(uint8_t *)(pVal->value) = (uint8_t)val_u;
-      break;
-    case TSDB_DATA_TYPE_SMALLINT:
-      if (!IS_VALID_SMALLINT(val_s)) {
-        return false;
-      }
-      pVal->value = calloc(length, 1);
-      *(int16_t *)(pVal->value) = (int16_t)val_s;
-      break;
-    case TSDB_DATA_TYPE_USMALLINT:
-      if (!IS_VALID_USMALLINT(val_u)) {
-        return false;
-      }
-      pVal->value = calloc(length, 1);
-      *(uint16_t *)(pVal->value) = (uint16_t)val_u;
-      break;
-    case TSDB_DATA_TYPE_INT:
-      if (!IS_VALID_INT(val_s)) {
-        return false;
-      }
-      pVal->value = calloc(length, 1);
-      *(int32_t *)(pVal->value) = (int32_t)val_s;
-      break;
-    case TSDB_DATA_TYPE_UINT:
-      if (!IS_VALID_UINT(val_u)) {
-        return false;
-      }
-      pVal->value = calloc(length, 1);
-      *(uint32_t *)(pVal->value) = (uint32_t)val_u;
-      break;
-    case TSDB_DATA_TYPE_BIGINT:
-      if (!IS_VALID_BIGINT(val_s)) {
-        return false;
-      }
-      pVal->value = calloc(length, 1);
-      *(int64_t *)(pVal->value) = (int64_t)val_s;
-      break;
-    case TSDB_DATA_TYPE_UBIGINT:
-      if (!IS_VALID_UBIGINT(val_u)) {
-        return false;
-      }
-      pVal->value = calloc(length, 1);
-      *(uint64_t *)(pVal->value) = (uint64_t)val_u;
-      break;
-    case TSDB_DATA_TYPE_FLOAT:
-      if (!IS_VALID_FLOAT(val_d)) {
-        return false;
-      }
-      pVal->value = calloc(length, 1);
-      *(float *)(pVal->value) = (float)val_d;
-      break;
-    case TSDB_DATA_TYPE_DOUBLE:
-      if (!IS_VALID_DOUBLE(val_d)) {
-        return false;
-      }
-      pVal->value = calloc(length, 1);
-      *(double *)(pVal->value) = (double)val_d;
-      break;
-    default:
-      return false;
-  }
-  return true;
-}
 //len does not include '\0' from value.
 bool convertSmlValueType(TAOS_SML_KV *pVal, char *value,
                          uint16_t len, SSmlLinesInfo* info) {
@@ -1540,98 +1808,6 @@ bool convertSmlValueType(TAOS_SML_KV *pVal, char *value,
     return false;
   }
 
-  //integer number
-  if (isTinyInt(value, len)) {
-    pVal->type = TSDB_DATA_TYPE_TINYINT;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    value[len - 2] = '\0';
-    if (!isValidInteger(value) || !convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
-  if (isTinyUint(value, len)) {
-    pVal->type = TSDB_DATA_TYPE_UTINYINT;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    value[len - 2] = '\0';
-    if (!isValidInteger(value) || !convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
-  if (isSmallInt(value, len)) {
-    pVal->type = TSDB_DATA_TYPE_SMALLINT;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    value[len - 3] = '\0';
-    if (!isValidInteger(value) || !convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
-  if (isSmallUint(value, len)) {
-    pVal->type = TSDB_DATA_TYPE_USMALLINT;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    value[len - 3] = '\0';
-    if (!isValidInteger(value) || !convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
-  if (isInt(value, len)) {
-    pVal->type = TSDB_DATA_TYPE_INT;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    value[len - 3] = '\0';
-    if (!isValidInteger(value) || !convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
-  if (isUint(value, len)) {
-    pVal->type = TSDB_DATA_TYPE_UINT;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    value[len - 3] = '\0';
-    if (!isValidInteger(value) || !convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
-  if (isBigInt(value, len)) {
-    pVal->type = TSDB_DATA_TYPE_BIGINT;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    value[len - 3] = '\0';
-    if (!isValidInteger(value) || !convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
-  if (isBigUint(value, len)) {
-    pVal->type = TSDB_DATA_TYPE_UBIGINT;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    value[len - 3] = '\0';
-    if (!isValidInteger(value) || !convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
-  //floating number
-  if (isFloat(value, len)) {
-    pVal->type = TSDB_DATA_TYPE_FLOAT;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    value[len - 3] = '\0';
-    if (!isValidFloat(value) || !convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
-  if (isDouble(value, len)) {
-    pVal->type = TSDB_DATA_TYPE_DOUBLE;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    value[len - 3] = '\0';
-    if (!isValidFloat(value) || !convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
   //binary
   if (isBinary(value, len)) {
     pVal->type = TSDB_DATA_TYPE_BINARY;
@@ -1659,16 +1835,8 @@ bool convertSmlValueType(TAOS_SML_KV *pVal, char *value,
     memcpy(pVal->value, &bVal, pVal->length);
     return true;
   }
-  //Handle default(no appendix) as float
-  if (isValidInteger(value) || isValidFloat(value)) {
-    pVal->type = TSDB_DATA_TYPE_FLOAT;
-    pVal->length = (int16_t)tDataTypes[pVal->type].bytes;
-    if (!convertStrToNumber(pVal, value, info)) {
-      return false;
-    }
-    return true;
-  }
-  return false;
+  //integer or floating number, the type is given by the appendix
+  return convertSmlNumber(pVal, value, len, info);
 }
 
 static int32_t getTimeStampValue(char *value, uint16_t len,
@@ -1801,31 +1969,24 @@ bool checkDuplicateKey(char *key, SHashObj *pHash, SSmlLinesInfo* info) {
 static int32_t parseSmlKey(TAOS_SML_KV *pKV, const char **index, SHashObj *pHash, SSmlLinesInfo* info) {
   const char *cur = *index;
   char key[TSDB_COL_NAME_LEN + 1];  // +1 to avoid key[len] over write
-  uint16_t len = 0;
+  int32_t len = 0;
 
   //key field cannot start with digit
   if (isdigit(*cur)) {
     tscError("SML:0x%"PRIx64" Tag key cannnot start with digit", info->id);
     return TSDB_CODE_TSC_LINE_SYNTAX_ERROR;
   }
-  while (*cur != '\0') {
-    if (len > TSDB_COL_NAME_LEN) {
-      tscError("SML:0x%"PRIx64" Key field cannot exceeds 65 characters", info->id);
-      return TSDB_CODE_TSC_INVALID_COLUMN_LENGTH;
-    }
-    //unescaped '=' identifies a tag key
-    if (*cur == '=' && *(cur - 1) != '\\') {
-      break;
-    }
-    //Escape special character
-    if (*cur == '\\') {
-      escapeSpecialCharacter(2, &cur);
-    }
-    key[len] = *cur;
-    cur++;
-    len++;
+  //unescaped '=' identifies a tag key
+  const char *end = smlFindDelimiter(cur, info->lineEnd, 2, "=", &len);
+  if (len > TSDB_COL_NAME_LEN) {
+    tscError("SML:0x%"PRIx64" Key field cannot exceeds 65 characters", info->id);
+    return TSDB_CODE_TSC_INVALID_COLUMN_LENGTH;
+  }
+  if (*end == '\0') {
+    tscError("SML:0x%"PRIx64" Key field not followed by value", info->id);
+    return TSDB_CODE_TSC_LINE_SYNTAX_ERROR;
   }
-  key[len] = '\0';
+  smlUnescape(key, cur, end, 2);
 
   if (checkDuplicateKey(key, pHash, info)) {
     return TSDB_CODE_TSC_LINE_SYNTAX_ERROR;
@@ -1834,93 +1995,82 @@ static int32_t parseSmlKey(TAOS_SML_KV *pKV, const char **index, SHashObj *pHash
   pKV->key = calloc(len + 1, 1);
   memcpy(pKV->key, key, len + 1);
   //tscDebug("SML:0x%"PRIx64" Key:%s|len:%d", info->id, pKV->key, len);
-  *index = cur + 1;
+  *index = end + 1;
   return TSDB_CODE_SUCCESS;
 }
 
 
 static bool parseSmlValue(TAOS_SML_KV *pKV, const char **index,
                           bool *is_last_kv, SSmlLinesInfo* info) {
-  const char *start, *cur;
-  char *value = NULL;
-  uint16_t len = 0;
-  start = cur = *index;
-
-  while (1) {
-    // unescaped ',' or ' ' or '\0' identifies a value
-    if ((*cur == ',' || *cur == ' ' || *cur == '\0') && *(cur - 1) != '\\') {
-      //unescaped ' ' or '\0' indicates end of value
-      *is_last_kv = (*cur == ' ' || *cur == '\0') ? true : false;
-      break;
-    }
-    //Escape special character
-    if (*cur == '\\') {
-      escapeSpecialCharacter(2, &cur);
-    }
-    cur++;
-    len++;
+  const char *cur = *index;
+  char buf[64];
+  char *value = buf;
+  int32_t len = 0;
+
+  // unescaped ',' or ' ' or '\0' identifies a value
+  const char *end = smlFindDelimiter(cur, info->lineEnd, 2, ", ", &len);
+  //unescaped ' ' or '\0' indicates end of value
+  *is_last_kv = (*end == ' ' || *end == '\0') ? true : false;
+  if (len > UINT16_MAX) {
+    tscError("SML:0x%"PRIx64" Value field too long", info->id);
+    free(pKV->key);
+    pKV->key = NULL;
+    return TSDB_CODE_TSC_INVALID_VALUE;
   }
 
-  value = calloc(len + 1, 1);
-  memcpy(value, start, len);
-  value[len] = '\0';
-  if (!convertSmlValueType(pKV, value, len, info)) {
+  if ((size_t)len >= sizeof(buf)) {
+    value = malloc(len + 1);
+  }
+  smlUnescape(value, cur, end, 2);
+  if (!convertSmlValueType(pKV, value, (uint16_t)len, info)) {
     tscError("SML:0x%"PRIx64" Failed to convert sml value string(%s) to any type",
             info->id, value);
     //free previous alocated key field
     free(pKV->key);
     pKV->key = NULL;
-    free(value);
+    if (value != buf) {
+      free(value);
+    }
     return TSDB_CODE_TSC_INVALID_VALUE;
   }
-  free(value);
+  if (value != buf) {
+    free(value);
+  }
 
-  *index = (*cur == '\0') ? cur : cur + 1;
+  *index = (*end == '\0') ? end : end + 1;
   return TSDB_CODE_SUCCESS;
 }
 
 static int32_t parseSmlMeasurement(TAOS_SML_DATA_POINT *pSml, const char **index,
                                    uint8_t *has_tags, SSmlLinesInfo* info) {
   const char *cur = *index;
-  uint16_t len = 0;
+  int32_t len = 0;
 
-  pSml->stableName = calloc(TSDB_TABLE_NAME_LEN + 1, 1);    // +1 to avoid 1772 line over write
-  if (pSml->stableName == NULL){
-      return TSDB_CODE_TSC_OUT_OF_MEMORY;
-  }
   if (isdigit(*cur)) {
     tscError("SML:0x%"PRIx64" Measurement field cannnot start with digit", info->id);
-    free(pSml->stableName);
-    pSml->stableName = NULL;
     return TSDB_CODE_TSC_LINE_SYNTAX_ERROR;
   }
 
-  while (*cur != '\0') {
-    if (len > TSDB_TABLE_NAME_LEN) {
-      tscError("SML:0x%"PRIx64" Measurement field cannot exceeds 193 characters", info->id);
-      free(pSml->stableName);
-      pSml->stableName = NULL;
-      return TSDB_CODE_TSC_INVALID_TABLE_ID_LENGTH;
-    }
-    //first unescaped comma or space identifies measurement
-    //if space detected first, meaning no tag in the input
-    if (*cur == ',' && *(cur - 1) != '\\') {
-      *has_tags = 1;
-      break;
-    }
-    if (*cur == ' ' && *(cur - 1) != '\\') {
-      break;
-    }
-    //Comma, Space, Backslash needs to be escaped if any
-    if (*cur == '\\') {
-      escapeSpecialCharacter(1, &cur);
-    }
-    pSml->stableName[len] = *cur;
-    cur++;
-    len++;
+  //first unescaped comma or space identifies measurement
+  //if space detected first, meaning no tag in the input
+  const char *end = smlFindDelimiter(cur, info->lineEnd, 1, ", ", &len);
+  if (len > TSDB_TABLE_NAME_LEN) {
+    tscError("SML:0x%"PRIx64" Measurement field cannot exceeds 193 characters", info->id);
+    return TSDB_CODE_TSC_INVALID_TABLE_ID_LENGTH;
+  }
+  if (*end == '\0') {
+    tscError("SML:0x%"PRIx64" Measurement field not followed by fields", info->id);
+    return TSDB_CODE_TSC_LINE_SYNTAX_ERROR;
+  }
+  *has_tags = (*end == ',') ? 1 : 0;
+
+  pSml->stableName = calloc(TSDB_TABLE_NAME_LEN + 1, 1);    // +1 to avoid 1772 line over write
+  if (pSml->stableName == NULL){
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
   }
-  pSml->stableName[len] = '\0';
-  *index = cur + 1;
+  //Comma, Space needs to be escaped if any
+  smlUnescape(pSml->stableName, cur, end, 1);
+  *index = end + 1;
   tscDebug("SML:0x%"PRIx64" Stable name in measurement:%s|len:%d", info->id, pSml->stableName, len);
 
   return TSDB_CODE_SUCCESS;
@@ -2043,17 +2193,17 @@ static void moveTimeStampToFirstKv(TAOS_SML_DATA_POINT** smlData, TAOS_SML_KV *t
   free(ts);
 }
 
-int32_t tscParseLine(const char* sql, TAOS_SML_DATA_POINT* smlData, SSmlLinesInfo* info) {
+int32_t tscParseLine(const char* sql, TAOS_SML_DATA_POINT* smlData, SHashObj* keyHashTable, SSmlLinesInfo* info) {
   const char* index = sql;
   int32_t ret = TSDB_CODE_SUCCESS;
   uint8_t has_tags = 0;
   TAOS_SML_KV *timestamp = NULL;
-  SHashObj *keyHashTable = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, false);
 
+  info->lineEnd = sql + strlen(sql);
+  taosHashClear(keyHashTable);
   ret = parseSmlMeasurement(smlData, &index, &has_tags, info);
   if (ret) {
     tscError("SML:0x%"PRIx64" Unable to parse measurement", info->id);
-    taosHashCleanup(keyHashTable);
     return ret;
   }
   tscDebug("SML:0x%"PRIx64" Parse measurement finished, has_tags:%d", info->id, has_tags);
@@ -2063,7 +2213,6 @@ int32_t tscParseLine(const char* sql, TAOS_SML_DATA_POINT* smlData, SSmlLinesInf
     ret = parseSmlKvPairs(&smlData->tags, &smlData->tagNum, &index, false, smlData, keyHashTable, info);
     if (ret) {
       tscError("SML:0x%"PRIx64" Unable to parse tag", info->id);
-      taosHashCleanup(keyHashTable);
       return ret;
     }
   }
@@ -2073,11 +2222,9 @@ int32_t tscParseLine(const char* sql, TAOS_SML_DATA_POINT* smlData, SSmlLinesInf
   ret = parseSmlKvPairs(&smlData->fields, &smlData->fieldNum, &index, true, smlData, keyHashTable, info);
   if (ret) {
     tscError("SML:0x%"PRIx64" Unable to parse field", info->id);
-    taosHashCleanup(keyHashTable);
     return ret;
   }
   tscDebug("SML:0x%"PRIx64" Parse fields finished, num of fields:%d", info->id, smlData->fieldNum);
-  taosHashCleanup(keyHashTable);
 
   //Parse timestamp
   ret = parseSmlTimeStamp(&timestamp, &index, info);
@@ -2109,12 +2256,19 @@ void destroySmlDataPoint(TAOS_SML_DATA_POINT* point) {
 }
 
 int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* failedLines, SSmlLinesInfo* info) {
+  // reused by all lines to detect duplicate keys
+  SHashObj *keyHashTable = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  if (keyHashTable == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
   for (int32_t i = 0; i < numLines; ++i) {
     TAOS_SML_DATA_POINT point = {0};
-    int32_t code = tscParseLine(lines[i], &point, info);
+    int32_t code = tscParseLine(lines[i], &point, keyHashTable, info);
     if (code != TSDB_CODE_SUCCESS) {
       tscError("SML:0x%"PRIx64" data point line parse failed. line %d : %s", info->id, i, lines[i]);
       destroySmlDataPoint(&point);
+      taosHashCleanup(keyHashTable);
       return code;
     } else {
       tscDebug("SML:0x%"PRIx64" data point line parse success. line %d", info->id, i);
@@ -2122,6 +2276,8 @@ int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* faile
 
     taosArrayPush(points, &point);
   }
+
+  taosHashCleanup(keyHashTable);
   return TSDB_CODE_SUCCESS;
 }
 
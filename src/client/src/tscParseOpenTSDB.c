@@ -33,6 +33,15 @@ static uint64_t genUID() {
   return id;
 }
 
+// returns the first c or '\0' in str, plain chars are skipped in bulk
+static const char *findTelnetChar(const char *str, const char *lineEnd, char c) {
+  const char *cur = smlScanSpecialChar(str, lineEnd);
+  while (*cur != c && *cur != '\0') {
+    cur = smlScanSpecialChar(cur + 1, lineEnd);
+  }
+  return cur;
+}
+
 static int32_t parseTelnetMetric(TAOS_SML_DATA_POINT *pSml, const char **index, SSmlLinesInfo* info) {
   const char *cur = *index;
   uint16_t len = 0;
@@ -47,21 +56,14 @@ static int32_t parseTelnetMetric(TAOS_SML_DATA_POINT *pSml, const char **index,
     return TSDB_CODE_TSC_LINE_SYNTAX_ERROR;
   }
 
-  while (*cur != '\0') {
-    if (len > TSDB_TABLE_NAME_LEN) {
-      tscError("OTD:0x%"PRIx64" Metric cannot exceeds 193 characters", info->id);
-      tfree(pSml->stableName);
-      return TSDB_CODE_TSC_INVALID_TABLE_ID_LENGTH;
-    }
-
-    if (*cur == ' ') {
-      break;
-    }
-
-    pSml->stableName[len] = *cur;
-    cur++;
-    len++;
+  cur = findTelnetChar(cur, info->lineEnd, ' ');
+  len = (uint16_t)MIN(cur - *index, TSDB_TABLE_NAME_LEN + 1);
+  if (len > TSDB_TABLE_NAME_LEN) {
+    tscError("OTD:0x%"PRIx64" Metric cannot exceeds 193 characters", info->id);
+    tfree(pSml->stableName);
+    return TSDB_CODE_TSC_INVALID_TABLE_ID_LENGTH;
   }
+  memcpy(pSml->stableName, *index, len);
   if (len == 0 || *cur == '\0') {
     tfree(pSml->stableName);
     return TSDB_CODE_TSC_LINE_SYNTAX_ERROR;
@@ -88,13 +90,8 @@ static int32_t parseTelnetTimeStamp(TAOS_SML_KV **pTS, int *num_kvs, const char
   //allocate fields for timestamp and value
   *pTS = tcalloc(OTD_MAX_FIELDS_NUM, sizeof(TAOS_SML_KV));
 
-  while(*cur != '\0') {
-    if (*cur == ' ') {
-      break;
-    }
-    cur++;
-    len++;
-  }
+  cur = findTelnetChar(cur, info->lineEnd, ' ');
+  len = (int)(cur - start);
 
   if (len > 0 && *cur != '\0') {
     value = tcalloc(len + 1, 1);
@@ -132,13 +129,8 @@ static int32_t parseTelnetMetricValue(TAOS_SML_KV **pKVs, int *num_kvs, const ch
 
   start = cur = *index;
 
-  while(*cur != '\0') {
-    if (*cur == ' ') {
-      break;
-    }
-    cur++;
-    len++;
-  }
+  cur = findTelnetChar(cur, info->lineEnd, ' ');
+  len = (int)(cur - start);
 
   if (len > 0 && *cur != '\0') {
     value = tcalloc(len + 1, 1);
@@ -173,19 +165,13 @@ static int32_t parseTelnetTagKey(TAOS_SML_KV *pKV, const char **index, SHashObj
     tscError("OTD:0x%"PRIx64" Tag key cannnot start with digit", info->id);
     return TSDB_CODE_TSC_LINE_SYNTAX_ERROR;
   }
-  while (*cur != '\0') {
-    if (len > TSDB_COL_NAME_LEN) {
-      tscError("OTD:0x%"PRIx64" Tag key cannot exceeds 65 characters", info->id);
-      return TSDB_CODE_TSC_INVALID_COLUMN_LENGTH;
-    }
-    if (*cur == '=') {
-      break;
-    }
-
-    key[len] = *cur;
-    cur++;
-    len++;
+  cur = findTelnetChar(cur, info->lineEnd, '=');
+  len = (uint16_t)MIN(cur - *index, TSDB_COL_NAME_LEN + 1);
+  if (len > TSDB_COL_NAME_LEN) {
+    tscError("OTD:0x%"PRIx64" Tag key cannot exceeds 65 characters", info->id);
+    return TSDB_CODE_TSC_INVALID_COLUMN_LENGTH;
   }
+  memcpy(key, *index, len);
   if (len == 0 || *cur == '\0') {
     return TSDB_CODE_TSC_LINE_SYNTAX_ERROR;
   }
@@ -210,16 +196,11 @@ static int32_t parseTelnetTagValue(TAOS_SML_KV *pKV, const char **index,
   uint16_t len = 0;
   start = cur = *index;
 
-  while (1) {
-    // ',' or '\0' identifies a value
-    if (*cur == ',' || *cur == '\0') {
-      // '\0' indicates end of value
-      *is_last_kv = (*cur == '\0') ? true : false;
-      break;
-    }
-    cur++;
-    len++;
-  }
+  // ',' or '\0' identifies a value
+  cur = findTelnetChar(cur, info->lineEnd, ',');
+  // '\0' indicates end of value
+  *is_last_kv = (*cur == '\0') ? true : false;
+  len = (uint16_t)(cur - start);
 
   if (len == 0) {
     tfree(pKV->key);
@@ -302,10 +283,11 @@ static int32_t parseTelnetTagKvs(TAOS_SML_KV **pKVs, int *num_kvs,
   return ret;
 }
 
-int32_t tscParseTelnetLine(const char* line, TAOS_SML_DATA_POINT* smlData, SSmlLinesInfo* info) {
+int32_t tscParseTelnetLine(const char* line, TAOS_SML_DATA_POINT* smlData, SHashObj* keyHashTable, SSmlLinesInfo* info) {
   const char* index = line;
   int32_t ret = TSDB_CODE_SUCCESS;
 
+  info->lineEnd = line + strlen(line);
   //Parse metric
   ret = parseTelnetMetric(smlData, &index, info);
   if (ret) {
@@ -331,27 +313,32 @@ int32_t tscParseTelnetLine(const char* line, TAOS_SML_DATA_POINT* smlData, SSmlL
   tscDebug("OTD:0x%"PRIx64" Parse metric value finished", info->id);
 
   //Parse tagKVs
-  SHashObj *keyHashTable = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, false);
+  taosHashClear(keyHashTable);
   ret = parseTelnetTagKvs(&smlData->tags, &smlData->tagNum, &index, &smlData->childTableName, keyHashTable, info);
   if (ret) {
     tscError("OTD:0x%"PRIx64" Unable to parse tags", info->id);
-    taosHashCleanup(keyHashTable);
     return ret;
   }
   tscDebug("OTD:0x%"PRIx64" Parse tags finished", info->id);
-  taosHashCleanup(keyHashTable);
 
 
   return TSDB_CODE_SUCCESS;
 }
 
 int32_t tscParseTelnetLines(char* lines[], int numLines, SArray* points, SArray* failedLines, SSmlLinesInfo* info) {
+  // reused by all lines to detect duplicate tag keys
+  SHashObj *keyHashTable = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  if (keyHashTable == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
   for (int32_t i = 0; i < numLines; ++i) {
     TAOS_SML_DATA_POINT point = {0};
-    int32_t code = tscParseTelnetLine(lines[i], &point, info);
+    int32_t code = tscParseTelnetLine(lines[i], &point, keyHashTable, info);
     if (code != TSDB_CODE_SUCCESS) {
       tscError("OTD:0x%"PRIx64" data point line parse failed. line %d : %s", info->id, i, lines[i]);
       destroySmlDataPoint(&point);
+      taosHashCleanup(keyHashTable);
       return code;
     } else {
       tscDebug("OTD:0x%"PRIx64" data point line parse success. line %d", info->id, i);
@@ -359,6 +346,8 @@ int32_t tscParseTelnetLines(char* lines[], int numLines, SArray* points, SArray*
 
     taosArrayPush(points, &point);
   }
+
+  taosHashCleanup(keyHashTable);
   return TSDB_CODE_SUCCESS;
 }
 
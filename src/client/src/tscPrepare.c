@@ -332,7 +332,9 @@ int32_t fillTablesColumnsNull(SSqlObj* pSql) {
   STableDataBlocks* pOneTableBlock = *p;
   while(pOneTableBlock) {
     SSubmitBlk* pBlocks = (SSubmitBlk*) pOneTableBlock->pData;
-    if (pBlocks->numOfRows > 0 && pOneTableBlock->boundColumnInfo.numOfBound < pOneTableBlock->boundColumnInfo.numOfCols) {
+    // unbound columns of column-wise bound blocks are filled while merging
+    if (pBlocks->numOfRows > 0 && pOneTableBlock->pBindCols == NULL &&
+        pOneTableBlock->boundColumnInfo.numOfBound < pOneTableBlock->boundColumnInfo.numOfCols) {
       fillColumnsNull(pOneTableBlock, pBlocks->numOfRows);
     }
 
@@ -804,12 +806,17 @@ static FORCE_INLINE int doBindParam(STableDataBlocks* pBlock, char* data, SParam
   return TSDB_CODE_SUCCESS;
 }
 
+int32_t tscBindParam(STableDataBlocks* pBlock, char* data, SParamInfo* param, TAOS_BIND* bind) {
+  return doBindParam(pBlock, data, param, bind, 1);
+}
+
 static int32_t insertStmtGenLastBlock(STableDataBlocks** lastBlock, STableDataBlocks* pBlock) {
   *lastBlock = (STableDataBlocks*)malloc(sizeof(STableDataBlocks));
   memcpy(*lastBlock, pBlock, sizeof(STableDataBlocks));
   (*lastBlock)->cloned = true;
   
   (*lastBlock)->pData    = NULL;
+  (*lastBlock)->pBindCols = NULL;
   (*lastBlock)->ordered  = true;
   (*lastBlock)->prevTS   = INT64_MIN;
   (*lastBlock)->size     = sizeof(SSubmitBlk);
@@ -911,6 +918,221 @@ static int doBindBatchParam(STableDataBlocks* pBlock, SParamInfo* param, TAOS_MU
   return TSDB_CODE_SUCCESS;
 }
 
+static int32_t getParamColumnIndex(STableDataBlocks* pBlock, SParamInfo* param) {
+  SParsedDataColInfo* spd = &pBlock->boundColumnInfo;
+  for (int32_t i = 0; i < spd->numOfCols; ++i) {
+    if (spd->cols[i].offset == (int32_t)param->offset) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+// Values can be kept column-wise only when the server accepts columnar submit blocks, the block is still
+// empty, and each bound column has exactly one parameter in the first row.
+static bool canBindColumnar(STscStmt* pStmt, STableDataBlocks* pBlock) {
+  SSqlObj* pSql = pStmt->pSql;
+
+  if ((pSql->pTscObj->features & TSDB_CONN_FEATURE_COLUMNAR_SUBMIT) == 0 || pSql->cmd.insertParam.schemaAttached) {
+    return false;
+  }
+
+  // batchSize follows the rows of current table for multiple table insertion
+  if (pSql->cmd.batchSize != 0) {
+    return false;
+  }
+
+  if (pBlock->numOfParams == 0 || pBlock->numOfParams != pBlock->boundColumnInfo.numOfBound) {
+    return false;
+  }
+
+  for (uint32_t j = 0; j < pBlock->numOfParams; ++j) {
+    if (getParamColumnIndex(pBlock, &pBlock->params[j]) < 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static int32_t bindColumnEnsureRows(SBindColumn* pCol, int32_t rows, bool isVar) {
+  if (rows <= pCol->rowCapacity) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t capacity = MAX(rows, pCol->rowCapacity * 2);
+
+  uint8_t* bitmap = realloc(pCol->bitmap, BIND_COL_BITMAP_LEN(capacity));
+  if (bitmap == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+  pCol->bitmap = bitmap;
+
+  if (isVar) {
+    int32_t* offsets = realloc(pCol->offsets, capacity * sizeof(int32_t));
+    if (offsets == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+    pCol->offsets = offsets;
+  }
+
+  pCol->rowCapacity = capacity;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t bindColumnEnsureData(SBindColumn* pCol, int32_t len) {
+  if (len <= pCol->dataCapacity) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t capacity = MAX(len, pCol->dataCapacity * 2);
+
+  char* data = realloc(pCol->data, capacity);
+  if (data == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  pCol->data = data;
+  pCol->dataCapacity = capacity;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int doBindBatchParamColumnar(STableDataBlocks* pBlock, SParamInfo* param, TAOS_MULTI_BIND* bind) {
+  if (bind->buffer_type != param->type || !isValidDataType(param->type)) {
+    tscError("column mismatch or invalid");
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  if (IS_VAR_DATA_TYPE(param->type) && bind->length == NULL) {
+    tscError("BINARY/NCHAR no length");
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  SBindColumn* pCol = &pBlock->pBindCols[getParamColumnIndex(pBlock, param)];
+  int32_t      start = pCol->numOfRows;
+
+  if (bindColumnEnsureRows(pCol, start + bind->num, IS_VAR_DATA_TYPE(param->type)) != TSDB_CODE_SUCCESS) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  if (!IS_VAR_DATA_TYPE(param->type)) {
+    int32_t bytes = tDataTypes[param->type].bytes;
+    if (bindColumnEnsureData(pCol, (start + bind->num) * bytes) != TSDB_CODE_SUCCESS) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    char* data = pCol->data + start * bytes;
+    if (bind->buffer_length == (uintptr_t)bytes) {
+      memcpy(data, bind->buffer, bind->num * bytes);
+    } else {
+      for (int i = 0; i < bind->num; ++i) {
+        memcpy(data + bytes * i, (char *)bind->buffer + bind->buffer_length * i, bytes);
+      }
+    }
+
+    for (int i = 0; i < bind->num; ++i, data += bytes) {
+      if (bind->is_null != NULL && bind->is_null[i]) {
+        setNull(data, param->type, param->bytes);
+        BIND_COL_SET_NULL(pCol->bitmap, start + i);
+        continue;
+      }
+
+      BIND_COL_SET_VALUE(pCol->bitmap, start + i);
+      if (param->offset == 0 && tsCheckTimestamp(pBlock, data) != TSDB_CODE_SUCCESS) {
+        tscError("invalid timestamp");
+        return TSDB_CODE_TSC_INVALID_VALUE;
+      }
+    }
+  } else {
+    for (int i = 0; i < bind->num; ++i) {
+      pCol->offsets[start + i] = pCol->dataLen;
+
+      if (bind->is_null != NULL && bind->is_null[i]) {
+        BIND_COL_SET_NULL(pCol->bitmap, start + i);
+        continue;
+      }
+
+      // bytes of binary column include the VarData header, the server rejects values not fit in it
+      int32_t maxLen = (param->type == TSDB_DATA_TYPE_BINARY) ? param->bytes - VARSTR_HEADER_SIZE : param->bytes;
+      if (bind->length[i] > (uintptr_t)maxLen) {
+        tscError("%s length too long, ignore it, max:%d, actual:%d",
+                 (param->type == TSDB_DATA_TYPE_BINARY) ? "binary" : "nchar string", maxLen, (int32_t)bind->length[i]);
+        return TSDB_CODE_TSC_INVALID_VALUE;
+      }
+
+      if (bindColumnEnsureData(pCol, pCol->dataLen + VARSTR_HEADER_SIZE + param->bytes) != TSDB_CODE_SUCCESS) {
+        return TSDB_CODE_TSC_OUT_OF_MEMORY;
+      }
+
+      char* src = (char *)bind->buffer + bind->buffer_length * i;
+      char* data = pCol->data + pCol->dataLen;
+      if (param->type == TSDB_DATA_TYPE_BINARY) {
+        STR_WITH_SIZE_TO_VARSTR(data, src, (VarDataLenT)bind->length[i]);
+      } else {
+        int32_t output = 0;
+        if (!taosMbsToUcs4(src, bind->length[i], varDataVal(data), param->bytes - VARSTR_HEADER_SIZE, &output)) {
+          tscError("convert nchar string to UCS4_LE failed:%s", src);
+          return TSDB_CODE_TSC_INVALID_VALUE;
+        }
+        varDataSetLen(data, output);
+      }
+
+      BIND_COL_SET_VALUE(pCol->bitmap, start + i);
+      pCol->dataLen += varDataTLen(data);
+    }
+  }
+
+  pCol->numOfRows = start + bind->num;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int insertStmtBindColumnsBatch(STscStmt* pStmt, STableDataBlocks* pBlock, TAOS_MULTI_BIND* bind, int colIdx) {
+  SSqlCmd* pCmd = &pStmt->pSql->cmd;
+  int      rowNum = bind->num;
+
+  if (colIdx == -1) {
+    for (uint32_t j = 0; j < pBlock->numOfParams; ++j) {
+      SParamInfo* param = &pBlock->params[j];
+      if (bind[param->idx].num != rowNum) {
+        tscError("0x%"PRIx64" param %d: num[%d:%d] not match", pStmt->pSql->self, param->idx, rowNum, bind[param->idx].num);
+        return invalidOperationMsg(tscGetErrorMsgPayload(pCmd), "bind row num mismatch");
+      }
+
+      int code = doBindBatchParamColumnar(pBlock, param, &bind[param->idx]);
+      if (code != TSDB_CODE_SUCCESS) {
+        tscError("0x%"PRIx64" bind column %d: type mismatch or invalid", pStmt->pSql->self, param->idx);
+        return invalidOperationMsg(tscGetErrorMsgPayload(pCmd), "bind column type mismatch or invalid");
+      }
+    }
+
+    pCmd->batchSize += rowNum - 1;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SParamInfo* param = &pBlock->params[colIdx];
+
+  int code = doBindBatchParamColumnar(pBlock, param, bind);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("0x%"PRIx64" bind column %d: type mismatch or invalid", pStmt->pSql->self, param->idx);
+    return invalidOperationMsg(tscGetErrorMsgPayload(pCmd), "bind column type mismatch or invalid");
+  }
+
+  if (colIdx == (pBlock->numOfParams - 1)) {
+    int32_t numOfRows = pBlock->pBindCols[getParamColumnIndex(pBlock, param)].numOfRows;
+    for (uint32_t j = 0; j < pBlock->numOfParams; ++j) {
+      if (pBlock->pBindCols[getParamColumnIndex(pBlock, &pBlock->params[j])].numOfRows != numOfRows) {
+        tscError("0x%"PRIx64" param %d: rows not match, expect:%d", pStmt->pSql->self, pBlock->params[j].idx, numOfRows);
+        return invalidOperationMsg(tscGetErrorMsgPayload(pCmd), "bind row num mismatch");
+      }
+    }
+
+    pCmd->batchSize += rowNum - 1;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static int insertStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
   SSqlCmd* pCmd = &stmt->pSql->cmd;
   STscStmt* pStmt = (STscStmt*)stmt;
@@ -946,6 +1168,13 @@ static int insertStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
     }
   }
 
+  if (pBlock->pBindCols != NULL) {
+    int32_t code = tscFlattenBindColumns(pBlock);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
   uint32_t totalDataSize = sizeof(SSubmitBlk) + (pCmd->batchSize + 1) * pBlock->rowSize;
   if (totalDataSize > pBlock->nAllocSize) {
     const double factor = 1.5;
@@ -1015,6 +1244,17 @@ static int insertStmtBindParamBatch(STscStmt* stmt, TAOS_MULTI_BIND* bind, int c
     return invalidOperationMsg(tscGetErrorMsgPayload(&stmt->pSql->cmd), "invalid param colIdx");
   }
 
+  if (pBlock->pBindCols == NULL && colIdx <= 0 && canBindColumnar(pStmt, pBlock)) {
+    pBlock->pBindCols = calloc(tscGetNumOfColumns(pBlock->pTableMeta), sizeof(SBindColumn));
+    if (pBlock->pBindCols == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+  }
+
+  if (pBlock->pBindCols != NULL) {
+    return insertStmtBindColumnsBatch(pStmt, pBlock, bind, colIdx);
+  }
+
   uint32_t totalDataSize = sizeof(SSubmitBlk) + (pCmd->batchSize + rowNum) * pBlock->rowSize;
   if (totalDataSize > pBlock->nAllocSize) {
     const double factor = 1.5;
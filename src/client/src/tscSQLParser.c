@@ -8545,6 +8545,7 @@ int32_t loadAllTableMeta(SSqlObj* pSql, struct SSqlInfo* pInfo) {
         if (code != TSDB_CODE_SUCCESS) {
           char* t = strdup(name);
           taosArrayPush(plist, &t);
+          atomic_add_fetch_64(&tscMetaCacheStat.miss, 1);
           continue;
         }
       } else if (pTableMeta->tableType == TSDB_SUPER_TABLE) {
@@ -8567,6 +8568,7 @@ int32_t loadAllTableMeta(SSqlObj* pSql, struct SSqlInfo* pInfo) {
         }
       }
 
+      atomic_add_fetch_64(&tscMetaCacheStat.hit, 1);
       if (taosHashGet(pCmd->pTableMetaMap, name, len) == NULL) {
         STableMeta* pMeta = tscTableMetaDup(pTableMeta);
         STableMetaVgroupInfo tvi = { .pTableMeta = pMeta,  .vgroupIdList = pVgroupIdList};
@@ -8576,6 +8578,7 @@ int32_t loadAllTableMeta(SSqlObj* pSql, struct SSqlInfo* pInfo) {
       // Add to the retrieve table meta array list.
       // If the tableMeta is missing, the cached vgroup list for the corresponding super table will be ignored.
       tscDebug("0x%"PRIx64" failed to retrieve table meta %s from local buf", pSql->self, name);
+      atomic_add_fetch_64(&tscMetaCacheStat.miss, 1);
 
       char* t = strdup(name);
       taosArrayPush(plist, &t);
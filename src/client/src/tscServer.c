@@ -27,6 +27,9 @@
 #include "tsclient.h"
 #include "ttimer.h"
 
+#define TSC_FLOWCTRL_MAX_DELAY 100  // ms, vnode never hints a longer delay
+#define TSC_META_PREFETCH_INTERVAL 30000  // ms, child table metas of a super table are prefetched at most once in it
+
 int (*tscBuildMsg[TSDB_SQL_MAX])(SSqlObj *pSql, SSqlInfo *pInfo) = {0};
 
 int (*tscProcessMsgRsp[TSDB_SQL_MAX])(SSqlObj *pSql);
@@ -130,7 +133,7 @@ void tscUpdateMgmtEpSet(SSqlObj *pSql, SRpcEpSet *pEpSet) {
   taosCorEndWrite(&pCorEpSet->version);
 }
 
-static void tscDumpEpSetFromVgroupInfo(SRpcEpSet *pEpSet, SNewVgroupInfo *pVgroupInfo) {
+void tscDumpEpSetFromVgroupInfo(SRpcEpSet *pEpSet, SNewVgroupInfo *pVgroupInfo) {
   if (pVgroupInfo == NULL) { return;}
   int8_t inUse = pVgroupInfo->inUse;
   pEpSet->inUse = (inUse >= 0 && inUse < TSDB_MAX_REPLICA) ? inUse: 0; 
@@ -143,6 +146,10 @@ static void tscDumpEpSetFromVgroupInfo(SRpcEpSet *pEpSet, SNewVgroupInfo *pVgrou
 
 static void tscUpdateVgroupInfo(SSqlObj *pSql, SRpcEpSet *pEpSet) {
   SSqlCmd *pCmd = &pSql->cmd;
+  if (tscGetQueryInfo(pCmd) == NULL) {  // e.g., the sub-wait of a subscription
+    return;
+  }
+
   STableMetaInfo *pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd,  0);
   if (pTableMetaInfo == NULL || pTableMetaInfo->pTableMeta == NULL) {
     return;
@@ -363,6 +370,42 @@ void tscSetFqdnErrorMsg(SSqlObj* pSql, SRpcEpSet* pEpSet) {
   }
 }
 
+static void tscUpdateVgroupFlowCtrl(int32_t vgId, int32_t retryAfter) {
+  if (retryAfter <= 0) {
+    if (taosHashGetSize(tscVgroupFlowCtrlMap) > 0) {
+      taosHashRemove(tscVgroupFlowCtrlMap, &vgId, sizeof(vgId));
+    }
+    return;
+  }
+
+  int64_t until = taosGetTimestampMs() + MIN(retryAfter, TSC_FLOWCTRL_MAX_DELAY);
+  taosHashPut(tscVgroupFlowCtrlMap, &vgId, sizeof(vgId), &until, sizeof(until));
+}
+
+static int32_t tscGetVgroupFlowCtrlDelay(int32_t vgId) {
+  int64_t until = 0;
+  if (taosHashGetClone(tscVgroupFlowCtrlMap, &vgId, sizeof(vgId), NULL, &until) == NULL) {
+    return 0;
+  }
+
+  int64_t ms = until - taosGetTimestampMs();
+  return (ms <= 0) ? 0 : (int32_t)MIN(ms, TSC_FLOWCTRL_MAX_DELAY);
+}
+
+static void tscSendPacedSubmit(void *param, void *tmrId) {
+  int64_t  rid = (int64_t)param;
+  SSqlObj *pSql = (SSqlObj *)taosAcquireRef(tscObjRef, rid);
+  if (pSql == NULL) return;
+
+  int32_t code = tscSendMsgToServer(pSql);
+  if (code != TSDB_CODE_SUCCESS) {
+    pSql->res.code = code;
+    tscAsyncResultOnError(pSql);
+  }
+
+  taosReleaseRef(tscObjRef, rid);
+}
+
 void tscProcessMsgFromServer(SRpcMsg *rpcMsg, SRpcEpSet *pEpSet) {
   TSDB_CACHE_PTR_TYPE handle = (TSDB_CACHE_PTR_TYPE) rpcMsg->ahandle;
   SSqlObj* pSql = (SSqlObj*)taosAcquireRef(tscObjRef, handle);
@@ -498,6 +541,15 @@ void tscProcessMsgFromServer(SRpcMsg *rpcMsg, SRpcEpSet *pEpSet) {
       pMsg->numOfFailedBlocks = htonl(pMsg->numOfFailedBlocks);
 
       pRes->numOfRows += pMsg->affectedRows;
+
+      // flow control hint appended by vnode
+      int32_t hintOffset = sizeof(SShellSubmitRspMsg) + pMsg->numOfFailedBlocks * sizeof(SShellSubmitRspBlock);
+      STableMetaInfo *pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, 0);
+      if (pRes->rspLen >= hintOffset + (int32_t)sizeof(SShellSubmitRspFlowCtrl) && pTableMetaInfo != NULL &&
+          pTableMetaInfo->pTableMeta != NULL) {
+        SShellSubmitRspFlowCtrl *pHint = (SShellSubmitRspFlowCtrl *)POINTER_SHIFT(pMsg, hintOffset);
+        tscUpdateVgroupFlowCtrl(pTableMetaInfo->pTableMeta->vgId, ntohl(pHint->retryAfter));
+      }
       tscDebug("0x%"PRIx64" SQL cmd:%s, code:%s inserted rows:%d rspLen:%d", pSql->self, sqlCmd[pCmd->command],
                tstrerror(pRes->code), pMsg->affectedRows, pRes->rspLen);
     } else {
@@ -544,7 +596,8 @@ int doBuildAndSendMsg(SSqlObj *pSql) {
       pCmd->command == TSDB_SQL_CONNECT ||
       pCmd->command == TSDB_SQL_HB ||
       pCmd->command == TSDB_SQL_RETRIEVE_FUNC ||
-      pCmd->command == TSDB_SQL_STABLEVGROUP) {
+      pCmd->command == TSDB_SQL_STABLEVGROUP ||
+      pCmd->command == TSDB_SQL_STABLE_TABLES) {
     pRes->code = tscBuildMsg[pCmd->command](pSql, NULL);
   }
   
@@ -553,6 +606,18 @@ int doBuildAndSendMsg(SSqlObj *pSql) {
     return TSDB_CODE_SUCCESS;
   }
 
+  // a submit to a vgroup under backpressure is sent by a timer once the delay hinted by its vnode passes, since this
+  // may run in rpc or callback threads shared by other requests
+  if (pCmd->command == TSDB_SQL_INSERT) {
+    STableMeta *pTableMeta = tscGetMetaInfo(tscGetQueryInfo(pCmd), 0)->pTableMeta;
+    int32_t     ms = tscGetVgroupFlowCtrlDelay(pTableMeta->vgId);
+    if (ms > 0 && taosTmrStart(tscSendPacedSubmit, ms, (void *)pSql->self, tscTmr) != NULL) {
+      tscDebug("0x%" PRIx64 " vgId:%d is under backpressure, submit is paced for %dms", pSql->self, pTableMeta->vgId,
+               ms);
+      return TSDB_CODE_SUCCESS;
+    }
+  }
+
   int32_t code = tscSendMsgToServer(pSql);
 
   // NOTE: if code is TSDB_CODE_SUCCESS, pSql may have been released here already by other threads.
@@ -691,6 +756,9 @@ static int32_t tscEstimateQueryMsgSize(SSqlObj *pSql) {
     for (int32_t i = 0; i < numOfGroups; ++i) {
       SVgroupTableInfo *pTableInfo = taosArrayGet(pTableMetaInfo->pVgroupTables, i);
       totalTables += (int32_t) taosArrayGetSize(pTableInfo->itemList);
+      if (pTableInfo->joinList != NULL) {
+        totalTables += (int32_t) taosArrayGetSize(pTableInfo->joinList);
+      }
     }
 
     tableSerialize = totalTables * sizeof(STableIdInfo);
@@ -757,6 +825,7 @@ static char *doSerializeTableInfo(SQueryTableMsg *pQueryMsg, SSqlObj *pSql, STab
     pTableIdInfo->key = htobe64(tscGetSubscriptionProgress(pSql->pSubscription, pTableMeta->id.uid, dfltKey));
 
     pQueryMsg->numOfTables = htonl(1);  // set the number of tables
+    pQueryMsg->numOfJoinTables = 0;
     pMsg += sizeof(STableIdInfo);
   } else { // it is a subquery of the super table query, this EP info is acquired from vgroupInfo
     int32_t index = pTableMetaInfo->vgroupIndex;
@@ -785,6 +854,21 @@ static char *doSerializeTableInfo(SQueryTableMsg *pQueryMsg, SSqlObj *pSql, STab
       pTableIdInfo->key = htobe64(tscGetSubscriptionProgress(pSql->pSubscription, pItem->uid, dfltKey));
       pMsg += sizeof(STableIdInfo);
     }
+
+    // the partner tables of a co-located join, the vnode builds the timestamp intersection by itself
+    int32_t numOfJoinTables = (pTableIdList->joinList != NULL)? (int32_t)taosArrayGetSize(pTableIdList->joinList):0;
+    assert(numOfJoinTables == 0 || numOfJoinTables == numOfTables);
+    pQueryMsg->numOfJoinTables = htonl(numOfJoinTables);
+
+    for(int32_t i = 0; i < numOfJoinTables; ++i) {
+      STableIdInfo* pItem = taosArrayGet(pTableIdList->joinList, i);
+
+      STableIdInfo *pTableIdInfo = (STableIdInfo *)pMsg;
+      pTableIdInfo->tid = htonl(pItem->tid);
+      pTableIdInfo->uid = htobe64(pItem->uid);
+      pTableIdInfo->key = htobe64(dfltKey);
+      pMsg += sizeof(STableIdInfo);
+    }
   }
 
   char n[TSDB_TABLE_FNAME_LEN] = {0};
@@ -926,6 +1010,7 @@ int tscBuildQueryMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   pQueryMsg->fillType       = htons(query.fillType);
   pQueryMsg->limit          = htobe64(query.limit.limit);
   pQueryMsg->offset         = htobe64(query.limit.offset);
+  pQueryMsg->vgroupLimit    = htobe64(query.prjInfo.vgroupLimit);
   pQueryMsg->numOfCols      = htons(query.numOfCols);
 
   pQueryMsg->interval.interval     = htobe64(query.interval.interval);
@@ -1846,6 +1931,13 @@ int tscProcessRetrieveGlobalMergeRsp(SSqlObj *pSql) {
   qTableQuery(pQueryInfo->pQInfo, &localQueryId);
   convertQueryResult(pRes, pQueryInfo, pSql->self, true);
 
+  // nothing merged before the chosen source runs out of rows, continue after its next block arrives
+  if (pRes->code == TSDB_CODE_SUCCESS && pRes->numOfRows == 0 && pRes->pMerger->pPendingSrc != NULL) {
+    pRes->completed = false;
+    tscFetchGlobalMergeSource(pSql);
+    return code;
+  }
+
   code = pRes->code;
   if (pRes->code == TSDB_CODE_SUCCESS) {
     (*pSql->fp)(pSql->param, pSql, pRes->numOfRows);
@@ -1931,6 +2023,22 @@ int tscBuildSTableVgroupMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   return TSDB_CODE_SUCCESS;
 }
 
+int tscBuildSTableTablesMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
+  SSqlCmd *pCmd = &pSql->cmd;
+
+  SSTableTablesMsg *pTablesMsg = (SSTableTablesMsg *)pCmd->payload;
+  STableMetaInfo *  pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, 0);
+  int32_t           code = tNameExtractFullName(&pTableMetaInfo->name, pTablesMsg->tableFname);
+  assert(code == TSDB_CODE_SUCCESS);
+
+  pTablesMsg->maxTables = htonl(tsMetaPrefetchTables);
+
+  pCmd->msgType = TSDB_MSG_TYPE_CM_STABLE_TABLES;
+  pCmd->payloadLen = sizeof(SSTableTablesMsg);
+
+  return TSDB_CODE_SUCCESS;
+}
+
 int tscBuildRetrieveFuncMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   SSqlCmd *pCmd = &pSql->cmd;
 
@@ -2081,6 +2189,8 @@ static void doAddTableMetaToLocalBuf(STableMeta* pTableMeta, STableMetaMsg* pMet
     CChildTableMeta* cMeta = tscCreateChildMeta(pTableMeta);
     taosHashPut(tscTableMetaMap, pMetaMsg->tableFname, strlen(pMetaMsg->tableFname), cMeta, sizeof(CChildTableMeta));
     tfree(cMeta);
+
+    tscEvictTableMetaIfNeeded();
   } else {
     uint32_t s = tscGetTableMetaSize(pTableMeta);
     taosHashPut(tscTableMetaMap, pMetaMsg->tableFname, strlen(pMetaMsg->tableFname), pTableMeta, s);
@@ -2116,6 +2226,10 @@ int tscProcessTableMetaRsp(SSqlObj *pSql) {
     doUpdateVgroupInfo(pTableMeta->vgId, &pMetaMsg->vgroup);
   }
 
+  if (pTableMeta->tableType == TSDB_CHILD_TABLE) {
+    tscPrefetchSTableMeta(pSql->pTscObj, pTableMeta->sTableName);
+  }
+
   tscDebug("0x%"PRIx64" recv table meta, uid:%" PRIu64 ", tid:%d, name:%s, numOfCols:%d, numOfTags:%d", pSql->self,
       pTableMeta->id.uid, pTableMeta->id.tid, tNameGetTableName(&pTableMetaInfo->name), pTableMeta->tableInfo.numOfColumns,
       pTableMeta->tableInfo.numOfTags);
@@ -2323,6 +2437,9 @@ int tscProcessMultiTableMetaRsp(SSqlObj *pSql) {
 
     // create the tableMeta and add it into the TableMeta map
     doAddTableMetaToLocalBuf(pTableMeta, pMetaMsg, updateStableMeta);
+    if (updateStableMeta) {
+      tscPrefetchSTableMeta(pSql->pTscObj, pTableMeta->sTableName);
+    }
 
     // for each vgroup, only update the information once.
     int64_t vgId = pMetaMsg->vgroup.vgId;
@@ -2410,6 +2527,109 @@ int tscProcessMultiTableMetaRsp(SSqlObj *pSql) {
   return TSDB_CODE_SUCCESS;
 }
 
+int tscProcessSTableTablesRsp(SSqlObj *pSql) {
+  SSqlRes *pRes = &pSql->res;
+  if (pRes->pRsp == NULL || pRes->rspLen < (int32_t)sizeof(SSTableTablesRspMsg)) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  SSTableTablesRspMsg *pRsp = (SSTableTablesRspMsg *)pRes->pRsp;
+  uint64_t suid        = htobe64(pRsp->suid);
+  int32_t  sversion    = htonl(pRsp->sversion);
+  int32_t  tversion    = htonl(pRsp->tversion);
+  int32_t  numOfTables = htonl(pRsp->numOfTables);
+  int32_t  contLen     = htonl(pRsp->contLen);
+  int32_t  rawLen      = htonl(pRsp->rawLen);
+
+  if (contLen + (int32_t)sizeof(SSTableTablesRspMsg) > pRes->rspLen || rawLen < TSDB_TABLE_FNAME_LEN + (int32_t)sizeof(SVgroupsMsg)) {
+    tscError("0x%" PRIx64 " invalid stable tables rsp, rspLen:%d contLen:%d rawLen:%d", pSql->self, pRes->rspLen,
+             contLen, rawLen);
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  char *buf = NULL;
+  char *pMsg = pRsp->data;
+  if (pRsp->compressed) {
+    buf = malloc(rawLen);
+    if (buf == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    int32_t len = tsDecompressString(pRsp->data, contLen, 1, buf, rawLen, ONE_STAGE_COMP, NULL, 0);
+    if (len != rawLen) {
+      tscError("0x%" PRIx64 " failed to decompress stable tables rsp, rawLen:%d len:%d", pSql->self, rawLen, len);
+      tfree(buf);
+      return TSDB_CODE_TSC_INVALID_VALUE;
+    }
+
+    pMsg = buf;
+  }
+
+  char *pEnd = pMsg + rawLen;
+
+  char sTableName[TSDB_TABLE_FNAME_LEN] = {0};
+  tstrncpy(sTableName, pMsg, TSDB_TABLE_FNAME_LEN);
+  size_t nameLen = strnlen(sTableName, TSDB_TABLE_FNAME_LEN);
+  pMsg += TSDB_TABLE_FNAME_LEN;
+
+  SVgroupsMsg *pVgroupsMsg = (SVgroupsMsg *)pMsg;
+  int32_t      numOfVgroups = htonl(pVgroupsMsg->numOfVgroups);
+  if (numOfVgroups < 0 || pMsg + sizeof(SVgroupsMsg) + numOfVgroups * sizeof(SVgroupMsg) > pEnd) {
+    tfree(buf);
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  for (int32_t i = 0; i < numOfVgroups; ++i) {
+    SVgroupMsg *vmsg = &pVgroupsMsg->vgroups[i];
+    vmsg->vgId = htonl(vmsg->vgId);
+    for (int32_t k = 0; k < vmsg->numOfEps; ++k) {
+      vmsg->epAddr[k].port = htons(vmsg->epAddr[k].port);
+    }
+
+    doUpdateVgroupInfo(vmsg->vgId, vmsg);
+  }
+
+  pMsg += sizeof(SVgroupsMsg) + numOfVgroups * sizeof(SVgroupMsg);
+
+  // the cached super table meta is dropped if it is older than the one in mnode, and renewed on next access
+  STableMeta *pSTableMeta = NULL;
+  size_t      size = 0;
+  if (taosHashGetCloneExt(tscTableMetaMap, sTableName, nameLen, NULL, (void **)&pSTableMeta, &size) != NULL) {
+    if (pSTableMeta->id.uid != suid || pSTableMeta->sversion < sversion || pSTableMeta->tversion < tversion) {
+      tscDebug("0x%" PRIx64 " stable:%s, cached meta is stale, uid:%" PRIu64 " sversion:%d tversion:%d", pSql->self,
+               sTableName, pSTableMeta->id.uid, pSTableMeta->sversion, pSTableMeta->tversion);
+      taosHashRemove(tscTableMetaMap, sTableName, nameLen);
+      atomic_add_fetch_64(&tscMetaCacheStat.stale, 1);
+    }
+  }
+  tfree(pSTableMeta);
+
+  CChildTableMeta cMeta = {.tableType = TSDB_CHILD_TABLE, .suid = suid};
+  tstrncpy(cMeta.sTableName, sTableName, TSDB_TABLE_FNAME_LEN);
+
+  int32_t i = 0;
+  for (; i < numOfTables && pMsg + sizeof(SChildTableInfoMsg) <= pEnd; ++i) {
+    SChildTableInfoMsg *pChild = (SChildTableInfoMsg *)pMsg;
+    int16_t             len = htons(pChild->nameLen);
+    if (len <= 0 || len >= TSDB_TABLE_FNAME_LEN || pChild->name + len > pEnd) break;
+
+    cMeta.vgId = htonl(pChild->vgId);
+    cMeta.id.tid = htonl(pChild->tid);
+    cMeta.id.uid = htobe64(pChild->uid);
+    taosHashPut(tscTableMetaMap, pChild->name, len, &cMeta, sizeof(CChildTableMeta));
+
+    pMsg = pChild->name + len;
+  }
+
+  tfree(buf);
+  atomic_add_fetch_64(&tscMetaCacheStat.prefetched, i);
+  tscEvictTableMetaIfNeeded();
+
+  tscDebug("0x%" PRIx64 " stable:%s, %d child table metas and %d vgroups are prefetched, total cached:%d", pSql->self,
+           sTableName, i, numOfVgroups, (int32_t)taosHashGetSize(tscTableMetaMap));
+  return TSDB_CODE_SUCCESS;
+}
+
 int tscProcessSTableVgroupRsp(SSqlObj *pSql) {
   // master sqlObj locates in param
   SSqlObj* parent = (SSqlObj*)taosAcquireRef(tscObjRef, (int64_t)pSql->param);
@@ -2582,6 +2802,7 @@ int tscProcessConnectRsp(SSqlObj *pSql) {
   strcpy(pObj->sversion, pConnect->serverVersion);
   pObj->writeAuth = pConnect->writeAuth;
   pObj->superAuth = pConnect->superAuth;
+  pObj->features = pConnect->features;
   pObj->connId = htonl(pConnect->connId);
 
   createHbObj(pObj);
@@ -2610,6 +2831,7 @@ int tscProcessDropDbRsp(SSqlObj *pSql) {
   
   taosHashClear(tscTableMetaMap);
   taosHashClear(tscVgroupMap);
+  taosHashClear(tscMetaPrefetchMap);
   taosCacheEmpty(tscVgroupListBuf);
   return 0;
 }
@@ -2653,6 +2875,14 @@ int tscProcessCompactRsp(SSqlObj *pSql) {
   return TSDB_CODE_SUCCESS; 
 }
 
+int tscProcessSubWaitRsp(SSqlObj *pSql) {
+  SSqlRes *pRes = &pSql->res;
+
+  SSubWaitRsp *pRsp = (SSubWaitRsp *)pRes->pRsp;
+  pRes->numOfRows = (pRsp != NULL && pRes->rspLen >= sizeof(SSubWaitRsp)) ? htonl(pRsp->numOfTables) : 0;
+  return TSDB_CODE_SUCCESS;
+}
+
 int tscProcessShowCreateRsp(SSqlObj *pSql) {
   return tscLocalResultCommonBuilder(pSql, 1);
 }
@@ -2958,18 +3188,21 @@ int32_t tscGetTableMetaImpl(SSqlObj* pSql, STableMetaInfo *pTableMetaInfo, bool
       int32_t code = tscCreateTableMetaFromSTableMeta(&pTableMetaInfo->pTableMeta, name, &pTableMetaInfo->tableMetaCapacity, (STableMeta **)(&pSTMeta));
       pSql->pBuf   = (void *)(pSTMeta); 
       if (code != TSDB_CODE_SUCCESS) {
+        atomic_add_fetch_64(&tscMetaCacheStat.miss, 1);
         return getTableMetaFromMnode(pSql, pTableMetaInfo, autocreate);
       }
     }
 
     tscDebug("0x%"PRIx64 " %s retrieve tableMeta from cache, numOfCols:%d, numOfTags:%d", pSql->self, name, pMeta->tableInfo.numOfColumns, pMeta->tableInfo.numOfTags);
+    atomic_add_fetch_64(&tscMetaCacheStat.hit, 1);
     return TSDB_CODE_SUCCESS;
   }
 
   if (onlyLocal) {
     return TSDB_CODE_TSC_NO_META_CACHED;
   }
-  
+
+  atomic_add_fetch_64(&tscMetaCacheStat.miss, 1);
   return getTableMetaFromMnode(pSql, pTableMetaInfo, autocreate);
 }
 
@@ -3139,6 +3372,65 @@ int tscGetSTableVgroupInfo(SSqlObj *pSql, SQueryInfo* pQueryInfo) {
   return code;
 }
 
+static void tscPrefetchSTableMetaCallback(void *param, TAOS_RES *tres, int code) {
+  SSqlObj *pSql = tres;
+  if (code != TSDB_CODE_SUCCESS) {
+    tscDebug("0x%" PRIx64 " failed to prefetch child table metas, code:%s", pSql->self, tstrerror(code));
+  }
+}
+
+/**
+ * fill the local meta cache with the child tables of a super table in one request, it is issued when a child table
+ * is missed in the cache, and repeated at most once per TSC_META_PREFETCH_INTERVAL for the same super table.
+ * @param pObj        connection
+ * @param sTableName  super table full name
+ */
+void tscPrefetchSTableMeta(STscObj *pObj, const char *sTableName) {
+  if (tsMetaPrefetchTables <= 0 || tscMetaPrefetchMap == NULL) {
+    return;
+  }
+
+  size_t  len = strnlen(sTableName, TSDB_TABLE_FNAME_LEN);
+  int64_t now = taosGetTimestampMs();
+  int64_t last = 0;
+  taosHashGetClone(tscMetaPrefetchMap, sTableName, len, NULL, &last);
+  if (last > 0 && now - last < TSC_META_PREFETCH_INTERVAL) {
+    return;
+  }
+
+  taosHashPut(tscMetaPrefetchMap, sTableName, len, &now, sizeof(now));
+
+  SName sname = {0};
+  if (tNameFromString(&sname, sTableName, T_NAME_ACCT | T_NAME_DB | T_NAME_TABLE) != TSDB_CODE_SUCCESS) {
+    return;
+  }
+
+  SSqlObj *pNew = calloc(1, sizeof(SSqlObj));
+  if (pNew == NULL) {
+    return;
+  }
+
+  pNew->pTscObj = pObj;
+  pNew->signature = pNew;
+  pNew->cmd.command = TSDB_SQL_STABLE_TABLES;
+
+  SQueryInfo *pNewQueryInfo = tscGetQueryInfoS(&pNew->cmd);
+  if (pNewQueryInfo == NULL || tscAllocPayload(&pNew->cmd, sizeof(SSTableTablesMsg)) != TSDB_CODE_SUCCESS) {
+    tscFreeSqlObj(pNew);
+    return;
+  }
+
+  tscAddTableMetaInfo(pNewQueryInfo, &sname, NULL, NULL, NULL, NULL);
+  registerSqlObj(pNew);
+
+  pNew->fp = tscPrefetchSTableMetaCallback;
+  pNew->param = pNew;
+
+  tscDebug("0x%" PRIx64 " new sqlObj to prefetch child table metas of stable:%s, maxTables:%d", pNew->self, sTableName,
+           tsMetaPrefetchTables);
+  tscBuildAndSendRequest(pNew, NULL);
+}
+
 void tscInitMsgsFp() {
   tscBuildMsg[TSDB_SQL_SELECT] = tscBuildQueryMsg;
   tscBuildMsg[TSDB_SQL_INSERT] = tscBuildSubmitMsg;
@@ -3171,6 +3463,7 @@ void tscInitMsgsFp() {
   tscBuildMsg[TSDB_SQL_USE_DB] = tscBuildUseDbMsg;
   tscBuildMsg[TSDB_SQL_STABLEVGROUP] = tscBuildSTableVgroupMsg;
   tscBuildMsg[TSDB_SQL_RETRIEVE_FUNC] = tscBuildRetrieveFuncMsg;
+  tscBuildMsg[TSDB_SQL_STABLE_TABLES] = tscBuildSTableTablesMsg;
 
   tscBuildMsg[TSDB_SQL_HB] = tscBuildHeartBeatMsg;
   tscBuildMsg[TSDB_SQL_SHOW] = tscBuildShowMsg;
@@ -3181,6 +3474,7 @@ void tscInitMsgsFp() {
 
   tscProcessMsgRsp[TSDB_SQL_SELECT] = tscProcessQueryRsp;
   tscProcessMsgRsp[TSDB_SQL_FETCH] = tscProcessRetrieveRspFromNode;
+  tscProcessMsgRsp[TSDB_SQL_SUB_WAIT] = tscProcessSubWaitRsp;
 
   tscProcessMsgRsp[TSDB_SQL_DROP_DB] = tscProcessDropDbRsp;
   tscProcessMsgRsp[TSDB_SQL_DROP_TABLE] = tscProcessDropTableRsp;
@@ -3190,6 +3484,7 @@ void tscInitMsgsFp() {
   tscProcessMsgRsp[TSDB_SQL_STABLEVGROUP] = tscProcessSTableVgroupRsp;
   tscProcessMsgRsp[TSDB_SQL_MULTI_META] = tscProcessMultiTableMetaRsp;
   tscProcessMsgRsp[TSDB_SQL_RETRIEVE_FUNC] = tscProcessRetrieveFuncRsp;
+  tscProcessMsgRsp[TSDB_SQL_STABLE_TABLES] = tscProcessSTableTablesRsp;
 
   tscProcessMsgRsp[TSDB_SQL_SHOW] = tscProcessShowRsp;
   tscProcessMsgRsp[TSDB_SQL_RETRIEVE] = tscProcessRetrieveRspFromNode;  // rsp handled by same function.
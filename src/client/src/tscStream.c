@@ -184,6 +184,22 @@ static void tscProcessStreamTimer(void *handle, void *tmrId) {
       tscSetRetryTimer(pStream, pSql, timer);
       return;
     }
+
+    // the closed windows are emitted from the state kept by the CQ, only the others are queried
+    bool (*incFp)(void *, SSqlStream *, int64_t, int64_t) = atomic_load_ptr(&pStream->incFp);
+    pStream->incEkey = INT64_MIN;
+    if (incFp != NULL) {
+      if ((*incFp)(pStream->param, pStream, pStream->stime, etime)) {
+        tscDebug("0x%"PRIx64" stream:%p, windows in %" PRId64 "-%" PRId64 " are emitted incrementally", pSql->self,
+                 pStream, pStream->stime, etime);
+        pStream->stime = etime;
+        tscSetNextLaunchTimer(pStream, pSql);
+        return;
+      }
+
+      pQueryInfo->window.ekey = etime - 1;
+      pStream->incEkey = etime;
+    }
   }
 
   // launch stream computing in a new thread
@@ -319,6 +335,12 @@ static void tscProcessStreamRetrieveResult(void *param, TAOS_RES *res, int numOf
       pStream->stime += 1;
     }
 
+    // the queried windows are closed, no matter they have results or not
+    if (pStream->incEkey > pStream->stime) {
+      pStream->stime = pStream->incEkey;
+    }
+    pStream->incEkey = INT64_MIN;
+
     tscDebug("0x%"PRIx64" stream:%p, query on:%s, fetch result completed, fetched rows:%" PRId64, pSql->self, pStream, tNameGetTableName(&pTableMetaInfo->name),
              pStream->numOfRes);
 
@@ -607,6 +629,10 @@ void tscSetStreamDestTable(SSqlStream* pStream, const char* dstTable) {
   pStream->dstTable = dstTable;
 }
 
+void tscSetStreamIncFp(SSqlStream* pStream, bool (*fp)(void *, SSqlStream *, int64_t, int64_t)) {
+  atomic_store_ptr(&pStream->incFp, fp);
+}
+
 // fetchFp call back
 void fetchFpStreamLastRow(void* param ,TAOS_RES* res, int num) {
   SSqlStream* pStream = (SSqlStream*)param;
@@ -694,6 +720,7 @@ TAOS_STREAM *taos_open_stream_withname(TAOS *taos, const char* dstTable, const c
   }
 
   pStream->ltime = INT64_MIN;
+  pStream->incEkey = INT64_MIN;
   pStream->stime = stime;
   pStream->fp = fp;
   pStream->callback = callback;
@@ -23,8 +23,12 @@
 #include "tscLog.h"
 #include "tscUtil.h"
 #include "tcache.h"
+#include "tref.h"
 #include "tscProfile.h"
 
+// how long a vnode may hold the sub-wait of an idle subscription, in ms
+#define TSC_SUB_WAIT_TIME 10000
+
 typedef struct SSubscriptionProgress {
   int64_t uid;
   TSKEY key;
@@ -43,8 +47,25 @@ typedef struct SSub {
   TAOS_SUBSCRIBE_CALLBACK fp;
   void *                  param;
   SArray* progress;
+
+  // an asynchronous subscription parks a sub-wait on each vgroup instead of querying every interval,
+  // the consume is only issued after a vnode reports new rows
+  int64_t                 rid;
+  int8_t                  closing;
+  int8_t                  consumeScheduled;
+  pthread_mutex_t         waitMutex;
+  SArray*                 waitingVgroups;  // SArray<int32_t>, vgroups having a sub-wait in flight
 } SSub;
 
+static pthread_once_t tscSubRefInit = PTHREAD_ONCE_INIT;
+static int32_t        tscSubRef = -1;
+
+static void tscFreeSubscription(void *param);
+
+static void tscInitSubRef(void) {
+  tscSubRef = taosOpenRef(200, tscFreeSubscription);
+}
+
 
 static int tscCompareSubscriptionProgress(const void* a, const void* b) {
   const SSubscriptionProgress* x = (const SSubscriptionProgress*)a;
@@ -110,8 +131,10 @@ static SSub* tscCreateSubscription(STscObj* pObj, const char* topic, const char*
   }
 
   tstrncpy(pSub->topic, topic, sizeof(pSub->topic));
+  pthread_mutex_init(&pSub->waitMutex, NULL);
+  pSub->waitingVgroups = taosArrayInit(4, sizeof(int32_t));
   pSub->progress = taosArrayInit(32, sizeof(SSubscriptionProgress));
-  if (pSub->progress == NULL) {
+  if (pSub->progress == NULL || pSub->waitingVgroups == NULL) {
     line = __LINE__;
     code = TSDB_CODE_TSC_OUT_OF_MEMORY;
     goto fail;
@@ -194,6 +217,8 @@ fail:
 
   if (pSub != NULL) {
     taosArrayDestroy(pSub->progress);
+    taosArrayDestroy(pSub->waitingVgroups);
+    pthread_mutex_destroy(&pSub->waitMutex);
     tsem_destroy(&pSub->sem);
     free(pSub);
     pSub = NULL;
@@ -204,16 +229,214 @@ fail:
 }
 
 
+static void tscProcessSubscriptionTimer(void *handle, void *tmrId);
+static void tscSubWaitCallback(void *param, TAOS_RES *tres, int code);
+
+// the consume keeps the interval of the subscription as the minimal gap between two queries
+static void tscScheduleConsume(SSub* pSub, int32_t delay) {
+  int64_t elapsed = taosGetTimestampMs() - pSub->lastConsumeTime;
+  if (delay < pSub->interval - elapsed) {
+    delay = (int32_t)(pSub->interval - elapsed);
+  }
+
+  pSub->consumeScheduled = 1;
+  taosTmrReset(tscProcessSubscriptionTimer, delay, (void *)pSub->rid, tscTmr, &pSub->pTimer);
+}
+
+static bool tscIsSubWaiting(SSub* pSub, int32_t vgId) {
+  for (size_t i = 0; i < taosArrayGetSize(pSub->waitingVgroups); ++i) {
+    if (*(int32_t *)taosArrayGet(pSub->waitingVgroups, i) == vgId) return true;
+  }
+  return false;
+}
+
+static void tscRemoveSubWaiting(SSub* pSub, int32_t vgId) {
+  for (size_t i = 0; i < taosArrayGetSize(pSub->waitingVgroups); ++i) {
+    if (*(int32_t *)taosArrayGet(pSub->waitingVgroups, i) == vgId) {
+      taosArrayRemove(pSub->waitingVgroups, i);
+      return;
+    }
+  }
+}
+
+// send the sub-wait with the given payload, the caller holds the waitMutex
+static int32_t tscSendSubWait(SSub* pSub, SSubWaitMsg* pMsg, int32_t len, SRpcEpSet* pEpSet) {
+  SSqlObj* pSql = calloc(1, sizeof(SSqlObj));
+  if (pSql == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  pSql->signature = pSql;
+  pSql->pTscObj = pSub->taos;
+  pSql->cmd.command = TSDB_SQL_SUB_WAIT;
+  pSql->cmd.msgType = TSDB_MSG_TYPE_SUB_WAIT;
+
+  if (tscAllocPayload(&pSql->cmd, len) != TSDB_CODE_SUCCESS) {
+    tscFreeSqlObj(pSql);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  memcpy(pSql->cmd.payload, pMsg, len);
+  pSql->cmd.payloadLen = len;
+  pSql->epSet = *pEpSet;
+  pSql->fp = tscSubWaitCallback;
+  pSql->param = (void *)pSub->rid;
+
+  registerSqlObj(pSql);
+
+  int32_t vgId = htonl(pMsg->head.vgId);
+  tscDebug("0x%"PRIx64" subscribe:%s, sub-wait vgId:%d, numOfTables:%d", pSql->self, pSub->topic, vgId,
+           htonl(pMsg->numOfTables));
+
+  int32_t code = tscSendMsgToServer(pSql);
+  if (code != TSDB_CODE_SUCCESS) {
+    taosReleaseRef(tscObjRef, pSql->self);
+    return code;
+  }
+
+  taosArrayPush(pSub->waitingVgroups, &vgId);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t tscSendSubWaitToVgroup(SSub* pSub, SNewVgroupInfo* pVgroupInfo, SArray* pTables) {
+  int32_t numOfTables = (int32_t)taosArrayGetSize(pTables);
+  if (numOfTables == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t      len = (int32_t)(sizeof(SSubWaitMsg) + numOfTables * sizeof(STableIdInfo));
+  SSubWaitMsg* pMsg = calloc(1, len);
+  if (pMsg == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  pMsg->head.vgId = htonl(pVgroupInfo->vgId);
+  pMsg->head.contLen = htonl(len);
+  pMsg->waitTime = htonl(TSC_SUB_WAIT_TIME);
+  pMsg->numOfTables = htonl(numOfTables);
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    STableIdInfo* pItem = taosArrayGet(pTables, i);
+    pMsg->tables[i].uid = htobe64(pItem->uid);
+    pMsg->tables[i].tid = htonl(pItem->tid);
+    pMsg->tables[i].key = htobe64(tscGetSubscriptionProgress(pSub, pItem->uid, INT64_MIN));
+  }
+
+  SRpcEpSet epSet = {0};
+  tscDumpEpSetFromVgroupInfo(&epSet, pVgroupInfo);
+
+  int32_t code = tscSendSubWait(pSub, pMsg, len, &epSet);
+  free(pMsg);
+  return code;
+}
+
+/*
+ * park a sub-wait on each vgroup of the subscription, if none can be sent, e.g., the vgroups are unknown or the
+ * server is too old to support it, the subscription falls back to query every interval.
+ */
+static void tscWaitForSubscription(SSub* pSub) {
+  SSqlCmd* pCmd = &pSub->pSql->cmd;
+
+  pthread_mutex_lock(&pSub->waitMutex);
+  pSub->consumeScheduled = 0;
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  // the command is select or fetch after a consume, or retrieve-empty-result if there are no tables
+  if (pCmd->command != TSDB_SQL_RETRIEVE_EMPTY_RESULT) {
+    STableMetaInfo* pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, 0);
+
+    if (UTIL_TABLE_IS_SUPER_TABLE(pTableMetaInfo)) {
+      size_t numOfVgroups = taosArrayGetSize(pTableMetaInfo->pVgroupTables);
+      for (size_t i = 0; i < numOfVgroups && code == TSDB_CODE_SUCCESS; ++i) {
+        SVgroupTableInfo* pVgroupTables = taosArrayGet(pTableMetaInfo->pVgroupTables, i);
+        if (tscIsSubWaiting(pSub, pVgroupTables->vgInfo.vgId)) continue;
+
+        SNewVgroupInfo vgroupInfo = createNewVgroupInfo(&pVgroupTables->vgInfo);
+        code = tscSendSubWaitToVgroup(pSub, &vgroupInfo, pVgroupTables->itemList);
+      }
+    } else if (pTableMetaInfo->pTableMeta != NULL && !tscIsSubWaiting(pSub, pTableMetaInfo->pTableMeta->vgId)) {
+      STableMeta*    pTableMeta = pTableMetaInfo->pTableMeta;
+      SNewVgroupInfo vgroupInfo = {.vgId = -1};
+      taosHashGetClone(tscVgroupMap, &pTableMeta->vgId, sizeof(pTableMeta->vgId), NULL, &vgroupInfo);
+
+      if (vgroupInfo.vgId == pTableMeta->vgId) {
+        SArray*      pTables = taosArrayInit(1, sizeof(STableIdInfo));
+        STableIdInfo item = {.uid = pTableMeta->id.uid, .tid = pTableMeta->id.tid};
+        taosArrayPush(pTables, &item);
+        code = tscSendSubWaitToVgroup(pSub, &vgroupInfo, pTables);
+        taosArrayDestroy(pTables);
+      }
+    }
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("subscribe:%s, failed to send sub-wait, reason:%s", pSub->topic, tstrerror(code));
+  }
+
+  if (taosArrayGetSize(pSub->waitingVgroups) == 0) {
+    tscScheduleConsume(pSub, pSub->interval);
+  }
+  pthread_mutex_unlock(&pSub->waitMutex);
+}
+
+static void tscSubWaitCallback(void *param, TAOS_RES *tres, int code) {
+  SSqlObj*     pSql = (SSqlObj *)tres;
+  SSubWaitMsg* pMsg = (SSubWaitMsg *)pSql->cmd.payload;
+  int32_t      vgId = htonl(pMsg->head.vgId);
+
+  SSub* pSub = taosAcquireRef(tscSubRef, (int64_t)param);
+  if (pSub == NULL) {
+    return;
+  }
+
+  tscDebug("0x%"PRIx64" subscribe:%s, sub-wait vgId:%d returns, code:%d", pSql->self, pSub->topic, vgId, code);
+
+  pthread_mutex_lock(&pSub->waitMutex);
+  tscRemoveSubWaiting(pSub, vgId);
+
+  if (pSub->closing || pSub->consumeScheduled) {
+    // the consume re-arms the sub-wait of this vgroup
+  } else if (code == 0) {
+    // nothing new within the wait time, the progress is unchanged and so is the sub-wait
+    code = tscSendSubWait(pSub, pMsg, pSql->cmd.payloadLen, &pSql->epSet);
+    if (code != TSDB_CODE_SUCCESS) {
+      tscScheduleConsume(pSub, pSub->interval);
+    }
+  } else {
+    // new rows arrive, or the vnode fails to wait and the consume finds out what happens
+    tscScheduleConsume(pSub, (code > 0) ? 0 : pSub->interval);
+  }
+
+  pthread_mutex_unlock(&pSub->waitMutex);
+  taosReleaseRef(tscSubRef, pSub->rid);
+}
+
 static void tscProcessSubscriptionTimer(void *handle, void *tmrId) {
-  SSub *pSub = (SSub *)handle;
-  if (pSub == NULL || pSub->pTimer != tmrId) return;
+  SSub *pSub = taosAcquireRef(tscSubRef, (int64_t)handle);
+  if (pSub == NULL) return;
+
+  // a zero delay timer may fire before pTimer is updated, so the timer id is not checked, only one consume is
+  // scheduled at a time
+  if (pSub->closing) {
+    taosReleaseRef(tscSubRef, pSub->rid);
+    return;
+  }
 
   TAOS_RES* res = taos_consume(pSub);
   if (res != NULL) {
     pSub->fp(pSub, res, pSub->param, 0);
   }
 
-  taosTmrReset(tscProcessSubscriptionTimer, pSub->interval, pSub, tscTmr, &pSub->pTimer);
+  if (pSub->closing) {
+    // unsubscribed in the callback
+  } else if (res != NULL) {
+    tscWaitForSubscription(pSub);
+  } else {
+    pthread_mutex_lock(&pSub->waitMutex);
+    tscScheduleConsume(pSub, pSub->interval);
+    pthread_mutex_unlock(&pSub->waitMutex);
+  }
+
+  taosReleaseRef(tscSubRef, pSub->rid);
 }
 
 //TODO refactor: extract table list name not simply from the sql
@@ -400,11 +623,14 @@ TAOS_SUB *taos_subscribe(TAOS *taos, int restart, const char* topic, const char
     return NULL;
   }
 
+  pthread_once(&tscSubRefInit, tscInitSubRef);
+
   SSub* pSub = tscCreateSubscription(pObj, topic, sql);
   if (pSub == NULL) {
     return NULL;
   }
   pSub->taos = taos;
+  pSub->rid = taosAddRef(tscSubRef, pSub);
 
   if (restart) {
     tscDebug("restart subscription: %s", topic);
@@ -424,7 +650,7 @@ TAOS_SUB *taos_subscribe(TAOS *taos, int restart, const char* topic, const char
     tscDebug("asynchronize subscription, create new timer: %s", topic);
     pSub->fp = fp;
     pSub->param = param;
-    taosTmrReset(tscProcessSubscriptionTimer, interval, pSub, tscTmr, &pSub->pTimer);
+    taosTmrReset(tscProcessSubscriptionTimer, interval, (void *)pSub->rid, tscTmr, &pSub->pTimer);
   }
 
   return pSub;
@@ -600,9 +826,12 @@ void taos_unsubscribe(TAOS_SUB *tsub, int keepProgress) {
   SSub *pSub = (SSub *)tsub;
   if (pSub == NULL || pSub->signature != pSub) return;
 
+  pthread_mutex_lock(&pSub->waitMutex);
+  pSub->closing = 1;
   if (pSub->pTimer != NULL) {
     taosTmrStop(pSub->pTimer);
   }
+  pthread_mutex_unlock(&pSub->waitMutex);
 
   if (keepProgress) {
     if (pSub->progress != NULL) {
@@ -616,6 +845,13 @@ void taos_unsubscribe(TAOS_SUB *tsub, int keepProgress) {
     }
   }
 
+  // the subscription is freed after the in-flight sub-waits and timer return
+  taosRemoveRef(tscSubRef, pSub->rid);
+}
+
+static void tscFreeSubscription(void *param) {
+  SSub *pSub = (SSub *)param;
+
   if (pSub->pSql != NULL) {
     if (pSub->pSql->self != 0) {
       taosReleaseRef(tscObjRef, pSub->pSql->self);
@@ -625,6 +861,8 @@ void taos_unsubscribe(TAOS_SUB *tsub, int keepProgress) {
   }
 
   taosArrayDestroy(pSub->progress);
+  taosArrayDestroy(pSub->waitingVgroups);
+  pthread_mutex_destroy(&pSub->waitMutex);
   tsem_destroy(&pSub->sem);
   memset(pSub, 0, sizeof(*pSub));
   free(pSub);
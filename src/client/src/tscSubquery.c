@@ -634,7 +634,9 @@ static int32_t tscLaunchRealSubqueries(SSqlObj* pSql) {
 
     if (UTIL_TABLE_IS_SUPER_TABLE(pTableMetaInfo)) {
       assert(pTableMetaInfo->pVgroupTables != NULL);
-      if (tscNonOrderedProjectionQueryOnSTable(pQueryInfo, 0)) {
+      if (pQueryInfo->tsBuf == NULL) {  // merge joined in vnode, every vgroup holds qualified tables
+        TSDB_QUERY_SET_TYPE(pQueryInfo->type, TSDB_QUERY_TYPE_MULTITABLE_QUERY);
+      } else if (tscNonOrderedProjectionQueryOnSTable(pQueryInfo, 0)) {
         SArray* p = buildVgroupTableByResult(pQueryInfo, pTableMetaInfo->pVgroupTables);
         tscFreeVgroupTableInfo(pTableMetaInfo->pVgroupTables);
         pTableMetaInfo->pVgroupTables = p;
@@ -868,7 +870,91 @@ static void setTidTagType(SJoinSupporter* p, uint8_t type) {
   }
 }
 
-static int32_t getIntersectionOfTableTuple(SQueryInfo* pQueryInfo, SSqlObj* pParentSql, SArray* resList) {
+/*
+ * The ts_comp query of each side applies the column filters of that side, so a join with column filters always takes
+ * the ts_comp path.
+ */
+static bool joinHasColumnFilter(SSqlObj* pParentSql) {
+  for (int32_t i = 0; i < pParentSql->subState.numOfSub; ++i) {
+    SJoinSupporter* p = pParentSql->pSubs[i]->param;
+    if (p->colCond != NULL && taosArrayGetSize(p->colCond) > 0) {
+      return true;
+    }
+
+    size_t numOfCols = (p->colList != NULL)? taosArrayGetSize(p->colList):0;
+    for (int32_t j = 0; j < numOfCols; ++j) {
+      SColumn* pCol = taosArrayGetP(p->colList, j);
+      if (pCol->info.flist.numOfFilters > 0) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/*
+ * Pair the matched tables of a two-table join, the uid of each table maps to the STableIdInfo of its partner. If the
+ * tables of every pair are in the same vgroup, the join is merged in vnode, otherwise NULL is returned.
+ */
+static SHashObj* buildJoinTableMap(SSqlObj* pParentSql, SMergeCtx* ctxlist, int16_t joinNum) {
+  if (joinNum != 2) {
+    return NULL;
+  }
+
+  size_t num = taosArrayGetSize(ctxlist[0].res);
+  assert(num == taosArrayGetSize(ctxlist[1].res));
+
+  for (int32_t i = 0; i < num; ++i) {
+    STidTags* t0 = taosArrayGet(ctxlist[0].res, i);
+    STidTags* t1 = taosArrayGet(ctxlist[1].res, i);
+    if (t0->vgId != t1->vgId) {
+      tscDebug("0x%"PRIx64" uid:%"PRIu64" in vgId:%d joins uid:%"PRIu64" in vgId:%d, merge with ts_comp", pParentSql->self,
+               t0->uid, t0->vgId, t1->uid, t1->vgId);
+      return NULL;
+    }
+  }
+
+  if (num == 0) {
+    return NULL;
+  }
+
+  SHashObj* pJoinTables = taosHashInit(num * 2, taosGetDefaultHashFunction(TSDB_DATA_TYPE_UBIGINT), false, HASH_NO_LOCK);
+  for (int32_t i = 0; i < num; ++i) {
+    STidTags* t0 = taosArrayGet(ctxlist[0].res, i);
+    STidTags* t1 = taosArrayGet(ctxlist[1].res, i);
+
+    STableIdInfo id0 = {.uid = t0->uid, .tid = t0->tid, .key = INT64_MIN};
+    STableIdInfo id1 = {.uid = t1->uid, .tid = t1->tid, .key = INT64_MIN};
+
+    taosHashPut(pJoinTables, &t0->uid, sizeof(t0->uid), &id1, sizeof(id1));
+    taosHashPut(pJoinTables, &t1->uid, sizeof(t1->uid), &id0, sizeof(id0));
+  }
+
+  tscDebug("0x%"PRIx64" all %"PRIzu" joined table pairs are co-located, merge join in vnode", pParentSql->self, num);
+  return pJoinTables;
+}
+
+static void setVgroupJoinTables(SArray* pVgroupTables, SHashObj* pJoinTables) {
+  size_t numOfGroups = taosArrayGetSize(pVgroupTables);
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    SVgroupTableInfo* pInfo = taosArrayGet(pVgroupTables, i);
+
+    size_t num = taosArrayGetSize(pInfo->itemList);
+    pInfo->joinList = taosArrayInit(num, sizeof(STableIdInfo));
+
+    for (int32_t j = 0; j < num; ++j) {
+      STableIdInfo* pItem = taosArrayGet(pInfo->itemList, j);
+      STableIdInfo* pJoin = taosHashGet(pJoinTables, &pItem->uid, sizeof(pItem->uid));
+      assert(pJoin != NULL);
+
+      taosArrayPush(pInfo->joinList, pJoin);
+    }
+  }
+}
+
+static int32_t getIntersectionOfTableTuple(SQueryInfo* pQueryInfo, SSqlObj* pParentSql, SArray* resList,
+                                           SHashObj** pJoinTables) {
   int16_t joinNum = pParentSql->subState.numOfSub;
   STableMetaInfo* pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
   int16_t tagColId = tscGetJoinTagColIdByUid(&pQueryInfo->tagCond, pTableMetaInfo->pTableMeta->id.uid);
@@ -1052,6 +1138,11 @@ static int32_t getIntersectionOfTableTuple(SQueryInfo* pQueryInfo, SSqlObj* pPar
     stackidx = 0;
   }
 
+  // the matched tables are pushed in pairs, take the pairs before the tuples are reorganized
+  if (pJoinTables != NULL) {
+    *pJoinTables = buildJoinTableMap(pParentSql, ctxlist, joinNum);
+  }
+
   for (int32_t i = 0; i < joinNum; ++i) {
     // reorganize the tid-tag value according to both the vgroup id and tag values
     // sort according to the tag value
@@ -1184,9 +1275,11 @@ static void tidTagRetrieveCallback(void* param, TAOS_RES* tres, int32_t numOfRow
     return;
   }  
 
-  SArray* resList = taosArrayInit(pParentSql->subState.numOfSub, sizeof(SArray *));
+  SArray*   resList = taosArrayInit(pParentSql->subState.numOfSub, sizeof(SArray *));
+  SHashObj* pJoinTables = NULL;
 
-  int32_t code = getIntersectionOfTableTuple(pQueryInfo, pParentSql, resList);
+  int32_t code = getIntersectionOfTableTuple(pQueryInfo, pParentSql, resList,
+                                             joinHasColumnFilter(pParentSql) ? NULL : &pJoinTables);
   if (code != TSDB_CODE_SUCCESS) {
     freeJoinSubqueryObj(pParentSql);
     pParentSql->res.code = code;
@@ -1208,6 +1301,22 @@ static void tidTagRetrieveCallback(void* param, TAOS_RES* tres, int32_t numOfRow
     assert(pParentSql->fp != tscJoinQueryCallback);
 
     (*pParentSql->fp)(pParentSql->param, pParentSql, 0);
+  } else if (pJoinTables != NULL) {
+    for (int32_t m = 0; m < pParentSql->subState.numOfSub; ++m) {
+      // the vnode intersects the timestamps of each table with its partner, no ts_comp query is required
+      SSqlCmd* pSubCmd = &pParentSql->pSubs[m]->cmd;
+      SArray** s = taosArrayGet(resList, m);
+
+      SQueryInfo*     pQueryInfo1 = tscGetQueryInfo(pSubCmd);
+      STableMetaInfo* pTableMetaInfo = tscGetMetaInfo(pQueryInfo1, 0);
+      tscBuildVgroupTableInfo(pParentSql, pTableMetaInfo, *s);
+      setVgroupJoinTables(pTableMetaInfo->pVgroupTables, pJoinTables);
+
+      SSqlObj* psub = pParentSql->pSubs[m];
+      ((SJoinSupporter*)psub->param)->pVgroupTables =  tscVgroupTableInfoDup(pTableMetaInfo->pVgroupTables);
+    }
+
+    tscLaunchRealSubqueries(pParentSql);
   } else {
     for (int32_t m = 0; m < pParentSql->subState.numOfSub; ++m) {
       // proceed to for ts_comp query
@@ -1228,6 +1337,8 @@ static void tidTagRetrieveCallback(void* param, TAOS_RES* tres, int32_t numOfRow
     }
   }
 
+  taosHashCleanup(pJoinTables);
+
   size_t rsize = taosArrayGetSize(resList);
   for (int32_t i = 0; i < rsize; ++i) {
     SArray** s = taosArrayGet(resList, i);
@@ -2820,34 +2931,42 @@ static void tscAllDataRetrievedFromDnode(SRetrieveSupport *trsupport, SSqlObj* p
   // data in from current vnode is stored in cache and disk
   uint32_t numOfRowsFromSubquery = (uint32_t)(trsupport->pExtMemBuffer[idx]->numOfTotalElems + trsupport->localBuffer->num);
   SVgroupsInfo* vgroupsInfo = pTableMetaInfo->vgroupList;
-  tscDebug("0x%"PRIx64" sub:0x%"PRIx64" all data retrieved from ep:%s, vgId:%d, numOfRows:%d, orderOfSub:%d", pParentSql->self,
-      pSql->self, vgroupsInfo->vgroups[0].epAddr[0].fqdn, vgroupsInfo->vgroups[0].vgId, numOfRowsFromSubquery, idx);
-  
-  tColModelCompact(pDesc->pColumnModel, trsupport->localBuffer, pDesc->pColumnModel->capacity);
+  SQueryInfo   *pPQueryInfo = tscGetQueryInfo(&pParentSql->cmd);
+  int32_t       code = TSDB_CODE_SUCCESS;
+
+  if (tscIsStreamGlobalMerge(pParentSql, pPQueryInfo)) {
+    tscDebug("0x%"PRIx64" sub:0x%"PRIx64" first block retrieved from ep:%s, vgId:%d, numOfRows:%d, orderOfSub:%d", pParentSql->self,
+        pSql->self, vgroupsInfo->vgroups[0].epAddr[0].fqdn, vgroupsInfo->vgroups[0].vgId, pSql->res.numOfRows, idx);
+  } else {
+    tscDebug("0x%"PRIx64" sub:0x%"PRIx64" all data retrieved from ep:%s, vgId:%d, numOfRows:%d, orderOfSub:%d", pParentSql->self,
+        pSql->self, vgroupsInfo->vgroups[0].epAddr[0].fqdn, vgroupsInfo->vgroups[0].vgId, numOfRowsFromSubquery, idx);
+
+    tColModelCompact(pDesc->pColumnModel, trsupport->localBuffer, pDesc->pColumnModel->capacity);
 
 #ifdef _DEBUG_VIEW
-  printf("%" PRIu64 " rows data flushed to disk:\n", trsupport->localBuffer->num);
+    printf("%" PRIu64 " rows data flushed to disk:\n", trsupport->localBuffer->num);
     SSrcColumnInfo colInfo[256] = {0};
     tscGetSrcColumnInfo(colInfo, pQueryInfo);
     tColModelDisplayEx(pDesc->pColumnModel, trsupport->localBuffer->data, trsupport->localBuffer->num,
                        trsupport->localBuffer->num, colInfo);
 #endif
-  
-  if (tsTotalTmpDirGB != 0 && tsAvailTmpDirectorySpace < tsReservedTmpDirectorySpace) {
-    tscError("0x%"PRIx64" sub:0x%"PRIx64" client disk space remain %.3f GB, need at least %.3f GB, stop query", pParentSql->self, pSql->self,
-             tsAvailTmpDirectorySpace, tsReservedTmpDirectorySpace);
-    tscAbortFurtherRetryRetrieval(trsupport, pSql, TSDB_CODE_TSC_NO_DISKSPACE);
-    return;
-  }
-  
-  // each result for a vnode is ordered as an independant list,
-  // then used as an input of loser tree for disk-based merge
-  int32_t code = tscFlushTmpBuffer(trsupport->pExtMemBuffer[idx], pDesc, trsupport->localBuffer, pQueryInfo->groupbyExpr.orderType);
-  if (code != 0) { // set no disk space error info, and abort retry
-    tscAbortFurtherRetryRetrieval(trsupport, pSql, code);
-    return;
+
+    if (tsTotalTmpDirGB != 0 && tsAvailTmpDirectorySpace < tsReservedTmpDirectorySpace) {
+      tscError("0x%"PRIx64" sub:0x%"PRIx64" client disk space remain %.3f GB, need at least %.3f GB, stop query", pParentSql->self, pSql->self,
+               tsAvailTmpDirectorySpace, tsReservedTmpDirectorySpace);
+      tscAbortFurtherRetryRetrieval(trsupport, pSql, TSDB_CODE_TSC_NO_DISKSPACE);
+      return;
+    }
+
+    // each result for a vnode is ordered as an independant list,
+    // then used as an input of loser tree for disk-based merge
+    code = tscFlushTmpBuffer(trsupport->pExtMemBuffer[idx], pDesc, trsupport->localBuffer, pQueryInfo->groupbyExpr.orderType);
+    if (code != 0) { // set no disk space error info, and abort retry
+      tscAbortFurtherRetryRetrieval(trsupport, pSql, code);
+      return;
+    }
   }
-  
+
   if (!subAndCheckDone(pSql, pParentSql, idx)) {
     tscDebug("0x%"PRIx64" sub:0x%"PRIx64" orderOfSub:%d freed, not finished", pParentSql->self, pSql->self,
         trsupport->subqueryIndex);
@@ -2862,9 +2981,11 @@ static void tscAllDataRetrievedFromDnode(SRetrieveSupport *trsupport, SSqlObj* p
   tscDebug("0x%"PRIx64" retrieve from %d vnodes completed.final NumOfRows:%" PRId64 ",start to build loser tree",
       pParentSql->self, pState->numOfSub, pState->numOfRetrievedRows);
   
-  SQueryInfo *pPQueryInfo = tscGetQueryInfo(&pParentSql->cmd);
-  
-  code = tscCreateGlobalMerger(trsupport->pExtMemBuffer, pState->numOfSub, pDesc, pPQueryInfo, &pParentSql->res.pMerger, pParentSql->self);
+  if (tscIsStreamGlobalMerge(pParentSql, pPQueryInfo)) {
+    code = tscCreateStreamGlobalMerger(pParentSql, trsupport->pExtMemBuffer, pDesc, &pParentSql->res.pMerger);
+  } else {
+    code = tscCreateGlobalMerger(trsupport->pExtMemBuffer, pState->numOfSub, pDesc, pPQueryInfo, &pParentSql->res.pMerger, pParentSql->self);
+  }
   pParentSql->res.code = code;
 
   if (code == TSDB_CODE_SUCCESS && trsupport->pExtMemBuffer == NULL) {
@@ -2991,6 +3112,12 @@ static void tscRetrieveFromDnodeCallBack(void *param, TAOS_RES *tres, int numOfR
     tColModelDisplayEx(pDesc->pColumnModel, pRes->data, pRes->numOfRows, pRes->numOfRows, colInfo);
 #endif
     
+    // the rows are kept in the subquery and merged directly, the following blocks are fetched during merge
+    if (tscIsStreamGlobalMerge(pParentSql, tscGetQueryInfo(&pParentSql->cmd))) {
+      tscAllDataRetrievedFromDnode(trsupport, pSql);
+      return;
+    }
+
     // no disk space for tmp directory
     if (tsTotalTmpDirGB != 0 && tsAvailTmpDirectorySpace < tsReservedTmpDirectorySpace) {
       tscError("0x%"PRIx64" sub:0x%"PRIx64" client disk space remain %.3f GB, need at least %.3f GB, stop query", pParentSql->self, pSql->self,
@@ -3028,6 +3155,11 @@ static SSqlObj *tscCreateSTableSubquery(SSqlObj *pSql, SRetrieveSupport *trsuppo
     pQueryInfo->limit.limit = -1;
     pQueryInfo->limit.offset = 0;
 
+    // the vnode sorts and cuts its results at the vgroup limit only for the streaming global merge
+    if (!tscIsStreamGlobalMerge(pSql, tscGetQueryInfo(&pSql->cmd))) {
+      pQueryInfo->vgroupLimit = -1;
+    }
+
     assert(trsupport->subqueryIndex < pSql->subState.numOfSub);
     
     // launch subquery for each vnode, so the subquery index equals to the vgroupIndex.
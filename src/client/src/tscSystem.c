@@ -34,10 +34,14 @@
 int32_t    sentinel = TSC_VAR_NOT_RELEASE;
 
 SHashObj  *tscVgroupMap;         // hash map to keep the vgroup info from mnode
+SHashObj  *tscVgroupFlowCtrlMap; // vgroup id -> time before which submits to it are paced, hinted by vnode
 SHashObj  *tscTableMetaMap;      // table meta info buffer
 SCacheObj *tscVgroupListBuf;     // super table vgroup list information, only survives 5 seconds for each super table vgroup list
+SHashObj  *tscMetaPrefetchMap;   // super table name -> last time its child table metas are prefetched
+SMetaCacheStat tscMetaCacheStat;
 
 int32_t    tscObjRef = -1;
+int32_t    tscBulkWriterRef = -1;
 void      *tscTmr;
 void      *tscQhandle;
 int32_t    tscRefId = -1;
@@ -189,9 +193,12 @@ void taos_init_imp(void) {
 
   if (tscTableMetaMap == NULL) {
     tscObjRef        = taosOpenRef(40960, tscFreeRegisteredSqlObj);
+    tscBulkWriterRef = taosOpenRef(200, tscFreeBulkWriter);
     tscVgroupMap     = taosHashInit(256, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, HASH_ENTRY_LOCK);
+    tscVgroupFlowCtrlMap = taosHashInit(256, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, HASH_ENTRY_LOCK);
     tscTableMetaMap  = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_ENTRY_LOCK);
     tscVgroupListBuf = taosCacheInit(TSDB_DATA_TYPE_BINARY, 5, false, NULL, "stable-vgroup-list");
+    tscMetaPrefetchMap = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_ENTRY_LOCK);
     tscDebug("TableMeta:%p, vgroup:%p is initialized", tscTableMetaMap, tscVgroupMap);
   }
    
@@ -221,16 +228,30 @@ void taos_cleanup(void) {
     scriptEnvPoolCleanup();
   }
 
+  tscInfo("table meta cache, hit:%" PRId64 " miss:%" PRId64 " stale:%" PRId64 " prefetched:%" PRId64
+          " evicted:%" PRId64, tscMetaCacheStat.hit, tscMetaCacheStat.miss, tscMetaCacheStat.stale,
+          tscMetaCacheStat.prefetched, tscMetaCacheStat.evicted);
+
   taosHashCleanup(tscTableMetaMap);
   tscTableMetaMap = NULL;
 
+  taosHashCleanup(tscMetaPrefetchMap);
+  tscMetaPrefetchMap = NULL;
+
   taosHashCleanup(tscVgroupMap);
   tscVgroupMap = NULL;
 
+  taosHashCleanup(tscVgroupFlowCtrlMap);
+  tscVgroupFlowCtrlMap = NULL;
+
   int32_t id = tscObjRef;
   tscObjRef = -1;
   taosCloseRef(id);
 
+  id = tscBulkWriterRef;
+  tscBulkWriterRef = -1;
+  taosCloseRef(id);
+
   void* p = tscQhandle;
   tscQhandle = NULL;
   taosCleanUpScheduler(p);
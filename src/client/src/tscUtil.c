@@ -1564,6 +1564,7 @@ void tscDestroyDataBlock(STableDataBlocks* pDataBlock, bool removeMeta) {
     return;
   }
 
+  tscDestroyBindColumns(pDataBlock);
   tfree(pDataBlock->pData);
 
   if (removeMeta) {
@@ -1587,6 +1588,77 @@ void tscDestroyDataBlock(STableDataBlocks* pDataBlock, bool removeMeta) {
   tfree(pDataBlock);
 }
 
+void tscDestroyBindColumns(STableDataBlocks* pDataBlock) {
+  if (pDataBlock->pBindCols == NULL) {
+    return;
+  }
+
+  int32_t numOfCols = tscGetNumOfColumns(pDataBlock->pTableMeta);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SBindColumn* pCol = &pDataBlock->pBindCols[i];
+    tfree(pCol->bitmap);
+    tfree(pCol->offsets);
+    tfree(pCol->data);
+  }
+
+  tfree(pDataBlock->pBindCols);
+}
+
+/**
+ * Move the column-wise bound values into raw rows in pData, so that the block can be sorted and merged as if
+ * the values were bound row by row. Columns without values are set to null.
+ */
+int32_t tscFlattenBindColumns(STableDataBlocks* pDataBlock) {
+  SBindColumn* pCols = pDataBlock->pBindCols;
+  if (pCols == NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SSchema* pSchema = tscGetTableSchema(pDataBlock->pTableMeta);
+  int32_t  numOfCols = tscGetNumOfColumns(pDataBlock->pTableMeta);
+  int32_t  numOfRows = 0;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    if (pCols[i].numOfRows > numOfRows) {
+      numOfRows = pCols[i].numOfRows;
+    }
+  }
+
+  uint32_t totalDataSize = sizeof(SSubmitBlk) + numOfRows * pDataBlock->rowSize;
+  if (totalDataSize > pDataBlock->nAllocSize) {
+    char* tmp = realloc(pDataBlock->pData, totalDataSize);
+    if (tmp == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    pDataBlock->pData = tmp;
+    pDataBlock->nAllocSize = totalDataSize;
+  }
+
+  int32_t offset = 0;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SBindColumn* pCol = &pCols[i];
+    int8_t       type = pSchema[i].type;
+    int16_t      bytes = pSchema[i].bytes;
+
+    char* row = pDataBlock->pData + sizeof(SSubmitBlk) + offset;
+    for (int32_t n = 0; n < numOfRows; ++n, row += pDataBlock->rowSize) {
+      if (n >= pCol->numOfRows || BIND_COL_IS_NULL(pCol->bitmap, n)) {
+        setNull(row, type, bytes);
+      } else if (IS_VAR_DATA_TYPE(type)) {
+        char* val = pCol->data + pCol->offsets[n];
+        memcpy(row, val, varDataTLen(val));
+      } else {
+        memcpy(row, pCol->data + bytes * n, bytes);
+      }
+    }
+
+    offset += bytes;
+  }
+
+  tscDestroyBindColumns(pDataBlock);
+  return TSDB_CODE_SUCCESS;
+}
+
 SParamInfo* tscAddParamToDataBlock(STableDataBlocks* pDataBlock, char type, uint8_t timePrec, int16_t bytes,
                                    uint32_t offset) {
   uint32_t needed = pDataBlock->numOfParams + 1;
@@ -1903,6 +1975,92 @@ static int trimDataBlock(void* pDataBlock, STableDataBlocks* pTableDataBlock, SI
   return len;
 }
 
+static int32_t getBindColumnsSize(STableDataBlocks* pTableDataBlock, int32_t numOfRows) {
+  SSchema* pSchema = tscGetTableSchema(pTableDataBlock->pTableMeta);
+  int32_t  numOfCols = tscGetNumOfColumns(pTableDataBlock->pTableMeta);
+  int32_t  size = 0;
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SBindColumn* pCol = &pTableDataBlock->pBindCols[i];
+    size += sizeof(SSubmitColHead) + BIND_COL_BITMAP_LEN(numOfRows);
+
+    if (IS_VAR_DATA_TYPE(pSchema[i].type)) {
+      size += numOfRows * sizeof(int32_t);
+      size += (numOfRows < pCol->numOfRows) ? pCol->offsets[numOfRows] : pCol->dataLen;
+    } else {
+      size += numOfRows * pSchema[i].bytes;
+    }
+  }
+
+  return size;
+}
+
+// Write the column-wise bound values as a columnar submit block, no row is built on client side
+static int32_t copyBindColumnsToSubmitBlk(void* pDataBlock, STableDataBlocks* pTableDataBlock) {
+  SSchema* pSchema = tscGetTableSchema(pTableDataBlock->pTableMeta);
+  int32_t  numOfCols = tscGetNumOfColumns(pTableDataBlock->pTableMeta);
+
+  SSubmitBlk* pBlock = pDataBlock;
+  memcpy(pDataBlock, pTableDataBlock->pData, sizeof(SSubmitBlk));
+
+  int32_t numOfRows = htons(pBlock->numOfRows);
+  char*   p = pBlock->data;
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SBindColumn* pCol = &pTableDataBlock->pBindCols[i];
+    int8_t       type = pSchema[i].type;
+    int32_t      rows = (pCol->numOfRows < numOfRows) ? pCol->numOfRows : numOfRows;
+
+    SSubmitColHead* pHead = (SSubmitColHead*)p;
+    p += sizeof(SSubmitColHead);
+    char* start = p;
+
+    uint8_t* bitmap = (uint8_t*)p;
+    if (rows > 0) {
+      memcpy(bitmap, pCol->bitmap, BIND_COL_BITMAP_LEN(rows));
+    }
+    for (int32_t n = rows; n < numOfRows; ++n) {
+      BIND_COL_SET_NULL(bitmap, n);
+    }
+    p += BIND_COL_BITMAP_LEN(numOfRows);
+
+    if (IS_VAR_DATA_TYPE(type)) {
+      int32_t dataLen = (rows < pCol->numOfRows) ? pCol->offsets[rows] : pCol->dataLen;
+      if (rows > 0) {
+        memcpy(p, pCol->offsets, rows * sizeof(int32_t));
+      }
+      memset(p + rows * sizeof(int32_t), 0, (numOfRows - rows) * sizeof(int32_t));
+      p += numOfRows * sizeof(int32_t);
+
+      if (dataLen > 0) {
+        memcpy(p, pCol->data, dataLen);
+      }
+      p += dataLen;
+    } else {
+      int16_t bytes = pSchema[i].bytes;
+      if (rows > 0) {
+        memcpy(p, pCol->data, rows * bytes);
+      }
+      for (int32_t n = rows; n < numOfRows; ++n) {
+        setNull(p + n * bytes, type, bytes);
+      }
+      p += numOfRows * bytes;
+    }
+
+    pHead->colId = pSchema[i].colId;
+    pHead->type = type;
+    pHead->reserved = 0;
+    pHead->len = (int32_t)(p - start);
+  }
+
+  int32_t len = (int32_t)(p - pBlock->data);
+  pBlock->flag = htonl(TSDB_SUBMIT_BLK_FLAG_COLUMNAR);
+  pBlock->dataLen = htonl(len);
+  pBlock->schemaLen = 0;
+
+  return len;
+}
+
 static int32_t getRowExpandSize(STableMeta* pTableMeta) {
   int32_t  result = TD_MEM_ROW_DATA_HEAD_SIZE;
   int32_t  columns = tscGetNumOfColumns(pTableMeta);
@@ -1952,7 +2110,18 @@ int32_t tscMergeTableDataBlocks(SInsertStatementParam *pInsertParam, bool freeBl
   while(pOneTableBlock) {
     SSubmitBlk* pBlocks = (SSubmitBlk*) pOneTableBlock->pData;
     if (pBlocks->numOfRows > 0) {
+      // columns can be sent as they are bound only if no sorting is required
+      if (pOneTableBlock->pBindCols != NULL && (!pOneTableBlock->ordered || pInsertParam->schemaAttached)) {
+        if ((code = tscFlattenBindColumns(pOneTableBlock)) != TSDB_CODE_SUCCESS) {
+          taosHashCleanup(pVnodeDataBlockHashList);
+          tscDestroyBlockArrayList(pVnodeDataBlockList);
+          tfree(blkKeyInfo.pKeyTuple);
+          return code;
+        }
+      }
+
       // the maximum expanded size in byte when a row-wise data is converted to SDataRow format
+      bool              isColumnar = (pOneTableBlock->pBindCols != NULL);
       int32_t           expandSize = isRawPayload ? getRowExpandSize(pOneTableBlock->pTableMeta) : 0;
       STableDataBlocks* dataBuf = NULL;
 
@@ -1968,6 +2137,9 @@ int32_t tscMergeTableDataBlocks(SInsertStatementParam *pInsertParam, bool freeBl
 
       int64_t destSize = dataBuf->size + pOneTableBlock->size + pBlocks->numOfRows * expandSize +
                          sizeof(STColumn) * tscGetNumOfColumns(pOneTableBlock->pTableMeta);
+      if (isColumnar) {
+        destSize = dataBuf->size + sizeof(SSubmitBlk) + getBindColumnsSize(pOneTableBlock, pBlocks->numOfRows);
+      }
 
       if (dataBuf->nAllocSize < destSize) {
         dataBuf->nAllocSize = (uint32_t)(destSize * 1.5);
@@ -1988,7 +2160,13 @@ int32_t tscMergeTableDataBlocks(SInsertStatementParam *pInsertParam, bool freeBl
         }
       }
 
-      if (isRawPayload) {
+      if (isColumnar) {
+        SBindColumn* pTsCol = &pOneTableBlock->pBindCols[PRIMARYKEY_TIMESTAMP_COL_INDEX];
+        tscDebug("0x%" PRIx64 " name:%s, tid:%d rows:%d sversion:%d skey:%" PRId64 ", ekey:%" PRId64 ", columnar",
+                 pInsertParam->objectId, tNameGetTableName(&pOneTableBlock->tableName), pBlocks->tid,
+                 pBlocks->numOfRows, pBlocks->sversion, GET_INT64_VAL(pTsCol->data),
+                 GET_INT64_VAL(pTsCol->data + TSDB_KEYSIZE * (pBlocks->numOfRows - 1)));
+      } else if (isRawPayload) {
         tscSortRemoveDataBlockDupRowsRaw(pOneTableBlock);
         char* ekey = (char*)pBlocks->data + pOneTableBlock->rowSize * (pBlocks->numOfRows - 1);
 
@@ -2021,9 +2199,16 @@ int32_t tscMergeTableDataBlocks(SInsertStatementParam *pInsertParam, bool freeBl
       pBlocks->numOfRows = htons(pBlocks->numOfRows);
       pBlocks->schemaLen = 0;
 
-      // erase the empty space reserved for binary data
-      int32_t finalLen = trimDataBlock(dataBuf->pData + dataBuf->size, pOneTableBlock, pInsertParam, blkKeyInfo.pKeyTuple);
-      assert(finalLen <= len);
+      int32_t finalLen = 0;
+      if (isColumnar) {
+        finalLen = copyBindColumnsToSubmitBlk(dataBuf->pData + dataBuf->size, pOneTableBlock);
+        assert(dataBuf->size + sizeof(SSubmitBlk) + finalLen <= destSize);
+        tscDestroyBindColumns(pOneTableBlock);
+      } else {
+        // erase the empty space reserved for binary data
+        finalLen = trimDataBlock(dataBuf->pData + dataBuf->size, pOneTableBlock, pInsertParam, blkKeyInfo.pKeyTuple);
+        assert(finalLen <= len);
+      }
 
       dataBuf->size += (finalLen + sizeof(SSubmitBlk));
       assert(dataBuf->size <= dataBuf->nAllocSize);
@@ -3092,9 +3277,10 @@ bool tscShouldBeFreed(SSqlObj* pSql) {
     return false;
   }
 
-  // only the table meta and super table vgroup query will free resource automatically
+  // only the table meta, super table vgroup, child tables query and sub-wait will free resource automatically
   int32_t command = pSql->cmd.command;
-  if (command == TSDB_SQL_META || command == TSDB_SQL_STABLEVGROUP) {
+  if (command == TSDB_SQL_META || command == TSDB_SQL_STABLEVGROUP || command == TSDB_SQL_STABLE_TABLES ||
+      command == TSDB_SQL_SUB_WAIT) {
     return true;
   }
 
@@ -3371,6 +3557,7 @@ void tscFreeVgroupTableInfo(SArray* pVgroupTables) {
     }
 #endif
     taosArrayDestroy(pInfo->itemList);
+    taosArrayDestroy(pInfo->joinList);
   }
 
   taosArrayDestroy(pVgroupTables);
@@ -3388,6 +3575,7 @@ void tscRemoveVgroupTableGroup(SArray* pVgroupTable, int32_t index) {
 //  }
 
   taosArrayDestroy(pInfo->itemList);
+  taosArrayDestroy(pInfo->joinList);
   taosArrayRemove(pVgroupTable, index);
 }
 
@@ -3405,6 +3593,10 @@ void tscVgroupTableCopy(SVgroupTableInfo* info, SVgroupTableInfo* pInfo) {
   if (pInfo->itemList) {
     info->itemList = taosArrayDup(pInfo->itemList);
   }
+
+  if (pInfo->joinList) {
+    info->joinList = taosArrayDup(pInfo->joinList);
+  }
 }
 
 SArray* tscVgroupTableInfoDup(SArray* pVgroupTables) {
@@ -4553,6 +4745,38 @@ CChildTableMeta* tscCreateChildMeta(STableMeta* pTableMeta) {
   return cMeta;
 }
 
+// child table metas and table metas share the leading fields, so the table type is read in the same way
+static bool tscEvictChildTableMetaFn(void *param, void *data) {
+  int32_t    *toEvict = param;
+  STableMeta *pMeta = data;
+  if (*toEvict <= 0 || pMeta->tableType != TSDB_CHILD_TABLE) {
+    return true;
+  }
+
+  (*toEvict) -= 1;
+  return false;
+}
+
+// Only child table metas are evicted, they are cheap to renew since the super table meta is kept. One tenth of the
+// bound more than required are evicted in one go, so that the cache is not traversed for each put.
+void tscEvictTableMetaIfNeeded() {
+  if (tsMaxMetaCacheTables <= 0) {
+    return;
+  }
+
+  int32_t size = taosHashGetSize(tscTableMetaMap);
+  if (size <= tsMaxMetaCacheTables) {
+    return;
+  }
+
+  int32_t expected = size - tsMaxMetaCacheTables + tsMaxMetaCacheTables / 10;
+  int32_t toEvict = expected;
+  taosHashCondTraverse(tscTableMetaMap, tscEvictChildTableMetaFn, &toEvict);
+  atomic_add_fetch_64(&tscMetaCacheStat.evicted, expected - toEvict);
+
+  tscDebug("%d child table metas are evicted, total cached:%d", expected - toEvict, taosHashGetSize(tscTableMetaMap));
+}
+
 int32_t tscCreateTableMetaFromSTableMeta(STableMeta** ppChild, const char* name, size_t *tableMetaCapacity, STableMeta**ppSTable) {
   assert(*ppChild != NULL);
   STableMeta* p      = *ppSTable;
@@ -4590,6 +4814,7 @@ int32_t tscCreateTableMetaFromSTableMeta(STableMeta** ppChild, const char* name,
     return TSDB_CODE_SUCCESS;
   } else { // super table has been removed, current tableMeta is also expired. remove it here
     taosHashRemove(tscTableMetaMap, name, strnlen(name, TSDB_TABLE_FNAME_LEN));
+    atomic_add_fetch_64(&tscMetaCacheStat.stale, 1);
     return -1;
   }
 }
@@ -4854,6 +5079,7 @@ int32_t tscCreateQueryFromQueryInfo(SQueryInfo* pQueryInfo, SQueryAttr* pQueryAt
   pQueryAttr->numOfOutput       = numOfOutput;
   pQueryAttr->limit             = pQueryInfo->limit;
   pQueryAttr->slimit            = pQueryInfo->slimit;
+  pQueryAttr->prjInfo.vgroupLimit = pQueryInfo->vgroupLimit;
   pQueryAttr->order             = pQueryInfo->order;
   pQueryAttr->fillType          = pQueryInfo->fillType;
   pQueryAttr->havingNum         = pQueryInfo->havingFieldNum;
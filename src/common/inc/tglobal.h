@@ -35,6 +35,13 @@ extern uint16_t tsArbitratorPort;
 extern int32_t  tsStatusInterval;
 extern int32_t  tsNumOfMnodes;
 extern int8_t   tsEnableVnodeBak;
+extern int8_t   tsColumnarSubmit;
+extern int32_t  tsSyncBandwidth;
+extern int32_t  tsSyncFileStreams;
+extern int32_t  tsMigrateInterval;
+extern int32_t  tsMigrateBandwidth;
+extern int32_t  tsMigrateHotReads;
+extern char     tsRollupTiers[];
 extern int8_t   tsEnableTelemetryReporting;
 extern char     tsEmail[];
 extern char     tsArbitrator[];
@@ -67,6 +74,8 @@ extern char     tsTempDir[];
 //query buffer management
 extern int32_t  tsQueryBufferSize;      // maximum allowed usage buffer size in MB for each data node during query processing
 extern int64_t  tsQueryBufferSizeBytes; // maximum allowed usage buffer size in byte for each data node during query processing
+extern int32_t  tsMaxQueryMemory;       // maximum allowed buffer size in MB of one query on a vnode
+extern int32_t  tsMaxQueriesPerUser;    // maximum number of running queries of one user on a data node
 extern int32_t  tsRetrieveBlockingModel;// retrieve threads will be blocked
 
 extern int8_t   tsKeepOriginalColumnName;
@@ -75,6 +84,8 @@ extern int8_t   tsKeepOriginalColumnName;
 extern int32_t tsMaxSQLStringLen;
 extern int32_t tsMaxWildCardsLen;
 extern int32_t tsMaxRegexStringLen;
+extern int32_t tsMetaPrefetchTables;
+extern int32_t tsMaxMetaCacheTables;
 extern int8_t  tsTscEnableRecordSql;
 extern int32_t tsMaxNumOfOrderedResults;
 extern int32_t tsMinSlidingTime;
@@ -132,6 +143,8 @@ extern int8_t   tsHttpEnableCompress;
 extern int8_t   tsHttpEnableRecordSql;
 extern int8_t   tsTelegrafUseFieldNum;
 extern int8_t   tsHttpDbNameMandatory;
+extern int8_t   tsHttpReusePort;
+extern int32_t  tsHttpMaxConnections;
 
 // mqtt
 extern int8_t tsEnableMqttModule;
@@ -195,6 +208,7 @@ extern char buildinfo[];
 
 // log
 extern int8_t  tsAsyncLog;
+extern int8_t  tsDeferLogFormat;
 extern int32_t tsNumOfLogLines;
 extern int32_t tsLogKeepDays;
 extern int32_t dDebugFlag;
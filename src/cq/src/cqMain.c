@@ -22,6 +22,7 @@
 
 #include "taos.h"
 #include "tsclient.h"
+#include "tscUtil.h"
 #include "taosdef.h"
 #include "taosmsg.h"
 #include "ttimer.h"
@@ -30,6 +31,9 @@
 #include "tglobal.h"
 #include "tlog.h"
 #include "twal.h"
+#include "hash.h"
+#include "ttype.h"
+#include "qAggMain.h"
 
 #define cFatal(...) { if (cqDebugFlag & DEBUG_FATAL) { taosPrintLog("CQ  FATAL ", 255, __VA_ARGS__); }}
 #define cError(...) { if (cqDebugFlag & DEBUG_ERROR) { taosPrintLog("CQ  ERROR ", 255, __VA_ARGS__); }}
@@ -39,6 +43,47 @@
 #define cTrace(...) { if (cqDebugFlag & DEBUG_TRACE) { taosPrintLog("CQ  ", cqDebugFlag, __VA_ARGS__); }}
 
 
+#define CQ_INC_ROW_KEY  (-1)  // count(*), the rows are counted instead of the values of a column
+
+typedef struct {
+  int16_t functionId;
+  int16_t colId;      // column of the source table, or CQ_INC_ROW_KEY
+  int8_t  colType;
+  int16_t resBytes;
+  int32_t offset;     // offset of the column in a data row of the current schema version, -1 if not there
+} SCqIncCol;
+
+typedef struct {
+  int64_t count;      // number of values which are not null
+  union {
+    int64_t  i;
+    uint64_t u;
+    double   d;
+  } sum;
+  int64_t min;        // raw values of the column type
+  int64_t max;
+  int64_t first;
+  int64_t last;
+} SCqIncAcc;
+
+typedef struct {
+  TSKEY     skey;
+  bool      dirty;    // out of order rows are written into the window, it has to be queried
+  SCqIncAcc acc[];
+} SCqIncWin;
+
+// window state of a stream whose results are computed when rows are written, instead of by queries
+typedef struct {
+  uint64_t   uid;       // uid of the source table
+  SInterval  interval;
+  int8_t     precision;
+  TSKEY      startKey;  // windows before it were not empty when the state is created, they are queried
+  int32_t    sversion;  // schema version of the column offsets
+  int32_t    numOfCols;
+  SCqIncCol *cols;
+  SArray    *pWins;     // SArray<SCqIncWin*>, ordered by skey
+} SCqIncState;
+
 typedef struct SCqObj {
   tmr_h          tmrId;
   int64_t        rid;
@@ -52,10 +97,14 @@ typedef struct SCqObj {
   struct SCqObj *prev;
   struct SCqObj *next;
   SCqContext *   pContext;
+  SCqIncState *  pInc;
 } SCqObj;
 
 static void cqProcessStreamRes(void *param, TAOS_RES *tres, TAOS_ROW row); 
 static void cqCreateStream(SCqContext *pContext, SCqObj *pObj);
+static void cqWriteRow(SCqContext *pContext, SCqObj *pObj, TAOS_ROW row, int32_t *lengths);
+static bool cqProcessIncWindows(void *param, SSqlStream *pStream, int64_t skey, int64_t ekey);
+static void cqIncReset(SCqContext *pContext, SCqObj *pObj);
 
 int32_t    cqObjRef = -1;
 int32_t    cqVnodeNum = 0;
@@ -83,6 +132,8 @@ static void freeSCqContext(void *handle) {
   }
   SCqContext *pContext = handle;
   pthread_mutex_destroy(&pContext->mutex);
+  pthread_mutex_destroy(&pContext->incMutex);
+  taosHashCleanup(pContext->incTables);
 
   taosTmrCleanUp(pContext->tmrCtrl);
   pContext->tmrCtrl = NULL;
@@ -111,6 +162,7 @@ void cqFree(void *handle) {
   }
 
   cInfo("vgId:%d, id:%d CQ:%s is dropped", pContext->vgId, pObj->tid, pObj->sqlStr); 
+  cqIncReset(pContext, pObj);
   tdFreeSchema(pObj->pSchema);
   free(pObj->dstTable);
   free(pObj->sqlStr);
@@ -170,10 +222,12 @@ void *cqOpen(void *ahandle, const SCqCfg *pCfg) {
   tstrncpy(pContext->db, db, sizeof(pContext->db));
   pContext->vgId = pCfg->vgId;
   pContext->cqWrite = pCfg->cqWrite;
+  pContext->cqLastKey = pCfg->cqLastKey;
   tscEmbedded = 1;
 
   pthread_mutex_init(&pContext->mutex, NULL);
-
+  pthread_mutex_init(&pContext->incMutex, NULL);
+  pContext->incTables = taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_UBIGINT), true, HASH_NO_LOCK);
 
   cDebug("vgId:%d, CQ is opened", pContext->vgId);
 
@@ -280,6 +334,7 @@ void cqStop(void *handle) {
       taosTmrStop(pObj->tmrId);
       pObj->tmrId = 0;
     }
+    cqIncReset(pContext, pObj);
     pObj = pObj->next;
   }
 
@@ -374,6 +429,7 @@ void cqDrop(void *handle) {
     taosTmrStop(pObj->tmrId);
     pObj->tmrId = 0;
   }
+  cqIncReset(pContext, pObj);
 
   pthread_mutex_unlock(&pContext->mutex);
 
@@ -443,6 +499,7 @@ static void cqCreateStream(SCqContext *pContext, SCqObj *pObj) {
 
     // TODO the pObj->pStream may be released if error happens
     if (pObj->pStream) {
+      tscSetStreamIncFp(pObj->pStream, cqProcessIncWindows);
       pContext->num++;
       cDebug("vgId:%d, id:%d CQ:%s is opened", pContext->vgId, pObj->tid, pObj->sqlStr);
     } else {
@@ -461,6 +518,7 @@ static void cqProcessStreamRes(void *param, TAOS_RES *tres, TAOS_ROW row) {
     taos_close_stream(pObj->pStream);
 
     pObj->pStream = NULL;
+    cqIncReset(pObj->pContext, pObj);
 
     taosReleaseRef(cqObjRef, (int64_t)param);
 
@@ -468,7 +526,6 @@ static void cqProcessStreamRes(void *param, TAOS_RES *tres, TAOS_ROW row) {
   }
 
   SCqContext *pContext = pObj->pContext;
-  STSchema   *pSchema = pObj->pSchema;
   if (pObj->pStream == NULL) {    
     taosReleaseRef(cqObjRef, (int64_t)param);
     return;
@@ -476,6 +533,14 @@ static void cqProcessStreamRes(void *param, TAOS_RES *tres, TAOS_ROW row) {
   
   cDebug("vgId:%d, id:%d CQ:%s stream result is ready", pContext->vgId, pObj->tid, pObj->sqlStr);
 
+  cqWriteRow(pContext, pObj, row, taos_fetch_lengths(tres));
+
+  taosReleaseRef(cqObjRef, (int64_t)param);
+}
+
+static void cqWriteRow(SCqContext *pContext, SCqObj *pObj, TAOS_ROW row, int32_t *lengths) {
+  STSchema *pSchema = pObj->pSchema;
+
   int32_t size = sizeof(SWalHead) + sizeof(SSubmitMsg) + sizeof(SSubmitBlk) + TD_MEM_ROW_DATA_HEAD_SIZE + pObj->rowSize;
   char *buffer = calloc(size, 1);
 
@@ -497,7 +562,7 @@ static void cqProcessStreamRes(void *param, TAOS_RES *tres, TAOS_ROW row) {
       val = ((char*)val) - sizeof(VarDataLenT);
     } else if (c->type == TSDB_DATA_TYPE_NCHAR) {
       char buf[TSDB_MAX_NCHAR_LEN];
-      int32_t len = taos_fetch_lengths(tres)[i];
+      int32_t len = lengths[i];
       taosMbsToUcs4(val, len, buf, sizeof(buf), &len);
       memcpy((char *)val + sizeof(VarDataLenT), buf, len);
       varDataLen(val) = len;
@@ -511,7 +576,7 @@ static void cqProcessStreamRes(void *param, TAOS_RES *tres, TAOS_ROW row) {
   pBlk->tid = htonl(pObj->tid);
   pBlk->numOfRows = htons(1);
   pBlk->sversion = htonl(pSchema->version);
-  pBlk->padding = 0;
+  pBlk->flag = 0;
 
   pHead->len = sizeof(SSubmitMsg) + sizeof(SSubmitBlk) + memRowDataTLen(trow);
 
@@ -526,7 +591,525 @@ static void cqProcessStreamRes(void *param, TAOS_RES *tres, TAOS_ROW row) {
   // write into vnode write queue
   pContext->cqWrite(pContext->vgId, pHead, TAOS_QTYPE_CQ, NULL);
   free(buffer);
-  
+}
+
+
+static bool cqIsIncFunc(SSqlExpr *pBase) {
+  switch (pBase->functionId) {
+    case TSDB_FUNC_TS:
+    case TSDB_FUNC_TS_DUMMY:
+      return pBase->resType == TSDB_DATA_TYPE_TIMESTAMP;
+    case TSDB_FUNC_COUNT:
+      return true;
+    case TSDB_FUNC_SUM:
+    case TSDB_FUNC_AVG:
+    case TSDB_FUNC_MIN:
+    case TSDB_FUNC_MAX:
+    case TSDB_FUNC_SPREAD:
+      return IS_NUMERIC_TYPE(pBase->colType);
+    case TSDB_FUNC_FIRST:
+    case TSDB_FUNC_LAST:
+      return !IS_VAR_DATA_TYPE(pBase->colType);
+    default:
+      return false;
+  }
+}
+
+/*
+ * Only the tumbling windows of aggregations on one table of this vnode are computed incrementally,
+ * all other streams are computed by queries as before.
+ */
+static SCqIncState *cqIncCreate(SCqContext *pContext, SCqObj *pObj, SSqlStream *pStream) {
+  SSqlObj *pSql = pStream->pSql;
+  if (pSql == NULL || pStream->isProject) return NULL;
+
+  SQueryInfo *pQueryInfo = tscGetQueryInfo(&pSql->cmd);
+  if (pQueryInfo == NULL || pQueryInfo->numOfTables != 1 || pQueryInfo->pTableMetaInfo[0]->pTableMeta == NULL) {
+    return NULL;
+  }
+
+  STableMeta *pTableMeta = pQueryInfo->pTableMetaInfo[0]->pTableMeta;
+  if (pTableMeta->vgId != pContext->vgId ||
+      (pTableMeta->tableType != TSDB_NORMAL_TABLE && pTableMeta->tableType != TSDB_CHILD_TABLE)) {
+    return NULL;
+  }
+
+  SInterval *pInterval = &pQueryInfo->interval;
+  if (pInterval->interval <= 0 || pInterval->intervalUnit == 'n' || pInterval->intervalUnit == 'y' ||
+      pInterval->offset != 0 || pInterval->sliding != pInterval->interval) {
+    return NULL;
+  }
+
+  if (pQueryInfo->groupbyExpr.numOfGroupCols > 0 || pQueryInfo->fillType != TSDB_FILL_NONE || pQueryInfo->hasFilter ||
+      pQueryInfo->colCond != NULL || pQueryInfo->sessionWindow.gap > 0 || pQueryInfo->stateWindow ||
+      pQueryInfo->havingFieldNum > 0 || pQueryInfo->distinct || pQueryInfo->limit.limit >= 0 ||
+      pQueryInfo->limit.offset > 0 || pQueryInfo->order.order != TSDB_ORDER_ASC ||
+      (pQueryInfo->pUdfInfo != NULL && taosArrayGetSize(pQueryInfo->pUdfInfo) > 0)) {
+    return NULL;
+  }
+
+  for (int32_t i = 0; i < taosArrayGetSize(pQueryInfo->colList); ++i) {
+    SColumn *pCol = taosArrayGetP(pQueryInfo->colList, i);
+    if (pCol->info.flist.numOfFilters > 0) return NULL;
+  }
+
+  int32_t numOfCols = pQueryInfo->fieldsInfo.numOfOutput;
+  if (numOfCols != schemaNCols(pObj->pSchema)) return NULL;
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SInternalField *pField = taosArrayGet(pQueryInfo->fieldsInfo.internalField, i);
+    if (pField->pExpr == NULL || pField->pExpr->pExpr != NULL) return NULL;
+
+    SSqlExpr *pBase = &pField->pExpr->base;
+    if (!cqIsIncFunc(pBase) || pBase->resBytes > sizeof(int64_t) || pBase->resType != schemaColAt(pObj->pSchema, i)->type) {
+      return NULL;
+    }
+  }
+
+  SCqIncState *pInc = calloc(1, sizeof(SCqIncState));
+  if (pInc == NULL) return NULL;
+
+  pInc->uid = pTableMeta->id.uid;
+  pInc->interval = *pInterval;
+  pInc->precision = (int8_t)pStream->precision;
+  pInc->sversion = -1;
+  pInc->numOfCols = numOfCols;
+  pInc->cols = calloc(numOfCols, sizeof(SCqIncCol));
+  pInc->pWins = taosArrayInit(4, POINTER_BYTES);
+  if (pInc->cols == NULL || pInc->pWins == NULL) {
+    taosArrayDestroy(pInc->pWins);
+    tfree(pInc->cols);
+    free(pInc);
+    return NULL;
+  }
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SSqlExpr  *pBase = &((SInternalField *)taosArrayGet(pQueryInfo->fieldsInfo.internalField, i))->pExpr->base;
+    SCqIncCol *pCol = &pInc->cols[i];
+
+    pCol->functionId = pBase->functionId;
+    pCol->colId = pBase->colInfo.colId;
+    pCol->colType = (int8_t)pBase->colType;
+    pCol->resBytes = pBase->resBytes;
+    pCol->offset = -1;
+    if (pBase->functionId == TSDB_FUNC_COUNT && pBase->colInfo.colIndex == TSDB_TBNAME_COLUMN_INDEX) {
+      pCol->colId = CQ_INC_ROW_KEY;
+    }
+  }
+
+  // rows of the windows which are open now may have been written, they are not in the state
+  TSKEY now = taosGetTimestamp(pInc->precision);
+  pInc->startKey = taosTimeTruncate(now, &pInc->interval, pInc->precision) + pInc->interval.interval;
+
+  return pInc;
+}
+
+static void cqIncDestroy(SCqIncState *pInc) {
+  for (int32_t i = 0; i < taosArrayGetSize(pInc->pWins); ++i) {
+    free(taosArrayGetP(pInc->pWins, i));
+  }
+
+  taosArrayDestroy(pInc->pWins);
+  tfree(pInc->cols);
+  free(pInc);
+}
+
+static void cqIncReset(SCqContext *pContext, SCqObj *pObj) {
+  if (pContext == NULL) return;
+
+  pthread_mutex_lock(&pContext->incMutex);
+
+  SCqIncState *pInc = pObj->pInc;
+  if (pInc != NULL) {
+    SArray **pObjs = taosHashGet(pContext->incTables, &pInc->uid, sizeof(pInc->uid));
+    if (pObjs != NULL) {
+      for (int32_t i = 0; i < taosArrayGetSize(*pObjs); ++i) {
+        if (taosArrayGetP(*pObjs, i) == pObj) {
+          taosArrayRemove(*pObjs, i);
+          atomic_sub_fetch_32(&pContext->incObjNum, 1);
+          break;
+        }
+      }
+
+      if (taosArrayGetSize(*pObjs) == 0) {
+        taosArrayDestroy(*pObjs);
+        taosHashRemove(pContext->incTables, &pInc->uid, sizeof(pInc->uid));
+      }
+    }
+
+    pObj->pInc = NULL;
+    cqIncDestroy(pInc);
+  }
+
+  pthread_mutex_unlock(&pContext->incMutex);
+}
+
+static int32_t cqIncAdd(SCqContext *pContext, SCqObj *pObj, SCqIncState *pInc) {
+  SArray **pObjs = taosHashGet(pContext->incTables, &pInc->uid, sizeof(pInc->uid));
+  SArray  *objs = (pObjs == NULL) ? NULL : *pObjs;
+
+  if (objs == NULL) {
+    objs = taosArrayInit(1, POINTER_BYTES);
+    if (objs == NULL) return -1;
+
+    if (taosHashPut(pContext->incTables, &pInc->uid, sizeof(pInc->uid), &objs, POINTER_BYTES) != 0) {
+      taosArrayDestroy(objs);
+      return -1;
+    }
+  }
+
+  taosArrayPush(objs, &pObj);
+  pObj->pInc = pInc;
+  atomic_add_fetch_32(&pContext->incObjNum, 1);
+  return 0;
+}
+
+// index of the first window whose skey is not less than the given one
+static int32_t cqIncSearchWin(SCqIncState *pInc, TSKEY skey) {
+  int32_t lo = 0, hi = (int32_t)taosArrayGetSize(pInc->pWins);
+  while (lo < hi) {
+    int32_t mid = (lo + hi) / 2;
+    if (((SCqIncWin *)taosArrayGetP(pInc->pWins, mid))->skey < skey) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+static SCqIncWin *cqIncGetWin(SCqIncState *pInc, TSKEY skey) {
+  size_t     size = taosArrayGetSize(pInc->pWins);
+  SCqIncWin *pWin = (size > 0) ? taosArrayGetP(pInc->pWins, size - 1) : NULL;
+
+  // rows are appended to the last window mostly
+  if (pWin != NULL && pWin->skey == skey) return pWin;
+
+  int32_t idx = (pWin != NULL && pWin->skey < skey) ? (int32_t)size : cqIncSearchWin(pInc, skey);
+  if (idx < size && ((SCqIncWin *)taosArrayGetP(pInc->pWins, idx))->skey == skey) {
+    return taosArrayGetP(pInc->pWins, idx);
+  }
+
+  pWin = calloc(1, sizeof(SCqIncWin) + sizeof(SCqIncAcc) * pInc->numOfCols);
+  if (pWin == NULL) return NULL;
+
+  pWin->skey = skey;
+  if (taosArrayInsert(pInc->pWins, idx, &pWin) == NULL) {
+    free(pWin);
+    return NULL;
+  }
+
+  return pWin;
+}
+
+static void cqIncResolveCols(SCqIncState *pInc, STSchema *pSchema) {
+  for (int32_t i = 0; i < pInc->numOfCols; ++i) {
+    SCqIncCol *pCol = &pInc->cols[i];
+    STColumn  *pTCol = (pCol->colId == CQ_INC_ROW_KEY) ? NULL : tdGetColOfID(pSchema, pCol->colId);
+
+    pCol->offset = (pTCol == NULL || pTCol->type != pCol->colType) ? -1 : TD_DATA_ROW_HEAD_SIZE + pTCol->offset;
+  }
+
+  pInc->sversion = schemaVersion(pSchema);
+}
+
+static int32_t cqIncCompare(int8_t type, const void *a, const void *b) {
+  if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
+    uint64_t x = 0, y = 0;
+    GET_TYPED_DATA(x, uint64_t, type, a);
+    GET_TYPED_DATA(y, uint64_t, type, b);
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+  } else if (IS_FLOAT_TYPE(type)) {
+    double x = 0, y = 0;
+    GET_TYPED_DATA(x, double, type, a);
+    GET_TYPED_DATA(y, double, type, b);
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+  } else {
+    int64_t x = 0, y = 0;
+    GET_TYPED_DATA(x, int64_t, type, a);
+    GET_TYPED_DATA(y, int64_t, type, b);
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+  }
+}
+
+static void cqIncAccumulate(SCqIncAcc *pAcc, SCqIncCol *pCol, const void *val) {
+  int8_t  type = pCol->colType;
+  int32_t bytes = tDataTypes[type].bytes;
+
+  switch (pCol->functionId) {
+    case TSDB_FUNC_SUM:
+      if (IS_SIGNED_NUMERIC_TYPE(type)) {
+        int64_t v = 0;
+        GET_TYPED_DATA(v, int64_t, type, val);
+        pAcc->sum.i += v;
+      } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
+        uint64_t v = 0;
+        GET_TYPED_DATA(v, uint64_t, type, val);
+        pAcc->sum.u += v;
+      } else {
+        double v = 0;
+        GET_TYPED_DATA(v, double, type, val);
+        pAcc->sum.d += v;
+      }
+      break;
+    case TSDB_FUNC_AVG: {
+      double v = 0;
+      GET_TYPED_DATA(v, double, type, val);
+      pAcc->sum.d += v;
+      break;
+    }
+    case TSDB_FUNC_MIN:
+    case TSDB_FUNC_MAX:
+    case TSDB_FUNC_SPREAD:
+      if (pAcc->count == 0 || cqIncCompare(type, val, &pAcc->min) < 0) memcpy(&pAcc->min, val, bytes);
+      if (pAcc->count == 0 || cqIncCompare(type, val, &pAcc->max) > 0) memcpy(&pAcc->max, val, bytes);
+      break;
+    case TSDB_FUNC_FIRST:
+      if (pAcc->count == 0) memcpy(&pAcc->first, val, bytes);
+      break;
+    case TSDB_FUNC_LAST:
+      memcpy(&pAcc->last, val, bytes);
+      break;
+    default:
+      break;
+  }
+
+  pAcc->count += 1;
+}
+
+static void cqIncFeed(SCqIncState *pInc, STSchema *pSchema, SMemRow row, bool inOrder) {
+  TSKEY      key = memRowKey(row);
+  SCqIncWin *pWin = cqIncGetWin(pInc, taosTimeTruncate(key, &pInc->interval, pInc->precision));
+
+  if (pWin == NULL) {  // the window can not be kept, so it is lost
+    cError("uid:%" PRIu64 ", failed to keep the window of key:%" PRId64 " for CQ", pInc->uid, key);
+    return;
+  }
+
+  if (!inOrder || pWin->dirty) {
+    pWin->dirty = true;
+    return;
+  }
+
+  if (schemaVersion(pSchema) != pInc->sversion) {
+    cqIncResolveCols(pInc, pSchema);
+  }
+
+  for (int32_t i = 0; i < pInc->numOfCols; ++i) {
+    SCqIncCol  *pCol = &pInc->cols[i];
+    const void *val = NULL;
+
+    if (pCol->functionId == TSDB_FUNC_TS || pCol->functionId == TSDB_FUNC_TS_DUMMY) {
+      continue;
+    } else if (pCol->colId == CQ_INC_ROW_KEY) {
+      val = &key;
+    } else if (pCol->offset >= 0) {
+      val = tdGetMemRowDataOfCol(row, pCol->colId, pCol->colType, pCol->offset);
+    }
+
+    if (val == NULL || (pCol->colId != CQ_INC_ROW_KEY && isNull(val, pCol->colType))) {
+      continue;
+    }
+
+    cqIncAccumulate(&pWin->acc[i], pCol, val);
+  }
+}
+
+// the result row of a window, the values are kept after the pointers to them
+static TAOS_ROW cqIncEmit(SCqIncState *pInc, SCqIncWin *pWin) {
+  TAOS_ROW row = malloc(pInc->numOfCols * (POINTER_BYTES + sizeof(int64_t)));
+  if (row == NULL) return NULL;
+
+  char *buf = (char *)(row + pInc->numOfCols);
+  for (int32_t i = 0; i < pInc->numOfCols; ++i) {
+    SCqIncCol *pCol = &pInc->cols[i];
+    SCqIncAcc *pAcc = &pWin->acc[i];
+    char      *p = buf + i * sizeof(int64_t);
+
+    row[i] = p;
+    if (pCol->functionId == TSDB_FUNC_TS || pCol->functionId == TSDB_FUNC_TS_DUMMY) {
+      *(TSKEY *)p = pWin->skey;
+      continue;
+    } else if (pCol->functionId == TSDB_FUNC_COUNT) {
+      *(int64_t *)p = pAcc->count;
+      continue;
+    } else if (pAcc->count == 0) {  // all values are null
+      row[i] = NULL;
+      continue;
+    }
+
+    switch (pCol->functionId) {
+      case TSDB_FUNC_SUM:
+        memcpy(p, &pAcc->sum, sizeof(int64_t));
+        break;
+      case TSDB_FUNC_AVG:
+        *(double *)p = pAcc->sum.d / pAcc->count;
+        break;
+      case TSDB_FUNC_MIN:
+        memcpy(p, &pAcc->min, pCol->resBytes);
+        break;
+      case TSDB_FUNC_MAX:
+        memcpy(p, &pAcc->max, pCol->resBytes);
+        break;
+      case TSDB_FUNC_FIRST:
+        memcpy(p, &pAcc->first, pCol->resBytes);
+        break;
+      case TSDB_FUNC_LAST:
+        memcpy(p, &pAcc->last, pCol->resBytes);
+        break;
+      case TSDB_FUNC_SPREAD: {
+        double min = 0, max = 0;
+        GET_TYPED_DATA(min, double, pCol->colType, &pAcc->min);
+        GET_TYPED_DATA(max, double, pCol->colType, &pAcc->max);
+        *(double *)p = max - min;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  return row;
+}
+
+/*
+ * Rows written into the windows after startKey before the state is created, e.g. rows with keys in the future, are
+ * not in the state. The last key of the table is read once the rows written are fed, and the windows up to it are
+ * queried. It is read out of incMutex, since tsdb drops CQs with its meta locked.
+ */
+static void cqIncSeed(SCqContext *pContext, SCqObj *pObj, SCqIncState *pInc) {
+  if (pContext->cqLastKey == NULL) return;
+
+  TSKEY lastKey = (*pContext->cqLastKey)(pContext->vgId, pInc->uid);
+
+  pthread_mutex_lock(&pContext->incMutex);
+
+  // the state may be reset meanwhile, a new one is only created by the next launch of the stream
+  if (pObj->pInc == pInc && lastKey >= pInc->startKey) {
+    pInc->startKey = taosTimeTruncate(lastKey, &pInc->interval, pInc->precision) + pInc->interval.interval;
+    cDebug("vgId:%d, id:%d CQ:%s has rows up to %" PRId64 ", computed incrementally since %" PRId64, pContext->vgId,
+           pObj->tid, pObj->sqlStr, lastKey, pInc->startKey);
+  }
+
+  pthread_mutex_unlock(&pContext->incMutex);
+}
+
+static void cqFreeRow(void *p) { free(*(TAOS_ROW *)p); }
+
+/*
+ * Called by the stream before each launch. The closed windows in [skey, ekey) are written into the stream table
+ * from the state, unless some of them are not complete in the state, in which case they are all queried.
+ */
+static bool cqProcessIncWindows(void *param, SSqlStream *pStream, int64_t skey, int64_t ekey) {
+  SCqObj *pObj = (SCqObj *)taosAcquireRef(cqObjRef, (int64_t)param);
+  if (pObj == NULL) {
+    return false;
+  }
+
+  SCqContext  *pContext = pObj->pContext;
+  SCqIncState *pCreated = NULL;
+  SArray      *pRows = NULL;
+  bool         emitted = false;
+
+  pthread_mutex_lock(&pContext->incMutex);
+
+  SCqIncState *pInc = pObj->pInc;
+  if (pInc == NULL) {
+    // the query of the stream is parsed before its first launch
+    pInc = cqIncCreate(pContext, pObj, pStream);
+    if (pInc != NULL && cqIncAdd(pContext, pObj, pInc) != 0) {
+      cqIncDestroy(pInc);
+      pInc = NULL;
+    }
+    pCreated = pInc;
+
+    if (pInc == NULL) {
+      tscSetStreamIncFp(pStream, NULL);
+      cDebug("vgId:%d, id:%d CQ:%s is computed by queries", pContext->vgId, pObj->tid, pObj->sqlStr);
+    } else {
+      cDebug("vgId:%d, id:%d CQ:%s is computed incrementally since %" PRId64, pContext->vgId, pObj->tid, pObj->sqlStr,
+             pInc->startKey);
+    }
+  } else if (skey >= pInc->startKey) {
+    int32_t start = cqIncSearchWin(pInc, skey);
+    int32_t end = start;
+    emitted = true;
+
+    for (; end < taosArrayGetSize(pInc->pWins); ++end) {
+      SCqIncWin *pWin = taosArrayGetP(pInc->pWins, end);
+      if (pWin->skey + pInc->interval.interval > ekey) break;
+      if (pWin->dirty) emitted = false;
+    }
+
+    if (emitted) {
+      pRows = taosArrayInit(end - start + 1, POINTER_BYTES);
+      for (int32_t i = start; pRows != NULL && i < end; ++i) {
+        TAOS_ROW row = cqIncEmit(pInc, taosArrayGetP(pInc->pWins, i));
+        if (row == NULL) break;
+        taosArrayPush(pRows, &row);
+      }
+
+      // the windows are queried if their rows can not be kept
+      if (pRows == NULL || taosArrayGetSize(pRows) < end - start) {
+        taosArrayDestroyEx(pRows, cqFreeRow);
+        pRows = NULL;
+        emitted = false;
+      }
+    }
+
+    cDebug("vgId:%d, id:%d CQ:%s, %d windows in %" PRId64 "-%" PRId64 " are %s", pContext->vgId, pObj->tid,
+           pObj->sqlStr, end - start, skey, ekey, emitted ? "emitted" : "queried");
+  }
+
+  // the closed windows are either emitted or queried
+  while (pInc != NULL && taosArrayGetSize(pInc->pWins) > 0) {
+    SCqIncWin *pWin = taosArrayGetP(pInc->pWins, 0);
+    if (pWin->skey + pInc->interval.interval > ekey) break;
+
+    taosArrayRemove(pInc->pWins, 0);
+    free(pWin);
+  }
+
+  pthread_mutex_unlock(&pContext->incMutex);
+
+  if (pCreated != NULL) {
+    cqIncSeed(pContext, pObj, pCreated);
+  }
+
+  // the rows are written with the state unlocked, since writes may wait for the flow control of the vnode
+  for (int32_t i = 0; pRows != NULL && i < taosArrayGetSize(pRows); ++i) {
+    cqWriteRow(pContext, pObj, taosArrayGetP(pRows, i), NULL);
+  }
+  taosArrayDestroyEx(pRows, cqFreeRow);
+
   taosReleaseRef(cqObjRef, (int64_t)param);
+  return emitted;
+}
+
+bool cqAccept(void *handle, uint64_t uid) {
+  SCqContext *pContext = handle;
+  if (pContext == NULL || atomic_load_32(&pContext->incObjNum) <= 0) {
+    return false;
+  }
+
+  pthread_mutex_lock(&pContext->incMutex);
+  bool accepted = (taosHashGet(pContext->incTables, &uid, sizeof(uid)) != NULL);
+  pthread_mutex_unlock(&pContext->incMutex);
+
+  return accepted;
 }
 
+void cqFeed(void *handle, uint64_t uid, STSchema *pSchema, SMemRow row, bool inOrder) {
+  SCqContext *pContext = handle;
+
+  pthread_mutex_lock(&pContext->incMutex);
+
+  SArray **pObjs = taosHashGet(pContext->incTables, &uid, sizeof(uid));
+  for (int32_t i = 0; pObjs != NULL && i < taosArrayGetSize(*pObjs); ++i) {
+    SCqObj *pObj = taosArrayGetP(*pObjs, i);
+    cqIncFeed(pObj->pInc, pSchema, row, inOrder);
+  }
+
+  pthread_mutex_unlock(&pContext->incMutex);
+}
@@ -42,7 +42,7 @@ int32_t dnodeInitMRead() {
 
   tsMReadWP.maxNum = (int32_t)(tsNumOfCores * tsNumOfThreadsPerCore / 2);
   tsMReadWP.maxNum = MAX(2, tsMReadWP.maxNum);
-  tsMReadWP.maxNum = MIN(4, tsMReadWP.maxNum);
+  tsMReadWP.maxNum = MIN(8, tsMReadWP.maxNum);
   tsMReadWP.curNum = 0;
   tsMReadWP.worker = (SMReadWorker *)calloc(sizeof(SMReadWorker), tsMReadWP.maxNum);
 
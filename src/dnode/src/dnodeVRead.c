@@ -142,7 +142,8 @@ static void *dnodeProcessReadQueue(void *wparam) {
       if (code == TSDB_CODE_QRY_HAS_RSP) {
         dnodeSendRpcVReadRsp(pVnode, pRead, pRead->code);
       } else {  // code == TSDB_CODE_QRY_NOT_READY, do not return msg to client
-        assert(pRead->rpcHandle == NULL || (pRead->rpcHandle != NULL && pRead->msgType == 5));
+        assert(pRead->rpcHandle == NULL ||
+               (pRead->rpcHandle != NULL && (pRead->msgType == 5 || pRead->msgType == TSDB_MSG_TYPE_SUB_WAIT)));
         dnodeDispatchNonRspMsg(pVnode, pRead, code);
       }
     }
@@ -214,6 +214,8 @@ static void *dnodeProcessVWriteQueue(void *wparam) {
       dTrace("msg:%p is processed in vwrite queue, code:0x%x", pWrite, pWrite->code);
     }
 
+    // forwards of the batch are sent to peers in one go, then the acks of forwards from master
+    vnodeFlushForwards(pVnode);
     walFsync(vnodeGetWal(pVnode), forceFsync);
 
     // browse all items, and process them one by one
@@ -232,6 +234,8 @@ static void *dnodeProcessVWriteQueue(void *wparam) {
         vnodeFreeFromWQueue(pVnode, pWrite);
       }
     }
+
+    vnodeFlushForwards(pVnode);
   }
 
   return NULL;
@@ -28,8 +28,14 @@ typedef struct {
   int32_t   opened;
   int32_t   vnodeNum;
   int32_t * vnodeList;
+  int32_t * nextVnode;
 } SOpenVnodeThread;
 
+typedef struct {
+  int32_t vgId;
+  int64_t walSize;
+} SVnodeWalSize;
+
 extern void *   tsDnodeTmr;
 static void *   tsStatusTimer = NULL;
 static uint32_t tsRebootTime = 0;
@@ -89,10 +95,14 @@ static void *dnodeOpenVnode(void *param) {
   SOpenVnodeThread *pThread = param;
   char stepDesc[TSDB_STEP_DESC_LEN] = {0};
 
-  dDebug("thread:%d, start to open %d vnodes", pThread->threadIndex, pThread->vnodeNum);
+  dDebug("thread:%d, start to open vnodes", pThread->threadIndex);
   setThreadName("dnodeOpenVnode");
 
-  for (int32_t v = 0; v < pThread->vnodeNum; ++v) {
+  // vnodes are taken one by one from the shared list, so a thread restoring a large wal does not hold back others
+  while (1) {
+    int32_t v = atomic_fetch_add_32(pThread->nextVnode, 1);
+    if (v >= pThread->vnodeNum) break;
+
     int32_t vgId = pThread->vnodeList[v];
     snprintf(stepDesc, TSDB_STEP_DESC_LEN, "vgId:%d, start to restore, %d of %d have been opened", vgId, tsOpenVnodes, tsTotalVnodes);
     dnodeReportStep("open-vnodes", stepDesc, 0);
@@ -108,11 +118,39 @@ static void *dnodeOpenVnode(void *param) {
     atomic_add_fetch_32(&tsOpenVnodes, 1);
   }
 
-  dDebug("thread:%d, total vnodes:%d, opened:%d failed:%d", pThread->threadIndex, pThread->vnodeNum, pThread->opened,
-         pThread->failed);
+  dDebug("thread:%d, opened:%d failed:%d", pThread->threadIndex, pThread->opened, pThread->failed);
   return NULL;
 }
 
+static int64_t dnodeGetVnodeWalSize(int32_t vgId) {
+  char walDir[TSDB_FILENAME_LEN + 32];
+  snprintf(walDir, sizeof(walDir), "%s/vnode%d/wal", tsVnodeDir, vgId);
+
+  DIR *dir = opendir(walDir);
+  if (dir == NULL) return 0;
+
+  int64_t        size = 0;
+  struct dirent *de = NULL;
+  while ((de = readdir(dir)) != NULL) {
+    if (strncmp(de->d_name, "wal", 3) != 0) continue;
+
+    char        name[sizeof(walDir) + sizeof(de->d_name) + 1];
+    struct stat st;
+    snprintf(name, sizeof(name), "%s/%s", walDir, de->d_name);
+    if (stat(name, &st) == 0) size += st.st_size;
+  }
+  closedir(dir);
+
+  return size;
+}
+
+static int32_t dnodeCompareVnodeWalSize(const void *a, const void *b) {
+  const SVnodeWalSize *pa = a;
+  const SVnodeWalSize *pb = b;
+  if (pa->walSize == pb->walSize) return pa->vgId - pb->vgId;
+  return (pa->walSize > pb->walSize) ? -1 : 1;
+}
+
 int32_t dnodeInitVnodes() {
   int32_t vnodeList[TSDB_MAX_VNODES] = {0};
   int32_t numOfVnodes = 0;
@@ -124,18 +162,37 @@ int32_t dnodeInitVnodes() {
     return status;
   }
 
-  int32_t threadNum = tsNumOfCores;
-  int32_t vnodesPerThread = numOfVnodes / threadNum + 1;
-  SOpenVnodeThread *threads = calloc(threadNum, sizeof(SOpenVnodeThread));
-  for (int32_t t = 0; t < threadNum; ++t) {
-    threads[t].threadIndex = t;
-    threads[t].vnodeList = calloc(vnodesPerThread, sizeof(int32_t));
+  // vnodes with the most wal to restore are opened first to shorten the total time
+  SVnodeWalSize *walSizes = calloc(numOfVnodes + 1, sizeof(SVnodeWalSize));
+  if (walSizes == NULL) {
+    dError("failed to malloc wal sizes of %d vnodes", numOfVnodes);
+    return TSDB_CODE_DND_OUT_OF_MEMORY;
   }
 
   for (int32_t v = 0; v < numOfVnodes; ++v) {
-    int32_t t = v % threadNum;
-    SOpenVnodeThread *pThread = &threads[t];
-    pThread->vnodeList[pThread->vnodeNum++] = vnodeList[v];
+    walSizes[v].vgId = vnodeList[v];
+    walSizes[v].walSize = dnodeGetVnodeWalSize(vnodeList[v]);
+  }
+  qsort(walSizes, numOfVnodes, sizeof(SVnodeWalSize), dnodeCompareVnodeWalSize);
+  for (int32_t v = 0; v < numOfVnodes; ++v) {
+    vnodeList[v] = walSizes[v].vgId;
+  }
+  free(walSizes);
+
+  int32_t threadNum = MAX(numOfVnodes, 1);
+  if (threadNum > tsNumOfCores) threadNum = tsNumOfCores;
+  int32_t nextVnode = 0;
+  SOpenVnodeThread *threads = calloc(threadNum, sizeof(SOpenVnodeThread));
+  if (threads == NULL) {
+    dError("failed to malloc %d threads to open vnodes", threadNum);
+    return TSDB_CODE_DND_OUT_OF_MEMORY;
+  }
+
+  for (int32_t t = 0; t < threadNum; ++t) {
+    threads[t].threadIndex = t;
+    threads[t].vnodeNum = numOfVnodes;
+    threads[t].vnodeList = vnodeList;
+    threads[t].nextVnode = &nextVnode;
   }
 
   dInfo("start %d threads to open %d vnodes", threadNum, numOfVnodes);
@@ -163,7 +220,6 @@ int32_t dnodeInitVnodes() {
     }
     openVnodes += pThread->opened;
     failedVnodes += pThread->failed;
-    free(pThread->vnodeList);
   }
 
   free(threads);
@@ -28,6 +28,7 @@ typedef void   TAOS_STMT;
 typedef void   TAOS_RES;
 typedef void   TAOS_STREAM;
 typedef void   TAOS_SUB;
+typedef void   TAOS_BULK_WRITER;
 typedef void **TAOS_ROW;
 
 // Data type definition
@@ -170,6 +171,20 @@ DLL_EXPORT void taos_close_stream(TAOS_STREAM *tstr);
 
 DLL_EXPORT int taos_load_table_info(TAOS *taos, const char* tableNameList);
 
+typedef struct TAOS_BULK_WRITER_OPTIONS {
+  int    maxRows;        // rows buffered for one vgroup before they are submitted, 0 for default
+  int    maxBytes;       // bytes buffered for one vgroup before they are submitted, 0 for default
+  int    flushInterval;  // ms, buffered rows are submitted no later than this, 0 for default
+  int    maxInflight;    // submits on the way to one vgroup, append blocks once reached, 0 for default
+  void (*fp)(void *param, const char *tableName, int numOfRows, int code);  // rows of a table failed to be written
+  void  *param;
+} TAOS_BULK_WRITER_OPTIONS;
+
+DLL_EXPORT TAOS_BULK_WRITER *taos_bulk_writer_open(TAOS *taos, TAOS_BULK_WRITER_OPTIONS *options);
+DLL_EXPORT int               taos_bulk_writer_append(TAOS_BULK_WRITER *writer, const char *tableName, TAOS_BIND *row);
+DLL_EXPORT int               taos_bulk_writer_flush(TAOS_BULK_WRITER *writer);
+DLL_EXPORT void              taos_bulk_writer_close(TAOS_BULK_WRITER *writer);
+
 DLL_EXPORT int taos_insert_lines(TAOS* taos, char* lines[], int numLines);
 
 DLL_EXPORT int taos_insert_telnet_lines(TAOS* taos, char* lines[], int numLines);
@@ -216,6 +216,10 @@ do { \
 #define TSDB_MAX_TAGS             128
 #define TSDB_MAX_TAG_CONDITIONS   1024
 
+// vnodes hold up to twice as many rows in memory for the streaming global merge, a larger limit + offset is
+// merged on disk by the client
+#define TSDB_MAX_ORDERED_PRJ_LIMIT 65536
+
 #define TSDB_AUTH_LEN             16
 #define TSDB_KEY_LEN              16
 #define TSDB_VERSION_LEN          12
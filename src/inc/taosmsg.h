@@ -45,7 +45,7 @@ TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_SUBMIT, "submit" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_QUERY, "query" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_FETCH, "fetch" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_UPDATE_TAG_VAL, "update-tag-val" )
-TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_DUMMY1, "dummy1" )
+TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_SUB_WAIT, "sub-wait" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_DUMMY2, "dummy2" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_DUMMY3, "dummy3" )
 
@@ -99,7 +99,7 @@ TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_CM_KILL_CONN, "kill-conn" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_CM_CONFIG_DNODE, "cm-config-dnode" ) 
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_CM_HEARTBEAT, "heartbeat" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_CM_RETRIEVE_FUNC, "retrieve-func" )
-TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_DUMMY9, "dummy9" )
+TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_CM_STABLE_TABLES, "stable-tables" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_DUMMY10, "dummy10" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_DUMMY11, "dummy11" )
 
@@ -224,7 +224,7 @@ typedef struct SMsgHead {
 typedef struct SSubmitBlk {
   uint64_t uid;        // table unique id
   int32_t  tid;        // table id
-  int32_t  padding;    // TODO just for padding here
+  int32_t  flag;       // TSDB_SUBMIT_BLK_FLAG_XXX, 0 for SMemRow rows
   int32_t  sversion;   // data schema version
   int32_t  dataLen;    // data part length, not including the SSubmitBlk head
   int32_t  schemaLen;  // schema length, if length is 0, no schema exists
@@ -232,6 +232,19 @@ typedef struct SSubmitBlk {
   char     data[];
 } SSubmitBlk;
 
+// The data part holds all columns of the table in schema order instead of SMemRow rows. Each column is a
+// SSubmitColHead, a null bitmap of (numOfRows + 7) / 8 bytes in which a set bit means null, and then either
+// numOfRows fixed-size values, or numOfRows int32_t offsets followed by the VarData values they point to.
+// Only sent to clusters that report TSDB_CONN_FEATURE_COLUMNAR_SUBMIT.
+#define TSDB_SUBMIT_BLK_FLAG_COLUMNAR 0x1
+
+typedef struct SSubmitColHead {
+  int16_t colId;
+  int8_t  type;
+  int8_t  reserved;
+  int32_t len;  // column length, not including the SSubmitColHead
+} SSubmitColHead;
+
 // Submit message for this TSDB
 typedef struct SSubmitMsg {
   SMsgHead   header;
@@ -256,6 +269,12 @@ typedef struct {
   SShellSubmitRspBlock failedBlocks[];
 } SShellSubmitRspMsg;
 
+// appended after the failed blocks of SShellSubmitRspMsg, old clients ignore it
+typedef struct {
+  int32_t retryAfter;    // ms the client shall wait before next submit to this vgroup, 0 if no backpressure
+  int32_t allowedBytes;  // bytes the vnode can take now without throttling
+} SShellSubmitRspFlowCtrl;
+
 typedef struct SSchema {
   uint8_t type;
   char    name[TSDB_COL_NAME_LEN];
@@ -345,12 +364,15 @@ typedef struct {
   char      clusterId[TSDB_CLUSTER_ID_LEN];
   int8_t    writeAuth;
   int8_t    superAuth;
-  int8_t    reserved1;
+  int8_t    features;  // TSDB_CONN_FEATURE_XXX
   int8_t    reserved2;
   int32_t   connId;
   SRpcEpSet epSet;
 } SConnectRsp;
 
+#define TSDB_CONN_FEATURE_COLUMNAR_SUBMIT 0x1
+#define TSDB_CONN_FEATURE_ORDERED_PRJ_LIMIT 0x2  // vnodes send ordered projections with a limit in timestamp order
+
 typedef struct {
   int32_t maxUsers;
   int32_t maxDbs;
@@ -515,6 +537,7 @@ typedef struct {
   int32_t     udfNum;           // number of udf function
   int32_t     udfContentOffset;
   int32_t     udfContentLen;
+  int32_t     numOfJoinTables;  // join partner of each table, merge joined in vnode, follows the table list
   SColumnInfo tableCols[];
 } SQueryTableMsg;
 
@@ -530,6 +553,21 @@ typedef struct {
   uint16_t free;
 } SRetrieveTableMsg;
 
+/*
+ * long-poll of a subscription: the vnode holds the request until one of the tables has rows
+ * after its progress key, or until waitTime elapses
+ */
+typedef struct {
+  SMsgHead     head;
+  int32_t      waitTime;     // ms
+  int32_t      numOfTables;
+  STableIdInfo tables[];     // key is the acknowledged progress of the table
+} SSubWaitMsg;
+
+typedef struct {
+  int32_t numOfTables;       // number of tables having new rows, 0 if the wait timed out
+} SSubWaitRsp;
+
 typedef struct SRetrieveTableRsp {
   int32_t numOfRows;
   int8_t  completed;  // all results are returned to client
@@ -806,6 +844,30 @@ typedef struct SMultiTableMeta {
   char          meta[];
 } SMultiTableMeta;
 
+typedef struct {
+  char    tableFname[TSDB_TABLE_FNAME_LEN];  // super table
+  int32_t maxTables;
+} SSTableTablesMsg;
+
+typedef struct {
+  int32_t  vgId;
+  int32_t  tid;
+  uint64_t uid;
+  int16_t  nameLen;
+  char     name[];  // table full name, not null terminated
+} SChildTableInfoMsg;
+
+typedef struct {
+  uint64_t suid;
+  int32_t  sversion;
+  int32_t  tversion;
+  int32_t  numOfTables;
+  int32_t  contLen;     // length of data
+  uint32_t rawLen;      // length of data before compress
+  uint8_t  compressed;
+  char     data[];      // super table name and its SVgroupsMsg, followed by numOfTables SChildTableInfoMsg
+} SSTableTablesRspMsg;
+
 typedef struct {
   int32_t dataLen;
   char    name[TSDB_TABLE_FNAME_LEN];
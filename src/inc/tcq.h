@@ -22,6 +22,7 @@ extern "C" {
 #include "tdataformat.h"
 
 typedef int32_t (*FCqWrite)(int32_t vgId, void *pHead, int32_t qtype, void *pMsg);
+typedef int64_t (*FCqLastKey)(int32_t vgId, uint64_t uid);
 
 typedef struct {
   int32_t  vgId;
@@ -29,6 +30,7 @@ typedef struct {
   char     pass[TSDB_KEY_LEN];
   char     db[TSDB_ACCT_ID_LEN + TSDB_DB_NAME_LEN]; // size must same with SVnodeObj.db[TSDB_ACCT_ID_LEN + TSDB_DB_NAME_LEN]
   FCqWrite cqWrite;
+  FCqLastKey cqLastKey;  // last key of a table of the vnode
 } SCqCfg;
 
 // SCqContext
@@ -40,12 +42,16 @@ typedef struct {
   char     pass[TSDB_KEY_LEN];
   char     db[TSDB_DB_NAME_LEN];
   FCqWrite cqWrite;
+  FCqLastKey cqLastKey;
   struct SCqObj *pHead;
   void    *dbConn;
   void    *tmrCtrl;
   pthread_mutex_t mutex;
   int32_t delete;
   int32_t cqObjNum;
+  pthread_mutex_t incMutex;  // protects the window state of the incremental CQs
+  void   *incTables;         // uid of source table -> incremental CQs on it
+  int32_t incObjNum;
 } SCqContext;
 
 // the following API shall be called by vnode
@@ -64,6 +70,12 @@ void *cqCreate(void *handle, uint64_t uid, int32_t sid, const char* dstTable, ch
 // cqDrop is called by TSDB to stop an instance of CQ, handle is the return value of cqCreate
 void  cqDrop(void *handle);
 
+// cqAccept is called by TSDB to check whether the rows written into a table are fed to incremental CQs
+bool  cqAccept(void *handle, uint64_t uid);
+
+// cqFeed is called by TSDB for each row written into a table accepted by cqAccept
+void  cqFeed(void *handle, uint64_t uid, STSchema *pSchema, SMemRow row, bool inOrder);
+
 extern int32_t cqDebugFlag;
 
 
@@ -53,6 +53,7 @@ void tfsDestroy();
 void tfsUpdateInfo(SFSMeta *pFSMeta, STierMeta *tierMetas, int8_t numLevels);
 void tfsGetMeta(SFSMeta *pMeta);
 void tfsAllocDisk(int expLevel, int *level, int *id);
+int  tfsGetLevelNum();
 
 const char *TFS_PRIMARY_PATH();
 const char *TFS_DISK_PATH(int level, int id);
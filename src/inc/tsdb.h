@@ -54,6 +54,9 @@ typedef struct {
   int (*eventCallBack)(void *);
   void *(*cqCreateFunc)(void *handle, uint64_t uid, int32_t sid, const char *dstTable, char *sqlStr, STSchema *pSchema, int start);
   void (*cqDropFunc)(void *handle);
+  // rows written into a table accepted by cqAcceptFunc are fed to the incremental CQs on it
+  bool (*cqAcceptFunc)(void *handle, uint64_t uid);
+  void (*cqFeedFunc)(void *handle, uint64_t uid, STSchema *pSchema, SMemRow row, bool inOrder);
 } STsdbAppH;
 
 // --------- TSDB REPOSITORY CONFIGURATION DEFINITION
@@ -131,6 +134,9 @@ int tsdbCreateTable(STsdbRepo *repo, STableCfg *pCfg);
 int tsdbDropTable(STsdbRepo *pRepo, STableId tableId);
 int tsdbUpdateTableTagValue(STsdbRepo *repo, SUpdateTableTagValMsg *pMsg);
 
+// last key of a normal or child table, TSKEY_INITIAL_VAL if the table does not exist
+TSKEY tsdbGetTableLastKey(STsdbRepo *repo, uint64_t uid);
+
 uint32_t tsdbGetFileInfo(STsdbRepo *repo, char *name, uint32_t *index, uint32_t eindex, int64_t *size);
 
 // the TSDB repository info
@@ -177,6 +183,8 @@ typedef struct STsdbQueryCond {
   SColumnInfo *colList;
   bool         loadExternalRows;  // load external rows or not
   int32_t      type;              // data block load type:
+  int64_t      rollupInterval;    // interval of which the windows may be read from rollup tiers, 0 if not
+  char         rollupIntervalUnit;
 } STsdbQueryCond;
 
 typedef struct STableData STableData;
@@ -388,6 +396,15 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle);
 
 void tsdbResetQueryHandle(TsdbQueryHandleT queryHandle, STsdbQueryCond *pCond);
 
+/**
+ * set the function to check if the query is killed, which is called in long loops of the query handle over files
+ * and tables, so that a killed query stops scanning in time instead of at the next returned data block
+ * @param queryHandle
+ * @param fp      returns true if the query is killed
+ * @param param   parameter passed to fp
+ */
+void tsdbSetQueryKilledFp(TsdbQueryHandleT queryHandle, bool (*fp)(void *param), void *param);
+
 void tsdbResetQueryHandleForNewTable(TsdbQueryHandleT queryHandle, STsdbQueryCond *pCond, STableGroupInfo* groupList);
 
 int32_t tsdbGetFileBlocksDistInfo(TsdbQueryHandleT* queryHandle, STableBlockDist* pTableBlockInfo);
@@ -401,6 +418,13 @@ int32_t tsdbGetFileBlocksDistInfo(TsdbQueryHandleT* queryHandle, STableBlockDist
  */
 void tsdbReportStat(void *repo, int64_t *totalPoints, int64_t *totalStorage, int64_t *compStorage);
 
+/**
+ * get the cache bytes the active mem table can still take before a commit is triggered
+ * @param repo. point to the tsdbrepo
+ * @return the headroom in bytes, 0 if the mem table is full
+ */
+int64_t tsdbGetMemHeadroom(STsdbRepo *repo);
+
 int  tsdbInitCommitQueue();
 void tsdbDestroyCommitQueue();
 int  tsdbSyncCommit(STsdbRepo *repo);
@@ -408,12 +432,16 @@ void tsdbIncCommitRef(int vgId);
 void tsdbDecCommitRef(int vgId);
 
 // For TSDB file sync
-int tsdbSyncSend(void *pRepo, SOCKET socketFd);
-int tsdbSyncRecv(void *pRepo, SOCKET socketFd);
+int tsdbSyncSend(void *pRepo, SOCKET socketFd, SOCKET *streamFds, int32_t numOfStreams);
+int tsdbSyncRecv(void *pRepo, SOCKET socketFd, SOCKET *streamFds, int32_t *numOfStreams);
 
 // For TSDB Compact
 int tsdbCompact(STsdbRepo *pRepo);
 
+// For TSDB Migrate, move at most one aged file set to its storage tier in background. Return 1 if a migration is
+// scheduled, 0 if nothing is to be moved, -1 on error.
+int tsdbMigrate(STsdbRepo *pRepo);
+
 // For TSDB Health Monitor
 
 // no problem return true
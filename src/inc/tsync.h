@@ -21,6 +21,7 @@ extern "C" {
 #endif
 
 #define TAOS_SYNC_MAX_REPLICA 5
+#define TAOS_SYNC_MAX_STREAMS 16  // extra connections to transfer data files in parallel
 #define TAOS_SYNC_MAX_INDEX   0x7FFFFFFF
 
 typedef enum {
@@ -79,8 +80,10 @@ typedef void     (*FStopSyncFile)(int32_t vgId, uint64_t fversion);
 // get file version
 typedef int32_t  (*FGetVersion)(int32_t vgId, uint64_t *fver, uint64_t *vver);
 
-typedef int32_t  (*FSendFile)(void *tsdb, SOCKET socketFd);
-typedef int32_t  (*FRecvFile)(void *tsdb, SOCKET socketFd);
+// data files may be transferred over extra stream connections besides socketFd, numOfStreams of receiver is updated
+// by sync module while streams of sender are connected
+typedef int32_t  (*FSendFile)(void *tsdb, SOCKET socketFd, SOCKET *streamFds, int32_t numOfStreams);
+typedef int32_t  (*FRecvFile)(void *tsdb, SOCKET socketFd, SOCKET *streamFds, int32_t *numOfStreams);
 
 typedef struct {
   int32_t  vgId;       // vgroup ID
@@ -98,6 +101,7 @@ typedef struct {
   FGetVersion       getVersionFp;
   FSendFile         sendFileFp;
   FRecvFile         recvFileFp;
+  int8_t            batchFwds;  // coalesce forwards and acks until syncFlushForwards is called
 } SSyncInfo;
 
 typedef void *tsync_h;
@@ -110,6 +114,7 @@ void    syncStop(int64_t rid);
 int32_t syncReconfig(int64_t rid, const SSyncCfg *);
 int32_t syncForwardToPeer(int64_t rid, void *pHead, void *mhandle, int32_t qtype, bool force);
 void    syncConfirmForward(int64_t rid, uint64_t version, int32_t code, bool force);
+void    syncFlushForwards(int64_t rid);
 void    syncRecover(int64_t rid);  // recover from other nodes:
 int32_t syncGetNodesRole(int64_t rid, SNodesRole *);
 
@@ -52,6 +52,20 @@ typedef struct {
   SWalHead walHead;
 } SVWriteMsg;
 
+typedef struct {
+  int32_t vgId;
+  int32_t queuedMsgs;
+  int32_t retryAfter;    // ms, suggested delay for clients, 0 if no backpressure
+  int32_t flowctrlLevel;
+  int64_t queuedBytes;
+  int64_t allowedBytes;
+  int64_t fillRate;      // bytes per second
+  int64_t drainRate;     // bytes per second
+  int64_t commitRate;    // bytes per second
+  int64_t memHeadroom;
+  int64_t throttledMsgs;
+} SVnodeFlowCtrlStat;
+
 // vnodeStatus
 extern char *vnodeStatus[];
 
@@ -80,8 +94,12 @@ int32_t vnodeWriteToWQueue(void *pVnode, void *pHead, int32_t qtype, void *pRpcM
 void    vnodeFreeFromWQueue(void *pVnode, SVWriteMsg *pWrite);
 int32_t vnodeProcessWrite(void *pVnode, void *pHead, int32_t qtype, void *pRspRet);
 
+// vnodeFlowCtrl
+int32_t vnodeGetFlowCtrlStat(int32_t vgId, SVnodeFlowCtrlStat *pStat);
+
 // vnodeSync
 void    vnodeConfirmForward(void *pVnode, uint64_t version, int32_t code, bool force);
+void    vnodeFlushForwards(void *pVnode);
 
 // vnodeRead
 int32_t vnodeWriteToRQueue(void *pVnode, void *pCont, int32_t contLen, int8_t qtype, void *rparam);
@@ -25,6 +25,8 @@
 #include "tsclient.h"
 #include "tsdb.h"
 #include "tutil.h"
+#include "hash.h"
+#include "tscompression.h"
 #include <taos.h>
 
 #define TSDB_SUPPORT_NANOSECOND 1
@@ -34,6 +36,25 @@
 #define MAX_RECORDS_PER_REQ     32766
 //#define DEFAULT_DUMP_FILE "taosdump.sql"
 
+/*
+ * Binary dump file, one for each dump out worker, in host byte order:
+ *   head  : magic "TDDP", int16 version, int8 compression, int8 reserved, int16 dbNameLen, dbName
+ *   table : int16 nameLen (> 0), name, int32 numOfCols, numOfCols x [int8 type, int8 reserved, int16 bytes]
+ *           blocks of int32 numOfRows (> 0), numOfCols x [int32 rawLen, int32 compLen, compressed column]
+ *           int32 0 ends the table
+ *   tail  : int16 0
+ * Fixed length columns are kept as the server returns them, null values included. Binary and nchar
+ * columns are packed as numOfRows x [int16 len, data] before compression, len -1 for null.
+ */
+#define BINARY_DUMP_MAGIC       "TDDP"
+#define BINARY_DUMP_MAGIC_LEN   4
+#define BINARY_DUMP_VERSION     1
+#define BINARY_DUMP_FILE_EXT    "tdump"
+#define BINARY_DUMP_TABLE_ABORT (-1)    // rows of a block, the table failed to be dumped after the blocks before it
+#define BINARY_DUMP_FILE_BROKEN (-2)    // returned when the binary dump file itself can not be written
+#define BINARY_META_BATCH       1000    // tables whose vgroups are loaded in one request
+#define BINARY_ROWS_PER_SUBMIT  16384   // rows bound to the stmt before it is executed
+
 // for strncpy buffer overflow
 #define min(a, b) (((a) < (b)) ? (a) : (b))
 
@@ -244,6 +265,7 @@ static struct argp_option options[] = {
     {"schemaonly", 's', 0, 0,  "Only dump schema.", 2},
     {"without-property", 'N', 0, 0,  "Dump schema without properties.", 2},
     {"avro", 'v', 0, 0,  "Dump apache avro format data file. By default, dump sql command sequence.", 2},
+    {"binary", 'b', 0, 0,  "Dump compressed column blocks with one thread per vgroup, and restore them through stmt. By default, dump sql command sequence.", 2},
     {"start-time",    'S', "START_TIME",  0,  "Start time to dump. Either epoch or ISO8601/RFC3339 format is acceptable. ISO8601 format example: 2017-10-01T00:00:00.000+0800 or 2017-10-0100:00:00:000+0800 or '2017-10-01 00:00:00.000+0800'",  4},
     {"end-time",      'E', "END_TIME",    0,  "End time to dump. Either epoch or ISO8601/RFC3339 format is acceptable. ISO8601 format example: 2017-10-01T00:00:00.000+0800 or 2017-10-0100:00:00.000+0800 or '2017-10-01 00:00:00.000+0800'",  5},
 #if TSDB_SUPPORT_NANOSECOND == 1
@@ -280,6 +302,7 @@ typedef struct arguments {
     bool     schemaonly;
     bool     with_property;
     bool     avro;
+    bool     binary;
     int64_t  start_time;
     int64_t  end_time;
     char     precision[8];
@@ -318,13 +341,16 @@ static void taosDumpCreateTableClause(STableDef *tableDes, int numOfCols,
 static void taosDumpCreateMTableClause(STableDef *tableDes, char *metric,
         int numOfCols, FILE *fp, char* dbName);
 static int32_t taosDumpTable(char *tbName, char *metric,
-        FILE *fp, TAOS* taosCon, char* dbName);
-static int taosDumpTableData(FILE *fp, char *tbName,
+        FILE *fp, FILE *binFp, TAOS* taosCon, char* dbName);
+static int taosDumpTableData(FILE *fp, FILE *binFp, char *tbName,
         TAOS* taosCon, char* dbName,
         char *jsonAvroSchema);
 static int taosCheckParam(struct arguments *arguments);
 static void taosFreeDbInfos();
 static void taosStartDumpOutWorkThreads(int32_t numOfThread, char *dbName);
+static int taosWriteBinaryHead(FILE *fp, char *dbName);
+static int taosWriteBinaryTail(FILE *fp);
+static int64_t writeResultToBinary(TAOS_RES *res, FILE *fp, char *tbName);
 
 struct arguments g_args = {
     // connection option
@@ -349,6 +375,7 @@ struct arguments g_args = {
     false,      // schemeonly
     true,       // with_property
     false,      // avro format
+    false,      // binary format
     -INT64_MAX, // start_time
     INT64_MAX,  // end_time
     "ms",       // precision
@@ -470,6 +497,9 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
         case 'v':
             g_args.avro = true;
             break;
+        case 'b':
+            g_args.binary = true;
+            break;
         case 'S':
             // parse time here.
             g_args.start_time = atol(arg);
@@ -713,6 +743,7 @@ int main(int argc, char *argv[]) {
         printf("schemaonly: %s\n", g_args.schemaonly?"true":"false");
         printf("with_property: %s\n", g_args.with_property?"true":"false");
         printf("avro format: %s\n", g_args.avro?"true":"false");
+        printf("binary format: %s\n", g_args.binary?"true":"false");
         printf("start_time: %" PRId64 "\n", g_args.start_time);
         printf("end_time: %" PRId64 "\n", g_args.end_time);
         printf("precision: %s\n", g_args.precision);
@@ -758,6 +789,7 @@ int main(int argc, char *argv[]) {
         fprintf(g_fpOfResult, "schemaonly: %s\n", g_args.schemaonly?"true":"false");
         fprintf(g_fpOfResult, "with_property: %s\n", g_args.with_property?"true":"false");
         fprintf(g_fpOfResult, "avro format: %s\n", g_args.avro?"true":"false");
+        fprintf(g_fpOfResult, "binary format: %s\n", g_args.binary?"true":"false");
         fprintf(g_fpOfResult, "start_time: %" PRId64 "\n", g_args.start_time);
         fprintf(g_fpOfResult, "end_time: %" PRId64 "\n", g_args.end_time);
         fprintf(g_fpOfResult, "precision: %s\n", g_args.precision);
@@ -1453,7 +1485,7 @@ static int convertSchemaToAvroSchema(STableDef *stableDes, char **avroSchema)
 
 static int32_t taosDumpTable(
         char *tbName, char *metric,
-        FILE *fp, TAOS* taosCon, char* dbName) {
+        FILE *fp, FILE *binFp, TAOS* taosCon, char* dbName) {
     int count = 0;
 
     STableDef *tableDes = (STableDef *)calloc(1, sizeof(STableDef)
@@ -1504,7 +1536,7 @@ static int32_t taosDumpTable(
 
     int32_t ret = 0;
     if (!g_args.schemaonly) {
-        ret = taosDumpTableData(fp, tbName, taosCon, dbName,
+        ret = taosDumpTableData(fp, binFp, tbName, taosCon, dbName,
             jsonAvroSchema);
     }
 
@@ -1569,6 +1601,30 @@ static void* taosDumpOutWorkThreadFp(void *arg)
         return NULL;
     }
 
+    // table schemas still go to the sql file, which is restored before the data
+    FILE *binFp = NULL;
+    if (g_args.binary) {
+        memset(tmpBuf, 0, 4096);
+        if (g_args.outpath[0] != 0) {
+            sprintf(tmpBuf, "%s/%s.tables.%d.%s",
+                    g_args.outpath, pThread->dbName, pThread->threadIndex,
+                    BINARY_DUMP_FILE_EXT);
+        } else {
+            sprintf(tmpBuf, "%s.tables.%d.%s",
+                    pThread->dbName, pThread->threadIndex, BINARY_DUMP_FILE_EXT);
+        }
+
+        binFp = fopen(tmpBuf, "w");
+        if (binFp == NULL || taosWriteBinaryHead(binFp, pThread->dbName) != 0) {
+            errorPrint("%s() LN%d, failed to open file %s\n",
+                    __func__, __LINE__, tmpBuf);
+            if (binFp != NULL) fclose(binFp);
+            fclose(fp);
+            close(fd);
+            return NULL;
+        }
+    }
+
     memset(tmpBuf, 0, 4096);
     sprintf(tmpBuf, "use %s", pThread->dbName);
 
@@ -1578,6 +1634,7 @@ static void* taosDumpOutWorkThreadFp(void *arg)
         errorPrint("%s() LN%d, invalid database %s. reason: %s\n",
                 __func__, __LINE__, pThread->dbName, taos_errstr(tmpResult));
         taos_free_result(tmpResult);
+        if (binFp != NULL) fclose(binFp);
         fclose(fp);
         close(fd);
         return NULL;
@@ -1595,8 +1652,18 @@ static void* taosDumpOutWorkThreadFp(void *arg)
 
         int ret = taosDumpTable(
                 tableRecord.name, tableRecord.metric,
-                fp, pThread->taosCon, pThread->dbName);
-        if (ret >= 0) {
+                fp, binFp, pThread->taosCon, pThread->dbName);
+        if (ret == BINARY_DUMP_FILE_BROKEN) {
+            // the tables left can not be dumped into the file, and it is not ended, so restore rejects it
+            errorPrint("%s() LN%d, failed to dump %s into binary file, the file of thread %d is abandoned\n",
+                    __func__, __LINE__, tableRecord.name, pThread->threadIndex);
+            fclose(binFp);
+            binFp = NULL;
+            break;
+        } else if (ret < 0) {
+            errorPrint("%s() LN%d, failed to dump table %s\n",
+                    __func__, __LINE__, tableRecord.name);
+        } else {
             // TODO: sum table count and table rows by self
             pThread->tablesOfDumpOut++;
             pThread->rowsOfDumpOut += ret;
@@ -1640,6 +1707,10 @@ static void* taosDumpOutWorkThreadFp(void *arg)
     taos_free_result(tmpResult);
     close(fd);
     fclose(fp);
+    if (binFp != NULL) {
+        taosWriteBinaryTail(binFp);
+        fclose(binFp);
+    }
 
     return NULL;
 }
@@ -1795,6 +1866,99 @@ static int32_t taosDumpCreateSuperTableClause(TAOS* taosCon, char* dbName, FILE
 }
 
 
+// vgroup of a table whose meta is loaded into the client cache by taos_load_table_info,
+// both STableMeta and CChildTableMeta start with the vgId
+static int32_t taosGetTableVgId(TAOS *taosCon, char *dbName, char *tbName)
+{
+    char key[TSDB_TABLE_FNAME_LEN + TSDB_ACCT_ID_LEN] = {0};
+    int  len = snprintf(key, sizeof(key), "%s.%s.%s",
+            ((STscObj *)taosCon)->acctId, dbName, tbName);
+
+    int32_t *pVgId = taosHashGet(tscTableMetaMap, key, len);
+    return (pVgId == NULL) ? -1 : *pVgId;
+}
+
+/*
+ * Split the tables listed in fd into .tables.tmp.<n>, one file for each vgroup, so that every
+ * dump out thread reads from a single vnode. numOfVgroups is set to the number of files created.
+ */
+static int taosSaveTablesOfVgroupToTempFiles(TAOS *taosCon, char *dbName,
+        int fd, int32_t *numOfVgroups)
+{
+    STableRecord *records = calloc(BINARY_META_BATCH, sizeof(STableRecord));
+    char *nameList = calloc(BINARY_META_BATCH, TSDB_DB_NAME_LEN + TSDB_TABLE_NAME_LEN + 2);
+    SHashObj *vgFds = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT),
+            false, HASH_NO_LOCK);
+    int ret = 0;
+    char tmpBuf[MAX_FILE_NAME_LEN];
+
+    if (records == NULL || nameList == NULL || vgFds == NULL) {
+        errorPrint("%s() LN%d, memory allocation failed\n", __func__, __LINE__);
+        ret = -1;
+        goto _exit;
+    }
+
+    while (1) {
+        ssize_t readLen = read(fd, records, BINARY_META_BATCH * sizeof(STableRecord));
+        int32_t num = (int32_t)(readLen / (ssize_t)sizeof(STableRecord));
+        if (num <= 0) break;
+
+        char *pstr = nameList;
+        for (int32_t i = 0; i < num; i++) {
+            pstr += sprintf(pstr, "%s%s.%s", (i == 0) ? "" : ",",
+                    dbName, records[i].name);
+        }
+
+        int32_t code = taos_load_table_info(taosCon, nameList);
+        if (code != 0) {
+            errorPrint("%s() LN%d, failed to load table meta of %s, reason: %s\n",
+                    __func__, __LINE__, dbName, tstrerror(code));
+        }
+
+        for (int32_t i = 0; i < num; i++) {
+            // tables whose vgroup is unknown are put together under vgId -1
+            int32_t vgId = taosGetTableVgId(taosCon, dbName, records[i].name);
+            int    *pFd = taosHashGet(vgFds, &vgId, sizeof(vgId));
+            int     subFd;
+
+            if (pFd == NULL) {
+                sprintf(tmpBuf, ".tables.tmp.%d", *numOfVgroups);
+                subFd = open(tmpBuf, O_RDWR | O_CREAT | O_TRUNC,
+                        S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH);
+                if (subFd == -1) {
+                    errorPrint("%s() LN%d, failed to open temp file: %s\n",
+                            __func__, __LINE__, tmpBuf);
+                    ret = -1;
+                    goto _exit;
+                }
+                taosHashPut(vgFds, &vgId, sizeof(vgId), &subFd, sizeof(subFd));
+                debugPrint("vgroup %d of %s dumped by thread %d\n",
+                        vgId, dbName, *numOfVgroups);
+                (*numOfVgroups)++;
+            } else {
+                subFd = *pFd;
+            }
+
+            taosWrite(subFd, &records[i], sizeof(STableRecord));
+        }
+    }
+
+    fprintf(g_fpOfResult, "# vgroup counter:                    %d\n", *numOfVgroups);
+
+_exit:
+    if (vgFds != NULL) {
+        int *pFd = taosHashIterate(vgFds, NULL);
+        while (pFd != NULL) {
+            close(*pFd);
+            pFd = taosHashIterate(vgFds, pFd);
+        }
+        taosHashCleanup(vgFds);
+    }
+    free(nameList);
+    free(records);
+    return ret;
+}
+
 static int taosDumpDb(SDbInfo *dbInfo, FILE *fp, TAOS *taosCon) {
     TAOS_ROW row;
     int fd = -1;
@@ -1853,6 +2017,23 @@ static int taosDumpDb(SDbInfo *dbInfo, FILE *fp, TAOS *taosCon) {
     taos_free_result(res);
     lseek(fd, 0, SEEK_SET);
 
+    int32_t  numOfThread = 0;
+    if (g_args.binary) {
+        int ret = taosSaveTablesOfVgroupToTempFiles(taosCon, dbInfo->name,
+                fd, &numOfThread);
+        close(fd);
+        (void)remove(".show-tables.tmp");
+
+        if (ret == 0) {
+            taosStartDumpOutWorkThreads(numOfThread, dbInfo->name);
+        }
+        for (int loopCnt = 0; loopCnt < numOfThread; loopCnt++) {
+            sprintf(tmpBuf, ".tables.tmp.%d", loopCnt);
+            (void)remove(tmpBuf);
+        }
+        return ret;
+    }
+
     int maxThreads = g_args.thread_num;
     int tableOfPerFile ;
     if (numOfTable <= g_args.thread_num) {
@@ -1873,7 +2054,6 @@ static int taosDumpDb(SDbInfo *dbInfo, FILE *fp, TAOS *taosCon) {
         return -1;
     }
 
-    int32_t  numOfThread = 0;
     int      subFd = -1;
     for (numOfThread = 0; numOfThread < maxThreads; numOfThread++) {
         memset(tmpBuf, 0, MAX_FILE_NAME_LEN);
@@ -2189,7 +2369,182 @@ static int64_t writeResultToSql(TAOS_RES *res, FILE *fp, char *dbName, char *tbN
     return 0;
 }
 
-static int taosDumpTableData(FILE *fp, char *tbName,
+static int taosBinaryWrite(FILE *fp, const void *buf, size_t len)
+{
+    if (len > 0 && fwrite(buf, 1, len, fp) != len) {
+        errorPrint("%s() LN%d, failed to write binary dump file, reason: %s\n",
+                __func__, __LINE__, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int taosBinaryRead(FILE *fp, void *buf, size_t len)
+{
+    if (len > 0 && fread(buf, 1, len, fp) != len) {
+        errorPrint("%s() LN%d, binary dump file is truncated\n",
+                __func__, __LINE__);
+        return -1;
+    }
+    return 0;
+}
+
+// bytes of one value in a fetched block, var types include the length header
+static int32_t taosBinaryColBytes(TAOS_FIELD *field)
+{
+    if (field->type == TSDB_DATA_TYPE_BINARY) {
+        return field->bytes + VARSTR_HEADER_SIZE;
+    } else if (field->type == TSDB_DATA_TYPE_NCHAR) {
+        return field->bytes * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE;
+    }
+    return field->bytes;
+}
+
+static int taosWriteBinaryHead(FILE *fp, char *dbName)
+{
+    int16_t fileVersion = BINARY_DUMP_VERSION;
+    int8_t  compression = ONE_STAGE_COMP;
+    int8_t  reserved = 0;
+    int16_t dbNameLen = (int16_t)strlen(dbName);
+
+    if (taosBinaryWrite(fp, BINARY_DUMP_MAGIC, BINARY_DUMP_MAGIC_LEN)
+            || taosBinaryWrite(fp, &fileVersion, sizeof(fileVersion))
+            || taosBinaryWrite(fp, &compression, sizeof(compression))
+            || taosBinaryWrite(fp, &reserved, sizeof(reserved))
+            || taosBinaryWrite(fp, &dbNameLen, sizeof(dbNameLen))
+            || taosBinaryWrite(fp, dbName, dbNameLen)) {
+        return -1;
+    }
+    return 0;
+}
+
+static int taosWriteBinaryTail(FILE *fp)
+{
+    int16_t nameLen = 0;
+    return taosBinaryWrite(fp, &nameLen, sizeof(nameLen));
+}
+
+static int64_t writeResultToBinary(TAOS_RES *res, FILE *fp, char *tbName)
+{
+    int64_t totalRows = 0;
+    int64_t lastRowsPrint = 5000000;
+
+    int32_t numFields = taos_field_count(res);
+    assert(numFields > 0);
+    TAOS_FIELD *fields = taos_fetch_fields(res);
+
+    int16_t nameLen = (int16_t)strlen(tbName);
+    int32_t maxBytes = 0;
+    if (taosBinaryWrite(fp, &nameLen, sizeof(nameLen))
+            || taosBinaryWrite(fp, tbName, nameLen)
+            || taosBinaryWrite(fp, &numFields, sizeof(numFields))) {
+        return BINARY_DUMP_FILE_BROKEN;
+    }
+
+    for (int32_t col = 0; col < numFields; col++) {
+        int8_t  type = fields[col].type;
+        int8_t  reserved = 0;
+        int16_t bytes = (int16_t)taosBinaryColBytes(&fields[col]);
+        if (taosBinaryWrite(fp, &type, sizeof(type))
+                || taosBinaryWrite(fp, &reserved, sizeof(reserved))
+                || taosBinaryWrite(fp, &bytes, sizeof(bytes))) {
+            return BINARY_DUMP_FILE_BROKEN;
+        }
+        maxBytes = MAX(maxBytes, bytes);
+    }
+
+    char    *packBuf = NULL;
+    char    *compBuf = NULL;
+    int64_t  bufLen = 0;
+    TAOS_ROW block = NULL;
+    int32_t  rows = 0;
+
+    while ((rows = taos_fetch_block(res, &block)) > 0) {
+        // buffers are allocated before the block is written, so a block is either complete or not started
+        int64_t size = (int64_t)rows * (maxBytes + sizeof(int16_t)) + COMP_OVERFLOW_BYTES;
+        if (size > bufLen) {
+            char *p1 = realloc(packBuf, size);
+            if (p1 != NULL) packBuf = p1;
+            char *p2 = realloc(compBuf, size);
+            if (p2 != NULL) compBuf = p2;
+            if (p1 == NULL || p2 == NULL) {
+                errorPrint("%s() LN%d, failed to allocate %"PRId64" memory\n",
+                        __func__, __LINE__, size);
+                goto _abort;
+            }
+            bufLen = size;
+        }
+
+        if (taosBinaryWrite(fp, &rows, sizeof(rows))) goto _broken;
+
+        for (int32_t col = 0; col < numFields; col++) {
+            int32_t bytes = taosBinaryColBytes(&fields[col]);
+            char   *pData = (char *)block[col];
+            int32_t rawLen = 0;
+            int32_t compLen = 0;
+
+            if (IS_VAR_DATA_TYPE(fields[col].type)) {
+                for (int32_t k = 0; k < rows; k++) {
+                    char   *p = pData + (int64_t)k * bytes;
+                    int16_t len = isNull(p, fields[col].type) ? -1 : (int16_t)varDataLen(p);
+                    memcpy(packBuf + rawLen, &len, sizeof(len));
+                    rawLen += sizeof(len);
+                    if (len > 0) {
+                        memcpy(packBuf + rawLen, varDataVal(p), len);
+                        rawLen += len;
+                    }
+                }
+                compLen = tsCompressString(packBuf, rawLen, rows, compBuf, (int32_t)bufLen,
+                        ONE_STAGE_COMP, NULL, 0);
+            } else {
+                rawLen = rows * bytes;
+                compLen = (*(tDataTypes[fields[col].type].compFunc))(pData, rawLen, rows, compBuf,
+                        (int32_t)bufLen, ONE_STAGE_COMP, NULL, 0);
+            }
+
+            if (taosBinaryWrite(fp, &rawLen, sizeof(rawLen))
+                    || taosBinaryWrite(fp, &compLen, sizeof(compLen))
+                    || taosBinaryWrite(fp, compBuf, compLen)) {
+                goto _broken;
+            }
+        }
+
+        totalRows += rows;
+        if (totalRows >= lastRowsPrint) {
+            printf(" %"PRId64 " rows already be dumpout from %s\n",
+                    totalRows, tbName);
+            lastRowsPrint += 5000000;
+        }
+    }
+
+    if (taos_errno(res) != 0) {
+        errorPrint("%s() LN%d, failed to fetch %s, reason: %s\n",
+                __func__, __LINE__, tbName, taos_errstr(res));
+        goto _abort;
+    }
+
+    rows = 0;
+    if (taosBinaryWrite(fp, &rows, sizeof(rows))) goto _broken;
+
+    atomic_add_fetch_64(&g_totalDumpOutRows, totalRows);
+    free(packBuf);
+    free(compBuf);
+    return totalRows;
+
+_abort:
+    // the blocks written are kept, the marker tells restore that the table is not complete
+    free(packBuf);
+    free(compBuf);
+    rows = BINARY_DUMP_TABLE_ABORT;
+    return taosBinaryWrite(fp, &rows, sizeof(rows)) ? BINARY_DUMP_FILE_BROKEN : -1;
+
+_broken:
+    free(packBuf);
+    free(compBuf);
+    return BINARY_DUMP_FILE_BROKEN;
+}
+
+static int taosDumpTableData(FILE *fp, FILE *binFp, char *tbName,
         TAOS* taosCon, char* dbName,
         char *jsonAvroSchema) {
     int64_t    totalRows     = 0;
@@ -2211,6 +2566,8 @@ static int taosDumpTableData(FILE *fp, char *tbName,
     if (g_args.avro) {
         writeSchemaToAvro(jsonAvroSchema);
         totalRows = writeResultToAvro(res);
+    } else if (g_args.binary) {
+        totalRows = writeResultToBinary(res, binFp, tbName);
     } else {
         totalRows = writeResultToSql(res, fp, dbName, tbName);
     }
@@ -2225,6 +2582,11 @@ static int taosCheckParam(struct arguments *arguments) {
         return -1;
     }
 
+    if (g_args.avro && g_args.binary) {
+        fprintf(stderr, "conflict option --avro and --binary\n");
+        return -1;
+    }
+
     if (g_args.start_time > g_args.end_time) {
         fprintf(stderr, "start time is larger than end time\n");
         return -1;
@@ -2417,6 +2779,9 @@ static char    **g_tsDumpInSqlFiles   = NULL;
 static int32_t   g_tsSqlFileNum = 0;
 static char      g_tsDbSqlFile[MAX_FILE_NAME_LEN] = {0};
 static char      g_tsCharset[64] = {0};
+static char    **g_tsDumpInBinFiles   = NULL;
+static int32_t   g_tsBinFileNum = 0;
+static int64_t   g_totalDumpInRows = 0;
 
 static int taosGetFilesNum(const char *directoryName,
         const char *prefix, const char *prefix2)
@@ -2506,6 +2871,19 @@ static void taosCheckDatabasesSQLFile(const char *directoryName)
     pclose(fp);
 }
 
+static void taosGetBinaryFileList(char *inputDir)
+{
+    g_tsBinFileNum = taosGetFilesNum(inputDir, BINARY_DUMP_FILE_EXT, NULL);
+    g_tsDumpInBinFiles = (char**)calloc(g_tsBinFileNum, sizeof(char*));
+    for (int i = 0; i < g_tsBinFileNum; i++) {
+        g_tsDumpInBinFiles[i] = calloc(1, MAX_FILE_NAME_LEN);
+    }
+    taosParseDirectory(inputDir, BINARY_DUMP_FILE_EXT, NULL,
+            g_tsDumpInBinFiles, g_tsBinFileNum);
+    fprintf(stdout, "\nstart to restore %d binary files in %s\n",
+            g_tsBinFileNum, inputDir);
+}
+
 static void taosMallocDumpFiles()
 {
     g_tsDumpInSqlFiles = (char**)calloc(g_tsSqlFileNum, sizeof(char*));
@@ -2520,6 +2898,11 @@ static void taosFreeDumpFiles()
         tfree(g_tsDumpInSqlFiles[i]);
     }
     tfree(g_tsDumpInSqlFiles);
+
+    for (int i = 0; i < g_tsBinFileNum; i++) {
+        tfree(g_tsDumpInBinFiles[i]);
+    }
+    tfree(g_tsDumpInBinFiles);
 }
 
 static void taosGetDirectoryFileList(char *inputDir)
@@ -2639,6 +3022,327 @@ static int taosDumpInOneFile(TAOS* taos, FILE* fp, char* fcharset,
     return 0;
 }
 
+typedef struct {
+    int8_t   type;
+    int16_t  bytes;
+    char    *data;      // decompressed column
+    int32_t *length;
+    char    *isNull;
+} SBinaryColumn;
+
+static int taosExecuteBinaryStmt(TAOS_STMT *stmt, char *fileName, int64_t *pending)
+{
+    if (*pending == 0) return 0;
+
+    *pending = 0;
+    if (taos_stmt_execute(stmt) != 0) {
+        errorPrint("%s() LN%d, failed to restore data from %s, reason: %s\n",
+                __func__, __LINE__, fileName, taos_stmt_errstr(stmt));
+        fprintf(g_fpOfResult, "error binary data: file:%s, reason: %s\n",
+                fileName, taos_stmt_errstr(stmt));
+        return -1;
+    }
+    return 0;
+}
+
+// decode one column of a block into the stmt bind layout: fixed values in place, var data at stride bytes
+static int taosDecodeBinaryColumn(FILE *fp, SBinaryColumn *pCol, int32_t rows,
+        char **compBuf, int32_t *compBufLen, char **packBuf, int32_t *packBufLen)
+{
+    int32_t rawLen = 0;
+    int32_t compLen = 0;
+    if (taosBinaryRead(fp, &rawLen, sizeof(rawLen))
+            || taosBinaryRead(fp, &compLen, sizeof(compLen))) {
+        return -1;
+    }
+
+    if (compLen > *compBufLen) {
+        char *p = realloc(*compBuf, compLen);
+        if (p == NULL) return -1;
+        *compBuf = p;
+        *compBufLen = compLen;
+    }
+    if (rawLen + COMP_OVERFLOW_BYTES > *packBufLen) {
+        char *p = realloc(*packBuf, rawLen + COMP_OVERFLOW_BYTES);
+        if (p == NULL) return -1;
+        *packBuf = p;
+        *packBufLen = rawLen + COMP_OVERFLOW_BYTES;
+    }
+
+    if (taosBinaryRead(fp, *compBuf, compLen)) return -1;
+
+    if (!IS_VAR_DATA_TYPE(pCol->type)) {
+        if (rawLen != rows * pCol->bytes) return -1;
+        if ((*(tDataTypes[pCol->type].decompFunc))(*compBuf, compLen, rows, pCol->data,
+                    rawLen, ONE_STAGE_COMP, NULL, 0) != rawLen) {
+            return -1;
+        }
+        for (int32_t k = 0; k < rows; k++) {
+            pCol->isNull[k] = isNull(pCol->data + (int64_t)k * pCol->bytes, pCol->type) ? 1 : 0;
+        }
+        return 0;
+    }
+
+    if (tsDecompressString(*compBuf, compLen, rows, *packBuf, rawLen,
+                ONE_STAGE_COMP, NULL, 0) != rawLen) {
+        return -1;
+    }
+
+    int32_t stride = pCol->bytes - VARSTR_HEADER_SIZE;
+    char   *p = *packBuf;
+    char   *end = *packBuf + rawLen;
+    for (int32_t k = 0; k < rows; k++) {
+        int16_t len;
+        if (p + sizeof(len) > end) return -1;
+        memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+
+        if (len < 0) {
+            pCol->isNull[k] = 1;
+            pCol->length[k] = 0;
+            continue;
+        }
+        if (len > stride || p + len > end) return -1;
+
+        memcpy(pCol->data + (int64_t)k * stride, p, len);
+        pCol->isNull[k] = 0;
+        pCol->length[k] = len;
+        p += len;
+    }
+    return 0;
+}
+
+static void taosFreeBinaryColumns(SBinaryColumn *cols, int32_t numOfCols)
+{
+    for (int32_t i = 0; i < numOfCols; i++) {
+        tfree(cols[i].data);
+        tfree(cols[i].length);
+        tfree(cols[i].isNull);
+    }
+}
+
+/*
+ * Restore one binary dump file. Each column block is bound to the stmt as it is, and rows of
+ * consecutive tables with the same schema are submitted together.
+ */
+static int64_t taosDumpInBinaryOneFile(TAOS *taos, FILE *fp, char *fileName)
+{
+    char     magic[BINARY_DUMP_MAGIC_LEN];
+    int16_t  fileVersion = 0;
+    int8_t   compression = 0;
+    int8_t   reserved = 0;
+    int16_t  dbNameLen = 0;
+    char     dbName[TSDB_DB_NAME_LEN] = {0};
+    int64_t  totalRows = 0;
+    int64_t  lastRowsPrint = 5000000;
+
+    if (taosBinaryRead(fp, magic, sizeof(magic))
+            || memcmp(magic, BINARY_DUMP_MAGIC, BINARY_DUMP_MAGIC_LEN) != 0
+            || taosBinaryRead(fp, &fileVersion, sizeof(fileVersion))
+            || taosBinaryRead(fp, &compression, sizeof(compression))
+            || taosBinaryRead(fp, &reserved, sizeof(reserved))
+            || taosBinaryRead(fp, &dbNameLen, sizeof(dbNameLen))
+            || dbNameLen <= 0 || dbNameLen >= TSDB_DB_NAME_LEN
+            || taosBinaryRead(fp, dbName, dbNameLen)) {
+        errorPrint("%s() LN%d, %s is not a binary dump file\n",
+                __func__, __LINE__, fileName);
+        fclose(fp);
+        return -1;
+    }
+
+    if (fileVersion != BINARY_DUMP_VERSION || compression != ONE_STAGE_COMP) {
+        errorPrint("%s() LN%d, %s has unsupported version:%d compression:%d\n",
+                __func__, __LINE__, fileName, fileVersion, compression);
+        fclose(fp);
+        return -1;
+    }
+
+    TAOS_STMT       *stmt = NULL;
+    SBinaryColumn   *cols = calloc(TSDB_MAX_COLUMNS, sizeof(SBinaryColumn));
+    TAOS_MULTI_BIND *binds = calloc(TSDB_MAX_COLUMNS, sizeof(TAOS_MULTI_BIND));
+    char            *sql = calloc(1, TSDB_MAX_COLUMNS * 2 + 64);
+    int32_t          numOfCols = 0;
+    int32_t          capacity = 0;
+    int64_t          pending = 0;
+    char            *compBuf = NULL;
+    char            *packBuf = NULL;
+    int32_t          compBufLen = 0;
+    int32_t          packBufLen = 0;
+    int64_t          ret = -1;
+
+    if (cols == NULL || binds == NULL || sql == NULL) {
+        errorPrint("%s() LN%d, memory allocation failed\n", __func__, __LINE__);
+        goto _exit;
+    }
+
+    while (1) {
+        int16_t nameLen = 0;
+        char    tbName[TSDB_TABLE_FNAME_LEN] = {0};
+        int32_t cols1 = 0;
+
+        if (taosBinaryRead(fp, &nameLen, sizeof(nameLen))) goto _exit;
+        if (nameLen == 0) break;
+
+        int32_t len = sprintf(tbName, "%s.", dbName);
+        if (nameLen < 0 || len + nameLen >= TSDB_TABLE_FNAME_LEN
+                || taosBinaryRead(fp, tbName + len, nameLen)
+                || taosBinaryRead(fp, &cols1, sizeof(cols1))
+                || cols1 <= 0 || cols1 > TSDB_MAX_COLUMNS) {
+            goto _exit;
+        }
+
+        // the stmt is kept while consecutive tables share the same schema
+        bool sameSchema = (stmt != NULL && cols1 == numOfCols);
+        for (int32_t i = 0; i < cols1; i++) {
+            int8_t  type;
+            int16_t bytes;
+            if (taosBinaryRead(fp, &type, sizeof(type))
+                    || taosBinaryRead(fp, &reserved, sizeof(reserved))
+                    || taosBinaryRead(fp, &bytes, sizeof(bytes))
+                    || type < TSDB_DATA_TYPE_BOOL || type > TSDB_DATA_TYPE_UBIGINT || bytes <= 0) {
+                goto _exit;
+            }
+            if (sameSchema && (cols[i].type != type || cols[i].bytes != bytes)) {
+                sameSchema = false;
+            }
+            if (!sameSchema) {
+                cols[i].type = type;
+                cols[i].bytes = bytes;
+            }
+        }
+
+        if (!sameSchema) {
+            if (stmt != NULL) {
+                if (taosExecuteBinaryStmt(stmt, fileName, &pending)) goto _exit;
+                taos_stmt_close(stmt);
+                stmt = NULL;
+            }
+
+            taosFreeBinaryColumns(cols, numOfCols);
+            numOfCols = cols1;
+            capacity = 0;
+
+            char *pstr = sql + sprintf(sql, "INSERT INTO ? VALUES(");
+            for (int32_t i = 0; i < numOfCols; i++) {
+                pstr += sprintf(pstr, (i == 0) ? "?" : ",?");
+            }
+            sprintf(pstr, ")");
+
+            stmt = taos_stmt_init(taos);
+            if (stmt == NULL || taos_stmt_prepare(stmt, sql, 0) != 0) {
+                errorPrint("%s() LN%d, failed to prepare <%s>, reason: %s\n",
+                        __func__, __LINE__, sql, (stmt == NULL) ? "" : taos_stmt_errstr(stmt));
+                goto _exit;
+            }
+        }
+
+        // the table is set again whenever the stmt was executed in the middle of it
+        bool needTbName = true;
+        while (1) {
+            int32_t rows = 0;
+            if (taosBinaryRead(fp, &rows, sizeof(rows))) goto _exit;
+            if (rows == 0) break;
+            if (rows == BINARY_DUMP_TABLE_ABORT) {
+                errorPrint("%s() LN%d, %s failed to be dumped out, only part of its rows are restored from %s\n",
+                        __func__, __LINE__, tbName, fileName);
+                break;
+            }
+            if (rows < 0) goto _exit;
+
+            if (rows > capacity) {
+                for (int32_t i = 0; i < numOfCols; i++) {
+                    char *data = realloc(cols[i].data, (int64_t)rows * cols[i].bytes);
+                    if (data != NULL) cols[i].data = data;
+                    int32_t *length = realloc(cols[i].length, rows * sizeof(int32_t));
+                    if (length != NULL) cols[i].length = length;
+                    char *isNull = realloc(cols[i].isNull, rows);
+                    if (isNull != NULL) cols[i].isNull = isNull;
+                    if (data == NULL || length == NULL || isNull == NULL) {
+                        errorPrint("%s() LN%d, memory allocation failed\n", __func__, __LINE__);
+                        goto _exit;
+                    }
+                }
+                capacity = rows;
+            }
+
+            for (int32_t i = 0; i < numOfCols; i++) {
+                if (taosDecodeBinaryColumn(fp, &cols[i], rows,
+                            &compBuf, &compBufLen, &packBuf, &packBufLen)) {
+                    errorPrint("%s() LN%d, corrupted block of %s in %s\n",
+                            __func__, __LINE__, tbName, fileName);
+                    goto _exit;
+                }
+            }
+
+            // a block is bound in pieces so that one submit never exceeds BINARY_ROWS_PER_SUBMIT rows
+            for (int32_t start = 0; start < rows; ) {
+                if (needTbName) {
+                    if (taos_stmt_set_tbname(stmt, tbName) != 0) {
+                        errorPrint("%s() LN%d, failed to set table %s, reason: %s\n",
+                                __func__, __LINE__, tbName, taos_stmt_errstr(stmt));
+                        goto _exit;
+                    }
+                    needTbName = false;
+                }
+
+                int32_t num = (int32_t)MIN(rows - start, BINARY_ROWS_PER_SUBMIT - pending);
+
+                for (int32_t i = 0; i < numOfCols; i++) {
+                    bool    isVar = IS_VAR_DATA_TYPE(cols[i].type);
+                    int32_t stride = isVar ? (cols[i].bytes - VARSTR_HEADER_SIZE) : cols[i].bytes;
+
+                    binds[i].buffer_type = cols[i].type;
+                    binds[i].buffer = cols[i].data + (int64_t)start * stride;
+                    binds[i].buffer_length = stride;
+                    binds[i].length = isVar ? (cols[i].length + start) : NULL;
+                    binds[i].is_null = cols[i].isNull + start;
+                    binds[i].num = num;
+                }
+
+                if (taos_stmt_bind_param_batch(stmt, binds) != 0
+                        || taos_stmt_add_batch(stmt) != 0) {
+                    errorPrint("%s() LN%d, failed to bind rows of %s, reason: %s\n",
+                            __func__, __LINE__, tbName, taos_stmt_errstr(stmt));
+                    goto _exit;
+                }
+
+                start += num;
+                pending += num;
+                totalRows += num;
+
+                if (pending >= BINARY_ROWS_PER_SUBMIT) {
+                    if (taosExecuteBinaryStmt(stmt, fileName, &pending)) goto _exit;
+                    needTbName = true;
+                }
+            }
+
+            if (totalRows >= lastRowsPrint) {
+                printf(" %"PRId64 " rows already be restored from file %s\n",
+                        totalRows, fileName);
+                lastRowsPrint += 5000000;
+            }
+        }
+    }
+
+    if (stmt != NULL && taosExecuteBinaryStmt(stmt, fileName, &pending)) goto _exit;
+    ret = totalRows;
+
+_exit:
+    if (ret < 0) {
+        errorPrint("%s() LN%d, failed to restore %s after %"PRId64" rows\n",
+                __func__, __LINE__, fileName, totalRows);
+    }
+    if (stmt != NULL) taos_stmt_close(stmt);
+    if (cols != NULL) taosFreeBinaryColumns(cols, numOfCols);
+    tfree(cols);
+    tfree(binds);
+    tfree(sql);
+    tfree(compBuf);
+    tfree(packBuf);
+    fclose(fp);
+    return ret;
+}
+
 static void* taosDumpInWorkThreadFp(void *arg)
 {
     SThreadParaObj *pThread = (SThreadParaObj*)arg;
@@ -2660,14 +3364,39 @@ static void* taosDumpInWorkThreadFp(void *arg)
     return NULL;
 }
 
-static void taosStartDumpInWorkThreads()
+static void* taosDumpInBinaryWorkThreadFp(void *arg)
+{
+    SThreadParaObj *pThread = (SThreadParaObj*)arg;
+    setThreadName("dumpInBinThrd");
+
+    for (int32_t f = 0; f < g_tsBinFileNum; ++f) {
+        if (f % pThread->totalThreads == pThread->threadIndex) {
+            char *binFileName = g_tsDumpInBinFiles[f];
+            FILE* fp = taosOpenDumpInFile(binFileName);
+            if (NULL == fp) {
+                continue;
+            }
+            fprintf(stderr, ", Success Open input file: %s\n",
+                    binFileName);
+            int64_t rows = taosDumpInBinaryOneFile(pThread->taosCon, fp, binFileName);
+            if (rows > 0) {
+                pThread->rowsOfDumpOut += rows;
+                atomic_add_fetch_64(&g_totalDumpInRows, rows);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void taosStartDumpInWorkThreads(int32_t numOfFiles, void *(*threadFp)(void *))
 {
     pthread_attr_t  thattr;
     SThreadParaObj *pThread;
     int32_t         totalThreads = g_args.thread_num;
 
-    if (totalThreads > g_tsSqlFileNum) {
-        totalThreads = g_tsSqlFileNum;
+    if (totalThreads > numOfFiles) {
+        totalThreads = numOfFiles;
     }
 
     SThreadParaObj *threadObj = (SThreadParaObj *)calloc(
@@ -2692,7 +3421,7 @@ static void taosStartDumpInWorkThreads()
         pthread_attr_setdetachstate(&thattr, PTHREAD_CREATE_JOINABLE);
 
         if (pthread_create(&(pThread->threadID), &thattr,
-                    taosDumpInWorkThreadFp, (void*)pThread) != 0) {
+                    threadFp, (void*)pThread) != 0) {
             errorPrint("%s() LN%d, thread:%d failed to start\n",
                     __func__, __LINE__, pThread->threadIndex);
             exit(0);
@@ -2747,7 +3476,16 @@ static int taosDumpIn() {
     taos_close(taos);
 
     if (0 != tsSqlFileNumOfTbls) {
-        taosStartDumpInWorkThreads();
+        taosStartDumpInWorkThreads(g_tsSqlFileNum, taosDumpInWorkThreadFp);
+    }
+
+    // data of a binary dump is restored once all tables are created by the sql files
+    if (g_args.binary) {
+        taosGetBinaryFileList(g_args.inpath);
+        taosStartDumpInWorkThreads(g_tsBinFileNum, taosDumpInBinaryWorkThreadFp);
+        fprintf(stderr, "dump in rows: %" PRId64 "\n", g_totalDumpInRows);
+        fprintf(g_fpOfResult, "# dump in row counter:               %" PRId64 "\n",
+                g_totalDumpInRows);
     }
 
     taosFreeDumpFiles();
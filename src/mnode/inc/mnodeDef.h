@@ -104,6 +104,7 @@ typedef struct SSTableObj {
   int32_t    numOfTables;
   SSchema *  schema;
   void *     vgHash;
+  void *     childHash;    // names of the child tables
 } SSTableObj;
 
 typedef struct {
@@ -36,6 +36,7 @@
 #include "mnodeSdb.h"
 
 #define SDB_TABLE_LEN 12
+#define SDB_TABLE_LOCKS 64
 #define MAX_QUEUED_MSG_NUM 100000
 
 typedef enum {
@@ -74,7 +75,9 @@ typedef struct SSdbTable {
   int32_t (*fpEncode)(SSdbRow *pRow);
   int32_t (*fpDestroy)(SSdbRow *pRow);
   int32_t (*fpRestored)();
-  pthread_mutex_t mutex;
+  _hash_fn_t hashFp;
+  // rows are striped over the locks by key hash, lookups of different rows do not contend with each other
+  pthread_rwlock_t locks[SDB_TABLE_LOCKS];
 } SSdbTable;
 
 typedef struct {
@@ -507,15 +510,24 @@ void sdbDecRef(void *tparam, void *pRow) {
   }
 }
 
-static void *sdbGetRowMeta(SSdbTable *pTable, void *key) {
-  if (pTable == NULL) return NULL;
-
-  int32_t keySize = sizeof(int32_t);
+static int32_t sdbGetKeySize(SSdbTable *pTable, void *key) {
   if (pTable->keyType == SDB_KEY_STRING || pTable->keyType == SDB_KEY_VAR_STRING) {
-    keySize = (int32_t)strlen((char *)key);
+    return (int32_t)strlen((char *)key);
   }
 
-  void **ppRow = (void **)taosHashGet(pTable->iHandle, key, keySize);
+  return sizeof(int32_t);
+}
+
+static pthread_rwlock_t *sdbGetRowLock(SSdbTable *pTable, void *key, int32_t keySize) {
+  uint32_t hash = (*pTable->hashFp)(key, (uint32_t)keySize);
+  return &pTable->locks[hash & (SDB_TABLE_LOCKS - 1)];
+}
+
+static void *sdbGetRowMeta(SSdbTable *pTable, void *key) {
+  if (pTable == NULL) return NULL;
+
+  int32_t keySize = sdbGetKeySize(pTable, key);
+  void ** ppRow = (void **)taosHashGet(pTable->iHandle, key, keySize);
   if (ppRow != NULL) return *ppRow;
 
   return NULL;
@@ -527,11 +539,13 @@ static void *sdbGetRowMetaFromObj(SSdbTable *pTable, void *key) {
 
 void *sdbGetRow(void *tparam, void *key) {
   SSdbTable *pTable = tparam;
+  if (pTable == NULL) return NULL;
 
-  pthread_mutex_lock(&pTable->mutex);
+  pthread_rwlock_t *pLock = sdbGetRowLock(pTable, key, sdbGetKeySize(pTable, key));
+  pthread_rwlock_rdlock(pLock);
   void *pRow = sdbGetRowMeta(pTable, key);
   if (pRow) sdbIncRef(pTable, pRow);
-  pthread_mutex_unlock(&pTable->mutex);
+  pthread_rwlock_unlock(pLock);
 
   return pRow;
 }
@@ -542,15 +556,12 @@ static void *sdbGetRowFromObj(SSdbTable *pTable, void *key) {
 
 static int32_t sdbInsertHash(SSdbTable *pTable, SSdbRow *pRow) {
   void *  key = sdbGetObjKey(pTable, pRow->pObj);
-  int32_t keySize = sizeof(int32_t);
-
-  if (pTable->keyType == SDB_KEY_STRING || pTable->keyType == SDB_KEY_VAR_STRING) {
-    keySize =  (int32_t)strlen((char *)key);
-  }
+  int32_t keySize = sdbGetKeySize(pTable, key);
 
-  pthread_mutex_lock(&pTable->mutex);
+  pthread_rwlock_t *pLock = sdbGetRowLock(pTable, key, keySize);
+  pthread_rwlock_wrlock(pLock);
   taosHashPut(pTable->iHandle, key, keySize, &pRow->pObj, sizeof(int64_t));
-  pthread_mutex_unlock(&pTable->mutex);
+  pthread_rwlock_unlock(pLock);
 
   sdbIncRef(pTable, pRow->pObj);
   atomic_add_fetch_32(&pTable->numOfRows, 1);
@@ -586,14 +597,12 @@ static int32_t sdbDeleteHash(SSdbTable *pTable, SSdbRow *pRow) {
   (*pTable->fpDelete)(pRow);
   
   void *  key = sdbGetObjKey(pTable, pRow->pObj);
-  int32_t keySize = sizeof(int32_t);
-  if (pTable->keyType == SDB_KEY_STRING || pTable->keyType == SDB_KEY_VAR_STRING) {
-    keySize = (int32_t)strlen((char *)key);
-  }
+  int32_t keySize = sdbGetKeySize(pTable, key);
 
-  pthread_mutex_lock(&pTable->mutex);
+  pthread_rwlock_t *pLock = sdbGetRowLock(pTable, key, keySize);
+  pthread_rwlock_wrlock(pLock);
   taosHashRemove(pTable->iHandle, key, keySize);
-  pthread_mutex_unlock(&pTable->mutex);
+  pthread_rwlock_unlock(pLock);
 
   atomic_sub_fetch_32(&pTable->numOfRows, 1);
 
@@ -878,7 +887,10 @@ int64_t sdbOpenTable(SSdbTableDesc *pDesc) {
   
   if (pTable == NULL) return -1;
 
-  pthread_mutex_init(&pTable->mutex, NULL);
+  for (int32_t i = 0; i < SDB_TABLE_LOCKS; ++i) {
+    pthread_rwlock_init(&pTable->locks[i], NULL);
+  }
+
   tstrncpy(pTable->name, pDesc->name, SDB_TABLE_LEN);
   pTable->keyType      = pDesc->keyType;
   pTable->id           = pDesc->id;
@@ -897,6 +909,7 @@ int64_t sdbOpenTable(SSdbTableDesc *pDesc) {
   if (pTable->keyType == SDB_KEY_STRING || pTable->keyType == SDB_KEY_VAR_STRING) {
     hashFp = taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY);
   }
+  pTable->hashFp = hashFp;
   pTable->iHandle = taosHashInit(pTable->hashSessions, hashFp, true, HASH_ENTRY_LOCK);
 
   tsSdbMgmt.numOfTables++;
@@ -939,7 +952,9 @@ static void sdbCloseTableObj(void *handle) {
   taosHashCancelIterate(pTable->iHandle, pIter);
   taosHashCleanup(pTable->iHandle);
   pTable->iHandle = NULL;
-  pthread_mutex_destroy(&pTable->mutex);
+  for (int32_t i = 0; i < SDB_TABLE_LOCKS; ++i) {
+    pthread_rwlock_destroy(&pTable->locks[i]);
+  }
 
   sdbDebug("vgId:1, sdb:%s, is closed, numOfTables:%d", pTable->name, tsSdbMgmt.numOfTables);
   free(pTable);
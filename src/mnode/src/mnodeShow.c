@@ -352,6 +352,8 @@ static int32_t mnodeProcessConnectMsg(SMnodeMsg *pMsg) {
   memcpy(pConnectRsp->serverVersion, version, TSDB_VERSION_LEN);
   pConnectRsp->writeAuth = pUser->writeAuth;
   pConnectRsp->superAuth = pUser->superAuth;
+  pConnectRsp->features = tsColumnarSubmit ? TSDB_CONN_FEATURE_COLUMNAR_SUBMIT : 0;
+  pConnectRsp->features |= TSDB_CONN_FEATURE_ORDERED_PRJ_LIMIT;
   
   mnodeGetMnodeEpSetForShell(&pConnectRsp->epSet, false);
 
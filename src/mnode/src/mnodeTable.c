@@ -82,6 +82,7 @@ static int32_t mnodeProcessDropChildTableMsg(SMnodeMsg *pMsg);
 static void    mnodeProcessDropChildTableRsp(SRpcMsg *rpcMsg);
 
 static int32_t mnodeProcessSuperTableVgroupMsg(SMnodeMsg *pMsg);
+static int32_t mnodeProcessSuperTableTablesMsg(SMnodeMsg *pMsg);
 static int32_t mnodeProcessMultiTableMetaMsg(SMnodeMsg *pMsg);
 static int32_t mnodeProcessTableCfgMsg(SMnodeMsg *pMsg);
 
@@ -447,11 +448,24 @@ static void mnodeAddTableIntoStable(SSTableObj *pStable, SCTableObj *pCtable) {
              pStable->vgHash, taosHashGetSize(pStable->vgHash));
     }
   }
+
+  if (pStable->childHash == NULL) {
+    pStable->childHash = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_ENTRY_LOCK);
+  }
+
+  if (pStable->childHash != NULL) {
+    taosHashPut(pStable->childHash, pCtable->info.tableId, strlen(pCtable->info.tableId), &pCtable->uid,
+                sizeof(pCtable->uid));
+  }
 }
 
 static void mnodeRemoveTableFromStable(SSTableObj *pStable, SCTableObj *pCtable) {
   atomic_sub_fetch_32(&pStable->numOfTables, 1);
 
+  if (pStable->childHash != NULL) {
+    taosHashRemove(pStable->childHash, pCtable->info.tableId, strlen(pCtable->info.tableId));
+  }
+
   if (pStable->vgHash == NULL) return;
 
   SVgObj *pVgroup = mnodeGetVgroup(pCtable->vgId);
@@ -469,6 +483,10 @@ static void mnodeDestroySuperTable(SSTableObj *pStable) {
     taosHashCleanup(pStable->vgHash);
     pStable->vgHash = NULL;
   }
+  if (pStable->childHash != NULL) {
+    taosHashCleanup(pStable->childHash);
+    pStable->childHash = NULL;
+  }
   tfree(pStable->info.tableId);
   tfree(pStable->schema);
   tfree(pStable);
@@ -518,12 +536,14 @@ static int32_t mnodeSuperTableActionUpdate(SSdbRow *pRow) {
     void *oldTableId = pTable->info.tableId;
     void *oldSchema = pTable->schema;
     void *oldVgHash = pTable->vgHash;
+    void *oldChildHash = pTable->childHash;
     int32_t oldRefCount = pTable->refCount;
     int32_t oldNumOfTables = pTable->numOfTables;
 
     memcpy(pTable, pNew, sizeof(SSTableObj));
 
     pTable->vgHash = oldVgHash;
+    pTable->childHash = oldChildHash;
     pTable->refCount = oldRefCount;
     pTable->schema = pNew->schema;
     pTable->numOfTables = oldNumOfTables;
@@ -652,6 +672,7 @@ int32_t mnodeInitTables() {
   mnodeAddWriteMsgHandle(TSDB_MSG_TYPE_CM_ALTER_TABLE, mnodeProcessAlterTableMsg);
   mnodeAddReadMsgHandle(TSDB_MSG_TYPE_CM_TABLE_META, mnodeProcessTableMetaMsg);
   mnodeAddReadMsgHandle(TSDB_MSG_TYPE_CM_STABLE_VGROUP, mnodeProcessSuperTableVgroupMsg);
+  mnodeAddReadMsgHandle(TSDB_MSG_TYPE_CM_STABLE_TABLES, mnodeProcessSuperTableTablesMsg);
 
   mnodeAddPeerRspHandle(TSDB_MSG_TYPE_MD_CREATE_TABLE_RSP, mnodeProcessCreateChildTableRsp);
   mnodeAddPeerRspHandle(TSDB_MSG_TYPE_MD_DROP_TABLE_RSP, mnodeProcessDropChildTableRsp);
@@ -1937,6 +1958,118 @@ static int32_t mnodeProcessSuperTableVgroupMsg(SMnodeMsg *pMsg) {
   }
 }
 
+// child table to vgroup mappings of a super table, which lets the client fill its meta cache in one request
+static int32_t mnodeProcessSuperTableTablesMsg(SMnodeMsg *pMsg) {
+  if (pMsg->rpcMsg.contLen < sizeof(SSTableTablesMsg)) {
+    return TSDB_CODE_MND_INVALID_MSG_LEN;
+  }
+
+  SSTableTablesMsg *pInfo = pMsg->rpcMsg.pCont;
+  pInfo->tableFname[TSDB_TABLE_FNAME_LEN - 1] = 0;
+  int32_t maxTables = htonl(pInfo->maxTables);
+
+  SSTableObj *pStable = mnodeGetSuperTable(pInfo->tableFname);
+  if (pStable == NULL) {
+    mError("msg:%p, app:%p stable:%s, not exist while get stable tables", pMsg, pMsg->rpcMsg.ahandle,
+           pInfo->tableFname);
+    return TSDB_CODE_MND_INVALID_TABLE_NAME;
+  }
+
+  uint64_t suid = pStable->uid;
+  int32_t  sversion = pStable->sversion;
+  int32_t  tversion = pStable->tversion;
+  int32_t  numOfVgroups = (pStable->vgHash != NULL) ? taosHashGetSize(pStable->vgHash) : 0;
+
+  maxTables = MIN(maxTables, pStable->numOfTables);
+  maxTables = MAX(maxTables, 0);
+
+  int32_t cap = TSDB_TABLE_FNAME_LEN + sizeof(SVgroupsMsg) + (numOfVgroups + 32) * sizeof(SVgroupMsg) +
+                maxTables * (int32_t)(sizeof(SChildTableInfoMsg) + 64);
+  char *raw = malloc(cap);
+  if (raw == NULL) {
+    mnodeDecTableRef(pStable);
+    return TSDB_CODE_MND_OUT_OF_MEMORY;
+  }
+
+  // the reference of pStable is released in serializeVgroupInfo, so acquire one more for the traverse
+  mnodeIncTableRef(pStable);
+  char *  msg = serializeVgroupInfo(pStable, pInfo->tableFname, raw, pMsg, pMsg->rpcMsg.ahandle);
+  int32_t len = (int32_t)(msg - raw);
+
+  // only the child tables of the super table are visited, and no more than maxTables of them
+  int32_t numOfTables = 0;
+  void *  pIter = NULL;
+  while (numOfTables < maxTables && pStable->childHash != NULL) {
+    pIter = taosHashIterate(pStable->childHash, pIter);
+    if (pIter == NULL) break;
+
+    char    tableId[TSDB_TABLE_FNAME_LEN] = {0};
+    int32_t keyLen = MIN((int32_t)taosHashGetDataKeyLen(pStable->childHash, pIter), TSDB_TABLE_FNAME_LEN - 1);
+    memcpy(tableId, taosHashGetDataKey(pStable->childHash, pIter), keyLen);
+
+    SCTableObj *pTable = mnodeGetTable(tableId);
+    if (pTable == NULL) continue;
+
+    if (pTable->info.type == TSDB_CHILD_TABLE && pTable->superTable == pStable) {
+      int16_t nameLen = (int16_t)strnlen(pTable->info.tableId, TSDB_TABLE_FNAME_LEN);
+      if (len + (int32_t)sizeof(SChildTableInfoMsg) + nameLen > cap) {
+        cap = cap * 2 + nameLen;
+        char *tmp = realloc(raw, cap);
+        if (tmp == NULL) {
+          mnodeDecTableRef(pTable);
+          break;
+        }
+        raw = tmp;
+      }
+
+      SChildTableInfoMsg *pChild = (SChildTableInfoMsg *)(raw + len);
+      pChild->vgId = htonl(pTable->vgId);
+      pChild->tid = htonl(pTable->tid);
+      pChild->uid = htobe64(pTable->uid);
+      pChild->nameLen = htons(nameLen);
+      memcpy(pChild->name, pTable->info.tableId, nameLen);
+
+      len += (int32_t)sizeof(SChildTableInfoMsg) + nameLen;
+      numOfTables++;
+    }
+
+    mnodeDecTableRef(pTable);
+  }
+
+  if (pIter != NULL) taosHashCancelIterate(pStable->childHash, pIter);
+  mnodeDecTableRef(pStable);
+
+  SSTableTablesRspMsg *pRsp = rpcMallocCont(sizeof(SSTableTablesRspMsg) + len + 2);
+  if (pRsp == NULL) {
+    free(raw);
+    return TSDB_CODE_MND_OUT_OF_MEMORY;
+  }
+
+  int32_t compLen = tsCompressString(raw, len, 1, pRsp->data, len + 2, ONE_STAGE_COMP, NULL, 0);
+  if (compLen == -1 || compLen >= len) {
+    memcpy(pRsp->data, raw, len);
+    pRsp->compressed = 0;
+    pRsp->contLen = htonl(len);
+  } else {
+    pRsp->compressed = 1;
+    pRsp->contLen = htonl(compLen);
+  }
+
+  pRsp->suid = htobe64(suid);
+  pRsp->sversion = htonl(sversion);
+  pRsp->tversion = htonl(tversion);
+  pRsp->numOfTables = htonl(numOfTables);
+  pRsp->rawLen = htonl(len);
+  free(raw);
+
+  mDebug("msg:%p, app:%p stable:%s, tables:%d vgroups:%d will be returned, rawLen:%d compressed:%d", pMsg,
+         pMsg->rpcMsg.ahandle, pInfo->tableFname, numOfTables, numOfVgroups, len, pRsp->compressed);
+
+  pMsg->rpcRsp.rsp = pRsp;
+  pMsg->rpcRsp.len = (int32_t)sizeof(SSTableTablesRspMsg) + htonl(pRsp->contLen);
+  return TSDB_CODE_SUCCESS;
+}
+
 static void mnodeProcessDropSuperTableRsp(SRpcMsg *rpcMsg) {
   mInfo("drop stable rsp received, result:%s", tstrerror(rpcMsg->code));
 }
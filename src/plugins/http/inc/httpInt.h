@@ -43,6 +43,13 @@
 #define HTTP_PASSWORD_LEN           TSDB_UNI_LEN
 #define HTTP_SESSION_ID_LEN         (TSDB_USER_LEN + HTTP_PASSWORD_LEN)
 
+// EPOLLIN is added to these only while the context is ready to read a new request
+#ifndef _TD_NINGSI_60
+#define HTTP_EPOLL_EVENTS           (EPOLLPRI | EPOLLWAKEUP | EPOLLERR | EPOLLHUP | EPOLLRDHUP)
+#else
+#define HTTP_EPOLL_EVENTS           (EPOLLPRI | EPOLLERR | EPOLLHUP | EPOLLRDHUP)
+#endif
+
 typedef enum HttpReqType {
   HTTP_REQTYPE_OTHERS = 0,
   HTTP_REQTYPE_LOGIN = 1,
@@ -163,6 +170,8 @@ typedef struct HttpContext {
   HttpEncodeMethod *encodeMethod;
   HttpDecodeMethod *decodeMethod;
   struct HttpThread *pThread;
+  int32_t      pipeLen;                  // bytes of the requests pipelined behind the one being handled
+  char         pipeBuf[HTTP_STEP_SIZE];
 } HttpContext;
 
 typedef struct HttpThread {
@@ -171,6 +180,7 @@ typedef struct HttpThread {
   pthread_mutex_t threadMutex;
   bool            stop;
   EpollFd         pollFd;
+  SOCKET          listenFd;  // own listening socket when httpReusePort is on, otherwise -1
   int32_t         numOfContexts;
   int32_t         threadId;
   char            label[HTTP_LABEL_SIZE << 1];
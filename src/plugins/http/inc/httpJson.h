@@ -20,6 +20,7 @@
 #include <stdbool.h>
 
 #define JSON_BUFFER_SIZE 16384
+#define JSON_BUFFER_DUMP_BYTES 32  // bytes of a binary buffer logged in hex
 struct HttpContext;
 
 enum { JsonNumber, JsonString, JsonBoolean, JsonArray, JsonObject, JsonNull };
@@ -40,6 +41,8 @@ typedef struct {
   int32_t size;
   int32_t total;
   char*   lst;
+  char    prev;  // last byte of the chunks already written, used when the buffer is empty
+  int8_t  binary;  // holds a columnar result of httpRestBlock.c instead of json
   char    buf[JSON_BUFFER_SIZE];
   struct  HttpContext* pContext;
 } JsonBuf;
@@ -55,6 +58,7 @@ typedef void (*httpJsonBuilder)(JsonBuf* buf, void* jsnHandle);
 // buffer
 void    httpInitJsonBuf(JsonBuf* buf, struct HttpContext* pContext);
 void    httpWriteJsonBufHead(JsonBuf* buf);
+void    httpWriteBlockBufHead(JsonBuf* buf);
 int32_t httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast);
 void    httpWriteJsonBufEnd(JsonBuf* buf);
 
@@ -19,6 +19,8 @@
 
 #define HTTP_MAX_URL 6  // http url stack size
 
+#define HTTP_BLOCK_CONTENT_TYPE "application/vnd.taos.block"  // columnar binary result, see httpRestBlock.c
+
 #define HTTP_CODE_CONTINUE                 100
 #define HTTP_CODE_SWITCHING_PROTOCOL       101
 #define HTTP_CODE_PROCESSING               102
@@ -157,6 +159,7 @@ typedef struct HttpParser {
   int8_t  httpVersion;
   int8_t  acceptEncodingGzip;
   int8_t  acceptEncodingChunked;
+  int8_t  acceptBlock;
   int8_t  contentLengthSpecified;
   int8_t  contentChunked;
   int8_t  transferGzip;
@@ -178,7 +181,7 @@ void        httpInitParser(HttpParser *parser);
 HttpParser *httpCreateParser(struct HttpContext *pContext);
 void        httpClearParser(HttpParser *parser);
 void        httpDestroyParser(HttpParser *parser);
-int32_t     httpParseBuf(HttpParser *parser, const char *buf, int32_t len);
+int32_t     httpParseBuf(HttpParser *parser, const char *buf, int32_t len, int32_t *parsedLen);
 char *      httpGetStatusDesc(int32_t statusCode);
 
 #endif
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_REST_BLOCK_H
+#define TDENGINE_REST_BLOCK_H
+#include <stdbool.h>
+#include "httpHandle.h"
+#include "httpJson.h"
+#include "taos.h"
+
+#define REST_BLOCK_MAGIC     "TDBK"
+#define REST_BLOCK_MAGIC_LEN 4
+#define REST_BLOCK_VERSION   1
+
+void restBuildSqlAffectRowsBlock(HttpContext *pContext, HttpSqlCmd *cmd, int32_t affect_rows);
+
+void restStartSqlBlock(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result);
+bool restBuildSqlBlock(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result, int32_t numOfRows);
+void restStopSqlBlock(HttpContext *pContext, HttpSqlCmd *cmd);
+
+#endif
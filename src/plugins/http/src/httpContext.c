@@ -106,6 +106,19 @@ const char *httpContextStateStr(HttpContextState state) {
 
 void httpNotifyContextClose(HttpContext *pContext) { shutdown(pContext->fd, SHUT_WR); }
 
+void httpModifyContextEvents(HttpContext *pContext, uint32_t events) {
+  HttpThread *pThread = pContext->pThread;
+  SOCKET      fd = pContext->fd;
+  if (fd < 0 || pThread == NULL) return;
+
+  struct epoll_event event = {0};
+  event.events = HTTP_EPOLL_EVENTS | events;
+  event.data.ptr = pContext;
+  if (epoll_ctl(pThread->pollFd, EPOLL_CTL_MOD, fd, &event) < 0) {
+    httpDebug("context:%p, fd:%d, failed to modify epoll events:%x, error:%s", pContext, fd, events, strerror(errno));
+  }
+}
+
 bool httpAlterContextState(HttpContext *pContext, HttpContextState srcState, HttpContextState destState) {
   return (atomic_val_compare_exchange_32(&pContext->state, srcState, destState) == srcState);
 }
@@ -198,11 +211,15 @@ void httpCloseContextByApp(HttpContext *pContext) {
 
   if (keepAlive) {
     if (httpAlterContextState(pContext, HTTP_CONTEXT_STATE_HANDLING, HTTP_CONTEXT_STATE_READY)) {
-      httpTrace("context:%p, fd:%d, last state:handling, keepAlive:true, reuse context", pContext, pContext->fd);
+      // a pipelined request already read from the socket is picked up through the writable event
+      httpModifyContextEvents(pContext, pContext->pipeLen > 0 ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+      httpTrace("context:%p, fd:%d, last state:handling, keepAlive:true, reuse context, pipeLen:%d", pContext,
+                pContext->fd, pContext->pipeLen);
     } else if (httpAlterContextState(pContext, HTTP_CONTEXT_STATE_DROPPING, HTTP_CONTEXT_STATE_CLOSED)) {
       httpRemoveContextFromEpoll(pContext);
       httpTrace("context:%p, fd:%d, ast state:dropping, keepAlive:true, close connect", pContext, pContext->fd);
     } else if (httpAlterContextState(pContext, HTTP_CONTEXT_STATE_READY, HTTP_CONTEXT_STATE_READY)) {
+      httpModifyContextEvents(pContext, EPOLLIN);
       httpTrace("context:%p, fd:%d, last state:ready, keepAlive:true, reuse context", pContext, pContext->fd);
     } else if (httpAlterContextState(pContext, HTTP_CONTEXT_STATE_CLOSED, HTTP_CONTEXT_STATE_CLOSED)) {
       httpRemoveContextFromEpoll(pContext);
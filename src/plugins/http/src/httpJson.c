@@ -91,9 +91,24 @@ int32_t httpWriteBufNoTrace(struct HttpContext* pContext, const char* buf, int32
   return writeSz;
 }
 
+// a binary buffer is logged by the hex of its first bytes
+static const char* httpJsonBufDump(JsonBuf* buf, char* dump) {
+  if (!buf->binary) return buf->buf;
+
+  int32_t len = (int32_t)(buf->lst - buf->buf);
+  int32_t pos = 0;
+  for (int32_t i = 0; i < MIN(len, JSON_BUFFER_DUMP_BYTES); ++i) {
+    pos += sprintf(dump + pos, "%02x ", (uint8_t)buf->buf[i]);
+  }
+  if (len > JSON_BUFFER_DUMP_BYTES) pos += sprintf(dump + pos, "...");
+  dump[pos] = 0;
+  return dump;
+}
+
 int32_t httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
   int32_t remain = 0;
   char    sLen[24];
+  char    dump[JSON_BUFFER_DUMP_BYTES * 3 + 4];
   int32_t srcLen = (int32_t)(buf->lst - buf->buf);
 
   if (buf->pContext->fd <= 0) {
@@ -116,7 +131,7 @@ int32_t httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
     } else {
       int32_t len = sprintf(sLen, "%x\r\n", srcLen);
       httpTrace("context:%p, fd:%d, write body, chunkSize:%d, response:\n%s", buf->pContext, buf->pContext->fd, srcLen,
-                buf->buf);
+                httpJsonBufDump(buf, dump));
       httpWriteBufNoTrace(buf->pContext, sLen, len);
       remain = httpWriteBufNoTrace(buf->pContext, buf->buf, srcLen);
     }
@@ -128,29 +143,30 @@ int32_t httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
       if (compressBufLen > 0) {
         int32_t len = sprintf(sLen, "%x\r\n", compressBufLen);
         httpTrace("context:%p, fd:%d, write body, chunkSize:%d, compressSize:%d, last:%d, response:\n%s", buf->pContext,
-                  buf->pContext->fd, srcLen, compressBufLen, isTheLast, buf->buf);
+                  buf->pContext->fd, srcLen, compressBufLen, isTheLast, httpJsonBufDump(buf, dump));
         httpWriteBufNoTrace(buf->pContext, sLen, len);
         remain = httpWriteBufNoTrace(buf->pContext, (const char*)compressBuf, compressBufLen);
       } else {
         httpDebug("context:%p, fd:%d, last:%d, compress already dumped, response:\n%s", buf->pContext,
-                  buf->pContext->fd, isTheLast, buf->buf);
+                  buf->pContext->fd, isTheLast, httpJsonBufDump(buf, dump));
         remain = 0;  // there is no data to dump.
       }
     } else {
       httpError("context:%p, fd:%d, failed to compress data, chunkSize:%d, last:%d, error:%d, response:\n%s",
-                buf->pContext, buf->pContext->fd, srcLen, isTheLast, ret, buf->buf);
+                buf->pContext, buf->pContext->fd, srcLen, isTheLast, ret, httpJsonBufDump(buf, dump));
       remain = 0;
     }
   }
 
   httpWriteBufNoTrace(buf->pContext, "\r\n", 2);
+  if (buf->lst > buf->buf) buf->prev = *(buf->lst - 1);
   buf->total += (int32_t)(buf->lst - buf->buf);
   buf->lst = buf->buf;
   memset(buf->buf, 0, (size_t)buf->size);
   return remain;
 }
 
-void httpWriteJsonBufHead(JsonBuf* buf) {
+static void httpWriteChunkedHead(JsonBuf* buf, int32_t unCompressTempl, int32_t compressTempl) {
   if (buf->pContext->fd <= 0) {
     buf->pContext->fd = -1;
   }
@@ -159,16 +175,24 @@ void httpWriteJsonBufHead(JsonBuf* buf) {
   int32_t len = -1;
 
   if (buf->pContext->parser->acceptEncodingGzip == 0 || !tsHttpEnableCompress) {
-    len = sprintf(msg, httpRespTemplate[HTTP_RESPONSE_CHUNKED_UN_COMPRESS], httpVersionStr[buf->pContext->parser->httpVersion],
+    len = sprintf(msg, httpRespTemplate[unCompressTempl], httpVersionStr[buf->pContext->parser->httpVersion],
                   httpKeepAliveStr[buf->pContext->parser->keepAlive]);
   } else {
-    len = sprintf(msg, httpRespTemplate[HTTP_RESPONSE_CHUNKED_COMPRESS], httpVersionStr[buf->pContext->parser->httpVersion],
+    len = sprintf(msg, httpRespTemplate[compressTempl], httpVersionStr[buf->pContext->parser->httpVersion],
                   httpKeepAliveStr[buf->pContext->parser->keepAlive]);
   }
 
   httpWriteBuf(buf->pContext, (const char*)msg, len);
 }
 
+void httpWriteJsonBufHead(JsonBuf* buf) {
+  httpWriteChunkedHead(buf, HTTP_RESPONSE_CHUNKED_UN_COMPRESS, HTTP_RESPONSE_CHUNKED_COMPRESS);
+}
+
+void httpWriteBlockBufHead(JsonBuf* buf) {
+  httpWriteChunkedHead(buf, HTTP_RESPONSE_CHUNKED_BLOCK_UN_COMPRESS, HTTP_RESPONSE_CHUNKED_BLOCK_COMPRESS);
+}
+
 void httpWriteJsonBufEnd(JsonBuf* buf) {
   if (buf->pContext->fd <= 0) {
     httpTrace("context:%p, fd:%d, json buf fd is 0", buf->pContext, buf->pContext->fd);
@@ -182,6 +206,8 @@ void httpWriteJsonBufEnd(JsonBuf* buf) {
 void httpInitJsonBuf(JsonBuf* buf, struct HttpContext* pContext) {
   buf->lst = buf->buf;
   buf->total = 0;
+  buf->prev = 0;
+  buf->binary = 0;
   buf->size = JSON_BUFFER_SIZE;  // option setting
   buf->pContext = pContext;
   memset(buf->lst, 0, JSON_BUFFER_SIZE);
@@ -194,11 +220,12 @@ void httpInitJsonBuf(JsonBuf* buf, struct HttpContext* pContext) {
 }
 
 void httpJsonItemToken(JsonBuf* buf) {
-  char c = *(buf->lst - 1);
+  // the buffer may have just been flushed between two items, look at what was sent last
+  char c = (buf->lst > buf->buf) ? *(buf->lst - 1) : buf->prev;
   if (c == JsonArrStt || c == JsonObjStt || c == JsonPairTkn || c == JsonItmTkn) {
     return;
   }
-  if (buf->lst > buf->buf) httpJsonToken(buf, JsonItmTkn);
+  if (buf->lst > buf->buf || buf->total > 0) httpJsonToken(buf, JsonItmTkn);
 }
 
 void httpJsonString(JsonBuf* buf, char* sVal, int32_t len) {
@@ -250,23 +277,75 @@ void httpJsonStringForTransMean(JsonBuf* buf, char* sVal, int32_t maxLen) {
   httpJsonToken(buf, JsonStrEnd);
 }
 
+// integers are the bulk of a result set, format them without going through the printf machinery
+static int32_t httpFormatUInt64(char* dst, uint64_t num) {
+  char    tmp[MAX_NUM_STR_SZ];
+  int32_t len = 0;
+
+  do {
+    tmp[len++] = (char)('0' + num % 10);
+    num /= 10;
+  } while (num != 0);
+
+  for (int32_t i = 0; i < len; ++i) {
+    dst[i] = tmp[len - i - 1];
+  }
+
+  return len;
+}
+
+static int32_t httpFormatInt64(char* dst, int64_t num) {
+  if (num >= 0) return httpFormatUInt64(dst, (uint64_t)num);
+
+  *dst = '-';
+  return httpFormatUInt64(dst + 1, (uint64_t)0 - (uint64_t)num) + 1;
+}
+
 void httpJsonInt64(JsonBuf* buf, int64_t num) {
   httpJsonItemToken(buf);
   httpJsonTestBuf(buf, MAX_NUM_STR_SZ);
-  buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%" PRId64, num);
+  buf->lst += httpFormatInt64(buf->lst, num);
 }
 
 void httpJsonUInt64(JsonBuf* buf, uint64_t num) {
   httpJsonItemToken(buf);
   httpJsonTestBuf(buf, MAX_NUM_STR_SZ);
-  buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%" PRIu64, num);
+  buf->lst += httpFormatUInt64(buf->lst, num);
+}
+
+/*
+ * Rows of a time series mostly share the same second, so the broken-down local time of the last
+ * second is kept per thread and only the fraction is formatted for the following timestamps.
+ */
+static threadlocal time_t  tsHttpLastSec = 0;
+static threadlocal char    tsHttpLastSecStr[24];
+static threadlocal int32_t tsHttpLastSecLen = 0;
+
+static int32_t httpFormatLocalSec(char* dst, time_t quot) {
+  if (quot != tsHttpLastSec || tsHttpLastSecLen == 0) {
+    struct tm ptm = {0};
+    localtime_r(&quot, &ptm);
+    tsHttpLastSecLen = (int32_t)strftime(tsHttpLastSecStr, sizeof(tsHttpLastSecStr), "%Y-%m-%d %H:%M:%S", &ptm);
+    tsHttpLastSec = quot;
+  }
+
+  memcpy(dst, tsHttpLastSecStr, (size_t)tsHttpLastSecLen);
+  return tsHttpLastSecLen;
+}
+
+static int32_t httpFormatFraction(char* dst, int64_t mod, int32_t digits) {
+  dst[0] = '.';
+  for (int32_t i = digits; i > 0; --i) {
+    dst[i] = (char)('0' + mod % 10);
+    mod /= 10;
+  }
+  return digits + 1;
 }
 
 void httpJsonTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
   char       ts[35] = {0};
   
-  int32_t fractionLen;
-  char* format = NULL;
+  int32_t digits;
   time_t quot = 0;
   int64_t mod = 0;
 
@@ -277,8 +356,7 @@ void httpJsonTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
         t -= 1000;
       }
       quot = t / 1000;
-      fractionLen = 5;
-      format = ".%03" PRId64;
+      digits = 3;
       break;
     }
 
@@ -288,8 +366,7 @@ void httpJsonTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
         t -= 1000000;
       }
       quot = t / 1000000;
-      fractionLen = 8;
-      format = ".%06" PRId64;
+      digits = 6;
       break;
     }
 
@@ -299,20 +376,17 @@ void httpJsonTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
         t -= 1000000000;
       }
       quot = t / 1000000000;
-      fractionLen = 11;
-      format = ".%09" PRId64;
+      digits = 9;
       break;
     }
 
     default:
-      fractionLen = 0;
+      digits = 0;
       assert(false);
   }
 
-  struct tm ptm = {0};
-  localtime_r(&quot, &ptm);
-  int32_t length = (int32_t)strftime(ts, 35, "%Y-%m-%d %H:%M:%S", &ptm);
-  length += snprintf(ts + length, fractionLen, format, mod);
+  int32_t length = httpFormatLocalSec(ts, quot);
+  length += httpFormatFraction(ts + length, mod, digits);
 
   httpJsonString(buf, ts, length);
 }
@@ -376,13 +450,13 @@ void httpJsonUtcTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
 void httpJsonInt(JsonBuf* buf, int32_t num) {
   httpJsonItemToken(buf);
   httpJsonTestBuf(buf, MAX_NUM_STR_SZ);
-  buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%d", num);
+  buf->lst += httpFormatInt64(buf->lst, num);
 }
 
 void httpJsonUInt(JsonBuf* buf, uint32_t num) {
   httpJsonItemToken(buf);
   httpJsonTestBuf(buf, MAX_NUM_STR_SZ);
-  buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%u", num);
+  buf->lst += httpFormatUInt64(buf->lst, num);
 }
 
 void httpJsonFloat(JsonBuf* buf, float num) {
@@ -16,9 +16,11 @@
 #include "os.h"
 #include "taoserror.h"
 #include "tfs.h"
+#include "tmetrics.h"
 
 #include "httpMetricsHandle.h"
 #include "dnode.h"
+#include "vnode.h"
 #include "httpLog.h"
 
 static HttpDecodeMethod metricsDecodeMethod = {"metrics", metricsProcessRequest};
@@ -175,6 +177,99 @@ bool metricsProcessRequest(HttpContext* pContext) {
     }
   }
 
+  {
+    int32_t vnodeList[TSDB_MAX_VNODES] = {0};
+    int32_t numOfVnodes = 0;
+    vnodeGetVnodeList(vnodeList, &numOfVnodes);
+
+    char* keyVnodes = "vnodes_flowctrl";
+    httpJsonPairHead(jsonBuf, keyVnodes, (int32_t)strlen(keyVnodes));
+    httpJsonToken(jsonBuf, JsonArrStt);
+    for (int32_t i = 0; i < numOfVnodes && i < TSDB_MAX_VNODES; ++i) {
+      SVnodeFlowCtrlStat stat = {0};
+      if (vnodeGetFlowCtrlStat(vnodeList[i], &stat) != TSDB_CODE_SUCCESS) continue;
+
+      httpJsonItemToken(jsonBuf);
+      httpJsonToken(jsonBuf, JsonObjStt);
+      char* keyVgId = "vgroup_id";
+      char* keyQueuedMsgs = "queued_msgs";
+      char* keyQueuedBytes = "queued_bytes";
+      char* keyAllowedBytes = "allowed_bytes";
+      char* keyRetryAfter = "retry_after_ms";
+      char* keyFillRate = "fill_rate";
+      char* keyDrainRate = "drain_rate";
+      char* keyCommitRate = "commit_rate";
+      char* keyMemHeadroom = "mem_headroom";
+      char* keyThrottled = "throttled_msgs";
+      char* keyLevel = "flowctrl_level";
+      httpJsonPairIntVal(jsonBuf, keyVgId, (int32_t)strlen(keyVgId), stat.vgId);
+      httpJsonPairIntVal(jsonBuf, keyQueuedMsgs, (int32_t)strlen(keyQueuedMsgs), stat.queuedMsgs);
+      httpJsonPairInt64Val(jsonBuf, keyQueuedBytes, (int32_t)strlen(keyQueuedBytes), stat.queuedBytes);
+      httpJsonPairInt64Val(jsonBuf, keyAllowedBytes, (int32_t)strlen(keyAllowedBytes), stat.allowedBytes);
+      httpJsonPairIntVal(jsonBuf, keyRetryAfter, (int32_t)strlen(keyRetryAfter), stat.retryAfter);
+      httpJsonPairInt64Val(jsonBuf, keyFillRate, (int32_t)strlen(keyFillRate), stat.fillRate);
+      httpJsonPairInt64Val(jsonBuf, keyDrainRate, (int32_t)strlen(keyDrainRate), stat.drainRate);
+      httpJsonPairInt64Val(jsonBuf, keyCommitRate, (int32_t)strlen(keyCommitRate), stat.commitRate);
+      httpJsonPairInt64Val(jsonBuf, keyMemHeadroom, (int32_t)strlen(keyMemHeadroom), stat.memHeadroom);
+      httpJsonPairInt64Val(jsonBuf, keyThrottled, (int32_t)strlen(keyThrottled), stat.throttledMsgs);
+      httpJsonPairIntVal(jsonBuf, keyLevel, (int32_t)strlen(keyLevel), stat.flowctrlLevel);
+      httpJsonToken(jsonBuf, JsonObjEnd);
+    }
+    httpJsonToken(jsonBuf, JsonArrEnd);
+  }
+
+  {
+    char* keyRegistry = "registry";
+    httpJsonPairHead(jsonBuf, keyRegistry, (int32_t)strlen(keyRegistry));
+    httpJsonToken(jsonBuf, JsonObjStt);
+
+    char* keyCounters = "counters";
+    httpJsonPairHead(jsonBuf, keyCounters, (int32_t)strlen(keyCounters));
+    httpJsonToken(jsonBuf, JsonObjStt);
+    for (int32_t i = 0; i < TSDB_METRIC_COUNTER_MAX; ++i) {
+      char* name = (char*)taosMetricsCounterName(i);
+      httpJsonPairInt64Val(jsonBuf, name, (int32_t)strlen(name), taosMetricsGetCounter(i));
+    }
+    httpJsonToken(jsonBuf, JsonObjEnd);
+
+    char* keyGauges = "gauges";
+    httpJsonPairHead(jsonBuf, keyGauges, (int32_t)strlen(keyGauges));
+    httpJsonToken(jsonBuf, JsonObjStt);
+    for (int32_t i = 0; i < TSDB_METRIC_GAUGE_MAX; ++i) {
+      char* name = (char*)taosMetricsGaugeName(i);
+      httpJsonPairInt64Val(jsonBuf, name, (int32_t)strlen(name), taosMetricsGetGauge(i));
+    }
+    httpJsonToken(jsonBuf, JsonObjEnd);
+
+    char* keyHistograms = "histograms";
+    httpJsonPairHead(jsonBuf, keyHistograms, (int32_t)strlen(keyHistograms));
+    httpJsonToken(jsonBuf, JsonObjStt);
+    for (int32_t i = 0; i < TSDB_METRIC_HISTOGRAM_MAX; ++i) {
+      SMetricsHistogram hist;
+      taosMetricsGetHistogram(i, &hist);
+
+      char* name = (char*)taosMetricsHistogramName(i);
+      httpJsonPairHead(jsonBuf, name, (int32_t)strlen(name));
+      httpJsonToken(jsonBuf, JsonObjStt);
+      char* keyCount = "count";
+      char* keySum = "sum";
+      char* keyP50 = "p50";
+      char* keyP90 = "p90";
+      char* keyP99 = "p99";
+      char* keyMax = "max";
+      httpJsonPairInt64Val(jsonBuf, keyCount, (int32_t)strlen(keyCount), hist.count);
+      httpJsonPairInt64Val(jsonBuf, keySum, (int32_t)strlen(keySum), hist.sum);
+      httpJsonPairInt64Val(jsonBuf, keyP50, (int32_t)strlen(keyP50), hist.p50);
+      httpJsonPairInt64Val(jsonBuf, keyP90, (int32_t)strlen(keyP90), hist.p90);
+      httpJsonPairInt64Val(jsonBuf, keyP99, (int32_t)strlen(keyP99), hist.p99);
+      httpJsonPairInt64Val(jsonBuf, keyMax, (int32_t)strlen(keyMax), hist.max);
+      httpJsonToken(jsonBuf, JsonObjEnd);
+    }
+    httpJsonToken(jsonBuf, JsonObjEnd);
+
+    httpJsonToken(jsonBuf, JsonObjEnd);
+  }
+
   httpJsonToken(jsonBuf, JsonObjEnd);
 
   httpWriteJsonBufEnd(jsonBuf);
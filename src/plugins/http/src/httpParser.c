@@ -242,6 +242,14 @@ static int32_t httpOnParseHeaderField(HttpParser *parser, const char *key, const
     return 0;
   }
 
+  else if (0 == strcasecmp(key, "Accept")) {
+    if (strstr(val, HTTP_BLOCK_CONTENT_TYPE)) {
+      parser->acceptBlock = 1;
+      httpTrace("context:%p, fd:%d, acceptBlock:%d", pContext, pContext->fd, parser->acceptBlock);
+    }
+    return 0;
+  }
+
   else if (strncasecmp(key, "Connection", 10) == 0) {
     if (strncasecmp(val, "Keep-Alive", 10) == 0) {
       parser->keepAlive = HTTP_KEEPALIVE_ENABLE;
@@ -443,6 +451,7 @@ void httpInitParser(HttpParser *parser) {
   parser->httpVersion = 0;
   parser->acceptEncodingGzip = 0;
   parser->acceptEncodingChunked = 0;
+  parser->acceptBlock = 0;
   parser->contentLengthSpecified = 0;
   parser->contentChunked = 0;
   parser->transferGzip = 0;
@@ -1160,7 +1169,7 @@ static int32_t httpParseChar(HttpParser *parser, const char c, int32_t *again) {
   return ok;
 }
 
-int32_t httpParseBuf(HttpParser *parser, const char *buf, int32_t len) {
+int32_t httpParseBuf(HttpParser *parser, const char *buf, int32_t len, int32_t *parsedLen) {
   HttpContext *pContext = parser->pContext;
   const char * p = buf;
   int32_t      ret = 0;
@@ -1176,7 +1185,11 @@ int32_t httpParseBuf(HttpParser *parser, const char *buf, int32_t len) {
     if (again) continue;
     ++p;
     ++i;
+
+    // the bytes after the end of this request belong to the next pipelined one
+    if (parser->parsed) break;
   }
 
+  if (parsedLen != NULL) *parsedLen = i;
   return ret;
 }
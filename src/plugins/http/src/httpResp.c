@@ -41,7 +41,10 @@ const char *httpRespTemplate[] = {
     // HTTP_RESPONSE_OPTIONS
     "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sContent-Type: application/json;charset=utf-8\r\nContent-Length: %d\r\nAccess-Control-Allow-Methods: *\r\nAccess-Control-Max-Age: 3600\r\nAccess-Control-Allow-Headers: Origin, X-Requested-With, Content-Type, Accept, authorization\r\n\r\n",
     // HTTP_RESPONSE_GRAFANA
-    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sAccess-Control-Allow-Methods:POST, GET, OPTIONS, DELETE, PUT\r\nAccess-Control-Allow-Headers:Accept, Content-Type\r\nContent-Type: application/json;charset=utf-8\r\nContent-Length: %d\r\n\r\n"
+    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sAccess-Control-Allow-Methods:POST, GET, OPTIONS, DELETE, PUT\r\nAccess-Control-Allow-Headers:Accept, Content-Type\r\nContent-Type: application/json;charset=utf-8\r\nContent-Length: %d\r\n\r\n",
+    // HTTP_RESPONSE_CHUNKED_BLOCK_UN_COMPRESS, HTTP_RESPONSE_CHUNKED_BLOCK_COMPRESS
+    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sContent-Type: " HTTP_BLOCK_CONTENT_TYPE "\r\nTransfer-Encoding: chunked\r\n\r\n",
+    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sContent-Type: " HTTP_BLOCK_CONTENT_TYPE "\r\nContent-Encoding: gzip\r\nTransfer-Encoding: chunked\r\n\r\n"
 };
 
 static void httpSendErrorRespImp(HttpContext *pContext, int32_t httpCode, char *httpCodeStr, int32_t errNo, const char *desc) {
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tglobal.h"
+#include "ttype.h"
+#include "tsclient.h"
+#include "tscUtil.h"
+#include "httpLog.h"
+#include "httpJson.h"
+#include "httpRestHandle.h"
+#include "httpRestJson.h"
+#include "httpRestBlock.h"
+
+/*
+ * Columnar result of a restful sql request, sent instead of json when the request carries
+ * "Accept: application/vnd.taos.block". All integers are in host (little-endian) byte order.
+ *
+ *   head  : magic "TDBK", int16 version, int8 precision, int8 reserved, int32 numOfCols,
+ *           numOfCols x [int8 type, int8 reserved, int16 bytes, int16 nameLen, name]
+ *   batch : int32 numOfRows (> 0), then for each column
+ *             null bitmap of (numOfRows + 7) / 8 bytes, bit (row % 8) of byte (row / 8) set for null
+ *             fixed length type: numOfRows x bytes values as stored by the server
+ *             binary and nchar : numOfRows x [int16 len, data], nchar already in the client charset
+ *   tail  : int32 0, int32 code, int64 numOfRows of the whole result
+ *
+ * One batch is written for each block retrieved from the server and pushed to the client at once,
+ * so the client decodes a batch while the next one is being fetched.
+ */
+
+#define REST_BLOCK_PIECE_SIZE  4096
+#define REST_BLOCK_BITMAP_ROWS (REST_BLOCK_PIECE_SIZE * 8)
+
+static void restBlockPrint(JsonBuf *buf, const void *data, int32_t len) {
+  const char *p = (const char *)data;
+  while (len > 0) {
+    int32_t piece = MIN(len, REST_BLOCK_PIECE_SIZE);
+    httpJsonPrint(buf, p, piece);
+    p += piece;
+    len -= piece;
+  }
+}
+
+static void restBlockInt8(JsonBuf *buf, int8_t val) { restBlockPrint(buf, &val, sizeof(val)); }
+static void restBlockInt16(JsonBuf *buf, int16_t val) { restBlockPrint(buf, &val, sizeof(val)); }
+static void restBlockInt32(JsonBuf *buf, int32_t val) { restBlockPrint(buf, &val, sizeof(val)); }
+static void restBlockInt64(JsonBuf *buf, int64_t val) { restBlockPrint(buf, &val, sizeof(val)); }
+
+static void restBlockColumnHead(JsonBuf *buf, const char *name, int8_t type, int16_t bytes) {
+  int16_t nameLen = (int16_t)strlen(name);
+
+  restBlockInt8(buf, type);
+  restBlockInt8(buf, 0);
+  restBlockInt16(buf, bytes);
+  restBlockInt16(buf, nameLen);
+  restBlockPrint(buf, name, nameLen);
+}
+
+static void restBlockHead(JsonBuf *buf, int8_t precision, int32_t numOfCols) {
+  restBlockPrint(buf, REST_BLOCK_MAGIC, REST_BLOCK_MAGIC_LEN);
+  restBlockInt16(buf, REST_BLOCK_VERSION);
+  restBlockInt8(buf, precision);
+  restBlockInt8(buf, 0);
+  restBlockInt32(buf, numOfCols);
+}
+
+void restBuildSqlAffectRowsBlock(HttpContext *pContext, HttpSqlCmd *cmd, int32_t affect_rows) {
+  JsonBuf *jsonBuf = httpMallocJsonBuf(pContext);
+  if (jsonBuf == NULL) return;
+
+  // the head announced a single int column, see restStartSqlBlock
+  restBlockInt32(jsonBuf, 1);
+  restBlockInt8(jsonBuf, 0);
+  restBlockInt32(jsonBuf, affect_rows);
+
+  cmd->numOfRows = 1;
+}
+
+void restStartSqlBlock(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result) {
+  JsonBuf *jsonBuf = httpMallocJsonBuf(pContext);
+  if (jsonBuf == NULL) return;
+
+  TAOS_FIELD *fields = taos_fetch_fields(result);
+  int32_t     num_fields = taos_num_fields(result);
+
+  httpInitJsonBuf(jsonBuf, pContext);
+  jsonBuf->binary = 1;
+  httpWriteBlockBufHead(jsonBuf);
+
+  SSqlObj *pObj = (SSqlObj *)result;
+  bool     isAlterSql = (pObj->sqlstr == NULL) ? false : httpCheckAlterSql(pObj->sqlstr);
+
+  if (num_fields == 0 || isAlterSql) {
+    restBlockHead(jsonBuf, (int8_t)taos_result_precision(result), 1);
+    restBlockColumnHead(jsonBuf, REST_JSON_AFFECT_ROWS, TSDB_DATA_TYPE_INT, sizeof(int32_t));
+    return;
+  }
+
+  restBlockHead(jsonBuf, (int8_t)taos_result_precision(result), num_fields);
+  for (int32_t i = 0; i < num_fields; ++i) {
+    restBlockColumnHead(jsonBuf, fields[i].name, fields[i].type, fields[i].bytes);
+  }
+}
+
+static void restBlockColumn(JsonBuf *buf, SInternalField *pInfo, char *pData, int32_t numOfRows) {
+  int32_t type = pInfo->field.type;
+  int32_t bytes = pInfo->field.bytes;
+
+  for (int32_t start = 0; start < numOfRows; start += REST_BLOCK_BITMAP_ROWS) {
+    uint8_t bitmap[REST_BLOCK_PIECE_SIZE] = {0};
+    int32_t rows = MIN(numOfRows - start, REST_BLOCK_BITMAP_ROWS);
+
+    for (int32_t k = 0; k < rows; ++k) {
+      if (isNull(pData + (int64_t)(start + k) * bytes, type)) {
+        bitmap[k >> 3] |= (uint8_t)(1u << (k & 7));
+      }
+    }
+
+    restBlockPrint(buf, bitmap, (rows + 7) / 8);
+  }
+
+  if (!IS_VAR_DATA_TYPE(type)) {
+    restBlockPrint(buf, pData, numOfRows * bytes);
+    return;
+  }
+
+  for (int32_t k = 0; k < numOfRows; ++k) {
+    char *p = pData + (int64_t)k * bytes;
+    if (isNull(p, type)) {
+      restBlockInt16(buf, 0);
+    } else {
+      restBlockInt16(buf, (int16_t)varDataLen(p));
+      restBlockPrint(buf, varDataVal(p), varDataLen(p));
+    }
+  }
+}
+
+bool restBuildSqlBlock(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result, int32_t numOfRows) {
+  JsonBuf *jsonBuf = httpMallocJsonBuf(pContext);
+  if (jsonBuf == NULL) return false;
+
+  SSqlObj    *pSql = (SSqlObj *)result;
+  SSqlRes    *pRes = &pSql->res;
+  SQueryInfo *pQueryInfo = tscGetQueryInfo(&pSql->cmd);
+
+  // rows of this block are taken from the raw columns, not row by row through taos_fetch_row
+  int32_t rows = MIN(numOfRows, (int32_t)(pRes->numOfRows - pRes->row));
+  bool    reachLimit = false;
+  if (cmd->numOfRows + rows >= tsRestRowLimit) {
+    rows = tsRestRowLimit - cmd->numOfRows;
+    reachLimit = true;
+  }
+
+  if (rows > 0) {
+    restBlockInt32(jsonBuf, rows);
+
+    size_t size = tscNumOfFields(pQueryInfo);
+    for (int32_t i = 0; i < size; ++i) {
+      SInternalField *pInfo = (SInternalField *)TARRAY_GET_ELEM(pQueryInfo->fieldsInfo.internalField, i);
+      if (!pInfo->visible) continue;
+
+      restBlockColumn(jsonBuf, pInfo, (char *)pRes->urow[i] + (int64_t)pRes->row * pInfo->field.bytes, rows);
+    }
+
+    pRes->row += rows;
+    cmd->numOfRows += rows;
+  }
+
+  if (pContext->fd <= 0) {
+    httpError("context:%p, fd:%d, user:%s, conn closed, abort retrieve", pContext, pContext->fd, pContext->user);
+    return false;
+  }
+
+  if (reachLimit) {
+    httpDebug("context:%p, fd:%d, user:%s, retrieve rows:%d larger than limit:%d, abort retrieve", pContext,
+              pContext->fd, pContext->user, cmd->numOfRows, tsRestRowLimit);
+    return false;
+  }
+
+  if (jsonBuf->lst != jsonBuf->buf) {
+    httpWriteJsonBufBody(jsonBuf, false);
+  }
+
+  httpDebug("context:%p, fd:%d, user:%s, retrieved row:%d", pContext, pContext->fd, pContext->user, cmd->numOfRows);
+  return true;
+}
+
+void restStopSqlBlock(HttpContext *pContext, HttpSqlCmd *cmd) {
+  JsonBuf *jsonBuf = httpMallocJsonBuf(pContext);
+  if (jsonBuf == NULL) return;
+
+  restBlockInt32(jsonBuf, 0);
+  restBlockInt32(jsonBuf, cmd->code);
+  restBlockInt64(jsonBuf, cmd->numOfRows);
+
+  httpWriteJsonBufEnd(jsonBuf);
+}
@@ -19,6 +19,7 @@
 #include "httpLog.h"
 #include "httpRestHandle.h"
 #include "httpRestJson.h"
+#include "httpRestBlock.h"
 #include "tglobal.h"
 
 static HttpDecodeMethod restDecodeMethod = {"rest", restProcessRequest};
@@ -56,6 +57,17 @@ static HttpEncodeMethod restEncodeSqlUtcTimeStringMethod = {
   .setNextCmdFp         = NULL
 };
 
+static HttpEncodeMethod restEncodeSqlBlockMethod = {
+  .startJsonFp          = restStartSqlBlock,
+  .stopJsonFp           = restStopSqlBlock,
+  .buildQueryJsonFp     = restBuildSqlBlock,
+  .buildAffectRowJsonFp = restBuildSqlAffectRowsBlock,
+  .initJsonFp           = NULL,
+  .cleanJsonFp          = NULL,
+  .checkFinishedFp      = NULL,
+  .setNextCmdFp         = NULL
+};
+
 void restInitHandle(HttpServer* pServer) {
   httpAddMethod(pServer, &restDecodeMethod);
   httpAddMethod(pServer, &restDecodeMethod2);
@@ -135,6 +147,11 @@ bool restProcessSqlRequest(HttpContext* pContext, int32_t timestampFmt) {
     pContext->encodeMethod = &restEncodeSqlUtcTimeStringMethod;
   }
 
+  // timestamps are sent as raw integers in the columnar format whatever the url asked for
+  if (pContext->parser->acceptBlock) {
+    pContext->encodeMethod = &restEncodeSqlBlockMethod;
+  }
+
   return true;
 }
 
@@ -229,6 +229,11 @@ bool restBuildSqlJson(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result,
     }
   }
 
+  // push the rows of this block to the client before the next one is fetched
+  if (jsonBuf->lst != jsonBuf->buf) {
+    httpWriteJsonBufBody(jsonBuf, false);
+  }
+
   httpDebug("context:%p, fd:%d, user:%s, retrieved row:%d", pContext, pContext->fd, pContext->user, cmd->numOfRows);
   return true;
 }
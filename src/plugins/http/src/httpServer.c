@@ -26,6 +26,7 @@
 #include "httpUtil.h"
 
 static bool httpReadData(HttpContext *pContext);
+static void httpAcceptReusePortConnections(HttpThread *pThread);
 
 #ifdef __APPLE__
 static int sv_dummy = 0;
@@ -88,6 +89,11 @@ static void httpStopThread(HttpThread *pThread) {
   }
 #endif  // __APPLE__
 
+  if (pThread->listenFd >= 0) {
+    taosCloseSocket(pThread->listenFd);
+    pThread->listenFd = -1;
+  }
+
   EpollClose(pThread->pollFd);
   pthread_mutex_destroy(&(pThread->threadMutex));
 }
@@ -139,6 +145,11 @@ static void httpProcessHttpData(void *param) {
         continue;
       }
 #endif // __APPLE__
+      if (events[i].data.ptr == pThread) {
+        httpAcceptReusePortConnections(pThread);
+        continue;
+      }
+
       pContext = httpGetContext(events[i].data.ptr);
       if (pContext == NULL) {
         httpError("context:%p, is already released, close connect", events[i].data.ptr);
@@ -175,6 +186,11 @@ static void httpProcessHttpData(void *param) {
         continue;
       }
 
+      if (events[i].events & EPOLLOUT) {
+        // only armed to pick up a pipelined request, see httpCloseContextByApp
+        httpModifyContextEvents(pContext, EPOLLIN);
+      }
+
       if (!httpAlterContextState(pContext, HTTP_CONTEXT_STATE_READY, HTTP_CONTEXT_STATE_READY)) {
         httpDebug("context:%p, fd:%d, state:%s, not in ready state, ignore read events", pContext, pContext->fd,
                   httpContextStateStr(pContext->state));
@@ -189,6 +205,8 @@ static void httpProcessHttpData(void *param) {
         httpNotifyContextClose(pContext);
       } else {
         if (httpReadData(pContext)) {
+          // stop reading until the response is sent, requests pipelined behind this one wait in the socket
+          httpModifyContextEvents(pContext, 0);
           (*(pThread->processData))(pContext);
           atomic_fetch_add_32(&pServer->requestNum, 1);
         }
@@ -197,14 +215,56 @@ static void httpProcessHttpData(void *param) {
   }
 }
 
+static void httpAddConnection(HttpServer *pServer, HttpThread *pThread, SOCKET connFd,
+                              struct sockaddr_in *clientAddr) {
+  int32_t totalFds = 1;
+  for (int32_t i = 0; i < pServer->numOfThreads; ++i) {
+    totalFds += pServer->pThreads[i].numOfContexts;
+  }
+
+  if (tsHttpMaxConnections > 0 && totalFds > tsHttpMaxConnections) {
+    httpError("fd:%d, ip:%s:%u, totalFds:%d larger than httpMaxConnections:%d, refuse connection", connFd,
+              taosInetNtoa(clientAddr->sin_addr), htons(clientAddr->sin_port), totalFds, tsHttpMaxConnections);
+    taosCloseSocket(connFd);
+    return;
+  }
+
+  taosKeepTcpAlive(connFd);
+  taosSetNonblocking(connFd, 1);
+
+  HttpContext *pContext = httpCreateContext(connFd);
+  if (pContext == NULL) {
+    httpError("fd:%d, ip:%s:%u, no enough resource to allocate http context", connFd,
+              taosInetNtoa(clientAddr->sin_addr), htons(clientAddr->sin_port));
+    taosCloseSocket(connFd);
+    return;
+  }
+
+  pContext->pThread = pThread;
+  sprintf(pContext->ipstr, "%s:%u", taosInetNtoa(clientAddr->sin_addr), htons(clientAddr->sin_port));
+
+  struct epoll_event event;
+  event.events = HTTP_EPOLL_EVENTS | EPOLLIN;
+  event.data.ptr = pContext;
+  if (epoll_ctl(pThread->pollFd, EPOLL_CTL_ADD, connFd, &event) < 0) {
+    httpError("context:%p, fd:%d, ip:%s, thread:%s, failed to add http fd for epoll, error:%s", pContext, connFd,
+              pContext->ipstr, pThread->label, strerror(errno));
+    taosCloseSocket(pContext->fd);
+    httpReleaseContext(pContext/*, true*/);
+    return;
+  }
+
+  // notify the data process, add into the FdObj list
+  atomic_add_fetch_32(&pThread->numOfContexts, 1);
+  httpDebug("context:%p, fd:%d, ip:%s, thread:%s numOfContexts:%d totalContext:%d, accept a new connection", pContext,
+            connFd, pContext->ipstr, pThread->label, pThread->numOfContexts, totalFds);
+}
+
 static void *httpAcceptHttpConnection(void *arg) {
   SOCKET             connFd = -1;
   struct sockaddr_in clientAddr;
   int32_t            threadId = 0;
   HttpServer *       pServer = &tsHttpServer;
-  HttpThread *       pThread = NULL;
-  HttpContext *      pContext = NULL;
-  int32_t            totalFds = 0;
 
   taosSetMaskSIGPIPE();
   setThreadName("httpAcceptConn");
@@ -237,64 +297,92 @@ static void *httpAcceptHttpConnection(void *arg) {
       continue;
     }
 
-    totalFds = 1;
-    for (int32_t i = 0; i < pServer->numOfThreads; ++i) {
-      totalFds += pServer->pThreads[i].numOfContexts;
-    }
+    // pick up the thread to handle this connection, and next thread for next connection
+    httpAddConnection(pServer, pServer->pThreads + threadId, connFd, &clientAddr);
+    threadId = (threadId + 1) % pServer->numOfThreads;
+  }
 
-#if 0
-    if (totalFds > tsHttpCacheSessions * 100) {
-      httpError("fd:%d, ip:%s:%u, totalFds:%d larger than httpCacheSessions:%d*100, refuse connection", connFd,
-                taosInetNtoa(clientAddr.sin_addr), htons(clientAddr.sin_port), totalFds, tsHttpCacheSessions);
-      taosCloseSocket(connFd);
-      continue;
+  taosCloseSocket(pServer->fd);
+  return NULL;
+}
+
+/*
+ * With httpReusePort each http thread owns a listening socket bound to the same port, the kernel balances
+ * the connections among them and a thread accepts its connections in its own epoll loop, so there is no
+ * single acceptor to queue behind.
+ */
+static void httpAcceptReusePortConnections(HttpThread *pThread) {
+  HttpServer *pServer = &tsHttpServer;
+
+  while (!pServer->stop) {
+    struct sockaddr_in clientAddr;
+    socklen_t          addrlen = sizeof(clientAddr);
+
+    SOCKET connFd = accept(pThread->listenFd, (struct sockaddr *)&clientAddr, &addrlen);
+    if (connFd == -1) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        httpError("http thread:%s, accept connect failure, errno:%d reason:%s", pThread->label, errno,
+                  strerror(errno));
+      }
+      break;
     }
-#endif
 
-    taosKeepTcpAlive(connFd);
-    taosSetNonblocking(connFd, 1);
+    httpAddConnection(pServer, pThread, connFd, &clientAddr);
+  }
+}
 
-    // pick up the thread to handle this connection
-    pThread = pServer->pThreads + threadId;
+static bool httpOpenReusePortSockets(HttpServer *pServer) {
+  // sockets with SO_REUSEPORT would share the port with another process of the same user listening on it, a plain
+  // socket can only be bound when no one listens on the port
+  SOCKET probeFd = taosOpenTcpServerSocket(pServer->serverIp, pServer->serverPort);
+  if (probeFd < 0) {
+    httpError("http server:%s, port %s:%u is in use, failed to open http sockets with SO_REUSEPORT", pServer->label,
+              taosIpStr(pServer->serverIp), pServer->serverPort);
+    return false;
+  }
+  taosCloseSocket(probeFd);
 
-    pContext = httpCreateContext(connFd);
-    if (pContext == NULL) {
-      httpError("fd:%d, ip:%s:%u, no enough resource to allocate http context", connFd,
-                taosInetNtoa(clientAddr.sin_addr), htons(clientAddr.sin_port));
-      taosCloseSocket(connFd);
-      continue;
+  for (int32_t i = 0; i < pServer->numOfThreads; ++i) {
+    HttpThread *pThread = pServer->pThreads + i;
+
+    pThread->listenFd = taosOpenTcpReusePortSocket(pServer->serverIp, pServer->serverPort);
+    if (pThread->listenFd < 0) {
+      httpError("http thread:%s, failed to open http socket with SO_REUSEPORT, ip:%s:%u error:%s", pThread->label,
+                taosIpStr(pServer->serverIp), pServer->serverPort, strerror(errno));
+      break;
     }
 
-    pContext->pThread = pThread;
-    sprintf(pContext->ipstr, "%s:%u", taosInetNtoa(clientAddr.sin_addr), htons(clientAddr.sin_port));
+    taosSetNonblocking(pThread->listenFd, 1);
 
-    struct epoll_event event;
-#ifndef _TD_NINGSI_60    
-    event.events = EPOLLIN | EPOLLPRI | EPOLLWAKEUP | EPOLLERR | EPOLLHUP | EPOLLRDHUP;
-#else
-    event.events = EPOLLIN | EPOLLPRI | EPOLLERR | EPOLLHUP | EPOLLRDHUP;
-#endif    
-    event.data.ptr = pContext;
-    if (epoll_ctl(pThread->pollFd, EPOLL_CTL_ADD, connFd, &event) < 0) {
-      httpError("context:%p, fd:%d, ip:%s, thread:%s, failed to add http fd for epoll, error:%s", pContext, connFd,
-                pContext->ipstr, pThread->label, strerror(errno));
-      taosCloseSocket(pContext->fd);
-      httpReleaseContext(pContext/*, true*/);
-      continue;
+    struct epoll_event event = {0};
+    event.events = EPOLLIN;
+    event.data.ptr = pThread;
+    if (epoll_ctl(pThread->pollFd, EPOLL_CTL_ADD, pThread->listenFd, &event) < 0) {
+      httpError("http thread:%s, failed to add listen fd for epoll, error:%s", pThread->label, strerror(errno));
+      taosCloseSocket(pThread->listenFd);
+      pThread->listenFd = -1;
+      break;
     }
+  }
 
-    // notify the data process, add into the FdObj list
-    atomic_add_fetch_32(&pThread->numOfContexts, 1);
-    httpDebug("context:%p, fd:%d, ip:%s, thread:%s numOfContexts:%d totalContext:%d, accept a new connection", pContext,
-              connFd, pContext->ipstr, pThread->label, pThread->numOfContexts, totalFds);
+  bool allOpened = true;
+  for (int32_t i = 0; i < pServer->numOfThreads; ++i) {
+    if (pServer->pThreads[i].listenFd < 0) allOpened = false;
+  }
+
+  if (!allOpened) {
+    for (int32_t i = 0; i < pServer->numOfThreads; ++i) {
+      HttpThread *pThread = pServer->pThreads + i;
+      if (pThread->listenFd < 0) continue;
 
-    // pick up next thread for next connection
-    threadId++;
-    threadId = threadId % pServer->numOfThreads;
+      epoll_ctl(pThread->pollFd, EPOLL_CTL_DEL, pThread->listenFd, NULL);
+      taosCloseSocket(pThread->listenFd);
+      pThread->listenFd = -1;
+    }
   }
 
-  taosCloseSocket(pServer->fd);
-  return NULL;
+  return allOpened;
 }
 
 bool httpInitConnect() {
@@ -310,6 +398,7 @@ bool httpInitConnect() {
     sprintf(pThread->label, "%s%d", pServer->label, i);
     pThread->processData = pServer->processData;
     pThread->threadId = i;
+    pThread->listenFd = -1;
 
     if (pthread_mutex_init(&(pThread->threadMutex), NULL) < 0) {
       httpError("http thread:%s, failed to init HTTP process data mutex, reason:%s", pThread->label, strerror(errno));
@@ -338,6 +427,14 @@ bool httpInitConnect() {
     pThread++;
   }
 
+  if (tsHttpReusePort && httpOpenReusePortSockets(pServer)) {
+    pServer->fd = -1;
+    pServer->status = HTTP_SERVER_RUNNING;
+    httpInfo("http server init success at %u, each of %d threads accepts connections", pServer->serverPort,
+             pServer->numOfThreads);
+    return true;
+  }
+
   pthread_attr_t thattr;
   pthread_attr_init(&thattr);
   pthread_attr_setdetachstate(&thattr, PTHREAD_CREATE_JOINABLE);
@@ -369,11 +466,21 @@ static bool httpReadData(HttpContext *pContext) {
   char buf[HTTP_STEP_SIZE + 1] = {0};
 
   while (1) {
-    int32_t nread = (int32_t)taosReadSocket(pContext->fd, buf, HTTP_STEP_SIZE);
+    int32_t nread;
+    if (pContext->pipeLen > 0) {
+      // requests pipelined behind the previous one are parsed before reading the socket again
+      nread = pContext->pipeLen;
+      memcpy(buf, pContext->pipeBuf, (size_t)nread);
+      pContext->pipeLen = 0;
+    } else {
+      nread = (int32_t)taosReadSocket(pContext->fd, buf, HTTP_STEP_SIZE);
+    }
+
     if (nread > 0) {
       buf[nread] = '\0';
       httpTraceL("context:%p, fd:%d, nread:%d content:%s", pContext, pContext->fd, nread, buf);
-      int32_t ok = httpParseBuf(pParser, buf, nread);
+      int32_t parsedLen = 0;
+      int32_t ok = httpParseBuf(pParser, buf, nread, &parsedLen);
 
       if (ok) {
         httpError("context:%p, fd:%d, parse failed, ret:%d code:%d close connect", pContext, pContext->fd, ok,
@@ -394,13 +501,22 @@ static bool httpReadData(HttpContext *pContext) {
         httpTrace("context:%p, fd:%d, read not finished", pContext, pContext->fd);
         continue;
       } else {
-        httpDebug("context:%p, fd:%d, bodyLen:%d", pContext, pContext->fd, pParser->body.pos);
+        if (parsedLen < nread) {
+          pContext->pipeLen = nread - parsedLen;
+          memcpy(pContext->pipeBuf, buf + parsedLen, (size_t)pContext->pipeLen);
+        }
+        httpDebug("context:%p, fd:%d, bodyLen:%d, pipeLen:%d", pContext, pContext->fd, pParser->body.pos,
+                  pContext->pipeLen);
         return true;
       }
     } else if (nread < 0) {
-      if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+      if (errno == EINTR) {
+        continue;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // the rest of the request has not arrived yet, go on parsing it when the socket is readable again
         httpDebug("context:%p, fd:%d, read from socket error:%d, wait another event", pContext, pContext->fd, errno);
-        continue;  // later again
+        httpReleaseContext(pContext/*, false */);
+        return false;
       } else {
         httpError("context:%p, fd:%d, read from socket error:%d, close connect", pContext, pContext->fd, errno);
         taosCloseSocket(pContext->fd);
@@ -232,6 +232,7 @@ void httpProcessSingleSqlRetrieveCallBackImp(void *param, TAOS_RES *result, int3
     if (code < 0) {
       httpError("context:%p, fd:%d, user:%s, retrieve failed, code:%s", pContext, pContext->fd, pContext->user,
                 tstrerror(code));
+      pContext->singleCmd.code = code;
     }
 
     taos_free_result(result);
@@ -20,6 +20,7 @@
 #include "tlog.h"
 #include "ttimer.h"
 #include "tutil.h"
+#include "tmetrics.h"
 #include "tscUtil.h"
 #include "tsclient.h"
 #include "dnode.h"
@@ -37,6 +38,7 @@
 #define LOG_LEN_STR    512
 #define IP_LEN_STR     TSDB_EP_LEN
 #define CHECK_INTERVAL 1000
+#define METRIC_NAME_LEN 32
 
 typedef enum {
   MON_CMD_CREATE_DB,
@@ -46,6 +48,7 @@ typedef enum {
   MON_CMD_CREATE_TB_DN,
   MON_CMD_CREATE_TB_ACCT_ROOT,
   MON_CMD_CREATE_TB_SLOWQUERY,
+  MON_CMD_CREATE_MT_METRICS,
   MON_CMD_MAX
 } EMonCmd;
 
@@ -67,6 +70,7 @@ typedef struct {
 
 static SMonConn tsMonitor = {0};
 static void  monSaveSystemInfo();
+static void  monSaveMetrics();
 static void *monThreadFunc(void *param);
 static void  monBuildMonitorSql(char *sql, int32_t cmd);
 extern int32_t (*monStartSystemFp)();
@@ -174,6 +178,7 @@ static void *monThreadFunc(void *param) {
     if (tsMonitor.state == MON_STATE_INITED) {
       if (accessTimes % tsMonitorInterval == 0) {
         monSaveSystemInfo();
+        monSaveMetrics();
       }
     }
   }
@@ -234,6 +239,11 @@ static void monBuildMonitorSql(char *sql, int32_t cmd) {
              "create table if not exists %s.slowquery(ts timestamp, username "
              "binary(%d), created_time timestamp, time bigint, sql binary(%d))",
              tsMonitorDbName, TSDB_TABLE_FNAME_LEN - 1, TSDB_SLOW_QUERY_SQL_LEN);
+  } else if (cmd == MON_CMD_CREATE_MT_METRICS) {
+    snprintf(sql, SQL_LENGTH,
+             "create table if not exists %s.metrics(ts timestamp, val bigint, sum bigint, p50 bigint, p90 bigint"
+             ", p99 bigint, max bigint) tags (dnodeid int, name binary(%d))",
+             tsMonitorDbName, METRIC_NAME_LEN);
   } else if (cmd == MON_CMD_CREATE_TB_LOG) {
     snprintf(sql, SQL_LENGTH,
              "create table if not exists %s.log(ts timestamp, level tinyint, "
@@ -351,6 +361,82 @@ static void monSaveSystemInfo() {
   }
 }
 
+static int32_t monBindMetric(TAOS_STMT *stmt, int64_t ts, const char *name, SMetricsHistogram *pHist, bool isHist) {
+  char      tbname[TSDB_TABLE_FNAME_LEN] = {0};
+  int32_t   dnodeId = dnodeGetDnodeId();
+  uintptr_t nameLen = strlen(name);
+  int32_t   null = 1;
+
+  snprintf(tbname, sizeof(tbname), "%s.dm%d_%s", tsMonitorDbName, dnodeId, name);
+
+  TAOS_BIND tags[2] = {{0}};
+  tags[0].buffer_type = TSDB_DATA_TYPE_INT;
+  tags[0].buffer = &dnodeId;
+  tags[1].buffer_type = TSDB_DATA_TYPE_BINARY;
+  tags[1].buffer = (void *)name;
+  tags[1].buffer_length = nameLen;
+  tags[1].length = &nameLen;
+
+  int64_t vals[6] = {isHist ? pHist->count : pHist->sum, pHist->sum, pHist->p50, pHist->p90, pHist->p99, pHist->max};
+  TAOS_BIND params[7] = {{0}};
+  params[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  params[0].buffer = &ts;
+  for (int32_t i = 0; i < 6; ++i) {
+    params[i + 1].buffer_type = TSDB_DATA_TYPE_BIGINT;
+    params[i + 1].buffer = &vals[i];
+    params[i + 1].is_null = (isHist || i == 0) ? NULL : &null;
+  }
+
+  int32_t code = taos_stmt_set_tbname_tags(stmt, tbname, tags);
+  if (code == 0) code = taos_stmt_bind_param(stmt, params);
+  if (code == 0) code = taos_stmt_add_batch(stmt);
+  return code;
+}
+
+/*
+ * Every counter, gauge and histogram of the registry is a child table of the metrics super table.
+ * One interval is bound into a single prepared statement and sent as one submit, so the values go
+ * in binary form and the cost does not grow with a sql string per metric.
+ */
+static void monSaveMetrics() {
+  int64_t    ts = taosGetTimestampUs();
+  TAOS_STMT *stmt = taos_stmt_init(tsMonitor.conn);
+  if (stmt == NULL) {
+    monError("failed to init stmt to save metrics, reason:%s", tstrerror(terrno));
+    return;
+  }
+
+  char sql[128] = {0};
+  snprintf(sql, sizeof(sql), "insert into ? using %s.metrics tags(?, ?) values(?, ?, ?, ?, ?, ?, ?)", tsMonitorDbName);
+  int32_t code = taos_stmt_prepare(stmt, sql, 0);
+
+  SMetricsHistogram hist = {0};
+  for (int32_t i = 0; code == 0 && i < TSDB_METRIC_COUNTER_MAX; ++i) {
+    hist.sum = taosMetricsGetCounter(i);
+    code = monBindMetric(stmt, ts, taosMetricsCounterName(i), &hist, false);
+  }
+
+  for (int32_t i = 0; code == 0 && i < TSDB_METRIC_GAUGE_MAX; ++i) {
+    hist.sum = taosMetricsGetGauge(i);
+    code = monBindMetric(stmt, ts, taosMetricsGaugeName(i), &hist, false);
+  }
+
+  for (int32_t i = 0; code == 0 && i < TSDB_METRIC_HISTOGRAM_MAX; ++i) {
+    taosMetricsGetHistogram(i, &hist);
+    code = monBindMetric(stmt, ts, taosMetricsHistogramName(i), &hist, true);
+  }
+
+  if (code == 0) code = taos_stmt_execute(stmt);
+
+  if (code != 0) {
+    monError("failed to save metrics, reason:%s", taos_stmt_errstr(stmt));
+  } else {
+    monDebug("successfully to save metrics");
+  }
+
+  taos_stmt_close(stmt);
+}
+
 static void monExecSqlCb(void *param, TAOS_RES *result, int32_t code) {
   int32_t c = taos_errno(result);
   if (c != TSDB_CODE_SUCCESS) {
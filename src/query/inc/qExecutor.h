@@ -393,6 +393,7 @@ typedef struct SQInfo {
   int64_t          startExecTs; // start to exec timestamp
   char*            sql;         // query sql string
   SQueryCostInfo   summary;
+  char             user[TSDB_USER_LEN];  // user of the query, counted in the running queries of the user
 } SQInfo;
 
 typedef struct SQueryParam {
@@ -402,6 +403,7 @@ typedef struct SQueryParam {
   char            *tbnameCond;
   char            *prevResult;
   SArray          *pTableIdList;
+  SArray          *pJoinTableList;  // join partner of each table in pTableIdList, merge joined in vnode
   SSqlExpr       **pExpr;
   SSqlExpr       **pSecExpr;
   SExprInfo       *pExprs;
@@ -577,7 +579,10 @@ typedef struct SMultiwayMergeInfo {
 typedef struct SOrderOperatorInfo {
   int32_t      colIndex;
   int32_t      order;
+  int64_t      limit;        // only the first limit rows are kept, -1 if all rows are required
+  int32_t      rowIndex;     // the first sorted row that has not been returned yet
   SSDataBlock *pDataBlock;
+  SSDataBlock *pRes;         // returns the sorted rows in blocks of the output capacity when limit is set
 } SOrderOperatorInfo;
 
 void appendUpstream(SOperatorInfo* p, SOperatorInfo* pUpstream);
@@ -609,7 +614,7 @@ SOperatorInfo* createFilterOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperator
                                         int32_t numOfOutput, SColumnInfo* pCols, int32_t numOfFilter);
 
 SOperatorInfo* createJoinOperatorInfo(SOperatorInfo** pUpstream, int32_t numOfUpstream, SSchema* pSchema, int32_t numOfOutput);
-SOperatorInfo* createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput, SOrderVal* pOrderVal);
+SOperatorInfo* createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput, SOrderVal* pOrderVal, int64_t limit);
 
 SSDataBlock* doGlobalAggregate(void* param, bool* newgroup);
 SSDataBlock* doMultiwayMergeSort(void* param, bool* newgroup);
@@ -659,11 +664,14 @@ int32_t buildArithmeticExprFromMsg(SExprInfo *pArithExprInfo, void *pQueryMsg);
 
 bool isQueryKilled(SQInfo *pQInfo);
 int32_t checkForQueryBuf(size_t numOfTables);
+int32_t checkForUserQuota(const char* user);
+void    releaseUserQuota(const char* user);
 bool checkNeedToCompressQueryCol(SQInfo *pQInfo);
 bool doBuildResCheck(SQInfo* pQInfo);
 void setQueryStatus(SQueryRuntimeEnv *pRuntimeEnv, int8_t status);
 
 bool onlyQueryTags(SQueryAttr* pQueryAttr);
+bool isOrderedPrjLimitQuery(SQueryAttr* pQueryAttr);
 void destroyUdfInfo(SUdfInfo* pUdfInfo);
 
 bool isValidQInfo(void *param);
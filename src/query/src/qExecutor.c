@@ -2301,7 +2301,8 @@ static int32_t setupQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv, int32_t numOf
       }
 
       case OP_Order: {
-        pRuntimeEnv->proot = createOrderOperatorInfo(pRuntimeEnv, pRuntimeEnv->proot, pQueryAttr->pExpr1, pQueryAttr->numOfOutput, &pQueryAttr->order);
+        int64_t limit = isOrderedPrjLimitQuery(pQueryAttr)? pQueryAttr->prjInfo.vgroupLimit:-1;
+        pRuntimeEnv->proot = createOrderOperatorInfo(pRuntimeEnv, pRuntimeEnv->proot, pQueryAttr->pExpr1, pQueryAttr->numOfOutput, &pQueryAttr->order, limit);
         break;
       }
 
@@ -2414,6 +2415,30 @@ bool isQueryKilled(SQInfo *pQInfo) {
   return false;
 }
 
+static bool isQueryKilledFp(void* param) {
+  return isQueryKilled((SQInfo*) param);
+}
+
+// result rows, their hash table and result pages, including the pages flushed to disk, are counted
+static bool isQueryBufExceeded(SQueryRuntimeEnv* pRuntimeEnv) {
+  if (tsMaxQueryMemory <= 0) {
+    return false;
+  }
+
+  int64_t size = getResultRowPoolMemSize(pRuntimeEnv->pool) + taosHashGetMemSize(pRuntimeEnv->pResultRowHashTable);
+  if (pRuntimeEnv->pResultBuf != NULL) {
+    size += getResBufSize(pRuntimeEnv->pResultBuf);
+  }
+
+  if (size <= (int64_t)tsMaxQueryMemory * 1048576) {
+    return false;
+  }
+
+  qError("QInfo:0x%"PRIx64" query buffer size:%"PRId64" exceeds limit:%dMB, abort", GET_QID(pRuntimeEnv), size,
+         tsMaxQueryMemory);
+  return true;
+}
+
 void setQueryKilled(SQInfo *pQInfo) { pQInfo->code = TSDB_CODE_TSC_QUERY_CANCELLED;}
 
 //static bool isFixedOutputQuery(SQueryAttr* pQueryAttr) {
@@ -2516,6 +2541,31 @@ bool onlyQueryTags(SQueryAttr* pQueryAttr) {
   return true;
 }
 
+/*
+ * super table projection ordered by the timestamp with limit clause, the client only needs the first
+ * vgroupLimit rows of each vnode in timestamp order.
+ */
+bool isOrderedPrjLimitQuery(SQueryAttr* pQueryAttr) {
+  if (!pQueryAttr->stableQuery || pQueryAttr->prjInfo.vgroupLimit <= 0 ||
+      pQueryAttr->prjInfo.vgroupLimit > TSDB_MAX_ORDERED_PRJ_LIMIT || pQueryAttr->distinct ||
+      pQueryAttr->order.orderColId != PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+    return false;
+  }
+
+  if (pQueryAttr->pGroupbyExpr != NULL && pQueryAttr->pGroupbyExpr->numOfGroupCols > 0) {
+    return false;
+  }
+
+  for(int32_t i = 0; i < pQueryAttr->numOfOutput; ++i) {
+    SExprInfo* pExprInfo = &pQueryAttr->pExpr1[i];
+    if (pExprInfo->base.functionId == TSDB_FUNC_PRJ && pExprInfo->base.colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 void getAlignQueryTimeWindow(SQueryAttr *pQueryAttr, int64_t key, int64_t keyFirst, int64_t keyLast, STimeWindow *win) {
@@ -2809,6 +2859,12 @@ static int32_t doTSJoinFilter(SQueryRuntimeEnv *pRuntimeEnv, TSKEY key, bool asc
          pRuntimeEnv->pTsBuf->cur.order, pRuntimeEnv->pTsBuf->cur.tsIndex);
 #endif
 
+  // the timestamps of current table are exhausted, the cursor has moved into the block of the next tag
+  if (pRuntimeEnv->pQueryAttr->stableQuery &&
+      (!tsBufIsValidElem(&elem) || tVariantCompare(elem.tag, &pRuntimeEnv->current->tag) != 0)) {
+    return TS_JOIN_TAG_NOT_EQUALS;
+  }
+
   if (ascQuery) {
     if (key < elem.ts) {
       return TS_JOIN_TS_NOT_EQUALS;
@@ -2940,6 +2996,7 @@ void filterRowsInDataBlock(SQueryRuntimeEnv* pRuntimeEnv, SSingleColumnFilterInf
       int32_t offset = ascQuery? i:(numOfRows - i - 1);
       int32_t ret = doTSJoinFilter(pRuntimeEnv, k[offset], ascQuery);
       if (ret == TS_JOIN_TAG_NOT_EQUALS) {
+        all = false;
         break;
       } else if (ret == TS_JOIN_TS_NOT_EQUALS) {
         all = false;
@@ -2950,6 +3007,7 @@ void filterRowsInDataBlock(SQueryRuntimeEnv* pRuntimeEnv, SSingleColumnFilterInf
       }
 
       if (!tsBufNextPos(pRuntimeEnv->pTsBuf)) {
+        all = all && (i == numOfRows - 1);
         break;
       }
     }
@@ -2982,6 +3040,7 @@ void filterColRowsInDataBlock(SQueryRuntimeEnv* pRuntimeEnv, SSDataBlock* pBlock
      int32_t offset = ascQuery? i:(numOfRows - i - 1);
      int32_t ret = doTSJoinFilter(pRuntimeEnv, k[offset], ascQuery);
      if (ret == TS_JOIN_TAG_NOT_EQUALS) {
+       all = false;
        break;
      } else if (ret == TS_JOIN_TS_NOT_EQUALS) {
        all = false;
@@ -2992,6 +3051,7 @@ void filterColRowsInDataBlock(SQueryRuntimeEnv* pRuntimeEnv, SSDataBlock* pBlock
      }
 
      if (!tsBufNextPos(pRuntimeEnv->pTsBuf)) {
+       all = all && (i == numOfRows - 1);
        break;
      }
    }
@@ -3057,6 +3117,20 @@ void doSetFilterColumnInfo(SSingleColumnFilterInfo* pFilterInfo, int32_t numOfFi
   }
 }
 
+// A table whose timestamps were all consumed by its previous blocks restarts from the first timestamp of its tag,
+// move the cursor beyond the timestamps that precede current data block.
+static void skipConsumedJoinKeys(SQueryRuntimeEnv* pRuntimeEnv, tVariant* pTag, STimeWindow* pWin, bool ascQuery) {
+  STSElem elem = tsBufGetElem(pRuntimeEnv->pTsBuf);
+  while (tsBufIsValidElem(&elem) && tVariantCompare(elem.tag, pTag) == 0 &&
+         (ascQuery ? (elem.ts < pWin->skey) : (elem.ts > pWin->ekey))) {
+    if (!tsBufNextPos(pRuntimeEnv->pTsBuf)) {
+      break;
+    }
+
+    elem = tsBufGetElem(pRuntimeEnv->pTsBuf);
+  }
+}
+
 int32_t loadDataBlockOnDemand(SQueryRuntimeEnv* pRuntimeEnv, STableScanInfo* pTableScanInfo, SSDataBlock* pBlock,
                               uint32_t* status) {
   *status = BLK_DATA_NO_NEEDED;
@@ -3085,6 +3159,7 @@ int32_t loadDataBlockOnDemand(SQueryRuntimeEnv* pRuntimeEnv, STableScanInfo* pTa
       tVariant t = {0};
       doSetTagValueInParam(pRuntimeEnv->current->pTable, tagId, &t, pColInfo->type, pColInfo->bytes);
       setTimestampListJoinInfo(pRuntimeEnv, &t, pRuntimeEnv->current);
+      skipConsumedJoinKeys(pRuntimeEnv, &t, &pBlock->info.window, ascQuery);
 
       STSElem elem = tsBufGetElem(pRuntimeEnv->pTsBuf);
       if (!tsBufIsValidElem(&elem) || (tsBufIsValidElem(&elem) && (tVariantCompare(&t, elem.tag) != 0))) {
@@ -4776,6 +4851,7 @@ static int32_t setupQueryHandle(void* tsdb, SQueryRuntimeEnv* pRuntimeEnv, int64
     pRuntimeEnv->pQueryHandle = tsdbQueryTables(tsdb, &cond, &pQueryAttr->tableGroupInfo, qId, &pQueryAttr->memRef);
   }
 
+  tsdbSetQueryKilledFp(pRuntimeEnv->pQueryHandle, isQueryKilledFp, pRuntimeEnv->qinfo);
   return terrno;
 }
 
@@ -4917,6 +4993,16 @@ STsdbQueryCond createTsdbQueryCond(SQueryAttr* pQueryAttr, STimeWindow* win) {
       .loadExternalRows = false,
   };
 
+  // buckets of rollup tiers are returned as data blocks of their own, which every window either covers or misses
+  SInterval* pInterval = &pQueryAttr->interval;
+  if (QUERY_IS_INTERVAL_QUERY(pQueryAttr) && pQueryAttr->pFilters == NULL && pQueryAttr->numOfFilterCols == 0 &&
+      !pQueryAttr->pointInterpQuery && !pQueryAttr->groupbyColumn && !pQueryAttr->timeWindowInterpo &&
+      pInterval->sliding == pInterval->interval && pInterval->offset == 0 && pInterval->intervalUnit != 'n' &&
+      pInterval->intervalUnit != 'y') {
+    cond.rollupInterval = pInterval->interval;
+    cond.rollupIntervalUnit = pInterval->intervalUnit;
+  }
+
   TIME_WINDOW_COPY(cond.twindow, *win);
   return cond;
 }
@@ -4979,6 +5065,10 @@ static SSDataBlock* doTableScanImpl(void* param, bool* newgroup) {
       longjmp(pOperator->pRuntimeEnv->env, TSDB_CODE_TSC_QUERY_CANCELLED);
     }
 
+    if (isQueryBufExceeded(pRuntimeEnv)) {
+      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_NOT_ENOUGH_BUFFER);
+    }
+
     pTableScanInfo->numOfBlocks += 1;
     tsdbRetrieveDataBlockInfo(pTableScanInfo->pQueryHandle, &pBlock->info);
 
@@ -5017,6 +5107,11 @@ static SSDataBlock* doTableScanImpl(void* param, bool* newgroup) {
     return pBlock;
   }
 
+  // the scan in tsdb stops early once the query is killed
+  if (isQueryKilled(pRuntimeEnv->qinfo)) {
+    longjmp(pRuntimeEnv->env, TSDB_CODE_TSC_QUERY_CANCELLED);
+  }
+
   return NULL;
 }
 
@@ -5510,6 +5605,54 @@ static int32_t doMergeSDatablock(SSDataBlock* pDest, SSDataBlock* pSrc) {
   return TSDB_CODE_SUCCESS;
 }
 
+static void doSortDataBlock(SOrderOperatorInfo* pInfo) {
+  // e.g. no rows of the tables in the vnode are in the time range
+  if (pInfo->pDataBlock->info.rows == 0) {
+    return;
+  }
+
+  int32_t numOfCols = pInfo->pDataBlock->info.numOfCols;
+  void** pCols     = calloc(numOfCols, POINTER_BYTES);
+  SSchema* pSchema = calloc(numOfCols, sizeof(SSchema));
+
+  for(int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* p1 = taosArrayGet(pInfo->pDataBlock->pDataBlock, i);
+    pCols[i] = p1->pData;
+    pSchema[i].colId = p1->info.colId;
+    pSchema[i].bytes = p1->info.bytes;
+    pSchema[i].type  = (uint8_t) p1->info.type;
+  }
+
+  __compar_fn_t  comp = getKeyComparFunc(pSchema[pInfo->colIndex].type, pInfo->order);
+  taoscQSort(pCols, pSchema, numOfCols, pInfo->pDataBlock->info.rows, pInfo->colIndex, comp);
+
+  tfree(pCols);
+  tfree(pSchema);
+}
+
+// copy the next sorted rows into the result block, no more than its capacity
+static SSDataBlock* doReturnSortedRows(SOperatorInfo* pOperator) {
+  SOrderOperatorInfo* pInfo = pOperator->info;
+
+  int32_t capacity = (int32_t) pOperator->pRuntimeEnv->resultInfo.capacity;
+  int32_t rows = MIN(capacity, pInfo->pDataBlock->info.rows - pInfo->rowIndex);
+
+  for(int32_t i = 0; i < pInfo->pDataBlock->info.numOfCols; ++i) {
+    SColumnInfoData* pSrc = taosArrayGet(pInfo->pDataBlock->pDataBlock, i);
+    SColumnInfoData* pDst = taosArrayGet(pInfo->pRes->pDataBlock, i);
+    memcpy(pDst->pData, pSrc->pData + pSrc->info.bytes * pInfo->rowIndex, pSrc->info.bytes * rows);
+  }
+
+  pInfo->rowIndex += rows;
+  pInfo->pRes->info.rows = rows;
+
+  if (pInfo->rowIndex >= pInfo->pDataBlock->info.rows) {
+    doSetOperatorCompleted(pOperator);
+  }
+
+  return (rows > 0)? pInfo->pRes:NULL;
+}
+
 static SSDataBlock* doSort(void* param, bool* newgroup) {
   SOperatorInfo* pOperator = (SOperatorInfo*) param;
   if (pOperator->status == OP_EXEC_DONE) {
@@ -5518,6 +5661,11 @@ static SSDataBlock* doSort(void* param, bool* newgroup) {
 
   SOrderOperatorInfo* pInfo = pOperator->info;
 
+  // the sorted rows are being returned block by block
+  if (pInfo->pRes != NULL && pInfo->rowIndex > 0) {
+    return doReturnSortedRows(pOperator);
+  }
+
   SSDataBlock* pBlock = NULL;
   while(1) {
     publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
@@ -5534,29 +5682,26 @@ static SSDataBlock* doSort(void* param, bool* newgroup) {
     if (code != TSDB_CODE_SUCCESS) {
       // todo handle error
     }
+
+    // only the first limit rows are required, discard the others once twice as many rows are buffered
+    if (pInfo->limit > 0 && pInfo->pDataBlock->info.rows >= pInfo->limit * 2) {
+      doSortDataBlock(pInfo);
+      pInfo->pDataBlock->info.rows = (int32_t) pInfo->limit;
+    }
   }
 
-  int32_t numOfCols = pInfo->pDataBlock->info.numOfCols;
-  void** pCols     = calloc(numOfCols, POINTER_BYTES);
-  SSchema* pSchema = calloc(numOfCols, sizeof(SSchema));
+  doSortDataBlock(pInfo);
 
-  for(int32_t i = 0; i < numOfCols; ++i) {
-    SColumnInfoData* p1 = taosArrayGet(pInfo->pDataBlock->pDataBlock, i);
-    pCols[i] = p1->pData;
-    pSchema[i].colId = p1->info.colId;
-    pSchema[i].bytes = p1->info.bytes;
-    pSchema[i].type  = (uint8_t) p1->info.type;
+  if (pInfo->limit > 0) {
+    pInfo->pDataBlock->info.rows = (int32_t) MIN(pInfo->pDataBlock->info.rows, pInfo->limit);
+    pOperator->status = OP_IN_EXECUTING;
+    return doReturnSortedRows(pOperator);
   }
 
-  __compar_fn_t  comp = getKeyComparFunc(pSchema[pInfo->colIndex].type, pInfo->order);
-  taoscQSort(pCols, pSchema, numOfCols, pInfo->pDataBlock->info.rows, pInfo->colIndex, comp);
-
-  tfree(pCols);
-  tfree(pSchema);
   return (pInfo->pDataBlock->info.rows > 0)? pInfo->pDataBlock:NULL;
 }
 
-SOperatorInfo *createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput, SOrderVal* pOrderVal) {
+SOperatorInfo *createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput, SOrderVal* pOrderVal, int64_t limit) {
   SOrderOperatorInfo* pInfo = calloc(1, sizeof(SOrderOperatorInfo));
 
   {
@@ -5565,11 +5710,12 @@ SOperatorInfo *createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorI
       for(int32_t i = 0; i < numOfOutput; ++i) {
         SColumnInfoData col = {{0}};
         col.info.colId = pExpr[i].base.colInfo.colId;
-        col.info.bytes = pExpr[i].base.colBytes;
-        col.info.type  = pExpr[i].base.colType;
+        col.info.bytes = pExpr[i].base.resBytes;
+        col.info.type  = pExpr[i].base.resType;
         taosArrayPush(pDataBlock->pDataBlock, &col);
 
-        if (col.info.colId == pOrderVal->orderColId) {
+        // an arithmetic expression may carry the column id of its operand
+        if (col.info.colId == pOrderVal->orderColId && pExpr[i].base.functionId == TSDB_FUNC_PRJ) {
           pInfo->colIndex = i;
         }
       }
@@ -5579,6 +5725,11 @@ SOperatorInfo *createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorI
       pInfo->pDataBlock = pDataBlock;
   }
 
+  pInfo->limit = limit;
+  if (limit > 0) {
+    pInfo->pRes = createOutputBuf(pExpr, numOfOutput, (int32_t) pRuntimeEnv->resultInfo.capacity);
+  }
+
   SOperatorInfo* pOperator = calloc(1, sizeof(SOperatorInfo));
   pOperator->name          = "InMemoryOrder";
   pOperator->operatorType  = OP_Order;
@@ -6613,6 +6764,7 @@ static void destroyTagScanOperatorInfo(void* param, int32_t numOfOutput) {
 static void destroyOrderOperatorInfo(void* param, int32_t numOfOutput) {
   SOrderOperatorInfo* pInfo = (SOrderOperatorInfo*) param;
   pInfo->pDataBlock = destroyOutputBuf(pInfo->pDataBlock);
+  pInfo->pRes = destroyOutputBuf(pInfo->pRes);
 }
 
 static void destroyConditionOperatorInfo(void* param, int32_t numOfOutput) {
@@ -7420,12 +7572,12 @@ static bool validateQueryTableCols(SQueriedTableInfo* pTableInfo, SSqlExpr** pEx
   return true;
 }
 
-static char *createTableIdList(SQueryTableMsg *pQueryMsg, char *pMsg, SArray **pTableIdList) {
-  assert(pQueryMsg->numOfTables > 0);
+static char *createTableIdList(int32_t numOfTables, char *pMsg, SArray **pTableIdList) {
+  assert(numOfTables > 0);
 
-  *pTableIdList = taosArrayInit(pQueryMsg->numOfTables, sizeof(STableIdInfo));
+  *pTableIdList = taosArrayInit(numOfTables, sizeof(STableIdInfo));
 
-  for (int32_t j = 0; j < pQueryMsg->numOfTables; ++j) {
+  for (int32_t j = 0; j < numOfTables; ++j) {
     STableIdInfo* pTableIdInfo = (STableIdInfo *)pMsg;
 
     pTableIdInfo->tid = htonl(pTableIdInfo->tid);
@@ -7524,6 +7676,7 @@ int32_t convertQueryMsg(SQueryTableMsg *pQueryMsg, SQueryParam* param) {
   pQueryMsg->udfContentOffset = htonl(pQueryMsg->udfContentOffset);
   pQueryMsg->udfContentLen    = htonl(pQueryMsg->udfContentLen);
   pQueryMsg->udfNum           = htonl(pQueryMsg->udfNum);
+  pQueryMsg->numOfJoinTables  = htonl(pQueryMsg->numOfJoinTables);
 
   // query msg safety check
   if (!validateQueryMsg(pQueryMsg)) {
@@ -7675,7 +7828,16 @@ int32_t convertQueryMsg(SQueryTableMsg *pQueryMsg, SQueryParam* param) {
     }
   }
 
-  pMsg = createTableIdList(pQueryMsg, pMsg, &(param->pTableIdList));
+  pMsg = createTableIdList(pQueryMsg->numOfTables, pMsg, &(param->pTableIdList));
+
+  if (pQueryMsg->numOfJoinTables > 0) {
+    if (pQueryMsg->numOfJoinTables != pQueryMsg->numOfTables) {
+      code = TSDB_CODE_QRY_INVALID_MSG;
+      goto _cleanup;
+    }
+
+    pMsg = createTableIdList(pQueryMsg->numOfJoinTables, pMsg, &(param->pJoinTableList));
+  }
 
   if (pQueryMsg->numOfGroupCols > 0) {  // group by tag columns
     param->pGroupColIndex = malloc(pQueryMsg->numOfGroupCols * sizeof(SColIndex));
@@ -8624,6 +8786,160 @@ bool isValidQInfo(void *param) {
   return (sig == (uint64_t)pQInfo);
 }
 
+// load the primary timestamps of one table within the query time window, in the query order
+static int32_t doLoadTableKeys(void* tsdb, STableIdInfo* pId, STsdbQueryCond* pCond, uint64_t qId, SArray* pKeys) {
+  taosArrayClear(pKeys);
+
+  // the keys are always loaded in ascending order, starting from the beginning of the query window
+  STableIdInfo id = {.uid = pId->uid, .tid = pId->tid, .key = pCond->twindow.skey};
+
+  SArray* pIdList = taosArrayInit(1, sizeof(STableIdInfo));
+  taosArrayPush(pIdList, &id);
+
+  STableGroupInfo groupInfo = {0};
+  int32_t code = tsdbGetTableGroupFromIdList(tsdb, pIdList, &groupInfo);
+  taosArrayDestroy(pIdList);
+
+  if (code != TSDB_CODE_SUCCESS || groupInfo.numOfTables == 0) {  // the table has been dropped already
+    tsdbDestroyTableGroup(&groupInfo);
+    return code;
+  }
+
+  SMemRef memRef = {0};
+  terrno = TSDB_CODE_SUCCESS;
+
+  TsdbQueryHandleT pQueryHandle = tsdbQueryTables(tsdb, pCond, &groupInfo, qId, &memRef);
+  if (pQueryHandle == NULL) {
+    tsdbDestroyTableGroup(&groupInfo);
+    return terrno;
+  }
+
+  while (tsdbNextDataBlock(pQueryHandle)) {
+    SDataBlockInfo blockInfo = SDATA_BLOCK_INITIALIZER;
+    tsdbRetrieveDataBlockInfo(pQueryHandle, &blockInfo);
+
+    SArray* pDataBlock = tsdbRetrieveDataBlock(pQueryHandle, NULL);
+    if (pDataBlock == NULL) {
+      code = terrno;
+      break;
+    }
+
+    SColumnInfoData* pColInfoData = taosArrayGet(pDataBlock, 0);
+    assert(pColInfoData->info.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
+    taosArrayAddBatch(pKeys, pColInfoData->pData, blockInfo.rows);
+  }
+
+  if (code == TSDB_CODE_SUCCESS && terrno != TSDB_CODE_SUCCESS) {
+    code = terrno;
+  }
+
+  tsdbCleanupQueryHandle(pQueryHandle);
+  tsdbDestroyTableGroup(&groupInfo);
+  return code;
+}
+
+/*
+ * Both tables of every joined pair are kept in this vnode, so the timestamps of each pair are merge joined here, instead
+ * of being shipped to the client by a ts_comp query and sent back after the intersection.
+ */
+static STSBuf* createJoinTsBuf(SQInfo* pQInfo, void* tsdb, SArray* pTableIdList, SArray* pJoinTableList) {
+  SQueryRuntimeEnv* pRuntimeEnv = &pQInfo->runtimeEnv;
+  SQueryAttr*       pQueryAttr = pRuntimeEnv->pQueryAttr;
+
+  int16_t      tagId = (int16_t)pQueryAttr->pExpr1[0].base.param[0].i64;
+  SColumnInfo* pColInfo = (pQueryAttr->numOfTags > 0)? doGetTagColumnInfoById(pQueryAttr->tagColList, pQueryAttr->numOfTags, tagId):NULL;
+  if (pColInfo == NULL) {
+    terrno = TSDB_CODE_QRY_INVALID_MSG;
+    return NULL;
+  }
+
+  // only the primary timestamp column is required, kept in ascending order like the ts_comp result of client
+  STimeWindow    win = {.skey = MIN(pQueryAttr->window.skey, pQueryAttr->window.ekey),
+                        .ekey = MAX(pQueryAttr->window.skey, pQueryAttr->window.ekey)};
+  STsdbQueryCond cond = createTsdbQueryCond(pQueryAttr, &win);
+  cond.numOfCols = 1;
+  cond.order = TSDB_ORDER_ASC;
+
+  STSBuf* pTsBuf = tsBufCreate(true, TSDB_ORDER_ASC);
+  if (pTsBuf == NULL) {
+    terrno = TSDB_CODE_QRY_NO_DISKSPACE;
+    return NULL;
+  }
+
+  SArray* pKeys = taosArrayInit(4096, sizeof(TSKEY));
+  SArray* pJoinKeys = taosArrayInit(4096, sizeof(TSKEY));
+  int32_t code = TSDB_CODE_SUCCESS;
+  int64_t total = 0;
+
+  size_t numOfTables = taosArrayGetSize(pTableIdList);
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    if (isQueryKilled(pQInfo)) {
+      code = TSDB_CODE_TSC_QUERY_CANCELLED;
+      break;
+    }
+
+    STableIdInfo*     pId = taosArrayGet(pTableIdList, i);
+    STableQueryInfo** pTableQueryInfo = taosHashGet(pRuntimeEnv->tableqinfoGroupInfo.map, &pId->tid, sizeof(pId->tid));
+    if (pTableQueryInfo == NULL) {
+      continue;
+    }
+
+    if ((code = doLoadTableKeys(tsdb, pId, &cond, pQInfo->qId, pKeys)) != TSDB_CODE_SUCCESS ||
+        (code = doLoadTableKeys(tsdb, taosArrayGet(pJoinTableList, i), &cond, pQInfo->qId, pJoinKeys)) != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    // keep the common timestamps of both ascending lists in place
+    TSKEY*  k1 = pKeys->pData;
+    TSKEY*  k2 = pJoinKeys->pData;
+    size_t  n1 = taosArrayGetSize(pKeys);
+    size_t  n2 = taosArrayGetSize(pJoinKeys);
+    int32_t num = 0;
+
+    for (size_t p1 = 0, p2 = 0; p1 < n1 && p2 < n2;) {
+      if (k1[p1] == k2[p2]) {
+        k1[num++] = k1[p1];
+        p1 += 1;
+        p2 += 1;
+      } else if (k1[p1] < k2[p2]) {
+        p1 += 1;
+      } else {
+        p2 += 1;
+      }
+    }
+
+    if (num == 0) {
+      continue;
+    }
+
+    tVariant t = {0};
+    doSetTagValueInParam((*pTableQueryInfo)->pTable, tagId, &t, pColInfo->type, pColInfo->bytes);
+
+    // the first key starts a new tag block, the remains are appended into the same block
+    tsBufAppend(pTsBuf, pQueryAttr->vgId, &t, (const char*)k1, TSDB_KEYSIZE);
+    if (num > 1) {
+      tsBufAppend(pTsBuf, pQueryAttr->vgId, &t, (const char*)(k1 + 1), (num - 1) * TSDB_KEYSIZE);
+    }
+
+    tVariantDestroy(&t);
+    total += num;
+  }
+
+  taosArrayDestroy(pKeys);
+  taosArrayDestroy(pJoinKeys);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tsBufDestroy(pTsBuf);
+    terrno = code;
+    return NULL;
+  }
+
+  tsBufFlush(pTsBuf);
+  qDebug("QInfo:0x%"PRIx64" join timestamps of %d table pairs merged in vnode, %"PRId64" qualified", pQInfo->qId,
+         (int32_t)numOfTables, total);
+  return pTsBuf;
+}
+
 int32_t initQInfo(STsBufInfo* pTsBufInfo, void* tsdb, void* sourceOptr, SQInfo* pQInfo, SQueryParam* param, char* start,
                   int32_t prevResultLen, void* merger) {
   int32_t code = TSDB_CODE_SUCCESS;
@@ -8644,6 +8960,16 @@ int32_t initQInfo(STsBufInfo* pTsBufInfo, void* tsdb, void* sourceOptr, SQInfo*
       code = TSDB_CODE_QRY_NO_DISKSPACE;
       goto _error;
     }
+    tsBufResetPos(pTsBuf);
+    bool ret = tsBufNextPos(pTsBuf);
+    UNUSED(ret);
+  } else if (param->pJoinTableList != NULL && pRuntimeEnv->tableqinfoGroupInfo.numOfTables > 0) {
+    pTsBuf = createJoinTsBuf(pQInfo, tsdb, param->pTableIdList, param->pJoinTableList);
+    if (pTsBuf == NULL) {
+      code = terrno;
+      goto _error;
+    }
+
     tsBufResetPos(pTsBuf);
     bool ret = tsBufNextPos(pTsBuf);
     UNUSED(ret);
@@ -8775,6 +9101,7 @@ void freeQInfo(SQInfo *pQInfo) {
 
   SQueryRuntimeEnv* pRuntimeEnv = &pQInfo->runtimeEnv;
   releaseQueryBuf(pRuntimeEnv->tableqinfoGroupInfo.numOfTables);
+  releaseUserQuota(pQInfo->user);
 
   doDestroyTableQueryInfo(&pRuntimeEnv->tableqinfoGroupInfo);
   teardownQueryRuntimeEnv(&pQInfo->runtimeEnv);
@@ -8962,6 +9289,67 @@ void releaseQueryBuf(size_t numOfTables) {
   atomic_add_fetch_64(&tsQueryBufferSizeBytes, t);
 }
 
+static pthread_once_t  userQuotaInit = PTHREAD_ONCE_INIT;
+static pthread_mutex_t userQuotaLock;
+static SHashObj*       userQueries = NULL;  // user -> number of running queries of the user on this data node
+
+static void initUserQuota() {
+  pthread_mutex_init(&userQuotaLock, NULL);
+  userQueries = taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+}
+
+// running queries are always counted, so that the limit can be changed at any time
+int32_t checkForUserQuota(const char* user) {
+  if (user == NULL || user[0] == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  pthread_once(&userQuotaInit, initUserQuota);
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  size_t  len = strnlen(user, TSDB_USER_LEN);
+
+  pthread_mutex_lock(&userQuotaLock);
+
+  int32_t* p = taosHashGet(userQueries, user, len);
+  int32_t  num = (p == NULL) ? 0 : *p;
+  if (tsMaxQueriesPerUser > 0 && num >= tsMaxQueriesPerUser) {
+    code = TSDB_CODE_QRY_TOO_MANY_QUERIES;
+  } else {
+    num += 1;
+    taosHashPut(userQueries, user, len, &num, sizeof(num));
+  }
+
+  pthread_mutex_unlock(&userQuotaLock);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    qWarn("user:%s has %d running queries, exceeds limit:%d", user, num, tsMaxQueriesPerUser);
+  }
+
+  return code;
+}
+
+void releaseUserQuota(const char* user) {
+  if (user == NULL || user[0] == 0) {
+    return;
+  }
+
+  size_t len = strnlen(user, TSDB_USER_LEN);
+
+  pthread_mutex_lock(&userQuotaLock);
+
+  int32_t* p = taosHashGet(userQueries, user, len);
+  if (p != NULL) {
+    if (*p <= 1) {
+      taosHashRemove(userQueries, user, len);
+    } else {
+      *p -= 1;
+    }
+  }
+
+  pthread_mutex_unlock(&userQuotaLock);
+}
+
 void freeQueryAttr(SQueryAttr* pQueryAttr) {
   if (pQueryAttr != NULL) {
     if (pQueryAttr->fillVal != NULL) {
@@ -656,6 +656,10 @@ SArray* createExecOperatorPlan(SQueryAttr* pQueryAttr) {
     if (pQueryAttr->vgId == 0 && orderColId != PRIMARYKEY_TIMESTAMP_COL_INDEX && orderColId != INT32_MIN) {
       op = OP_Order;
       taosArrayPush(plan, &op);
+    } else if (isOrderedPrjLimitQuery(pQueryAttr)) {
+      // each vnode sends its first vgroupLimit rows in timestamp order, the client merges them as sorted runs
+      op = OP_Order;
+      taosArrayPush(plan, &op);
     }
   }
 
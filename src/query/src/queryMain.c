@@ -55,6 +55,7 @@ void freeParam(SQueryParam *param) {
   tfree(param->tagCond);
   tfree(param->tbnameCond);
   tfree(param->pTableIdList);
+  param->pJoinTableList = taosArrayDestroy(param->pJoinTableList);
   taosArrayDestroy(param->pOperator);
   tfree(param->pExprs);
   tfree(param->pSecExprs);
@@ -68,7 +69,8 @@ void freeParam(SQueryParam *param) {
   tfree(param->prevResult);
 }
 
-int32_t qCreateQueryInfo(void* tsdb, int32_t vgId, SQueryTableMsg* pQueryMsg, qinfo_t* pQInfo, uint64_t qId) {
+int32_t qCreateQueryInfo(void* tsdb, int32_t vgId, SQueryTableMsg* pQueryMsg, qinfo_t* pQInfo, uint64_t qId,
+                         const char* user) {
   assert(pQueryMsg != NULL && tsdb != NULL);
 
   int32_t code = TSDB_CODE_SUCCESS;
@@ -161,8 +163,14 @@ int32_t qCreateQueryInfo(void* tsdb, int32_t vgId, SQueryTableMsg* pQueryMsg, qi
     assert(0);
   }
 
+  code = checkForUserQuota(user);
+  if (code != TSDB_CODE_SUCCESS) {  // too many running queries of this user, abort
+    goto _over;
+  }
+
   code = checkForQueryBuf(tableGroupInfo.numOfTables);
   if (code != TSDB_CODE_SUCCESS) {  // not enough query buffer, abort
+    releaseUserQuota(user);
     goto _over;
   }
 
@@ -178,11 +186,17 @@ int32_t qCreateQueryInfo(void* tsdb, int32_t vgId, SQueryTableMsg* pQueryMsg, qi
   param.pFilters = NULL;
 
   if ((*pQInfo) == NULL) {
+    releaseUserQuota(user);
     code = TSDB_CODE_QRY_OUT_OF_MEMORY;
     goto _over;
   }
   param.pUdfInfo = NULL;
 
+  // released along with the query info
+  if (user != NULL) {
+    tstrncpy(((SQInfo*)(*pQInfo))->user, user, sizeof(((SQInfo*)(*pQInfo))->user));
+  }
+
   code = initQInfo(&pQueryMsg->tsBuf, tsdb, NULL, *pQInfo, &param, (char*)pQueryMsg, pQueryMsg->prevResultLen, NULL);
 
   _over:
@@ -21,6 +21,7 @@
 #include "tutil.h"
 #include "lz4.h"
 #include "tref.h"
+#include "tmetrics.h"
 #include "taoserror.h"
 #include "tsocket.h"
 #include "tglobal.h"
@@ -405,8 +406,8 @@ void rpcSendRequest(void *shandle, const SRpcEpSet *pEpSet, SRpcMsg *pMsg, int64
   // for TDengine, all the query, show commands shall have TCP connection
   char type = pMsg->msgType;
   if (type == TSDB_MSG_TYPE_QUERY || type == TSDB_MSG_TYPE_CM_RETRIEVE
-    || type == TSDB_MSG_TYPE_FETCH || type == TSDB_MSG_TYPE_CM_STABLE_VGROUP
-    || type == TSDB_MSG_TYPE_CM_TABLES_META || type == TSDB_MSG_TYPE_CM_TABLE_META
+    || type == TSDB_MSG_TYPE_FETCH || type == TSDB_MSG_TYPE_SUB_WAIT || type == TSDB_MSG_TYPE_CM_STABLE_VGROUP
+    || type == TSDB_MSG_TYPE_CM_TABLES_META || type == TSDB_MSG_TYPE_CM_TABLE_META || type == TSDB_MSG_TYPE_CM_STABLE_TABLES
     || type == TSDB_MSG_TYPE_CM_SHOW || type == TSDB_MSG_TYPE_DM_STATUS || type == TSDB_MSG_TYPE_CM_ALTER_TABLE)
     pContext->connType = RPC_CONN_TCPC;
 
@@ -1075,6 +1076,8 @@ static void *rpcProcessMsgFromPeer(SRecvInfo *pRecv) {
   SRpcConn  *pConn = (SRpcConn *)pRecv->thandle;
 
   tDump(pRecv->msg, pRecv->msgLen);
+  taosMetricsInc(TSDB_METRIC_RPC_MSGS_IN, 1);
+  taosMetricsInc(TSDB_METRIC_RPC_BYTES_IN, pRecv->msgLen);
 
   // underlying UDP layer does not know it is server or client
   pRecv->connType = pRecv->connType | pRpc->connType;  
@@ -1351,6 +1354,9 @@ static void rpcSendMsgToPeer(SRpcConn *pConn, void *msg, int msgLen) {
 
   if (writtenLen != msgLen) {
     tError("%s, failed to send, msgLen:%d written:%d, reason:%s", pConn->info, msgLen, writtenLen, strerror(errno));
+  } else {
+    taosMetricsInc(TSDB_METRIC_RPC_MSGS_OUT, 1);
+    taosMetricsInc(TSDB_METRIC_RPC_BYTES_OUT, msgLen);
   }
  
   tDump(msg, msgLen);
@@ -37,6 +37,8 @@ extern "C" {
 
 #define SYNC_MAX_FWDS 4096
 #define SYNC_FWD_TIMER 300
+#define SYNC_FWD_BATCH_SIZE (256 * 1024)  // forwards to a peer are coalesced up to this size
+#define SYNC_FWD_WINDOW 1024              // forwards to a peer not acked yet
 #define SYNC_ROLE_TIMER 15000             // ms
 #define SYNC_CHECK_INTERVAL 1000          // ms
 #define SYNC_WAIT_AFTER_CHOOSE_MASTER 10  // ms
@@ -83,11 +85,17 @@ typedef struct SsyncPeer {
   uint64_t lastFileVer;     // track the file version while retrieve
   uint64_t lastWalVer;      // track the wal version while retrieve
   SOCKET   syncFd;
+  SOCKET   streamFds[TAOS_SYNC_MAX_STREAMS];  // extra connections to restore data files
+  int32_t  numOfStreams;
   SOCKET   peerFd;          // forward FD
   int32_t  numOfRetrieves;  // number of retrieves tried
   int32_t  fileChanged;     // a flag to indicate file is changed during retrieving process
   int32_t  refCount;
   int8_t   isArb;
+  int8_t   features;        // SYNC_FEATURE_* of peer
+  uint64_t ackVersion;      // forwards up to this version are acked by peer
+  char *   fwdBuf;          // forwards coalesced to send
+  int32_t  fwdLen;
   int64_t  rid;
   void *   timer;
   void *   pConn;
@@ -101,6 +109,8 @@ typedef struct SSyncNode {
   int8_t       selfIndex;
   uint32_t     vgId;
   int32_t      refCount;
+  int8_t       batchFwds;
+  uint64_t     fwdAckVersion;  // forwards up to this version are confirmed but not acked to master yet
   int64_t      rid;
   SSyncPeer *  peerInfo[TAOS_SYNC_MAX_REPLICA + 1];  // extra one for arbitrator
   SSyncPeer *  pMaster;
@@ -131,6 +141,7 @@ void *     syncRetrieveData(void *param);
 void *     syncRestoreData(void *param);
 int32_t    syncSaveIntoBuffer(SSyncPeer *pPeer, SWalHead *pHead);
 void       syncRestartConnection(SSyncPeer *pPeer);
+void       syncCloseStreams(SSyncPeer *pPeer);
 void       syncBroadcastStatus(SSyncNode *pNode);
 uint32_t   syncResolvePeerFqdn(SSyncPeer *pPeer);
 SSyncPeer *syncAcquirePeer(int64_t rid);
@@ -38,7 +38,9 @@ typedef enum {
   TAOS_SMSG_SYNC_FILE     = 13,
   TAOS_SMSG_SYNC_FILE_RSP = 14,
   TAOS_SMSG_TEST          = 15,
-  TAOS_SMSG_END           = 16
+  TAOS_SMSG_SYNC_STREAM   = 16,
+  TAOS_SMSG_SYNC_FWD_ACK  = 17,
+  TAOS_SMSG_END           = 18
 } ESyncMsgType;
 
 typedef enum {
@@ -91,7 +93,8 @@ typedef struct {
   int8_t      role;
   int8_t      ack;
   int8_t      type;
-  int8_t      reserved[3];
+  int8_t      features;  // SYNC_FEATURE_*, zero from old versions
+  int8_t      reserved[2];
   uint16_t    tranId;
   uint64_t    version;
   SPeerStatus peersStatus[TAOS_SYNC_MAX_REPLICA];
@@ -118,6 +121,8 @@ typedef struct {
 #define SYNC_PROTOCOL_VERSION 1
 #define SYNC_SIGNATURE ((uint16_t)(0xCDEF))
 
+#define SYNC_FEATURE_FWD_ACK 0x1  // forwards up to a version can be acked by one SFwdRsp of TAOS_SMSG_SYNC_FWD_ACK
+
 extern char *statusType[];
 
 uint16_t syncGenTranId();
@@ -125,8 +130,10 @@ int32_t  syncCheckHead(SSyncHead *pHead);
 
 void syncBuildSyncFwdMsg(SSyncHead *pHead, int32_t vgId, int32_t len);
 void syncBuildSyncFwdRsp(SFwdRsp *pMsg, int32_t vgId, uint64_t version, int32_t code);
+void syncBuildSyncFwdAck(SFwdRsp *pMsg, int32_t vgId, uint64_t version);
 void syncBuildSyncReqMsg(SSyncMsg *pMsg, int32_t vgId);
 void syncBuildSyncDataMsg(SSyncMsg *pMsg, int32_t vgId);
+void syncBuildSyncStreamMsg(SSyncMsg *pMsg, int32_t vgId);
 void syncBuildSyncSetupMsg(SSyncMsg *pMsg, int32_t vgId);
 void syncBuildPeersStatus(SPeersStatus *pMsg, int32_t vgId);
 void syncBuildSyncTestMsg(SSyncMsg *pMsg, int32_t vgId);
@@ -57,6 +57,8 @@ static void    syncProcessFwdAck(SSyncNode *pNode, SFwdInfo *pFwdInfo, int32_t c
 static int32_t syncSaveFwdInfo(SSyncNode *pNode, uint64_t version, void *mhandle);
 static void    syncRestartPeer(SSyncPeer *pPeer);
 static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle, int32_t qtype, bool force);
+static int32_t syncFlushPeerForwards(SSyncPeer *pPeer);
+static void    syncSendFwdAck(SSyncNode *pNode);
 
 static SSyncPeer *syncAddPeer(SSyncNode *pNode, const SNodeInfo *pInfo);
 static void       syncStartCheckPeerConn(SSyncPeer *pPeer);
@@ -184,6 +186,7 @@ int64_t syncStart(const SSyncInfo *pInfo) {
   pNode->getVersionFp = pInfo->getVersionFp;
   pNode->sendFileFp = pInfo->sendFileFp;
   pNode->recvFileFp = pInfo->recvFileFp;
+  pNode->batchFwds = pInfo->batchFwds;
 
   pNode->selfIndex = -1;
   pNode->vgId = pInfo->vgId;
@@ -395,6 +398,15 @@ void syncConfirmForward(int64_t rid, uint64_t _version, int32_t code, bool force
 
   SSyncPeer *pPeer = pNode->pMaster;
   if (pPeer && (pNode->quorum > 1 || force)) {
+    // Confirmed forwards are acked together by syncFlushForwards, a failed one is sent after those before it
+    if (code == 0 && pNode->batchFwds && (pPeer->features & SYNC_FEATURE_FWD_ACK)) {
+      pNode->fwdAckVersion = _version;
+      syncReleaseNode(pNode);
+      return;
+    }
+
+    syncSendFwdAck(pNode);
+
     SFwdRsp rsp;
     syncBuildSyncFwdRsp(&rsp, pNode->vgId, _version, code);
 
@@ -409,6 +421,48 @@ void syncConfirmForward(int64_t rid, uint64_t _version, int32_t code, bool force
   syncReleaseNode(pNode);
 }
 
+static void syncSendFwdAck(SSyncNode *pNode) {
+  uint64_t   _version = pNode->fwdAckVersion;
+  SSyncPeer *pPeer = pNode->pMaster;
+
+  if (_version == 0) return;
+  pNode->fwdAckVersion = 0;
+  if (pPeer == NULL) return;
+
+  SFwdRsp rsp;
+  syncBuildSyncFwdAck(&rsp, pNode->vgId, _version);
+
+  if (taosWriteMsg(pPeer->peerFd, &rsp, sizeof(SFwdRsp)) == sizeof(SFwdRsp)) {
+    sTrace("%s, forward-ack is sent, hver:%" PRIu64, pPeer->id, _version);
+  } else {
+    sDebug("%s, failed to send forward-ack, restart", pPeer->id);
+    syncRestartConnection(pPeer);
+  }
+}
+
+void syncFlushForwards(int64_t rid) {
+  if (rid <= 0) return;
+
+  SSyncNode *pNode = syncAcquireNode(rid);
+  if (pNode == NULL) return;
+
+  if (pNode->replica == 1) {
+    syncReleaseNode(pNode);
+    return;
+  }
+
+  syncSendFwdAck(pNode);
+
+  pthread_mutex_lock(&pNode->mutex);
+  for (int32_t i = 0; i < pNode->replica; ++i) {
+    SSyncPeer *pPeer = pNode->peerInfo[i];
+    if (pPeer != NULL && pPeer->fwdLen > 0) syncFlushPeerForwards(pPeer);
+  }
+  pthread_mutex_unlock(&pNode->mutex);
+
+  syncReleaseNode(pNode);
+}
+
 void syncRecover(int64_t rid) {
   SSyncPeer *pPeer;
 
@@ -519,6 +573,7 @@ static void syncFreePeer(void *param) {
   sDebug("%s, peer is freed, refCount:%d", pPeer->id, pPeer->refCount);
 
   syncReleaseNode(pPeer->pSyncNode);
+  tfree(pPeer->fwdBuf);
   tfree(pPeer);
 }
 
@@ -546,6 +601,8 @@ static void syncClosePeerConn(SSyncPeer *pPeer) {
 
   taosTmrStopA(&pPeer->timer);
   taosCloseSocket(pPeer->syncFd);
+  pPeer->fwdLen = 0;
+  pPeer->ackVersion = 0;
   if (pPeer->peerFd >= 0) {
     pPeer->peerFd = -1;
     void *pConn = pPeer->pConn;
@@ -617,6 +674,7 @@ static SSyncPeer *syncAddPeer(SSyncNode *pNode, const SNodeInfo *pInfo) {
 
   pPeer->peerFd = -1;
   pPeer->syncFd = -1;
+  pPeer->numOfStreams = 0;
   pPeer->role = TAOS_SYNC_ROLE_OFFLINE;
   pPeer->pSyncNode = pNode;
   pPeer->refCount = 1;
@@ -993,6 +1051,8 @@ static void syncProcessFwdResponse(SFwdRsp *pFwdRsp, SSyncPeer *pPeer) {
   sTrace("%s, forward-rsp is received, code:%x hver:%" PRIu64, pPeer->id, pFwdRsp->code, pFwdRsp->version);
   SFwdInfo *pFirst = pSyncFwds->fwdInfo + pSyncFwds->first;
 
+  if (pFwdRsp->version > pPeer->ackVersion) pPeer->ackVersion = pFwdRsp->version;
+
   if (pFirst->version <= pFwdRsp->version && pSyncFwds->fwds > 0) {
     // find the forwardInfo from first
     for (int32_t i = 0; i < pSyncFwds->fwds; ++i) {
@@ -1006,6 +1066,23 @@ static void syncProcessFwdResponse(SFwdRsp *pFwdRsp, SSyncPeer *pPeer) {
   }
 }
 
+static void syncProcessFwdAckFromPeer(SFwdRsp *pFwdRsp, SSyncPeer *pPeer) {
+  SSyncNode *pNode = pPeer->pSyncNode;
+  SSyncFwds *pSyncFwds = pNode->pSyncFwds;
+
+  sTrace("%s, forward-ack is received, hver:%" PRIu64 " acked:%" PRIu64, pPeer->id, pFwdRsp->version,
+         pPeer->ackVersion);
+
+  for (int32_t i = 0; i < pSyncFwds->fwds; ++i) {
+    SFwdInfo *pFwdInfo = pSyncFwds->fwdInfo + (i + pSyncFwds->first) % SYNC_MAX_FWDS;
+    if (pFwdInfo->version > pFwdRsp->version) break;
+    if (pFwdInfo->version > pPeer->ackVersion) syncProcessFwdAck(pNode, pFwdInfo, 0);
+  }
+
+  if (pFwdRsp->version > pPeer->ackVersion) pPeer->ackVersion = pFwdRsp->version;
+  syncRemoveConfirmedFwdInfo(pNode);
+}
+
 static void syncProcessForwardFromPeer(char *cont, SSyncPeer *pPeer) {
   SSyncNode *pNode = pPeer->pSyncNode;
   SWalHead * pHead = (SWalHead *)(cont + sizeof(SSyncHead));
@@ -1041,6 +1118,7 @@ static void syncProcessPeersStatusMsg(SPeersStatus *pPeersStatus, SSyncPeer *pPe
          pPeersStatus->version, pPeersStatus->ack, pPeersStatus->tranId, statusType[pPeersStatus->type], pPeer->peerFd);
 
   pPeer->version = pPeersStatus->version;
+  pPeer->features = pPeersStatus->features;
   syncCheckRole(pPeer, pPeersStatus->peersStatus, pPeersStatus->role);
 
   if (pPeersStatus->ack) {
@@ -1088,6 +1166,8 @@ static int32_t syncProcessPeerMsg(int64_t rid, void *buffer) {
       syncProcessForwardFromPeer(buffer, pPeer);
     } else if (pHead->type == TAOS_SMSG_SYNC_FWD_RSP) {
       syncProcessFwdResponse(buffer, pPeer);
+    } else if (pHead->type == TAOS_SMSG_SYNC_FWD_ACK) {
+      syncProcessFwdAckFromPeer(buffer, pPeer);
     } else if (pHead->type == TAOS_SMSG_SYNC_REQ) {
       syncProcessSyncRequest(buffer, pPeer);
     } else if (pHead->type == TAOS_SMSG_STATUS) {
@@ -1119,6 +1199,7 @@ static int32_t syncSendPeersStatusMsgToPeer(SSyncPeer *pPeer, char ack, int8_t t
   msg.type = type;
   msg.tranId = tranId;
   msg.version = nodeVersion;
+  msg.features = SYNC_FEATURE_FWD_ACK;
 
   for (int32_t i = 0; i < pNode->replica; ++i) {
     msg.peersStatus[i].role = pNode->peerInfo[i]->role;
@@ -1237,6 +1318,40 @@ void syncProcessTestMsg(SSyncMsg *pMsg, SOCKET connFd) {
   taosCloseSocket(connFd);
 }
 
+void syncCloseStreams(SSyncPeer *pPeer) {
+  int32_t numOfStreams = atomic_exchange_32(&pPeer->numOfStreams, 0);
+  for (int32_t i = 0; i < numOfStreams; ++i) {
+    taosCloseSocket(pPeer->streamFds[i]);
+  }
+}
+
+// Extra connections opened by master to send data files in parallel while data is restored from it
+static void syncProcessStreamConnection(SSyncPeer *pPeer, SSyncMsg *pMsg, SOCKET connFd) {
+  SSyncNode *pNode = pPeer->pSyncNode;
+  int32_t    numOfStreams = pPeer->numOfStreams;
+
+  if (pPeer->syncFd < 0 || (nodeSStatus != TAOS_SYNC_STATUS_START && nodeSStatus != TAOS_SYNC_STATUS_FILE) ||
+      numOfStreams >= TAOS_SYNC_MAX_STREAMS) {
+    sError("%s, sync-stream msg is refused, tranId:%u sstatus:%s streams:%d", pPeer->id, pMsg->tranId,
+           syncStatus[nodeSStatus], numOfStreams);
+    taosCloseSocket(connFd);
+    return;
+  }
+
+  pPeer->streamFds[numOfStreams] = connFd;
+  atomic_store_32(&pPeer->numOfStreams, numOfStreams + 1);
+
+  SSyncRsp rsp = {.sync = 1, .tranId = pMsg->tranId};
+  if (taosWriteMsg(connFd, &rsp, sizeof(SSyncRsp)) != sizeof(SSyncRsp)) {
+    sError("%s, failed to send sync-stream rsp since %s, tranId:%u", pPeer->id, strerror(errno), pMsg->tranId);
+    atomic_store_32(&pPeer->numOfStreams, numOfStreams);
+    taosCloseSocket(connFd);
+    return;
+  }
+
+  sInfo("%s, sync-stream:%d from master is received, tranId:%u", pPeer->id, numOfStreams, pMsg->tranId);
+}
+
 static void syncProcessIncommingConnection(SOCKET connFd, uint32_t sourceIp) {
   char    ipstr[24];
   int32_t i;
@@ -1290,11 +1405,14 @@ static void syncProcessIncommingConnection(SOCKET connFd, uint32_t sourceIp) {
   } else {
     // first packet tells what kind of link
     if (msg.head.type == TAOS_SMSG_SYNC_DATA) {
+      syncCloseStreams(pPeer);
       pPeer->syncFd = connFd;
       nodeSStatus = TAOS_SYNC_STATUS_START;
       sInfo("%s, sync-data msg from master is received, tranId:%u, set sstatus:%s", pPeer->id, msg.tranId,
             syncStatus[nodeSStatus]);
       syncCreateRestoreDataThread(pPeer);
+    } else if (msg.head.type == TAOS_SMSG_SYNC_STREAM) {
+      syncProcessStreamConnection(pPeer, &msg, connFd);
     } else {
       sDebug("%s, TCP connection is up, pfd:%d sfd:%d, old pfd:%d", pPeer->id, connFd, pPeer->syncFd, pPeer->peerFd);
       syncClosePeerConn(pPeer);
@@ -1448,6 +1566,34 @@ static void syncMonitorFwdInfos(void *param, void *tmrId) {
   syncReleaseNode(pNode);
 }
 
+// Forwards to a peer not acked are counted from the first one still waiting for confirmation
+static bool syncIsFwdWindowFull(SSyncNode *pNode, SSyncPeer *pPeer, uint64_t _version) {
+  SSyncFwds *pSyncFwds = pNode->pSyncFwds;
+  if (pSyncFwds->fwds <= 0) return false;
+
+  uint64_t acked = pSyncFwds->fwdInfo[pSyncFwds->first].version - 1;
+  if (pPeer->ackVersion > acked) acked = pPeer->ackVersion;
+
+  return _version > acked + SYNC_FWD_WINDOW;
+}
+
+static int32_t syncFlushPeerForwards(SSyncPeer *pPeer) {
+  int32_t fwdLen = pPeer->fwdLen;
+  if (fwdLen <= 0) return 0;
+
+  pPeer->fwdLen = 0;
+  int32_t retLen = taosWriteMsg(pPeer->peerFd, pPeer->fwdBuf, fwdLen);
+  if (retLen != fwdLen) {
+    sError("%s, failed to send forwards, role:%s sstatus:%s fwdLen:%d retLen:%d", pPeer->id, syncRole[pPeer->role],
+           syncStatus[pPeer->sstatus], fwdLen, retLen);
+    syncRestartConnection(pPeer);
+    return -1;
+  }
+
+  sTrace("%s, forwards are sent, fwdLen:%d", pPeer->id, fwdLen);
+  return 0;
+}
+
 static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle, int32_t qtype, bool force) {
   SSyncPeer *pPeer;
   SSyncHead *pSyncHead;
@@ -1487,6 +1633,26 @@ static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle
 
   pthread_mutex_lock(&pNode->mutex);
 
+  // A write is pushed back if it can not be confirmed by the peers within their windows of forwards not acked
+  if (pNode->quorum > 1) {
+    int32_t peers = 0;
+    int32_t ready = 0;
+    for (int32_t i = 0; i < pNode->replica; ++i) {
+      pPeer = pNode->peerInfo[i];
+      if (pPeer == NULL || pPeer->peerFd < 0) continue;
+      if (pPeer->role != TAOS_SYNC_ROLE_SLAVE && pPeer->sstatus != TAOS_SYNC_STATUS_CACHE) continue;
+      peers++;
+      if (!syncIsFwdWindowFull(pNode, pPeer, pWalHead->version)) ready++;
+    }
+
+    if (peers >= pNode->quorum - 1 && ready < pNode->quorum - 1) {
+      sDebug("vgId:%d, forward windows are full, hver:%" PRIu64 " peers:%d ready:%d", pNode->vgId,
+             pWalHead->version, peers, ready);
+      pthread_mutex_unlock(&pNode->mutex);
+      return TSDB_CODE_SYN_TOO_MANY_FWDINFO;
+    }
+  }
+
   for (int32_t i = 0; i < pNode->replica; ++i) {
     pPeer = pNode->peerInfo[i];
     if (pPeer == NULL || pPeer->peerFd < 0) continue;
@@ -1502,6 +1668,23 @@ static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle
       }
     }
 
+    if (pNode->batchFwds && fwdLen <= SYNC_FWD_BATCH_SIZE) {
+      if (pPeer->fwdLen + fwdLen > SYNC_FWD_BATCH_SIZE && syncFlushPeerForwards(pPeer) < 0) continue;
+      if (pPeer->fwdBuf == NULL && (pPeer->fwdBuf = malloc(SYNC_FWD_BATCH_SIZE)) == NULL) {
+        sError("%s, failed to allocate forward buffer", pPeer->id);
+        syncRestartConnection(pPeer);
+        continue;
+      }
+
+      memcpy(pPeer->fwdBuf + pPeer->fwdLen, pSyncHead, fwdLen);
+      pPeer->fwdLen += fwdLen;
+      sTrace("%s, forward is buffered, role:%s sstatus:%s hver:%" PRIu64 " contLen:%d", pPeer->id,
+             syncRole[pPeer->role], syncStatus[pPeer->sstatus], pWalHead->version, pWalHead->len);
+      continue;
+    }
+
+    if (syncFlushPeerForwards(pPeer) < 0) continue;
+
     int32_t retLen = taosWriteMsg(pPeer->peerFd, pSyncHead, fwdLen);
     if (retLen == fwdLen) {
       sTrace("%s, forward is sent, role:%s sstatus:%s hver:%" PRIu64 " contLen:%d", pPeer->id, syncRole[pPeer->role],
@@ -52,7 +52,16 @@ static int32_t syncRecvFileVersion(SSyncPeer *pPeer, uint64_t *fversion) {
 static int32_t syncRestoreFile(SSyncPeer *pPeer, uint64_t *fversion) {
   SSyncNode *pNode = pPeer->pSyncNode;
 
-  if (pNode->recvFileFp && (*pNode->recvFileFp)(pNode->pTsdb, pPeer->syncFd) != 0) {
+  int32_t code = 0;
+  if (pNode->recvFileFp) {
+    code = (*pNode->recvFileFp)(pNode->pTsdb, pPeer->syncFd, pPeer->streamFds, &pPeer->numOfStreams);
+  }
+
+  pthread_mutex_lock(&pNode->mutex);
+  syncCloseStreams(pPeer);
+  pthread_mutex_unlock(&pNode->mutex);
+
+  if (code != 0) {
     sError("%s, failed to restore file", pPeer->id);
     return -1;
   }
@@ -300,6 +309,10 @@ void *syncRestoreData(void *param) {
   nodeSStatus = TAOS_SYNC_STATUS_INIT;
   sInfo("%s, restore data over, set sstatus:%s", pPeer->id, syncStatus[nodeSStatus]);
 
+  pthread_mutex_lock(&pNode->mutex);
+  syncCloseStreams(pPeer);
+  pthread_mutex_unlock(&pNode->mutex);
+
   taosCloseSocket(pPeer->syncFd);
   syncCloseRecvBuffer(pNode);
   atomic_sub_fetch_32(&tsSyncNum, 1);
@@ -113,15 +113,56 @@ static int32_t syncSendFileVersion(SSyncPeer *pPeer) {
   return 0;
 }
 
+// Open extra connections to send data files in parallel, peers not knowing them just close the connection
+static int32_t syncOpenStreams(SSyncPeer *pPeer, SOCKET *streamFds) {
+  SSyncNode *pNode = pPeer->pSyncNode;
+  int32_t    numOfStreams = 0;
+
+  if (tsSyncFileStreams <= 1) return 0;
+
+  uint32_t ip = syncResolvePeerFqdn(pPeer);
+  if (!ip) return 0;
+
+  while (numOfStreams < MIN(tsSyncFileStreams - 1, TAOS_SYNC_MAX_STREAMS)) {
+    SOCKET fd = taosOpenTcpClientSocket(ip, pPeer->port, 0);
+    if (fd < 0) break;
+
+    SSyncMsg msg;
+    SSyncRsp rsp;
+    syncBuildSyncStreamMsg(&msg, pNode->vgId);
+    if (taosWriteMsg(fd, &msg, sizeof(SSyncMsg)) != sizeof(SSyncMsg) ||
+        taosReadMsg(fd, &rsp, sizeof(SSyncRsp)) != sizeof(SSyncRsp) || rsp.sync != 1 || rsp.tranId != msg.tranId) {
+      sInfo("%s, failed to setup sync-stream:%d, tranId:%u", pPeer->id, numOfStreams, msg.tranId);
+      taosCloseSocket(fd);
+      break;
+    }
+
+    streamFds[numOfStreams++] = fd;
+  }
+
+  sInfo("%s, %d sync-streams are setup", pPeer->id, numOfStreams);
+  return numOfStreams;
+}
+
 static int32_t syncRetrieveFile(SSyncPeer *pPeer) {
   SSyncNode *pNode = pPeer->pSyncNode;
+  SOCKET     streamFds[TAOS_SYNC_MAX_STREAMS];
+  int32_t    code = 0;
 
   if (syncGetFileVersion(pNode, pPeer) < 0) {
     pPeer->fileChanged = 1;
     return -1;
   }
 
-  if (pNode->sendFileFp && (*pNode->sendFileFp)(pNode->pTsdb, pPeer->syncFd) != 0) {
+  if (pNode->sendFileFp) {
+    int32_t numOfStreams = syncOpenStreams(pPeer, streamFds);
+    code = (*pNode->sendFileFp)(pNode->pTsdb, pPeer->syncFd, streamFds, numOfStreams);
+    for (int32_t i = 0; i < numOfStreams; ++i) {
+      taosCloseSocket(streamFds[i]);
+    }
+  }
+
+  if (code != 0) {
     sError("%s, failed to retrieve file", pPeer->id);
     return -1;
   }
@@ -79,6 +79,7 @@ int      tsdbEndFSTxn(STsdbRepo *pRepo);
 int      tsdbEndFSTxnWithError(STsdbFS *pfs);
 void     tsdbUpdateFSTxnMeta(STsdbFS *pfs, STsdbFSMeta *pMeta);
 void     tsdbUpdateMFile(STsdbFS *pfs, const SMFile *pMFile);
+int      tsdbGetFSStatusCksum(STsdbFS *pfs, uint32_t *cksum);
 int      tsdbUpdateDFileSet(STsdbFS *pfs, const SDFileSet *pSet);
 
 void       tsdbFSIterInit(SFSIter *pIter, STsdbFS *pfs, int direction);
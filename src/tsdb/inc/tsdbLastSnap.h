@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_LAST_SNAP_H_
+#define _TD_TSDB_LAST_SNAP_H_
+
+// Snapshot of lastKey, last row and last non-null columns of all tables, taken on the file system status after the
+// final commit when the repository is closed. It lets tsdbRestoreInfo skip scanning data files on the next open as
+// long as the file system is not changed since then.
+#define TSDB_LAST_SNAP_VERSION 0
+
+int  tsdbSaveLastSnap(STsdbRepo *pRepo);
+int  tsdbLoadLastSnap(STsdbRepo *pRepo, bool *loaded);
+bool tsdbIsLastSnapFile(const char *bname);
+
+#endif /* _TD_TSDB_LAST_SNAP_H_ */
@@ -28,6 +28,7 @@ typedef struct STable {
   STSchema*      tagSchema;
   SKVRow         tagVal;
   SSkipList*     pIndex;         // For TSDB_SUPER_TABLE, it is the skiplist index
+  struct STagIndex* pTagIndex;   // For TSDB_SUPER_TABLE, inverted index of all tag columns, NULL if not available
   void*          eventHandler;   // TODO
   void*          streamHandler;  // TODO
   TSKEY          lastKey;
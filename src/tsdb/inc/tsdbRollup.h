@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_ROLLUP_H_
+#define _TD_TSDB_ROLLUP_H_
+
+// Rollup of a file set: for each data block written by a commit, the number of rows and the sum, min, max and number
+// of NULLs of each column in every bucket of the tiers configured by rollupTiers, e.g. "1m,1h,1d". It is saved in its
+// own file bound to the head file of the file set and is used only while the file set stays the same. Blocks with
+// sub-blocks have no rollup, they are read as they are.
+#define TSDB_ROLLUP_VERSION 1
+#define TSDB_MAX_ROLLUP_TIERS 4
+
+typedef struct {
+  TSKEY        skey;   // first key in the bucket
+  TSKEY        ekey;   // last key in the bucket
+  int32_t      start;  // position of the first row of the bucket in the block
+  int32_t      rows;
+  int32_t      nCols;
+  SDataStatis *cols;  // columns not all NULL in the bucket in ascending colId, timestamp column excluded
+} SRollupBucket;
+
+typedef struct {
+  TSKEY          keyFirst;
+  TSKEY          keyLast;
+  int32_t        numOfRows;
+  int32_t        nBuckets;
+  SRollupBucket *buckets;
+} SRollupBlock;
+
+typedef struct SRollupW SRollupW;
+typedef struct SRollupR SRollupR;
+
+int  tsdbGetRollupTiers(int8_t precision, SInterval tiers[]);
+bool tsdbIsRollupFile(const char *bname, int *fid);
+void tsdbRemoveRollup(SDFileSet *pSet);
+
+// Rollup writer of a commit. Failures of the writer never fail the commit, the file set is just left without rollup.
+int  tsdbInitRollupW(SRollupW **ppw, STsdbRepo *pRepo);
+void tsdbDestroyRollupW(SRollupW *pw);
+void tsdbRollupBeginFSet(SRollupW *pw, SDFileSet *pSet, int fid);
+void tsdbRollupSetTable(SRollupW *pw, STable *pTable);
+void tsdbRollupBlockData(SRollupW *pw, SDataCols *pDataCols);
+void tsdbRollupMoveBlock(SRollupW *pw, const SBlock *pBlock);
+void tsdbRollupAddBlock(SRollupW *pw, const SBlock *pBlock);
+void tsdbRollupEndTable(SRollupW *pw);
+void tsdbRollupEndFSet(SRollupW *pw, SDFileSet *pSet);
+
+// Rollup reader of a query, it picks the coarsest tier of which the buckets make up windows of the interval
+SRollupR *    tsdbNewRollupR(STsdbRepo *pRepo, int64_t interval, char unit);
+void          tsdbFreeRollupR(SRollupR *pr);
+void          tsdbRollupOpenFSet(SRollupR *pr, SDFileSet *pSet);
+SRollupBlock *tsdbRollupGetBlock(SRollupR *pr, uint64_t uid, const SBlock *pBlock);
+
+#endif /* _TD_TSDB_ROLLUP_H_ */
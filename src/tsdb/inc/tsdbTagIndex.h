@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_TAG_INDEX_H_
+#define _TD_TSDB_TAG_INDEX_H_
+
+// Inverted index over all tag columns of a super table. Each distinct tag value maps to the set of child table
+// tids holding it, kept as a tid array while small and as a bitmap once the array gets larger than the bitmap.
+// Child tables without a value of the column are kept in a separate set. All functions are called with the repo
+// meta locked, writers hold the write lock.
+typedef struct STagIndex STagIndex;
+
+typedef bool (*__tag_val_filter_fn_t)(const char *val, void *param);
+
+STagIndex *tsdbNewTagIndex(STSchema *pTagSchema);
+void       tsdbFreeTagIndex(STagIndex *pIndex);
+int        tsdbTagIndexAddTable(STagIndex *pIndex, STable *pTable);
+void       tsdbTagIndexRemoveTable(STagIndex *pIndex, STable *pTable);
+int32_t    tsdbTagIndexWords(STagIndex *pIndex);
+void       tsdbTagIndexGetAll(STagIndex *pIndex, uint64_t *words);
+int        tsdbQueryTagIndex(STagIndex *pIndex, int16_t colId, __tag_val_filter_fn_t fp, void *param, uint64_t *words);
+
+#endif /* _TD_TSDB_TAG_INDEX_H_ */
@@ -52,6 +52,8 @@ extern "C" {
 #include "tsdbLog.h"
 // Meta
 #include "tsdbMeta.h"
+// Tag Index
+#include "tsdbTagIndex.h"
 // Buffer
 #include "tsdbBuffer.h"
 // MemTable
@@ -68,6 +70,12 @@ extern "C" {
 #include "tsdbCompact.h"
 // Commit Queue
 #include "tsdbCommitQueue.h"
+// Migrate
+#include "tsdbMigrate.h"
+// Last Data Snapshot
+#include "tsdbLastSnap.h"
+// Rollup
+#include "tsdbRollup.h"
 
 #include "tsdbRowMergeBuf.h"
 // Main definitions
@@ -97,6 +105,8 @@ struct STsdbRepo {
 
   SMergeBuf       mergeBuf;  //used when update=2
   int8_t          compactState;  // compact state: inCompact/noCompact/waitingCompact?
+  int8_t          migrateState;  // migrate state: inMigrate/noMigrate
+  int32_t         fsetReads[TSDB_FSET_READ_SLOTS];  // # of file set opens by queries since last migration pass
   pthread_t*      pthread;
 };
 
@@ -13,6 +13,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "tsdbint.h"
+#include "tmetrics.h"
 
 extern int32_t tsTsdbMetaCompactRatio;
 
@@ -42,6 +43,7 @@ typedef struct {
   SArray *     aSupBlk;  // Table super-block array
   SArray *     aSubBlk;  // table sub-block array
   SDataCols *  pDataCols;
+  SRollupW *   pRollup;  // NULL if no rollup tier is configured
 } SCommitH;
 
 #define TSDB_COMMIT_REPO(ch) TSDB_READ_REPO(&(ch->readh))
@@ -93,6 +95,7 @@ void *tsdbCommitData(STsdbRepo *pRepo) {
   if (pRepo->imem == NULL) {
     return NULL;
   }
+  int64_t start = taosGetTimestampUs();
   tsdbStartCommit(pRepo);
 
   // Commit to update meta file
@@ -108,6 +111,8 @@ void *tsdbCommitData(STsdbRepo *pRepo) {
   }
 
   tsdbEndCommit(pRepo, TSDB_CODE_SUCCESS);
+  taosMetricsInc(TSDB_METRIC_TSDB_COMMITS, 1);
+  taosMetricsObserve(TSDB_METRIC_TSDB_COMMIT_US, taosGetTimestampUs() - start);
   return NULL;
 
 _err:
@@ -730,6 +735,8 @@ static int tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid) {
     return -1;
   }
 
+  tsdbRollupBeginFSet(pCommith->pRollup, pCommith->isRFileSet ? pSet : NULL, fid);
+
   // Loop to commit each table data
   for (int tid = 1; tid < pCommith->niters; tid++) {
     SCommitIter *pIter = pCommith->iters + tid;
@@ -768,6 +775,8 @@ static int tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid) {
     return -1;
   }
 
+  tsdbRollupEndFSet(pCommith->pRollup, &(pCommith->wSet));
+
   return 0;
 }
 
@@ -884,10 +893,17 @@ static int tsdbInitCommitH(SCommitH *pCommith, STsdbRepo *pRepo) {
     return -1;
   }
 
+  if (tsdbInitRollupW(&(pCommith->pRollup), pRepo) < 0) {
+    tsdbDestroyCommitH(pCommith);
+    return -1;
+  }
+
   return 0;
 }
 
 static void tsdbDestroyCommitH(SCommitH *pCommith) {
+  tsdbDestroyRollupW(pCommith->pRollup);
+  pCommith->pRollup = NULL;
   pCommith->pDataCols = tdFreeDataCols(pCommith->pDataCols);
   pCommith->aSubBlk = taosArrayDestroy(pCommith->aSubBlk);
   pCommith->aSupBlk = taosArrayDestroy(pCommith->aSupBlk);
@@ -1024,6 +1040,7 @@ static int tsdbSetCommitTable(SCommitH *pCommith, STable *pTable) {
   STSchema *pSchema = tsdbGetTableSchemaImpl(pTable, false, false, -1);
 
   pCommith->pTable = pTable;
+  tsdbRollupSetTable(pCommith->pRollup, pTable);
 
   if (tdInitDataCols(pCommith->pDataCols, pSchema) < 0) {
     terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
@@ -1187,9 +1204,14 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDataCo
 
 static int tsdbWriteBlock(SCommitH *pCommith, SDFile *pDFile, SDataCols *pDataCols, SBlock *pBlock, bool isLast,
                           bool isSuper) {
-  return tsdbWriteBlockImpl(TSDB_COMMIT_REPO(pCommith), TSDB_COMMIT_TABLE(pCommith), pDFile, pDataCols, pBlock, isLast,
-                            isSuper, (void **)(&(TSDB_COMMIT_BUF(pCommith))),
-                            (void **)(&(TSDB_COMMIT_COMP_BUF(pCommith))));
+  if (tsdbWriteBlockImpl(TSDB_COMMIT_REPO(pCommith), TSDB_COMMIT_TABLE(pCommith), pDFile, pDataCols, pBlock, isLast,
+                         isSuper, (void **)(&(TSDB_COMMIT_BUF(pCommith))),
+                         (void **)(&(TSDB_COMMIT_COMP_BUF(pCommith)))) < 0) {
+    return -1;
+  }
+
+  if (isSuper) tsdbRollupBlockData(pCommith->pRollup, pDataCols);
+  return 0;
 }
 
 
@@ -1203,6 +1225,8 @@ static int tsdbWriteBlockInfo(SCommitH *pCommih) {
     return -1;
   }
 
+  tsdbRollupEndTable(pCommih->pRollup);
+
   if (blkIdx.numOfBlocks == 0) {
     return 0;
   }
@@ -1336,6 +1360,7 @@ static int tsdbMoveBlock(SCommitH *pCommith, int bidx) {
   }
 
   if (isSameFile) {
+    tsdbRollupMoveBlock(pCommith->pRollup, pBlock);
     if (pBlock->numOfSubBlocks == 1) {
       if (tsdbCommitAddBlock(pCommith, pBlock, NULL, 0) < 0) {
         return -1;
@@ -1364,6 +1389,8 @@ static int tsdbCommitAddBlock(SCommitH *pCommith, const SBlock *pSupBlock, const
     return -1;
   }
 
+  tsdbRollupAddBlock(pCommith->pRollup, pSupBlock);
+
   if (pSubBlocks && taosArrayAddBatch(pCommith->aSubBlk, pSubBlocks, nSubBlocks) == NULL) {
     terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
     return -1;
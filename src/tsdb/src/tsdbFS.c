@@ -395,6 +395,25 @@ int tsdbEndFSTxnWithError(STsdbFS *pfs) {
 
 void tsdbUpdateMFile(STsdbFS *pfs, const SMFile *pMFile) { tsdbSetStatusMFile(pfs->nstatus, pMFile); }
 
+// Checksum of the encoded current status, it changes whenever the meta file or any data file changes
+int tsdbGetFSStatusCksum(STsdbFS *pfs, uint32_t *cksum) {
+  SFSStatus *pStatus = pfs->cstatus;
+  void *     pBuf = NULL;
+  void *     ptr;
+
+  *cksum = 0;
+  if (pStatus->pmf == NULL) return 0;
+
+  if (tsdbMakeRoom(&pBuf, tsdbEncodeFSStatus(NULL, pStatus)) < 0) return -1;
+
+  ptr = pBuf;
+  int tlen = tsdbEncodeFSStatus(&ptr, pStatus);
+  *cksum = taosCalcChecksum(0, (uint8_t *)pBuf, tlen);
+
+  taosTZfree(pBuf);
+  return 0;
+}
+
 int tsdbUpdateDFileSet(STsdbFS *pfs, const SDFileSet *pSet) { return tsdbAddDFileSetToStatus(pfs->nstatus, pSet); }
 
 static int tsdbSaveFSStatus(SFSStatus *pStatus, int vid) {
@@ -504,6 +523,7 @@ static void tsdbApplyFSTxnOnDisk(SFSStatus *pFrom, SFSStatus *pTo) {
 
     if (pSetTo == NULL || (pSetFrom && pSetFrom->fid < pSetTo->fid)) {
       tsdbApplyDFileSetChange(pSetFrom, NULL);
+      tsdbRemoveRollup(pSetFrom);
 
       ifrom++;
       if (ifrom >= sizeFrom) {
@@ -899,11 +919,20 @@ int tsdbLoadMetaCache(STsdbRepo *pRepo, bool recoverMeta) {
   return 0;
 }
 
+static bool tsdbFSStatusHasFSet(SFSStatus *pStatus, int fid) {
+  for (size_t i = 0; i < taosArrayGetSize(pStatus->df); i++) {
+    SDFileSet *pSet = (SDFileSet *)taosArrayGet(pStatus->df, i);
+    if (pSet->fid == fid) return true;
+  }
+  return false;
+}
+
 static int tsdbScanRootDir(STsdbRepo *pRepo) {
   char         rootDir[TSDB_FILENAME_LEN];
   char         bname[TSDB_FILENAME_LEN];
   STsdbFS *    pfs = REPO_FS(pRepo);
   const TFILE *pf;
+  int          fid;
 
   tsdbGetRootDir(REPO_ID(pRepo), rootDir);
   TDIR *tdir = tfsOpendir(rootDir);
@@ -920,6 +949,16 @@ static int tsdbScanRootDir(STsdbRepo *pRepo) {
       continue;
     }
 
+    if (tsdbIsLastSnapFile(bname)) {
+      // Skip last data snapshot, its version is checked when loading
+      continue;
+    }
+
+    if (tsdbIsRollupFile(bname, &fid) && tsdbFSStatusHasFSet(pfs->cstatus, fid)) {
+      // Skip rollup of a file set still there, it is checked against the head file when loading
+      continue;
+    }
+
     if (pfs->cstatus->pmf && tfsIsSameFile(pf, &(pfs->cstatus->pmf->f))) {
       continue;
     }
@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tsdbint.h"
+
+#define TSDB_LAST_SNAP_FLUSH_SIZE (1024 * 1024)
+
+typedef enum { TSDB_LAST_SNAP_TEMP_FILE = 0, TSDB_LAST_SNAP_FILE } TSDB_LAST_SNAP_FILE_T;
+static const char *tsdbLastSnapFname[] = {"last.t", "last"};
+
+typedef struct {
+  uint32_t version;       // snapshot format version
+  uint32_t fsVersion;     // commit version of the file system the snapshot is taken on
+  uint32_t fsCksum;       // checksum of the file system status
+  uint8_t  cacheLastRow;  // last rows are included
+  uint8_t  cacheLastCol;  // last non-null columns are included
+  uint32_t nTables;
+  uint64_t len;    // body length
+  uint32_t cksum;  // body checksum
+} SLastSnapHeader;
+
+static void tsdbGetLastSnapFname(int repoid, TSDB_LAST_SNAP_FILE_T ftype, char fname[]) {
+  snprintf(fname, TSDB_FILENAME_LEN, "%s/vnode/vnode%d/tsdb/%s", TFS_PRIMARY_PATH(), repoid, tsdbLastSnapFname[ftype]);
+}
+
+static int tsdbEncodeLastSnapHeader(void **buf, SLastSnapHeader *pHeader) {
+  int tlen = 0;
+
+  tlen += taosEncodeFixedU32(buf, pHeader->version);
+  tlen += taosEncodeFixedU32(buf, pHeader->fsVersion);
+  tlen += taosEncodeFixedU32(buf, pHeader->fsCksum);
+  tlen += taosEncodeFixedU8(buf, pHeader->cacheLastRow);
+  tlen += taosEncodeFixedU8(buf, pHeader->cacheLastCol);
+  tlen += taosEncodeFixedU32(buf, pHeader->nTables);
+  tlen += taosEncodeFixedU64(buf, pHeader->len);
+  tlen += taosEncodeFixedU32(buf, pHeader->cksum);
+
+  return tlen;
+}
+
+static void *tsdbDecodeLastSnapHeader(void *buf, SLastSnapHeader *pHeader) {
+  buf = taosDecodeFixedU32(buf, &(pHeader->version));
+  buf = taosDecodeFixedU32(buf, &(pHeader->fsVersion));
+  buf = taosDecodeFixedU32(buf, &(pHeader->fsCksum));
+  buf = taosDecodeFixedU8(buf, &(pHeader->cacheLastRow));
+  buf = taosDecodeFixedU8(buf, &(pHeader->cacheLastCol));
+  buf = taosDecodeFixedU32(buf, &(pHeader->nTables));
+  buf = taosDecodeFixedU64(buf, &(pHeader->len));
+  buf = taosDecodeFixedU32(buf, &(pHeader->cksum));
+
+  return buf;
+}
+
+static int tsdbEncodeLastSnapBytes(void **buf, const void *data, int len) {
+  if (buf != NULL && *buf != NULL) {
+    memcpy(*buf, data, len);
+    *buf = POINTER_SHIFT(*buf, len);
+  }
+  return len;
+}
+
+// uid, lastKey, row length, row, number of columns, then colId, ts, bytes and data of each column
+static int tsdbEncodeLastSnapTable(void **buf, STable *pTable, bool cacheLastRow, bool cacheLastCol) {
+  int      tlen = 0;
+  uint32_t rowLen = (cacheLastRow && pTable->lastRow != NULL) ? memRowTLen(pTable->lastRow) : 0;
+  uint16_t nCols = 0;
+
+  if (cacheLastCol) {
+    for (int16_t i = 0; i < pTable->maxColNum; i++) {
+      if (pTable->lastCols[i].bytes > 0) nCols++;
+    }
+  }
+
+  tlen += taosEncodeFixedU64(buf, TABLE_UID(pTable));
+  tlen += taosEncodeFixedI64(buf, pTable->lastKey);
+  tlen += taosEncodeFixedU32(buf, rowLen);
+  if (rowLen > 0) tlen += tsdbEncodeLastSnapBytes(buf, pTable->lastRow, rowLen);
+  tlen += taosEncodeFixedU16(buf, nCols);
+  for (int16_t i = 0; i < pTable->maxColNum && nCols > 0; i++) {
+    SDataCol *pCol = pTable->lastCols + i;
+    if (pCol->bytes <= 0) continue;
+
+    tlen += taosEncodeFixedI16(buf, pCol->colId);
+    tlen += taosEncodeFixedI64(buf, pCol->ts);
+    tlen += taosEncodeFixedU16(buf, (uint16_t)pCol->bytes);
+    tlen += tsdbEncodeLastSnapBytes(buf, pCol->pData, pCol->bytes);
+  }
+
+  return tlen;
+}
+
+static int tsdbWriteLastSnapBuf(int fd, void *pBuf, int len, SLastSnapHeader *pHeader) {
+  if (len <= 0) return 0;
+
+  if (taosWrite(fd, pBuf, len) < len) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  pHeader->cksum = taosCalcChecksum(pHeader->cksum, (uint8_t *)pBuf, len);
+  pHeader->len += len;
+  return 0;
+}
+
+// Must be called after the final commit succeeds, with all writing threads stopped
+int tsdbSaveLastSnap(STsdbRepo *pRepo) {
+  STsdbMeta *     pMeta = pRepo->tsdbMeta;
+  STsdbFS *       pfs = REPO_FS(pRepo);
+  STsdbCfg *      pCfg = REPO_CFG(pRepo);
+  SLastSnapHeader header = {0};
+  char            hbuf[TSDB_FILE_HEAD_SIZE] = "\0";
+  char            tfname[TSDB_FILENAME_LEN] = "\0";
+  char            cfname[TSDB_FILENAME_LEN] = "\0";
+  void *          pBuf = NULL;
+  void *          ptr;
+  int             len = 0;
+  TSKEY           minKey = TSKEY_INITIAL_VAL;
+  TSKEY           maxKey;
+
+  if (pfs->cstatus->pmf == NULL) return 0;
+
+  header.version = TSDB_LAST_SNAP_VERSION;
+  header.fsVersion = pfs->cstatus->meta.version;
+  if (tsdbGetFSStatusCksum(pfs, &header.fsCksum) < 0) return -1;
+  header.cacheLastRow = CACHE_LAST_ROW(pCfg) ? 1 : 0;
+  header.cacheLastCol = (CACHE_LAST_NULL_COLUMN(pCfg) && pRepo->hasCachedLastColumn) ? 1 : 0;
+
+  // data older than the first file set has expired, tables only with such data are left out
+  SDFileSet *pSet = taosArrayGetSize(pfs->cstatus->df) > 0 ? taosArrayGet(pfs->cstatus->df, 0) : NULL;
+  if (pSet != NULL) tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, pSet->fid, &minKey, &maxKey);
+
+  tsdbGetLastSnapFname(REPO_ID(pRepo), TSDB_LAST_SNAP_TEMP_FILE, tfname);
+  tsdbGetLastSnapFname(REPO_ID(pRepo), TSDB_LAST_SNAP_FILE, cfname);
+
+  int fd = open(tfname, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0755);
+  if (fd < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  // header is written at last
+  if (taosWrite(fd, hbuf, TSDB_FILE_HEAD_SIZE) < TSDB_FILE_HEAD_SIZE) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  for (int i = 1; pSet != NULL && i < pMeta->maxTables; i++) {
+    STable *pTable = pMeta->tables[i];
+    if (pTable == NULL || pTable->lastKey == TSKEY_INITIAL_VAL || pTable->lastKey < minKey) continue;
+
+    int tlen = tsdbEncodeLastSnapTable(NULL, pTable, header.cacheLastRow, header.cacheLastCol);
+    if (len + tlen > TSDB_LAST_SNAP_FLUSH_SIZE) {
+      if (tsdbWriteLastSnapBuf(fd, pBuf, len, &header) < 0) goto _err;
+      len = 0;
+    }
+
+    if (tsdbMakeRoom(&pBuf, len + tlen) < 0) goto _err;
+    ptr = POINTER_SHIFT(pBuf, len);
+    len += tsdbEncodeLastSnapTable(&ptr, pTable, header.cacheLastRow, header.cacheLastCol);
+    header.nTables++;
+  }
+
+  if (tsdbWriteLastSnapBuf(fd, pBuf, len, &header) < 0) goto _err;
+
+  ptr = hbuf;
+  tsdbEncodeLastSnapHeader(&ptr, &header);
+  taosCalcChecksumAppend(0, (uint8_t *)hbuf, TSDB_FILE_HEAD_SIZE);
+
+  if (lseek(fd, 0, SEEK_SET) < 0 || taosWrite(fd, hbuf, TSDB_FILE_HEAD_SIZE) < TSDB_FILE_HEAD_SIZE ||
+      taosFsync(fd) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  (void)close(fd);
+  (void)taosRename(tfname, cfname);
+  taosTZfree(pBuf);
+
+  tsdbInfo("vgId:%d last data of %u tables is saved, fs version %u", REPO_ID(pRepo), header.nTables,
+           header.fsVersion);
+  return 0;
+
+_err:
+  close(fd);
+  (void)remove(tfname);
+  taosTZfree(pBuf);
+  return -1;
+}
+
+static int tsdbApplyLastSnapTable(STsdbRepo *pRepo, STable *pTable, TSKEY lastKey, void *row, uint32_t rowLen,
+                                  void *cols, uint16_t nCols) {
+  STsdbCfg *pCfg = REPO_CFG(pRepo);
+
+  if (tsdbGetTableLastKeyImpl(pTable) < lastKey) pTable->lastKey = lastKey;
+
+  if (CACHE_LAST_ROW(pCfg) && rowLen > 0 && pTable->lastRow == NULL) {
+    pTable->lastRow = taosTMalloc(rowLen);
+    if (pTable->lastRow == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+    memcpy(pTable->lastRow, row, rowLen);
+  }
+
+  if (!CACHE_LAST_NULL_COLUMN(pCfg)) return 0;
+
+  STSchema *pSchema = tsdbGetTableLatestSchema(pTable);
+  if (pSchema == NULL) return 0;
+
+  tsdbFreeLastColumns(pTable);
+  if (tsdbInitColIdCacheWithSchema(pTable, pSchema) < 0) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  for (uint16_t i = 0; i < nCols; i++) {
+    int16_t  colId;
+    TSKEY    ts;
+    uint16_t bytes;
+
+    cols = taosDecodeFixedI16(cols, &colId);
+    cols = taosDecodeFixedI64(cols, &ts);
+    cols = taosDecodeFixedU16(cols, &bytes);
+
+    int16_t idx = tsdbGetLastColumnsIndexByColId(pTable, colId);
+    if (idx >= 0) {
+      SDataCol *pLastCol = pTable->lastCols + idx;
+      pLastCol->pData = malloc(bytes);
+      if (pLastCol->pData == NULL) {
+        terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+        return -1;
+      }
+      memcpy(pLastCol->pData, cols, bytes);
+      pLastCol->bytes = bytes;
+      pLastCol->ts = ts;
+      pTable->restoreColumnNum++;
+    }
+    cols = POINTER_SHIFT(cols, bytes);
+  }
+
+  pTable->hasRestoreLastColumn = (pTable->restoreColumnNum >= schemaNCols(pSchema));
+  return 0;
+}
+
+// Load the snapshot if it is taken on the current file system, *loaded is set false if it is missing or stale
+int tsdbLoadLastSnap(STsdbRepo *pRepo, bool *loaded) {
+  STsdbMeta *     pMeta = pRepo->tsdbMeta;
+  STsdbFS *       pfs = REPO_FS(pRepo);
+  STsdbCfg *      pCfg = REPO_CFG(pRepo);
+  SLastSnapHeader header = {0};
+  char            hbuf[TSDB_FILE_HEAD_SIZE] = "\0";
+  char            fname[TSDB_FILENAME_LEN] = "\0";
+  uint32_t        fsCksum = 0;
+  void *          pBuf = NULL;
+  int             code = 0;
+
+  *loaded = false;
+  if (pfs->cstatus->pmf == NULL) return 0;
+
+  tsdbGetLastSnapFname(REPO_ID(pRepo), TSDB_LAST_SNAP_FILE, fname);
+  int fd = open(fname, O_RDONLY | O_BINARY);
+  if (fd < 0) return 0;
+
+  if (taosRead(fd, hbuf, TSDB_FILE_HEAD_SIZE) < TSDB_FILE_HEAD_SIZE ||
+      !taosCheckChecksumWhole((uint8_t *)hbuf, TSDB_FILE_HEAD_SIZE)) {
+    tsdbWarn("vgId:%d last data snapshot %s is corrupted", REPO_ID(pRepo), fname);
+    goto _exit;
+  }
+  tsdbDecodeLastSnapHeader(hbuf, &header);
+
+  if (tsdbGetFSStatusCksum(pfs, &fsCksum) < 0) {
+    code = -1;
+    goto _exit;
+  }
+
+  if (header.version != TSDB_LAST_SNAP_VERSION || header.fsVersion != pfs->cstatus->meta.version ||
+      header.fsCksum != fsCksum || (CACHE_LAST_ROW(pCfg) && !header.cacheLastRow) ||
+      (CACHE_LAST_NULL_COLUMN(pCfg) && !header.cacheLastCol)) {
+    tsdbInfo("vgId:%d last data snapshot is stale, fs version %u:%u", REPO_ID(pRepo), header.fsVersion,
+             pfs->cstatus->meta.version);
+    goto _exit;
+  }
+
+  // the whole body is read at once
+  if (tsdbMakeRoom(&pBuf, header.len + 1) < 0) {
+    code = -1;
+    goto _exit;
+  }
+  if (taosRead(fd, pBuf, header.len) < (int64_t)header.len ||
+      taosCalcChecksum(0, (uint8_t *)pBuf, (uint32_t)header.len) != header.cksum) {
+    tsdbWarn("vgId:%d last data snapshot %s is corrupted", REPO_ID(pRepo), fname);
+    goto _exit;
+  }
+
+  void *ptr = pBuf;
+  for (uint32_t i = 0; i < header.nTables; i++) {
+    uint64_t uid;
+    TSKEY    lastKey;
+    uint32_t rowLen;
+    uint16_t nCols;
+
+    ptr = taosDecodeFixedU64(ptr, &uid);
+    ptr = taosDecodeFixedI64(ptr, &lastKey);
+    ptr = taosDecodeFixedU32(ptr, &rowLen);
+    void *row = ptr;
+    ptr = POINTER_SHIFT(ptr, rowLen);
+    ptr = taosDecodeFixedU16(ptr, &nCols);
+    void *cols = ptr;
+    for (uint16_t j = 0; j < nCols; j++) {
+      uint16_t bytes;
+      ptr = POINTER_SHIFT(ptr, sizeof(int16_t) + sizeof(TSKEY));
+      ptr = taosDecodeFixedU16(ptr, &bytes);
+      ptr = POINTER_SHIFT(ptr, bytes);
+    }
+    ASSERT(POINTER_DISTANCE(ptr, pBuf) <= header.len);
+
+    // the table may be dropped after the snapshot is taken
+    STable *pTable = tsdbGetTableByUid(pMeta, uid);
+    if (pTable == NULL || TABLE_TYPE(pTable) == TSDB_SUPER_TABLE) continue;
+
+    if (tsdbApplyLastSnapTable(pRepo, pTable, lastKey, row, rowLen, cols, nCols) < 0) {
+      code = -1;
+      goto _exit;
+    }
+  }
+
+  *loaded = true;
+  tsdbInfo("vgId:%d last data of %u tables is loaded from snapshot, fs version %u", REPO_ID(pRepo), header.nTables,
+           header.fsVersion);
+
+_exit:
+  close(fd);
+  taosTZfree(pBuf);
+  return code;
+}
+
+// A temporary file left by a failed save is not a valid snapshot
+bool tsdbIsLastSnapFile(const char *bname) { return strcmp(bname, tsdbLastSnapFname[TSDB_LAST_SNAP_FILE]) == 0; }
@@ -134,7 +134,11 @@ int tsdbCloseRepo(STsdbRepo *repo, int toCommit) {
   }
 
   if (toCommit) {
-    tsdbSyncCommit(repo);
+    // all data is in files now, save the last data for the next open
+    if (tsdbSyncCommit(repo) == 0 && pRepo->state == TSDB_STATE_OK && tsdbSaveLastSnap(pRepo) < 0) {
+      tsdbWarn("vgId:%d failed to save last data snapshot since %s", vgId, tstrerror(terrno));
+      terrno = TSDB_CODE_SUCCESS;
+    }
   }
 
   tsem_wait(&(pRepo->readyToCommit));
@@ -216,6 +220,24 @@ void tsdbReportStat(void *repo, int64_t *totalPoints, int64_t *totalStorage, int
   *compStorage = pRepo->stat.compStorage;
 }
 
+int64_t tsdbGetMemHeadroom(STsdbRepo *repo) {
+  STsdbRepo *pRepo = repo;
+  int64_t    nBlocks = pRepo->config.totalBlocks / 3;
+
+  if (tsdbLockRepo(pRepo) < 0) return 0;
+  if (pRepo->mem != NULL) {
+    if (pRepo->mem->extraBuffList != NULL) {
+      nBlocks = 0;
+    } else {
+      nBlocks -= listNEles(pRepo->mem->bufBlockList);
+    }
+  }
+  int64_t blockSize = pRepo->pPool->bufBlockSize;
+  tsdbUnlockRepo(pRepo);
+
+  return (nBlocks > 0) ? nBlocks * blockSize : 0;
+}
+
 int32_t tsdbConfigRepo(STsdbRepo *repo, STsdbCfg *pCfg) {
   // TODO: think about multithread cases
   if (tsdbCheckAndSetDefaultCfg(pCfg) < 0) return -1;
@@ -653,7 +675,6 @@ static int tsdbRestoreLastColumns(STsdbRepo *pRepo, STable *pTable, SReadH* pRea
   int numColumns;
   int32_t blockIdx;
   SDataStatis* pBlockStatis = NULL;
-  SMemRow      row = NULL;
   // restore last column data with last schema
   
   int err = 0;
@@ -669,16 +690,6 @@ static int tsdbRestoreLastColumns(STsdbRepo *pRepo, STable *pTable, SReadH* pRea
     }
   }
 
-  row = taosTMalloc(memRowMaxBytesFromSchema(pSchema));
-  if (row == NULL) {
-    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
-    err = -1;
-    goto out;
-  }
-
-  memRowSetType(row, SMEM_ROW_DATA);
-  tdInitDataRow(memRowDataBody(row), pSchema);
-
   // first load block index info
   if (tsdbLoadBlockInfo(pReadh, NULL) < 0) {
     err = -1;
@@ -731,14 +742,12 @@ static int tsdbRestoreLastColumns(STsdbRepo *pRepo, STable *pTable, SReadH* pRea
         continue;
       }
 
-      // OK,let's load row from backward to get not-null column
+      // OK,let's load row from backward to get not-null column, the value is taken from the column data as
+      // appending each var data value to one row would overflow it
       for (int32_t rowId = pBlock->numOfRows - 1; rowId >= 0; rowId--) {
         SDataCol *pDataCol = pReadh->pDCols[0]->cols + i;
         const void* pColData = tdGetColDataOfRow(pDataCol, rowId);
-        tdAppendColVal(memRowDataBody(row), pColData, pCol->type, pCol->offset);
-        //SDataCol *pDataCol = readh.pDCols[0]->cols + j;
-        void *value = tdGetRowDataOfCol(memRowDataBody(row), (int8_t)pCol->type, TD_DATA_ROW_HEAD_SIZE + pCol->offset);
-        if (isNull(value, pCol->type)) {
+        if (isNull(pColData, pCol->type)) {
           continue;
         }
 
@@ -753,13 +762,10 @@ static int tsdbRestoreLastColumns(STsdbRepo *pRepo, STable *pTable, SReadH* pRea
         pLastCol->pData = malloc(bytes);
         pLastCol->bytes = bytes;
         pLastCol->colId = pCol->colId;
-        memcpy(pLastCol->pData, value, bytes);
+        memcpy(pLastCol->pData, pColData, bytes);
 
         // save row ts(in column 0)
-        pDataCol = pReadh->pDCols[0]->cols + 0;
-        pCol = schemaColAt(pSchema, 0);
-        tdAppendColVal(memRowDataBody(row), tdGetColDataOfRow(pDataCol, rowId), pCol->type, pCol->offset);
-        pLastCol->ts = memRowKey(row);
+        pLastCol->ts = dataColsKeyAt(pReadh->pDCols[0], rowId);
 
         pTable->restoreColumnNum += 1;
 
@@ -770,7 +776,6 @@ static int tsdbRestoreLastColumns(STsdbRepo *pRepo, STable *pTable, SReadH* pRea
   }
 
 out:
-  taosTZfree(row);
   tfree(pBlockStatis);
 
   if (err == 0 && numColumns <= pTable->restoreColumnNum) {
@@ -818,12 +823,7 @@ int tsdbRestoreInfo(STsdbRepo *pRepo) {
   SDFileSet *pSet;
   STsdbMeta *pMeta = pRepo->tsdbMeta;
   STsdbCfg * pCfg = REPO_CFG(pRepo);
-
-  if (tsdbInitReadH(&readh, pRepo) < 0) {
-    return -1;
-  }
-
-  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_BACKWARD);
+  bool       loaded = false;
 
   if (CACHE_LAST_NULL_COLUMN(pCfg)) {
     for (int i = 1; i < pMeta->maxTables; i++) {
@@ -834,6 +834,24 @@ int tsdbRestoreInfo(STsdbRepo *pRepo) {
     }
   }
 
+  // files are not changed since the snapshot is saved, no need to scan them
+  if (tsdbLoadLastSnap(pRepo, &loaded) < 0) {
+    return -1;
+  }
+
+  if (loaded) {
+    if (CACHE_LAST_NULL_COLUMN(pCfg)) {
+      atomic_store_8(&pRepo->hasCachedLastColumn, 1);
+    }
+    return 0;
+  }
+
+  if (tsdbInitReadH(&readh, pRepo) < 0) {
+    return -1;
+  }
+
+  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_BACKWARD);
+
   while ((pSet = tsdbFSIterNext(&fsiter)) != NULL) {
     if (tsdbSetAndOpenReadFSet(&readh, pSet) < 0) {
       tsdbDestroyReadH(&readh);
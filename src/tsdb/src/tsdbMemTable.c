@@ -26,6 +26,11 @@ typedef struct {
   int32_t  totalLen;
   int32_t  len;
   SMemRow  row;
+  // for columnar submit blocks, rows are built one by one into row
+  int32_t   numOfRows;
+  int32_t   rowIdx;
+  STSchema *pSchema;
+  char **   pCols;  // null bitmap of each column, values follow
 } SSubmitBlkIter;
 
 typedef struct {
@@ -41,8 +46,11 @@ static void         tsdbFreeTableData(STableData *pTableData);
 static char *       tsdbGetTsTupleKey(const void *data);
 static int          tsdbAdjustMemMaxTables(SMemTable *pMemTable, int maxTables);
 static int          tsdbAppendTableRowToCols(STable *pTable, SDataCols *pCols, STSchema **ppSchema, SMemRow row);
-static int          tsdbInitSubmitBlkIter(SSubmitBlk *pBlock, SSubmitBlkIter *pIter);
+static int          tsdbInitSubmitBlkIter(SSubmitBlk *pBlock, STable *pTable, SSubmitBlkIter *pIter);
 static SMemRow      tsdbGetSubmitBlkNext(SSubmitBlkIter *pIter);
+static void         tsdbDestroySubmitBlkIter(SSubmitBlkIter *pIter);
+static int          tsdbCheckSubmitBlkCols(STsdbRepo *pRepo, SSubmitBlk *pBlock, STable *pTable, TSKEY minKey,
+                                           TSKEY maxKey, TSKEY now);
 static int          tsdbScanAndConvertSubmitMsg(STsdbRepo *pRepo, SSubmitMsg *pMsg);
 static int          tsdbInsertDataToTable(STsdbRepo *pRepo, SSubmitBlk *pBlock, int32_t *affectedrows);
 static int          tsdbInitSubmitMsgIter(SSubmitMsg *pMsg, SSubmitMsgIter *pIter);
@@ -600,11 +608,73 @@ static int tsdbAppendTableRowToCols(STable *pTable, SDataCols *pCols, STSchema *
   return 0;
 }
 
-static int tsdbInitSubmitBlkIter(SSubmitBlk *pBlock, SSubmitBlkIter *pIter) {
+static void tsdbBuildSubmitBlkRow(SSubmitBlkIter *pIter, int32_t idx) {
+  STSchema *pSchema = pIter->pSchema;
+  int32_t   bitmapLen = (pIter->numOfRows + 7) >> 3;
+
+  memRowSetType(pIter->row, SMEM_ROW_DATA);
+  SDataRow trow = memRowDataBody(pIter->row);
+  tdInitDataRow(trow, pSchema);
+
+  for (int i = 0; i < schemaNCols(pSchema); i++) {
+    STColumn *   pCol = schemaColAt(pSchema, i);
+    uint8_t *    bitmap = (uint8_t *)pIter->pCols[i];
+    char *       data = pIter->pCols[i] + bitmapLen;
+    const void * value = NULL;
+
+    if (bitmap[idx >> 3] & (1u << (idx & 7))) {
+      value = getNullValue(pCol->type);
+    } else if (IS_VAR_DATA_TYPE(pCol->type)) {
+      value = data + sizeof(int32_t) * pIter->numOfRows + ((int32_t *)data)[idx];
+    } else {
+      value = data + TYPE_BYTES[pCol->type] * idx;
+    }
+
+    tdAppendColVal(trow, value, pCol->type, pCol->offset);
+  }
+}
+
+static int tsdbInitSubmitBlkIter(SSubmitBlk *pBlock, STable *pTable, SSubmitBlkIter *pIter) {
   if (pBlock->dataLen <= 0) return -1;
   pIter->totalLen = pBlock->dataLen;
   pIter->len = 0;
-  pIter->row = (SMemRow)(pBlock->data + pBlock->schemaLen);
+
+  if (!(pBlock->flag & TSDB_SUBMIT_BLK_FLAG_COLUMNAR)) {
+    pIter->row = (SMemRow)(pBlock->data + pBlock->schemaLen);
+    return 0;
+  }
+
+  // the layout is checked in tsdbCheckSubmitBlkCols
+  if (pBlock->numOfRows <= 0) return -1;
+
+  STSchema *pSchema = tsdbGetTableSchemaByVersion(pTable, pBlock->sversion);
+  if (pSchema == NULL) {
+    terrno = TSDB_CODE_TDB_IVD_TB_SCHEMA_VERSION;
+    return -1;
+  }
+  int numOfCols = schemaNCols(pSchema);
+
+  char *buf = malloc(POINTER_BYTES * numOfCols + memRowMaxBytesFromSchema(pSchema));
+  if (buf == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  pIter->pCols = (char **)buf;
+  pIter->row = (SMemRow)(buf + POINTER_BYTES * numOfCols);
+  pIter->pSchema = pSchema;
+  pIter->numOfRows = pBlock->numOfRows;
+  pIter->rowIdx = 0;
+
+  char *p = pBlock->data;
+  for (int i = 0; i < numOfCols; i++) {
+    SSubmitColHead *pHead = (SSubmitColHead *)p;
+    pIter->pCols[i] = p + sizeof(SSubmitColHead);
+    p = pIter->pCols[i] + pHead->len;
+  }
+
+  // the first row is always there, so that the key of it can be got before iterating
+  tsdbBuildSubmitBlkRow(pIter, 0);
   return 0;
 }
 
@@ -612,6 +682,14 @@ static SMemRow tsdbGetSubmitBlkNext(SSubmitBlkIter *pIter) {
   SMemRow row = pIter->row;  // firstly, get current row
   if (row == NULL) return NULL;
 
+  if (pIter->pCols != NULL) {
+    // rows are copied into mem table one by one, so the same buffer can be reused
+    if (pIter->rowIdx >= pIter->numOfRows) return NULL;
+    if (pIter->rowIdx > 0) tsdbBuildSubmitBlkRow(pIter, pIter->rowIdx);
+    pIter->rowIdx++;
+    return row;
+  }
+
   pIter->len += memRowTLen(row);
   if (pIter->len >= pIter->totalLen) {  // reach the end
     pIter->row = NULL;
@@ -622,6 +700,11 @@ static SMemRow tsdbGetSubmitBlkNext(SSubmitBlkIter *pIter) {
   return row;
 }
 
+static void tsdbDestroySubmitBlkIter(SSubmitBlkIter *pIter) {
+  tfree(pIter->pCols);
+  pIter->row = NULL;
+}
+
 static FORCE_INLINE int tsdbCheckRowRange(STsdbRepo *pRepo, STable *pTable, SMemRow row, TSKEY minKey, TSKEY maxKey,
                                           TSKEY now) {
   TSKEY rowKey = memRowKey(row);
@@ -637,6 +720,75 @@ static FORCE_INLINE int tsdbCheckRowRange(STsdbRepo *pRepo, STable *pTable, SMem
   return 0;
 }
 
+// Check the layout of a columnar submit block against the table schema, and the range of its keys
+static int tsdbCheckSubmitBlkCols(STsdbRepo *pRepo, SSubmitBlk *pBlock, STable *pTable, TSKEY minKey,
+                                  TSKEY maxKey, TSKEY now) {
+  STSchema *pSchema = tsdbGetTableSchemaByVersion(pTable, pBlock->sversion);
+  int32_t   numOfRows = pBlock->numOfRows;
+  int32_t   bitmapLen = (numOfRows + 7) >> 3;
+  char *    p = pBlock->data;
+  char *    end = pBlock->data + pBlock->dataLen;
+  char *    keys = NULL;
+
+  if (pSchema == NULL || pBlock->schemaLen != 0 || numOfRows <= 0) goto _err;
+
+  for (int i = 0; i < schemaNCols(pSchema); i++) {
+    STColumn *pCol = schemaColAt(pSchema, i);
+    if (end - p < (int32_t)sizeof(SSubmitColHead)) goto _err;
+
+    SSubmitColHead *pHead = (SSubmitColHead *)p;
+    uint8_t *       bitmap = (uint8_t *)(p + sizeof(SSubmitColHead));
+    char *          data = (char *)bitmap + bitmapLen;
+    if (pHead->colId != pCol->colId || pHead->type != pCol->type || pHead->len < bitmapLen ||
+        pHead->len > end - (char *)bitmap) {
+      goto _err;
+    }
+    p = (char *)bitmap + pHead->len;
+
+    if (IS_VAR_DATA_TYPE(pCol->type)) {
+      int32_t varLen = pHead->len - bitmapLen - (int32_t)sizeof(int32_t) * numOfRows;
+      char *  vars = data + sizeof(int32_t) * numOfRows;
+      if (varLen < 0) goto _err;
+
+      for (int32_t r = 0; r < numOfRows; r++) {
+        if (bitmap[r >> 3] & (1u << (r & 7))) continue;
+
+        int32_t offset = ((int32_t *)data)[r];
+        if (offset < 0 || offset > varLen - (int32_t)VARSTR_HEADER_SIZE) goto _err;
+        int32_t tlen = (int32_t)varDataTLen(vars + offset);
+        if (tlen > pCol->bytes || offset + tlen > varLen) goto _err;
+      }
+    } else if (pHead->len - bitmapLen < TYPE_BYTES[pCol->type] * numOfRows) {
+      goto _err;
+    }
+
+    if (i == 0) keys = data;
+  }
+
+  if (p != end) goto _err;
+
+  for (int32_t r = 0; r < numOfRows; r++) {
+    TSKEY key = *(TSKEY *)(keys + TSDB_KEYSIZE * r);
+    if (key < minKey || key > maxKey) {
+      tsdbError("vgId:%d table %s tid %d uid %" PRIu64 " timestamp is out of range! now %" PRId64 " minKey %" PRId64
+                " maxKey %" PRId64 " row key %" PRId64,
+                REPO_ID(pRepo), TABLE_CHAR_NAME(pTable), TABLE_TID(pTable), TABLE_UID(pTable), now, minKey, maxKey,
+                key);
+      terrno = TSDB_CODE_TDB_TIMESTAMP_OUT_OF_RANGE;
+      return -1;
+    }
+  }
+
+  return 0;
+
+_err:
+  tsdbError("vgId:%d table %s tid %d uid %" PRIu64 " columnar submit block is messed up, sversion %d rows %d len %d",
+            REPO_ID(pRepo), TABLE_CHAR_NAME(pTable), TABLE_TID(pTable), TABLE_UID(pTable), pBlock->sversion,
+            numOfRows, pBlock->dataLen);
+  terrno = TSDB_CODE_TDB_SUBMIT_MSG_MSSED_UP;
+  return -1;
+}
+
 static int tsdbScanAndConvertSubmitMsg(STsdbRepo *pRepo, SSubmitMsg *pMsg) {
   ASSERT(pMsg != NULL);
   STsdbMeta *    pMeta = pRepo->tsdbMeta;
@@ -659,6 +811,7 @@ static int tsdbScanAndConvertSubmitMsg(STsdbRepo *pRepo, SSubmitMsg *pMsg) {
 
     pBlock->uid = htobe64(pBlock->uid);
     pBlock->tid = htonl(pBlock->tid);
+    pBlock->flag = htonl(pBlock->flag);
     pBlock->sversion = htonl(pBlock->sversion);
     pBlock->dataLen = htonl(pBlock->dataLen);
     pBlock->schemaLen = htonl(pBlock->schemaLen);
@@ -694,7 +847,14 @@ static int tsdbScanAndConvertSubmitMsg(STsdbRepo *pRepo, SSubmitMsg *pMsg) {
       }
     }
 
-    tsdbInitSubmitBlkIter(pBlock, &blkIter);
+    if (pBlock->flag & TSDB_SUBMIT_BLK_FLAG_COLUMNAR) {
+      if (tsdbCheckSubmitBlkCols(pRepo, pBlock, pTable, minKey, maxKey, now) < 0) {
+        return -1;
+      }
+      continue;
+    }
+
+    tsdbInitSubmitBlkIter(pBlock, pTable, &blkIter);
     while ((row = tsdbGetSubmitBlkNext(&blkIter)) != NULL) {
       if (tsdbCheckRowRange(pRepo, pTable, row, minKey, maxKey, now) < 0) {
         return -1;
@@ -778,6 +938,25 @@ static void tsdbSetupSkipListHookFns(SSkipList* pSkipList, STsdbRepo *pRepo, STa
   pSkipList->insertHandleFn->args[7] = pLastRow;
 }
 
+// only the rows appended after the last key of the table are in order, others may be duplicated or updated
+static void tsdbFeedCq(STsdbRepo *pRepo, STable *pTable, SSubmitBlk *pBlock, TSKEY lastKey) {
+  SSubmitBlkIter blkIter = {0};
+  SMemRow        row = NULL;
+  STSchema      *pSchema = tsdbGetTableSchemaByVersion(pTable, pBlock->sversion);
+
+  if (tsdbInitSubmitBlkIter(pBlock, pTable, &blkIter) < 0) return;
+
+  while ((row = tsdbGetSubmitBlkNext(&blkIter)) != NULL) {
+    TSKEY key = memRowKey(row);
+    bool  inOrder = (key > lastKey) && !memRowDeleted(row);
+    if (inOrder) lastKey = key;
+
+    (*pRepo->appH.cqFeedFunc)(pRepo->appH.cqH, TABLE_UID(pTable), pSchema, row, inOrder);
+  }
+
+  tsdbDestroySubmitBlkIter(&blkIter);
+}
+
 static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *pAffectedRows) {
 
   STsdbMeta       *pMeta = pRepo->tsdbMeta;
@@ -788,19 +967,16 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
   STableData      *pTableData = NULL;
   STsdbCfg        *pCfg = &(pRepo->config);
 
-  tsdbInitSubmitBlkIter(pBlock, &blkIter);
-  if(blkIter.row == NULL) return 0;
-  TSKEY firstRowKey = memRowKey(blkIter.row);
+  ASSERT(pBlock->tid < pMeta->maxTables);
+  pTable = pMeta->tables[pBlock->tid];
+  ASSERT(pTable != NULL && TABLE_UID(pTable) == pBlock->uid);
+
+  if (pBlock->dataLen <= 0) return 0;
 
   tsdbAllocBytes(pRepo, 0);
   pMemTable = pRepo->mem;
 
   ASSERT(pMemTable != NULL);
-  ASSERT(pBlock->tid < pMeta->maxTables);
-
-  pTable = pMeta->tables[pBlock->tid];
-
-  ASSERT(pTable != NULL && TABLE_UID(pTable) == pBlock->uid);
 
 
   if (TABLE_TID(pTable) >= pMemTable->maxTables) {
@@ -830,10 +1006,15 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
 
   ASSERT((pTableData != NULL) && pTableData->uid == TABLE_UID(pTable));
 
+  if (tsdbInitSubmitBlkIter(pBlock, pTable, &blkIter) < 0) return -1;
+  TSKEY firstRowKey = memRowKey(blkIter.row);
+  TSKEY tableLastKey = pTable->lastKey;
+
   SMemRow lastRow = NULL;
   int64_t osize = SL_SIZE(pTableData->pData);
   tsdbSetupSkipListHookFns(pTableData->pData, pRepo, pTable, &points, &lastRow);
   tSkipListPutBatchByIter(pTableData->pData, &blkIter, (iter_next_fn_t)tsdbGetSubmitBlkNext);
+  tsdbDestroySubmitBlkIter(&blkIter);
   int64_t dsize = SL_SIZE(pTableData->pData) - osize;
   (*pAffectedRows) += points;
 
@@ -852,6 +1033,10 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
     }
   }
 
+  if (pRepo->appH.cqAcceptFunc != NULL && (*pRepo->appH.cqAcceptFunc)(pRepo->appH.cqH, TABLE_UID(pTable))) {
+    tsdbFeedCq(pRepo, pTable, pBlock, tableLastKey);
+  }
+
   STSchema *pSchema = tsdbGetTableSchemaByVersion(pTable, pBlock->sversion);
   pRepo->stat.pointsWritten += points * schemaNCols(pSchema);
   pRepo->stat.totalStorage += points * schemaVLen(pSchema);
@@ -25,6 +25,8 @@ static int     tsdbAddTableToMeta(STsdbRepo *pRepo, STable *pTable, bool addIdx,
 static void    tsdbRemoveTableFromMeta(STsdbRepo *pRepo, STable *pTable, bool rmFromIdx, bool lock);
 static int     tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable, bool refSuper);
 static int     tsdbRemoveTableFromIndex(STsdbMeta *pMeta, STable *pTable);
+static void    tsdbAddTableIntoTagIndex(STable *pSTable, STable *pTable);
+static void    tsdbRebuildTagIndex(STsdbRepo *pRepo, STable *pSTable);
 static int     tsdbInitTableCfg(STableCfg *config, ETableType type, uint64_t uid, int32_t tid);
 static int     tsdbTableSetSchema(STableCfg *config, STSchema *pSchema, bool dup);
 static int     tsdbTableSetName(STableCfg *config, char *name, bool dup);
@@ -105,6 +107,7 @@ int tsdbCreateTable(STsdbRepo *repo, STableCfg *pCfg) {
         super->tagSchema = tdDupSchema(pCfg->tagSchema);
         TSDB_WUNLOCK_TABLE(super);
         tdFreeSchema(pOldSchema);
+        tsdbRebuildTagIndex(pRepo, super);
 
         superChanged = true;
       }
@@ -229,6 +232,20 @@ char *tsdbGetTableName(void* pTable) {
   }
 }
 
+TSKEY tsdbGetTableLastKey(STsdbRepo *repo, uint64_t uid) {
+  TSKEY lastKey = TSKEY_INITIAL_VAL;
+
+  if (tsdbRLockRepoMeta(repo) < 0) return lastKey;
+
+  STable *pTable = tsdbGetTableByUid(tsdbGetMeta(repo), uid);
+  if (pTable != NULL && TABLE_TYPE(pTable) != TSDB_SUPER_TABLE) {
+    lastKey = tsdbGetTableLastKeyImpl(pTable);
+  }
+
+  tsdbUnlockRepoMeta(repo);
+  return lastKey;
+}
+
 STableCfg *tsdbCreateTableCfgFromMsg(SMDCreateTableMsg *pMsg) {
   if (pMsg == NULL) return NULL;
 
@@ -386,23 +403,29 @@ int tsdbUpdateTableTagValue(STsdbRepo *repo, SUpdateTableTagValMsg *pMsg) {
     pTable->pSuper->tagSchema = pNewSchema;
     tdFreeSchema(pOldSchema);
     TSDB_WUNLOCK_TABLE(pTable->pSuper);
+    tsdbRebuildTagIndex(pRepo, pTable->pSuper);
   }
 
   bool      isChangeIndexCol = (pMsg->colId == colColId(schemaColAt(pTable->pSuper->tagSchema, 0)));
   // STColumn *pCol = bsearch(&(pMsg->colId), pMsg->data, pMsg->numOfTags, sizeof(STColumn), colIdCompar);
   // ASSERT(pCol != NULL);
 
+  // all tag columns are in the tag index, so the table is always re-indexed
+  tsdbWLockRepoMeta(pRepo);
   if (isChangeIndexCol) {
-    tsdbWLockRepoMeta(pRepo);
     tsdbRemoveTableFromIndex(pMeta, pTable);
+  } else if (pTable->pSuper->pTagIndex != NULL) {
+    tsdbTagIndexRemoveTable(pTable->pSuper->pTagIndex, pTable);
   }
   TSDB_WLOCK_TABLE(pTable);
   tdSetKVRowDataOfCol(&(pTable->tagVal), pMsg->colId, pMsg->type, POINTER_SHIFT(pMsg->data, pMsg->schemaLen));
   TSDB_WUNLOCK_TABLE(pTable);
   if (isChangeIndexCol) {
     tsdbAddTableIntoIndex(pMeta, pTable, false);
-    tsdbUnlockRepoMeta(pRepo);
+  } else {
+    tsdbAddTableIntoTagIndex(pTable->pSuper, pTable);
   }
+  tsdbUnlockRepoMeta(pRepo);
 
   // Update on file
   int tlen1 = (pNewSchema) ? tsdbGetTableEncodeSize(TSDB_UPDATE_META, pTable->pSuper) : 0;
@@ -852,6 +875,8 @@ static STable *tsdbCreateTableFromCfg(STableCfg *pCfg, bool isSuper, STable *pST
       terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
       goto _err;
     }
+    pTable->pTagIndex = tsdbNewTagIndex(pTable->tagSchema);
+    if (pTable->pTagIndex == NULL) goto _err;
   } else {
     pTable->type = pCfg->type;
     tsize = strnlen(pCfg->name, TSDB_TABLE_NAME_LEN - 1);
@@ -920,6 +945,7 @@ static void tsdbFreeTable(STable *pTable) {
     kvRowFree(pTable->tagVal);
 
     tSkipListDestroy(pTable->pIndex);
+    tsdbFreeTagIndex(pTable->pTagIndex);
     taosTZfree(pTable->lastRow);    
     tfree(pTable->sql);
 
@@ -1044,6 +1070,41 @@ static void tsdbRemoveTableFromMeta(STsdbRepo *pRepo, STable *pTable, bool rmFro
   tsdbUnRefTable(pTable);
 }
 
+static void tsdbAddTableIntoTagIndex(STable *pSTable, STable *pTable) {
+  if (pSTable->pTagIndex == NULL) return;
+
+  if (tsdbTagIndexAddTable(pSTable->pTagIndex, pTable) < 0) {
+    // the tag index only speeds up tag filtering, queries scan the skiplist index without it
+    tsdbWarn("failed to add table %s to tag index of %s since %s, tag index is dropped", TABLE_CHAR_NAME(pTable),
+             TABLE_CHAR_NAME(pSTable), tstrerror(terrno));
+    tsdbFreeTagIndex(pSTable->pTagIndex);
+    pSTable->pTagIndex = NULL;
+  }
+}
+
+// Tag columns are added or dropped, the tag index is built again from all child tables in the skiplist index
+static void tsdbRebuildTagIndex(STsdbRepo *pRepo, STable *pSTable) {
+  tsdbWLockRepoMeta(pRepo);
+
+  tsdbFreeTagIndex(pSTable->pTagIndex);
+  pSTable->pTagIndex = tsdbNewTagIndex(pSTable->tagSchema);
+  if (pSTable->pTagIndex == NULL) {
+    tsdbWarn("vgId:%d failed to rebuild tag index of %s since %s", REPO_ID(pRepo), TABLE_CHAR_NAME(pSTable),
+             tstrerror(terrno));
+    tsdbUnlockRepoMeta(pRepo);
+    return;
+  }
+
+  SSkipListIterator *pIter = tSkipListCreateIter(pSTable->pIndex);
+  while (pSTable->pTagIndex != NULL && tSkipListIterNext(pIter)) {
+    STable *pTable = (STable *)SL_GET_NODE_DATA(tSkipListIterGet(pIter));
+    tsdbAddTableIntoTagIndex(pSTable, pTable);
+  }
+  tSkipListDestroyIter(pIter);
+
+  tsdbUnlockRepoMeta(pRepo);
+}
+
 static int tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable, bool refSuper) {
   ASSERT(pTable->type == TSDB_CHILD_TABLE && pTable != NULL);
   STable *pSTable = tsdbGetTableByUid(pMeta, TABLE_SUID(pTable));
@@ -1052,6 +1113,7 @@ static int tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable, bool refSuper
   pTable->pSuper = pSTable;
 
   tSkipListPut(pSTable->pIndex, (void *)pTable);
+  tsdbAddTableIntoTagIndex(pSTable, pTable);
 
   if (refSuper) T_REF_INC(pSTable);
   return 0;
@@ -1063,6 +1125,8 @@ static int tsdbRemoveTableFromIndex(STsdbMeta *pMeta, STable *pTable) {
   STable *pSTable = pTable->pSuper;
   ASSERT(pSTable != NULL);
 
+  if (pSTable->pTagIndex != NULL) tsdbTagIndexRemoveTable(pSTable->pTagIndex, pTable);
+
   char* key = getTagIndexKey(pTable);
   SArray *res = tSkipListGet(pSTable->pIndex, key);
 
@@ -1323,6 +1387,11 @@ static void *tsdbDecodeTable(void *buf, STable **pRTable) {
         tsdbFreeTable(pTable);
         return NULL;
       }
+      pTable->pTagIndex = tsdbNewTagIndex(pTable->tagSchema);
+      if (pTable->pTagIndex == NULL) {
+        tsdbFreeTable(pTable);
+        return NULL;
+      }
     }
 
     if (TABLE_TYPE(pTable) == TSDB_STREAM_TABLE) {
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tsdbint.h"
+
+/*
+ * Retention only moves a file set to the tier of its age (keep1/keep2) when a commit happens to run on the vnode, so
+ * data of a vnode without new writes stays on the hot tier forever. Migration does the same move in background: one
+ * aged file set is copied to its tier under temporary names without blocking commits. readyToCommit is only taken to
+ * check the file set was not changed by a commit or compact meanwhile, and to switch to the copy by a file system
+ * transaction. Expired file sets are removed on the way.
+ */
+#define TSDB_MIGRATE_COPY_SIZE (1024 * 1024)
+#define TSDB_MIGRATE_TNAME_LEN (TSDB_FILENAME_LEN + 8)
+#define TSDB_MIGRATE_TSUFFIX ".mig"
+
+enum { TSDB_NO_MIGRATE, TSDB_IN_MIGRATE };
+
+typedef struct {
+  STsdbRepo *pRepo;
+  SRtn       rtn;
+  int64_t    startTime;
+  int64_t    copied;
+  void *     pBuf;
+  bool       hasExpired;
+  bool       hasCopy;
+  SDFileSet  oSet;  // the file set copied, as it was when the copy started
+  SDFileSet  tSet;  // the copy, files are named after it with TSDB_MIGRATE_TSUFFIX
+} SMigrateH;
+
+static bool tsdbShouldMigrateFSet(STsdbRepo *pRepo, SDFileSet *pSet, SRtn *pRtn);
+static bool tsdbPickFSetToMigrate(SMigrateH *pMigrh);
+static bool tsdbIsSameDFileSet(SDFileSet *pSet1, SDFileSet *pSet2);
+static bool tsdbIsFSetChanged(SMigrateH *pMigrh);
+static void tsdbGetMigrateTName(SDFile *pDFile, char *tname);
+static void tsdbRemoveMigrateCopy(SMigrateH *pMigrh);
+static int  tsdbCopyFSetToTier(SMigrateH *pMigrh);
+static int  tsdbSwitchMigrateFSet(SMigrateH *pMigrh);
+static int  tsdbApplyMigrateCopy(SMigrateH *pMigrh, SDFileSet *pSet);
+static void tsdbStartMigrate(STsdbRepo *pRepo);
+static void tsdbEndMigrate(STsdbRepo *pRepo, int eno);
+static int  tsdbMigrateDFile(SMigrateH *pMigrh, SDFile *pSrc, const char *tname);
+static void tsdbMigrateThrottle(SMigrateH *pMigrh);
+
+static FORCE_INLINE int32_t *tsdbFSetReadSlot(STsdbRepo *pRepo, int fid) {
+  return pRepo->fsetReads + (((fid % TSDB_FSET_READ_SLOTS) + TSDB_FSET_READ_SLOTS) % TSDB_FSET_READ_SLOTS);
+}
+
+void tsdbRecordFSetRead(STsdbRepo *pRepo, int fid) { atomic_add_fetch_32(tsdbFSetReadSlot(pRepo, fid), 1); }
+
+int tsdbMigrate(STsdbRepo *pRepo) {
+  SMigrateH migrh;
+  int       ret;
+
+  if (pRepo->state != TSDB_STATE_OK || tsdbGetCompactState(pRepo) != 0) {
+    return 0;
+  }
+
+  memset(&migrh, 0, sizeof(migrh));
+  migrh.pRepo = pRepo;
+  migrh.startTime = taosGetTimestampMs();
+  tsdbGetRtnSnap(pRepo, &(migrh.rtn));
+
+  if (!tsdbPickFSetToMigrate(&migrh)) {
+    // A migration pass is over, start to count reads of the next one
+    for (int i = 0; i < TSDB_FSET_READ_SLOTS; i++) {
+      atomic_store_32(pRepo->fsetReads + i, 0);
+    }
+    return 0;
+  }
+
+  // Copy without readyToCommit, commits go on during the copy
+  if (migrh.hasCopy && tsdbCopyFSetToTier(&migrh) < 0) {
+    tfree(migrh.pBuf);
+    if (tsdbIsFSetChanged(&migrh)) {
+      // Files of the set are replaced by a commit or compact, the new set is tried in the next pass
+      tsdbInfo("vgId:%d FSET %d is changed during migration, drop the copy", REPO_ID(pRepo), migrh.oSet.fid);
+      return 0;
+    }
+    tsdbError("vgId:%d failed to copy FSET %d to level %d since %s", REPO_ID(pRepo), migrh.oSet.fid,
+              TSDB_FSET_LEVEL(&(migrh.tSet)), tstrerror(terrno));
+    return -1;
+  }
+  tfree(migrh.pBuf);
+
+  if (!migrh.hasCopy && !migrh.hasExpired) {
+    // No disk available on higher levels, keep it where it is
+    return 0;
+  }
+
+  // Wait for the running commit or compact
+  tsem_wait(&(pRepo->readyToCommit));
+  if (pRepo->state != TSDB_STATE_OK || REPO_FS(pRepo)->cstatus->pmf == NULL) {
+    tsem_post(&(pRepo->readyToCommit));
+    if (migrh.hasCopy) tsdbRemoveMigrateCopy(&migrh);
+    return 0;
+  }
+
+  ret = tsdbSwitchMigrateFSet(&migrh);
+  if (ret < 0) {
+    tsdbError("vgId:%d failed to migrate FSET %d since %s", REPO_ID(pRepo), migrh.oSet.fid, tstrerror(terrno));
+  }
+
+  return ret;
+}
+
+static bool tsdbShouldMigrateFSet(STsdbRepo *pRepo, SDFileSet *pSet, SRtn *pRtn) {
+  int level = MIN(tsdbGetFidLevel(pSet->fid, pRtn), tfsGetLevelNum() - 1);
+
+  if (level <= TSDB_FSET_LEVEL(pSet)) return false;
+
+  int32_t nreads = atomic_load_32(tsdbFSetReadSlot(pRepo, pSet->fid));
+  if (tsMigrateHotReads > 0 && nreads >= tsMigrateHotReads) {
+    tsdbDebug("vgId:%d FSET %d is read %d times since last migration, keep it on level %d", REPO_ID(pRepo),
+              pSet->fid, nreads, TSDB_FSET_LEVEL(pSet));
+    return false;
+  }
+
+  return true;
+}
+
+// Find expired file sets and the first one to move, which is kept in pMigrh->oSet
+static bool tsdbPickFSetToMigrate(SMigrateH *pMigrh) {
+  STsdbRepo *pRepo = pMigrh->pRepo;
+  STsdbFS *  pfs = REPO_FS(pRepo);
+
+  tsdbRLockFS(pfs);
+  if (pfs->cstatus->pmf != NULL) {
+    for (size_t i = 0; i < taosArrayGetSize(pfs->cstatus->df); i++) {
+      SDFileSet *pSet = (SDFileSet *)taosArrayGet(pfs->cstatus->df, i);
+      if (pSet->fid < pMigrh->rtn.minFid) {
+        pMigrh->hasExpired = true;
+      } else if (!pMigrh->hasCopy && tsdbShouldMigrateFSet(pRepo, pSet, &(pMigrh->rtn))) {
+        pMigrh->hasCopy = true;
+        pMigrh->oSet = *pSet;
+      }
+    }
+  }
+  tsdbUnLockFS(pfs);
+
+  return pMigrh->hasExpired || pMigrh->hasCopy;
+}
+
+static bool tsdbIsSameDFileSet(SDFileSet *pSet1, SDFileSet *pSet2) {
+  if (pSet1->fid != pSet2->fid || TSDB_FSET_LEVEL(pSet1) != TSDB_FSET_LEVEL(pSet2) ||
+      TSDB_FSET_ID(pSet1) != TSDB_FSET_ID(pSet2)) {
+    return false;
+  }
+
+  for (TSDB_FILE_T ftype = 0; ftype < TSDB_FILE_MAX; ftype++) {
+    SDFile *pDFile1 = TSDB_DFILE_IN_SET(pSet1, ftype);
+    SDFile *pDFile2 = TSDB_DFILE_IN_SET(pSet2, ftype);
+    if (strcmp(TSDB_FILE_FULL_NAME(pDFile1), TSDB_FILE_FULL_NAME(pDFile2)) != 0 ||
+        memcmp(TSDB_FILE_INFO(pDFile1), TSDB_FILE_INFO(pDFile2), sizeof(SDFInfo)) != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool tsdbIsFSetChanged(SMigrateH *pMigrh) {
+  STsdbFS *pfs = REPO_FS(pMigrh->pRepo);
+  bool     changed = true;
+
+  tsdbRLockFS(pfs);
+  for (size_t i = 0; i < taosArrayGetSize(pfs->cstatus->df); i++) {
+    SDFileSet *pSet = (SDFileSet *)taosArrayGet(pfs->cstatus->df, i);
+    if (pSet->fid == pMigrh->oSet.fid) {
+      changed = !tsdbIsSameDFileSet(pSet, &(pMigrh->oSet));
+      break;
+    }
+  }
+  tsdbUnLockFS(pfs);
+
+  return changed;
+}
+
+static void tsdbGetMigrateTName(SDFile *pDFile, char *tname) {
+  snprintf(tname, TSDB_MIGRATE_TNAME_LEN, "%s%s", TSDB_FILE_FULL_NAME(pDFile), TSDB_MIGRATE_TSUFFIX);
+}
+
+static void tsdbRemoveMigrateCopy(SMigrateH *pMigrh) {
+  char tname[TSDB_MIGRATE_TNAME_LEN];
+
+  for (TSDB_FILE_T ftype = 0; ftype < TSDB_FILE_MAX; ftype++) {
+    tsdbGetMigrateTName(TSDB_DFILE_IN_SET(&(pMigrh->tSet), ftype), tname);
+    (void)remove(tname);
+  }
+}
+
+static int tsdbCopyFSetToTier(SMigrateH *pMigrh) {
+  STsdbRepo *pRepo = pMigrh->pRepo;
+  SDFileSet *pSet = &(pMigrh->oSet);
+  SDiskID    did;
+  char       tname[TSDB_MIGRATE_TNAME_LEN];
+  char       dataDir[TSDB_FILENAME_LEN];
+
+  tfsAllocDisk(tsdbGetFidLevel(pSet->fid, &(pMigrh->rtn)), &(did.level), &(did.id));
+  if (did.level == TFS_UNDECIDED_LEVEL) {
+    terrno = TSDB_CODE_TDB_NO_AVAIL_DISK;
+    return -1;
+  }
+
+  if (did.level <= TSDB_FSET_LEVEL(pSet)) {
+    pMigrh->hasCopy = false;
+    return 0;
+  }
+
+  // A disk mounted after the vnode was created has no data directory of it yet
+  tsdbGetDataDir(REPO_ID(pRepo), dataDir);
+  if (tfsMkdirRecurAt(dataDir, did.level, did.id) < 0) {
+    return -1;
+  }
+
+  pMigrh->pBuf = malloc(TSDB_MIGRATE_COPY_SIZE);
+  if (pMigrh->pBuf == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  // The version of the copy is decided when switching to it, name it by version 0 before that
+  tsdbInitDFileSet(&(pMigrh->tSet), did, REPO_ID(pRepo), pSet->fid, 0);
+
+  for (TSDB_FILE_T ftype = 0; ftype < TSDB_FILE_MAX; ftype++) {
+    tsdbGetMigrateTName(TSDB_DFILE_IN_SET(&(pMigrh->tSet), ftype), tname);
+    if (tsdbMigrateDFile(pMigrh, TSDB_DFILE_IN_SET(pSet, ftype), tname) < 0) {
+      tsdbRemoveMigrateCopy(pMigrh);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int tsdbSwitchMigrateFSet(SMigrateH *pMigrh) {
+  STsdbRepo *pRepo = pMigrh->pRepo;
+  STsdbFS *  pfs = REPO_FS(pRepo);
+  SFSIter    fsIter;
+  SDFileSet *pSet;
+  bool       switched = false;
+
+  tsdbStartMigrate(pRepo);
+
+  tsdbUpdateMFile(pfs, pfs->cstatus->pmf);
+
+  tsdbFSIterInit(&fsIter, pfs, TSDB_FS_ITER_FORWARD);
+  while ((pSet = tsdbFSIterNext(&fsIter))) {
+    if (pSet->fid < pMigrh->rtn.minFid) {
+      tsdbInfo("vgId:%d FSET %d on level %d disk id %d expires, remove it", REPO_ID(pRepo), pSet->fid,
+               TSDB_FSET_LEVEL(pSet), TSDB_FSET_ID(pSet));
+      continue;
+    }
+
+    if (pMigrh->hasCopy && pSet->fid == pMigrh->oSet.fid && tsdbIsSameDFileSet(pSet, &(pMigrh->oSet))) {
+      if (tsdbApplyMigrateCopy(pMigrh, pSet) < 0) goto _err;
+      switched = true;
+      continue;
+    }
+
+    if (tsdbUpdateDFileSet(pfs, pSet) < 0) {
+      goto _err;
+    }
+  }
+
+  if (pMigrh->hasCopy && !switched) {
+    tsdbInfo("vgId:%d FSET %d is changed during migration, drop the copy", REPO_ID(pRepo), pMigrh->oSet.fid);
+    tsdbRemoveMigrateCopy(pMigrh);
+  }
+
+  tsdbEndMigrate(pRepo, TSDB_CODE_SUCCESS);
+  // Go on with the next file set unless this one has to be copied again
+  return (switched || !pMigrh->hasCopy) ? 1 : 0;
+
+_err:
+  if (pMigrh->hasCopy && !switched) tsdbRemoveMigrateCopy(pMigrh);
+  tsdbEndMigrate(pRepo, terrno);
+  return -1;
+}
+
+static int tsdbApplyMigrateCopy(SMigrateH *pMigrh, SDFileSet *pSet) {
+  STsdbRepo *pRepo = pMigrh->pRepo;
+  STsdbFS *  pfs = REPO_FS(pRepo);
+  SDiskID    did = {.level = TSDB_FSET_LEVEL(&(pMigrh->tSet)), .id = TSDB_FSET_ID(&(pMigrh->tSet))};
+  SDFileSet  nSet;
+  char       tname[TSDB_MIGRATE_TNAME_LEN];
+
+  tsdbInitDFileSet(&nSet, did, REPO_ID(pRepo), pSet->fid, FS_TXN_VERSION(pfs));
+
+  for (TSDB_FILE_T ftype = 0; ftype < TSDB_FILE_MAX; ftype++) {
+    SDFile *pDFile = TSDB_DFILE_IN_SET(&nSet, ftype);
+
+    tsdbGetMigrateTName(TSDB_DFILE_IN_SET(&(pMigrh->tSet), ftype), tname);
+    if (taosRename(tname, TSDB_FILE_FULL_NAME(pDFile)) < 0) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      tsdbRemoveMigrateCopy(pMigrh);
+      tsdbRemoveDFileSet(&nSet);
+      return -1;
+    }
+    tsdbSetDFileInfo(pDFile, TSDB_FILE_INFO(TSDB_DFILE_IN_SET(pSet, ftype)));
+  }
+
+  if (tsdbUpdateDFileSet(pfs, &nSet) < 0) {
+    tsdbRemoveDFileSet(&nSet);
+    return -1;
+  }
+
+  tsdbInfo("vgId:%d FSET %d is migrated from level %d disk id %d to level %d disk id %d, %" PRId64 " bytes in %" PRId64
+           " ms",
+           REPO_ID(pRepo), pSet->fid, TSDB_FSET_LEVEL(pSet), TSDB_FSET_ID(pSet), did.level, did.id, pMigrh->copied,
+           taosGetTimestampMs() - pMigrh->startTime);
+  return 0;
+}
+
+static void tsdbStartMigrate(STsdbRepo *pRepo) {
+  assert(pRepo->migrateState == TSDB_NO_MIGRATE);
+  tsdbInfo("vgId:%d start to migrate!", REPO_ID(pRepo));
+  tsdbStartFSTxn(pRepo, 0, 0);
+  pRepo->code = TSDB_CODE_SUCCESS;
+  pRepo->migrateState = TSDB_IN_MIGRATE;
+}
+
+static void tsdbEndMigrate(STsdbRepo *pRepo, int eno) {
+  if (eno != TSDB_CODE_SUCCESS) {
+    tsdbEndFSTxnWithError(REPO_FS(pRepo));
+  } else {
+    tsdbEndFSTxn(pRepo);
+  }
+  pRepo->migrateState = TSDB_NO_MIGRATE;
+  tsdbInfo("vgId:%d migrate over, %s", REPO_ID(pRepo), (eno == TSDB_CODE_SUCCESS) ? "succeed" : "failed");
+  tsem_post(&(pRepo->readyToCommit));
+}
+
+// Same as tsdbCopyDFile, but copies in big pieces throttled to migrateBandwidth
+static int tsdbMigrateDFile(SMigrateH *pMigrh, SDFile *pSrc, const char *tname) {
+  int     fdFrom = -1, fdTo = -1;
+  int64_t nread;
+
+  fdFrom = open(TSDB_FILE_FULL_NAME(pSrc), O_RDONLY | O_BINARY);
+  if (fdFrom < 0) goto _err;
+
+  // A copy left by a crash is not in the FS, it is removed at restart, so an old one here is truncated
+  fdTo = open(tname, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0755);
+  if (fdTo < 0) goto _err;
+
+  while ((nread = taosRead(fdFrom, pMigrh->pBuf, TSDB_MIGRATE_COPY_SIZE)) > 0) {
+    if (taosWrite(fdTo, pMigrh->pBuf, nread) < nread) goto _err;
+    pMigrh->copied += nread;
+    tsdbMigrateThrottle(pMigrh);
+  }
+  if (nread < 0) goto _err;
+
+  if (taosFsync(fdTo) < 0) goto _err;
+
+  taosClose(fdFrom);
+  taosClose(fdTo);
+  return 0;
+
+_err:
+  terrno = TAOS_SYSTEM_ERROR(errno);
+  if (fdFrom >= 0) taosClose(fdFrom);
+  if (fdTo >= 0) taosClose(fdTo);
+  return -1;
+}
+
+static void tsdbMigrateThrottle(SMigrateH *pMigrh) {
+  if (tsMigrateBandwidth <= 0) return;
+
+  int64_t expectMs = pMigrh->copied * 1000 / ((int64_t)tsMigrateBandwidth * 1024 * 1024);
+  int64_t elapsedMs = taosGetTimestampMs() - pMigrh->startTime;
+  if (expectMs > elapsedMs) taosMsleep((int32_t)(expectMs - elapsedMs));
+}
@@ -141,10 +141,15 @@ typedef struct STsdbQueryHandle {
   SArray        *defaultLoadColumn;// default load column
   SDataBlockLoadInfo dataBlockLoadInfo; /* record current block load information */
   SLoadCompBlockInfo compBlockLoadInfo; /* record current compblock information in SQueryAttr */
+  SRollupR      *pRollup;          // rollup tiers of file sets, NULL if not used by the query
+  SRollupBlock  *pRollupBlock;     // current file block returned bucket by bucket, NULL if it is returned as a whole
+  int32_t        rollupBucket;     // current bucket in pRollupBlock
 
   SArray        *prev;             // previous row which is before than time window
   SArray        *next;             // next row which is after the query time window
   SIOCostSummary cost;
+  bool         (*killedFp)(void *param);  // check if the query is killed in long loops, to abort it in time
+  void          *killedParam;
 } STsdbQueryHandle;
 
 typedef struct STableGroupSupporter {
@@ -153,6 +158,15 @@ typedef struct STableGroupSupporter {
   STSchema*  pTagSchema;
 } STableGroupSupporter;
 
+static FORCE_INLINE bool isQueryHandleKilled(STsdbQueryHandle* pQueryHandle) {
+  if (pQueryHandle->killedFp != NULL && (*pQueryHandle->killedFp)(pQueryHandle->killedParam)) {
+    terrno = TSDB_CODE_TSC_QUERY_CANCELLED;
+    return true;
+  }
+
+  return false;
+}
+
 static STimeWindow updateLastrowForEachGroup(STableGroupInfo *groupList);
 static int32_t checkForCachedLastRow(STsdbQueryHandle* pQueryHandle, STableGroupInfo *groupList);
 static int32_t checkForCachedLast(STsdbQueryHandle* pQueryHandle);
@@ -474,6 +488,11 @@ static STsdbQueryHandle* tsdbQueryTablesImpl(STsdbRepo* tsdb, STsdbQueryCond* pC
   tsdbInitDataBlockLoadInfo(&pQueryHandle->dataBlockLoadInfo);
   tsdbInitCompBlockLoadInfo(&pQueryHandle->compBlockLoadInfo);
 
+  // the query goes on without rollup if it fails to allocate the reader
+  if (pCond->rollupInterval > 0) {
+    pQueryHandle->pRollup = tsdbNewRollupR(tsdb, pCond->rollupInterval, pCond->rollupIntervalUnit);
+  }
+
   return (TsdbQueryHandleT) pQueryHandle;
 
   _end:
@@ -545,6 +564,7 @@ void tsdbResetQueryHandle(TsdbQueryHandleT queryHandle, STsdbQueryCond *pCond) {
 
   tsdbInitDataBlockLoadInfo(&pQueryHandle->dataBlockLoadInfo);
   tsdbInitCompBlockLoadInfo(&pQueryHandle->compBlockLoadInfo);
+  pQueryHandle->pRollupBlock = NULL;
 
   resetCheckInfo(pQueryHandle);
 }
@@ -573,6 +593,7 @@ void tsdbResetQueryHandleForNewTable(TsdbQueryHandleT queryHandle, STsdbQueryCon
 
   tsdbInitDataBlockLoadInfo(&pQueryHandle->dataBlockLoadInfo);
   tsdbInitCompBlockLoadInfo(&pQueryHandle->compBlockLoadInfo);
+  pQueryHandle->pRollupBlock = NULL;
 
   SArray* pTable = NULL;
   STsdbMeta* pMeta = tsdbGetMeta(pQueryHandle->pTsdb);
@@ -1154,6 +1175,11 @@ static int32_t getFileCompInfo(STsdbQueryHandle* pQueryHandle, int32_t* numOfBlo
     numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
 
     for (int32_t i = 0; i < numOfTables; ++i) {
+      if ((i & 0x3F) == 0 && isQueryHandleKilled(pQueryHandle)) {
+        pQueryHandle->cost.headFileLoadTime += (taosGetTimestampUs() - s);
+        return TSDB_CODE_TSC_QUERY_CANCELLED;
+      }
+
       code = loadBlockInfo(pQueryHandle, i, numOfBlocks);
       if (code != TSDB_CODE_SUCCESS) {
         int64_t e = taosGetTimestampUs();
@@ -1245,6 +1271,31 @@ static void moveDataToFront(STsdbQueryHandle* pQueryHandle, int32_t numOfRows, i
 static void doCheckGeneratedBlockRange(STsdbQueryHandle* pQueryHandle);
 static void copyAllRemainRowsFromFileBlock(STsdbQueryHandle* pQueryHandle, STableCheckInfo* pCheckInfo, SDataBlockInfo* pBlockInfo, int32_t endPos);
 
+// the buckets of a file block in the rollup are returned one by one as data blocks, with their statistics
+static void setCurrentRollupBucket(STsdbQueryHandle* pQueryHandle) {
+  SQueryFilePos* cur = &pQueryHandle->cur;
+  SRollupBucket* pBucket = &pQueryHandle->pRollupBlock->buckets[pQueryHandle->rollupBucket];
+
+  cur->rows = pBucket->rows;
+  cur->win  = (STimeWindow){.skey = pBucket->skey, .ekey = pBucket->ekey};
+  pQueryHandle->realNumOfRows = pBucket->rows;
+}
+
+static bool moveToNextRollupBucket(STsdbQueryHandle* pQueryHandle) {
+  if (pQueryHandle->pRollupBlock == NULL) {
+    return false;
+  }
+
+  pQueryHandle->rollupBucket += ASCENDING_TRAVERSE(pQueryHandle->order)? 1:-1;
+  if (pQueryHandle->rollupBucket < 0 || pQueryHandle->rollupBucket >= pQueryHandle->pRollupBlock->nBuckets) {
+    pQueryHandle->pRollupBlock = NULL;
+    return false;
+  }
+
+  setCurrentRollupBucket(pQueryHandle);
+  return true;
+}
+
 static int32_t handleDataMergeIfNeeded(STsdbQueryHandle* pQueryHandle, SBlock* pBlock, STableCheckInfo* pCheckInfo){
   SQueryFilePos* cur = &pQueryHandle->cur;
   STsdbCfg*      pCfg = &pQueryHandle->pTsdb->config;
@@ -1306,10 +1357,18 @@ static int32_t handleDataMergeIfNeeded(STsdbQueryHandle* pQueryHandle, SBlock* p
 
     if ((cur->pos == 0 && endPos == binfo.rows -1 && ASCENDING_TRAVERSE(pQueryHandle->order)) ||
         (cur->pos == (binfo.rows - 1) && endPos == 0 && (!ASCENDING_TRAVERSE(pQueryHandle->order)))) {
-      pQueryHandle->realNumOfRows = binfo.rows;
+      SRollupBlock* pRollupBlock = tsdbRollupGetBlock(pQueryHandle->pRollup, pCheckInfo->tableId.uid, pBlock);
+      if (pRollupBlock != NULL && pRollupBlock->nBuckets > 1) {
+        pQueryHandle->pRollupBlock = pRollupBlock;
+        pQueryHandle->rollupBucket = ASCENDING_TRAVERSE(pQueryHandle->order)? 0:(pRollupBlock->nBuckets - 1);
+        setCurrentRollupBucket(pQueryHandle);
+      } else {
+        pQueryHandle->realNumOfRows = binfo.rows;
+
+        cur->rows = binfo.rows;
+        cur->win  = binfo.window;
+      }
 
-      cur->rows = binfo.rows;
-      cur->win  = binfo.window;
       cur->mixBlock = false;
       cur->blockCompleted = true;
 
@@ -1344,6 +1403,8 @@ static int32_t loadFileDataBlock(STsdbQueryHandle* pQueryHandle, SBlock* pBlock,
   int32_t code = TSDB_CODE_SUCCESS;
   bool asc = ASCENDING_TRAVERSE(pQueryHandle->order);
 
+  pQueryHandle->pRollupBlock = NULL;
+
   if (asc) {
     // query ended in/started from current block
     if (pQueryHandle->window.ekey < pBlock->keyLast || pCheckInfo->lastKey > pBlock->keyFirst) {
@@ -2329,6 +2390,12 @@ static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exist
   STimeWindow win = TSWINDOW_INITIALIZER;
 
   while (true) {
+    if (isQueryHandleKilled(pQueryHandle)) {
+      code = TSDB_CODE_TSC_QUERY_CANCELLED;
+      pQueryHandle->pFileGroup = NULL;
+      break;
+    }
+
     tsdbRLockFS(REPO_FS(pQueryHandle->pTsdb));
 
     if ((pQueryHandle->pFileGroup = tsdbFSIterNext(&pQueryHandle->fileIter)) == NULL) {
@@ -2355,6 +2422,7 @@ static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exist
       break;
     }
 
+    tsdbRecordFSetRead(pQueryHandle->pTsdb, pQueryHandle->pFileGroup->fid);
     tsdbUnLockFS(REPO_FS(pQueryHandle->pTsdb));
 
     if (tsdbLoadBlockIdx(&pQueryHandle->rhelper) < 0) {
@@ -2362,6 +2430,9 @@ static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exist
       break;
     }
 
+    tsdbRollupOpenFSet(pQueryHandle->pRollup, pQueryHandle->pFileGroup);
+    pQueryHandle->pRollupBlock = NULL;
+
     if ((code = getFileCompInfo(pQueryHandle, &numOfBlocks)) != TSDB_CODE_SUCCESS) {
       break;
     }
@@ -2536,7 +2607,10 @@ static int32_t getDataBlocksInFiles(STsdbQueryHandle* pQueryHandle, bool* exists
 
     // current block is done, try next
     if ((!cur->mixBlock) || cur->blockCompleted) {
-      // all data blocks in current file has been checked already, try next file if exists
+      if (moveToNextRollupBucket(pQueryHandle)) {
+        *exists = true;
+        return TSDB_CODE_SUCCESS;
+      }
     } else {
       tsdbDebug("%p continue in current data block, index:%d, pos:%d, 0x%"PRIx64, pQueryHandle, cur->slot, cur->pos,
                 pQueryHandle->qId);
@@ -2564,6 +2638,10 @@ static bool doHasDataInBuffer(STsdbQueryHandle* pQueryHandle) {
   size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
   
   while (pQueryHandle->activeIndex < numOfTables) {
+    if (isQueryHandleKilled(pQueryHandle)) {
+      return false;
+    }
+
     if (hasMoreDataInCache(pQueryHandle)) {
       return true;
     }
@@ -2949,6 +3027,10 @@ static bool loadDataBlockFromTableSeq(STsdbQueryHandle* pQueryHandle) {
   int64_t stime = taosGetTimestampUs();
 
   while(pQueryHandle->activeIndex < numOfTables) {
+    if (isQueryHandleKilled(pQueryHandle)) {
+      return false;
+    }
+
     if (loadBlockOfActiveTable(pQueryHandle)) {
       return true;
     }
@@ -3018,7 +3100,9 @@ bool tsdbNextDataBlock(TsdbQueryHandleT pHandle) {
 
     // TODO: opt by consider the scan order
     bool ret = doHasDataInBuffer(pQueryHandle);
-    terrno = TSDB_CODE_SUCCESS;
+    if (terrno != TSDB_CODE_TSC_QUERY_CANCELLED) {
+      terrno = TSDB_CODE_SUCCESS;
+    }
 
     elapsedTime = taosGetTimestampUs() - stime;
     pQueryHandle->cost.checkForNextTime += elapsedTime;
@@ -3343,6 +3427,35 @@ void tsdbRetrieveDataBlockInfo(TsdbQueryHandleT* pQueryHandle, SDataBlockInfo* p
   pDataBlockInfo->numOfCols = (int32_t)(QH_GET_NUM_OF_COLS(pHandle));
 }
 
+// columns missing in the bucket are all NULL in it
+static void getRollupBucketStatis(STsdbQueryHandle* pHandle, int16_t* colIds, size_t numOfCols) {
+  SRollupBucket* pBucket = &pHandle->pRollupBlock->buckets[pHandle->rollupBucket];
+
+  memset(pHandle->statis, 0, numOfCols * sizeof(SDataStatis));
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SDataStatis* pStatis = &pHandle->statis[i];
+    pStatis->colId = colIds[i];
+
+    if (i == 0) {
+      assert(pStatis->colId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
+      pStatis->min = pBucket->skey;
+      pStatis->max = pBucket->ekey;
+      continue;
+    }
+
+    int32_t j = 0;
+    while (j < pBucket->nCols && pBucket->cols[j].colId != pStatis->colId) {
+      j++;
+    }
+
+    if (j < pBucket->nCols) {
+      *pStatis = pBucket->cols[j];
+    } else {
+      pStatis->numOfNull = pBucket->rows;
+    }
+  }
+}
+
 /*
  * return null for mixed data block, if not a complete file data block, the statistics value will always return NULL
  */
@@ -3364,14 +3477,20 @@ int32_t tsdbRetrieveDataBlockStatisInfo(TsdbQueryHandleT* pQueryHandle, SDataSta
     return TSDB_CODE_SUCCESS;
   }
 
+  int16_t* colIds = pHandle->defaultLoadColumn->pData;
+  size_t   numOfCols = QH_GET_NUM_OF_COLS(pHandle);
+
+  if (pHandle->pRollupBlock != NULL) {
+    getRollupBucketStatis(pHandle, colIds, numOfCols);
+    *pBlockStatis = pHandle->statis;
+    return TSDB_CODE_SUCCESS;
+  }
+
   int64_t stime = taosGetTimestampUs();
   if (tsdbLoadBlockStatis(&pHandle->rhelper, pBlockInfo->compBlock) < 0) {
     return terrno;
   }
 
-  int16_t* colIds = pHandle->defaultLoadColumn->pData;
-
-  size_t numOfCols = QH_GET_NUM_OF_COLS(pHandle);
   memset(pHandle->statis, 0, numOfCols * sizeof(SDataStatis));
   for(int32_t i = 0; i < numOfCols; ++i) {
     pHandle->statis[i].colId = colIds[i];
@@ -3401,6 +3520,46 @@ int32_t tsdbRetrieveDataBlockStatisInfo(TsdbQueryHandleT* pQueryHandle, SDataSta
   return TSDB_CODE_SUCCESS;
 }
 
+// only the rows of the current bucket are copied, the file block is loaded once for all its buckets
+static SArray* retrieveRollupBucket(STsdbQueryHandle* pHandle, STableBlockInfo* pBlockInfo) {
+  SRollupBucket*      pBucket = &pHandle->pRollupBlock->buckets[pHandle->rollupBucket];
+  SDataBlockLoadInfo* pBlockLoadInfo = &pHandle->dataBlockLoadInfo;
+  STableCheckInfo*    pCheckInfo = pBlockInfo->pTableCheckInfo;
+  SQueryFilePos*      cur = &pHandle->cur;
+
+  if (pBlockLoadInfo->slot != cur->slot || pBlockLoadInfo->fileGroup == NULL ||
+      pBlockLoadInfo->fileGroup->fid != cur->fid || pBlockLoadInfo->tid != pCheckInfo->pTableObj->tableId.tid) {
+    if (doLoadFileDataBlock(pHandle, pBlockInfo->compBlock, pCheckInfo, cur->slot) != TSDB_CODE_SUCCESS) {
+      return NULL;
+    }
+  }
+
+  // copying rows moves the position of the block, which is done with already
+  STimeWindow win = cur->win;
+  TSKEY       lastKey = cur->lastKey;
+  int32_t     pos = cur->pos;
+
+  int32_t numOfRows =
+      doCopyRowsFromFileBlock(pHandle, pHandle->outputCapacity, 0, pBucket->start, pBucket->start + pBucket->rows - 1);
+
+  cur->win = win;
+  cur->lastKey = lastKey;
+  cur->pos = pos;
+
+  // if the buffer is not full in case of descending order query, move the data in the front of the buffer
+  if (!ASCENDING_TRAVERSE(pHandle->order) && numOfRows < pHandle->outputCapacity) {
+    int32_t emptySize = pHandle->outputCapacity - numOfRows;
+    int32_t reqNumOfCols = (int32_t)taosArrayGetSize(pHandle->pColumns);
+
+    for(int32_t i = 0; i < reqNumOfCols; ++i) {
+      SColumnInfoData* pColInfo = taosArrayGet(pHandle->pColumns, i);
+      memmove((char*)pColInfo->pData, (char*)pColInfo->pData + emptySize * pColInfo->info.bytes, numOfRows * pColInfo->info.bytes);
+    }
+  }
+
+  return pHandle->pColumns;
+}
+
 SArray* tsdbRetrieveDataBlock(TsdbQueryHandleT* pQueryHandle, SArray* pIdList) {
   /**
    * In the following two cases, the data has been loaded to SColumnInfoData.
@@ -3423,6 +3582,10 @@ SArray* tsdbRetrieveDataBlock(TsdbQueryHandleT* pQueryHandle, SArray* pIdList) {
       // data block has been loaded, todo extract method
       SDataBlockLoadInfo* pBlockLoadInfo = &pHandle->dataBlockLoadInfo;
 
+      if (pHandle->pRollupBlock != NULL) {
+        return retrieveRollupBucket(pHandle, pBlockInfo);
+      }
+
       if (pBlockLoadInfo->slot == pHandle->cur.slot && pBlockLoadInfo->fileGroup->fid == pHandle->cur.fid &&
           pBlockLoadInfo->tid == pCheckInfo->pTableObj->tableId.tid) {
         return pHandle->pColumns;
@@ -3637,18 +3800,10 @@ SArray* createTableGroup(SArray* pTableList, STSchema* pTagSchema, SColIndex* pC
   return pTableGroup;
 }
 
-static bool tableFilterFp(const void* pNode, void* param) {
+// val is NULL if the table has no value of the tag
+static bool tagValueFilterFp(const char* val, void* param) {
   tQueryInfo* pInfo = (tQueryInfo*) param;
 
-  STable* pTable = (STable*)(SL_GET_NODE_DATA((SSkipListNode*)pNode));
-
-  char* val = NULL;
-  if (pInfo->sch.colId == TSDB_TBNAME_COLUMN_INDEX) {
-    val = (char*) TABLE_NAME(pTable);
-  } else {
-    val = tdGetKVRowValOfCol(pTable->tagVal, pInfo->sch.colId);
-  }
-
   if (pInfo->optr == TSDB_RELATION_ISNULL || pInfo->optr == TSDB_RELATION_NOTNULL) {
     if (pInfo->optr == TSDB_RELATION_ISNULL) {
       return (val == NULL) || isNull(val, pInfo->sch.type);
@@ -3656,6 +3811,10 @@ static bool tableFilterFp(const void* pNode, void* param) {
       return (val != NULL) && (!isNull(val, pInfo->sch.type));
     }
   } else if (pInfo->optr == TSDB_RELATION_IN) {
+     if (val == NULL) {
+       return false;
+     }
+
      int type = pInfo->sch.type;
      if (type == TSDB_DATA_TYPE_BOOL || IS_SIGNED_NUMERIC_TYPE(type) || type == TSDB_DATA_TYPE_TIMESTAMP) {
        int64_t v;
@@ -3722,9 +3881,117 @@ static bool tableFilterFp(const void* pNode, void* param) {
   return true;
 }
 
+static bool tableFilterFp(const void* pNode, void* param) {
+  tQueryInfo* pInfo = (tQueryInfo*) param;
+
+  STable* pTable = (STable*)(SL_GET_NODE_DATA((SSkipListNode*)pNode));
+
+  char* val = NULL;
+  if (pInfo->sch.colId == TSDB_TBNAME_COLUMN_INDEX) {
+    val = (char*) TABLE_NAME(pTable);
+  } else {
+    val = tdGetKVRowValOfCol(pTable->tagVal, pInfo->sch.colId);
+  }
+
+  return tagValueFilterFp(val, pInfo);
+}
+
 static void getTableListfromSkipList(tExprNode *pExpr, SSkipList *pSkipList, SArray *result, SExprTraverseSupp *param);
 
-static int32_t doQueryTableList(STable* pSTable, SArray* pRes, tExprNode* pExpr) {
+// Evaluate the expression on the tag index into words. The result is exact if all leaves are answered by the index,
+// otherwise it is a superset of the qualified tables, which is checked against each table afterwards.
+static bool tagIndexApplyFilter(STagIndex* pIndex, tExprNode* pExpr, SExprTraverseSupp* param, uint64_t* words,
+                                int32_t nWords) {
+  tExprNode* pLeft  = pExpr->_node.pLeft;
+  tExprNode* pRight = pExpr->_node.pRight;
+
+  memset(words, 0, sizeof(uint64_t) * nWords);
+
+  if (pLeft->nodeType == TSQL_NODE_EXPR && pRight->nodeType == TSQL_NODE_EXPR) {
+    uint64_t* rwords = malloc(sizeof(uint64_t) * nWords);
+    if (rwords == NULL) {
+      tsdbTagIndexGetAll(pIndex, words);
+      return false;
+    }
+
+    bool exact = tagIndexApplyFilter(pIndex, pLeft, param, words, nWords);
+    exact = tagIndexApplyFilter(pIndex, pRight, param, rwords, nWords) && exact;
+
+    if (pExpr->_node.optr == TSDB_RELATION_OR) {
+      for (int32_t i = 0; i < nWords; ++i) words[i] |= rwords[i];
+    } else {
+      for (int32_t i = 0; i < nWords; ++i) words[i] &= rwords[i];
+    }
+
+    free(rwords);
+    return exact;
+  }
+
+  param->setupInfoFn(pExpr, param->pExtInfo);
+  tQueryInfo* pInfo = pExpr->_node.info;
+
+  if (pInfo->sch.colId != TSDB_TBNAME_COLUMN_INDEX &&
+      tsdbQueryTagIndex(pIndex, pInfo->sch.colId, tagValueFilterFp, pInfo, words) == 0) {
+    return true;
+  }
+
+  tsdbTagIndexGetAll(pIndex, words);
+  return false;
+}
+
+static int32_t tableKeyInfoComparFn(const void* p1, const void* p2, const void* param) {
+  SSkipList* pSkipList = (SSkipList*) param;
+  STable*    pTable1 = ((STableKeyInfo*) p1)->pTable;
+  STable*    pTable2 = ((STableKeyInfo*) p2)->pTable;
+
+  int32_t ret = pSkipList->comparFn(pSkipList->keyFn(pTable1), pSkipList->keyFn(pTable2));
+  if (ret != 0) {
+    return ret;
+  }
+
+  return (TABLE_UID(pTable1) < TABLE_UID(pTable2)) ? -1 : ((TABLE_UID(pTable1) > TABLE_UID(pTable2)) ? 1 : 0);
+}
+
+static int32_t queryTableListByTagIndex(STsdbMeta* pMeta, STable* pSTable, tExprNode* pExpr, SArray* pRes,
+                                        SExprTraverseSupp* param) {
+  STagIndex* pIndex = pSTable->pTagIndex;
+  int32_t    nWords = tsdbTagIndexWords(pIndex);
+
+  uint64_t* words = malloc(sizeof(uint64_t) * MAX(nWords, 1));
+  if (words == NULL) {
+    return TSDB_CODE_TDB_OUT_OF_MEMORY;
+  }
+
+  bool exact = tagIndexApplyFilter(pIndex, pExpr, param, words, nWords);
+
+  for (int32_t i = 0; i < nWords; ++i) {
+    uint64_t w = words[i];
+    while (w != 0) {
+      int32_t tid = i * 64 + BUILDIN_CTZL(w);
+      w &= (w - 1);
+
+      STable* pTable = pMeta->tables[tid];
+      assert(pTable != NULL && pTable->pSuper == pSTable);
+
+      SSkipListNode node = {.level = 0, .pData = pTable};
+      if (exact || exprTreeApplyFilter(pExpr, &node, param)) {
+        STableKeyInfo info = {.pTable = pTable, .lastKey = TSKEY_INITIAL_VAL};
+        taosArrayPush(pRes, &info);
+      }
+    }
+  }
+
+  free(words);
+
+  // keep the order of the skiplist index, i.e., the order of the first tag
+  taosqsort(pRes->pData, taosArrayGetSize(pRes), sizeof(STableKeyInfo), pSTable->pIndex, tableKeyInfoComparFn);
+
+  tsdbDebug("stable uid:%" PRIu64 " %" PRIzu " tables found by tag index, exact:%d", TABLE_UID(pSTable),
+            taosArrayGetSize(pRes), exact);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t doQueryTableList(STsdbMeta* pMeta, STable* pSTable, SArray* pRes, tExprNode* pExpr) {
   // query according to the expression tree
   SExprTraverseSupp supp = {
       .nodeFilterFn = (__result_filter_fn_t) tableFilterFp,
@@ -3732,9 +3999,27 @@ static int32_t doQueryTableList(STable* pSTable, SArray* pRes, tExprNode* pExpr)
       .pExtInfo = pSTable->tagSchema,
       };
 
-  getTableListfromSkipList(pExpr, pSTable->pIndex, pRes, &supp);
+  // a single condition on the first tag is answered by the skiplist index, compound conditions and conditions on
+  // other tags by the tag index
+  bool useTagIndex = (pSTable->pTagIndex != NULL && pExpr != NULL);
+  if (useTagIndex && pExpr->_node.pLeft->nodeType != TSQL_NODE_EXPR &&
+      pExpr->_node.pRight->nodeType != TSQL_NODE_EXPR) {
+    supp.setupInfoFn(pExpr, supp.pExtInfo);
+    tQueryInfo* pInfo = pExpr->_node.info;
+    useTagIndex = (pInfo->sch.colId != TSDB_TBNAME_COLUMN_INDEX) &&
+                  (!pInfo->indexed || pInfo->optr == TSDB_RELATION_LIKE || pInfo->optr == TSDB_RELATION_MATCH ||
+                   pInfo->optr == TSDB_RELATION_NMATCH || pInfo->optr == TSDB_RELATION_IN);
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (useTagIndex) {
+    code = queryTableListByTagIndex(pMeta, pSTable, pExpr, pRes, &supp);
+  } else {
+    getTableListfromSkipList(pExpr, pSTable->pIndex, pRes, &supp);
+  }
+
   tExprTreeDestroy(pExpr, destroyHelper);
-  return TSDB_CODE_SUCCESS;
+  return code;
 }
 
 int32_t tsdbQuerySTableByTagCond(STsdbRepo* tsdb, uint64_t uid, TSKEY skey, const char* pTagCond, size_t len,
@@ -3817,7 +4102,14 @@ int32_t tsdbQuerySTableByTagCond(STsdbRepo* tsdb, uint64_t uid, TSKEY skey, cons
     // TODO: more error handling
   } END_TRY
 
-  doQueryTableList(pTable, res, expr);
+  ret = doQueryTableList(tsdbGetMeta(tsdb), pTable, res, expr);
+  if (ret != TSDB_CODE_SUCCESS) {
+    terrno = ret;
+    taosArrayDestroy(res);
+    tsdbUnlockRepoMeta(tsdb);
+    goto _error;
+  }
+
   pGroupInfo->numOfTables = (uint32_t)taosArrayGetSize(res);
   pGroupInfo->pGroupList  = createTableGroup(res, pTagSchema, pColIndex, numOfCols, skey);
 
@@ -3938,6 +4230,16 @@ static void* destroyTableCheckInfo(SArray* pTableCheckInfo) {
   return NULL;
 }
 
+void tsdbSetQueryKilledFp(TsdbQueryHandleT queryHandle, bool (*fp)(void *param), void *param) {
+  STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
+  if (pQueryHandle == NULL) {
+    return;
+  }
+
+  pQueryHandle->killedFp = fp;
+  pQueryHandle->killedParam = param;
+}
+
 void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
   STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
   if (pQueryHandle == NULL) {
@@ -3961,6 +4263,7 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
   }
 
   tsdbDestroyReadH(&pQueryHandle->rhelper);
+  tsdbFreeRollupR(pQueryHandle->pRollup);
 
   tdFreeDataCols(pQueryHandle->pDataCols);
   pQueryHandle->pDataCols = NULL;
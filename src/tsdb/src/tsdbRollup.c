@@ -0,0 +1,958 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tglobal.h"
+#include "tsdbint.h"
+
+#define TSDB_ROLLUP_FLUSH_SIZE (1024 * 1024)
+#define TSDB_ROLLUP_BLOCK_HEAD_SIZE (sizeof(uint32_t) + sizeof(TSKEY) * 2 + sizeof(int32_t))
+#define TSDB_ROLLUP_TIER_HEAD_SIZE (sizeof(uint32_t) * 3)
+#define TSDB_ROLLUP_BUCKET_HEAD_SIZE (sizeof(TSKEY) * 2 + sizeof(int32_t) * 2 + sizeof(uint16_t))
+#define TSDB_ROLLUP_COL_SIZE (sizeof(int16_t) * 4 + sizeof(int64_t) * 3)
+#define TSDB_ROLLUP_TABLE_HEAD_SIZE (sizeof(uint64_t) + sizeof(uint32_t) * 2)
+#define TSDB_ROLLUP_IDX_ENTRY_SIZE (sizeof(uint64_t) * 2 + sizeof(uint32_t) * 2)
+
+typedef enum { TSDB_ROLLUP_TEMP_FILE = 0, TSDB_ROLLUP_FILE } TSDB_ROLLUP_FILE_T;
+static const char *tsdbRollupSuffix[] = {".rollup.t", ".rollup"};
+
+typedef struct {
+  uint32_t version;
+  int32_t  fid;
+  uint32_t headMagic;  // magic and size of the head file the rollup is bound to
+  uint64_t headSize;
+  uint8_t  nTiers;
+  int64_t  intervals[TSDB_MAX_ROLLUP_TIERS];
+  uint8_t  units[TSDB_MAX_ROLLUP_TIERS];
+  uint32_t nTables;
+  uint64_t len;       // body length, the index of tables follows the body
+  uint32_t idxLen;    // index length
+  uint32_t idxCksum;  // index checksum
+} SRollupHeader;
+
+// Index entry of a table, a query reads and checks only the sections of the tables it reads
+typedef struct {
+  uint64_t offset;  // of the table section in the body
+  uint32_t len;
+  uint32_t cksum;
+} SRollupIdx;
+
+struct SRollupW {
+  STsdbRepo *   pRepo;
+  int           nTiers;
+  SInterval     tiers[TSDB_MAX_ROLLUP_TIERS];
+  bool          valid;  // the file set being committed still gets a rollup
+  int           fd;
+  char          tfname[TSDB_FILENAME_LEN];
+  char          cfname[TSDB_FILENAME_LEN];
+  SRollupHeader header;
+  void *        pBuf;  // table entries not written yet
+  int           len;
+  void *        pIdxBuf;  // index entries of the tables written
+  int           idxLen;
+  int           oFd;    // rollup of the file set committed on
+  SHashObj *    pOIdx;  // uid -> SRollupIdx of the table section in the old rollup
+  void *        pOBuf;  // section of the current table in the old rollup
+  void *        oCur;   // next record of the current table in pOBuf
+  uint32_t      oLeft;
+  STable *      pTable;
+  void *        pTBuf;  // records of the current table
+  int           tLen;
+  uint32_t      tBlocks;
+  void *        pPend;  // record of the block just written or moved, kept until the block is added
+  int           pLen;
+};
+
+typedef struct {
+  int32_t        nBlocks;
+  SRollupBlock * blocks;
+  SRollupBucket *buckets;
+  SDataStatis *  cols;
+} SRollupTable;
+
+struct SRollupR {
+  STsdbRepo *   pRepo;
+  SInterval     interval;
+  int           fid;
+  int           tier;  // tier read in the file set opened, -1 if none fits
+  SRollupHeader header;
+  int           fd;
+  SHashObj *    pIdx;     // uid -> SRollupIdx of the table section
+  SHashObj *    pTables;  // uid -> SRollupTable * decoded
+  void *        pBuf;     // section being decoded
+};
+
+static void tsdbGetRollupFname(int repoid, int fid, TSDB_ROLLUP_FILE_T ftype, char fname[]) {
+  snprintf(fname, TSDB_FILENAME_LEN, "%s/vnode/vnode%d/tsdb/f%d%s", TFS_PRIMARY_PATH(), repoid, fid,
+           tsdbRollupSuffix[ftype]);
+}
+
+// Tiers of rollupTiers in ascending order, units of calendar length and tiers finer than a second are ignored
+int tsdbGetRollupTiers(int8_t precision, SInterval tiers[]) {
+  char *  buf = strdup(tsRollupTiers);
+  char *  saveptr = NULL;
+  int     nTiers = 0;
+  int64_t minDuration = convertTimePrecision(1000, TSDB_TIME_PRECISION_MILLI, precision);
+
+  if (buf == NULL) return 0;
+  for (char *token = strtok_r(buf, ", ", &saveptr); token != NULL; token = strtok_r(NULL, ", ", &saveptr)) {
+    int64_t duration = 0;
+    char    unit = 0;
+
+    if (parseAbsoluteDuration(token, (int32_t)strlen(token), &duration, &unit, precision) < 0 ||
+        strchr("smhdw", unit) == NULL || duration < minDuration) {
+      continue;
+    }
+
+    int i = 0;
+    while (i < nTiers && tiers[i].interval < duration) i++;
+    if (i < nTiers && tiers[i].interval == duration) continue;
+    if (i == TSDB_MAX_ROLLUP_TIERS) continue;
+
+    int nMove = MIN(nTiers, TSDB_MAX_ROLLUP_TIERS - 1) - i;
+    if (nMove > 0) memmove(tiers + i + 1, tiers + i, sizeof(SInterval) * nMove);
+    memset(tiers + i, 0, sizeof(SInterval));
+    tiers[i].interval = tiers[i].sliding = duration;
+    tiers[i].intervalUnit = tiers[i].slidingUnit = unit;
+    nTiers = MIN(nTiers + 1, TSDB_MAX_ROLLUP_TIERS);
+  }
+
+  free(buf);
+  return nTiers;
+}
+
+// A temporary file left by a failed commit is not a rollup
+bool tsdbIsRollupFile(const char *bname, int *fid) {
+  char suffix[16] = "\0";
+
+  if (sscanf(bname, "f%d%15s", fid, suffix) != 2) return false;
+  return strcmp(suffix, tsdbRollupSuffix[TSDB_ROLLUP_FILE]) == 0;
+}
+
+// Remove the rollup of a file set removed from the repository
+void tsdbRemoveRollup(SDFileSet *pSet) {
+  SDFile *    pHeadf = TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD);
+  char        bname[TSDB_FILENAME_LEN] = "\0";
+  char        fname[TSDB_FILENAME_LEN] = "\0";
+  int         vid, fid;
+  TSDB_FILE_T ftype;
+  uint32_t    ver;
+
+  tfsbasename(TSDB_FILE_F(pHeadf), bname);
+  tsdbParseDFilename(bname, &vid, &fid, &ftype, &ver);
+  tsdbGetRollupFname(vid, pSet->fid, TSDB_ROLLUP_FILE, fname);
+  (void)remove(fname);
+}
+
+static int tsdbEncodeRollupHeader(void **buf, SRollupHeader *pHeader) {
+  int tlen = 0;
+
+  tlen += taosEncodeFixedU32(buf, pHeader->version);
+  tlen += taosEncodeFixedI32(buf, pHeader->fid);
+  tlen += taosEncodeFixedU32(buf, pHeader->headMagic);
+  tlen += taosEncodeFixedU64(buf, pHeader->headSize);
+  tlen += taosEncodeFixedU8(buf, pHeader->nTiers);
+  for (uint8_t i = 0; i < pHeader->nTiers; i++) {
+    tlen += taosEncodeFixedI64(buf, pHeader->intervals[i]);
+    tlen += taosEncodeFixedU8(buf, pHeader->units[i]);
+  }
+  tlen += taosEncodeFixedU32(buf, pHeader->nTables);
+  tlen += taosEncodeFixedU64(buf, pHeader->len);
+  tlen += taosEncodeFixedU32(buf, pHeader->idxLen);
+  tlen += taosEncodeFixedU32(buf, pHeader->idxCksum);
+
+  return tlen;
+}
+
+static void *tsdbDecodeRollupHeader(void *buf, SRollupHeader *pHeader) {
+  buf = taosDecodeFixedU32(buf, &(pHeader->version));
+  buf = taosDecodeFixedI32(buf, &(pHeader->fid));
+  buf = taosDecodeFixedU32(buf, &(pHeader->headMagic));
+  buf = taosDecodeFixedU64(buf, &(pHeader->headSize));
+  buf = taosDecodeFixedU8(buf, &(pHeader->nTiers));
+  pHeader->nTiers = MIN(pHeader->nTiers, TSDB_MAX_ROLLUP_TIERS);
+  for (uint8_t i = 0; i < pHeader->nTiers; i++) {
+    buf = taosDecodeFixedI64(buf, &(pHeader->intervals[i]));
+    buf = taosDecodeFixedU8(buf, &(pHeader->units[i]));
+  }
+  buf = taosDecodeFixedU32(buf, &(pHeader->nTables));
+  buf = taosDecodeFixedU64(buf, &(pHeader->len));
+  buf = taosDecodeFixedU32(buf, &(pHeader->idxLen));
+  buf = taosDecodeFixedU32(buf, &(pHeader->idxCksum));
+
+  return buf;
+}
+
+static void tsdbSetRollupHeaderTiers(SRollupHeader *pHeader, SInterval tiers[], int nTiers) {
+  pHeader->nTiers = (uint8_t)nTiers;
+  for (int i = 0; i < nTiers; i++) {
+    pHeader->intervals[i] = tiers[i].interval;
+    pHeader->units[i] = (uint8_t)tiers[i].intervalUnit;
+  }
+}
+
+static bool tsdbRollupTiersEqual(SRollupHeader *pHeader, SRollupHeader *pOther) {
+  if (pHeader->nTiers != pOther->nTiers) return false;
+  for (uint8_t i = 0; i < pHeader->nTiers; i++) {
+    if (pHeader->intervals[i] != pOther->intervals[i] || pHeader->units[i] != pOther->units[i]) return false;
+  }
+  return true;
+}
+
+static FORCE_INLINE void *tsdbDecodeRollupTable(void *buf, uint64_t *uid, uint32_t *nBlocks, uint32_t *len) {
+  buf = taosDecodeFixedU64(buf, uid);
+  buf = taosDecodeFixedU32(buf, nBlocks);
+  buf = taosDecodeFixedU32(buf, len);
+  return buf;
+}
+
+static FORCE_INLINE void *tsdbDecodeRollupBlockHead(void *buf, uint32_t *len, SRollupBlock *pBlock) {
+  buf = taosDecodeFixedU32(buf, len);
+  buf = taosDecodeFixedI64(buf, &(pBlock->keyFirst));
+  buf = taosDecodeFixedI64(buf, &(pBlock->keyLast));
+  buf = taosDecodeFixedI32(buf, &(pBlock->numOfRows));
+  return buf;
+}
+
+// Open the rollup of the file set if it is bound to its head file and load its index. *pfd is left -1 if it is
+// missing or stale, otherwise it is kept open to read the sections of tables.
+static int tsdbLoadRollup(STsdbRepo *pRepo, SDFileSet *pSet, SRollupHeader *pHeader, int *pfd, SHashObj **ppIdx) {
+  SDFile *  pHeadf = TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD);
+  char      hbuf[TSDB_FILE_HEAD_SIZE] = "\0";
+  char      fname[TSDB_FILENAME_LEN] = "\0";
+  void *    pBuf = NULL;
+  SHashObj *pIdx = NULL;
+  int       code = 0;
+
+  *pfd = -1;
+  *ppIdx = NULL;
+
+  tsdbGetRollupFname(REPO_ID(pRepo), pSet->fid, TSDB_ROLLUP_FILE, fname);
+  int fd = open(fname, O_RDONLY | O_BINARY);
+  if (fd < 0) return 0;
+
+  if (taosRead(fd, hbuf, TSDB_FILE_HEAD_SIZE) < TSDB_FILE_HEAD_SIZE ||
+      !taosCheckChecksumWhole((uint8_t *)hbuf, TSDB_FILE_HEAD_SIZE)) {
+    tsdbWarn("vgId:%d rollup %s is corrupted", REPO_ID(pRepo), fname);
+    goto _exit;
+  }
+  tsdbDecodeRollupHeader(hbuf, pHeader);
+
+  if (pHeader->version != TSDB_ROLLUP_VERSION || pHeader->fid != pSet->fid ||
+      pHeader->headMagic != pHeadf->info.magic || pHeader->headSize != pHeadf->info.size || pHeader->nTiers == 0) {
+    tsdbDebug("vgId:%d rollup of file set %d is stale", REPO_ID(pRepo), pSet->fid);
+    goto _exit;
+  }
+
+  if (pHeader->idxLen != pHeader->nTables * TSDB_ROLLUP_IDX_ENTRY_SIZE) {
+    tsdbWarn("vgId:%d rollup %s is corrupted", REPO_ID(pRepo), fname);
+    goto _exit;
+  }
+
+  if (tsdbMakeRoom(&pBuf, pHeader->idxLen + 1) < 0) {
+    code = -1;
+    goto _exit;
+  }
+  if (lseek(fd, (off_t)(TSDB_FILE_HEAD_SIZE + pHeader->len), SEEK_SET) < 0 ||
+      taosRead(fd, pBuf, pHeader->idxLen) < (int64_t)pHeader->idxLen ||
+      taosCalcChecksum(0, (uint8_t *)pBuf, pHeader->idxLen) != pHeader->idxCksum) {
+    tsdbWarn("vgId:%d rollup %s is corrupted", REPO_ID(pRepo), fname);
+    goto _exit;
+  }
+
+  pIdx = taosHashInit(pHeader->nTables + 1, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, HASH_NO_LOCK);
+  if (pIdx == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    code = -1;
+    goto _exit;
+  }
+
+  void *ptr = pBuf;
+  for (uint32_t i = 0; i < pHeader->nTables; i++) {
+    uint64_t   uid;
+    SRollupIdx idx;
+
+    ptr = taosDecodeFixedU64(ptr, &uid);
+    ptr = taosDecodeFixedU64(ptr, &(idx.offset));
+    ptr = taosDecodeFixedU32(ptr, &(idx.len));
+    ptr = taosDecodeFixedU32(ptr, &(idx.cksum));
+    if (idx.len < TSDB_ROLLUP_TABLE_HEAD_SIZE || idx.offset + idx.len > pHeader->len) {
+      tsdbWarn("vgId:%d rollup %s is corrupted", REPO_ID(pRepo), fname);
+      goto _exit;
+    }
+
+    if (taosHashPut(pIdx, &uid, sizeof(uid), &idx, sizeof(idx)) < 0) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      code = -1;
+      goto _exit;
+    }
+  }
+
+  *pfd = fd;
+  *ppIdx = pIdx;
+  fd = -1;
+  pIdx = NULL;
+
+_exit:
+  if (fd >= 0) close(fd);
+  taosTZfree(pBuf);
+  taosHashCleanup(pIdx);
+  return code;
+}
+
+// Read the section of a table and check it, the records of its blocks are returned
+static void *tsdbReadRollupTable(STsdbRepo *pRepo, int fd, SRollupIdx *pIdx, void **ppBuf, uint32_t *nBlocks) {
+  uint64_t uid;
+  uint32_t len;
+
+  if (tsdbMakeRoom(ppBuf, pIdx->len) < 0) return NULL;
+
+  if (lseek(fd, (off_t)(TSDB_FILE_HEAD_SIZE + pIdx->offset), SEEK_SET) < 0 ||
+      taosRead(fd, *ppBuf, pIdx->len) < (int64_t)pIdx->len ||
+      taosCalcChecksum(0, (uint8_t *)(*ppBuf), pIdx->len) != pIdx->cksum) {
+    tsdbWarn("vgId:%d a table section of rollup is corrupted", REPO_ID(pRepo));
+    return NULL;
+  }
+
+  void *ptr = tsdbDecodeRollupTable(*ppBuf, &uid, nBlocks, &len);
+  if (len != pIdx->len - TSDB_ROLLUP_TABLE_HEAD_SIZE) {
+    tsdbWarn("vgId:%d a table section of rollup is corrupted", REPO_ID(pRepo));
+    return NULL;
+  }
+
+  return ptr;
+}
+
+// ================== WRITER
+static void tsdbRollupResetFSet(SRollupW *pw) {
+  if (pw->fd >= 0) {
+    close(pw->fd);
+    (void)remove(pw->tfname);
+    pw->fd = -1;
+  }
+
+  if (pw->oFd >= 0) {
+    close(pw->oFd);
+    pw->oFd = -1;
+  }
+  taosHashCleanup(pw->pOIdx);
+  pw->pOIdx = NULL;
+  pw->oCur = NULL;
+  pw->oLeft = 0;
+  pw->pTable = NULL;
+  pw->len = 0;
+  pw->idxLen = 0;
+  pw->tLen = 0;
+  pw->tBlocks = 0;
+  pw->pLen = 0;
+  pw->valid = false;
+}
+
+int tsdbInitRollupW(SRollupW **ppw, STsdbRepo *pRepo) {
+  SInterval tiers[TSDB_MAX_ROLLUP_TIERS];
+
+  *ppw = NULL;
+  int nTiers = tsdbGetRollupTiers(REPO_CFG(pRepo)->precision, tiers);
+  if (nTiers == 0) return 0;
+
+  SRollupW *pw = (SRollupW *)calloc(1, sizeof(*pw));
+  if (pw == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  pw->pRepo = pRepo;
+  pw->nTiers = nTiers;
+  memcpy(pw->tiers, tiers, sizeof(SInterval) * nTiers);
+  pw->fd = -1;
+  pw->oFd = -1;
+
+  *ppw = pw;
+  return 0;
+}
+
+void tsdbDestroyRollupW(SRollupW *pw) {
+  if (pw == NULL) return;
+
+  tsdbRollupResetFSet(pw);
+  taosTZfree(pw->pBuf);
+  taosTZfree(pw->pIdxBuf);
+  taosTZfree(pw->pOBuf);
+  taosTZfree(pw->pTBuf);
+  taosTZfree(pw->pPend);
+  free(pw);
+}
+
+static void tsdbRollupFail(SRollupW *pw) {
+  tsdbWarn("vgId:%d file set %d is left without rollup since %s", REPO_ID(pw->pRepo), pw->header.fid,
+           tstrerror(terrno));
+  tsdbRollupResetFSet(pw);
+}
+
+// pSet is the file set committed on, NULL if there is none
+void tsdbRollupBeginFSet(SRollupW *pw, SDFileSet *pSet, int fid) {
+  SRollupHeader oheader = {0};
+  char          hbuf[TSDB_FILE_HEAD_SIZE] = "\0";
+
+  if (pw == NULL) return;
+
+  tsdbRollupResetFSet(pw);
+  memset(&pw->header, 0, sizeof(pw->header));
+  pw->header.version = TSDB_ROLLUP_VERSION;
+  pw->header.fid = fid;
+  tsdbSetRollupHeaderTiers(&pw->header, pw->tiers, pw->nTiers);
+
+  // blocks moved as they are keep their records of the old rollup
+  if (pSet != NULL) {
+    if (tsdbLoadRollup(pw->pRepo, pSet, &oheader, &pw->oFd, &pw->pOIdx) < 0) {
+      tsdbRollupFail(pw);
+      return;
+    }
+
+    if (pw->oFd >= 0 && !tsdbRollupTiersEqual(&oheader, &pw->header)) {
+      close(pw->oFd);
+      pw->oFd = -1;
+      taosHashCleanup(pw->pOIdx);
+      pw->pOIdx = NULL;
+    }
+  }
+
+  tsdbGetRollupFname(REPO_ID(pw->pRepo), fid, TSDB_ROLLUP_TEMP_FILE, pw->tfname);
+  tsdbGetRollupFname(REPO_ID(pw->pRepo), fid, TSDB_ROLLUP_FILE, pw->cfname);
+
+  pw->fd = open(pw->tfname, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0755);
+  if (pw->fd < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbRollupFail(pw);
+    return;
+  }
+
+  // header is written at last
+  if (taosWrite(pw->fd, hbuf, TSDB_FILE_HEAD_SIZE) < TSDB_FILE_HEAD_SIZE) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbRollupFail(pw);
+    return;
+  }
+
+  pw->valid = true;
+}
+
+void tsdbRollupSetTable(SRollupW *pw, STable *pTable) {
+  if (pw == NULL || !pw->valid) return;
+
+  pw->pTable = pTable;
+  pw->tLen = 0;
+  pw->tBlocks = 0;
+  pw->pLen = 0;
+  pw->oCur = NULL;
+  pw->oLeft = 0;
+
+  if (pw->pOIdx == NULL) return;
+
+  uint64_t    uid = TABLE_UID(pTable);
+  SRollupIdx *pIdx = taosHashGet(pw->pOIdx, &uid, sizeof(uid));
+  if (pIdx != NULL) {
+    // blocks moved from a section not read get no record
+    pw->oCur = tsdbReadRollupTable(pw->pRepo, pw->oFd, pIdx, &pw->pOBuf, &pw->oLeft);
+    if (pw->oCur == NULL) pw->oLeft = 0;
+  }
+}
+
+static TSKEY tsdbRollupBucketStart(SInterval *pTier, TSKEY key, int8_t precision) {
+  TSKEY start = taosTimeTruncate(key, pTier, precision);
+  while (start > key) start -= pTier->interval;
+  return start;
+}
+
+// len, keyFirst, keyLast and number of rows, then for each tier the buckets of the block with the statistics of the
+// columns not all NULL in them
+static int tsdbEncodeRollupBlock(SRollupW *pw, SDataCols *pCols) {
+  int8_t precision = REPO_CFG(pw->pRepo)->precision;
+  int    rows = pCols->numOfRows;
+  int    len = sizeof(uint32_t);
+  void * ptr;
+
+  if (tsdbMakeRoom(&pw->pPend, TSDB_ROLLUP_BLOCK_HEAD_SIZE) < 0) return -1;
+  ptr = POINTER_SHIFT(pw->pPend, len);
+  len += taosEncodeFixedI64(&ptr, dataColsKeyFirst(pCols));
+  len += taosEncodeFixedI64(&ptr, dataColsKeyLast(pCols));
+  len += taosEncodeFixedI32(&ptr, rows);
+
+  for (int t = 0; t < pw->nTiers; t++) {
+    SInterval *pTier = pw->tiers + t;
+    int        tierOffset = len;
+    uint32_t   nBuckets = 0;
+    uint32_t   nCols = 0;
+
+    len += TSDB_ROLLUP_TIER_HEAD_SIZE;
+    for (int start = 0; start < rows;) {
+      TSKEY skey = tsdbRollupBucketStart(pTier, dataColsKeyAt(pCols, start), precision);
+      TSKEY ekey = skey + pTier->interval - 1;
+      int   end = start + 1;
+      while (end < rows && dataColsKeyAt(pCols, end) <= ekey) end++;
+
+      if (tsdbMakeRoom(&pw->pPend, len + TSDB_ROLLUP_BUCKET_HEAD_SIZE + TSDB_ROLLUP_COL_SIZE * pCols->numOfCols) < 0) {
+        return -1;
+      }
+
+      ptr = POINTER_SHIFT(pw->pPend, len);
+      len += taosEncodeFixedI64(&ptr, dataColsKeyAt(pCols, start));
+      len += taosEncodeFixedI64(&ptr, dataColsKeyAt(pCols, end - 1));
+      len += taosEncodeFixedI32(&ptr, start);
+      len += taosEncodeFixedI32(&ptr, end - start);
+      int nColsOffset = len;
+      len += taosEncodeFixedU16(&ptr, 0);
+
+      uint16_t bCols = 0;
+      for (int i = 1; i < pCols->numOfCols; i++) {
+        SDataCol *  pCol = pCols->cols + i;
+        SDataStatis statis = {0};
+
+        if (isAllRowsNull(pCol) || tDataTypes[pCol->type].statisFunc == NULL) continue;
+
+        (*tDataTypes[pCol->type].statisFunc)(tdGetColDataOfRow(pCol, start), end - start, &statis.min, &statis.max,
+                                             &statis.sum, &statis.minIndex, &statis.maxIndex, &statis.numOfNull);
+        if (statis.numOfNull >= end - start) continue;
+
+        len += taosEncodeFixedI16(&ptr, pCol->colId);
+        len += taosEncodeFixedI16(&ptr, statis.numOfNull);
+        len += taosEncodeFixedI16(&ptr, statis.maxIndex);
+        len += taosEncodeFixedI16(&ptr, statis.minIndex);
+        len += taosEncodeFixedI64(&ptr, statis.sum);
+        len += taosEncodeFixedI64(&ptr, statis.max);
+        len += taosEncodeFixedI64(&ptr, statis.min);
+        bCols++;
+      }
+
+      ptr = POINTER_SHIFT(pw->pPend, nColsOffset);
+      taosEncodeFixedU16(&ptr, bCols);
+      nBuckets++;
+      nCols += bCols;
+      start = end;
+    }
+
+    ptr = POINTER_SHIFT(pw->pPend, tierOffset);
+    taosEncodeFixedU32(&ptr, nBuckets);
+    taosEncodeFixedU32(&ptr, nCols);
+    taosEncodeFixedU32(&ptr, (uint32_t)(len - tierOffset - TSDB_ROLLUP_TIER_HEAD_SIZE));
+  }
+
+  ptr = pw->pPend;
+  taosEncodeFixedU32(&ptr, (uint32_t)len);
+  return len;
+}
+
+// Data of a super block just written
+void tsdbRollupBlockData(SRollupW *pw, SDataCols *pDataCols) {
+  if (pw == NULL || !pw->valid) return;
+
+  pw->pLen = tsdbEncodeRollupBlock(pw, pDataCols);
+  if (pw->pLen < 0) tsdbRollupFail(pw);
+}
+
+// A block moved as it is keeps its record of the old rollup, if there is one
+void tsdbRollupMoveBlock(SRollupW *pw, const SBlock *pBlock) {
+  if (pw == NULL || !pw->valid) return;
+
+  pw->pLen = 0;
+  while (pw->oLeft > 0) {
+    SRollupBlock oblock;
+    uint32_t     len;
+
+    tsdbDecodeRollupBlockHead(pw->oCur, &len, &oblock);
+    if (oblock.keyLast < pBlock->keyFirst) {
+      pw->oCur = POINTER_SHIFT(pw->oCur, len);
+      pw->oLeft--;
+      continue;
+    }
+
+    if (oblock.keyFirst == pBlock->keyFirst && oblock.keyLast == pBlock->keyLast &&
+        oblock.numOfRows == pBlock->numOfRows) {
+      if (tsdbMakeRoom(&pw->pPend, len) < 0) {
+        tsdbRollupFail(pw);
+        return;
+      }
+      memcpy(pw->pPend, pw->oCur, len);
+      pw->pLen = len;
+      pw->oCur = POINTER_SHIFT(pw->oCur, len);
+      pw->oLeft--;
+    }
+    break;
+  }
+}
+
+// A super block is added to the block index of the table. Super blocks with sub-blocks get no record.
+void tsdbRollupAddBlock(SRollupW *pw, const SBlock *pBlock) {
+  SRollupBlock rblock;
+  uint32_t     len;
+
+  if (pw == NULL || !pw->valid) return;
+
+  if (pw->pLen > 0 && pBlock->numOfSubBlocks == 1) {
+    tsdbDecodeRollupBlockHead(pw->pPend, &len, &rblock);
+    if (rblock.keyFirst == pBlock->keyFirst && rblock.keyLast == pBlock->keyLast &&
+        rblock.numOfRows == pBlock->numOfRows) {
+      if (tsdbMakeRoom(&pw->pTBuf, pw->tLen + len) < 0) {
+        tsdbRollupFail(pw);
+        return;
+      }
+      memcpy(POINTER_SHIFT(pw->pTBuf, pw->tLen), pw->pPend, len);
+      pw->tLen += len;
+      pw->tBlocks++;
+    }
+  }
+
+  pw->pLen = 0;
+}
+
+static int tsdbWriteRollupBuf(SRollupW *pw) {
+  if (pw->len <= 0) return 0;
+
+  if (taosWrite(pw->fd, pw->pBuf, pw->len) < pw->len) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  pw->header.len += pw->len;
+  pw->len = 0;
+  return 0;
+}
+
+void tsdbRollupEndTable(SRollupW *pw) {
+  if (pw == NULL || !pw->valid || pw->pTable == NULL) return;
+
+  if (pw->tBlocks > 0) {
+    if (tsdbMakeRoom(&pw->pBuf, pw->len + TSDB_ROLLUP_TABLE_HEAD_SIZE + pw->tLen) < 0 ||
+        tsdbMakeRoom(&pw->pIdxBuf, pw->idxLen + TSDB_ROLLUP_IDX_ENTRY_SIZE) < 0) {
+      tsdbRollupFail(pw);
+      return;
+    }
+
+    void *pSection = POINTER_SHIFT(pw->pBuf, pw->len);
+    void *ptr = pSection;
+    int   slen = 0;
+    slen += taosEncodeFixedU64(&ptr, TABLE_UID(pw->pTable));
+    slen += taosEncodeFixedU32(&ptr, pw->tBlocks);
+    slen += taosEncodeFixedU32(&ptr, (uint32_t)pw->tLen);
+    memcpy(ptr, pw->pTBuf, pw->tLen);
+    slen += pw->tLen;
+
+    ptr = POINTER_SHIFT(pw->pIdxBuf, pw->idxLen);
+    pw->idxLen += taosEncodeFixedU64(&ptr, TABLE_UID(pw->pTable));
+    pw->idxLen += taosEncodeFixedU64(&ptr, pw->header.len + pw->len);
+    pw->idxLen += taosEncodeFixedU32(&ptr, (uint32_t)slen);
+    pw->idxLen += taosEncodeFixedU32(&ptr, taosCalcChecksum(0, (uint8_t *)pSection, slen));
+
+    pw->len += slen;
+    pw->header.nTables++;
+
+    if (pw->len >= TSDB_ROLLUP_FLUSH_SIZE && tsdbWriteRollupBuf(pw) < 0) {
+      tsdbRollupFail(pw);
+      return;
+    }
+  }
+
+  pw->pTable = NULL;
+  pw->tLen = 0;
+  pw->tBlocks = 0;
+}
+
+// pSet is the file set just committed, the rollup is bound to its head file
+void tsdbRollupEndFSet(SRollupW *pw, SDFileSet *pSet) {
+  char    hbuf[TSDB_FILE_HEAD_SIZE] = "\0";
+  void *  ptr = hbuf;
+  SDFile *pHeadf = TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD);
+
+  if (pw == NULL || !pw->valid) return;
+
+  if (tsdbWriteRollupBuf(pw) < 0) {
+    tsdbRollupFail(pw);
+    return;
+  }
+
+  if (pw->idxLen > 0 && taosWrite(pw->fd, pw->pIdxBuf, pw->idxLen) < pw->idxLen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbRollupFail(pw);
+    return;
+  }
+  pw->header.idxLen = (uint32_t)pw->idxLen;
+  pw->header.idxCksum = taosCalcChecksum(0, (uint8_t *)pw->pIdxBuf, pw->idxLen);
+
+  pw->header.headMagic = pHeadf->info.magic;
+  pw->header.headSize = pHeadf->info.size;
+  tsdbEncodeRollupHeader(&ptr, &pw->header);
+  taosCalcChecksumAppend(0, (uint8_t *)hbuf, TSDB_FILE_HEAD_SIZE);
+
+  if (lseek(pw->fd, 0, SEEK_SET) < 0 || taosWrite(pw->fd, hbuf, TSDB_FILE_HEAD_SIZE) < TSDB_FILE_HEAD_SIZE ||
+      taosFsync(pw->fd) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbRollupFail(pw);
+    return;
+  }
+
+  (void)close(pw->fd);
+  pw->fd = -1;
+  (void)taosRename(pw->tfname, pw->cfname);
+
+  tsdbDebug("vgId:%d rollup of %u tables is saved for file set %d", REPO_ID(pw->pRepo), pw->header.nTables,
+            pSet->fid);
+  tsdbRollupResetFSet(pw);
+}
+
+// ================== READER
+static void tsdbRollupFreeTables(SRollupR *pr) {
+  if (pr->pTables == NULL) return;
+
+  SRollupTable **ppTable = taosHashIterate(pr->pTables, NULL);
+  while (ppTable != NULL) {
+    SRollupTable *pTable = *ppTable;
+    tfree(pTable->blocks);
+    tfree(pTable->buckets);
+    tfree(pTable->cols);
+    free(pTable);
+    ppTable = taosHashIterate(pr->pTables, ppTable);
+  }
+
+  taosHashCleanup(pr->pTables);
+  pr->pTables = NULL;
+}
+
+static void tsdbRollupCloseFSet(SRollupR *pr) {
+  tsdbRollupFreeTables(pr);
+  if (pr->fd >= 0) {
+    close(pr->fd);
+    pr->fd = -1;
+  }
+  taosHashCleanup(pr->pIdx);
+  pr->pIdx = NULL;
+  pr->fid = TSDB_IVLD_FID;
+  pr->tier = -1;
+}
+
+SRollupR *tsdbNewRollupR(STsdbRepo *pRepo, int64_t interval, char unit) {
+  SRollupR *pr = (SRollupR *)calloc(1, sizeof(*pr));
+  if (pr == NULL) return NULL;
+
+  pr->pRepo = pRepo;
+  pr->interval.interval = pr->interval.sliding = interval;
+  pr->interval.intervalUnit = pr->interval.slidingUnit = unit;
+  pr->fid = TSDB_IVLD_FID;
+  pr->tier = -1;
+  pr->fd = -1;
+  return pr;
+}
+
+void tsdbFreeRollupR(SRollupR *pr) {
+  if (pr == NULL) return;
+
+  tsdbRollupCloseFSet(pr);
+  taosTZfree(pr->pBuf);
+  free(pr);
+}
+
+// Buckets of the tier make up windows of the interval if the tier divides the interval and windows start at bucket
+// starts. Windows and buckets of days and weeks start at local midnight, the ones of other units do not, so a window
+// start is compared with the start of the bucket holding it.
+static bool tsdbRollupTierFits(SRollupR *pr, int tier) {
+  STsdbCfg *pCfg = REPO_CFG(pr->pRepo);
+  SInterval tierInterval = {0};
+  TSKEY     minKey, maxKey;
+
+  if (pr->header.intervals[tier] <= 0 || pr->interval.interval % pr->header.intervals[tier] != 0) return false;
+
+  tierInterval.interval = tierInterval.sliding = pr->header.intervals[tier];
+  tierInterval.intervalUnit = tierInterval.slidingUnit = (char)pr->header.units[tier];
+
+  tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, pr->fid, &minKey, &maxKey);
+  TSKEY wstart = taosTimeTruncate(minKey, &pr->interval, pCfg->precision);
+  return (wstart - tsdbRollupBucketStart(&tierInterval, wstart, pCfg->precision)) % tierInterval.interval == 0;
+}
+
+// The rollup of a file set is read only if one of its tiers fits the interval, the coarsest such tier is picked
+void tsdbRollupOpenFSet(SRollupR *pr, SDFileSet *pSet) {
+  SDFile *pHeadf = TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD);
+
+  if (pr == NULL) return;
+  if (pr->fid == pSet->fid && pr->header.headMagic == pHeadf->info.magic && pr->header.headSize == pHeadf->info.size) {
+    return;
+  }
+
+  tsdbRollupCloseFSet(pr);
+  pr->fid = pSet->fid;
+  memset(&pr->header, 0, sizeof(pr->header));
+
+  if (tsdbLoadRollup(pr->pRepo, pSet, &pr->header, &pr->fd, &pr->pIdx) < 0 || pr->fd < 0) {
+    pr->header.headMagic = pHeadf->info.magic;
+    pr->header.headSize = pHeadf->info.size;
+    return;
+  }
+
+  for (int i = pr->header.nTiers - 1; i >= 0; i--) {
+    if (tsdbRollupTierFits(pr, i)) {
+      pr->tier = i;
+      break;
+    }
+  }
+
+  if (pr->tier >= 0) {
+    pr->pTables = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, HASH_NO_LOCK);
+    if (pr->pTables == NULL) pr->tier = -1;
+  }
+
+  if (pr->tier < 0) {
+    close(pr->fd);
+    pr->fd = -1;
+    taosHashCleanup(pr->pIdx);
+    pr->pIdx = NULL;
+  }
+
+  tsdbDebug("vgId:%d file set %d is read with rollup tier %d for interval %" PRId64, REPO_ID(pr->pRepo), pSet->fid,
+            pr->tier, pr->interval.interval);
+}
+
+// Decode the buckets of the tier read of all blocks of the table
+static SRollupTable *tsdbRollupDecodeTable(SRollupR *pr, uint64_t uid) {
+  SRollupTable *pTable = (SRollupTable *)calloc(1, sizeof(*pTable));
+  SRollupIdx *  pIdx = taosHashGet(pr->pIdx, &uid, sizeof(uid));
+  uint32_t      nBlocks = 0;
+  uint32_t      len;
+  uint32_t      totalBuckets = 0;
+  uint32_t      totalCols = 0;
+  void *        ptr;
+  void *        pRecords = NULL;
+
+  if (pTable == NULL) return NULL;
+
+  if (pIdx != NULL) {
+    // a section failing the check is read as a table without rollup
+    pRecords = tsdbReadRollupTable(pr->pRepo, pr->fd, pIdx, &pr->pBuf, &nBlocks);
+    if (pRecords == NULL) nBlocks = 0;
+  }
+
+  // the first pass counts the buckets and columns
+  ptr = pRecords;
+  for (uint32_t i = 0; i < nBlocks; i++) {
+    SRollupBlock block;
+    uint32_t     nBuckets, nCols, tlen;
+    void *       pRecord = ptr;
+
+    ptr = tsdbDecodeRollupBlockHead(ptr, &len, &block);
+    for (int t = 0; t < pr->tier; t++) {
+      ptr = POINTER_SHIFT(ptr, sizeof(uint32_t) * 2);
+      ptr = taosDecodeFixedU32(ptr, &tlen);
+      ptr = POINTER_SHIFT(ptr, tlen);
+    }
+    ptr = taosDecodeFixedU32(ptr, &nBuckets);
+    ptr = taosDecodeFixedU32(ptr, &nCols);
+    totalBuckets += nBuckets;
+    totalCols += nCols;
+    ptr = POINTER_SHIFT(pRecord, len);
+  }
+
+  pTable->blocks = (SRollupBlock *)calloc(nBlocks + 1, sizeof(SRollupBlock));
+  pTable->buckets = (SRollupBucket *)calloc(totalBuckets + 1, sizeof(SRollupBucket));
+  pTable->cols = (SDataStatis *)calloc(totalCols + 1, sizeof(SDataStatis));
+  if (pTable->blocks == NULL || pTable->buckets == NULL || pTable->cols == NULL) {
+    tfree(pTable->blocks);
+    tfree(pTable->buckets);
+    tfree(pTable->cols);
+    free(pTable);
+    return NULL;
+  }
+
+  SRollupBucket *pBucket = pTable->buckets;
+  SDataStatis *  pStatis = pTable->cols;
+
+  ptr = pRecords;
+  for (uint32_t i = 0; i < nBlocks; i++) {
+    SRollupBlock *pBlock = pTable->blocks + i;
+    uint32_t      nBuckets, nCols, tlen;
+    void *        pRecord = ptr;
+
+    ptr = tsdbDecodeRollupBlockHead(ptr, &len, pBlock);
+    for (int t = 0; t < pr->tier; t++) {
+      ptr = POINTER_SHIFT(ptr, sizeof(uint32_t) * 2);
+      ptr = taosDecodeFixedU32(ptr, &tlen);
+      ptr = POINTER_SHIFT(ptr, tlen);
+    }
+    ptr = taosDecodeFixedU32(ptr, &nBuckets);
+    ptr = taosDecodeFixedU32(ptr, &nCols);
+    ptr = taosDecodeFixedU32(ptr, &tlen);
+
+    pBlock->nBuckets = (int32_t)nBuckets;
+    pBlock->buckets = pBucket;
+    for (uint32_t b = 0; b < nBuckets; b++, pBucket++) {
+      uint16_t bCols;
+
+      ptr = taosDecodeFixedI64(ptr, &pBucket->skey);
+      ptr = taosDecodeFixedI64(ptr, &pBucket->ekey);
+      ptr = taosDecodeFixedI32(ptr, &pBucket->start);
+      ptr = taosDecodeFixedI32(ptr, &pBucket->rows);
+      ptr = taosDecodeFixedU16(ptr, &bCols);
+
+      pBucket->nCols = bCols;
+      pBucket->cols = pStatis;
+      for (uint16_t c = 0; c < bCols; c++, pStatis++) {
+        ptr = taosDecodeFixedI16(ptr, &pStatis->colId);
+        ptr = taosDecodeFixedI16(ptr, &pStatis->numOfNull);
+        ptr = taosDecodeFixedI16(ptr, &pStatis->maxIndex);
+        ptr = taosDecodeFixedI16(ptr, &pStatis->minIndex);
+        ptr = taosDecodeFixedI64(ptr, &pStatis->sum);
+        ptr = taosDecodeFixedI64(ptr, &pStatis->max);
+        ptr = taosDecodeFixedI64(ptr, &pStatis->min);
+      }
+    }
+
+    ptr = POINTER_SHIFT(pRecord, len);
+  }
+
+  pTable->nBlocks = (int32_t)nBlocks;
+  return pTable;
+}
+
+// Buckets of a block of the table, NULL if the block has no record in the rollup
+SRollupBlock *tsdbRollupGetBlock(SRollupR *pr, uint64_t uid, const SBlock *pBlock) {
+  if (pr == NULL || pr->tier < 0 || pBlock->numOfSubBlocks > 1) return NULL;
+
+  SRollupTable **ppTable = taosHashGet(pr->pTables, &uid, sizeof(uid));
+  SRollupTable * pTable = NULL;
+  if (ppTable == NULL) {
+    pTable = tsdbRollupDecodeTable(pr, uid);
+    if (pTable == NULL) return NULL;
+    if (taosHashPut(pr->pTables, &uid, sizeof(uid), &pTable, sizeof(pTable)) < 0) {
+      free(pTable->blocks);
+      free(pTable->buckets);
+      free(pTable->cols);
+      free(pTable);
+      return NULL;
+    }
+  } else {
+    pTable = *ppTable;
+  }
+
+  int32_t lo = 0, hi = pTable->nBlocks - 1;
+  while (lo <= hi) {
+    int32_t       mid = (lo + hi) >> 1;
+    SRollupBlock *pRBlock = pTable->blocks + mid;
+
+    if (pRBlock->keyFirst < pBlock->keyFirst) {
+      lo = mid + 1;
+    } else if (pRBlock->keyFirst > pBlock->keyFirst) {
+      hi = mid - 1;
+    } else {
+      return (pRBlock->keyLast == pBlock->keyLast && pRBlock->numOfRows == pBlock->numOfRows) ? pRBlock : NULL;
+    }
+  }
+
+  return NULL;
+}
@@ -16,44 +16,117 @@
 #define _DEFAULT_SOURCE
 #include "os.h"
 #include "taoserror.h"
+#include "tchecksum.h"
+#include "tglobal.h"
+#include "tmd5.h"
+#include "tsync.h"
 #include "tsdbint.h"
 
-// Sync handle
+// Decisions on a file sent by the receiver. A fileset that exists on both sides is sent by chunks: the receiver sends
+// the digest of each chunk of its local files, and the sender replies with a bitmap of changed chunks followed by
+// their content. The receiver rebuilds the files from its local chunks and the received ones.
+#define TSDB_SYNC_SKIP   0
+#define TSDB_SYNC_WHOLE  1
+#define TSDB_SYNC_DIFF   2
+#define TSDB_SYNC_VERIFY 0x80  // or-ed into a decision to ask for a checksum after each piece of content sent
+
+#define TSDB_SYNC_DIFF_VERSION   1  // appended to the fileset info by senders able to send changed chunks
+#define TSDB_SYNC_STREAM_VERSION 2  // followed by the number of streams, senders are able to send checksums too
+#define TSDB_SYNC_CHUNK_SIZE     (256 * 1024)
+#define TSDB_SYNC_DIGEST_SIZE    16
+#define TSDB_SYNC_SEND_SIZE      (TSDB_SYNC_CHUNK_SIZE * 16)
+#define TSDB_SYNC_CHUNKS(size)   (((size) + TSDB_SYNC_CHUNK_SIZE - 1) / TSDB_SYNC_CHUNK_SIZE)
+#define TSDB_SYNC_CHUNK_LEN(size, i) MIN(TSDB_SYNC_CHUNK_SIZE, (size) - (int64_t)(i) * TSDB_SYNC_CHUNK_SIZE)
+#define TSDB_SYNC_STREAM_JOBS    4
+
+// A file to transfer. Files are assigned to streams round-robin in the same order on both sides, so each stream
+// carries the files of its own in the order they are decided on the sync connection.
 typedef struct {
-  STsdbRepo *pRepo;
-  SRtn       rtn;
-  SOCKET     socketFd;
-  void *     pBuf;
-  bool       mfChanged;
-  SMFile *   pmf;
-  SMFile     mf;
-  SDFileSet  df;
-  SDFileSet *pdf;
-} SSyncH;
+  uint8_t decision;
+  SDFile  df;   // file to send, or the new file to receive, opened and owned by the job
+  SDFile  ldf;  // local file of an older version to rebuild the new one from
+  SDFile  rdf;  // remote file
+} SSyncJob;
+
+typedef struct SSyncH SSyncH;
+
+typedef struct {
+  SSyncH *        pSynch;
+  SOCKET          socketFd;
+  void *          pBuf;
+  void *          pData;  // content of files read to be checksummed
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  notEmpty;
+  pthread_cond_t  notFull;
+  SSyncJob        jobs[TSDB_SYNC_STREAM_JOBS];
+  int32_t         head;
+  int32_t         size;
+  bool            stop;
+} SSyncStream;
+
+// Sync handle
+struct SSyncH {
+  STsdbRepo *  pRepo;
+  SRtn         rtn;
+  SOCKET       socketFd;
+  void *       pBuf;
+  bool         mfChanged;
+  SMFile *     pmf;
+  SMFile       mf;
+  SDFileSet    df;
+  SDFileSet *  pdf;
+  bool         remoteDiff;    // remote is able to send a fileset by changed chunks
+  bool         remoteVerify;  // remote is able to send checksums of files
+  int32_t      remoteStreams;
+  int64_t      startTime;
+  int64_t      sentBytes;
+  SOCKET *     streamFds;
+  int32_t *    numOfStreams;  // streams connected, files are sent over the sync connection if there is none
+  SSyncStream  mstream;       // stream over the sync connection
+  SSyncStream *streams;
+  int32_t      nStreams;      // streams in use
+  int32_t      nextStream;
+  int32_t      code;          // first error of streams
+  int32_t (*jobFp)(SSyncStream *pStream, SSyncJob *pJob);
+};
 
 #define SYNC_BUFFER(sh) ((sh)->pBuf)
 
-static void    tsdbInitSyncH(SSyncH *pSyncH, STsdbRepo *pRepo, SOCKET socketFd);
+static void    tsdbInitSyncH(SSyncH *pSyncH, STsdbRepo *pRepo, SOCKET socketFd, SOCKET *streamFds,
+                             int32_t *numOfStreams);
 static void    tsdbDestroySyncH(SSyncH *pSyncH);
 static int32_t tsdbSyncSendMeta(SSyncH *pSynch);
 static int32_t tsdbSyncRecvMeta(SSyncH *pSynch);
 static int32_t tsdbSendMetaInfo(SSyncH *pSynch);
 static int32_t tsdbRecvMetaInfo(SSyncH *pSynch);
-static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend);
-static int32_t tsdbRecvDecision(SSyncH *pSynch, bool *toSend);
+static int32_t tsdbSendDecision(SSyncH *pSynch, uint8_t decision);
+static int32_t tsdbRecvDecision(SSyncH *pSynch, uint8_t *decision);
 static int32_t tsdbSyncSendDFileSetArray(SSyncH *pSynch);
 static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch);
 static bool    tsdbIsTowFSetSame(SDFileSet *pSet1, SDFileSet *pSet2);
 static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet);
 static int32_t tsdbSendDFileSetInfo(SSyncH *pSynch, SDFileSet *pSet);
 static int32_t tsdbRecvDFileSetInfo(SSyncH *pSynch);
+static int32_t tsdbSyncStartStreams(SSyncH *pSynch, int32_t nStreams);
+static int32_t tsdbSyncStopStreams(SSyncH *pSynch);
+static void    tsdbSyncAbort(SSyncH *pSynch, int32_t code);
+static int32_t tsdbSyncDispatch(SSyncH *pSynch, SSyncJob *pJob);
+static int32_t tsdbSyncSendFile(SSyncStream *pStream, SSyncJob *pJob);
+static int32_t tsdbSyncRecvFile(SSyncStream *pStream, SSyncJob *pJob);
+static int32_t tsdbSyncSendDFileDiff(SSyncStream *pStream, SDFile *pDFile, bool verify);
+static int32_t tsdbSyncRecvDFileDiff(SSyncStream *pStream, SDFile *pLDFile, SDFile *pDFile, SDFile *pRDFile,
+                                     bool verify);
+static int32_t tsdbSyncSendData(SSyncStream *pStream, SDFile *pDFile, int64_t offset, int64_t len, bool verify);
+static int32_t tsdbSyncRecvData(SSyncStream *pStream, SDFile *pDFile, int64_t len, bool verify);
 static int     tsdbReload(STsdbRepo *pRepo, bool isMfChanged);
 
-int32_t tsdbSyncSend(void *tsdb, SOCKET socketFd) {
+int32_t tsdbSyncSend(void *tsdb, SOCKET socketFd, SOCKET *streamFds, int32_t numOfStreams) {
   STsdbRepo *pRepo = (STsdbRepo *)tsdb;
   SSyncH     synch = {0};
 
-  tsdbInitSyncH(&synch, pRepo, socketFd);
+  tsdbInitSyncH(&synch, pRepo, socketFd, streamFds, &numOfStreams);
+  synch.jobFp = tsdbSyncSendFile;
   // Disable TSDB commit
   tsem_wait(&(pRepo->readyToCommit));
 
@@ -64,6 +137,13 @@ int32_t tsdbSyncSend(void *tsdb, SOCKET socketFd) {
 
   if (tsdbSyncSendDFileSetArray(&synch) < 0) {
     tsdbError("vgId:%d, failed to send filesets since %s", REPO_ID(pRepo), tstrerror(terrno));
+    tsdbSyncAbort(&synch, terrno);
+    tsdbSyncStopStreams(&synch);
+    goto _err;
+  }
+
+  if (tsdbSyncStopStreams(&synch) < 0) {
+    tsdbError("vgId:%d, failed to send files since %s", REPO_ID(pRepo), tstrerror(terrno));
     goto _err;
   }
 
@@ -78,13 +158,14 @@ _err:
   return -1;
 }
 
-int32_t tsdbSyncRecv(void *tsdb, SOCKET socketFd) {
+int32_t tsdbSyncRecv(void *tsdb, SOCKET socketFd, SOCKET *streamFds, int32_t *numOfStreams) {
   STsdbRepo *pRepo = (STsdbRepo *)tsdb;
   SSyncH synch = {0};
 
   pRepo->state = TSDB_STATE_OK;
 
-  tsdbInitSyncH(&synch, pRepo, socketFd);
+  tsdbInitSyncH(&synch, pRepo, socketFd, streamFds, numOfStreams);
+  synch.jobFp = tsdbSyncRecvFile;
   tsem_wait(&(pRepo->readyToCommit));
   tsdbStartFSTxn(pRepo, 0, 0);
 
@@ -95,6 +176,13 @@ int32_t tsdbSyncRecv(void *tsdb, SOCKET socketFd) {
 
   if (tsdbSyncRecvDFileSetArray(&synch) < 0) {
     tsdbError("vgId:%d, failed to recv filesets since %s", REPO_ID(pRepo), tstrerror(terrno));
+    tsdbSyncAbort(&synch, terrno);
+    tsdbSyncStopStreams(&synch);
+    goto _err;
+  }
+
+  if (tsdbSyncStopStreams(&synch) < 0) {
+    tsdbError("vgId:%d, failed to recv files since %s", REPO_ID(pRepo), tstrerror(terrno));
     goto _err;
   }
 
@@ -114,17 +202,27 @@ _err:
   return -1;
 }
 
-static void tsdbInitSyncH(SSyncH *pSyncH, STsdbRepo *pRepo, SOCKET socketFd) {
+static void tsdbInitSyncH(SSyncH *pSyncH, STsdbRepo *pRepo, SOCKET socketFd, SOCKET *streamFds,
+                          int32_t *numOfStreams) {
   pSyncH->pRepo = pRepo;
   pSyncH->socketFd = socketFd;
+  pSyncH->startTime = taosGetTimestampMs();
+  pSyncH->streamFds = streamFds;
+  pSyncH->numOfStreams = numOfStreams;
+  pSyncH->mstream.pSynch = pSyncH;
+  pSyncH->mstream.socketFd = socketFd;
   tsdbGetRtnSnap(pRepo, &(pSyncH->rtn));
 }
 
-static void tsdbDestroySyncH(SSyncH *pSyncH) { taosTZfree(pSyncH->pBuf); }
+static void tsdbDestroySyncH(SSyncH *pSyncH) {
+  taosTZfree(pSyncH->pBuf);
+  taosTZfree(pSyncH->mstream.pBuf);
+  taosTZfree(pSyncH->mstream.pData);
+}
 
 static int32_t tsdbSyncSendMeta(SSyncH *pSynch) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  bool       toSendMeta = false;
+  uint8_t    toSendMeta = TSDB_SYNC_SKIP;
   SMFile     mf;
 
   // Send meta info to remote
@@ -199,7 +297,7 @@ static int32_t tsdbSyncRecvMeta(SSyncH *pSynch) {
     // Local has no meta file or has a different meta file, need to copy from remote
     pSynch->mfChanged = true;
 
-    if (tsdbSendDecision(pSynch, true) < 0) {
+    if (tsdbSendDecision(pSynch, TSDB_SYNC_WHOLE) < 0) {
       tsdbError("vgId:%d, failed to send decision while recv metafile since %s", REPO_ID(pRepo), tstrerror(terrno));
       return -1;
     }
@@ -236,7 +334,7 @@ static int32_t tsdbSyncRecvMeta(SSyncH *pSynch) {
   } else {
     pSynch->mfChanged = false;
     tsdbInfo("vgId:%d, metafile is same, no need to recv", REPO_ID(pRepo));
-    if (tsdbSendDecision(pSynch, false) < 0) {
+    if (tsdbSendDecision(pSynch, TSDB_SYNC_SKIP) < 0) {
       tsdbError("vgId:%d, failed to send decision while recv metafile since %s", REPO_ID(pRepo), tstrerror(terrno));
       return -1;
     }
@@ -327,9 +425,8 @@ static int32_t tsdbRecvMetaInfo(SSyncH *pSynch) {
   return 0;
 }
 
-static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend) {
+static int32_t tsdbSendDecision(SSyncH *pSynch, uint8_t decision) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  uint8_t    decision = toSend;
 
   int32_t writeLen = sizeof(uint8_t);
   int32_t ret = taosWriteMsg(pSynch->socketFd, (void *)(&decision), writeLen);
@@ -342,19 +439,17 @@ static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend) {
   return 0;
 }
 
-static int32_t tsdbRecvDecision(SSyncH *pSynch, bool *toSend) {
+static int32_t tsdbRecvDecision(SSyncH *pSynch, uint8_t *decision) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  uint8_t    decision = 0;
 
   int32_t readLen = sizeof(uint8_t);
-  int32_t ret = taosReadMsg(pSynch->socketFd, (void *)(&decision), readLen);
+  int32_t ret = taosReadMsg(pSynch->socketFd, (void *)decision, readLen);
   if (ret != readLen) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     tsdbError("vgId:%d, failed to recv decison, ret:%d readLen:%d", REPO_ID(pRepo), ret, readLen);
     return -1;
   }
 
-  *toSend = decision;
   return 0;
 }
 
@@ -366,6 +461,11 @@ static int32_t tsdbSyncSendDFileSetArray(SSyncH *pSynch) {
 
   tsdbFSIterInit(&fsiter, pfs, TSDB_FS_ITER_FORWARD);
 
+  if (tsdbSyncStartStreams(pSynch, *pSynch->numOfStreams) < 0) {
+    tsdbError("vgId:%d, failed to start streams since %s", REPO_ID(pRepo), tstrerror(terrno));
+    return -1;
+  }
+
   do {
     pSet = tsdbFSIterNext(&fsiter);
     if (tsdbSyncSendDFileSet(pSynch, pSet) < 0) {
@@ -398,6 +498,12 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
     return -1;
   }
 
+  // Streams of remote are all connected before it sends the first fileset info
+  if (tsdbSyncStartStreams(pSynch, pSynch->remoteStreams) < 0) {
+    tsdbError("vgId:%d, failed to start streams since %s", REPO_ID(pRepo), tstrerror(terrno));
+    return -1;
+  }
+
   while (true) {
     if (pLSet == NULL && pSynch->pdf == NULL) {
       tsdbInfo("vgId:%d, all filesets is disposed", REPO_ID(pRepo));
@@ -423,16 +529,17 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
           return -1;
         }
 
-        if (tsdbSendDecision(pSynch, false) < 0) {
+        if (tsdbSendDecision(pSynch, TSDB_SYNC_SKIP) < 0) {
           tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
           return -1;
         }
       } else {
         // Need to copy from remote
+        uint8_t decision = TSDB_SYNC_WHOLE;
         int fidLevel = tsdbGetFidLevel(pSynch->pdf->fid, &(pSynch->rtn));
         if (fidLevel < 0) {  // expired fileset
           tsdbInfo("vgId:%d, fileset:%d will be skipped as expired", REPO_ID(pRepo), pSynch->pdf->fid);
-          if (tsdbSendDecision(pSynch, false) < 0) {
+          if (tsdbSendDecision(pSynch, TSDB_SYNC_SKIP) < 0) {
             tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
             return -1;
           }
@@ -447,9 +554,14 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
           // Next loop
           continue;
         } else {
-          tsdbInfo("vgId:%d, fileset:%d will be received", REPO_ID(pRepo), pSynch->pdf->fid);
+          // Only the changed chunks are needed if an older version of the fileset exists here
+          if (pSynch->remoteDiff && pLSet && pLSet->fid == pSynch->pdf->fid) {
+            decision = TSDB_SYNC_DIFF;
+          }
+          tsdbInfo("vgId:%d, fileset:%d will be received %s", REPO_ID(pRepo), pSynch->pdf->fid,
+                   decision == TSDB_SYNC_DIFF ? "by changed chunks" : "wholly");
           // Notify remote to send there file here
-          if (tsdbSendDecision(pSynch, true) < 0) {
+          if (tsdbSendDecision(pSynch, pSynch->remoteVerify ? (decision | TSDB_SYNC_VERIFY) : decision) < 0) {
             tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
             return -1;
           }
@@ -475,26 +587,29 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
         }
 
         for (TSDB_FILE_T ftype = 0; ftype < TSDB_FILE_MAX; ftype++) {
-          SDFile *pDFile = TSDB_DFILE_IN_SET(&fset, ftype);         // local file
-          SDFile *pRDFile = TSDB_DFILE_IN_SET(pSynch->pdf, ftype);  // remote file
+          SDFile * pDFile = TSDB_DFILE_IN_SET(&fset, ftype);         // local file
+          SDFile * pRDFile = TSDB_DFILE_IN_SET(pSynch->pdf, ftype);  // remote file
+          SSyncJob job = {.decision = decision, .df = *pDFile, .rdf = *pRDFile};
 
           tsdbInfo("vgId:%d, file:%s will be received, osize:%" PRIu64 " rsize:%" PRIu64, REPO_ID(pRepo),
                    pDFile->f.aname, pDFile->info.size, pRDFile->info.size);
 
-          int64_t writeLen = pRDFile->info.size;
-          int64_t ret = taosCopyFds(pSynch->socketFd, pDFile->fd, writeLen);
-          if (ret != writeLen) {
-            terrno = TAOS_SYSTEM_ERROR(errno);
-            tsdbError("vgId:%d, failed to recv file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
-                      pDFile->f.aname, tstrerror(terrno), ret, writeLen);
+          if (decision == TSDB_SYNC_DIFF) {
+            job.ldf = *TSDB_DFILE_IN_SET(pLSet, ftype);
+          }
+          if (pSynch->remoteVerify) {
+            job.decision |= TSDB_SYNC_VERIFY;
+          }
+
+          // The opened file is handed over to the job, and is received once all jobs are done
+          TSDB_FILE_SET_CLOSED(pDFile);
+          pDFile->info = pRDFile->info;
+          if (tsdbSyncDispatch(pSynch, &job) < 0) {
+            tsdbError("vgId:%d, failed to recv file:%s since %s", REPO_ID(pRepo), pDFile->f.aname, tstrerror(terrno));
             tsdbCloseDFileSet(&fset);
             tsdbRemoveDFileSet(&fset);
             return -1;
           }
-
-          // Update new file info
-          pDFile->info = pRDFile->info;
-          tsdbInfo("vgId:%d, file:%s is received, size:%" PRId64, REPO_ID(pRepo), pDFile->f.aname, writeLen);
         }
 
         tsdbCloseDFileSet(&fset);
@@ -564,7 +679,7 @@ static bool tsdbIsTowFSetSame(SDFileSet *pSet1, SDFileSet *pSet2) {
 
 static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  bool toSend = false;
+  uint8_t    toSend = TSDB_SYNC_SKIP;
 
   // skip expired fileset
   if (pSet && tsdbGetFidLevel(pSet->fid, &(pSynch->rtn)) < 0) {
@@ -590,30 +705,23 @@ static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet) {
   }
 
   if (toSend) {
-    tsdbInfo("vgId:%d, fileset:%d will be sent", REPO_ID(pRepo), pSet->fid);
+    tsdbInfo("vgId:%d, fileset:%d will be sent %s%s", REPO_ID(pRepo), pSet->fid,
+             (toSend & ~TSDB_SYNC_VERIFY) == TSDB_SYNC_DIFF ? "by changed chunks" : "wholly",
+             (toSend & TSDB_SYNC_VERIFY) ? " with checksums" : "");
 
     for (TSDB_FILE_T ftype = 0; ftype < TSDB_FILE_MAX; ftype++) {
-      SDFile df = *TSDB_DFILE_IN_SET(pSet, ftype);
-      
-      if (tsdbOpenDFile(&df, O_RDONLY) < 0) {
-        tsdbError("vgId:%d, failed to file:%s since %s", REPO_ID(pRepo), df.f.aname, tstrerror(terrno));
+      SSyncJob job = {.decision = toSend, .df = *TSDB_DFILE_IN_SET(pSet, ftype)};
+
+      if (tsdbOpenDFile(&job.df, O_RDONLY) < 0) {
+        tsdbError("vgId:%d, failed to file:%s since %s", REPO_ID(pRepo), job.df.f.aname, tstrerror(terrno));
         return -1;
       }
 
-      int64_t writeLen = df.info.size;
-      tsdbInfo("vgId:%d, file:%s will be sent, size:%" PRId64, REPO_ID(pRepo), df.f.aname, writeLen);
-
-      int64_t ret = taosSendFile(pSynch->socketFd, TSDB_FILE_FD(&df), 0, writeLen);
-      if (ret != writeLen) {
-        terrno = TAOS_SYSTEM_ERROR(errno);
-        tsdbError("vgId:%d, failed to send file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
-                  df.f.aname, tstrerror(terrno), ret, writeLen);
-        tsdbCloseDFile(&df);
+      tsdbInfo("vgId:%d, file:%s will be sent, size:%" PRId64, REPO_ID(pRepo), job.df.f.aname, job.df.info.size);
+      if (tsdbSyncDispatch(pSynch, &job) < 0) {
+        tsdbError("vgId:%d, failed to send file:%s since %s", REPO_ID(pRepo), job.df.f.aname, tstrerror(terrno));
         return -1;
       }
-
-      tsdbInfo("vgId:%d, file:%s is sent", REPO_ID(pRepo), df.f.aname);
-      tsdbCloseDFile(&df);
     }
 
     tsdbInfo("vgId:%d, fileset:%d is sent", REPO_ID(pRepo), pSet->fid);
@@ -629,7 +737,7 @@ static int32_t tsdbSendDFileSetInfo(SSyncH *pSynch, SDFileSet *pSet) {
   uint32_t   tlen = 0;
 
   if (pSet) {
-    tlen = tsdbEncodeDFileSetEx(NULL, pSet) + sizeof(TSCKSUM);
+    tlen = tsdbEncodeDFileSetEx(NULL, pSet) + sizeof(uint8_t) * 2 + sizeof(TSCKSUM);
   }
 
   if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), tlen + sizeof(tlen)) < 0) {
@@ -642,6 +750,9 @@ static int32_t tsdbSendDFileSetInfo(SSyncH *pSynch, SDFileSet *pSet) {
   void *tptr = ptr;
   if (pSet) {
     tsdbEncodeDFileSetEx(&ptr, pSet);
+    // Ignored by receivers which decode the fileset only
+    taosEncodeFixedU8(&ptr, TSDB_SYNC_STREAM_VERSION);
+    taosEncodeFixedU8(&ptr, (uint8_t)(*pSynch->numOfStreams));
     taosCalcChecksumAppend(0, (uint8_t *)tptr, tlen);
   }
 
@@ -695,7 +806,534 @@ static int32_t tsdbRecvDFileSetInfo(SSyncH *pSynch) {
   }
 
   pSynch->pdf = &(pSynch->df);
-  tsdbDecodeDFileSetEx(SYNC_BUFFER(pSynch), pSynch->pdf);
+  void *ptr = tsdbDecodeDFileSetEx(SYNC_BUFFER(pSynch), pSynch->pdf);
+
+  uint8_t syncVersion = 0;
+  uint8_t nStreams = 0;
+  if (POINTER_DISTANCE(ptr, SYNC_BUFFER(pSynch)) + sizeof(uint8_t) + sizeof(TSCKSUM) <= tlen) {
+    ptr = taosDecodeFixedU8(ptr, &syncVersion);
+  }
+  if (syncVersion >= TSDB_SYNC_STREAM_VERSION) {
+    taosDecodeFixedU8(ptr, &nStreams);
+  }
+  pSynch->remoteDiff = (syncVersion >= TSDB_SYNC_DIFF_VERSION);
+  pSynch->remoteVerify = (syncVersion >= TSDB_SYNC_STREAM_VERSION);
+  pSynch->remoteStreams = nStreams;
+
+  return 0;
+}
+
+static void *tsdbSyncStreamFp(void *param) {
+  SSyncStream *pStream = (SSyncStream *)param;
+  SSyncH *     pSynch = pStream->pSynch;
+  SSyncJob     job;
+
+  setThreadName("tsdbSyncStream");
+
+  while (true) {
+    pthread_mutex_lock(&pStream->mutex);
+    while (pStream->size == 0 && !pStream->stop) {
+      pthread_cond_wait(&pStream->notEmpty, &pStream->mutex);
+    }
+    if (pStream->size == 0) {
+      pthread_mutex_unlock(&pStream->mutex);
+      break;
+    }
+    job = pStream->jobs[pStream->head];
+    pStream->head = (pStream->head + 1) % TSDB_SYNC_STREAM_JOBS;
+    pStream->size--;
+    pthread_cond_signal(&pStream->notFull);
+    pthread_mutex_unlock(&pStream->mutex);
+
+    // Jobs queued are still taken after an error to release the files of them
+    if ((*pSynch->jobFp)(pStream, &job) < 0) {
+      tsdbSyncAbort(pSynch, terrno);
+    }
+  }
+
+  return NULL;
+}
+
+static int32_t tsdbSyncStartStreams(SSyncH *pSynch, int32_t nStreams) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+
+  if (nStreams <= 0) return 0;
+
+  if (nStreams > atomic_load_32(pSynch->numOfStreams)) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    tsdbError("vgId:%d, remote sends files over %d streams, but %d are connected", REPO_ID(pRepo), nStreams,
+              atomic_load_32(pSynch->numOfStreams));
+    return -1;
+  }
+
+  pSynch->streams = (SSyncStream *)calloc(nStreams, sizeof(SSyncStream));
+  if (pSynch->streams == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  for (int32_t i = 0; i < nStreams; i++) {
+    SSyncStream *pStream = pSynch->streams + i;
+
+    pStream->pSynch = pSynch;
+    pStream->socketFd = pSynch->streamFds[i];
+    pthread_mutex_init(&pStream->mutex, NULL);
+    pthread_cond_init(&pStream->notEmpty, NULL);
+    pthread_cond_init(&pStream->notFull, NULL);
+
+    if (pthread_create(&pStream->thread, NULL, tsdbSyncStreamFp, pStream) != 0) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      pthread_mutex_destroy(&pStream->mutex);
+      pthread_cond_destroy(&pStream->notEmpty);
+      pthread_cond_destroy(&pStream->notFull);
+      tsdbSyncAbort(pSynch, terrno);
+      tsdbSyncStopStreams(pSynch);
+      return -1;
+    }
+
+    pSynch->nStreams++;
+  }
+
+  tsdbInfo("vgId:%d, files will be transferred over %d streams", REPO_ID(pRepo), nStreams);
+  return 0;
+}
+
+// Wait until all files queued are transferred, the first error of streams is returned if any
+static int32_t tsdbSyncStopStreams(SSyncH *pSynch) {
+  for (int32_t i = 0; i < pSynch->nStreams; i++) {
+    SSyncStream *pStream = pSynch->streams + i;
+
+    pthread_mutex_lock(&pStream->mutex);
+    pStream->stop = true;
+    pthread_cond_signal(&pStream->notEmpty);
+    pthread_mutex_unlock(&pStream->mutex);
+  }
+
+  for (int32_t i = 0; i < pSynch->nStreams; i++) {
+    SSyncStream *pStream = pSynch->streams + i;
+
+    pthread_join(pStream->thread, NULL);
+    pthread_mutex_destroy(&pStream->mutex);
+    pthread_cond_destroy(&pStream->notEmpty);
+    pthread_cond_destroy(&pStream->notFull);
+    taosTZfree(pStream->pBuf);
+    taosTZfree(pStream->pData);
+  }
+
+  tfree(pSynch->streams);
+  pSynch->nStreams = 0;
+
+  int32_t code = atomic_load_32(&pSynch->code);
+  if (code != 0) {
+    terrno = code;
+    return -1;
+  }
+
+  return 0;
+}
+
+// Record the first error and shut all connections down so that both sides blocked on them give up
+static void tsdbSyncAbort(SSyncH *pSynch, int32_t code) {
+  if (code == 0) code = TSDB_CODE_TDB_MESSED_MSG;
+  if (atomic_val_compare_exchange_32(&pSynch->code, 0, code) != 0) return;
+  if (pSynch->nStreams == 0) return;
+
+  tsdbError("vgId:%d, file transfer is aborted since %s", REPO_ID(pSynch->pRepo), tstrerror(code));
+  shutdown(pSynch->socketFd, SHUT_RDWR);
+  for (int32_t i = 0; i < pSynch->nStreams; i++) {
+    shutdown(pSynch->streams[i].socketFd, SHUT_RDWR);
+  }
+}
+
+// Transfer a file over the sync connection, or queue it to the next stream. The job always releases the file.
+static int32_t tsdbSyncDispatch(SSyncH *pSynch, SSyncJob *pJob) {
+  if (pSynch->nStreams == 0) {
+    return (*pSynch->jobFp)(&pSynch->mstream, pJob);
+  }
+
+  SSyncStream *pStream = pSynch->streams + pSynch->nextStream;
+  pSynch->nextStream = (pSynch->nextStream + 1) % pSynch->nStreams;
+
+  pthread_mutex_lock(&pStream->mutex);
+  while (pStream->size == TSDB_SYNC_STREAM_JOBS) {
+    pthread_cond_wait(&pStream->notFull, &pStream->mutex);
+  }
+  pStream->jobs[(pStream->head + pStream->size) % TSDB_SYNC_STREAM_JOBS] = *pJob;
+  pStream->size++;
+  pthread_cond_signal(&pStream->notEmpty);
+  pthread_mutex_unlock(&pStream->mutex);
+
+  int32_t code = atomic_load_32(&pSynch->code);
+  if (code != 0) {
+    terrno = code;
+    return -1;
+  }
+
+  return 0;
+}
+
+static int32_t tsdbSyncSendFile(SSyncStream *pStream, SSyncJob *pJob) {
+  STsdbRepo *pRepo = pStream->pSynch->pRepo;
+  SDFile *   pDFile = &pJob->df;
+  bool       verify = (pJob->decision & TSDB_SYNC_VERIFY) != 0;
+  int32_t    code = 0;
+
+  if (atomic_load_32(&pStream->pSynch->code) != 0) {
+    terrno = pStream->pSynch->code;
+    code = -1;
+  } else if ((pJob->decision & ~TSDB_SYNC_VERIFY) == TSDB_SYNC_DIFF) {
+    code = tsdbSyncSendDFileDiff(pStream, pDFile, verify);
+  } else {
+    code = tsdbSyncSendData(pStream, pDFile, 0, pDFile->info.size, verify);
+    if (code == 0) {
+      tsdbInfo("vgId:%d, file:%s is sent", REPO_ID(pRepo), pDFile->f.aname);
+    }
+  }
+
+  if (code < 0) {
+    tsdbError("vgId:%d, failed to send file:%s since %s", REPO_ID(pRepo), pDFile->f.aname, tstrerror(terrno));
+  }
+
+  tsdbCloseDFile(pDFile);
+  return code;
+}
+
+static int32_t tsdbSyncRecvFile(SSyncStream *pStream, SSyncJob *pJob) {
+  STsdbRepo *pRepo = pStream->pSynch->pRepo;
+  SDFile *   pDFile = &pJob->df;
+  bool       verify = (pJob->decision & TSDB_SYNC_VERIFY) != 0;
+  int32_t    code = 0;
+
+  if (atomic_load_32(&pStream->pSynch->code) != 0) {
+    terrno = pStream->pSynch->code;
+    code = -1;
+  } else if ((pJob->decision & ~TSDB_SYNC_VERIFY) == TSDB_SYNC_DIFF) {
+    code = tsdbSyncRecvDFileDiff(pStream, &pJob->ldf, pDFile, &pJob->rdf, verify);
+  } else {
+    code = tsdbSyncRecvData(pStream, pDFile, pJob->rdf.info.size, verify);
+    if (code == 0) {
+      tsdbInfo("vgId:%d, file:%s is received, size:%" PRId64, REPO_ID(pRepo), pDFile->f.aname,
+               pJob->rdf.info.size);
+    }
+  }
+
+  tsdbCloseDFile(pDFile);
+  if (code < 0) {
+    tsdbError("vgId:%d, failed to recv file:%s since %s", REPO_ID(pRepo), pDFile->f.aname, tstrerror(terrno));
+    (void)tsdbRemoveDFile(pDFile);
+  }
+
+  return code;
+}
+
+#define TSDB_SYNC_CHUNK_CHANGED(bitmap, i) (((bitmap)[(i) / 8] & (1 << ((i) % 8))) != 0)
+
+static void tsdbSyncChunkDigest(void *chunk, int64_t len, uint8_t *digest) {
+  MD5_CTX ctx;
+  MD5Init(&ctx);
+  MD5Update(&ctx, chunk, (unsigned int)len);
+  MD5Final(&ctx);
+  memcpy(digest, ctx.digest, TSDB_SYNC_DIGEST_SIZE);
+}
+
+static int tsdbSyncReadChunk(SDFile *pDFile, int64_t size, int64_t i, void *chunk) {
+  int64_t len = TSDB_SYNC_CHUNK_LEN(size, i);
+
+  if (tsdbSeekDFile(pDFile, i * TSDB_SYNC_CHUNK_SIZE, SEEK_SET) < 0) return -1;
+
+  int64_t nread = tsdbReadDFile(pDFile, chunk, len);
+  if (nread < 0) return -1;
+
+  if (nread < len) {
+    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+    return -1;
+  }
+
+  return 0;
+}
+
+static int32_t tsdbSyncSendDFileDiff(SSyncStream *pStream, SDFile *pDFile, bool verify) {
+  STsdbRepo *pRepo = pStream->pSynch->pRepo;
+  int64_t    size = pDFile->info.size;
+  int64_t    nChunks = TSDB_SYNC_CHUNKS(size);
+  int64_t    bitmapLen = (nChunks + 7) / 8;
+  uint64_t   lsize = 0;
+  uint32_t   nLChunks = 0;
+  char       head[sizeof(uint64_t) + sizeof(uint32_t)];
+
+  // Recv the size and chunk digests of the file on remote
+  int32_t readLen = sizeof(head);
+  int32_t ret = taosReadMsg(pStream->socketFd, head, readLen);
+  if (ret != readLen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbError("vgId:%d, failed to recv chunk info, ret:%d readLen:%d", REPO_ID(pRepo), ret, readLen);
+    return -1;
+  }
+
+  void *ptr = taosDecodeFixedU64(head, &lsize);
+  taosDecodeFixedU32(ptr, &nLChunks);
+  if (nLChunks > nChunks) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    tsdbError("vgId:%d, file:%s, remote has %u chunks more than %" PRId64, REPO_ID(pRepo), pDFile->f.aname, nLChunks,
+              nChunks);
+    return -1;
+  }
+
+  int64_t digestLen = (int64_t)nLChunks * TSDB_SYNC_DIGEST_SIZE;
+  if (tsdbMakeRoom((void **)(&pStream->pBuf), digestLen + bitmapLen + TSDB_SYNC_CHUNK_SIZE) < 0) {
+    tsdbError("vgId:%d, failed to makeroom while send file chunks since %s", REPO_ID(pRepo), tstrerror(terrno));
+    return -1;
+  }
+
+  uint8_t *digests = pStream->pBuf;
+  uint8_t *bitmap = digests + digestLen;
+  uint8_t *chunk = bitmap + bitmapLen;
+
+  if (digestLen > 0) {
+    ret = taosReadMsg(pStream->socketFd, digests, (int32_t)digestLen);
+    if (ret != digestLen) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      tsdbError("vgId:%d, failed to recv chunk digests, ret:%d readLen:%" PRId64, REPO_ID(pRepo), ret, digestLen);
+      return -1;
+    }
+  }
+
+  // A chunk is reused by remote if it has the same length and digest there
+  int64_t nChanged = 0;
+  memset(bitmap, 0, bitmapLen);
+  for (int64_t i = 0; i < nChunks; i++) {
+    if (i < nLChunks && TSDB_SYNC_CHUNK_LEN((int64_t)lsize, i) == TSDB_SYNC_CHUNK_LEN(size, i)) {
+      uint8_t digest[TSDB_SYNC_DIGEST_SIZE];
+      if (tsdbSyncReadChunk(pDFile, size, i, chunk) < 0) return -1;
+      tsdbSyncChunkDigest(chunk, TSDB_SYNC_CHUNK_LEN(size, i), digest);
+      if (memcmp(digest, digests + i * TSDB_SYNC_DIGEST_SIZE, TSDB_SYNC_DIGEST_SIZE) == 0) continue;
+    }
+
+    bitmap[i / 8] |= (uint8_t)(1 << (i % 8));
+    nChanged++;
+  }
+
+  if (bitmapLen > 0) {
+    ret = taosWriteMsg(pStream->socketFd, bitmap, (int32_t)bitmapLen);
+    if (ret != bitmapLen) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      tsdbError("vgId:%d, failed to send chunk bitmap, ret:%d writeLen:%" PRId64, REPO_ID(pRepo), ret, bitmapLen);
+      return -1;
+    }
+  }
+
+  // Send the changed chunks, adjacent ones in one go
+  for (int64_t i = 0; i < nChunks;) {
+    if (!TSDB_SYNC_CHUNK_CHANGED(bitmap, i)) {
+      i++;
+      continue;
+    }
+
+    int64_t j = i + 1;
+    while (j < nChunks && TSDB_SYNC_CHUNK_CHANGED(bitmap, j)) j++;
+
+    int64_t offset = i * TSDB_SYNC_CHUNK_SIZE;
+    int64_t writeLen = MIN(j * TSDB_SYNC_CHUNK_SIZE, size) - offset;
+    if (tsdbSyncSendData(pStream, pDFile, offset, writeLen, verify) < 0) {
+      tsdbError("vgId:%d, failed to send file:%s chunks since %s, writeLen:%" PRId64, REPO_ID(pRepo), pDFile->f.aname,
+                tstrerror(terrno), writeLen);
+      return -1;
+    }
+
+    i = j;
+  }
+
+  tsdbInfo("vgId:%d, file:%s is sent, %" PRId64 " of %" PRId64 " chunks changed", REPO_ID(pRepo), pDFile->f.aname,
+           nChanged, nChunks);
+  return 0;
+}
+
+static int32_t tsdbSyncRecvDFileDiff(SSyncStream *pStream, SDFile *pLDFile, SDFile *pDFile, SDFile *pRDFile,
+                                     bool verify) {
+  STsdbRepo *pRepo = pStream->pSynch->pRepo;
+  SDFile     ldf = *pLDFile;
+  int64_t    size = pRDFile->info.size;
+  int64_t    nChunks = TSDB_SYNC_CHUNKS(size);
+  int64_t    bitmapLen = (nChunks + 7) / 8;
+  int64_t    lsize = 0;
+  int64_t    nLChunks = 0;
+  int64_t    nChanged = 0;
+
+  TSDB_FILE_SET_CLOSED(&ldf);
+  if (strcmp(TSDB_FILE_FULL_NAME(&ldf), TSDB_FILE_FULL_NAME(pDFile)) == 0) {
+    tsdbWarn("vgId:%d, file:%s is overwritten, receive it wholly", REPO_ID(pRepo), ldf.f.aname);
+  } else if (tsdbOpenDFile(&ldf, O_RDONLY) < 0) {
+    tsdbWarn("vgId:%d, failed to open file:%s since %s, receive it wholly", REPO_ID(pRepo), ldf.f.aname,
+             tstrerror(terrno));
+  } else {
+    lsize = ldf.info.size;
+    nLChunks = MIN(TSDB_SYNC_CHUNKS(lsize), nChunks);
+  }
+
+  int64_t headLen = sizeof(uint64_t) + sizeof(uint32_t) + nLChunks * TSDB_SYNC_DIGEST_SIZE;
+  if (tsdbMakeRoom((void **)(&pStream->pBuf), headLen + bitmapLen + TSDB_SYNC_CHUNK_SIZE) < 0) {
+    tsdbError("vgId:%d, failed to makeroom while recv file chunks since %s", REPO_ID(pRepo), tstrerror(terrno));
+    goto _err;
+  }
+
+  uint8_t *bitmap = POINTER_SHIFT(pStream->pBuf, headLen);
+  uint8_t *chunk = bitmap + bitmapLen;
+
+  // Send the size and chunk digests of the local file
+  void *ptr = pStream->pBuf;
+  taosEncodeFixedU64(&ptr, (uint64_t)lsize);
+  taosEncodeFixedU32(&ptr, (uint32_t)nLChunks);
+  for (int64_t i = 0; i < nLChunks; i++) {
+    if (tsdbSyncReadChunk(&ldf, lsize, i, chunk) < 0) goto _err;
+    tsdbSyncChunkDigest(chunk, TSDB_SYNC_CHUNK_LEN(lsize, i), ptr);
+    ptr = POINTER_SHIFT(ptr, TSDB_SYNC_DIGEST_SIZE);
+  }
+
+  int32_t ret = taosWriteMsg(pStream->socketFd, pStream->pBuf, (int32_t)headLen);
+  if (ret != headLen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbError("vgId:%d, failed to send chunk digests, ret:%d writeLen:%" PRId64, REPO_ID(pRepo), ret, headLen);
+    goto _err;
+  }
+
+  if (bitmapLen > 0) {
+    ret = taosReadMsg(pStream->socketFd, bitmap, (int32_t)bitmapLen);
+    if (ret != bitmapLen) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      tsdbError("vgId:%d, failed to recv chunk bitmap, ret:%d readLen:%" PRId64, REPO_ID(pRepo), ret, bitmapLen);
+      goto _err;
+    }
+  }
+
+  // Rebuild the file from changed chunks received and unchanged ones in the local file
+  for (int64_t i = 0; i < nChunks;) {
+    if (TSDB_SYNC_CHUNK_CHANGED(bitmap, i)) {
+      int64_t j = i + 1;
+      while (j < nChunks && TSDB_SYNC_CHUNK_CHANGED(bitmap, j)) j++;
+
+      int64_t readLen = MIN(j * TSDB_SYNC_CHUNK_SIZE, size) - i * TSDB_SYNC_CHUNK_SIZE;
+      if (tsdbSyncRecvData(pStream, pDFile, readLen, verify) < 0) {
+        tsdbError("vgId:%d, failed to recv file:%s chunks since %s, readLen:%" PRId64, REPO_ID(pRepo),
+                  pDFile->f.aname, tstrerror(terrno), readLen);
+        goto _err;
+      }
+
+      nChanged += j - i;
+      i = j;
+    } else {
+      if (i >= nLChunks) {
+        terrno = TSDB_CODE_TDB_MESSED_MSG;
+        tsdbError("vgId:%d, file:%s, chunk:%" PRId64 " not exists but not sent", REPO_ID(pRepo), pDFile->f.aname, i);
+        goto _err;
+      }
+
+      if (tsdbSyncReadChunk(&ldf, lsize, i, chunk) < 0) goto _err;
+      if (tsdbWriteDFile(pDFile, chunk, TSDB_SYNC_CHUNK_LEN(size, i)) < 0) goto _err;
+      i++;
+    }
+  }
+
+  tsdbCloseDFile(&ldf);
+  tsdbInfo("vgId:%d, file:%s is received, %" PRId64 " of %" PRId64 " chunks changed", REPO_ID(pRepo), pDFile->f.aname,
+           nChanged, nChunks);
+  return 0;
+
+_err:
+  tsdbCloseDFile(&ldf);
+  return -1;
+}
+
+// Throttle the files sent by all streams to syncBandwidth if it is set
+static void tsdbSyncThrottle(SSyncH *pSynch, int64_t bytes) {
+  if (tsSyncBandwidth <= 0) return;
+
+  int64_t sentBytes = atomic_add_fetch_64(&pSynch->sentBytes, bytes);
+  int64_t expectMs = sentBytes * 1000 / ((int64_t)tsSyncBandwidth * 1024 * 1024);
+  int64_t elapsedMs = taosGetTimestampMs() - pSynch->startTime;
+  if (expectMs > elapsedMs) taosMsleep((int32_t)(expectMs - elapsedMs));
+}
+
+// Send a range of a file to remote. If verify is set, the content is read and sent in pieces, each followed by its
+// checksum, so that the file corrupted in transfer is found by remote.
+static int32_t tsdbSyncSendData(SSyncStream *pStream, SDFile *pDFile, int64_t offset, int64_t len, bool verify) {
+  int64_t nsent = 0;
+
+  if (!verify) {
+    while (nsent < len) {
+      int64_t pos = offset + nsent;
+      int64_t toSend = MIN(TSDB_SYNC_SEND_SIZE, len - nsent);
+      int64_t ret = taosSendFile(pStream->socketFd, TSDB_FILE_FD(pDFile), &pos, toSend);
+      if (ret != toSend) {
+        terrno = TAOS_SYSTEM_ERROR(errno);
+        return -1;
+      }
+
+      nsent += ret;
+      tsdbSyncThrottle(pStream->pSynch, ret);
+    }
+
+    return 0;
+  }
+
+  if (tsdbMakeRoom(&pStream->pData, TSDB_SYNC_CHUNK_SIZE + sizeof(TSCKSUM)) < 0) return -1;
+  if (tsdbSeekDFile(pDFile, offset, SEEK_SET) < 0) return -1;
+
+  while (nsent < len) {
+    int64_t toSend = MIN(TSDB_SYNC_CHUNK_SIZE, len - nsent);
+    int64_t nread = tsdbReadDFile(pDFile, pStream->pData, toSend);
+    if (nread < 0) return -1;
+    if (nread < toSend) {
+      terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+      return -1;
+    }
+
+    taosCalcChecksumAppend(0, pStream->pData, (uint32_t)(toSend + sizeof(TSCKSUM)));
+
+    int32_t writeLen = (int32_t)(toSend + sizeof(TSCKSUM));
+    if (taosWriteMsg(pStream->socketFd, pStream->pData, writeLen) != writeLen) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
+
+    nsent += toSend;
+    tsdbSyncThrottle(pStream->pSynch, toSend);
+  }
+
+  return 0;
+}
+
+static int32_t tsdbSyncRecvData(SSyncStream *pStream, SDFile *pDFile, int64_t len, bool verify) {
+  int64_t nrecv = 0;
+
+  if (!verify) {
+    if (taosCopyFds(pStream->socketFd, TSDB_FILE_FD(pDFile), len) != len) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
+
+    return 0;
+  }
+
+  if (tsdbMakeRoom(&pStream->pData, TSDB_SYNC_CHUNK_SIZE + sizeof(TSCKSUM)) < 0) return -1;
+
+  while (nrecv < len) {
+    int64_t toRecv = MIN(TSDB_SYNC_CHUNK_SIZE, len - nrecv);
+    int32_t readLen = (int32_t)(toRecv + sizeof(TSCKSUM));
+    if (taosReadMsg(pStream->socketFd, pStream->pData, readLen) != readLen) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
+
+    if (!taosCheckChecksumWhole(pStream->pData, readLen)) {
+      terrno = TSDB_CODE_TDB_MESSED_MSG;
+      tsdbError("vgId:%d, file:%s, content at offset %" PRId64 " is corrupted in transfer",
+                REPO_ID(pStream->pSynch->pRepo), pDFile->f.aname, nrecv);
+      return -1;
+    }
+
+    if (tsdbWriteDFile(pDFile, pStream->pData, toRecv) < 0) return -1;
+    nrecv += toRecv;
+  }
 
   return 0;
 }
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tsdbint.h"
+
+#define TAG_INDEX_INIT_TIDS 4
+#define TAG_INDEX_WORDS(tid) ((tid) / 64 + 1)
+#define TAG_INDEX_SET_BIT(w, tid) ((w)[(tid) / 64] |= ((uint64_t)1) << ((tid) % 64))
+#define TAG_INDEX_CLR_BIT(w, tid) ((w)[(tid) / 64] &= ~(((uint64_t)1) << ((tid) % 64)))
+#define TAG_INDEX_GET_BIT(w, tid) (((w)[(tid) / 64] >> ((tid) % 64)) & 1)
+
+typedef struct {
+  int32_t   nTids;  // number of child tables in the set
+  int32_t   cap;    // capacity of tids, or number of words of the bitmap
+  int32_t * tids;   // unsorted tids while the set is small
+  uint64_t *words;  // bitmap indexed by tid once the set is converted
+  int32_t   len;    // length of val, 0 for the set of tables without the tag
+  char      val[];  // tag value, including the var header for binary and nchar
+} STagPosting;
+
+typedef struct {
+  int16_t      colId;
+  int8_t       type;
+  SHashObj *   values;   // tag value -> STagPosting *
+  STagPosting *missing;  // tables without a value of the column
+} STagColIndex;
+
+struct STagIndex {
+  int32_t      nWords;  // number of words to hold the largest tid
+  int32_t      nCols;
+  uint64_t *   all;     // all child tables in the index
+  STagColIndex cols[];
+};
+
+static STagPosting *tsdbNewTagPosting(const char *val, int32_t len) {
+  STagPosting *pPosting = calloc(1, sizeof(STagPosting) + len);
+  if (pPosting == NULL) return NULL;
+
+  pPosting->len = len;
+  if (len > 0) memcpy(pPosting->val, val, len);
+  return pPosting;
+}
+
+static void tsdbFreeTagPosting(STagPosting *pPosting) {
+  if (pPosting == NULL) return;
+  tfree(pPosting->tids);
+  tfree(pPosting->words);
+  free(pPosting);
+}
+
+static int tsdbTagPostingEnsureWords(STagPosting *pPosting, int32_t nWords) {
+  if (pPosting->cap >= nWords) return 0;
+
+  uint64_t *words = realloc(pPosting->words, sizeof(uint64_t) * nWords);
+  if (words == NULL) return -1;
+
+  memset(words + pPosting->cap, 0, sizeof(uint64_t) * (nWords - pPosting->cap));
+  pPosting->words = words;
+  pPosting->cap = nWords;
+  return 0;
+}
+
+static int tsdbTagPostingToBitmap(STagPosting *pPosting, int32_t nWords) {
+  uint64_t *words = calloc(nWords, sizeof(uint64_t));
+  if (words == NULL) return -1;
+
+  for (int32_t i = 0; i < pPosting->nTids; i++) {
+    TAG_INDEX_SET_BIT(words, pPosting->tids[i]);
+  }
+
+  tfree(pPosting->tids);
+  pPosting->words = words;
+  pPosting->cap = nWords;
+  return 0;
+}
+
+static int tsdbTagPostingAdd(STagPosting *pPosting, int32_t tid, int32_t nWords) {
+  if (pPosting->words != NULL) {
+    if (tsdbTagPostingEnsureWords(pPosting, TAG_INDEX_WORDS(tid)) < 0) return -1;
+    if (!TAG_INDEX_GET_BIT(pPosting->words, tid)) {
+      TAG_INDEX_SET_BIT(pPosting->words, tid);
+      pPosting->nTids++;
+    }
+    return 0;
+  }
+
+  if (pPosting->nTids >= pPosting->cap) {
+    int32_t cap = (pPosting->cap == 0) ? TAG_INDEX_INIT_TIDS : pPosting->cap * 2;
+
+    // the tid array would take more space than a bitmap over all tids
+    if (sizeof(int32_t) * cap > sizeof(uint64_t) * nWords) {
+      if (tsdbTagPostingToBitmap(pPosting, nWords) < 0) return -1;
+      return tsdbTagPostingAdd(pPosting, tid, nWords);
+    }
+
+    int32_t *tids = realloc(pPosting->tids, sizeof(int32_t) * cap);
+    if (tids == NULL) return -1;
+    pPosting->tids = tids;
+    pPosting->cap = cap;
+  }
+
+  pPosting->tids[pPosting->nTids++] = tid;
+  return 0;
+}
+
+static void tsdbTagPostingRemove(STagPosting *pPosting, int32_t tid) {
+  if (pPosting->words != NULL) {
+    if (tid < pPosting->cap * 64 && TAG_INDEX_GET_BIT(pPosting->words, tid)) {
+      TAG_INDEX_CLR_BIT(pPosting->words, tid);
+      pPosting->nTids--;
+    }
+    return;
+  }
+
+  for (int32_t i = 0; i < pPosting->nTids; i++) {
+    if (pPosting->tids[i] == tid) {
+      pPosting->tids[i] = pPosting->tids[--pPosting->nTids];
+      return;
+    }
+  }
+}
+
+static void tsdbTagPostingMerge(STagPosting *pPosting, uint64_t *words) {
+  if (pPosting->words != NULL) {
+    for (int32_t i = 0; i < pPosting->cap; i++) {
+      words[i] |= pPosting->words[i];
+    }
+  } else {
+    for (int32_t i = 0; i < pPosting->nTids; i++) {
+      TAG_INDEX_SET_BIT(words, pPosting->tids[i]);
+    }
+  }
+}
+
+static int32_t tsdbTagValLen(int8_t type, const char *val) {
+  return IS_VAR_DATA_TYPE(type) ? varDataTLen(val) : TYPE_BYTES[type];
+}
+
+static STagColIndex *tsdbGetTagColIndex(STagIndex *pIndex, int16_t colId) {
+  for (int32_t i = 0; i < pIndex->nCols; i++) {
+    if (pIndex->cols[i].colId == colId) return pIndex->cols + i;
+  }
+  return NULL;
+}
+
+STagIndex *tsdbNewTagIndex(STSchema *pTagSchema) {
+  int        nCols = schemaNCols(pTagSchema);
+  STagIndex *pIndex = calloc(1, sizeof(STagIndex) + sizeof(STagColIndex) * nCols);
+  if (pIndex == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pIndex->nCols = nCols;
+  for (int i = 0; i < nCols; i++) {
+    STColumn *    pCol = schemaColAt(pTagSchema, i);
+    STagColIndex *pColIndex = pIndex->cols + i;
+
+    pColIndex->colId = colColId(pCol);
+    pColIndex->type = colType(pCol);
+    pColIndex->values = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_NO_LOCK);
+    if (pColIndex->values == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      tsdbFreeTagIndex(pIndex);
+      return NULL;
+    }
+  }
+
+  return pIndex;
+}
+
+void tsdbFreeTagIndex(STagIndex *pIndex) {
+  if (pIndex == NULL) return;
+
+  for (int32_t i = 0; i < pIndex->nCols; i++) {
+    STagColIndex *pColIndex = pIndex->cols + i;
+    if (pColIndex->values != NULL) {
+      STagPosting **ppPosting = taosHashIterate(pColIndex->values, NULL);
+      while (ppPosting != NULL) {
+        tsdbFreeTagPosting(*ppPosting);
+        ppPosting = taosHashIterate(pColIndex->values, ppPosting);
+      }
+      taosHashCleanup(pColIndex->values);
+    }
+    tsdbFreeTagPosting(pColIndex->missing);
+  }
+
+  tfree(pIndex->all);
+  free(pIndex);
+}
+
+static int tsdbTagColIndexAdd(STagIndex *pIndex, STagColIndex *pColIndex, const char *val, int32_t tid) {
+  STagPosting *pPosting = NULL;
+
+  if (val == NULL) {
+    if (pColIndex->missing == NULL && (pColIndex->missing = tsdbNewTagPosting(NULL, 0)) == NULL) return -1;
+    pPosting = pColIndex->missing;
+  } else {
+    int32_t       len = tsdbTagValLen(pColIndex->type, val);
+    STagPosting **ppPosting = taosHashGet(pColIndex->values, val, len);
+    if (ppPosting != NULL) {
+      pPosting = *ppPosting;
+    } else {
+      if ((pPosting = tsdbNewTagPosting(val, len)) == NULL) return -1;
+      if (taosHashPut(pColIndex->values, val, len, &pPosting, sizeof(pPosting)) < 0) {
+        tsdbFreeTagPosting(pPosting);
+        return -1;
+      }
+    }
+  }
+
+  return tsdbTagPostingAdd(pPosting, tid, pIndex->nWords);
+}
+
+static void tsdbTagColIndexRemove(STagColIndex *pColIndex, const char *val, int32_t tid) {
+  if (val == NULL) {
+    if (pColIndex->missing != NULL) tsdbTagPostingRemove(pColIndex->missing, tid);
+    return;
+  }
+
+  int32_t       len = tsdbTagValLen(pColIndex->type, val);
+  STagPosting **ppPosting = taosHashGet(pColIndex->values, val, len);
+  if (ppPosting == NULL) return;
+
+  STagPosting *pPosting = *ppPosting;
+  tsdbTagPostingRemove(pPosting, tid);
+  if (pPosting->nTids == 0) {
+    taosHashRemove(pColIndex->values, val, len);
+    tsdbFreeTagPosting(pPosting);
+  }
+}
+
+int tsdbTagIndexAddTable(STagIndex *pIndex, STable *pTable) {
+  int32_t tid = TABLE_TID(pTable);
+
+  if (TAG_INDEX_WORDS(tid) > pIndex->nWords) {
+    int32_t   nWords = TAG_INDEX_WORDS(tid);
+    uint64_t *all = realloc(pIndex->all, sizeof(uint64_t) * nWords);
+    if (all == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+    memset(all + pIndex->nWords, 0, sizeof(uint64_t) * (nWords - pIndex->nWords));
+    pIndex->all = all;
+    pIndex->nWords = nWords;
+  }
+
+  for (int32_t i = 0; i < pIndex->nCols; i++) {
+    STagColIndex *pColIndex = pIndex->cols + i;
+    if (tsdbTagColIndexAdd(pIndex, pColIndex, tdGetKVRowValOfCol(pTable->tagVal, pColIndex->colId), tid) < 0) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+  }
+
+  TAG_INDEX_SET_BIT(pIndex->all, tid);
+  return 0;
+}
+
+void tsdbTagIndexRemoveTable(STagIndex *pIndex, STable *pTable) {
+  int32_t tid = TABLE_TID(pTable);
+
+  for (int32_t i = 0; i < pIndex->nCols; i++) {
+    STagColIndex *pColIndex = pIndex->cols + i;
+    tsdbTagColIndexRemove(pColIndex, tdGetKVRowValOfCol(pTable->tagVal, pColIndex->colId), tid);
+  }
+
+  if (tid < pIndex->nWords * 64) TAG_INDEX_CLR_BIT(pIndex->all, tid);
+}
+
+int32_t tsdbTagIndexWords(STagIndex *pIndex) { return pIndex->nWords; }
+
+void tsdbTagIndexGetAll(STagIndex *pIndex, uint64_t *words) {
+  if (pIndex->nWords > 0) memcpy(words, pIndex->all, sizeof(uint64_t) * pIndex->nWords);
+}
+
+// Each distinct value of the column is checked only once, the sets of the qualified values are merged into words,
+// which must hold tsdbTagIndexWords(pIndex) words. Return -1 if the column is not indexed.
+int tsdbQueryTagIndex(STagIndex *pIndex, int16_t colId, __tag_val_filter_fn_t fp, void *param, uint64_t *words) {
+  STagColIndex *pColIndex = tsdbGetTagColIndex(pIndex, colId);
+  if (pColIndex == NULL) return -1;
+
+  STagPosting **ppPosting = taosHashIterate(pColIndex->values, NULL);
+  while (ppPosting != NULL) {
+    STagPosting *pPosting = *ppPosting;
+    if (fp(pPosting->val, param)) {
+      tsdbTagPostingMerge(pPosting, words);
+    }
+    ppPosting = taosHashIterate(pColIndex->values, ppPosting);
+  }
+
+  if (pColIndex->missing != NULL && pColIndex->missing->nTids > 0 && fp(NULL, param)) {
+    tsdbTagPostingMerge(pColIndex->missing, words);
+  }
+
+  return 0;
+}
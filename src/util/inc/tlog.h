@@ -49,6 +49,19 @@ void    taosPrintLongString(const char * flags, int32_t dflag, const char *forma
 
 void    taosDumpData(unsigned char *msg, int32_t len);
 
+// formats of lines deferred to the async log thread, the arguments are recorded and rendered later
+typedef struct {
+  char    spec[32];  // conversion spec to pass to snprintf, length modifier normalized
+  int32_t stars;
+  int32_t precision;
+  char    lenMod;    // 0, 'H' for hh, 'h', 'l', 'q' for ll/q, 'L', 'j', 'z', 't'
+  char    conv;
+} SLogSpec;
+
+const char *taosParseLogSpec(const char *p, SLogSpec *pSpec);
+int32_t     taosEncodeLogArgs(char *buf, int32_t cap, const char *format, va_list ap);
+int32_t     taosRenderLogArgs(char *out, int32_t cap, const char *format, const char *args);
+
 #ifdef __cplusplus
 }
 #endif
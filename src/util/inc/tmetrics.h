@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TMETRICS_H
+#define TDENGINE_TMETRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+/*
+ * Process wide registry of counters, gauges and latency histograms.
+ *
+ * Counters and histograms are sharded per thread: a thread claims a shard on its first update and
+ * afterwards only writes its own cache lines, so the hot paths never share a lock or an atomic.
+ * Readers sum the shards on demand. Gauges are plain atomics, they are set rarely.
+ */
+
+typedef enum {
+  TSDB_METRIC_RPC_MSGS_IN,
+  TSDB_METRIC_RPC_BYTES_IN,
+  TSDB_METRIC_RPC_MSGS_OUT,
+  TSDB_METRIC_RPC_BYTES_OUT,
+  TSDB_METRIC_WAL_WRITES,
+  TSDB_METRIC_WAL_BYTES,
+  TSDB_METRIC_TSDB_COMMITS,
+  TSDB_METRIC_VNODE_WRITES,
+  TSDB_METRIC_VNODE_QUERIES,
+  TSDB_METRIC_VNODE_FETCHES,
+  TSDB_METRIC_CACHE_HITS,
+  TSDB_METRIC_CACHE_MISSES,
+  TSDB_METRIC_COUNTER_MAX
+} EMetricsCounter;
+
+typedef enum {
+  TSDB_METRIC_VNODES,
+  TSDB_METRIC_GAUGE_MAX
+} EMetricsGauge;
+
+typedef enum {
+  TSDB_METRIC_WAL_FSYNC_US,
+  TSDB_METRIC_TSDB_COMMIT_US,
+  TSDB_METRIC_VNODE_WRITE_US,
+  TSDB_METRIC_QUERY_EXEC_US,
+  TSDB_METRIC_HISTOGRAM_MAX
+} EMetricsHistogram;
+
+// bucket i holds the observations in [2^(i-1), 2^i) microseconds, bucket 0 holds 0
+#define TSDB_METRIC_HISTOGRAM_BUCKETS 32
+
+typedef struct {
+  int64_t count;
+  int64_t sum;
+  int64_t max;
+  int64_t p50;
+  int64_t p90;
+  int64_t p99;
+} SMetricsHistogram;
+
+const char *taosMetricsCounterName(int32_t id);
+const char *taosMetricsGaugeName(int32_t id);
+const char *taosMetricsHistogramName(int32_t id);
+
+void taosMetricsInc(int32_t id, int64_t val);
+void taosMetricsSetGauge(int32_t id, int64_t val);
+void taosMetricsAddGauge(int32_t id, int64_t val);
+void taosMetricsObserve(int32_t id, int64_t us);
+
+int64_t taosMetricsGetCounter(int32_t id);
+int64_t taosMetricsGetGauge(int32_t id);
+void    taosMetricsGetHistogram(int32_t id, SMetricsHistogram *pHist);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TMETRICS_H
@@ -21,6 +21,7 @@
 #include "tcache.h"
 #include "hash.h"
 #include "hashfunc.h"
+#include "tmetrics.h"
 
 static FORCE_INLINE void __cache_wr_lock(SCacheObj *pCacheObj) {
 #if defined(LINUX)
@@ -301,6 +302,7 @@ void *taosCacheAcquireByKey(SCacheObj *pCacheObj, const void *key, size_t keyLen
 
   if (taosHashGetSize(pCacheObj->pHashTable) == 0) {
     atomic_add_fetch_32(&pCacheObj->statistics.missCount, 1);
+    taosMetricsInc(TSDB_METRIC_CACHE_MISSES, 1);
     return NULL;
   }
 
@@ -311,9 +313,11 @@ void *taosCacheAcquireByKey(SCacheObj *pCacheObj, const void *key, size_t keyLen
 
   if (pData != NULL) {
     atomic_add_fetch_32(&pCacheObj->statistics.hitCount, 1);
+    taosMetricsInc(TSDB_METRIC_CACHE_HITS, 1);
     uDebug("cache:%s, key:%p, %p is retrieved from cache, refcnt:%d", pCacheObj->name, key, pData, T_REF_VAL_GET(ptNode));
   } else {
     atomic_add_fetch_32(&pCacheObj->statistics.missCount, 1);
+    taosMetricsInc(TSDB_METRIC_CACHE_MISSES, 1);
     uDebug("cache:%s, key:%p, not in cache, retrieved failed", pCacheObj->name, key);
   }
 
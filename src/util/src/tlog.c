@@ -42,6 +42,29 @@
 #define LOG_BUF_SIZE(x)   ((x)->buffSize)
 #define LOG_BUF_MUTEX(x)  ((x)->buffMutex)
 
+#define LOG_RING_SIZE      (128 * 1024)  // must be a power of 2
+#define LOG_RING_MAX_REC   (LOG_RING_SIZE / 4)
+#define LOG_RING_FREE      0
+#define LOG_RING_ACTIVE    1
+#define LOG_RING_EXITED    2
+#define LOG_RING_DETACHED  ((SLogRing *)1)
+#define LOG_OUT_BUF_SIZE   (256 * 1024)
+#define LOG_REC_HEAD_SIZE  8
+#define LOG_REC_TEXT       0
+#define LOG_REC_DEFERRED   1
+#define LOG_REC_SKIP       2
+#define LOG_MAX_DEFER_ARGS 16
+#define LOG_ARG_INT        0
+#define LOG_ARG_UINT       1
+#define LOG_ARG_DOUBLE     2
+#define LOG_ARG_PTR        3
+#define LOG_ARG_STR        4
+#define LOG_DEFER_REC_SIZE (MAX_LOGLINE_BUFFER_SIZE * 2)
+#define LOG_MAX_FLAGS_LEN  50
+#define LOG_HEAD_DATE_LEN  15
+#define LOG_SPEC_MAX_LEN   24
+#define LOG_PRECISION_ARG  (-2)
+
 typedef struct {
   char *          buffer;
   int32_t         buffStart;
@@ -55,6 +78,41 @@ typedef struct {
   tsem_t          buffNotEmpty;
 } SLogBuff;
 
+/*
+ * Each thread that logs to file in async mode owns one ring, it is the only producer and the async log
+ * thread the only consumer, so pushing a line takes no lock. Records never wrap, a skip record fills the
+ * tail of the ring instead. A thread whose ring is full waits for it to be drained, so its lines keep their order.
+ */
+typedef struct SLogRing {
+  struct SLogRing *next;
+  char *           buffer;
+  int32_t          state;
+  int64_t          head;  // bytes pushed, written by the owner thread only
+  int64_t          tail;  // bytes consumed, written by the async log thread only
+} SLogRing;
+
+typedef struct {
+  int32_t len;   // length of the payload following the record head
+  int32_t kind;
+} SLogRecHead;
+
+// payload of a LOG_REC_DEFERRED record, followed by flags, format with its '\0' and the arguments
+typedef struct {
+  int64_t sec;
+  int64_t tid;
+  int32_t usec;
+  int16_t flagsLen;
+  int16_t formatLen;
+} SLogDeferHead;
+
+typedef struct {
+  int64_t sec;
+  int64_t tid;
+  int32_t tidLen;
+  char    date[32];  // "MM/DD HH:MM:SS."
+  char    tidStr[24];
+} SLogHeadCache;
+
 typedef struct {
   int32_t fileNum;
   int32_t maxLines;
@@ -69,6 +127,7 @@ typedef struct {
 
 int32_t tsLogKeepDays = 0;
 int8_t  tsAsyncLog = 1;
+int8_t  tsDeferLogFormat = 0;
 float   tsTotalLogDirGB = 0;
 float   tsAvailLogDirGB = 0;
 float   tsMinimalLogDirGB = 1.0f;
@@ -90,6 +149,11 @@ char    tsLogDir[PATH_MAX] = "/var/log/taos";
 #endif
 
 static SLogObj   tsLogObj = { .fileNum = 1 };
+static SLogRing *tsLogRings = NULL;
+static pthread_once_t tsLogRingOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t  tsLogRingKey;
+static threadlocal SLogRing *     tsLogRing = NULL;
+static threadlocal SLogHeadCache tsLogHeadCache = { .sec = -1, .tid = -1 };
 static void *    taosAsyncOutputLog(void *param);
 static int32_t   taosPushLogBuffer(SLogBuff *tLogBuff, char *msg, int32_t msgLen);
 static SLogBuff *taosLogBuffNew(int32_t bufSize);
@@ -363,6 +427,440 @@ static int32_t taosOpenLogFile(char *fn, int32_t maxLines, int32_t maxFileNum) {
   return 0;
 }
 
+static void taosCountLogLines(int32_t lines) {
+  if (tsLogObj.maxLines > 0) {
+    atomic_add_fetch_32(&tsLogObj.lines, lines);
+
+    if ((tsLogObj.lines > tsLogObj.maxLines) && (tsLogObj.openInProgress == 0)) taosOpenNewLogFile();
+  }
+}
+
+// the date part is formatted once per second and the thread id once per thread, only usec changes per line
+static int32_t taosBuildLogHead(SLogHeadCache *pCache, char *buffer, int64_t sec, int32_t usec, int64_t tid,
+                                const char *flags, int32_t flagsLen) {
+  if (pCache->sec != sec) {
+    struct tm Tm;
+    time_t    curTime = (time_t)sec;
+    localtime_r(&curTime, &Tm);
+    snprintf(pCache->date, sizeof(pCache->date), "%02d/%02d %02d:%02d:%02d.", Tm.tm_mon + 1, Tm.tm_mday, Tm.tm_hour,
+             Tm.tm_min, Tm.tm_sec);
+    pCache->sec = sec;
+  }
+
+  if (pCache->tid != tid) {
+    pCache->tidLen = snprintf(pCache->tidStr, sizeof(pCache->tidStr), " %08" PRId64 " ", tid);
+    pCache->tid = tid;
+  }
+
+  memcpy(buffer, pCache->date, LOG_HEAD_DATE_LEN);
+  for (int32_t i = LOG_HEAD_DATE_LEN + 5; i >= LOG_HEAD_DATE_LEN; --i) {
+    buffer[i] = (char)('0' + usec % 10);
+    usec /= 10;
+  }
+
+  int32_t len = LOG_HEAD_DATE_LEN + 6;
+  memcpy(buffer + len, pCache->tidStr, pCache->tidLen);
+  len += pCache->tidLen;
+  memcpy(buffer + len, flags, flagsLen);
+  return len + flagsLen;
+}
+
+static void taosReleaseLogRing(void *param) {
+  SLogRing *pRing = param;
+
+  // lines printed by destructors running after this one go to the shared buffer
+  tsLogRing = LOG_RING_DETACHED;
+  atomic_store_32(&pRing->state, LOG_RING_EXITED);
+}
+
+static void taosInitLogRingKey(void) { pthread_key_create(&tsLogRingKey, taosReleaseLogRing); }
+
+static SLogRing *taosGetLogRing() {
+  SLogRing *pRing = tsLogRing;
+  if (pRing != NULL) return (pRing == LOG_RING_DETACHED) ? NULL : pRing;
+
+  pthread_once(&tsLogRingOnce, taosInitLogRingKey);
+
+  // rings of exited threads are drained by the async log thread and then reused
+  for (pRing = atomic_load_ptr(&tsLogRings); pRing != NULL; pRing = pRing->next) {
+    if (pRing->state == LOG_RING_FREE &&
+        atomic_val_compare_exchange_32(&pRing->state, LOG_RING_FREE, LOG_RING_ACTIVE) == LOG_RING_FREE) {
+      break;
+    }
+  }
+
+  if (pRing == NULL) {
+    pRing = calloc(1, sizeof(SLogRing));
+    if (pRing != NULL) pRing->buffer = malloc(LOG_RING_SIZE);
+    if (pRing == NULL || pRing->buffer == NULL) {
+      tfree(pRing);
+      tsLogRing = LOG_RING_DETACHED;
+      return NULL;
+    }
+
+    pRing->state = LOG_RING_ACTIVE;
+    SLogRing *pNext = NULL;
+    do {
+      pNext = atomic_load_ptr(&tsLogRings);
+      pRing->next = pNext;
+    } while (atomic_val_compare_exchange_ptr(&tsLogRings, pNext, pRing) != pNext);
+  }
+
+  pthread_setspecific(tsLogRingKey, pRing);
+  tsLogRing = pRing;
+  return pRing;
+}
+
+static int32_t taosPushLogRing(SLogRing *pRing, int32_t kind, const char *msg, int32_t msgLen) {
+  int32_t recLen = LOG_REC_HEAD_SIZE + ((msgLen + 7) & ~7);
+  if (recLen > LOG_RING_MAX_REC || tsLogObj.logHandle->stop) return -1;
+
+  int64_t head = pRing->head;
+  int64_t avail = LOG_RING_SIZE - (head - atomic_load_64(&pRing->tail));
+  int32_t offset = (int32_t)(head & (LOG_RING_SIZE - 1));
+  int32_t skip = (LOG_RING_SIZE - offset < recLen) ? (LOG_RING_SIZE - offset) : 0;
+  if (avail < skip + recLen) return -1;
+
+  if (skip > 0) {
+    SLogRecHead *pSkip = (SLogRecHead *)(pRing->buffer + offset);
+    pSkip->len = skip - LOG_REC_HEAD_SIZE;
+    pSkip->kind = LOG_REC_SKIP;
+    offset = 0;
+  }
+
+  SLogRecHead *pRec = (SLogRecHead *)(pRing->buffer + offset);
+  pRec->len = msgLen;
+  pRec->kind = kind;
+  memcpy(pRec + 1, msg, msgLen);
+
+  atomic_store_64(&pRing->head, head + skip + recLen);
+  return 0;
+}
+
+// the shared buffer is written before the rings, a line of a full ring waits for the async log thread to drain it
+// instead of going to the shared buffer ahead of the earlier lines of its thread
+static int32_t taosWaitLogRing(SLogRing *pRing, int32_t kind, const char *msg, int32_t msgLen) {
+  while (taosPushLogRing(pRing, kind, msg, msgLen) != 0) {
+    if (tsLogObj.logHandle->stop || msgLen > LOG_RING_MAX_REC - LOG_REC_HEAD_SIZE - 8 ||
+        pthread_equal(pthread_self(), tsLogObj.logHandle->asyncThread)) {
+      return -1;
+    }
+    writeInterval = MIN_LOG_INTERVAL;
+    taosMsleep(1);
+  }
+
+  return 0;
+}
+
+static void taosPushLogLine(char *buffer, int32_t len) {
+  if (tsAsyncLog) {
+    SLogRing *pRing = taosGetLogRing();
+
+    // lines in the rings are counted by the async log thread
+    if (pRing != NULL && taosWaitLogRing(pRing, LOG_REC_TEXT, buffer, len) == 0) return;
+    taosPushLogBuffer(tsLogObj.logHandle, buffer, len);
+  } else {
+    taosWrite(tsLogObj.logHandle->fd, buffer, len);
+  }
+
+  taosCountLogLines(1);
+}
+
+// parse the conversion spec at p, return the position after it or NULL if it can not be deferred
+const char *taosParseLogSpec(const char *p, SLogSpec *pSpec) {
+  int32_t len = 0;
+
+  pSpec->stars = 0;
+  pSpec->precision = -1;
+  pSpec->lenMod = 0;
+  pSpec->spec[len++] = *p++;
+
+  while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+    if (len >= LOG_SPEC_MAX_LEN) return NULL;
+    pSpec->spec[len++] = *p++;
+  }
+
+  if (*p == '*') {
+    pSpec->stars++;
+    pSpec->spec[len++] = *p++;
+  } else {
+    while (*p >= '0' && *p <= '9') {
+      if (len >= LOG_SPEC_MAX_LEN) return NULL;
+      pSpec->spec[len++] = *p++;
+    }
+  }
+
+  if (*p == '.') {
+    pSpec->spec[len++] = *p++;
+    if (*p == '*') {
+      pSpec->stars++;
+      pSpec->precision = LOG_PRECISION_ARG;
+      pSpec->spec[len++] = *p++;
+    } else {
+      pSpec->precision = 0;
+      while (*p >= '0' && *p <= '9') {
+        if (len >= LOG_SPEC_MAX_LEN) return NULL;
+        pSpec->precision = pSpec->precision * 10 + (*p - '0');
+        pSpec->spec[len++] = *p++;
+      }
+    }
+  }
+
+  if (p[0] == 'h' && p[1] == 'h') {
+    pSpec->lenMod = 'H';
+    p += 2;
+  } else if (p[0] == 'l' && p[1] == 'l') {
+    pSpec->lenMod = 'q';
+    p += 2;
+  } else if (*p == 'h' || *p == 'l' || *p == 'q' || *p == 'L' || *p == 'j' || *p == 'z' || *p == 't') {
+    pSpec->lenMod = *p++;
+  }
+
+  pSpec->conv = *p++;
+  switch (pSpec->conv) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+      // integers are kept as 64 bits and printed as long long
+      pSpec->spec[len++] = 'l';
+      pSpec->spec[len++] = 'l';
+      break;
+    case 'c': case 's': case 'p':
+      if (pSpec->lenMod != 0) return NULL;
+      break;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+      if (pSpec->lenMod != 0 && pSpec->lenMod != 'l') return NULL;
+      break;
+    default:
+      return NULL;
+  }
+
+  pSpec->spec[len++] = pSpec->conv;
+  pSpec->spec[len] = 0;
+  return p;
+}
+
+static int32_t taosEncodeLogArg(char *buf, int32_t cap, int8_t type, const void *val, int32_t size) {
+  if (cap < (int32_t)sizeof(int8_t) + size) return -1;
+  buf[0] = type;
+  memcpy(buf + 1, val, size);
+  return (int32_t)sizeof(int8_t) + size;
+}
+
+// record the arguments of format, strings are copied since they may be gone when the line is rendered
+int32_t taosEncodeLogArgs(char *buf, int32_t cap, const char *format, va_list ap) {
+  int32_t  len = 0;
+  int32_t  numOfArgs = 0;
+  SLogSpec spec;
+
+  for (const char *p = format; *p != 0;) {
+    if (*p != '%') {
+      ++p;
+      continue;
+    }
+
+    if (p[1] == '%') {
+      p += 2;
+      continue;
+    }
+
+    p = taosParseLogSpec(p, &spec);
+    if (p == NULL) return -1;
+
+    numOfArgs += spec.stars + 1;
+    if (numOfArgs > LOG_MAX_DEFER_ARGS) return -1;
+
+    int32_t precision = spec.precision;
+    for (int32_t i = 0; i < spec.stars; ++i) {
+      int64_t star = va_arg(ap, int);
+      if (spec.precision == LOG_PRECISION_ARG && i == spec.stars - 1) precision = (star < 0) ? -1 : (int32_t)star;
+
+      int32_t n = taosEncodeLogArg(buf + len, cap - len, LOG_ARG_INT, &star, sizeof(star));
+      if (n < 0) return -1;
+      len += n;
+    }
+
+    int32_t n = -1;
+    if (spec.conv == 'd' || spec.conv == 'i') {
+      int64_t v = 0;
+      switch (spec.lenMod) {
+        case 0:   v = va_arg(ap, int); break;
+        case 'H': v = (signed char)va_arg(ap, int); break;
+        case 'h': v = (short)va_arg(ap, int); break;
+        case 'l': v = va_arg(ap, long); break;
+        case 'q': v = va_arg(ap, long long); break;
+        case 'j': v = va_arg(ap, intmax_t); break;
+        case 'z': v = va_arg(ap, ssize_t); break;
+        case 't': v = va_arg(ap, ptrdiff_t); break;
+        default:  return -1;
+      }
+      n = taosEncodeLogArg(buf + len, cap - len, LOG_ARG_INT, &v, sizeof(v));
+    } else if (spec.conv == 'u' || spec.conv == 'o' || spec.conv == 'x' || spec.conv == 'X') {
+      uint64_t v = 0;
+      switch (spec.lenMod) {
+        case 0:   v = va_arg(ap, unsigned int); break;
+        case 'H': v = (unsigned char)va_arg(ap, unsigned int); break;
+        case 'h': v = (unsigned short)va_arg(ap, unsigned int); break;
+        case 'l': v = va_arg(ap, unsigned long); break;
+        case 'q': v = va_arg(ap, unsigned long long); break;
+        case 'j': v = va_arg(ap, uintmax_t); break;
+        case 'z': v = va_arg(ap, size_t); break;
+        case 't': v = (size_t)va_arg(ap, ptrdiff_t); break;
+        default:  return -1;
+      }
+      n = taosEncodeLogArg(buf + len, cap - len, LOG_ARG_UINT, &v, sizeof(v));
+    } else if (spec.conv == 'c') {
+      int64_t v = va_arg(ap, int);
+      n = taosEncodeLogArg(buf + len, cap - len, LOG_ARG_INT, &v, sizeof(v));
+    } else if (spec.conv == 'p') {
+      uint64_t v = (uint64_t)(uintptr_t)va_arg(ap, void *);
+      n = taosEncodeLogArg(buf + len, cap - len, LOG_ARG_PTR, &v, sizeof(v));
+    } else if (spec.conv == 's') {
+      const char *str = va_arg(ap, const char *);
+      if (str == NULL) str = "(null)";
+
+      int32_t strLen = (int32_t)strnlen(str, (precision >= 0) ? precision : MAX_LOGLINE_CONTENT_SIZE);
+      if (cap - len < (int32_t)(sizeof(int8_t) + sizeof(int32_t)) + strLen + 1) return -1;
+
+      buf[len++] = LOG_ARG_STR;
+      memcpy(buf + len, &strLen, sizeof(int32_t));
+      len += sizeof(int32_t);
+      memcpy(buf + len, str, strLen);
+      len += strLen;
+      buf[len++] = 0;
+      continue;
+    } else {
+      double v = va_arg(ap, double);
+      n = taosEncodeLogArg(buf + len, cap - len, LOG_ARG_DOUBLE, &v, sizeof(v));
+    }
+
+    if (n < 0) return -1;
+    len += n;
+  }
+
+  return len;
+}
+
+static const char *taosDecodeLogArg(const char *args, int64_t *pVal, const char **pStr) {
+  int8_t type = *args++;
+  if (type == LOG_ARG_STR) {
+    int32_t strLen = 0;
+    memcpy(&strLen, args, sizeof(int32_t));
+    *pStr = args + sizeof(int32_t);
+    return *pStr + strLen + 1;
+  }
+
+  memcpy(pVal, args, sizeof(int64_t));
+  return args + sizeof(int64_t);
+}
+
+#define LOG_RENDER_ARG(buf, size, spec, stars, star, val)                                                 \
+  (((stars) == 0) ? snprintf(buf, size, spec, val)                                                        \
+                  : (((stars) == 1) ? snprintf(buf, size, spec, (int32_t)(star)[0], val)                  \
+                                    : snprintf(buf, size, spec, (int32_t)(star)[0], (int32_t)(star)[1], val)))
+
+// render a format recorded by taosEncodeLogArgs, at most cap - 1 bytes are written
+int32_t taosRenderLogArgs(char *out, int32_t cap, const char *format, const char *args) {
+  int32_t  len = 0;
+  SLogSpec spec;
+
+  for (const char *p = format; *p != 0 && len < cap - 1;) {
+    if (*p != '%') {
+      out[len++] = *p++;
+      continue;
+    }
+
+    if (p[1] == '%') {
+      out[len++] = '%';
+      p += 2;
+      continue;
+    }
+
+    // the format has been accepted by taosEncodeLogArgs, so it parses again
+    p = taosParseLogSpec(p, &spec);
+
+    int64_t star[2] = {0};
+    for (int32_t i = 0; i < spec.stars; ++i) {
+      args = taosDecodeLogArg(args, &star[i], NULL);
+    }
+
+    int64_t     val = 0;
+    const char *str = NULL;
+    args = taosDecodeLogArg(args, &val, &str);
+
+    int32_t n = 0;
+    int32_t size = cap - len;
+    switch (spec.conv) {
+      case 'd': case 'i':
+        n = LOG_RENDER_ARG(out + len, size, spec.spec, spec.stars, star, (long long)val);
+        break;
+      case 'u': case 'o': case 'x': case 'X':
+        n = LOG_RENDER_ARG(out + len, size, spec.spec, spec.stars, star, (unsigned long long)val);
+        break;
+      case 'c':
+        n = LOG_RENDER_ARG(out + len, size, spec.spec, spec.stars, star, (int32_t)val);
+        break;
+      case 'p':
+        n = LOG_RENDER_ARG(out + len, size, spec.spec, spec.stars, star, (void *)(uintptr_t)val);
+        break;
+      case 's':
+        n = LOG_RENDER_ARG(out + len, size, spec.spec, spec.stars, star, str);
+        break;
+      default: {
+        double d = 0;
+        memcpy(&d, &val, sizeof(double));
+        n = LOG_RENDER_ARG(out + len, size, spec.spec, spec.stars, star, d);
+        break;
+      }
+    }
+
+    if (n < 0) break;
+    len += MIN(n, size - 1);
+  }
+
+  return len;
+}
+
+static bool taosPushDeferredLog(struct timeval *pTime, const char *flags, const char *format, va_list ap) {
+  SLogRing *pRing = taosGetLogRing();
+  if (pRing == NULL) return false;
+
+  char          rec[LOG_DEFER_REC_SIZE];
+  SLogDeferHead head;
+  size_t        formatLen = strlen(format);
+
+  head.sec = pTime->tv_sec;
+  head.usec = (int32_t)pTime->tv_usec;
+  head.tid = taosGetSelfPthreadId();
+  head.flagsLen = (int16_t)strnlen(flags, LOG_MAX_FLAGS_LEN);
+  head.formatLen = (int16_t)formatLen;
+  if (sizeof(SLogDeferHead) + head.flagsLen + formatLen + 1 > LOG_DEFER_REC_SIZE) return false;
+
+  int32_t len = sizeof(SLogDeferHead);
+  memcpy(rec, &head, sizeof(SLogDeferHead));
+  memcpy(rec + len, flags, head.flagsLen);
+  len += head.flagsLen;
+  memcpy(rec + len, format, formatLen + 1);
+  len += (int32_t)formatLen + 1;
+
+  int32_t argsLen = taosEncodeLogArgs(rec + len, LOG_DEFER_REC_SIZE - len, format, ap);
+  if (argsLen < 0) return false;
+
+  return taosWaitLogRing(pRing, LOG_REC_DEFERRED, rec, len + argsLen) == 0;
+}
+
+static int32_t taosRenderDeferredLog(SLogHeadCache *pCache, char *buffer, const char *rec) {
+  SLogDeferHead head;
+  memcpy(&head, rec, sizeof(SLogDeferHead));
+
+  const char *flags = rec + sizeof(SLogDeferHead);
+  const char *format = flags + head.flagsLen;
+  const char *args = format + head.formatLen + 1;
+
+  int32_t len = taosBuildLogHead(pCache, buffer, head.sec, head.usec, head.tid, flags, head.flagsLen);
+  len += taosRenderLogArgs(buffer + len, MAX_LOGLINE_CONTENT_SIZE, format, args);
+  buffer[len++] = '\n';
+  return len;
+}
+
 void taosPrintLog(const char *flags, int32_t dflag, const char *format, ...) {
   if (tsTotalLogDirGB != 0 && tsAvailLogDirGB < tsMinimalLogDirGB) {
     printf("server disk:%s space remain %.3f GB, total %.1f GB, stop print log.\n", tsLogDir, tsAvailLogDirGB, tsTotalLogDirGB);
@@ -371,19 +869,24 @@ void taosPrintLog(const char *flags, int32_t dflag, const char *format, ...) {
   }
 
   va_list        argpointer;
-  char           buffer[MAX_LOGLINE_BUFFER_SIZE] = { 0 };
+  char           buffer[MAX_LOGLINE_BUFFER_SIZE];
   int32_t        len;
-  struct tm      Tm, *ptm;
   struct timeval timeSecs;
-  time_t         curTime;
 
   gettimeofday(&timeSecs, NULL);
-  curTime = timeSecs.tv_sec;
-  ptm = localtime_r(&curTime, &Tm);
 
-  len = sprintf(buffer, "%02d/%02d %02d:%02d:%02d.%06d %08" PRId64 " ", ptm->tm_mon + 1, ptm->tm_mday, ptm->tm_hour,
-                ptm->tm_min, ptm->tm_sec, (int32_t)timeSecs.tv_usec, taosGetSelfPthreadId());
-  len += sprintf(buffer + len, "%s", flags);
+  bool toFile = (dflag & DEBUG_FILE) && tsLogObj.logHandle && tsLogObj.logHandle->fd >= 0;
+
+  // only lines that go to the log file alone can be formatted later by the async log thread
+  if (toFile && tsAsyncLog && tsDeferLogFormat && !(dflag & DEBUG_SCREEN) && dflag != 255) {
+    va_start(argpointer, format);
+    bool deferred = taosPushDeferredLog(&timeSecs, flags, format, argpointer);
+    va_end(argpointer);
+    if (deferred) return;
+  }
+
+  len = taosBuildLogHead(&tsLogHeadCache, buffer, timeSecs.tv_sec, (int32_t)timeSecs.tv_usec, taosGetSelfPthreadId(),
+                         flags, (int32_t)strnlen(flags, LOG_MAX_FLAGS_LEN));
 
   va_start(argpointer, format);
   int32_t writeLen = vsnprintf(buffer + len, MAX_LOGLINE_CONTENT_SIZE, format, argpointer);
@@ -404,18 +907,8 @@ void taosPrintLog(const char *flags, int32_t dflag, const char *format, ...) {
   buffer[len++] = '\n';
   buffer[len] = 0;
 
-  if ((dflag & DEBUG_FILE) && tsLogObj.logHandle && tsLogObj.logHandle->fd >= 0) {
-    if (tsAsyncLog) {
-      taosPushLogBuffer(tsLogObj.logHandle, buffer, len);
-    } else {
-      taosWrite(tsLogObj.logHandle->fd, buffer, len);
-    }
-
-    if (tsLogObj.maxLines > 0) {
-      atomic_add_fetch_32(&tsLogObj.lines, 1);
-
-      if ((tsLogObj.lines > tsLogObj.maxLines) && (tsLogObj.openInProgress == 0)) taosOpenNewLogFile();
-    }
+  if (toFile) {
+    taosPushLogLine(buffer, len);
   }
 
   if (dflag & DEBUG_SCREEN)
@@ -460,17 +953,11 @@ void taosPrintLongString(const char *flags, int32_t dflag, const char *format, .
   va_list        argpointer;
   char           buffer[MAX_LOGLINE_DUMP_BUFFER_SIZE];
   int32_t        len;
-  struct tm      Tm, *ptm;
   struct timeval timeSecs;
-  time_t         curTime;
 
   gettimeofday(&timeSecs, NULL);
-  curTime = timeSecs.tv_sec;
-  ptm = localtime_r(&curTime, &Tm);
-
-  len = sprintf(buffer, "%02d/%02d %02d:%02d:%02d.%06d %08" PRId64 " ", ptm->tm_mon + 1, ptm->tm_mday, ptm->tm_hour,
-                ptm->tm_min, ptm->tm_sec, (int32_t)timeSecs.tv_usec, taosGetSelfPthreadId());
-  len += sprintf(buffer + len, "%s", flags);
+  len = taosBuildLogHead(&tsLogHeadCache, buffer, timeSecs.tv_sec, (int32_t)timeSecs.tv_usec, taosGetSelfPthreadId(),
+                         flags, (int32_t)strnlen(flags, LOG_MAX_FLAGS_LEN));
 
   va_start(argpointer, format);
   len += vsnprintf(buffer + len, MAX_LOGLINE_DUMP_CONTENT_SIZE, format, argpointer);
@@ -482,17 +969,7 @@ void taosPrintLongString(const char *flags, int32_t dflag, const char *format, .
   buffer[len] = 0;
 
   if ((dflag & DEBUG_FILE) && tsLogObj.logHandle && tsLogObj.logHandle->fd >= 0) {
-    if (tsAsyncLog) {
-      taosPushLogBuffer(tsLogObj.logHandle, buffer, len);
-    } else {
-      taosWrite(tsLogObj.logHandle->fd, buffer, len);
-    }
-    
-    if (tsLogObj.maxLines > 0) {
-      atomic_add_fetch_32(&tsLogObj.lines, 1);
-
-      if ((tsLogObj.lines > tsLogObj.maxLines) && (tsLogObj.openInProgress == 0)) taosOpenNewLogFile();
-    }
+    taosPushLogLine(buffer, len);
   }
 
   if (dflag & DEBUG_SCREEN) taosWrite(1, buffer, (uint32_t)len);
@@ -685,18 +1162,80 @@ static void taosWriteLog(SLogBuff *tLogBuff) {
   }while (1);
 }
 
+static int32_t taosDrainLogRing(SLogBuff *tLogBuff, SLogRing *pRing, SLogHeadCache *pCache, char *out,
+                                int32_t *outLen) {
+  int32_t lines = 0;
+  int64_t tail = pRing->tail;
+  int64_t head = atomic_load_64(&pRing->head);
+
+  while (tail < head) {
+    SLogRecHead *pRec = (SLogRecHead *)(pRing->buffer + (tail & (LOG_RING_SIZE - 1)));
+
+    if (pRec->kind != LOG_REC_SKIP) {
+      if (*outLen + MAX(pRec->len, MAX_LOGLINE_BUFFER_SIZE) > LOG_OUT_BUF_SIZE) {
+        taosWrite(tLogBuff->fd, out, *outLen);
+        *outLen = 0;
+      }
+
+      if (pRec->kind == LOG_REC_TEXT) {
+        memcpy(out + *outLen, pRec + 1, pRec->len);
+        *outLen += pRec->len;
+      } else {
+        *outLen += taosRenderDeferredLog(pCache, out + *outLen, (char *)(pRec + 1));
+      }
+      lines++;
+    }
+
+    tail += LOG_REC_HEAD_SIZE + ((pRec->len + 7) & ~7);
+  }
+
+  atomic_store_64(&pRing->tail, tail);
+  return lines;
+}
+
+static void taosWriteLogRings(SLogBuff *tLogBuff, SLogHeadCache *pCache, char *out) {
+  int32_t outLen = 0;
+  int32_t lines = 0;
+  bool    busy = false;
+
+  for (SLogRing *pRing = atomic_load_ptr(&tsLogRings); pRing != NULL; pRing = pRing->next) {
+    // the state is read before the head, so all lines of an exited thread are drained before reuse
+    int32_t state = atomic_load_32(&pRing->state);
+    if (state == LOG_RING_FREE) continue;
+
+    if (atomic_load_64(&pRing->head) - pRing->tail > LOG_RING_SIZE / 2) busy = true;
+    lines += taosDrainLogRing(tLogBuff, pRing, pCache, out, &outLen);
+
+    if (state == LOG_RING_EXITED) atomic_store_32(&pRing->state, LOG_RING_FREE);
+  }
+
+  if (outLen > 0) {
+    taosWrite(tLogBuff->fd, out, outLen);
+    dbgWN++;
+    dbgWSize += outLen;
+  }
+
+  if (busy) writeInterval = MIN_LOG_INTERVAL;
+  if (lines > 0) taosCountLogLines(lines);
+}
+
 static void *taosAsyncOutputLog(void *param) {
   SLogBuff *tLogBuff = (SLogBuff *)param;
   setThreadName("log");
+
+  SLogHeadCache cache = {.sec = -1, .tid = -1};
+  char *        out = malloc(LOG_OUT_BUF_SIZE);
   
   while (1) {
     taosMsleep(writeInterval);
 
     // Polling the buffer
     taosWriteLog(tLogBuff);
+    if (out != NULL) taosWriteLogRings(tLogBuff, &cache, out);
 
     if (tLogBuff->stop) break;
   }
 
+  tfree(out);
   return NULL;
 }
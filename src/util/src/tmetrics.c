@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tmetrics.h"
+
+#define TSDB_METRIC_SHARDS 256
+
+typedef struct {
+  volatile int64_t counters[TSDB_METRIC_COUNTER_MAX];
+  volatile int64_t buckets[TSDB_METRIC_HISTOGRAM_MAX][TSDB_METRIC_HISTOGRAM_BUCKETS];
+  volatile int64_t sums[TSDB_METRIC_HISTOGRAM_MAX];
+  volatile int64_t maxs[TSDB_METRIC_HISTOGRAM_MAX];
+  int32_t          inUse;
+} __attribute__((aligned(64))) SMetricsShard;
+
+static const char *tsMetricsCounterNames[TSDB_METRIC_COUNTER_MAX] = {
+  "rpc_msgs_in",   "rpc_bytes_in",   "rpc_msgs_out",  "rpc_bytes_out",   "wal_writes",  "wal_bytes",
+  "tsdb_commits",  "vnode_writes",   "vnode_queries", "vnode_fetches",   "cache_hits",  "cache_misses"};
+
+static const char *tsMetricsGaugeNames[TSDB_METRIC_GAUGE_MAX] = {"vnodes"};
+
+static const char *tsMetricsHistogramNames[TSDB_METRIC_HISTOGRAM_MAX] = {
+  "wal_fsync_us", "tsdb_commit_us", "vnode_write_us", "query_exec_us"};
+
+// shards owned by one thread each, plus the overflow shard shared by threads that found none free
+static SMetricsShard        tsMetricsShards[TSDB_METRIC_SHARDS];
+static SMetricsShard        tsMetricsOverflow;
+static int64_t              tsMetricsGauges[TSDB_METRIC_GAUGE_MAX];
+static pthread_once_t       tsMetricsOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t        tsMetricsKey;
+static threadlocal SMetricsShard *tsMetricsShard = NULL;
+
+// the counts of an exited thread stay in its shard and keep adding up under the next owner
+static void taosMetricsReleaseShard(void *param) {
+  SMetricsShard *pShard = param;
+  atomic_store_32(&pShard->inUse, 0);
+}
+
+static void taosMetricsInitKey(void) { pthread_key_create(&tsMetricsKey, taosMetricsReleaseShard); }
+
+static SMetricsShard *taosMetricsClaimShard() {
+  pthread_once(&tsMetricsOnce, taosMetricsInitKey);
+
+  uint32_t start = (uint32_t)taosGetSelfPthreadId() % TSDB_METRIC_SHARDS;
+  for (int32_t i = 0; i < TSDB_METRIC_SHARDS; ++i) {
+    SMetricsShard *pShard = &tsMetricsShards[(start + i) % TSDB_METRIC_SHARDS];
+    if (pShard->inUse == 0 && atomic_val_compare_exchange_32(&pShard->inUse, 0, 1) == 0) {
+      pthread_setspecific(tsMetricsKey, pShard);
+      tsMetricsShard = pShard;
+      return pShard;
+    }
+  }
+
+  tsMetricsShard = &tsMetricsOverflow;
+  return tsMetricsShard;
+}
+
+static FORCE_INLINE SMetricsShard *taosMetricsGetShard() {
+  SMetricsShard *pShard = tsMetricsShard;
+  if (pShard == NULL) pShard = taosMetricsClaimShard();
+  return pShard;
+}
+
+static FORCE_INLINE int32_t taosMetricsBucket(int64_t us) {
+  if (us <= 0) return 0;
+  int32_t bucket = 64 - __builtin_clzll((uint64_t)us);
+  return MIN(bucket, TSDB_METRIC_HISTOGRAM_BUCKETS - 1);
+}
+
+const char *taosMetricsCounterName(int32_t id) { return tsMetricsCounterNames[id]; }
+const char *taosMetricsGaugeName(int32_t id) { return tsMetricsGaugeNames[id]; }
+const char *taosMetricsHistogramName(int32_t id) { return tsMetricsHistogramNames[id]; }
+
+void taosMetricsInc(int32_t id, int64_t val) {
+  SMetricsShard *pShard = taosMetricsGetShard();
+  if (pShard == &tsMetricsOverflow) {
+    atomic_add_fetch_64(&pShard->counters[id], val);
+  } else {
+    pShard->counters[id] += val;
+  }
+}
+
+void taosMetricsSetGauge(int32_t id, int64_t val) { atomic_store_64(&tsMetricsGauges[id], val); }
+
+void taosMetricsAddGauge(int32_t id, int64_t val) { atomic_add_fetch_64(&tsMetricsGauges[id], val); }
+
+void taosMetricsObserve(int32_t id, int64_t us) {
+  SMetricsShard *pShard = taosMetricsGetShard();
+  int32_t        bucket = taosMetricsBucket(us);
+
+  if (pShard == &tsMetricsOverflow) {
+    atomic_add_fetch_64(&pShard->buckets[id][bucket], 1);
+    atomic_add_fetch_64(&pShard->sums[id], us);
+    int64_t max = atomic_load_64(&pShard->maxs[id]);
+    while (us > max) {
+      int64_t old = atomic_val_compare_exchange_64(&pShard->maxs[id], max, us);
+      if (old == max) break;
+      max = old;
+    }
+  } else {
+    pShard->buckets[id][bucket] += 1;
+    pShard->sums[id] += us;
+    if (us > pShard->maxs[id]) pShard->maxs[id] = us;
+  }
+}
+
+int64_t taosMetricsGetCounter(int32_t id) {
+  int64_t total = atomic_load_64(&tsMetricsOverflow.counters[id]);
+  for (int32_t i = 0; i < TSDB_METRIC_SHARDS; ++i) {
+    total += tsMetricsShards[i].counters[id];
+  }
+  return total;
+}
+
+int64_t taosMetricsGetGauge(int32_t id) { return atomic_load_64(&tsMetricsGauges[id]); }
+
+static int64_t taosMetricsPercentile(const int64_t *buckets, int64_t count, int64_t max, int32_t percent) {
+  if (count == 0) return 0;
+
+  int64_t rank = (count * percent + 99) / 100;
+  int64_t seen = 0;
+  for (int32_t i = 0; i < TSDB_METRIC_HISTOGRAM_BUCKETS; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      // upper bound of the bucket, never beyond the largest observation
+      int64_t bound = (i == 0) ? 0 : ((int64_t)1 << i) - 1;
+      return MIN(bound, max);
+    }
+  }
+
+  return max;
+}
+
+void taosMetricsGetHistogram(int32_t id, SMetricsHistogram *pHist) {
+  int64_t buckets[TSDB_METRIC_HISTOGRAM_BUCKETS] = {0};
+  memset(pHist, 0, sizeof(SMetricsHistogram));
+
+  for (int32_t i = 0; i <= TSDB_METRIC_SHARDS; ++i) {
+    SMetricsShard *pShard = (i == TSDB_METRIC_SHARDS) ? &tsMetricsOverflow : &tsMetricsShards[i];
+    for (int32_t b = 0; b < TSDB_METRIC_HISTOGRAM_BUCKETS; ++b) {
+      buckets[b] += pShard->buckets[id][b];
+    }
+    pHist->sum += pShard->sums[id];
+    pHist->max = MAX(pHist->max, pShard->maxs[id]);
+  }
+
+  for (int32_t b = 0; b < TSDB_METRIC_HISTOGRAM_BUCKETS; ++b) {
+    pHist->count += buckets[b];
+  }
+
+  pHist->p50 = taosMetricsPercentile(buckets, pHist->count, pHist->max, 50);
+  pHist->p90 = taosMetricsPercentile(buckets, pHist->count, pHist->max, 90);
+  pHist->p99 = taosMetricsPercentile(buckets, pHist->count, pHist->max, 99);
+}
@@ -0,0 +1,7 @@
+char version[12] = "2.1.7.2";
+char compatible_version[12] = "2.0.0.0";
+char gitinfo[48] = "ac882a064a0e6b0cf43ddffd02d206e7b20ac016";
+char gitinfoOfInternal[48] = "ac882a064a0e6b0cf43ddffd02d206e7b20ac016";
+char buildinfo[64] = "Built at 2026-10-18 16:45:27";
+
+void libtaos_2_1_7_2_Linux_x32_stable() {};
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <stdarg.h>
+#include <iostream>
+
+#include "os.h"
+#include "tlog.h"
+
+namespace {
+
+int32_t encodeArgs(char *buf, int32_t cap, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int32_t len = taosEncodeLogArgs(buf, cap, format, ap);
+  va_end(ap);
+  return len;
+}
+
+std::string printArgs(const char *format, ...) {
+  char    buf[1024];
+  va_list ap;
+  va_start(ap, format);
+  vsnprintf(buf, sizeof(buf), format, ap);
+  va_end(ap);
+  return std::string(buf);
+}
+
+std::string renderArgs(const char *format, const char *args, int32_t cap = 1024) {
+  char    out[1024];
+  int32_t len = taosRenderLogArgs(out, cap, format, args);
+  return std::string(out, len);
+}
+
+}  // namespace
+
+#define EXPECT_DEFERRED_LOG(format, ...)                                        \
+  do {                                                                          \
+    char args[1024];                                                            \
+    ASSERT_GE(encodeArgs(args, sizeof(args), format, __VA_ARGS__), 0) << format; \
+    EXPECT_EQ(printArgs(format, __VA_ARGS__), renderArgs(format, args));        \
+  } while (0)
+
+TEST(testCase, log_parse_spec_test) {
+  SLogSpec    spec;
+  const char *fmt = "%d rows";
+  const char *p = taosParseLogSpec(fmt, &spec);
+  ASSERT_TRUE(p != NULL);
+  EXPECT_STREQ(" rows", p);
+  EXPECT_EQ('d', spec.conv);
+  EXPECT_EQ(0, spec.lenMod);
+  EXPECT_EQ(0, spec.stars);
+  EXPECT_EQ(-1, spec.precision);
+  EXPECT_STREQ("%lld", spec.spec);
+
+  // integers are always printed as long long
+  p = taosParseLogSpec("%" PRId64, &spec);
+  ASSERT_TRUE(p != NULL);
+  EXPECT_EQ(0, *p);
+  EXPECT_EQ('d', spec.conv);
+  EXPECT_STREQ("%lld", spec.spec);
+
+  p = taosParseLogSpec("%-08hhx", &spec);
+  ASSERT_TRUE(p != NULL);
+  EXPECT_EQ('H', spec.lenMod);
+  EXPECT_STREQ("%-08llx", spec.spec);
+
+  p = taosParseLogSpec("%5.2f", &spec);
+  ASSERT_TRUE(p != NULL);
+  EXPECT_EQ('f', spec.conv);
+  EXPECT_EQ(2, spec.precision);
+  EXPECT_STREQ("%5.2f", spec.spec);
+
+  p = taosParseLogSpec("%*.*s", &spec);
+  ASSERT_TRUE(p != NULL);
+  EXPECT_EQ('s', spec.conv);
+  EXPECT_EQ(2, spec.stars);
+  EXPECT_STREQ("%*.*s", spec.spec);
+
+  // conversions that can not be recorded are rejected
+  EXPECT_TRUE(taosParseLogSpec("%n", &spec) == NULL);
+  EXPECT_TRUE(taosParseLogSpec("%ls", &spec) == NULL);
+  EXPECT_TRUE(taosParseLogSpec("%hf", &spec) == NULL);
+  EXPECT_TRUE(taosParseLogSpec("%", &spec) == NULL);
+  EXPECT_TRUE(taosParseLogSpec("%000000000000000000000000000000d", &spec) == NULL);
+}
+
+TEST(testCase, log_render_args_test) {
+  int64_t  i64 = -1234567890123LL;
+  uint64_t u64 = 18446744073709551615ULL;
+  int16_t  i16 = -32768;
+  int8_t   i8 = -7;
+  int      n = 42;
+  char     name[] = "vnode:2";
+
+  EXPECT_DEFERRED_LOG("vgId:%d, %s is opened", n, name);
+  EXPECT_DEFERRED_LOG("%" PRId64 " %" PRIu64 " %" PRIx64, i64, u64, u64);
+  EXPECT_DEFERRED_LOG("%hd %hhd %hhu %lu %zu %jd", i16, i8, (unsigned char)200, 123456789UL, (size_t)77, (intmax_t)i64);
+  EXPECT_DEFERRED_LOG("%5.2f|%-10.3e|%g|%lf", 3.14159, 0.000123, 1e20, -2.5);
+  EXPECT_DEFERRED_LOG("%c%c %p %%", 'o', 'k', (void *)&n);
+  EXPECT_DEFERRED_LOG("[%10s][%-10s][%.3s]", "right", "left", "truncated");
+  EXPECT_DEFERRED_LOG("[%*d][%-*d][%.*s][%*.*f]", 6, n, 6, n, 4, name, 8, 2, 1.005);
+  EXPECT_DEFERRED_LOG("%s and %s", (const char *)NULL, "null");
+  EXPECT_DEFERRED_LOG("%s", "no arguments are left");
+}
+
+TEST(testCase, log_encode_args_test) {
+  char args[1024];
+
+  // strings are copied, so the line renders after the argument is gone
+  char tmp[16];
+  strcpy(tmp, "table_1");
+  ASSERT_GT(encodeArgs(args, sizeof(args), "drop %s", tmp), 0);
+  strcpy(tmp, "overwritten");
+  EXPECT_EQ(std::string("drop table_1"), renderArgs("drop %s", args));
+
+  // formats that can not be deferred
+  int n = 0;
+  EXPECT_LT(encodeArgs(args, sizeof(args), "%d%n", 1, &n), 0);
+  EXPECT_LT(encodeArgs(args, sizeof(args), "%ls", L"wide"), 0);
+  EXPECT_LT(encodeArgs(args, sizeof(args), "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7,
+                       8, 9, 10, 11, 12, 13, 14, 15, 16, 17),
+            0);
+
+  // arguments that do not fit in the record
+  EXPECT_LT(encodeArgs(args, 8, "%d %d", 1, 2), 0);
+  EXPECT_LT(encodeArgs(args, 16, "%s", "a string longer than the record"), 0);
+}
+
+TEST(testCase, log_render_truncate_test) {
+  char args[1024];
+  ASSERT_GT(encodeArgs(args, sizeof(args), "%s=%d", "numOfRows", 123456), 0);
+
+  // at most cap - 1 bytes are written
+  EXPECT_EQ(std::string("numOfRows=123456"), renderArgs("%s=%d", args));
+  EXPECT_EQ(std::string("numOfRows=12"), renderArgs("%s=%d", args, 13));
+  EXPECT_EQ(std::string("numOf"), renderArgs("%s=%d", args, 6));
+  EXPECT_EQ(std::string(""), renderArgs("%s=%d", args, 1));
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "os.h"
+#include "tmetrics.h"
+
+namespace {
+
+typedef struct {
+  pthread_barrier_t *barrier;
+  int32_t            loops;
+} SMetricsParam;
+
+// all threads are alive at the same time, so each of them holds a shard of its own or the overflow one
+void *incCounters(void *param) {
+  SMetricsParam *pParam = (SMetricsParam *)param;
+  pthread_barrier_wait(pParam->barrier);
+  for (int32_t i = 0; i < pParam->loops; ++i) {
+    taosMetricsInc(TSDB_METRIC_VNODE_FETCHES, 1);
+    taosMetricsInc(TSDB_METRIC_RPC_BYTES_OUT, 3);
+    taosMetricsObserve(TSDB_METRIC_VNODE_WRITE_US, i % 100);
+  }
+  pthread_barrier_wait(pParam->barrier);
+  return NULL;
+}
+
+void runThreads(int32_t numOfThreads, int32_t loops) {
+  pthread_barrier_t barrier;
+  pthread_barrier_init(&barrier, NULL, numOfThreads);
+
+  SMetricsParam param = {&barrier, loops};
+  pthread_t    *threads = (pthread_t *)calloc(numOfThreads, sizeof(pthread_t));
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    ASSERT_EQ(0, pthread_create(&threads[i], NULL, incCounters, &param));
+  }
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  free(threads);
+  pthread_barrier_destroy(&barrier);
+}
+
+}  // namespace
+
+TEST(testCase, metrics_counter_test) {
+  int64_t fetches = taosMetricsGetCounter(TSDB_METRIC_VNODE_FETCHES);
+  int64_t bytes = taosMetricsGetCounter(TSDB_METRIC_RPC_BYTES_OUT);
+
+  runThreads(8, 100000);
+  EXPECT_EQ(fetches + 8 * 100000, taosMetricsGetCounter(TSDB_METRIC_VNODE_FETCHES));
+  EXPECT_EQ(bytes + 8 * 300000, taosMetricsGetCounter(TSDB_METRIC_RPC_BYTES_OUT));
+
+  // the shards of the exited threads are reused, their counts are kept
+  runThreads(8, 1000);
+  EXPECT_EQ(fetches + 8 * 101000, taosMetricsGetCounter(TSDB_METRIC_VNODE_FETCHES));
+
+  taosMetricsInc(TSDB_METRIC_VNODE_FETCHES, 5);
+  EXPECT_EQ(fetches + 8 * 101000 + 5, taosMetricsGetCounter(TSDB_METRIC_VNODE_FETCHES));
+}
+
+TEST(testCase, metrics_overflow_test) {
+  int64_t fetches = taosMetricsGetCounter(TSDB_METRIC_VNODE_FETCHES);
+
+  SMetricsHistogram before;
+  taosMetricsGetHistogram(TSDB_METRIC_VNODE_WRITE_US, &before);
+
+  // more threads than shards, the ones left share the overflow shard
+  runThreads(300, 2000);
+  EXPECT_EQ(fetches + 300 * 2000, taosMetricsGetCounter(TSDB_METRIC_VNODE_FETCHES));
+
+  SMetricsHistogram after;
+  taosMetricsGetHistogram(TSDB_METRIC_VNODE_WRITE_US, &after);
+  EXPECT_EQ(before.count + 300 * 2000, after.count);
+  EXPECT_EQ(before.sum + 300 * 20 * 4950, after.sum);
+  EXPECT_EQ(99, after.max);
+}
+
+TEST(testCase, metrics_histogram_test) {
+  SMetricsHistogram hist;
+  taosMetricsGetHistogram(TSDB_METRIC_QUERY_EXEC_US, &hist);
+  EXPECT_EQ(0, hist.count);
+  EXPECT_EQ(0, hist.p50);
+  EXPECT_EQ(0, hist.p99);
+
+  // 90 fast observations, 9 slow ones and one far slower
+  for (int32_t i = 0; i < 90; ++i) taosMetricsObserve(TSDB_METRIC_QUERY_EXEC_US, 10);
+  for (int32_t i = 0; i < 9; ++i) taosMetricsObserve(TSDB_METRIC_QUERY_EXEC_US, 1000);
+  taosMetricsObserve(TSDB_METRIC_QUERY_EXEC_US, 100000);
+
+  taosMetricsGetHistogram(TSDB_METRIC_QUERY_EXEC_US, &hist);
+  EXPECT_EQ(100, hist.count);
+  EXPECT_EQ(90 * 10 + 9 * 1000 + 100000, hist.sum);
+  EXPECT_EQ(100000, hist.max);
+
+  // percentiles are the upper bounds of the buckets [8, 16), [512, 1024)
+  EXPECT_EQ(15, hist.p50);
+  EXPECT_EQ(15, hist.p90);
+  EXPECT_EQ(1023, hist.p99);
+
+  // the bound of the last bucket is never beyond the largest observation
+  for (int32_t i = 0; i < 1000; ++i) taosMetricsObserve(TSDB_METRIC_QUERY_EXEC_US, 100000);
+  taosMetricsGetHistogram(TSDB_METRIC_QUERY_EXEC_US, &hist);
+  EXPECT_EQ(100000, hist.p50);
+
+  // zero and negative observations go to the first bucket
+  taosMetricsObserve(TSDB_METRIC_TSDB_COMMIT_US, 0);
+  taosMetricsObserve(TSDB_METRIC_TSDB_COMMIT_US, -5);
+  taosMetricsGetHistogram(TSDB_METRIC_TSDB_COMMIT_US, &hist);
+  EXPECT_EQ(2, hist.count);
+  EXPECT_EQ(0, hist.p99);
+}
+
+TEST(testCase, metrics_gauge_test) {
+  taosMetricsSetGauge(TSDB_METRIC_VNODES, 10);
+  taosMetricsAddGauge(TSDB_METRIC_VNODES, 3);
+  taosMetricsAddGauge(TSDB_METRIC_VNODES, -5);
+  EXPECT_EQ(8, taosMetricsGetGauge(TSDB_METRIC_VNODES));
+
+  taosMetricsSetGauge(TSDB_METRIC_VNODES, 0);
+  EXPECT_EQ(0, taosMetricsGetGauge(TSDB_METRIC_VNODES));
+
+  EXPECT_STREQ("vnode_fetches", taosMetricsCounterName(TSDB_METRIC_VNODE_FETCHES));
+  EXPECT_STREQ("vnodes", taosMetricsGaugeName(TSDB_METRIC_VNODES));
+  EXPECT_STREQ("query_exec_us", taosMetricsHistogramName(TSDB_METRIC_QUERY_EXEC_US));
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_VNODE_FLOWCTRL_H
+#define TDENGINE_VNODE_FLOWCTRL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "vnodeInt.h"
+
+#define MAX_QUEUED_MSG_NUM  100000
+#define MAX_QUEUED_MSG_SIZE 1024*1024*1024  //1GB
+
+#define VNODE_FCTRL_MAX_DELAY 100    // ms, upper bound of a single flow control delay
+#define VNODE_FCTRL_MAX_WAIT  10000  // ms, a msg is rejected after waiting so long in flow control
+
+void    vnodeFlowCtrlIn(SVnodeObj *pVnode, int32_t len);
+void    vnodeFlowCtrlOut(SVnodeObj *pVnode, int32_t len);
+void    vnodeFlowCtrlStartCommit(SVnodeObj *pVnode);
+void    vnodeFlowCtrlEndCommit(SVnodeObj *pVnode);
+int32_t vnodeFlowCtrlAdmit(SVnodeObj *pVnode, int32_t len);
+void    vnodeFlowCtrlSetHint(SVnodeObj *pVnode, SShellSubmitRspFlowCtrl *pHint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -35,6 +35,24 @@ extern int32_t vNumOfExistedQHandle;   // current initialized and existed query
 #define vDebug(...) { if (vDebugFlag & DEBUG_DEBUG) { taosPrintLog("VND ", vDebugFlag, __VA_ARGS__); }}
 #define vTrace(...) { if (vDebugFlag & DEBUG_TRACE) { taosPrintLog("VND ", vDebugFlag, __VA_ARGS__); }}
 
+typedef struct {
+  int64_t sampleTs;       // ms, start of current sampling window
+  int64_t inBytes;        // bytes put into vwqueue in current window
+  int64_t outBytes;       // bytes applied by vwrite worker in current window
+  int64_t fillRate;       // smoothed bytes per second put into vwqueue
+  int64_t drainRate;      // smoothed bytes per second applied by vwrite worker
+  int64_t commitBytes;    // bytes applied since last commit started
+  int64_t commitPending;  // bytes handed to the running commit
+  int64_t commitStartTs;  // ms
+  int64_t commitRate;     // bytes per second of last finished commit
+  int64_t memHeadroom;    // cache bytes left before next commit is triggered
+  int64_t memTs;          // ms, last time memHeadroom was refreshed
+  int64_t allowedBytes;   // credits, bytes that can be queued without throttling
+  int64_t throttledMsgs;
+  int32_t retryAfter;     // ms, suggested delay for clients, 0 if no backpressure
+  int32_t reserved;
+} SVnodeFlowCtrl;
+
 typedef struct {
   int32_t  vgId;      // global vnode group ID
   int32_t  refCount;  // reference count
@@ -42,6 +60,7 @@ typedef struct {
   int32_t  queuedWMsg;
   int32_t  queuedRMsg;
   int32_t  flowctrlLevel;
+  SVnodeFlowCtrl fctrl;
   int8_t   preClose;  // drop and close switch
   int8_t   reserved[3];
   int64_t  sequence;  // for topic
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taosmsg.h"
+#include "vnodeMain.h"
+#include "vnodeFlowCtrl.h"
+
+#define VNODE_FCTRL_SAMPLE_MS  100                 // refresh interval of the rate estimates
+#define VNODE_FCTRL_QUEUE_MS   1000                // keep about so many ms of work in vwqueue
+#define VNODE_FCTRL_MIN_CREDIT (16 * 1024 * 1024)  // credits never shrink below this while not syncing
+#define VNODE_FCTRL_EWMA(o, n) (((o)*3 + (n)) / 4)
+
+static void vnodeFlowCtrlUpdateRate(SVnodeObj *pVnode) {
+  SVnodeFlowCtrl *pCtrl = &pVnode->fctrl;
+
+  int64_t now = taosGetTimestampMs();
+  int64_t sampleTs = atomic_load_64(&pCtrl->sampleTs);
+  int64_t elapsed = now - sampleTs;
+  if (elapsed < VNODE_FCTRL_SAMPLE_MS) return;
+
+  // only one thread closes the window
+  if (atomic_val_compare_exchange_64(&pCtrl->sampleTs, sampleTs, now) != sampleTs) return;
+
+  int64_t inBytes = atomic_exchange_64(&pCtrl->inBytes, 0);
+  int64_t outBytes = atomic_exchange_64(&pCtrl->outBytes, 0);
+  if (sampleTs == 0) return;
+
+  pCtrl->fillRate = VNODE_FCTRL_EWMA(pCtrl->fillRate, inBytes * 1000 / elapsed);
+  pCtrl->drainRate = VNODE_FCTRL_EWMA(pCtrl->drainRate, outBytes * 1000 / elapsed);
+
+  vTrace("vgId:%d, flowctrl rate updated, fill:%" PRId64 " drain:%" PRId64 " commit:%" PRId64 " headroom:%" PRId64,
+         pVnode->vgId, pCtrl->fillRate, pCtrl->drainRate, pCtrl->commitRate, pCtrl->memHeadroom);
+}
+
+static int64_t vnodeFlowCtrlCredits(SVnodeObj *pVnode, int64_t queuedSize) {
+  SVnodeFlowCtrl *pCtrl = &pVnode->fctrl;
+  int32_t         level = pVnode->flowctrlLevel;
+
+  int64_t target = pCtrl->drainRate * VNODE_FCTRL_QUEUE_MS / 1000;
+  if (level > 0) {
+    // peers keep failing to catch up with data files, shrink the queue so fewer commits happen
+    target >>= MIN(level + 2, 30);
+  } else if (target < VNODE_FCTRL_MIN_CREDIT) {
+    target = VNODE_FCTRL_MIN_CREDIT;
+  }
+  if (target > MAX_QUEUED_MSG_SIZE) target = MAX_QUEUED_MSG_SIZE;
+
+  int64_t credits = target - queuedSize;
+
+  // while commit is running, the vwrite worker blocks once the mem table is full
+  if (pVnode->isCommiting) {
+    int64_t memCredits = pCtrl->memHeadroom - queuedSize;
+    if (memCredits < credits) credits = memCredits;
+  }
+
+  return credits;
+}
+
+static int32_t vnodeFlowCtrlDelay(SVnodeObj *pVnode, int64_t deficit) {
+  SVnodeFlowCtrl *pCtrl = &pVnode->fctrl;
+  int64_t         ms = VNODE_FCTRL_MAX_DELAY;
+
+  if (pVnode->isCommiting && pCtrl->memHeadroom <= pVnode->queuedWMsgSize + deficit) {
+    // memory is released only when commit finishes, estimate by the last commit speed
+    if (pCtrl->commitRate > 0) {
+      ms = pCtrl->commitPending * 1000 / pCtrl->commitRate - (taosGetTimestampMs() - pCtrl->commitStartTs);
+    }
+  } else if (pCtrl->drainRate > 0) {
+    ms = deficit * 1000 / pCtrl->drainRate;
+  }
+
+  if (ms < 1) ms = 1;
+  if (ms > VNODE_FCTRL_MAX_DELAY) ms = VNODE_FCTRL_MAX_DELAY;
+  return (int32_t)ms;
+}
+
+void vnodeFlowCtrlIn(SVnodeObj *pVnode, int32_t len) { atomic_add_fetch_64(&pVnode->fctrl.inBytes, len); }
+
+void vnodeFlowCtrlOut(SVnodeObj *pVnode, int32_t len) {
+  atomic_add_fetch_64(&pVnode->fctrl.outBytes, len);
+  atomic_add_fetch_64(&pVnode->fctrl.commitBytes, len);
+}
+
+void vnodeFlowCtrlStartCommit(SVnodeObj *pVnode) {
+  SVnodeFlowCtrl *pCtrl = &pVnode->fctrl;
+  pCtrl->commitPending = atomic_exchange_64(&pCtrl->commitBytes, 0);
+  pCtrl->commitStartTs = taosGetTimestampMs();
+}
+
+void vnodeFlowCtrlEndCommit(SVnodeObj *pVnode) {
+  SVnodeFlowCtrl *pCtrl = &pVnode->fctrl;
+  if (pCtrl->commitStartTs <= 0) return;
+
+  int64_t elapsed = taosGetTimestampMs() - pCtrl->commitStartTs;
+  if (elapsed <= 0) elapsed = 1;
+
+  int64_t rate = pCtrl->commitPending * 1000 / elapsed;
+  pCtrl->commitRate = (pCtrl->commitRate == 0) ? rate : VNODE_FCTRL_EWMA(pCtrl->commitRate, rate);
+  pCtrl->commitStartTs = 0;
+
+  vDebug("vgId:%d, commit %" PRId64 " bytes in %" PRId64 "ms, commit rate:%" PRId64, pVnode->vgId,
+         pCtrl->commitPending, elapsed, pCtrl->commitRate);
+}
+
+int32_t vnodeFlowCtrlAdmit(SVnodeObj *pVnode, int32_t len) {
+  SVnodeFlowCtrl *pCtrl = &pVnode->fctrl;
+  vnodeFlowCtrlUpdateRate(pVnode);
+
+  int32_t queued = pVnode->queuedWMsg;
+  int64_t queuedSize = pVnode->queuedWMsgSize;
+  int64_t credits = vnodeFlowCtrlCredits(pVnode, queuedSize);
+  pCtrl->allowedBytes = MAX(credits, 0);
+
+  // an empty queue always takes the msg, otherwise no progress can be made
+  bool admit = (queued < MAX_QUEUED_MSG_NUM && len <= credits);
+  if (queued <= 0 && pVnode->flowctrlLevel <= 0) admit = true;
+  if (admit) {
+    pCtrl->retryAfter = 0;
+    return 0;
+  }
+
+  int64_t deficit = len - credits;
+  if (queued >= MAX_QUEUED_MSG_NUM) {
+    int64_t overflow = (queuedSize / queued) * (queued - MAX_QUEUED_MSG_NUM + 1);
+    deficit = MAX(deficit, overflow);
+  }
+
+  int32_t ms = vnodeFlowCtrlDelay(pVnode, deficit);
+  pCtrl->retryAfter = ms;
+  atomic_add_fetch_64(&pCtrl->throttledMsgs, 1);
+
+  return ms;
+}
+
+void vnodeFlowCtrlSetHint(SVnodeObj *pVnode, SShellSubmitRspFlowCtrl *pHint) {
+  SVnodeFlowCtrl *pCtrl = &pVnode->fctrl;
+
+  // refreshed in the vwrite worker, where tsdb is guaranteed to be opened
+  int64_t now = taosGetTimestampMs();
+  if (now - pCtrl->memTs >= VNODE_FCTRL_SAMPLE_MS) {
+    pCtrl->memHeadroom = tsdbGetMemHeadroom(pVnode->tsdb);
+    pCtrl->memTs = now;
+  }
+
+  if (pHint == NULL) return;
+
+  int64_t credits = vnodeFlowCtrlCredits(pVnode, pVnode->queuedWMsgSize);
+  int32_t retryAfter = (credits > 0) ? 0 : vnodeFlowCtrlDelay(pVnode, 1 - credits);
+  if (credits < 0) credits = 0;
+  if (credits > INT32_MAX) credits = INT32_MAX;
+
+  pHint->retryAfter = htonl(retryAfter);
+  pHint->allowedBytes = htonl((int32_t)credits);
+}
+
+int32_t vnodeGetFlowCtrlStat(int32_t vgId, SVnodeFlowCtrlStat *pStat) {
+  SVnodeObj *pVnode = vnodeAcquire(vgId);
+  if (pVnode == NULL) return TSDB_CODE_VND_INVALID_VGROUP_ID;
+
+  SVnodeFlowCtrl *pCtrl = &pVnode->fctrl;
+  vnodeFlowCtrlUpdateRate(pVnode);
+
+  pStat->vgId = pVnode->vgId;
+  pStat->queuedMsgs = pVnode->queuedWMsg;
+  pStat->queuedBytes = pVnode->queuedWMsgSize;
+  pStat->flowctrlLevel = pVnode->flowctrlLevel;
+  pStat->retryAfter = pCtrl->retryAfter;
+  pStat->allowedBytes = pCtrl->allowedBytes;
+  pStat->fillRate = pCtrl->fillRate;
+  pStat->drainRate = pCtrl->drainRate;
+  pStat->commitRate = pCtrl->commitRate;
+  pStat->memHeadroom = pCtrl->memHeadroom;
+  pStat->throttledMsgs = pCtrl->throttledMsgs;
+
+  vnodeRelease(pVnode);
+  return TSDB_CODE_SUCCESS;
+}
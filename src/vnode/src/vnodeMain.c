@@ -28,9 +28,11 @@
 #include "vnodeMgmt.h"
 #include "vnodeWorker.h"
 #include "vnodeBackup.h"
+#include "vnodeFlowCtrl.h"
 #include "vnodeMain.h"
 
 static int32_t vnodeProcessTsdbStatus(void *arg, int32_t status, int32_t eno);
+static int64_t vnodeGetTableLastKey(int32_t vgId, uint64_t uid);
 
 int32_t vnodeCreate(SCreateVnodeMsg *pVnodeCfg) {
   int32_t code;
@@ -307,6 +309,7 @@ int32_t vnodeOpen(int32_t vgId) {
     strcpy(cqCfg.db, pVnode->db);
     cqCfg.vgId = vgId;
     cqCfg.cqWrite = vnodeWriteToCache;
+    cqCfg.cqLastKey = vnodeGetTableLastKey;
     pVnode->cq = cqOpen(pVnode, &cqCfg);
     if (pVnode->cq == NULL) {
       vnodeCleanUp(pVnode);
@@ -320,6 +323,8 @@ int32_t vnodeOpen(int32_t vgId) {
   appH.cqH = pVnode->cq;
   appH.cqCreateFunc = cqCreate;
   appH.cqDropFunc = cqDrop;
+  appH.cqAcceptFunc = cqAccept;
+  appH.cqFeedFunc = cqFeed;
 
   terrno = 0;
   pVnode->tsdb = tsdbOpenRepo(&(pVnode->tsdbCfg), &appH);
@@ -403,6 +408,7 @@ int32_t vnodeOpen(int32_t vgId) {
   syncInfo.getVersionFp = vnodeGetVersion;
   syncInfo.sendFileFp = tsdbSyncSend;
   syncInfo.recvFileFp = tsdbSyncRecv;
+  syncInfo.batchFwds = 1;
   syncInfo.pTsdb = pVnode->tsdb;
   pVnode->sync = syncStart(&syncInfo);
 
@@ -528,6 +534,16 @@ void vnodeCleanUp(SVnodeObj *pVnode) {
   vnodeRelease(pVnode);
 }
 
+static int64_t vnodeGetTableLastKey(int32_t vgId, uint64_t uid) {
+  SVnodeObj *pVnode = vnodeAcquire(vgId);
+  if (pVnode == NULL) return TSKEY_INITIAL_VAL;
+
+  int64_t lastKey = (pVnode->tsdb == NULL) ? TSKEY_INITIAL_VAL : tsdbGetTableLastKey(pVnode->tsdb, uid);
+
+  vnodeRelease(pVnode);
+  return lastKey;
+}
+
 static int32_t vnodeProcessTsdbStatus(void *arg, int32_t status, int32_t eno) {
   SVnodeObj *pVnode = arg;
 
@@ -542,6 +558,7 @@ static int32_t vnodeProcessTsdbStatus(void *arg, int32_t status, int32_t eno) {
   if (status == TSDB_STATUS_COMMIT_START) {
     pVnode->isCommiting = 1;
     pVnode->cversion = pVnode->version;
+    vnodeFlowCtrlStartCommit(pVnode);
     vInfo("vgId:%d, start commit, fver:%" PRIu64 " vver:%" PRIu64, pVnode->vgId, pVnode->fversion, pVnode->version);
     if (!vnodeInInitStatus(pVnode)) {
       return walRenew(pVnode->wal);
@@ -553,6 +570,7 @@ static int32_t vnodeProcessTsdbStatus(void *arg, int32_t status, int32_t eno) {
     pVnode->isCommiting = 0;
     pVnode->isFull = 0;
     pVnode->fversion = pVnode->cversion;
+    vnodeFlowCtrlEndCommit(pVnode);
     vInfo("vgId:%d, commit over, fver:%" PRIu64 " vver:%" PRIu64, pVnode->vgId, pVnode->fversion, pVnode->version);
     if (!vnodeInInitStatus(pVnode)) {
       walRemoveOneOldFile(pVnode->wal);
@@ -16,8 +16,11 @@
 #define _DEFAULT_SOURCE
 #include "os.h"
 #include "dnode.h"
+#include "tmetrics.h"
 #include "vnodeStatus.h"
 #include "vnodeBackup.h"
+#include "vnodeMigrate.h"
+#include "vnodeSub.h"
 #include "vnodeWorker.h"
 #include "vnodeRead.h"
 #include "vnodeWrite.h"
@@ -35,7 +38,9 @@ static SStep tsVnodeSteps[] = {
   {"vnode-write",  vnodeInitWrite,      vnodeCleanupWrite},
   {"vnode-read",   vnodeInitRead,       vnodeCleanupRead},
   {"vnode-hash",   vnodeInitHash,       vnodeCleanupHash},
-  {"tsdb-queue",   tsdbInitCommitQueue, tsdbDestroyCommitQueue}
+  {"tsdb-queue",   tsdbInitCommitQueue, tsdbDestroyCommitQueue},
+  {"vnode-migrate", vnodeInitMigrate,   vnodeCleanupMigrate},
+  {"vnode-sub",    vnodeInitSub,        vnodeCleanupSub}
 };
 
 int32_t vnodeInitMgmt() {
@@ -72,10 +77,12 @@ void *vnodeGetWal(void *pVnode) {
 
 void vnodeAddIntoHash(SVnodeObj *pVnode) {
   taosHashPut(tsVnodesHash, &pVnode->vgId, sizeof(int32_t), &pVnode, sizeof(SVnodeObj *));
+  taosMetricsSetGauge(TSDB_METRIC_VNODES, taosHashGetSize(tsVnodesHash));
 }
 
 void vnodeRemoveFromHash(SVnodeObj *pVnode) { 
   taosHashRemove(tsVnodesHash, &pVnode->vgId, sizeof(int32_t));
+  taosMetricsSetGauge(TSDB_METRIC_VNODES, taosHashGetSize(tsVnodesHash));
 }
 
 static void vnodeIncRef(void *ptNode) {
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tglobal.h"
+#include "vnodeStatus.h"
+#include "vnodeMgmt.h"
+#include "vnodeMigrate.h"
+
+static pthread_t tsVMigrateThread;
+static int8_t    tsVMigrateStop = 0;
+
+static void vnodeMigrateVnode(int32_t vgId) {
+  SVnodeObj *pVnode = vnodeAcquireNotClose(vgId);
+  if (pVnode == NULL) return;
+
+  // file sets are moved one by one, each tsdbMigrate waits for the previous one
+  while (atomic_load_8(&tsVMigrateStop) == 0 && vnodeInReadyStatus(pVnode) && pVnode->tsdb != NULL) {
+    if (tsdbMigrate(pVnode->tsdb) <= 0) break;
+  }
+
+  vnodeRelease(pVnode);
+}
+
+static void *vnodeMigrateFunc(void *param) {
+  int64_t lastTime = taosGetTimestampSec();
+
+  setThreadName("vnodeMigrate");
+
+  while (atomic_load_8(&tsVMigrateStop) == 0) {
+    taosMsleep(1000);
+
+    if (tsMigrateInterval <= 0 || taosGetTimestampSec() - lastTime < tsMigrateInterval) continue;
+    lastTime = taosGetTimestampSec();
+
+    int32_t vnodeList[TSDB_MAX_VNODES] = {0};
+    int32_t numOfVnodes = 0;
+    vnodeGetVnodeList(vnodeList, &numOfVnodes);
+
+    vDebug("start to migrate data files of %d vnodes", numOfVnodes);
+    for (int32_t i = 0; i < numOfVnodes && i < TSDB_MAX_VNODES; ++i) {
+      if (atomic_load_8(&tsVMigrateStop) != 0) break;
+      vnodeMigrateVnode(vnodeList[i]);
+    }
+  }
+
+  return NULL;
+}
+
+int32_t vnodeInitMigrate() {
+  pthread_attr_t thAttr;
+  pthread_attr_init(&thAttr);
+  pthread_attr_setdetachstate(&thAttr, PTHREAD_CREATE_JOINABLE);
+
+  tsVMigrateStop = 0;
+  if (pthread_create(&tsVMigrateThread, &thAttr, vnodeMigrateFunc, NULL) != 0) {
+    vError("failed to create thread to migrate data files, reason:%s", strerror(errno));
+    pthread_attr_destroy(&thAttr);
+    return -1;
+  }
+
+  pthread_attr_destroy(&thAttr);
+  vDebug("vmigrate is initialized, interval:%ds", tsMigrateInterval);
+  return TSDB_CODE_SUCCESS;
+}
+
+void vnodeCleanupMigrate() {
+  atomic_store_8(&tsVMigrateStop, 1);
+  if (taosCheckPthreadValid(tsVMigrateThread)) {
+    pthread_join(tsVMigrateThread, NULL);
+  }
+  vDebug("vmigrate is closed");
+}
@@ -19,7 +19,9 @@
 #include "tqueue.h"
 #include "tglobal.h"
 #include "query.h"
+#include "tmetrics.h"
 #include "vnodeStatus.h"
+#include "vnodeSub.h"
 
 int32_t vNumOfExistedQHandle;   // current initialized and existed query handle in current dnode
 
@@ -32,6 +34,7 @@ static int32_t  vnodeNotifyCurrentQhandle(void* handle, uint64_t qId, void* qhan
 int32_t vnodeInitRead(void) {
   vnodeProcessReadMsgFp[TSDB_MSG_TYPE_QUERY] = vnodeProcessQueryMsg;
   vnodeProcessReadMsgFp[TSDB_MSG_TYPE_FETCH] = vnodeProcessFetchMsg;
+  vnodeProcessReadMsgFp[TSDB_MSG_TYPE_SUB_WAIT] = vnodeProcessSubWaitMsg;
   return 0;
 }
 
@@ -139,7 +142,8 @@ int32_t vnodeWriteToRQueue(void *vparam, void *pCont, int32_t contLen, int8_t qt
 
   atomic_add_fetch_32(&pVnode->queuedRMsg, 1);
 
-  if (pRead->code == TSDB_CODE_RPC_NETWORK_UNAVAIL || pRead->msgType == TSDB_MSG_TYPE_FETCH) {
+  if (pRead->code == TSDB_CODE_RPC_NETWORK_UNAVAIL || pRead->msgType == TSDB_MSG_TYPE_FETCH ||
+      pRead->msgType == TSDB_MSG_TYPE_SUB_WAIT) {
     vTrace("vgId:%d, write into vfetch queue, refCount:%d queued:%d", pVnode->vgId, pVnode->refCount,
            pVnode->queuedRMsg);
     return taosWriteQitem(pVnode->fqueue, qtype, pRead);
@@ -233,7 +237,15 @@ static int32_t vnodeProcessQueryMsg(SVnodeObj *pVnode, SVReadMsg *pRead) {
   if (contLen != 0) {
     qinfo_t pQInfo = NULL;
     uint64_t qId = genQueryId();
-    code = qCreateQueryInfo(pVnode->tsdb, pVnode->vgId, pQueryTableMsg, &pQInfo, qId);
+    taosMetricsInc(TSDB_METRIC_VNODE_QUERIES, 1);
+
+    // running queries are limited per user
+    SRpcConnInfo connInfo = {0};
+    if (pRead->rpcHandle != NULL) {
+      rpcGetConnInfo(pRead->rpcHandle, &connInfo);
+    }
+
+    code = qCreateQueryInfo(pVnode->tsdb, pVnode->vgId, pQueryTableMsg, &pQInfo, qId, connInfo.user);
 
     SQueryTableRsp *pRsp = (SQueryTableRsp *)rpcMallocCont(sizeof(SQueryTableRsp));
     pRsp->code = code;
@@ -293,12 +305,15 @@ static int32_t vnodeProcessQueryMsg(SVnodeObj *pVnode, SVReadMsg *pRead) {
     vTrace("vgId:%d, QInfo:%p, dnode continues to exec query", pVnode->vgId, *qhandle);
 
     // In the retrieve blocking model, only 50% CPU will be used in query processing
+    int64_t start = taosGetTimestampUs();
     if (tsRetrieveBlockingModel) {
       qTableQuery(*qhandle, &qId);  // do execute query
+      taosMetricsObserve(TSDB_METRIC_QUERY_EXEC_US, taosGetTimestampUs() - start);
       qReleaseQInfo(pVnode->qMgmt, (void **)&qhandle, false);
     } else {
       bool freehandle = false;
       bool buildRes = qTableQuery(*qhandle, &qId);  // do execute query
+      taosMetricsObserve(TSDB_METRIC_QUERY_EXEC_US, taosGetTimestampUs() - start);
 
       // build query rsp, the retrieve request has reached here already
       if (buildRes) {
@@ -352,6 +367,7 @@ static int32_t vnodeProcessFetchMsg(SVnodeObj *pVnode, SVReadMsg *pRead) {
          pRetrieve->free, pRead->rpcHandle);
 
   memset(pRet, 0, sizeof(SRspRet));
+  taosMetricsInc(TSDB_METRIC_VNODE_FETCHES, 1);
 
   terrno = TSDB_CODE_SUCCESS;
   int32_t code = TSDB_CODE_SUCCESS;
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "hash.h"
+#include "taosmsg.h"
+#include "tglobal.h"
+#include "vnodeStatus.h"
+#include "vnodeSub.h"
+
+#define VNODE_SUB_MAX_WAIT_TIME 60000  // ms
+
+typedef struct SVSubWaiter {
+  struct SVSubWaiter *next;
+  int32_t             vgId;
+  int8_t              woken;
+  void *              rpcHandle;
+  int64_t             deadline;
+  int32_t             numOfTables;
+  STableIdInfo        tables[];  // sorted by uid
+} SVSubWaiter;
+
+typedef struct {
+  SVSubWaiter *pWaiter;
+  TSKEY        key;  // progress of the subscription on the table
+} SVSubRef;
+
+// waiters of a vnode, indexed by uid so that a submit only looks at the waiters of the tables it writes
+typedef struct {
+  pthread_mutex_t mutex;
+  int32_t         numOfWaiters;
+  SArray *        waiters;  // SVSubWaiter *, scanned for expiration
+  SHashObj *      tables;   // uid -> SArray of SVSubRef
+} SVSubVnode;
+
+static pthread_mutex_t tsVSubMutex;
+static SHashObj *      tsVSubVnodes = NULL;  // vgId -> SVSubVnode *
+static int32_t         tsVSubNum = 0;
+static pthread_t       tsVSubThread;
+static int8_t          tsVSubStop = 0;
+
+static int32_t vnodeCompareSubTable(const void *a, const void *b) {
+  uint64_t x = ((const STableIdInfo *)a)->uid;
+  uint64_t y = ((const STableIdInfo *)b)->uid;
+  if (x == y) return 0;
+  return (x > y) ? 1 : -1;
+}
+
+static void vnodeSendSubWaitRsp(void *rpcHandle, int32_t numOfTables) {
+  SRpcMsg rpcRsp = {.handle = rpcHandle, .code = TSDB_CODE_SUCCESS};
+
+  SSubWaitRsp *pRsp = rpcMallocCont(sizeof(SSubWaitRsp));
+  if (pRsp == NULL) {
+    rpcRsp.code = TSDB_CODE_VND_OUT_OF_MEMORY;
+  } else {
+    pRsp->numOfTables = htonl(numOfTables);
+    rpcRsp.pCont = pRsp;
+    rpcRsp.contLen = sizeof(SSubWaitRsp);
+  }
+
+  rpcSendResponse(&rpcRsp);
+}
+
+// number of tables in the waiter having rows after their progress key
+static int32_t vnodeGetSubChangedTables(STsdbRepo *tsdb, STableIdInfo *tables, int32_t numOfTables) {
+  int32_t changed = 0;
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    if (tsdbGetTableLastKey(tsdb, tables[i].uid) > tables[i].key) changed++;
+  }
+  return changed;
+}
+
+// waiters are answered out of the lock, the write and the sweep threads shall not block on the network
+static void vnodeAnswerSubWaiters(SVSubWaiter *pList, bool changed) {
+  while (pList != NULL) {
+    SVSubWaiter *pWaiter = pList;
+    pList = pList->next;
+
+    vTrace("vgId:%d, sub-wait of %d tables is answered, changed:%d", pWaiter->vgId, pWaiter->numOfTables, changed);
+    vnodeSendSubWaitRsp(pWaiter->rpcHandle, changed ? pWaiter->numOfTables : 0);
+    free(pWaiter);
+  }
+}
+
+static SVSubVnode *vnodeGetSubVnode(int32_t vgId, bool create) {
+  SVSubVnode **ppSub = taosHashGet(tsVSubVnodes, &vgId, sizeof(int32_t));
+  if (ppSub != NULL || !create) return (ppSub == NULL) ? NULL : *ppSub;
+
+  SVSubVnode *pSub = NULL;
+
+  pthread_mutex_lock(&tsVSubMutex);
+  ppSub = taosHashGet(tsVSubVnodes, &vgId, sizeof(int32_t));
+  if (ppSub != NULL) {
+    pSub = *ppSub;
+  } else {
+    pSub = calloc(1, sizeof(SVSubVnode));
+    if (pSub != NULL) {
+      pthread_mutex_init(&pSub->mutex, NULL);
+      pSub->waiters = taosArrayInit(4, POINTER_BYTES);
+      pSub->tables = taosHashInit(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, HASH_NO_LOCK);
+      if (pSub->waiters == NULL || pSub->tables == NULL ||
+          taosHashPut(tsVSubVnodes, &vgId, sizeof(int32_t), &pSub, POINTER_BYTES) != 0) {
+        taosArrayDestroy(pSub->waiters);
+        taosHashCleanup(pSub->tables);
+        pthread_mutex_destroy(&pSub->mutex);
+        tfree(pSub);
+      }
+    }
+  }
+  pthread_mutex_unlock(&tsVSubMutex);
+
+  return pSub;
+}
+
+static void vnodeRemoveSubWaiter(SVSubVnode *pSub, SVSubWaiter *pWaiter) {
+  for (int32_t i = 0; i < pWaiter->numOfTables; ++i) {
+    uint64_t uid = pWaiter->tables[i].uid;
+    SArray **ppRefs = taosHashGet(pSub->tables, &uid, sizeof(uint64_t));
+    if (ppRefs == NULL) continue;
+
+    SArray *pRefs = *ppRefs;
+    for (int32_t j = (int32_t)taosArrayGetSize(pRefs) - 1; j >= 0; --j) {
+      if (((SVSubRef *)taosArrayGet(pRefs, j))->pWaiter == pWaiter) taosArrayRemove(pRefs, j);
+    }
+    if (taosArrayGetSize(pRefs) == 0) {
+      taosHashRemove(pSub->tables, &uid, sizeof(uint64_t));
+      taosArrayDestroy(pRefs);
+    }
+  }
+
+  for (int32_t i = 0; i < taosArrayGetSize(pSub->waiters); ++i) {
+    if (*(SVSubWaiter **)taosArrayGet(pSub->waiters, i) == pWaiter) {
+      taosArrayRemove(pSub->waiters, i);
+      break;
+    }
+  }
+
+  atomic_sub_fetch_32(&pSub->numOfWaiters, 1);
+  atomic_sub_fetch_32(&tsVSubNum, 1);
+}
+
+static int32_t vnodeAddSubWaiter(SVSubVnode *pSub, SVSubWaiter *pWaiter) {
+  if (taosArrayPush(pSub->waiters, &pWaiter) == NULL) return TSDB_CODE_VND_OUT_OF_MEMORY;
+  atomic_add_fetch_32(&pSub->numOfWaiters, 1);
+  atomic_add_fetch_32(&tsVSubNum, 1);
+
+  for (int32_t i = 0; i < pWaiter->numOfTables; ++i) {
+    uint64_t uid = pWaiter->tables[i].uid;
+    SVSubRef ref = {.pWaiter = pWaiter, .key = pWaiter->tables[i].key};
+    SArray * pRefs = NULL;
+
+    SArray **ppRefs = taosHashGet(pSub->tables, &uid, sizeof(uint64_t));
+    if (ppRefs != NULL) {
+      pRefs = *ppRefs;
+    } else {
+      pRefs = taosArrayInit(1, sizeof(SVSubRef));
+      if (pRefs != NULL && taosHashPut(pSub->tables, &uid, sizeof(uint64_t), &pRefs, POINTER_BYTES) != 0) {
+        taosArrayDestroy(pRefs);
+        pRefs = NULL;
+      }
+    }
+
+    if (pRefs == NULL || taosArrayPush(pRefs, &ref) == NULL) {
+      vnodeRemoveSubWaiter(pSub, pWaiter);
+      return TSDB_CODE_VND_OUT_OF_MEMORY;
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t vnodeProcessSubWaitMsg(SVnodeObj *pVnode, SVReadMsg *pRead) {
+  SSubWaitMsg *pMsg = (SSubWaitMsg *)pRead->pCont;
+
+  int32_t waitTime = htonl(pMsg->waitTime);
+  if (waitTime > VNODE_SUB_MAX_WAIT_TIME) waitTime = VNODE_SUB_MAX_WAIT_TIME;
+  int32_t numOfTables = htonl(pMsg->numOfTables);
+  if (numOfTables <= 0 || pRead->contLen < sizeof(SSubWaitMsg) + numOfTables * sizeof(STableIdInfo)) {
+    vError("vgId:%d, invalid sub-wait msg, numOfTables:%d contLen:%d", pVnode->vgId, numOfTables, pRead->contLen);
+    return TSDB_CODE_QRY_INVALID_MSG;
+  }
+
+  if (pVnode->tsdb == NULL) return TSDB_CODE_APP_NOT_READY;
+
+  SVSubVnode *pSub = vnodeGetSubVnode(pVnode->vgId, true);
+  if (pSub == NULL) return TSDB_CODE_VND_OUT_OF_MEMORY;
+
+  SVSubWaiter *pWaiter = malloc(sizeof(SVSubWaiter) + numOfTables * sizeof(STableIdInfo));
+  if (pWaiter == NULL) return TSDB_CODE_VND_OUT_OF_MEMORY;
+
+  pWaiter->next = NULL;
+  pWaiter->vgId = pVnode->vgId;
+  pWaiter->woken = 0;
+  pWaiter->rpcHandle = pRead->rpcHandle;
+  pWaiter->deadline = taosGetTimestampMs() + waitTime;
+  pWaiter->numOfTables = numOfTables;
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    pWaiter->tables[i].uid = htobe64(pMsg->tables[i].uid);
+    pWaiter->tables[i].tid = htonl(pMsg->tables[i].tid);
+    pWaiter->tables[i].key = htobe64(pMsg->tables[i].key);
+  }
+  qsort(pWaiter->tables, numOfTables, sizeof(STableIdInfo), vnodeCompareSubTable);
+
+  // the check and the registration are atomic to the write path, rows inserted after the check wake the waiter
+  pthread_mutex_lock(&pSub->mutex);
+  int32_t changed = vnodeGetSubChangedTables(pVnode->tsdb, pWaiter->tables, numOfTables);
+  if (changed == 0 && waitTime > 0 && atomic_load_8(&tsVSubStop) == 0) {
+    int32_t code = vnodeAddSubWaiter(pSub, pWaiter);
+    pthread_mutex_unlock(&pSub->mutex);
+    if (code != TSDB_CODE_SUCCESS) {
+      free(pWaiter);
+      return code;
+    }
+
+    vTrace("vgId:%d, sub-wait of %d tables is parked, waitTime:%d", pVnode->vgId, numOfTables, waitTime);
+    return TSDB_CODE_QRY_NOT_READY;
+  }
+  pthread_mutex_unlock(&pSub->mutex);
+  free(pWaiter);
+
+  SSubWaitRsp *pRsp = rpcMallocCont(sizeof(SSubWaitRsp));
+  if (pRsp == NULL) return TSDB_CODE_VND_OUT_OF_MEMORY;
+
+  pRsp->numOfTables = htonl(changed);
+  pRead->rspRet.rsp = pRsp;
+  pRead->rspRet.len = sizeof(SSubWaitRsp);
+  return TSDB_CODE_SUCCESS;
+}
+
+void vnodeNotifySubWaiters(SVnodeObj *pVnode, SSubmitMsg *pMsg) {
+  if (atomic_load_32(&tsVSubNum) == 0) return;
+
+  SVSubVnode *pSub = vnodeGetSubVnode(pVnode->vgId, false);
+  if (pSub == NULL || atomic_load_32(&pSub->numOfWaiters) == 0) return;
+
+  SVSubWaiter *pWoken = NULL;
+
+  pthread_mutex_lock(&pSub->mutex);
+  // the submit msg is already converted to host order by tsdb
+  SSubmitBlk *pBlock = (SSubmitBlk *)pMsg->blocks;
+  for (int32_t i = 0; i < pMsg->numOfBlocks; ++i) {
+    SArray **ppRefs = taosHashGet(pSub->tables, &pBlock->uid, sizeof(uint64_t));
+    if (ppRefs != NULL) {
+      TSKEY lastKey = tsdbGetTableLastKey(pVnode->tsdb, pBlock->uid);
+      for (int32_t j = 0; j < taosArrayGetSize(*ppRefs); ++j) {
+        SVSubRef *pRef = taosArrayGet(*ppRefs, j);
+        if (pRef->pWaiter->woken || lastKey <= pRef->key) continue;
+
+        pRef->pWaiter->woken = 1;
+        pRef->pWaiter->next = pWoken;
+        pWoken = pRef->pWaiter;
+      }
+    }
+    pBlock = (SSubmitBlk *)POINTER_SHIFT(pBlock, sizeof(SSubmitBlk) + pBlock->schemaLen + pBlock->dataLen);
+  }
+
+  for (SVSubWaiter *pWaiter = pWoken; pWaiter != NULL; pWaiter = pWaiter->next) {
+    vnodeRemoveSubWaiter(pSub, pWaiter);
+  }
+  pthread_mutex_unlock(&pSub->mutex);
+
+  vnodeAnswerSubWaiters(pWoken, true);
+}
+
+static void *vnodeSubFunc(void *param) {
+  setThreadName("vnodeSub");
+
+  while (atomic_load_8(&tsVSubStop) == 0) {
+    taosMsleep(100);
+    if (atomic_load_32(&tsVSubNum) == 0) continue;
+
+    SVSubWaiter *pExpired = NULL;
+    int64_t      now = taosGetTimestampMs();
+
+    void *pIter = taosHashIterate(tsVSubVnodes, NULL);
+    while (pIter != NULL) {
+      SVSubVnode *pSub = *(SVSubVnode **)pIter;
+      pIter = taosHashIterate(tsVSubVnodes, pIter);
+      if (atomic_load_32(&pSub->numOfWaiters) == 0) continue;
+
+      pthread_mutex_lock(&pSub->mutex);
+      for (int32_t i = (int32_t)taosArrayGetSize(pSub->waiters) - 1; i >= 0; --i) {
+        SVSubWaiter *pWaiter = *(SVSubWaiter **)taosArrayGet(pSub->waiters, i);
+        if (pWaiter->deadline <= now) {
+          vnodeRemoveSubWaiter(pSub, pWaiter);
+          pWaiter->next = pExpired;
+          pExpired = pWaiter;
+        }
+      }
+      pthread_mutex_unlock(&pSub->mutex);
+    }
+
+    vnodeAnswerSubWaiters(pExpired, false);
+  }
+
+  return NULL;
+}
+
+int32_t vnodeInitSub() {
+  pthread_mutex_init(&tsVSubMutex, NULL);
+  tsVSubVnodes = taosHashInit(TSDB_MIN_VNODES, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, HASH_ENTRY_LOCK);
+  if (tsVSubVnodes == NULL) {
+    vError("failed to init vsub hash");
+    return TSDB_CODE_VND_OUT_OF_MEMORY;
+  }
+
+  pthread_attr_t thAttr;
+  pthread_attr_init(&thAttr);
+  pthread_attr_setdetachstate(&thAttr, PTHREAD_CREATE_JOINABLE);
+
+  tsVSubStop = 0;
+  if (pthread_create(&tsVSubThread, &thAttr, vnodeSubFunc, NULL) != 0) {
+    vError("failed to create thread to expire subscription waits, reason:%s", strerror(errno));
+    pthread_attr_destroy(&thAttr);
+    return -1;
+  }
+
+  pthread_attr_destroy(&thAttr);
+  vDebug("vsub is initialized");
+  return TSDB_CODE_SUCCESS;
+}
+
+void vnodeCleanupSub() {
+  atomic_store_8(&tsVSubStop, 1);
+  if (taosCheckPthreadValid(tsVSubThread)) {
+    pthread_join(tsVSubThread, NULL);
+  }
+
+  if (tsVSubVnodes == NULL) return;
+
+  // the rpc is going away with the dnode, the parked waits are dropped without answers
+  void *pIter = taosHashIterate(tsVSubVnodes, NULL);
+  while (pIter != NULL) {
+    SVSubVnode *pSub = *(SVSubVnode **)pIter;
+    pIter = taosHashIterate(tsVSubVnodes, pIter);
+
+    for (int32_t i = 0; i < taosArrayGetSize(pSub->waiters); ++i) {
+      free(*(SVSubWaiter **)taosArrayGet(pSub->waiters, i));
+    }
+    taosArrayDestroy(pSub->waiters);
+
+    void *pTableIter = taosHashIterate(pSub->tables, NULL);
+    while (pTableIter != NULL) {
+      taosArrayDestroy(*(SArray **)pTableIter);
+      pTableIter = taosHashIterate(pSub->tables, pTableIter);
+    }
+    taosHashCleanup(pSub->tables);
+
+    pthread_mutex_destroy(&pSub->mutex);
+    free(pSub);
+  }
+  taosHashCleanup(tsVSubVnodes);
+  tsVSubVnodes = NULL;
+  tsVSubNum = 0;
+
+  pthread_mutex_destroy(&tsVSubMutex);
+  vDebug("vsub is closed");
+}
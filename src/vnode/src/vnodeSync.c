@@ -178,3 +178,8 @@ void vnodeConfirmForward(void *vparam, uint64_t version, int32_t code, bool forc
   SVnodeObj *pVnode = vparam;
   syncConfirmForward(pVnode->sync, version, code, force);
 }
+
+void vnodeFlushForwards(void *vparam) {
+  SVnodeObj *pVnode = vparam;
+  syncFlushForwards(pVnode->sync);
+}
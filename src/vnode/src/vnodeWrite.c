@@ -22,10 +22,10 @@
 #include "tqueue.h"
 #include "ttimer.h"
 #include "dnode.h"
+#include "tmetrics.h"
 #include "vnodeStatus.h"
-
-#define MAX_QUEUED_MSG_NUM 100000
-#define MAX_QUEUED_MSG_SIZE 1024*1024*1024  //1GB
+#include "vnodeFlowCtrl.h"
+#include "vnodeSub.h"
 
 extern void *  tsDnodeTmr;
 static int32_t (*vnodeProcessWriteMsgFp[TSDB_MSG_TYPE_MAX])(SVnodeObj *, void *pCont, SRspRet *);
@@ -89,6 +89,7 @@ int32_t vnodeProcessWrite(void *vparam, void *wparam, int32_t qtype, void *rpara
   }
 
   // forward to peers, even it is WAL/FWD, it shall be called to update version in sync
+  int64_t start = taosGetTimestampUs();
   int32_t syncCode = 0;
   bool    force = (pWrite == NULL ? false : pWrite->walHead.msgType != TSDB_MSG_TYPE_SUBMIT);
   syncCode = syncForwardToPeer(pVnode->sync, pHead, pWrite, qtype, force);
@@ -115,6 +116,8 @@ int32_t vnodeProcessWrite(void *vparam, void *wparam, int32_t qtype, void *rpara
     return code;
   }
 
+  taosMetricsInc(TSDB_METRIC_VNODE_WRITES, 1);
+  taosMetricsObserve(TSDB_METRIC_VNODE_WRITE_US, taosGetTimestampUs() - start);
   return syncCode;
 }
 
@@ -156,13 +159,21 @@ static int32_t vnodeProcessSubmitMsg(SVnodeObj *pVnode, void *pCont, SRspRet *pR
 
   // save insert result into item
   SShellSubmitRspMsg *pRsp = NULL;
+  SShellSubmitRspFlowCtrl *pHint = NULL;
   if (pRet) {
-    pRet->len = sizeof(SShellSubmitRspMsg);
+    pRet->len = sizeof(SShellSubmitRspMsg) + sizeof(SShellSubmitRspFlowCtrl);
     pRet->rsp = rpcMallocCont(pRet->len);
     pRsp = pRet->rsp;
+    pHint = POINTER_SHIFT(pRsp, sizeof(SShellSubmitRspMsg));
+  }
+
+  if (tsdbInsertData(pVnode->tsdb, pCont, pRsp) < 0) {
+    code = terrno;
+  } else {
+    vnodeNotifySubWaiters(pVnode, pCont);
   }
 
-  if (tsdbInsertData(pVnode->tsdb, pCont, pRsp) < 0) code = terrno;
+  vnodeFlowCtrlSetHint(pVnode, pHint);
 
   return code;
 }
@@ -287,6 +298,7 @@ static int32_t vnodeWriteToWQueueImp(SVWriteMsg *pWrite) {
 
   int32_t queued = atomic_add_fetch_32(&pVnode->queuedWMsg, 1);
   int64_t queuedSize = atomic_add_fetch_64(&pVnode->queuedWMsgSize, pWrite->walHead.len);
+  vnodeFlowCtrlIn(pVnode, pWrite->walHead.len);
 
   if (queued > MAX_QUEUED_MSG_NUM || queuedSize > MAX_QUEUED_MSG_SIZE) {
     int32_t ms = (queued / MAX_QUEUED_MSG_NUM) * 10 + 3;
@@ -331,6 +343,7 @@ void vnodeFreeFromWQueue(void *vparam, SVWriteMsg *pWrite) {
   if (pVnode) {
     int32_t queued = atomic_sub_fetch_32(&pVnode->queuedWMsg, 1);
     int64_t queuedSize = atomic_sub_fetch_64(&pVnode->queuedWMsgSize, pWrite->walHead.len);
+    vnodeFlowCtrlOut(pVnode, pWrite->walHead.len);
 
     vTrace("vgId:%d, msg:%p, app:%p, free from vwqueue, queued:%d size:%" PRId64, pVnode->vgId, pWrite,
            pWrite->rpcMsg.ahandle, queued, queuedSize);
@@ -347,9 +360,9 @@ static void vnodeFlowCtrlMsgToWQueue(void *param, void *tmrId) {
 
   if (pVnode->flowctrlLevel <= 0) code = TSDB_CODE_VND_IS_FLOWCTRL;
 
-  pWrite->processedCount++;
-  if (pWrite->processedCount >= 100) {
-    vError("vgId:%d, msg:%p, failed to process since %s, retry:%d", pVnode->vgId, pWrite, tstrerror(code),
+  // processedCount keeps the ms waited in flow control until the msg is put into vwqueue
+  if (pWrite->processedCount >= VNODE_FCTRL_MAX_WAIT) {
+    vError("vgId:%d, msg:%p, failed to process since %s, waited:%dms", pVnode->vgId, pWrite, tstrerror(code),
            pWrite->processedCount);
     void *handle = pWrite->rpcMsg.handle;
     taosFreeQitem(pWrite);
@@ -359,7 +372,7 @@ static void vnodeFlowCtrlMsgToWQueue(void *param, void *tmrId) {
   } else {
     code = vnodePerformFlowCtrl(pWrite);
     if (code == 0) {
-      vDebug("vgId:%d, msg:%p, write into vwqueue after flowctrl, retry:%d", pVnode->vgId, pWrite,
+      vDebug("vgId:%d, msg:%p, write into vwqueue after flowctrl, waited:%dms", pVnode->vgId, pWrite,
              pWrite->processedCount);
       pWrite->processedCount = 0;
       void *handle = pWrite->rpcMsg.handle;
@@ -375,22 +388,21 @@ static void vnodeFlowCtrlMsgToWQueue(void *param, void *tmrId) {
 static int32_t vnodePerformFlowCtrl(SVWriteMsg *pWrite) {
   SVnodeObj *pVnode = pWrite->pVnode;
   if (pWrite->qtype != TAOS_QTYPE_RPC) return 0;
-  if (pVnode->queuedWMsg < MAX_QUEUED_MSG_NUM && pVnode->queuedWMsgSize < MAX_QUEUED_MSG_SIZE &&
-      pVnode->flowctrlLevel <= 0)
-    return 0;
+
+  int32_t ms = vnodeFlowCtrlAdmit(pVnode, pWrite->walHead.len);
+  if (ms <= 0) return 0;
 
   if (tsEnableFlowCtrl == 0) {
-    int32_t ms = (int32_t)pow(2, pVnode->flowctrlLevel + 2);
-    if (ms > 100) ms = 100;
     vTrace("vgId:%d, msg:%p, app:%p, perform flowctrl for %d ms", pVnode->vgId, pWrite, pWrite->rpcMsg.ahandle, ms);
     taosMsleep(ms);
     return 0;
   } else {
     void *unUsedTimerId = NULL;
-    taosTmrReset(vnodeFlowCtrlMsgToWQueue, 100, pWrite, tsDnodeTmr, &unUsedTimerId);
+    pWrite->processedCount += ms;
+    taosTmrReset(vnodeFlowCtrlMsgToWQueue, ms, pWrite, tsDnodeTmr, &unUsedTimerId);
 
-    vTrace("vgId:%d, msg:%p, app:%p, perform flowctrl, retry:%d", pVnode->vgId, pWrite, pWrite->rpcMsg.ahandle,
-           pWrite->processedCount);
+    vTrace("vgId:%d, msg:%p, app:%p, perform flowctrl for %d ms, waited:%dms", pVnode->vgId, pWrite,
+           pWrite->rpcMsg.ahandle, ms, pWrite->processedCount);
     return TSDB_CODE_VND_ACTION_IN_PROGRESS;
   }
 }
@@ -40,6 +40,10 @@ extern int32_t wDebugFlag;
 #define WAL_FILE_LEN   (WAL_PATH_LEN + 32)
 #define WAL_FILE_NUM   1 // 3
 
+#define WAL_RESTORE_PIPELINE_SIZE (1024 * 1024)   // files smaller than this are restored serially
+#define WAL_RESTORE_QUEUE_SIZE    (WAL_MAX_SIZE * 4)
+#define WAL_RESTORE_REPORT_MS     5000
+
 typedef struct {
   uint64_t version;
   int64_t  fileId;
@@ -20,6 +20,7 @@
 #include "taosmsg.h"
 #include "tchecksum.h"
 #include "tfile.h"
+#include "tmetrics.h"
 #include "twal.h"
 #include "walInt.h"
 
@@ -168,6 +169,11 @@ int32_t walWrite(void *handle, SWalHead *pHead) {
 
   pthread_mutex_unlock(&pWal->mutex);
 
+  if (code == 0) {
+    taosMetricsInc(TSDB_METRIC_WAL_WRITES, 1);
+    taosMetricsInc(TSDB_METRIC_WAL_BYTES, contLen);
+  }
+
   ASSERT(contLen == pHead->len + sizeof(SWalHead));
 
   return code;
@@ -179,9 +185,11 @@ void walFsync(void *handle, bool forceFsync) {
 
   if (forceFsync || (pWal->level == TAOS_WAL_FSYNC && pWal->fsyncPeriod == 0)) {
     wTrace("vgId:%d, fileId:%" PRId64 ", do fsync", pWal->vgId, pWal->fileId);
+    int64_t start = taosGetTimestampUs();
     if (tfFsync(pWal->tfd) < 0) {
       wError("vgId:%d, fileId:%" PRId64 ", fsync failed since %s", pWal->vgId, pWal->fileId, strerror(errno));
     }
+    taosMetricsObserve(TSDB_METRIC_WAL_FSYNC_US, taosGetTimestampUs() - start);
   }
 }
 
@@ -417,145 +425,300 @@ static int walSMemRowCheck(SWalHead *pHead) {
   return 0;
 }
 
-static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, char *name, int64_t fileId) {
-  int32_t size = WAL_MAX_SIZE;
-  void *  buffer = tmalloc(size);
-  if (buffer == NULL) {
-    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
-    return TAOS_SYSTEM_ERROR(errno);
-  }
-
-  int64_t tfd = tfOpen(name, O_RDWR);
-  if (!tfValid(tfd)) {
-    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
-    tfree(buffer);
-    return TAOS_SYSTEM_ERROR(errno);
-  } else {
-    wDebug("vgId:%d, file:%s, open for restore", pWal->vgId, name);
-  }
-
+// A wal file is restored by a reader, which reads, validates and converts the records, and an applier, which hands
+// them to the vnode in order. For large files the reader runs in its own thread and passes the records through a
+// bounded queue, so decoding and checksum overlaps with inserting into the memtable.
+typedef struct SWalRecord {
+  struct SWalRecord *next;
+  int64_t            offset;
+  SWalHead *         pHead;
+} SWalRecord;
+
+typedef struct {
+  SWal *          pWal;
+  char *          name;
+  int64_t         fileId;
+  int64_t         tfd;
+  int64_t         offset;
+  int64_t         fsize;
+  int32_t         code;
+  int8_t          eof;
+  SWalHead *      pHead;
+  pthread_mutex_t mutex;
+  pthread_cond_t  notEmpty;
+  pthread_cond_t  notFull;
+  SWalRecord *    qHead;
+  SWalRecord *    qTail;
+  int64_t         qBytes;
+} SWalReader;
+
+// Read the next valid record into pReader->pHead, return false at the end of file or on error saved in pReader->code
+static bool walReadRecord(SWalReader *pReader) {
+  SWal *    pWal = pReader->pWal;
+  char *    name = pReader->name;
+  int64_t   tfd = pReader->tfd;
+  int32_t   size = WAL_MAX_SIZE;
+  SWalHead *pHead = pReader->pHead;
   int32_t   code = TSDB_CODE_SUCCESS;
-  int64_t   offset = 0;
-  SWalHead *pHead = buffer;
 
   while (1) {
     int32_t ret = (int32_t)tfRead(tfd, pHead, sizeof(SWalHead));
-    if (ret == 0) break;
+    if (ret == 0) return false;
 
     if (ret < 0) {
       wError("vgId:%d, file:%s, failed to read wal head since %s", pWal->vgId, name, strerror(errno));
-      code = TAOS_SYSTEM_ERROR(errno);
-      break;
+      pReader->code = TAOS_SYSTEM_ERROR(errno);
+      return false;
     }
 
     if (ret < sizeof(SWalHead)) {
       wError("vgId:%d, file:%s, failed to read wal head, ret is %d", pWal->vgId, name, ret);
-      walFtruncate(pWal, tfd, offset);
-      break;
+      walFtruncate(pWal, tfd, pReader->offset);
+      return false;
     }
 
 #if defined(WAL_CHECKSUM_WHOLE)
     if ((pHead->sver == 0 && !walValidateChecksum(pHead)) || pHead->sver < 0 || pHead->sver > 2) {
       wError("vgId:%d, file:%s, wal head cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
+             pHead->version, pHead->len, pReader->offset);
+      code = walSkipCorruptedRecord(pWal, pHead, tfd, &pReader->offset);
       if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+        pReader->code = code;
+        walFtruncate(pWal, tfd, pReader->offset);
+        return false;
       }
     }
 
     if (pHead->len < 0 || pHead->len > size - sizeof(SWalHead)) {
       wError("vgId:%d, file:%s, wal head len out of range, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
+             pHead->version, pHead->len, pReader->offset);
+      code = walSkipCorruptedRecord(pWal, pHead, tfd, &pReader->offset);
       if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+        pReader->code = code;
+        walFtruncate(pWal, tfd, pReader->offset);
+        return false;
       }
     }
 
     ret = (int32_t)tfRead(tfd, pHead->cont, pHead->len);
     if (ret < 0) {
       wError("vgId:%d, file:%s, failed to read wal body since %s", pWal->vgId, name, strerror(errno));
-      code = TAOS_SYSTEM_ERROR(errno);
-      break;
+      pReader->code = TAOS_SYSTEM_ERROR(errno);
+      return false;
     }
 
     if (ret < pHead->len) {
       wError("vgId:%d, file:%s, failed to read wal body, ret:%d len:%d", pWal->vgId, name, ret, pHead->len);
-      offset += sizeof(SWalHead);
+      pReader->offset += sizeof(SWalHead);
       continue;
     }
 
     if ((pHead->sver >= 1) && !walValidateChecksum(pHead)) {
       wError("vgId:%d, file:%s, wal whole cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
+             pHead->version, pHead->len, pReader->offset);
+      code = walSkipCorruptedRecord(pWal, pHead, tfd, &pReader->offset);
       if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+        pReader->code = code;
+        walFtruncate(pWal, tfd, pReader->offset);
+        return false;
       }
     }
 
 #else
     if (!taosCheckChecksumWhole((uint8_t *)pHead, sizeof(SWalHead))) {
       wError("vgId:%d, file:%s, wal head cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
+             pHead->version, pHead->len, pReader->offset);
+      code = walSkipCorruptedRecord(pWal, pHead, tfd, &pReader->offset);
       if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+        pReader->code = code;
+        walFtruncate(pWal, tfd, pReader->offset);
+        return false;
       }
     }
 
     if (pHead->len < 0 || pHead->len > size - sizeof(SWalHead)) {
       wError("vgId:%d, file:%s, wal head len out of range, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
+             pHead->version, pHead->len, pReader->offset);
+      code = walSkipCorruptedRecord(pWal, pHead, tfd, &pReader->offset);
       if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+        pReader->code = code;
+        walFtruncate(pWal, tfd, pReader->offset);
+        return false;
       }
     }
 
     ret = (int32_t)tfRead(tfd, pHead->cont, pHead->len);
     if (ret < 0) {
       wError("vgId:%d, file:%s, failed to read wal body since %s", pWal->vgId, name, strerror(errno));
-      code = TAOS_SYSTEM_ERROR(errno);
-      break;
+      pReader->code = TAOS_SYSTEM_ERROR(errno);
+      return false;
     }
 
     if (ret < pHead->len) {
       wError("vgId:%d, file:%s, failed to read wal body, ret:%d len:%d", pWal->vgId, name, ret, pHead->len);
-      offset += sizeof(SWalHead);
+      pReader->offset += sizeof(SWalHead);
       continue;
     }
 
 #endif
-    offset = offset + sizeof(SWalHead) + pHead->len;
+    pReader->offset = pReader->offset + sizeof(SWalHead) + pHead->len;
 
-    wTrace("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " wver:%" PRIu64 " len:%d offset:%" PRId64,
-           pWal->vgId, fileId, pHead->version, pWal->version, pHead->len, offset);
+    wTrace("vgId:%d, read wal, fileId:%" PRId64 " hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId,
+           pReader->fileId, pHead->version, pHead->len, pReader->offset);
 
-    pWal->version = pHead->version;
-
-    // wInfo("writeFp: %ld", offset);
     if (0 != walSMemRowCheck(pHead)) {
-      wError("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " wver:%" PRIu64 " len:%d offset:%" PRId64,
-             pWal->vgId, fileId, pHead->version, pWal->version, pHead->len, offset);
-      tfClose(tfd);
-      tfree(buffer);
-      return TAOS_SYSTEM_ERROR(errno);
+      wError("vgId:%d, read wal, fileId:%" PRId64 " hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId,
+             pReader->fileId, pHead->version, pHead->len, pReader->offset);
+      pReader->code = TAOS_SYSTEM_ERROR(errno);
+      return false;
+    }
+
+    return true;
+  }
+}
+
+static void *walReadRecordsFp(void *param) {
+  SWalReader *pReader = param;
+  setThreadName("walRestore");
+
+  while (walReadRecord(pReader)) {
+    int32_t     len = (int32_t)sizeof(SWalHead) + pReader->pHead->len;
+    SWalRecord *pRecord = malloc(sizeof(SWalRecord) + len);
+    if (pRecord == NULL) {
+      pReader->code = TAOS_SYSTEM_ERROR(errno);
+      break;
+    }
+
+    pRecord->next = NULL;
+    pRecord->offset = pReader->offset;
+    pRecord->pHead = POINTER_SHIFT(pRecord, sizeof(SWalRecord));
+    memcpy(pRecord->pHead, pReader->pHead, len);
+
+    pthread_mutex_lock(&pReader->mutex);
+    while (pReader->qBytes >= WAL_RESTORE_QUEUE_SIZE) {
+      pthread_cond_wait(&pReader->notFull, &pReader->mutex);
+    }
+    if (pReader->qTail == NULL) {
+      pReader->qHead = pRecord;
+    } else {
+      pReader->qTail->next = pRecord;
     }
-    (*writeFp)(pVnode, pHead, TAOS_QTYPE_WAL, NULL);
+    pReader->qTail = pRecord;
+    pReader->qBytes += len;
+    pthread_cond_signal(&pReader->notEmpty);
+    pthread_mutex_unlock(&pReader->mutex);
   }
 
-  tfClose(tfd);
-  tfree(buffer);
+  pthread_mutex_lock(&pReader->mutex);
+  pReader->eof = 1;
+  pthread_cond_signal(&pReader->notEmpty);
+  pthread_mutex_unlock(&pReader->mutex);
+
+  return NULL;
+}
+
+static SWalRecord *walPopRecord(SWalReader *pReader) {
+  pthread_mutex_lock(&pReader->mutex);
+  while (pReader->qHead == NULL && !pReader->eof) {
+    pthread_cond_wait(&pReader->notEmpty, &pReader->mutex);
+  }
+
+  SWalRecord *pRecord = pReader->qHead;
+  if (pRecord != NULL) {
+    pReader->qHead = pRecord->next;
+    if (pReader->qHead == NULL) pReader->qTail = NULL;
+    pReader->qBytes -= sizeof(SWalHead) + pRecord->pHead->len;
+    pthread_cond_signal(&pReader->notFull);
+  }
+  pthread_mutex_unlock(&pReader->mutex);
+
+  return pRecord;
+}
+
+static void walApplyRecord(SWalReader *pReader, void *pVnode, FWalWrite writeFp, SWalHead *pHead, int64_t offset,
+                           int64_t *reportTime) {
+  SWal *pWal = pReader->pWal;
+
+  wTrace("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " wver:%" PRIu64 " len:%d offset:%" PRId64,
+         pWal->vgId, pReader->fileId, pHead->version, pWal->version, pHead->len, offset);
+
+  pWal->version = pHead->version;
+  (*writeFp)(pVnode, pHead, TAOS_QTYPE_WAL, NULL);
+
+  int64_t now = taosGetTimestampMs();
+  if (now - *reportTime >= WAL_RESTORE_REPORT_MS) {
+    *reportTime = now;
+    wInfo("vgId:%d, file:%s, %" PRId64 " of %" PRId64 " bytes restored, wver:%" PRIu64, pWal->vgId, pReader->name,
+          offset, pReader->fsize, pWal->version);
+  }
+}
+
+static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, char *name, int64_t fileId) {
+  SWalReader reader = {.pWal = pWal, .name = name, .fileId = fileId};
+
+  reader.pHead = tmalloc(WAL_MAX_SIZE);
+  if (reader.pHead == NULL) {
+    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  reader.tfd = tfOpen(name, O_RDWR);
+  if (!tfValid(reader.tfd)) {
+    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
+    tfree(reader.pHead);
+    return TAOS_SYSTEM_ERROR(errno);
+  } else {
+    wDebug("vgId:%d, file:%s, open for restore", pWal->vgId, name);
+  }
+
+  reader.fsize = tfLseek(reader.tfd, 0, SEEK_END);
+  tfLseek(reader.tfd, 0, SEEK_SET);
+
+  bool      pipelined = false;
+  int64_t   reportTime = taosGetTimestampMs();
+  pthread_t thread;
+  if (reader.fsize >= WAL_RESTORE_PIPELINE_SIZE) {
+    pthread_mutex_init(&reader.mutex, NULL);
+    pthread_cond_init(&reader.notEmpty, NULL);
+    pthread_cond_init(&reader.notFull, NULL);
+
+    pthread_attr_t thattr;
+    pthread_attr_init(&thattr);
+    pthread_attr_setdetachstate(&thattr, PTHREAD_CREATE_JOINABLE);
+    if (pthread_create(&thread, &thattr, walReadRecordsFp, &reader) == 0) {
+      pipelined = true;
+    } else {
+      wWarn("vgId:%d, file:%s, failed to create read thread since %s, restore it serially", pWal->vgId, name,
+            strerror(errno));
+      pthread_cond_destroy(&reader.notFull);
+      pthread_cond_destroy(&reader.notEmpty);
+      pthread_mutex_destroy(&reader.mutex);
+    }
+    pthread_attr_destroy(&thattr);
+  }
+
+  if (pipelined) {
+    SWalRecord *pRecord = NULL;
+    while ((pRecord = walPopRecord(&reader)) != NULL) {
+      walApplyRecord(&reader, pVnode, writeFp, pRecord->pHead, pRecord->offset, &reportTime);
+      free(pRecord);
+    }
+
+    pthread_join(thread, NULL);
+    pthread_cond_destroy(&reader.notFull);
+    pthread_cond_destroy(&reader.notEmpty);
+    pthread_mutex_destroy(&reader.mutex);
+  } else {
+    while (walReadRecord(&reader)) {
+      walApplyRecord(&reader, pVnode, writeFp, reader.pHead, reader.offset, &reportTime);
+    }
+  }
+
+  tfClose(reader.tfd);
+  tfree(reader.pHead);
 
   wDebug("vgId:%d, file:%s, it is closed after restore", pWal->vgId, name);
-  return code;
+  return reader.code;
 }
 
 uint64_t walGetVersion(twalh param) {
@@ -17,6 +17,7 @@ python3 ./test.py -f insert/nchar.py
 python3 ./test.py -f insert/nchar-unicode.py
 python3 ./test.py -f insert/multi.py
 python3 ./test.py -f insert/randomNullCommit.py
+python3 ./test.py -f insert/columnarSubmit.py
 python3 insert/retentionpolicy.py
 python3 ./test.py -f insert/alterTableAndInsert.py
 python3 ./test.py -f insert/insertIntoTwoTables.py
@@ -162,6 +163,7 @@ python3 ./test.py -f update/merge_commit_data.py
 # tools
 python3 test.py -f tools/taosdumpTest.py
 python3 test.py -f tools/taosdumpTest2.py
+python3 test.py -f tools/taosdumpBinaryTest.py
 
 python3 test.py -f tools/taosdemoTest.py
 python3 test.py -f tools/taosdemoTestWithoutMetric.py
@@ -175,6 +177,8 @@ python3 test.py -f tools/taosdemoTestQuery.py
 # restful test for python
 python3 test.py -f restful/restful_bind_db1.py
 python3 test.py -f restful/restful_bind_db2.py
+python3 test.py -f restful/restful_block.py
+python3 test.py -f restful/restful_pipeline.py
 
 # nano support
 python3 test.py -f tools/taosdemoAllTest/NanoTestCase/taosdemoTestSupportNanoInsert.py
@@ -285,6 +289,7 @@ python3 ./test.py -f stream/history.py
 python3 ./test.py -f stream/sys.py
 python3 ./test.py -f stream/table_1.py
 python3 ./test.py -f stream/table_n.py
+python3 ./test.py -f stream/incremental.py
 python3 ./test.py -f stream/showStreamExecTimeisNull.py
 python3 ./test.py -f stream/cqSupportBefore1970.py
 
@@ -309,11 +314,14 @@ python3 queryCount.py
 python3 ./test.py -f query/queryGroupbyWithInterval.py
 python3 client/twoClients.py
 python3 test.py -f query/queryInterval.py
+python3 test.py -f query/rollupInterval.py
+python3 test.py -f query/stableOrderLimit.py
 python3 test.py -f query/queryFillTest.py
 # subscribe
 python3 test.py -f subscribe/singlemeter.py
 #python3 test.py -f subscribe/stability.py  
 python3 test.py -f subscribe/supertable.py
+python3 test.py -f subscribe/asyncwait.py
 # topic
 python3 ./test.py -f topic/topicQuery.py
 #======================p3-end===============
@@ -352,6 +360,7 @@ python3 ./test.py -f functions/function_interp.py
 python3 ./test.py -f insert/metadataUpdate.py
 python3 ./test.py -f query/last_cache.py
 python3 ./test.py -f query/last_row_cache.py
+python3 ./test.py -f query/lastRowSnapshot.py
 python3 ./test.py -f account/account_create.py
 python3 ./test.py -f alter/alter_table.py
 python3 ./test.py -f query/queryGroupbySort.py
@@ -382,6 +391,7 @@ python3 test.py -f tools/taosdemoAllTest/TD-4985/query-limit-offset.py
 python3 test.py -f tools/taosdemoAllTest/TD-5213/insert4096columns_not_use_taosdemo.py
 python3 test.py -f tools/taosdemoAllTest/TD-5213/insertSigcolumnsNum4096.py
 python3 ./test.py -f tag_lite/drop_auto_create.py
+python3 ./test.py -f tag_lite/tagIndex.py
 python3 test.py -f insert/insert_before_use_db.py
 python3 test.py -f alter/alter_keep.py
 python3 test.py -f alter/alter_cacheLastRow.py
@@ -0,0 +1,168 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import subprocess
+from ctypes import c_byte, c_char_p, cast
+from taos.bind import new_bind_params, new_multi_binds
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    # the mnode tells clients to send stmt batch binds as columnar submit blocks
+    updatecfgDict = {'columnarSubmit': 1}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.conn = conn
+        self.ts = 1600000000000
+        self.cols = ["ts", "c1", "c2", "c3", "c4", "c5", "c6", "c7", "c8"]
+        self.binders = ["timestamp", "bool", "tinyint", "int", "bigint", "float", "double", "binary", "nchar"]
+
+    def row(self, key, seed):
+        # each column is null in rows of its own period
+        values = [self.ts + key, seed % 2 == 0, seed % 100 - 50, seed * 3, seed * 100000007, seed * 0.5,
+                  seed / 8, "b%d" % seed, "涛思%d" % seed]
+        return tuple(None if k > 0 and (seed + k) % (k + 3) == 0 else values[k] for k in range(len(values)))
+
+    def literal(self, v):
+        if v is None:
+            return "null"
+        if isinstance(v, bool):
+            return "true" if v else "false"
+        if isinstance(v, str):
+            return "'%s'" % v
+        return str(v)
+
+    def bindBatch(self, stmt, rows, cols):
+        binds = new_multi_binds(len(cols))
+        for i, c in enumerate(cols):
+            values = [r[c] for r in rows]
+            getattr(binds[i], self.binders[c])(values)
+            if c > 0:
+                binds[i].is_null = cast((c_byte * len(values))(*[v is None for v in values]), c_char_p)
+        stmt.bind_param_batch(binds)
+
+    def bindRow(self, stmt, row, cols):
+        binds = new_bind_params(len(cols))
+        for i, c in enumerate(cols):
+            if row[c] is None:
+                binds[i].null()
+            else:
+                getattr(binds[i], self.binders[c])(row[c])
+        stmt.bind_param(binds)
+
+    def insertRef(self, table, rows, cols):
+        # the same rows in one statement go through the row path of the client
+        values = ["(%s)" % ', '.join(self.literal(r[c]) for c in cols) for r in rows]
+        tdSql.execute("insert into %s (%s) values %s" % (table, ', '.join(self.cols[c] for c in cols),
+                                                          ' '.join(values)))
+
+    def countColumnar(self):
+        logPath = "%s/taoslog0.0" % tdDnodes.sim.logDir
+        out = subprocess.run("grep -c ', columnar' %s" % logPath, shell=True, stdout=subprocess.PIPE).stdout
+        return int(out.decode().strip() or 0)
+
+    def check(self, step, num):
+        for i in range(1, num + 1):
+            tdSql.query("select * from t%d" % i)
+            result = tdSql.queryResult
+            tdSql.query("select * from r%d" % i)
+            if len(result) == 0 or result != tdSql.queryResult:
+                tdLog.exit("%s, t%d: %d rows differ from the %d rows inserted by sql" %
+                           (step, i, len(result), tdSql.queryRows))
+        tdLog.info("%s: rows of %d tables are the same as the ones inserted by sql" % (step, num))
+
+    def run(self):
+        tdSql.prepare()
+        schema = "(ts timestamp, c1 bool, c2 tinyint, c3 int, c4 bigint, c5 float, c6 double, c7 binary(16), " \
+                 "c8 nchar(16))"
+        for i in range(1, 6):
+            tdSql.execute("create table t%d %s" % (i, schema))
+            tdSql.execute("create table r%d %s" % (i, schema))
+        allCols = list(range(len(self.cols)))
+        sql = "insert into %s values(?, ?, ?, ?, ?, ?, ?, ?, ?)"
+
+        tdLog.info("===== ordered batches with nulls are sent column-wise =====")
+        columnar = self.countColumnar()
+        stmt = self.conn.statement(sql % "t1")
+        rows = [self.row(i, i) for i in range(3000)]
+        for begin in range(0, 3000, 1000):
+            self.bindBatch(stmt, rows[begin:begin + 1000], allCols)
+        stmt.execute()
+        self.insertRef("r1", rows, allCols)
+
+        # the statement is reused after execution
+        rows = [self.row(i, i) for i in range(3000, 3100)]
+        self.bindBatch(stmt, rows, allCols)
+        stmt.execute()
+        stmt.close()
+        self.insertRef("r1", rows, allCols)
+        if self.countColumnar() < columnar + 2:
+            tdLog.exit("batch binds are not sent as columnar submit blocks")
+
+        tdLog.info("===== out of order and duplicate timestamps are flattened into rows =====")
+        stmt = self.conn.statement(sql % "t2")
+        keys = [5, 3, 3, 9, 1, 9, 0, 7, 7, 7, 2, 100, 50, 50]
+        rows = [self.row(k, s) for s, k in enumerate(keys)]
+        self.bindBatch(stmt, rows, allCols)
+        stmt.execute()
+        stmt.close()
+        self.insertRef("r2", rows, allCols)
+
+        tdLog.info("===== a row bind after a batch bind =====")
+        stmt = self.conn.statement(sql % "t3")
+        rows = [self.row(i, i) for i in range(201)]
+        self.bindBatch(stmt, rows[:100], allCols)
+        for r in rows[100:103]:
+            self.bindRow(stmt, r, allCols)
+        self.bindBatch(stmt, rows[103:], allCols)
+        stmt.execute()
+        stmt.close()
+        self.insertRef("r3", rows, allCols)
+
+        tdLog.info("===== columns not bound are null =====")
+        cols = [0, 3, 7]
+        stmt = self.conn.statement("insert into t4 (ts, c3, c7) values(?, ?, ?)")
+        rows = [self.row(i, i) for i in range(500)]
+        self.bindBatch(stmt, rows, cols)
+        stmt.execute()
+        stmt.close()
+        self.insertRef("r4", rows, cols)
+
+        tdLog.info("===== all values of a column are null =====")
+        stmt = self.conn.statement(sql % "t5")
+        rows = [tuple(None if c in (2, 7, 8) else v for c, v in enumerate(self.row(i, i))) for i in range(300)]
+        self.bindBatch(stmt, rows, allCols)
+        stmt.execute()
+        stmt.close()
+        self.insertRef("r5", rows, allCols)
+
+        self.check("insert", 5)
+
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        self.check("restart", 5)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
@@ -0,0 +1,142 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import os
+import re
+import glob
+import time
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    updatecfgDict = {'tsdbDebugFlag': 143}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.day = 86400000
+        self.now = int(time.time()) * 1000
+        self.rowsPerDay = 1000
+        # data older than keep0 days belongs to level 1
+        self.oldDays = [60, 55, 50, 45, 40, 35]
+        self.newDays = [3, 2, 1]
+        self.queries = [
+            "select count(*), sum(c1), min(c1), max(c1), first(ts), last(ts) from db.st",
+            "select count(*), sum(c1) from db.st group by tbname",
+            "select count(*), sum(c1), max(c2) from db.st interval(24h)",
+            "select ts, c1, c2 from db.t1 where ts < now - 30d order by ts desc limit 50",
+        ]
+
+    def insertDay(self, daysAgo):
+        start = self.fidOf(daysAgo) * self.day
+        for t in range(2):
+            for i in range(0, self.rowsPerDay, 200):
+                values = ' '.join("(%d, %d, %d)" % (start + (i + j) * 60000, daysAgo * 10000 + i + j, t)
+                                  for j in range(200))
+                tdSql.execute("insert into db.t%d values %s" % (t, values))
+
+    def dataFiles(self, dataDir):
+        # named v<vgId>f<fid>.data, or v<vgId>f<fid>.data-ver<n> once rewritten
+        return sorted(os.path.basename(f) for f in glob.glob("%s/vnode/vnode*/tsdb/data/v*f*.data*" % dataDir))
+
+    def dataFids(self, dataDir):
+        return set(int(re.match(r"v\d+f(-?\d+)\.", f).group(1)) for f in self.dataFiles(dataDir))
+
+    def fidOf(self, daysAgo):
+        return self.now // self.day - daysAgo
+
+    def snapshot(self):
+        results = []
+        for sql in self.queries:
+            tdSql.query(sql)
+            results.append(tdSql.queryResult)
+        return results
+
+    def checkSnapshot(self, step, expected):
+        results = self.snapshot()
+        for i in range(len(self.queries)):
+            if results[i] != expected[i]:
+                tdLog.exit("%s: %s returns %s, expect %s" % (step, self.queries[i], results[i], expected[i]))
+        tdLog.info("%s: %d queries return the same results" % (step, len(self.queries)))
+
+    def checkTiers(self, step, hotDir, coldDir):
+        oldFids = set(self.fidOf(d) for d in self.oldDays)
+        newFids = set(self.fidOf(d) for d in self.newDays)
+        hot = self.dataFids(hotDir)
+        cold = self.dataFids(coldDir)
+        if hot != newFids or cold != oldFids:
+            tdLog.exit("%s: file sets %s on level 0 and %s on level 1, expect %s and %s" %
+                       (step, sorted(hot), sorted(cold), sorted(newFids), sorted(oldFids)))
+        tdLog.info("%s: %d aged file sets are on level 1, %d on level 0" % (step, len(cold), len(hot)))
+
+    def run(self):
+        hotDir = tdDnodes.dnodes[0].dataDir
+        coldDir = "%s/cold" % os.path.dirname(hotDir)
+        logPath = "%s/taosdlog.0" % tdDnodes.dnodes[0].logDir
+
+        # levels of dataDir and keep0,keep1,keep2 are only read by a build with _STORAGE
+        tdLog.info("===== data of all ages is written to a dnode of one level =====")
+        tdSql.execute("create database db days 1 keep 10,20,365")
+        tdSql.execute("create table db.st(ts timestamp, c1 int, c2 int) tags(t int)")
+        tdSql.execute("create table db.t0 using db.st tags(0)")
+        tdSql.execute("create table db.t1 using db.st tags(1)")
+        for d in self.oldDays + self.newDays:
+            self.insertDay(d)
+        expected = self.snapshot()
+        if expected[0][0][0] != len(self.oldDays + self.newDays) * 2 * self.rowsPerDay:
+            tdLog.exit("%d rows are written" % expected[0][0][0])
+
+        # stopping commits the data, every file set is on level 0
+        tdDnodes.stop(1)
+        if len(self.dataFiles(hotDir)) != len(self.oldDays + self.newDays):
+            tdLog.exit("file sets on level 0: %s" % self.dataFiles(hotDir))
+
+        tdLog.info("===== aged file sets migrate once a cold tier is added =====")
+        os.system("rm -rf %s && mkdir -p %s" % (coldDir, coldDir))
+        tdDnodes.cfg(1, "dataDir", "%s 1 0" % coldDir)
+        tdDnodes.cfg(1, "migrateInterval", 2)
+        tdDnodes.cfg(1, "migrateHotReads", 0)
+        tdDnodes.start(1)
+
+        for i in range(60):
+            if len(self.dataFiles(coldDir)) == len(self.oldDays):
+                break
+            time.sleep(1)
+        self.checkTiers("after migration", hotDir, coldDir)
+        cmd = "grep -c 'is migrated from level 0 disk id 0 to level 1 disk id 0' %s" % logPath
+        migrated = int(os.popen(cmd).read().strip() or 0)
+        if migrated != len(self.oldDays):
+            tdLog.exit("%d file sets are logged as migrated" % migrated)
+        self.checkSnapshot("after migration", expected)
+
+        tdLog.info("===== migrated data is read after a restart =====")
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        self.checkSnapshot("after restart", expected)
+        # a few migration passes later nothing is moved again
+        time.sleep(5)
+        self.checkTiers("after restart", hotDir, coldDir)
+        self.checkSnapshot("after restart", expected)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
@@ -0,0 +1,149 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import os
+import glob
+import subprocess
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    updatecfgDict = {'tsdbDebugFlag': 143}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.ts = 1600000000000
+        self.numOfTables = 20
+        self.rows = {}
+
+    def row(self, t, i):
+        # the last rows have nulls, so the last row and the last value of each column differ
+        c1 = None if i % 3 == 0 else i * 10 + t
+        c2 = None if i % 400 >= 395 else "b%d" % i
+        c3 = None if i % 2 == 1 else i / 2
+        return (self.ts + i * 1000, c1, c2, c3)
+
+    def insertRows(self, t, begin, num):
+        rows = self.rows.setdefault(t, [])
+        values = []
+        for i in range(begin, begin + num):
+            r = self.row(t, i)
+            rows.append(r)
+            values.append("(%d, %s, %s, %s)" % (r[0], 'null' if r[1] is None else r[1],
+                                                'null' if r[2] is None else "'%s'" % r[2],
+                                                'null' if r[3] is None else r[3]))
+        # the cached last columns are updated by the last row of each insert, so the rows with nulls go one by one
+        tail = max(0, len(values) - 10)
+        for begin in range(0, tail, 1000):
+            tdSql.execute("insert into ct%d values %s" % (t, ' '.join(values[begin:min(tail, begin + 1000)])))
+        for value in values[tail:]:
+            tdSql.execute("insert into ct%d values %s" % (t, value))
+
+    def check(self, step):
+        for t in range(self.numOfTables):
+            rows = self.rows[t]
+            expect = [rows[-1][0]] + [next((r[c] for r in reversed(rows) if r[c] is not None), None)
+                                      for c in range(1, 4)]
+
+            tdSql.query("select last_row(*) from ct%d" % t)
+            got = [int(tdSql.queryResult[0][0].timestamp() * 1000)] + list(tdSql.queryResult[0][1:])
+            if got != list(rows[-1]):
+                tdLog.exit("%s, last row of ct%d: %s, %s expected" % (step, t, got, rows[-1]))
+
+            tdSql.query("select last(*) from ct%d" % t)
+            got = [int(tdSql.queryResult[0][0].timestamp() * 1000)] + list(tdSql.queryResult[0][1:])
+            if got != expect:
+                tdLog.exit("%s, last of ct%d: %s, %s expected" % (step, t, got, expect))
+        tdLog.info("%s: last row and last values of %d tables are right" % (step, self.numOfTables))
+
+    def countLog(self, pattern):
+        logPath = "%s/taosdlog.0" % tdDnodes.dnodes[0].logDir
+        out = subprocess.run("grep -c '%s' %s" % (pattern, logPath), shell=True, stdout=subprocess.PIPE).stdout
+        return int(out.decode().strip() or 0)
+
+    def snapFiles(self):
+        return glob.glob("%s/vnode/vnode*/tsdb/last" % tdDnodes.dnodes[0].dataDir)
+
+    def start(self):
+        tdDnodes.start(1)
+        tdSql.execute("use db")
+
+    def run(self):
+        tdSql.execute("drop database if exists db")
+        tdSql.execute("create database db cachelast 3 cache 1 blocks 3")
+        tdSql.execute("use db")
+        tdSql.execute("create table st(ts timestamp, c1 int, c2 binary(8), c3 double) tags(t int)")
+        tdSql.execute("create table nt(ts timestamp, c1 int, c2 binary(8), c3 double)")
+        for t in range(self.numOfTables):
+            tdSql.execute("create table ct%d using st tags(%d)" % (t, t))
+            self.insertRows(t, 0, 400)
+        self.check("insert")
+
+        tdLog.info("===== step1: the last data is loaded from the snapshot saved on close =====")
+        loaded = self.countLog("is loaded from snapshot")
+        tdDnodes.stop(1)
+        if len(self.snapFiles()) == 0:
+            tdLog.exit("no snapshot of the last data is saved")
+        self.start()
+        if self.countLog("is loaded from snapshot") <= loaded:
+            tdLog.exit("the last data is not loaded from the snapshot")
+        self.check("loaded from snapshot")
+
+        tdLog.info("===== step2: files committed after the snapshot make it stale =====")
+        for t in range(5):
+            self.insertRows(t, 400, 10)
+        values = ["(%d, %d, 'nt', %d)" % (self.ts + i, i, i) for i in range(100000)]
+        for begin in range(0, len(values), 1000):
+            tdSql.execute("insert into nt values %s" % ' '.join(values[begin:begin + 1000]))
+        stale = self.countLog("last data snapshot is stale")
+        tdDnodes.forcestop(1)
+        self.start()
+        if self.countLog("last data snapshot is stale") <= stale:
+            tdLog.exit("the snapshot taken before the commit is used")
+        self.check("stale snapshot")
+
+        tdLog.info("===== step3: a corrupted snapshot is not used =====")
+        tdDnodes.stop(1)
+        for fname in self.snapFiles():
+            with open(fname, "r+b") as f:
+                f.seek(-1, os.SEEK_END)
+                last = f.read(1)
+                f.seek(-1, os.SEEK_END)
+                f.write(bytes([last[0] ^ 0xff]))
+        corrupted = self.countLog("is corrupted")
+        self.start()
+        if self.countLog("is corrupted") <= corrupted:
+            tdLog.exit("the corrupted snapshot is used")
+        self.check("corrupted snapshot")
+
+        tdLog.info("===== step4: a dropped table is skipped in the snapshot =====")
+        tdSql.execute("drop table ct%d" % (self.numOfTables - 1))
+        del self.rows[self.numOfTables - 1]
+        self.numOfTables -= 1
+        tdDnodes.stop(1)
+        self.start()
+        self.check("dropped table")
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
@@ -0,0 +1,157 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import os
+import re
+import time
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    # windows and buckets of days begin at midnight of UTC+5:30, the ones of hours at midnight of UTC
+    updatecfgDict = {'rollupTiers': '1m,1h,1d', 'tsdbDebugFlag': 143, 'timezone': 'Asia/Kolkata'}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        # whole days so that windows of a day begin on the first row
+        now = int(time.time() * 1000)
+        self.ts = now - now % 86400000 - 3 * 86400000
+        self.rows = {}
+        self.dayShift = -19800000
+
+    def insertRows(self, tbname, start, num, step):
+        rows = self.rows.setdefault(tbname, [])
+        for begin in range(0, num, 1000):
+            values = []
+            for i in range(begin, min(num, begin + 1000)):
+                ts = start + i * step
+                if i % 7 == 0:
+                    values.append("(%d, null, null)" % ts)
+                    rows.append((ts, None, None))
+                else:
+                    values.append("(%d, %d, %f)" % (ts, i % 1000 - 500, i / 4))
+                    rows.append((ts, i % 1000 - 500, i / 4))
+            tdSql.execute("insert into %s values %s" % (tbname, ' '.join(values)))
+
+    def expect(self, tbnames, interval, shift):
+        windows = {}
+        for tbname in tbnames:
+            for ts, v, f in self.rows[tbname]:
+                windows.setdefault(ts - (ts - shift) % interval, []).append((v, f))
+
+        result = []
+        for skey in sorted(windows):
+            vs = [v for v, f in windows[skey] if v is not None]
+            fs = [f for v, f in windows[skey] if f is not None]
+            result.append((skey, len(windows[skey]), len(vs), sum(vs) if vs else None, min(vs) if vs else None,
+                           max(vs) if vs else None, sum(fs) / len(fs) if fs else None))
+        return result
+
+    def checkInterval(self, tbname, tbnames, unit, interval):
+        tdSql.query("select count(*), count(v), sum(v), min(v), max(v), avg(f) from %s interval(%s)" % (tbname, unit))
+        expect = self.expect(tbnames, interval, self.dayShift if unit.endswith("d") else 0)
+        if tdSql.queryRows != len(expect):
+            tdLog.exit("%s interval(%s): %d windows, %d expected" % (tbname, unit, tdSql.queryRows, len(expect)))
+
+        for i in range(len(expect)):
+            row = tdSql.queryResult[i]
+            if int(row[0].timestamp() * 1000) != expect[i][0]:
+                tdLog.exit("%s interval(%s) window %d begins at %s" % (tbname, unit, i, row[0]))
+            for col in range(1, len(row)):
+                if isinstance(row[col], float) and expect[i][col] is not None:
+                    same = abs(row[col] - expect[i][col]) <= 1e-9 * max(1.0, abs(expect[i][col]))
+                else:
+                    same = (row[col] == expect[i][col])
+                if not same:
+                    tdLog.exit("%s interval(%s) window %s col %d: %s, of raw rows: %s" %
+                               (tbname, unit, row[0], col, row[col], expect[i][col]))
+        tdLog.info("%d windows of %s interval(%s) are the same as raw rows" % (len(expect), tbname, unit))
+
+    def checkAll(self):
+        for unit, interval in (("1m", 60000), ("1h", 3600000), ("1d", 86400000), ("24h", 86400000), ("90s", 90000)):
+            for tbname in ("t0", "t1"):
+                self.checkInterval(tbname, [tbname], unit, interval)
+            self.checkInterval("st", ["t0", "t1"], unit, interval)
+
+    def rollupFids(self):
+        tsdbDir = "%s/vnode/vnode2/tsdb" % tdDnodes.dnodes[0].dataDir
+        fids = set()
+        for fname in os.listdir(tsdbDir):
+            m = re.match(r"^f(-?\d+)\.rollup$", fname)
+            if m:
+                fids.add(int(m.group(1)))
+        return fids
+
+    def restart(self):
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        tdSql.execute("use db")
+
+    def run(self):
+        # a small cache commits while the dnode runs
+        tdSql.execute("drop database if exists db")
+        tdSql.execute("create database db keep 365 cache 1 blocks 3")
+        tdSql.execute("use db")
+
+        tdSql.execute("create table st(ts timestamp, v int, f double) tags(t int)")
+        tdSql.execute("create table t0 using st tags(0)")
+        tdSql.execute("create table t1 using st tags(1)")
+
+        tdLog.info("===== step1: rows of several blocks in each window, and of a file set to be expired =====")
+        self.insertRows("t0", self.ts, 60000, 3000)
+        self.insertRows("t1", self.ts + 1500, 20000, 7000)
+        old = self.ts - 200 * 86400000
+        self.insertRows("t1", old, 2000, 60000)
+        self.restart()
+
+        fids = self.rollupFids()
+        if len(fids) < 2:
+            tdLog.exit("rollup of %d file sets only" % len(fids))
+
+        tdLog.info("===== step2: windows read with rollup are the same as raw rows =====")
+        self.checkAll()
+        logPath = "%s/taosdlog.0" % tdDnodes.dnodes[0].logDir
+        if os.system("grep -q 'is read with rollup tier' %s" % logPath) != 0:
+            tdLog.exit("rollup is not read")
+        # buckets of an hour make up windows of 24 hours, the ones of a day starting at a half hour do not
+        if os.system("grep -q 'is read with rollup tier 1 for interval 86400000' %s" % logPath) != 0:
+            tdLog.exit("rollup of hours is not read for windows of 24 hours")
+
+        tdLog.info("===== step3: the rollup goes with the file set expired by a commit =====")
+        tdSql.execute("alter database db keep 100")
+        self.rows["t1"] = [row for row in self.rows["t1"] if row[0] >= self.ts]
+        tdSql.execute("create table nt(ts timestamp, v int, f double)")
+        self.insertRows("nt", self.ts, 100000, 1000)
+
+        for _ in range(30):
+            left = self.rollupFids()
+            if min(fids) not in left:
+                break
+            time.sleep(1)
+        if len(left) != len(fids) - 1 or min(fids) in left:
+            tdLog.exit("rollup of file sets %s is left, of %s before" % (sorted(left), sorted(fids)))
+        self.checkAll()
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
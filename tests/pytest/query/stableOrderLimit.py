@@ -0,0 +1,88 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+from util.log import *
+from util.cases import *
+from util.sql import *
+
+
+class TDTestCase:
+    # tables of the super table are spread over several vgroups
+    updatecfgDict = {'minTablesPerVnode': 4, 'maxTablesPerVnode': 4, 'maxVgroupsPerDb': 4}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.ts = 1600000000000
+        self.numOfTables = 12
+        self.rows = []
+
+    def insertRows(self, t, num):
+        tbname = "t%d" % t
+        for begin in range(0, num, 1000):
+            values = []
+            for i in range(begin, min(num, begin + 1000)):
+                # tables interleave in time, some of them are denser than others, no two rows share a timestamp
+                ts = self.ts + i * (t % 3 + 1) * 100 + t
+                values.append("(%d, %d)" % (ts, i))
+                self.rows.append((ts, i, t))
+            tdSql.execute("insert into %s values %s" % (tbname, ' '.join(values)))
+
+    def check(self, order, limit, offset):
+        tdSql.query("select ts, v, t from st order by ts %s limit %d offset %d" % (order, limit, offset))
+        expect = sorted(self.rows, reverse=(order == "desc"))[offset:offset + limit]
+        if tdSql.queryRows != len(expect):
+            tdLog.exit("order by ts %s limit %d offset %d: %d rows, %d expected" %
+                       (order, limit, offset, tdSql.queryRows, len(expect)))
+
+        for i in range(len(expect)):
+            row = tdSql.queryResult[i]
+            if int(row[0].timestamp() * 1000) != expect[i][0] or row[1] != expect[i][1] or row[2] != expect[i][2]:
+                tdLog.exit("order by ts %s limit %d offset %d row %d: %s, expected %s" %
+                           (order, limit, offset, i, row, expect[i]))
+        tdLog.info("order by ts %s limit %d offset %d: %d rows are merged in order" % (order, limit, offset, len(expect)))
+
+    def run(self):
+        tdSql.prepare()
+
+        tdSql.execute("create table st(ts timestamp, v int) tags(t int)")
+        for t in range(self.numOfTables):
+            tdSql.execute("create table t%d using st tags(%d)" % (t, t))
+            self.insertRows(t, 6000)
+
+        # tables of the last vgroup have no rows
+        for t in range(self.numOfTables, self.numOfTables + 4):
+            tdSql.execute("create table t%d using st tags(%d)" % (t, t))
+
+        tdSql.query("show vgroups")
+        if tdSql.queryRows < 4:
+            tdLog.exit("tables are in %d vgroups only" % tdSql.queryRows)
+
+        for order in ("asc", "desc"):
+            # within the first block of each vnode, across several blocks, and the end of the rows
+            for limit, offset in ((10, 0), (100, 37), (5000, 3000), (20000, 15000), (100, 71990), (50, 72000)):
+                self.check(order, limit, offset)
+
+            # beyond TSDB_MAX_ORDERED_PRJ_LIMIT rows the vnodes do not sort, the client merges the rows on disk
+            for limit, offset in ((100, 65500), (30, 71000), (10, 50000000)):
+                self.check(order, limit, offset)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
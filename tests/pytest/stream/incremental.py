@@ -0,0 +1,111 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import time
+import random
+import taos
+from util.log import tdLog
+from util.cases import tdCases
+from util.sql import tdSql
+
+
+class TDTestCase:
+    updatecfgDict = {'minIntervalTime': 1, 'minSlidingTime': 1, 'maxStreamCompDelay': 1000,
+                     'maxFirstStreamCompDelay': 1000}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+    def nullable(self, value):
+        return 'null' if random.random() < 0.2 else value
+
+    def insertRows(self, ts, num):
+        values = []
+        for i in range(num):
+            values.append("(%d, %d, %s, %s, %s)" % (ts + i, random.randint(-100, 100),
+                          self.nullable("%.3f" % random.uniform(-10, 10)),
+                          self.nullable(str(random.randint(0, 254))),
+                          self.nullable(random.choice(['true', 'false']))))
+        tdSql.execute("insert into t values %s" % ' '.join(values))
+
+    def run(self):
+        random.seed(1)
+        tdSql.prepare()
+
+        tdLog.info("===== step1: rows in the future are written before the stream =====")
+        tdSql.execute("create table t (ts timestamp, v int, f double, u tinyint unsigned, b bool)")
+        now = int(time.time() * 1000)
+        future = now + 8000 - (now + 8000) % 2000
+        self.insertRows(future, 5)
+
+        tdLog.info("===== step2: create the stream, it is computed incrementally =====")
+        funcs = "count(*), sum(v), avg(f), min(v), max(v), first(v), last(f), spread(v), count(f), sum(u), max(f), first(b)"
+        tdSql.execute("create table s as select %s from t interval(2s)" % funcs)
+
+        tdLog.info("===== step3: write rows in order, out of order and duplicated =====")
+        end = now + 30000
+        i = 0
+        while int(time.time() * 1000) < end:
+            ts = int(time.time() * 1000)
+            self.insertRows(ts, 5)
+            # rows later than the windows closed are not in the stream, whether it is incremental or not.
+            # The window of the rows in the future is left in order, it is only right if they are in the state.
+            if ts >= future + 4000 and i % 30 == 15:
+                self.insertRows(max(ts - 300, ts - ts % 2000), 1)
+            if ts >= future + 4000 and i % 30 == 25:
+                self.insertRows(ts + 2, 2)
+            i += 1
+            time.sleep(0.2)
+
+        tdLog.info("===== step4: wait for the windows written =====")
+        lastWin = end - end % 2000 - 2000
+        for _ in range(60):
+            tdSql.query("select last(ts) from s")
+            if tdSql.queryRows == 1 and int(tdSql.getData(0, 0).timestamp() * 1000) >= lastWin:
+                break
+            time.sleep(1)
+
+        tdLog.info("===== step5: compare the stream with the query =====")
+        tdSql.query("select * from s")
+        streamRows = tdSql.queryResult
+        tdSql.query("select %s from t interval(2s)" % funcs)
+        queryRows = {row[0]: row for row in tdSql.queryResult}
+
+        if len(streamRows) < 5:
+            tdLog.exit("stream wrote %d windows only" % len(streamRows))
+
+        for row in streamRows:
+            if int(row[0].timestamp() * 1000) > lastWin:
+                continue
+            expect = queryRows.get(row[0])
+            if expect is None:
+                tdLog.exit("window %s of stream is not in query result" % row[0])
+            for col in range(1, len(row)):
+                if isinstance(row[col], float) and expect[col] is not None:
+                    same = abs(row[col] - expect[col]) <= 1e-6 * max(1.0, abs(expect[col]))
+                else:
+                    same = (row[col] == expect[col])
+                if not same:
+                    tdLog.exit("window %s col %d of stream: %s, of query: %s" % (row[0], col, row[col], expect[col]))
+
+        tdLog.info("%d windows of stream are the same as the query" % len(streamRows))
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
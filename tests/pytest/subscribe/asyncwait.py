@@ -0,0 +1,103 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import time
+import threading
+from ctypes import c_char_p, c_void_p
+from taos.cinterface import _libtaos, subscribe_callback_type
+from taos.result import TaosResult
+from util.log import *
+from util.cases import *
+from util.sql import *
+
+
+class TDTestCase:
+    # tables of the super table are spread over several vgroups
+    updatecfgDict = {'minTablesPerVnode': 4, 'maxTablesPerVnode': 4}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+        self.conn = conn
+        self.lock = threading.Lock()
+        self.consumed = []
+
+    def subscribeCallback(self, pSub, pResult, pParam, code):
+        rows = 0
+        if code == 0 and pResult is not None:
+            for row in TaosResult(pResult).rows_iter():
+                rows += 1
+        with self.lock:
+            self.consumed.append((time.time(), rows))
+
+    def waitRows(self, since, expect, timeout):
+        while time.time() < since + timeout:
+            with self.lock:
+                rows = sum(n for t, n in self.consumed if t >= since)
+            if rows >= expect:
+                return time.time() - since
+            time.sleep(0.05)
+        return None
+
+    def run(self):
+        tdSql.prepare()
+
+        tdSql.execute("create table st(ts timestamp, v int) tags(t int)")
+        for i in range(8):
+            tdSql.execute("create table t%d using st tags(%d)" % (i, i))
+        tdSql.query("show vgroups")
+        if tdSql.queryRows < 2:
+            tdLog.exit("tables are in %d vgroup only" % tdSql.queryRows)
+
+        # an idle subscription is consumed at the interval no more, new rows wake it by the vnode at once
+        interval = 5000
+        # the callback is kept referenced by the case, the connector wraps it in a temporary one
+        self.callback = subscribe_callback_type(self.subscribeCallback)
+        sub = c_void_p(_libtaos.taos_subscribe(self.conn._conn, 1, c_char_p(b"asyncwait"), c_char_p(b"select * from st"),
+                                               self.callback, None, interval))
+        if sub.value is None:
+            tdLog.exit("failed to subscribe")
+
+        # the first consume arms the sub-waits
+        time.sleep(interval / 1000 + 2)
+
+        total = 0
+        for i in range(8):
+            # the subscription has been idle for longer than its interval, a wake-up is answered right away
+            time.sleep(interval / 1000 + 1)
+            since = time.time()
+            tdSql.execute("insert into t%d values(now, %d)(now + 1a, %d)" % (i, i, i))
+            total += 2
+
+            latency = self.waitRows(since, 2, interval / 1000 * 3)
+            if latency is None:
+                tdLog.exit("rows of t%d are not consumed" % i)
+            tdLog.info("rows of t%d are consumed in %.3f seconds" % (i, latency))
+            if latency > interval / 1000 / 2:
+                tdLog.exit("rows of t%d are consumed in %.3f seconds, the sub-wait does not wake it" % (i, latency))
+
+        with self.lock:
+            rows = sum(n for t, n in self.consumed)
+        if rows != total:
+            tdLog.exit("%d rows consumed, %d inserted" % (rows, total))
+
+        _libtaos.taos_unsubscribe(sub, 0)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
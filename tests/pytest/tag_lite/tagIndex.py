@@ -0,0 +1,124 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import os
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    updatecfgDict = {'tsdbDebugFlag': 143}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.ts = 1600000000000
+        self.numOfTables = 300
+        self.tables = {}
+
+        # conditions on one tag and on several tags, each with the child tables it holds for
+        self.conds = [
+            ("t1 = 10", lambda t: t['t1'] == 10),
+            ("t2 = 'g1' and t1 > 20", lambda t: t['t2'] == 'g1' and t['t1'] is not None and t['t1'] > 20),
+            ("t2 = 'g0' or t5 = 'n3'", lambda t: t['t2'] == 'g0' or t['t5'] == 'n3'),
+            ("t1 in (1, 2, 3) and t4 = true", lambda t: t['t1'] in (1, 2, 3) and t['t4']),
+            ("t1 is null", lambda t: t['t1'] is None),
+            ("t1 is not null and t3 < 30", lambda t: t['t1'] is not None and t['t3'] < 30),
+            ("t5 like 'n1%'", lambda t: t['t5'].startswith('n1')),
+            ("(t1 = 5 or t1 = 6) and t2 <> 'g2'", lambda t: t['t1'] in (5, 6) and t['t2'] != 'g2'),
+            ("t3 >= 10 and t3 <= 20 and t4 = false", lambda t: 10 <= t['t3'] <= 20 and not t['t4']),
+            ("t2 = 'g1' and tbname in ('ct1', 'ct4', 'ct5', 'ct7')",
+             lambda t: t['t2'] == 'g1' and t['name'] in ('ct1', 'ct4', 'ct5', 'ct7')),
+            ("t2 = 'g9' or t1 = 99", lambda t: t['t2'] == 'g9' or t['t1'] == 99),
+        ]
+
+    def tags(self, i):
+        return {'name': 'ct%d' % i, 'v': i, 't1': None if i % 37 == 0 else i % 50, 't2': 'g%d' % (i % 3),
+                't3': i * 0.5, 't4': i % 2 == 0, 't5': 'n%d' % (i % 17)}
+
+    def createTable(self, i):
+        t = self.tags(i)
+        tdSql.execute("create table %s using st tags(%s, '%s', %f, %s, '%s')" %
+                      (t['name'], 'null' if t['t1'] is None else t['t1'], t['t2'], t['t3'], t['t4'], t['t5']))
+        tdSql.execute("insert into %s values(%d, %d)" % (t['name'], self.ts, t['v']))
+        self.tables[t['name']] = t
+
+    def checkAll(self, step):
+        for sql, fp in self.conds:
+            tdSql.query("select v from st where %s" % sql)
+            result = sorted(row[0] for row in tdSql.queryResult)
+            expect = sorted(t['v'] for t in self.tables.values() if fp(t))
+            if result != expect:
+                tdLog.exit("%s, where %s: tables %s, %s expected" % (step, sql, result, expect))
+        tdLog.info("%s: %d conditions select the same tables as the tags" % (step, len(self.conds)))
+
+    def run(self):
+        tdSql.prepare()
+        tdSql.execute("create table st(ts timestamp, v int) tags(t1 int, t2 binary(10), t3 double, t4 bool, "
+                      "t5 nchar(10))")
+        for i in range(self.numOfTables):
+            self.createTable(i)
+
+        # a third of the tables share each value of t2, those sets are kept as bitmaps
+        self.checkAll("create")
+        logPath = "%s/taosdlog.0" % tdDnodes.dnodes[0].logDir
+        if os.system("grep -q 'tables found by tag index' %s" % logPath) != 0:
+            tdLog.exit("tag index is not used")
+
+        for i in (5, 8, 11):
+            tdSql.execute("alter table ct%d set tag t2 = 'g9'" % i)
+            self.tables['ct%d' % i]['t2'] = 'g9'
+        for i in (7, 74, 0):
+            tdSql.execute("alter table ct%d set tag t1 = 99" % i)
+            self.tables['ct%d' % i]['t1'] = 99
+        tdSql.execute("alter table ct20 set tag t1 = null")
+        self.tables['ct20']['t1'] = None
+        self.checkAll("set tag")
+
+        for i in range(10, 40):
+            tdSql.execute("drop table ct%d" % i)
+            del self.tables['ct%d' % i]
+        for i in range(self.numOfTables, self.numOfTables + 20):
+            self.createTable(i)
+        self.checkAll("drop and create tables")
+
+        # the index is rebuilt for the new tag schema
+        tdSql.execute("alter table st add tag t6 int")
+        for t in self.tables.values():
+            t['t6'] = None
+        for i in range(40, 60):
+            tdSql.execute("alter table ct%d set tag t6 = %d" % (i, i % 4))
+            self.tables['ct%d' % i]['t6'] = i % 4
+        self.conds.append(("t6 = 1 and t2 = 'g0'", lambda t: t['t6'] == 1 and t['t2'] == 'g0'))
+        self.conds.append(("t6 is not null and t4 = true", lambda t: t['t6'] is not None and t['t4']))
+        self.checkAll("add tag")
+
+        tdSql.execute("alter table st drop tag t5")
+        self.conds = [(sql, fp) for sql, fp in self.conds if 't5' not in sql]
+        self.checkAll("drop tag")
+
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        self.checkAll("restart")
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
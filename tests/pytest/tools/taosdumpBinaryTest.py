@@ -0,0 +1,123 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import os
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.ts = 1601481600000
+        self.numberOfTables = 8
+        self.numberOfRecords = 12000
+        self.dumpPath = "/tmp/taosdumpBinary"
+
+    def getBuildPath(self):
+        selfPath = os.path.dirname(os.path.realpath(__file__))
+
+        if ("community" in selfPath):
+            projPath = selfPath[:selfPath.find("community")]
+        else:
+            projPath = selfPath[:selfPath.find("tests")]
+
+        for root, dirs, files in os.walk(projPath):
+            if ("taosd" in files):
+                rootRealPath = os.path.dirname(os.path.realpath(root))
+                if ("packaging" not in rootRealPath):
+                    buildPath = root[:len(root) - len("/build/bin")]
+                    break
+        return buildPath
+
+    def insertRows(self, tbname, rows):
+        finish = 0
+        while(finish < rows):
+            sql = "insert into %s values" % tbname
+            for i in range(finish, rows):
+                if i % 7 == 0:
+                    sql += "(%d, null, null, null, null, null, null, null, null, null, null)" % (self.ts + i)
+                else:
+                    sql += "(%d, %d, %d, %d, %f, %f, 'b%d', %d, %d, %d, 'n%d')" % (
+                        self.ts + i, self.ts + i * 10, i, i * 100000, i / 3, i / 7, i, i % 30000, i % 100, i % 2, i)
+                finish = i + 1
+                if (1048576 - len(sql)) < 16384:
+                    break
+            tdSql.execute(sql)
+
+    def checkAll(self):
+        results = []
+        for tbname in ["st", "nt"] + ["t%d" % i for i in range(self.numberOfTables)]:
+            tdSql.query("select count(*), count(c1), sum(c2), sum(c3), sum(c4), sum(c5), count(c6), sum(c7), sum(c8), "
+                        "count(c9), count(c10), first(c6), last(c10), last(ts) from %s" % tbname)
+            results.append(tdSql.queryResult)
+        tdSql.query("select last(c6), last(c10) from st group by t1")
+        results.append(tdSql.queryResult)
+        return results
+
+    def run(self):
+        tdSql.prepare()
+
+        tdSql.execute("create table st(ts timestamp, c1 timestamp, c2 int, c3 bigint, c4 float, c5 double, c6 binary(8), c7 smallint, c8 tinyint, c9 bool, c10 nchar(8)) tags(t1 int)")
+        tdSql.execute("create table nt(ts timestamp, c1 timestamp, c2 int, c3 bigint, c4 float, c5 double, c6 binary(8), c7 smallint, c8 tinyint, c9 bool, c10 nchar(8))")
+        for i in range(self.numberOfTables):
+            tdSql.execute("create table t%d using st tags(%d)" % (i, i))
+            # tables of several blocks, one block and no rows
+            self.insertRows("t%d" % i, self.numberOfRecords if i % 3 == 0 else (i * 100 if i % 3 == 1 else 0))
+        self.insertRows("nt", self.numberOfRecords)
+
+        expect = self.checkAll()
+
+        buildPath = self.getBuildPath()
+        if (buildPath == ""):
+            tdLog.exit("taosdump not found!")
+        else:
+            tdLog.info("taosdump found in %s" % buildPath)
+        binPath = buildPath + "/build/bin/"
+
+        os.system("rm -rf %s && mkdir -p %s" % (self.dumpPath, self.dumpPath))
+        if os.system("%staosdump --databases db -b -o %s" % (binPath, self.dumpPath)) != 0:
+            tdLog.exit("failed to dump out in binary")
+
+        tdSql.execute("drop database db")
+        tdSql.query("show databases")
+        tdSql.checkRows(0)
+
+        if os.system("%staosdump -b -i %s" % (binPath, self.dumpPath)) != 0:
+            tdLog.exit("failed to dump in binary")
+
+        tdSql.execute("use db")
+        tdSql.query("show stables")
+        tdSql.checkRows(1)
+        tdSql.checkData(0, 0, 'st')
+
+        result = self.checkAll()
+        for i in range(len(expect)):
+            if result[i] != expect[i]:
+                tdLog.exit("restored result %s is not %s" % (result[i], expect[i]))
+        tdLog.info("all tables are restored from binary dump")
+
+        os.system("rm -rf %s" % self.dumpPath)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
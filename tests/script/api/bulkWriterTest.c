@@ -0,0 +1,237 @@
+// bulk writer: rows of many tables routed to vgroups, submitted by size, by interval, on flush and on close
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "taos.h"
+#include <sys/time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define PRINT_ERROR printf("\033[31m");
+#define PRINT_SUCCESS printf("\033[32m");
+
+#define NUM_OF_TABLES 10
+#define NUM_OF_ROWS   2000
+#define START_TS      1600000000000LL
+
+typedef struct {
+  pthread_mutex_t mutex;
+  char            tableName[256];
+  int             numOfRows;
+  int             code;
+} SFailures;
+
+static SFailures failures = {PTHREAD_MUTEX_INITIALIZER};
+
+void on_failure(void *param, const char *tableName, int numOfRows, int code) {
+  SFailures *pFailures = param;
+  pthread_mutex_lock(&pFailures->mutex);
+  snprintf(pFailures->tableName, sizeof(pFailures->tableName), "%s", tableName);
+  pFailures->numOfRows += numOfRows;
+  pFailures->code = code;
+  pthread_mutex_unlock(&pFailures->mutex);
+}
+
+void execute_simple_sql(void *taos, char *sql) {
+  TAOS_RES *result = taos_query(taos, sql);
+  if (result == NULL || taos_errno(result) != 0) {
+    PRINT_ERROR
+    printf("failed to %s, Reason: %s\n", sql, taos_errstr(result));
+    taos_free_result(result);
+    exit(EXIT_FAILURE);
+  }
+  taos_free_result(result);
+  PRINT_SUCCESS
+  printf("Successfully %s\n", sql);
+}
+
+void check_rows(TAOS *taos, const char *tableName, int64_t expectRows, int64_t expectSum) {
+  char sql[256] = {0};
+  sprintf(sql, "select count(*), sum(v) from %s", tableName);
+  TAOS_RES *result = taos_query(taos, sql);
+  if (result == NULL || taos_errno(result) != 0) {
+    PRINT_ERROR
+    printf("failed to %s, Reason: %s\n", sql, taos_errstr(result));
+    exit(EXIT_FAILURE);
+  }
+
+  int64_t   rows = 0;
+  int64_t   sum = 0;
+  TAOS_ROW  row = taos_fetch_row(result);
+  if (row != NULL) {
+    rows = *(int64_t *)row[0];
+    sum = (row[1] == NULL) ? 0 : *(int64_t *)row[1];
+  }
+  taos_free_result(result);
+
+  if (rows != expectRows || sum != expectSum) {
+    PRINT_ERROR
+    printf("table %s has %ld rows summed to %ld, but %ld rows summed to %ld expected\n", tableName, (long)rows,
+           (long)sum, (long)expectRows, (long)expectSum);
+    exit(EXIT_FAILURE);
+  }
+  PRINT_SUCCESS
+  printf("table %s has %ld rows as expected\n", tableName, (long)rows);
+}
+
+// rows are (ts, v) with v the index of the row
+int append_rows(TAOS_BULK_WRITER *writer, const char *tableName, int begin, int num) {
+  int64_t  ts = 0;
+  int32_t  v = 0;
+  TAOS_BIND params[2];
+  memset(params, 0, sizeof(params));
+
+  params[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  params[0].buffer_length = sizeof(ts);
+  params[0].buffer = &ts;
+  params[0].length = &params[0].buffer_length;
+
+  params[1].buffer_type = TSDB_DATA_TYPE_INT;
+  params[1].buffer_length = sizeof(v);
+  params[1].buffer = &v;
+  params[1].length = &params[1].buffer_length;
+
+  for (int i = begin; i < begin + num; i++) {
+    ts = START_TS + i;
+    v = i;
+    int code = taos_bulk_writer_append(writer, tableName, params);
+    if (code != 0) return code;
+  }
+  return 0;
+}
+
+void append_or_exit(TAOS_BULK_WRITER *writer, const char *tableName, int begin, int num) {
+  int code = append_rows(writer, tableName, begin, num);
+  if (code != 0) {
+    PRINT_ERROR
+    printf("failed to append rows to %s, reason: %s\n", tableName, taos_errstr(NULL));
+    exit(EXIT_FAILURE);
+  }
+}
+
+int64_t sum_of(int begin, int num) { return (int64_t)(begin + begin + num - 1) * num / 2; }
+
+int main(int argc, char *argv[]) {
+  void *taos = taos_connect("127.0.0.1", "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    PRINT_ERROR
+    printf("TDengine error: failed to connect\n");
+    exit(EXIT_FAILURE);
+  }
+  PRINT_SUCCESS
+  printf("Successfully connected to TDengine\n");
+
+  execute_simple_sql(taos, "drop database if exists bulk_writer_db");
+  execute_simple_sql(taos, "create database bulk_writer_db");
+  execute_simple_sql(taos, "use bulk_writer_db");
+  execute_simple_sql(taos, "create table st(ts timestamp, v int) tags(t int)");
+  execute_simple_sql(taos, "create table nt(ts timestamp, v int)");
+  for (int i = 0; i < NUM_OF_TABLES; i++) {
+    char sql[128];
+    sprintf(sql, "create table t%d using st tags(%d)", i, i);
+    execute_simple_sql(taos, sql);
+  }
+
+  TAOS_BULK_WRITER_OPTIONS options = {0};
+  options.maxRows = 500;
+  options.flushInterval = 200;
+  options.maxInflight = 2;
+  options.fp = on_failure;
+  options.param = &failures;
+
+  TAOS_BULK_WRITER *writer = taos_bulk_writer_open(taos, &options);
+  if (writer == NULL) {
+    PRINT_ERROR
+    printf("failed to open bulk writer\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // rows of all tables interleaved, submitted each time a vgroup buffers maxRows
+  for (int i = 0; i < NUM_OF_ROWS; i += 100) {
+    for (int t = 0; t < NUM_OF_TABLES; t++) {
+      char tableName[32];
+      sprintf(tableName, "t%d", t);
+      append_or_exit(writer, tableName, i, 100);
+    }
+    append_or_exit(writer, "bulk_writer_db.nt", i, 100);
+  }
+
+  if (taos_bulk_writer_flush(writer) != 0 || failures.numOfRows != 0) {
+    PRINT_ERROR
+    printf("failed to flush bulk writer, %d rows failed\n", failures.numOfRows);
+    exit(EXIT_FAILURE);
+  }
+  for (int t = 0; t < NUM_OF_TABLES; t++) {
+    char tableName[32];
+    sprintf(tableName, "t%d", t);
+    check_rows(taos, tableName, NUM_OF_ROWS, sum_of(0, NUM_OF_ROWS));
+  }
+  check_rows(taos, "nt", NUM_OF_ROWS, sum_of(0, NUM_OF_ROWS));
+  check_rows(taos, "st", (NUM_OF_TABLES + 0) * NUM_OF_ROWS, NUM_OF_TABLES * sum_of(0, NUM_OF_ROWS));
+
+  // rows below maxRows are submitted once they are older than flushInterval
+  append_or_exit(writer, "t0", NUM_OF_ROWS, 10);
+  usleep(1000 * 1000);
+  check_rows(taos, "t0", NUM_OF_ROWS + 10, sum_of(0, NUM_OF_ROWS + 10));
+
+  // a table that does not exist or a row that does not bind is refused by append
+  if (append_rows(writer, "no_such_table", 0, 1) == 0) {
+    PRINT_ERROR
+    printf("rows of a table not existing are appended\n");
+    exit(EXIT_FAILURE);
+  }
+  {
+    int64_t   ts = START_TS;
+    double    v = 1.0;
+    TAOS_BIND params[2];
+    memset(params, 0, sizeof(params));
+    params[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+    params[0].buffer_length = sizeof(ts);
+    params[0].buffer = &ts;
+    params[0].length = &params[0].buffer_length;
+    params[1].buffer_type = TSDB_DATA_TYPE_DOUBLE;
+    params[1].buffer_length = sizeof(v);
+    params[1].buffer = &v;
+    params[1].length = &params[1].buffer_length;
+    if (taos_bulk_writer_append(writer, "t1", params) == 0) {
+      PRINT_ERROR
+      printf("a double is appended to an int column\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+  PRINT_SUCCESS
+  printf("rows that can not be written are refused by append\n");
+
+  // the meta of a dropped table is outdated, the rows are reported per table and the meta is reloaded
+  execute_simple_sql(taos, "drop table t9");
+  execute_simple_sql(taos, "create table t9 using st tags(9)");
+  append_or_exit(writer, "t9", 0, 7);
+  if (taos_bulk_writer_flush(writer) == 0 || failures.numOfRows != 7 || strstr(failures.tableName, "t9") == NULL) {
+    PRINT_ERROR
+    printf("rows of a recreated table: %d rows of %s reported failed\n", failures.numOfRows, failures.tableName);
+    exit(EXIT_FAILURE);
+  }
+  PRINT_SUCCESS
+  printf("%d rows of %s are reported failed, reason: %s\n", failures.numOfRows, failures.tableName,
+         taos_errstr(NULL));
+
+  append_or_exit(writer, "t9", 0, 7);
+  if (taos_bulk_writer_flush(writer) != 0) {
+    PRINT_ERROR
+    printf("failed to flush rows of the recreated table\n");
+    exit(EXIT_FAILURE);
+  }
+  check_rows(taos, "t9", 7, sum_of(0, 7));
+
+  // rows left are submitted on close
+  append_or_exit(writer, "t1", NUM_OF_ROWS, 3);
+  taos_bulk_writer_close(writer);
+  check_rows(taos, "t1", NUM_OF_ROWS + 3, sum_of(0, NUM_OF_ROWS + 3));
+
+  PRINT_SUCCESS
+  printf("bulk writer test passed\n");
+  printf("\033[0m");
+
+  taos_close(taos);
+  return 0;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taos.h"
+#include "tulog.h"
+#include "tutil.h"
+#include "hash.h"
+#include "tarray.h"
+#include "taoserror.h"
+#include "tscParseLine.h"
+
+#define GREEN "\033[1;32m"
+#define NC "\033[0m"
+#define MAX_LINE_LEN 65536
+
+int32_t numOfLines = 10000;
+int32_t numOfLoops = 20;
+int32_t telnet = 0;
+char *  lineFile = NULL;
+
+void shellParseArgument(int argc, char *argv[]);
+
+// lines look like what telegraf reports for cpu/mem/disk
+char **generateLines(int32_t num) {
+  char **lines = calloc(num, sizeof(char *));
+  char   buf[1024];
+
+  for (int32_t i = 0; i < num; ++i) {
+    int32_t len;
+    if (telnet) {
+      len = snprintf(buf, sizeof(buf), "sys.cpu.usage_%d %" PRId64 "ns %d.%03df64 host=\"web%04d\",cpu=\"cpu%d\",dc=\"east-%d\"",
+                     i % 8, (int64_t)1626006833639000000 + i, i % 100, i % 1000, i % 1000, i % 16, i % 4);
+    } else {
+      len = snprintf(buf, sizeof(buf),
+                     "cpu,host=\"web%04d\",cpu=\"cpu%d\",region=\"us-east-%d\",dc=\"dc\\ %d\" usage_user=%d.%03df64,"
+                     "usage_system=%d.%03df64,usage_idle=%d.%03df64,usage_iowait=%de-3f64,processes=%di64,"
+                     "threads=%du32,status=\"running\",running=t %" PRId64 "ns",
+                     i % 1000, i % 16, i % 4, i % 8, i % 100, i % 1000, (i * 7) % 100, i % 1000, (i * 3) % 100,
+                     i % 1000, i, i % 4096, i * 5, (int64_t)1626006833639000000 + i);
+    }
+    lines[i] = strndup(buf, len);
+  }
+
+  return lines;
+}
+
+char **readLines(const char *file, int32_t *num) {
+  FILE *fp = fopen(file, "r");
+  if (fp == NULL) {
+    pPrint("failed to open %s, reason:%s", file, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  int32_t capacity = 1024;
+  char ** lines = calloc(capacity, sizeof(char *));
+  char *  buf = malloc(MAX_LINE_LEN);
+
+  *num = 0;
+  while (fgets(buf, MAX_LINE_LEN, fp) != NULL) {
+    size_t len = strlen(buf);
+    while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == '\r')) buf[--len] = '\0';
+    if (len == 0 || buf[0] == '#') continue;
+
+    if (*num >= capacity) {
+      capacity *= 2;
+      lines = realloc(lines, capacity * sizeof(char *));
+    }
+    lines[(*num)++] = strndup(buf, len);
+  }
+
+  free(buf);
+  fclose(fp);
+  return lines;
+}
+
+void testParsePerformance(char **lines, int32_t num) {
+  int64_t totalBytes = 0;
+  for (int32_t i = 0; i < num; ++i) {
+    totalBytes += strlen(lines[i]);
+  }
+
+  SSmlLinesInfo info = {0};
+  int64_t       totalUs = 0;
+
+  for (int32_t loop = 0; loop < numOfLoops; ++loop) {
+    SArray *points = taosArrayInit(num, sizeof(TAOS_SML_DATA_POINT));
+
+    int64_t startUs = taosGetTimestampUs();
+    int32_t code = telnet ? tscParseTelnetLines(lines, num, points, NULL, &info)
+                          : tscParseLines(lines, num, points, NULL, &info);
+    int64_t endUs = taosGetTimestampUs();
+
+    if (code != 0) {
+      pPrint("failed to parse lines, reason:%s", tstrerror(code));
+      exit(EXIT_FAILURE);
+    }
+    totalUs += endUs - startUs;
+
+    for (int32_t i = 0; i < taosArrayGetSize(points); ++i) {
+      destroySmlDataPoint(taosArrayGet(points, i));
+    }
+    taosArrayDestroy(points);
+  }
+
+  double seconds = totalUs / 1000000.0;
+  pPrint("%s parse %d lines %d times, total time:%.3f sec, speed:%.1f lines/second, %.2f MB/second %s", GREEN, num,
+         numOfLoops, seconds, (double)num * numOfLoops / seconds,
+         (double)totalBytes * numOfLoops / seconds / 1024 / 1024, NC);
+}
+
+int main(int argc, char *argv[]) {
+  shellParseArgument(argc, argv);
+
+  int32_t num = numOfLines;
+  char ** lines = (lineFile != NULL) ? readLines(lineFile, &num) : generateLines(numOfLines);
+
+  testParsePerformance(lines, num);
+
+  for (int32_t i = 0; i < num; ++i) {
+    free(lines[i]);
+  }
+  free(lines);
+  return 0;
+}
+
+void printHelp() {
+  char indent[10] = "        ";
+  printf("Used to test the performance of schemaless line parsing\n");
+
+  printf("%s%s\n", indent, "-f");
+  printf("%s%s%s\n", indent, indent, "file of lines to parse, one line per row, lines are generated if not set");
+  printf("%s%s\n", indent, "-n");
+  printf("%s%s%s%d\n", indent, indent, "number of generated lines, default is ", numOfLines);
+  printf("%s%s\n", indent, "-l");
+  printf("%s%s%s%d\n", indent, indent, "loops over all lines, default is ", numOfLoops);
+  printf("%s%s\n", indent, "-t");
+  printf("%s%s%s\n", indent, indent, "lines are in opentsdb telnet format instead of influxdb line protocol");
+
+  exit(EXIT_SUCCESS);
+}
+
+void shellParseArgument(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+      printHelp();
+      exit(0);
+    } else if (strcmp(argv[i], "-f") == 0) {
+      lineFile = argv[++i];
+    } else if (strcmp(argv[i], "-n") == 0) {
+      numOfLines = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0) {
+      numOfLoops = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-t") == 0) {
+      telnet = 1;
+    } else {
+    }
+  }
+
+  pPrint("%s lineFile:%s %s", GREEN, lineFile ? lineFile : "generated", NC);
+  pPrint("%s numOfLines:%d %s", GREEN, numOfLines, NC);
+  pPrint("%s numOfLoops:%d %s", GREEN, numOfLoops, NC);
+  pPrint("%s telnet:%d %s", GREEN, telnet, NC);
+}